@@ -33,6 +33,10 @@ class DeejConfig {
   String comPort;
   int baudRate;
   String noiseReduction;
+  // Buton/encoder'lı kartlar için (native motor okur, deej yok sayar):
+  // kısa basış hedefi sessize alır, encoder sesini değiştirir.
+  final Map<int, SliderTarget> buttonMapping;
+  final Map<int, SliderTarget> encoderMapping;
 
   DeejConfig({
     required this.sliderMapping,
@@ -40,6 +44,8 @@ class DeejConfig {
     required this.comPort,
     required this.baudRate,
     required this.noiseReduction,
+    this.buttonMapping = const {},
+    this.encoderMapping = const {},
   });
 
   factory DeejConfig.defaults() => DeejConfig(
@@ -0,0 +1,86 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+/// Native meter geçmişini (bkz. meter_history.h `MeterHistoryBlock`) kopya
+/// almadan okur. Blok plugin DLL'inde yaşıyor; burada sadece görünüm var.
+///
+///   64 byte başlık, ardından float data[slots][2][length]
+///   (slot başına önce peak halkası, sonra RMS halkası).
+class MeterHistoryView {
+  MeterHistoryView._(this._header, this._seq, this._columns, this.data, this.slots, this.length, this.rateHz);
+
+  static const int _magic = 0x484D4456; // "VDMH"
+  static const int _headerBytes = 64;
+
+  final Uint32List _header;
+  final Pointer<Uint64> _seq;
+  final Pointer<Uint64> _columns;
+
+  /// Native belleğin kendisi: yazıcı thread bunu sürekli günceller.
+  final Float32List data;
+  final int slots;
+  final int length;
+  final double rateHz;
+
+  static MeterHistoryView? _instance;
+
+  /// Plugin kayıtlı değilse veya Windows dışında null.
+  static MeterHistoryView? open() {
+    if (_instance != null) return _instance;
+    if (!Platform.isWindows) return null;
+    try {
+      final lib = DynamicLibrary.open('volumedeck_mixer_plugin.dll');
+      final fn = lib.lookupFunction<Pointer<Void> Function(Pointer<IntPtr>), Pointer<Void> Function(Pointer<IntPtr>)>(
+        'VolumedeckMixerMeterHistory',
+      );
+      final block = fn(nullptr);
+      if (block == nullptr) return null;
+
+      final header = block.cast<Uint32>().asTypedList(_headerBytes ~/ 4);
+      if (header[0] != _magic || header[1] != 1) return null;
+      final slots = header[2];
+      final length = header[3];
+      final rate = (block.cast<Float>() + 4).value;
+      final data = Pointer<Float>.fromAddress(block.address + _headerBytes).asTypedList(slots * 2 * length);
+      return _instance = MeterHistoryView._(
+        header,
+        Pointer<Uint64>.fromAddress(block.address + 24),
+        Pointer<Uint64>.fromAddress(block.address + 32),
+        data,
+        slots,
+        length,
+        rate,
+      );
+    } catch (_) {
+      return null;
+    }
+  }
+
+  /// Toplam yazılmış sütun; en yenisi `(columns - 1) % length` indeksinde.
+  int get columns => _columns.value;
+
+  /// Slot'un peak ve RMS geçmişini eskiden yeniye `peaks`/`rms` içine kopyalar
+  /// (ikisi de `length` uzunluğunda, sağa hizalı). Yazıcı araya girerse
+  /// tekrar dener; geçerli sütun sayısını döner.
+  int copySlot(int slot, Float32List peaks, Float32List rms) {
+    if (slot < 0 || slot >= slots) return 0;
+    while (true) {
+      final s1 = _seq.value;
+      if (s1.isOdd) continue;
+      final cols = columns;
+      final valid = cols < length ? cols : length;
+      final start = (cols - valid) % length;
+      final base = slot * 2 * length;
+      for (var i = 0; i < valid; i++) {
+        final at = (start + i) % length;
+        peaks[length - valid + i] = data[base + at];
+        rms[length - valid + i] = data[base + length + at];
+      }
+      if (_seq.value == s1) return valid;
+    }
+  }
+
+  // Başlık referansı blok canlı kaldığı sürece geçerli (plugin ömrü).
+  int get version => _header[1];
+}
@@ -0,0 +1,113 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'state_channel_ffi.dart';
+
+/// Native senkron mixer çağrıları (bkz. volumedeck_mixer_ffi.h). Fader
+/// sürüklerken MethodChannel'ın codec + thread atlaması + Future maliyeti
+/// yerine doğrudan C çağrısı; nadir işlemler MethodChannel'da kalıyor.
+///
+/// Slot numaraları durum kanalınınkiler: 0 ana çıkış, oturumlar
+/// [StateChannelView.roster] sırasıyla. Her yazma, slotun çözüldüğü
+/// [StateChannelView.rosterGeneration]'ı taşır; roster o arada değiştiyse
+/// native taraf yazmayı reddeder (false / sayılmaz). Slotlar ancak sampler
+/// aboneliği tutulurken güncel bir roster'dan çözülür (bkz.
+/// [StateChannelView]); abonelik yoksa MethodChannel kullanılır.
+class MixerFfi {
+  MixerFfi._(this._setVolume, this._setMute, this._applyBatch, this._readMeters);
+
+  static const int opVolume = 0;
+  static const int opMute = 1;
+
+  /// Slot başına okunan değer: peak, hold, ppm, vu, rms.
+  static const int meterFields = 5;
+
+  final int Function(int, int, double) _setVolume;
+  final int Function(int, int, int) _setMute;
+  final int Function(Pointer<Uint8>, int) _applyBatch;
+  final int Function(Pointer<Float>, int) _readMeters;
+
+  static MixerFfi? _instance;
+
+  /// Windows dışında veya eski bir plugin DLL'inde null.
+  static MixerFfi? open() {
+    if (_instance != null) return _instance;
+    if (!Platform.isWindows) return null;
+    try {
+      final lib = DynamicLibrary.open('volumedeck_mixer_plugin.dll');
+      // Hepsi kısa ve geri çağırmasız: leaf çağrı, typed data doğrudan geçer.
+      return _instance = MixerFfi._(
+        lib.lookupFunction<Int32 Function(Uint32, Uint32, Float), int Function(int, int, double)>(
+          'VolumedeckMixerSetVolume',
+          isLeaf: true,
+        ),
+        lib.lookupFunction<Int32 Function(Uint32, Uint32, Int32), int Function(int, int, int)>(
+          'VolumedeckMixerSetMute',
+          isLeaf: true,
+        ),
+        lib.lookupFunction<Uint32 Function(Pointer<Uint8>, Uint32), int Function(Pointer<Uint8>, int)>(
+          'VolumedeckMixerApplyBatch',
+          isLeaf: true,
+        ),
+        lib.lookupFunction<Uint32 Function(Pointer<Float>, Uint32), int Function(Pointer<Float>, int)>(
+          'VolumedeckMixerReadMeters',
+          isLeaf: true,
+        ),
+      );
+    } catch (_) {
+      return null;
+    }
+  }
+
+  bool setVolume(int generation, int slot, double v01) => _setVolume(_gen(generation), slot, v01) != 0;
+
+  bool setMute(int generation, int slot, bool mute) => _setMute(_gen(generation), slot, mute ? 1 : 0) != 0;
+
+  /// C tarafı jenerasyonun alt 32 bitini karşılaştırır.
+  static int _gen(int generation) => generation & 0xffffffff;
+
+  /// `out` en az `slots * meterFields` uzunlukta; yazılan slot sayısını döner.
+  int readMeters(Float32List out) => _readMeters(out.address, out.length ~/ meterFields);
+
+  /// Tek çağrıda birden çok işlem; başarılı olanların sayısını döner.
+  int applyBatch(MixerOpBatch batch) => _applyBatch(batch._bytes.address, batch.length);
+
+  /// Oturum kimliğinden slota; roster'da yoksa null.
+  static int? slotOf(StateChannelView view, String sessionId) {
+    final roster = view.roster;
+    for (var i = 0; i < roster.length; i++) {
+      if (roster[i].id == sessionId) return i;
+    }
+    return null;
+  }
+}
+
+/// `VolumedeckMixerOp` dizisi (generation, slot, kind, value; 16 byte),
+/// frame başına yeniden kullanılmak üzere.
+class MixerOpBatch {
+  MixerOpBatch(int capacity) : _bytes = Uint8List(capacity * _opBytes);
+
+  static const int _opBytes = 16;
+
+  final Uint8List _bytes;
+  int length = 0;
+
+  int get capacity => _bytes.length ~/ _opBytes;
+
+  void clear() => length = 0;
+
+  void add(int generation, int slot, int kind, double value) {
+    if (length == capacity) return;
+    final d = ByteData.sublistView(_bytes, length * _opBytes, (length + 1) * _opBytes);
+    d.setUint32(0, MixerFfi._gen(generation), Endian.host);
+    d.setUint32(4, slot, Endian.host);
+    d.setUint32(8, kind, Endian.host);
+    d.setFloat32(12, value, Endian.host);
+    length++;
+  }
+
+  void volume(int generation, int slot, double v01) => add(generation, slot, MixerFfi.opVolume, v01);
+
+  void mute(int generation, int slot, bool mute) => add(generation, slot, MixerFfi.opMute, mute ? 1.0 : 0.0);
+}
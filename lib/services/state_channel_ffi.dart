@@ -0,0 +1,142 @@
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+/// Roster'daki bir slot: oturum kimliği, exe adı ve görünen ad.
+class StateRosterEntry {
+  const StateRosterEntry(this.id, this.exeName, this.displayName);
+
+  final String id;
+  final String exeName;
+  final String displayName;
+}
+
+/// Native canlı durum kanalını (bkz. state_channel.h `StateChannelHeader`)
+/// kopya almadan ve frame başına sistem çağrısı yapmadan okur. Kanal ya
+/// plugin'in kendisinde ya da açıksa volumedeckd'nin paylaşılan belleğinde.
+///
+///   128 byte başlık, ardından float volume[], float peak[],
+///   uint32 flags[], uint32 pid[] (kapasite kadar) ve roster baytları.
+///
+/// Slot 0 varsayılan çıkış cihazı; oturumlar arkasından gelir.
+///
+/// Plugin'in kendi kanalını meter thread'i doldurur ve sampler'ın abonesi
+/// kalmayınca o da durur: okuyan taraf, kanal güncel kalsın diye okuduğu
+/// sürece bir `WindowsMixerService.subscribeSampler` aboneliği tutar.
+class StateChannelView {
+  StateChannelView._(this._block, this.capacity, this.volumes, this.peaks, this.flags, this.pids);
+
+  static const int _magic = 0x43534456; // "VDSC"
+  static const int _headerBytes = 128;
+
+  static const int flagMuted = 1 << 0;
+  static const int flagSystem = 1 << 1;
+  static const int flagEndpoint = 1 << 2;
+
+  final Pointer<Uint8> _block;
+  final int capacity;
+
+  /// Native belleğin kendisi; yalnızca [read] içinde tutarlıdır.
+  final Float32List volumes;
+  final Float32List peaks;
+  final Uint32List flags;
+  final Uint32List pids;
+
+  List<StateRosterEntry> _roster = const [];
+  int _rosterGeneration = 0;
+
+  static StateChannelView? _instance;
+
+  /// Plugin kayıtlı değilse veya Windows dışında null.
+  static StateChannelView? open() {
+    if (_instance != null) return _instance;
+    if (!Platform.isWindows) return null;
+    try {
+      final lib = DynamicLibrary.open('volumedeck_mixer_plugin.dll');
+      final fn = lib.lookupFunction<Pointer<Void> Function(Pointer<IntPtr>), Pointer<Void> Function(Pointer<IntPtr>)>(
+        'VolumedeckMixerStateChannel',
+      );
+      final block = fn(nullptr).cast<Uint8>();
+      if (block == nullptr) return null;
+
+      final header = block.cast<Uint32>().asTypedList(_headerBytes ~/ 4);
+      if (header[0] != _magic || header[1] != 1) return null;
+      final capacity = header[2];
+      Pointer<T> at<T extends NativeType>(int offset) => Pointer<T>.fromAddress(block.address + offset);
+      return _instance = StateChannelView._(
+        block,
+        capacity,
+        at<Float>(header[4]).asTypedList(capacity),
+        at<Float>(header[5]).asTypedList(capacity),
+        at<Uint32>(header[6]).asTypedList(capacity),
+        at<Uint32>(header[7]).asTypedList(capacity),
+      );
+    } catch (_) {
+      return null;
+    }
+  }
+
+  int _u64(int offset) => (_block + offset).cast<Uint64>().value;
+  int _u32(int offset) => (_block + offset).cast<Uint32>().value;
+
+  /// Yayınlanan toplam frame; değişmediyse yeniden çizmeye gerek yok.
+  int get frame => _u64(48);
+
+  /// Yazıcı kanalı kapattıysa (ör. volumedeckd durdu) false.
+  bool get live => _u32(68) != 0;
+
+  /// `body(count)` yazıcı araya girmeden çalışırsa sonucunu döner; body
+  /// dizileri doğrudan okur. Yazıcı takılı kaldıysa null.
+  T? read<T>(T Function(int count) body, {int attempts = 64}) {
+    for (var i = 0; i < attempts; i++) {
+      final s1 = _u64(40);
+      if (s1.isOdd) continue;
+      final count = _u32(64);
+      final result = body(count < capacity ? count : capacity);
+      if (_u64(40) == s1) return result;
+    }
+    return null;
+  }
+
+  /// Son okunan [roster]'un jenerasyonu; [MixerFfi] yazmaları bununla
+  /// etiketlenir ki başka bir roster'a göre çözülmüş slot reddedilsin.
+  int get rosterGeneration => _rosterGeneration;
+
+  /// Slotların adları. Sadece jenerasyon değişince yeniden çözülür.
+  List<StateRosterEntry> get roster {
+    final generation = _u64(80);
+    if (generation == _rosterGeneration) return _roster;
+    final header = _block.cast<Uint32>();
+    final rosterAt = (header + 8).value;
+    final rosterBytes = (header + 3).value;
+    for (var attempt = 0; attempt < 64; attempt++) {
+      final s1 = _u64(72);
+      if (s1.isOdd) continue;
+      final used = _u32(88);
+      final bytes = Uint8List.fromList((_block + rosterAt).asTypedList(used < rosterBytes ? used : rosterBytes));
+      final gen = _u64(80);
+      if (_u64(72) != s1) continue;
+      _roster = _parseRoster(bytes);
+      _rosterGeneration = gen;
+      break;
+    }
+    return _roster;
+  }
+
+  static List<StateRosterEntry> _parseRoster(Uint8List bytes) {
+    final out = <StateRosterEntry>[];
+    var at = 0;
+    String next() {
+      final n = bytes[at] | (bytes[at + 1] << 8);
+      final s = utf8.decode(Uint8List.sublistView(bytes, at + 2, at + 2 + n), allowMalformed: true);
+      at += 2 + n;
+      return s;
+    }
+
+    while (at + 6 <= bytes.length) {
+      out.add(StateRosterEntry(next(), next(), next()));
+    }
+    return out;
+  }
+}
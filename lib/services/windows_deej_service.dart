@@ -1,12 +1,72 @@
 import 'dart:io';
 
+import 'package:flutter/services.dart';
+
+/// deej.exe'nin durumu; plugin'in süpervizöründen (getDeejStatus).
+class DeejStatus {
+  final bool running;
+  final int pid;
+  final int starts;
+  final int crashes;
+  final int lastExitCode;
+  final int startupUs; // spawn -> çalışıyor
+  final int restartUs; // restart isteği -> yeni süreç çalışıyor
+  final int uptimeMs;
+  final int backoffMs;
+
+  const DeejStatus({
+    this.running = false,
+    this.pid = 0,
+    this.starts = 0,
+    this.crashes = 0,
+    this.lastExitCode = 0,
+    this.startupUs = 0,
+    this.restartUs = 0,
+    this.uptimeMs = 0,
+    this.backoffMs = 0,
+  });
+
+  factory DeejStatus.fromMap(Map m) {
+    int i(String k) => (m[k] as num?)?.toInt() ?? 0;
+    return DeejStatus(
+      running: m['running'] == true,
+      pid: i('pid'),
+      starts: i('starts'),
+      crashes: i('crashes'),
+      lastExitCode: i('lastExitCode'),
+      startupUs: i('startupUs'),
+      restartUs: i('restartUs'),
+      uptimeMs: i('uptimeMs'),
+      backoffMs: i('backoffMs'),
+    );
+  }
+}
+
+/// deej.exe'yi native süpervizörle çalıştırır: süreç handle'ı tutulur,
+/// çökünce backoff ile yeniden başlatılır, restart eski süreç gerçekten
+/// bitince hemen yapılır (sabit 250 ms bekleme yok). Sadece kendi
+/// başlattığımız deej kapatılır. Plugin eskiyse eski yola düşer.
 class WindowsDeejService {
+  static const MethodChannel _ch = MethodChannel('volumedeck_mixer');
+
   Future<void> killDeej() async {
+    try {
+      await _ch.invokeMethod('stopDeej');
+      return;
+    } on MissingPluginException {
+      // eski plugin
+    }
     // Çalışmıyorsa da sorun değil.
     await Process.run('taskkill', ['/IM', 'deej.exe', '/F']);
   }
 
   Future<void> startDeej(String deejExePath, {String? workingDir}) async {
+    try {
+      await _ch.invokeMethod('startDeej', _args(deejExePath, workingDir));
+      return;
+    } on MissingPluginException {
+      // eski plugin
+    }
     await Process.start(
       deejExePath,
       const [],
@@ -16,8 +76,29 @@ class WindowsDeejService {
   }
 
   Future<void> restartDeej(String deejExePath, {String? workingDir}) async {
-    await killDeej();
+    try {
+      await _ch.invokeMethod('restartDeej', _args(deejExePath, workingDir));
+      return;
+    } on MissingPluginException {
+      // eski plugin
+    }
+    await Process.run('taskkill', ['/IM', 'deej.exe', '/F']);
     await Future.delayed(const Duration(milliseconds: 250));
     await startDeej(deejExePath, workingDir: workingDir);
   }
+
+  /// Süpervizör yoksa (deej hiç başlatılmadıysa ya da eski plugin) null.
+  Future<DeejStatus?> status() async {
+    try {
+      final res = await _ch.invokeMethod<Map>('getDeejStatus');
+      return res == null ? null : DeejStatus.fromMap(res);
+    } on MissingPluginException {
+      return null;
+    }
+  }
+
+  static Map<String, Object?> _args(String exePath, String? workingDir) => {
+        'exePath': exePath,
+        if (workingDir != null) 'workingDir': workingDir,
+      };
 }
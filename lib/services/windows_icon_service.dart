@@ -1,14 +1,67 @@
+import 'dart:async';
 import 'dart:convert';
 import 'dart:io';
 import 'dart:typed_data';
+import 'dart:ui' as ui;
+
+import 'package:flutter/services.dart';
+
+/// Tek bir GPU image içinde birden çok ikon (native atlas, bkz.
+/// icon_extractor.cpp `getIconAtlas`). Rect'ler atlas piksel koordinatında.
+class IconAtlas {
+  IconAtlas(this.image, this.rects, this.version);
+
+  final ui.Image image;
+  final Map<String, ui.Rect> rects; // küçük harf path -> rect
+  final int version;
+
+  ui.Rect? rectFor(String? path) {
+    final p = (path ?? '').trim().toLowerCase();
+    return p.isEmpty ? null : rects[p];
+  }
+}
 
 class WindowsIconService {
   WindowsIconService._();
   static final WindowsIconService I = WindowsIconService._();
 
+  // Runner tarafı (icon_extractor.cpp): diskteki ikon cache'i burada.
+  static const MethodChannel _native = MethodChannel('volumedeck/icon');
+  bool _nativeAvailable = true;
+
   // Basit cache: "path|size" -> png bytes
   final Map<String, Uint8List?> _cache = {};
 
+  // "path|size" -> hazır GPU image (widget'lar bunu kullanıyor)
+  final Map<String, Future<ui.Image?>> _images = {};
+
+  /// Native raw RGBA varsa ne C++'ta PNG encode ne burada PNG decode yapılır;
+  /// yoksa PNG yoluna düşer.
+  Future<ui.Image?> getExeIconImage(String exePath, {int size = 20}) {
+    final p = exePath.trim();
+    if (p.isEmpty) return Future.value(null);
+
+    final key = '${p.toLowerCase()}|$size';
+    return _images.putIfAbsent(key, () => _loadImage(p, size));
+  }
+
+  Future<ui.Image?> _loadImage(String p, int size) async {
+    if (!Platform.isWindows) return null;
+
+    final raw = await _getNativeRgba(p, size);
+    if (raw != null) return raw;
+
+    final png = await getExeIconPng(p, size: size);
+    if (png == null || png.isEmpty) return null;
+    try {
+      final codec = await ui.instantiateImageCodec(png);
+      final frame = await codec.getNextFrame();
+      return frame.image;
+    } catch (_) {
+      return null;
+    }
+  }
+
   Future<Uint8List?> getExeIconPng(String exePath, {int size = 20}) async {
     if (!Platform.isWindows) return null;
 
@@ -18,6 +71,13 @@ class WindowsIconService {
     final key = '${p.toLowerCase()}|$size';
     if (_cache.containsKey(key)) return _cache[key];
 
+    // Önce native + disk cache; soğuk açılışta PowerShell hiç çalışmaz.
+    final nativeBytes = await _getNative(p, size);
+    if (nativeBytes != null) {
+      _cache[key] = nativeBytes;
+      return nativeBytes;
+    }
+
     final psExe = _powershellExePath();
 
     // Base64 PNG üretip stdout’a basıyoruz (tek satır).
@@ -104,6 +164,127 @@ try {
     }
   }
 
+  // Boyut başına native atlas'ın buradaki kopyası. Native taraf yalnızca
+  // `version`'dan sonra yazılan satırları gönderir; değişmediyse hiç piksel
+  // gelmez ve hazır image yeniden kullanılır.
+  final Map<int, _AtlasSheet> _sheets = {};
+
+  /// Picker listeleri için: istenen tüm ikonlar tek sheet'te, tek upload.
+  /// Native taraf atlası sadece büyütür; eski rect'ler geçerli kalır.
+  Future<IconAtlas?> getIconAtlas(List<String> paths, {int size = 20}) async {
+    if (!Platform.isWindows || !_nativeAvailable) return null;
+
+    final clean = paths.map((e) => e.trim()).where((e) => e.isNotEmpty).toSet().toList();
+    if (clean.isEmpty) return null;
+
+    try {
+      final known = _sheets[size];
+      final res = await _native.invokeMapMethod<String, dynamic>('getIconAtlas', {
+        'paths': clean,
+        'size': size,
+        'knownVersion': known?.version ?? 0,
+      });
+      if (res == null) return null;
+
+      final w = res['width'] as int? ?? 0;
+      final h = res['height'] as int? ?? 0;
+      final version = res['version'] as int? ?? 0;
+      if (w <= 0 || h <= 0) return null;
+
+      final rects = <String, ui.Rect>{};
+      final raw = (res['rects'] as Map?) ?? const {};
+      raw.forEach((k, v) {
+        if (k is! String || v is! List || v.length != 4) return;
+        final r = v.cast<int>();
+        rects[k.toLowerCase()] = ui.Rect.fromLTWH(
+          r[0].toDouble(),
+          r[1].toDouble(),
+          r[2].toDouble(),
+          r[3].toDouble(),
+        );
+      });
+
+      final image = await _applyAtlas(size, w, h, version, res['firstRow'] as int? ?? 0, res['pixels'] as Uint8List?);
+      if (image == null) return null;
+      return IconAtlas(image, rects, version);
+    } on MissingPluginException {
+      _nativeAvailable = false;
+      return null;
+    } catch (_) {
+      return null;
+    }
+  }
+
+  /// Gelen satırları kopyaya işler; sheet büyüdüyse yeni satırlar şeffaf.
+  Future<ui.Image?> _applyAtlas(int size, int w, int h, int version, int firstRow, Uint8List? rows) async {
+    var sheet = _sheets[size];
+    // Başka genişlik: bu kopya o atlasa ait değil.
+    if (sheet != null && sheet.width != w) sheet = null;
+    // Sıra dışı gelen eski bir cevap daha yeni kopyayı ezmesin.
+    if (sheet != null && version <= sheet.version) return sheet.image;
+
+    if (sheet == null || sheet.height != h) {
+      final pixels = Uint8List(w * h * 4);
+      if (sheet != null) pixels.setRange(0, sheet.pixels.length, sheet.pixels);
+      sheet = _AtlasSheet(w, h, pixels);
+    }
+    if (rows != null) {
+      final at = firstRow * w * 4;
+      if (rows.length % (w * 4) != 0 || at + rows.length > sheet.pixels.length) return null;
+      sheet.pixels.setRange(at, at + rows.length, rows);
+    }
+
+    final done = Completer<ui.Image>();
+    ui.decodeImageFromPixels(sheet.pixels, w, h, ui.PixelFormat.rgba8888, done.complete);
+    sheet.image = await done.future;
+    sheet.version = version;
+    _sheets[size] = sheet;
+    return sheet.image;
+  }
+
+  Future<Uint8List?> _getNative(String path, int size) async {
+    if (!_nativeAvailable) return null;
+    try {
+      final res = await _native.invokeMethod<Uint8List>('getExeIconPng', {
+        'path': path,
+        'size': size,
+      });
+      if (res == null || res.isEmpty) return null;
+      return res;
+    } on MissingPluginException {
+      _nativeAvailable = false;
+      return null;
+    } catch (_) {
+      return null;
+    }
+  }
+
+  Future<ui.Image?> _getNativeRgba(String path, int size) async {
+    if (!_nativeAvailable) return null;
+    try {
+      final res = await _native.invokeMapMethod<String, dynamic>('getExeIconRgba', {
+        'path': path,
+        'size': size,
+      });
+      if (res == null) return null;
+
+      final w = res['width'] as int? ?? 0;
+      final h = res['height'] as int? ?? 0;
+      final pixels = res['pixels'] as Uint8List?;
+      if (w <= 0 || h <= 0 || pixels == null || pixels.length != w * h * 4) return null;
+
+      // premultiplied RGBA8 -> doğrudan GPU image
+      final done = Completer<ui.Image>();
+      ui.decodeImageFromPixels(pixels, w, h, ui.PixelFormat.rgba8888, done.complete);
+      return await done.future;
+    } on MissingPluginException {
+      _nativeAvailable = false;
+      return null;
+    } catch (_) {
+      return null;
+    }
+  }
+
   String _powershellExePath() {
     final sysRoot = Platform.environment['SystemRoot'] ?? r'C:\Windows';
     final full = r'\System32\WindowsPowerShell\v1.0\powershell.exe';
@@ -123,3 +304,13 @@ try {
     return base64Encode(bytes);
   }
 }
+
+class _AtlasSheet {
+  _AtlasSheet(this.width, this.height, this.pixels);
+
+  final int width;
+  final int height;
+  final Uint8List pixels;
+  int version = 0;
+  ui.Image? image;
+}
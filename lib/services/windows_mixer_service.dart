@@ -65,6 +65,66 @@ class MixerSession {
   }
 }
 
+/// Smoothed meter values from the native meter thread (0..1, linear).
+class MeterLevels {
+  final double peak;
+  final double hold;
+  final double ppm;
+  final double vu;
+  final double rms;
+
+  const MeterLevels({this.peak = 0, this.hold = 0, this.ppm = 0, this.vu = 0, this.rms = 0});
+
+  factory MeterLevels.fromMap(Map<dynamic, dynamic> m) {
+    double d(String k) => (m[k] as num?)?.toDouble() ?? 0.0;
+    return MeterLevels(peak: d('peak'), hold: d('hold'), ppm: d('ppm'), vu: d('vu'), rms: d('rms'));
+  }
+}
+
+class MixerMeters {
+  final MeterLevels master;
+  final Map<String, MeterLevels> sessions; // sessionId -> levels
+
+  const MixerMeters({this.master = const MeterLevels(), this.sessions = const {}});
+
+  factory MixerMeters.fromMap(Map<dynamic, dynamic> m) {
+    final sessions = <String, MeterLevels>{};
+    (m['sessions'] as Map? ?? const {}).forEach((k, v) {
+      sessions[k.toString()] = MeterLevels.fromMap((v as Map).cast<dynamic, dynamic>());
+    });
+    return MixerMeters(
+      master: MeterLevels.fromMap((m['master'] as Map? ?? const {}).cast<dynamic, dynamic>()),
+      sessions: sessions,
+    );
+  }
+}
+
+/// EBU R 128 loudness of an output, measured on its loopback capture (LUFS).
+/// -70 means silence.
+class LoudnessLevels {
+  final double momentary;
+  final double shortTerm;
+  final double integrated;
+  final bool capturing;
+
+  const LoudnessLevels({
+    this.momentary = -70,
+    this.shortTerm = -70,
+    this.integrated = -70,
+    this.capturing = false,
+  });
+
+  factory LoudnessLevels.fromMap(Map<dynamic, dynamic> m) {
+    double d(String k) => (m[k] as num?)?.toDouble() ?? -70.0;
+    return LoudnessLevels(
+      momentary: d('momentary'),
+      shortTerm: d('shortTerm'),
+      integrated: d('integrated'),
+      capturing: m['capturing'] == true,
+    );
+  }
+}
+
 class WindowsMixerService {
   static const MethodChannel _ch = MethodChannel('volumedeck_mixer');
 
@@ -78,6 +138,43 @@ class WindowsMixerService {
     return MixerSnapshot.fromMap(res ?? {});
   }
 
+  /// Cheap: reads the latest values the meter thread published, no COM calls.
+  Future<MixerMeters> getMeters() async {
+    if (!Platform.isWindows) return const MixerMeters();
+    final res = await _ch.invokeMethod<Map>('getMeters');
+    return MixerMeters.fromMap(res ?? {});
+  }
+
+  /// Keeps the native meter sampler running until [unsubscribeSampler].
+  /// [maxHz]: the most this caller can use; [minHz]: what it wants even
+  /// when everything is silent. 0 = no preference.
+  Future<int?> subscribeSampler({double minHz = 0, double maxHz = 0}) async {
+    if (!Platform.isWindows) return null;
+    return _ch.invokeMethod<int>('subscribeSampler', {'minHz': minHz, 'maxHz': maxHz});
+  }
+
+  Future<void> setSamplerHint(int id, {double minHz = 0, double maxHz = 0}) async {
+    if (!Platform.isWindows) return;
+    await _ch.invokeMethod('setSamplerHint', {'id': id, 'minHz': minHz, 'maxHz': maxHz});
+  }
+
+  Future<void> unsubscribeSampler(int id) async {
+    if (!Platform.isWindows) return;
+    await _ch.invokeMethod('unsubscribeSampler', {'id': id});
+  }
+
+  /// Starts loopback capture of the endpoint on first use ('' = default).
+  Future<LoudnessLevels> getLoudness({String endpointId = ''}) async {
+    if (!Platform.isWindows) return const LoudnessLevels();
+    final res = await _ch.invokeMethod<Map>('getLoudness', {'endpointId': endpointId});
+    return LoudnessLevels.fromMap(res ?? {});
+  }
+
+  Future<void> resetLoudness({String endpointId = ''}) async {
+    if (!Platform.isWindows) return;
+    await _ch.invokeMethod('resetLoudness', {'endpointId': endpointId});
+  }
+
   Future<String?> findSessionIdByExe(String exeName) async {
     final res = await _ch.invokeMethod('findSessionIdByExe', {'exeName': exeName});
     return res as String?;
@@ -81,7 +81,7 @@ class AppState extends ChangeNotifier {
     if (deejFolderPath == null) return;
     final path = _folderSvc.defaultConfigPath(deejFolderPath!);
     configPath = path;
-    DeejConfigIO.saveToFile(path, cfg);
+    await DeejConfigIO.saveToFile(path, cfg);
     notifyListeners();
   }
 
@@ -92,7 +92,7 @@ class AppState extends ChangeNotifier {
     if (configPath == null) {
       await createConfigInDeejFolder();
     } else {
-      DeejConfigIO.saveToFile(configPath!, cfg);
+      await DeejConfigIO.saveToFile(configPath!, cfg);
     }
 
     if (autoRestartAfterSave && deejExePath != null) {
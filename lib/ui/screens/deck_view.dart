@@ -1,5 +1,7 @@
 import 'dart:async';
 import 'package:flutter/material.dart';
+import '../../services/mixer_ffi.dart';
+import '../../services/state_channel_ffi.dart';
 import '../../services/windows_mixer_service.dart';
 
 class DeckView extends StatefulWidget {
@@ -9,9 +11,14 @@ class DeckView extends StatefulWidget {
   State<DeckView> createState() => _DeckViewState();
 }
 
-class _DeckViewState extends State<DeckView> {
+class _DeckViewState extends State<DeckView> with WidgetsBindingObserver {
   final _mixer = WindowsMixerService();
+  // Fader sürüklerken senkron native yol; yoksa (eski DLL, Windows dışı)
+  // MethodChannel'a düşülür.
+  final _ffi = MixerFfi.open();
+  final _view = StateChannelView.open();
   Timer? _t;
+  int? _samplerId;
 
   MixerSnapshot? snap;
 
@@ -25,16 +32,49 @@ class _DeckViewState extends State<DeckView> {
   @override
   void initState() {
     super.initState();
-    _tick();
-    _t = Timer.periodic(const Duration(milliseconds: 50), (_) => _tick()); // ~20 FPS
+    WidgetsBinding.instance.addObserver(this);
+    _resume();
   }
 
   @override
   void dispose() {
-    _t?.cancel();
+    WidgetsBinding.instance.removeObserver(this);
+    _pause();
     super.dispose();
   }
 
+  // Hidden or minimized: stop polling and let the native sampler idle.
+  @override
+  void didChangeAppLifecycleState(AppLifecycleState state) {
+    if (state == AppLifecycleState.resumed) {
+      _resume();
+    } else if (state == AppLifecycleState.hidden || state == AppLifecycleState.paused) {
+      _pause();
+    }
+  }
+
+  Future<void> _resume() async {
+    if (_t != null) return;
+    _tick();
+    _t = Timer.periodic(const Duration(milliseconds: 50), (_) => _tick()); // ~20 FPS
+    // We never draw faster than we poll.
+    final id = await _mixer.subscribeSampler(maxHz: 20);
+    if (id == null) return;
+    if (_t == null || _samplerId != null) {
+      _mixer.unsubscribeSampler(id); // paused (or resumed twice) meanwhile
+      return;
+    }
+    _samplerId = id;
+  }
+
+  void _pause() {
+    _t?.cancel();
+    _t = null;
+    final id = _samplerId;
+    _samplerId = null;
+    if (id != null) _mixer.unsubscribeSampler(id);
+  }
+
   Future<void> _tick() async {
     final s = await _mixer.getSnapshot(includeSessions: true);
     if (!mounted) return;
@@ -99,7 +139,27 @@ class _DeckViewState extends State<DeckView> {
     return _VM(peak: sess.peak, volume: sess.volume, mute: sess.mute, sessionId: sess.sessionId);
   }
 
+  /// Kanalın durum kanalındaki slotu; roster'da yoksa null. Roster burada
+  /// okunduğu için hemen ardından [StateChannelView.rosterGeneration] bu
+  /// slotların jenerasyonudur.
+  int? _slotOf(StateChannelView view, _DeckChannel ch) {
+    if (ch.type == _TargetType.master) return 0;
+    final want = (ch.exeName ?? '').toLowerCase();
+    final roster = view.roster;
+    for (var i = 1; i < roster.length; i++) {
+      if (roster[i].exeName.toLowerCase() == want) return i;
+    }
+    return null;
+  }
+
   Future<void> _setVolume(_DeckChannel ch, double v) async {
+    final ffi = _ffi, view = _view;
+    // Abonelik yokken kanal donmuş olabilir; roster'a güvenme.
+    if (ffi != null && view != null && _samplerId != null) {
+      final slot = _slotOf(view, ch);
+      // Roster arada değiştiyse native taraf reddeder; aşağıdan devam.
+      if (slot != null && ffi.setVolume(view.rosterGeneration, slot, v)) return;
+    }
     if (ch.type == _TargetType.master) {
       await _mixer.setMasterVolume(v);
       return;
@@ -110,6 +170,11 @@ class _DeckViewState extends State<DeckView> {
   }
 
   Future<void> _setMute(_DeckChannel ch, bool mute) async {
+    final ffi = _ffi, view = _view;
+    if (ffi != null && view != null && _samplerId != null) {
+      final slot = _slotOf(view, ch);
+      if (slot != null && ffi.setMute(view.rosterGeneration, slot, mute)) return;
+    }
     if (ch.type == _TargetType.master) {
       await _mixer.setMasterMute(mute);
       return;
@@ -1,4 +1,4 @@
-import 'dart:typed_data';
+import 'dart:ui' as ui;
 import 'package:flutter/material.dart';
 
 import '../../services/windows_icon_service.dart';
@@ -30,25 +30,73 @@ class ExeIcon extends StatelessWidget {
     if (p.isEmpty) return fb;
 
     // key veriyoruz ki exePath/size değişince FutureBuilder temiz başlasın
-    return FutureBuilder<Uint8List?>(
+    return FutureBuilder<ui.Image?>(
       key: ValueKey('${p.toLowerCase()}|${size.round()}'),
-      future: WindowsIconService.I.getExeIconPng(p, size: size.round()),
+      future: WindowsIconService.I.getExeIconImage(p, size: size.round()),
       builder: (context, snap) {
-        final bytes = snap.data;
-        if (bytes == null || bytes.isEmpty) return fb;
+        final image = snap.data;
+        if (image == null) return fb;
 
         return ClipRRect(
           borderRadius: BorderRadius.circular(6),
-          child: Image.memory(
-            bytes,
+          child: RawImage(
+            image: image,
             width: size,
             height: size,
             fit: BoxFit.cover,
             filterQuality: FilterQuality.high,
-            gaplessPlayback: true,
           ),
         );
       },
     );
   }
 }
+
+/// Atlas'tan tek ikon çizer; atlasta yoksa normal [ExeIcon]'a düşer.
+class AtlasExeIcon extends StatelessWidget {
+  const AtlasExeIcon({
+    super.key,
+    required this.atlas,
+    required this.exePath,
+    this.size = 20,
+  });
+
+  final IconAtlas? atlas;
+  final String? exePath;
+  final double size;
+
+  @override
+  Widget build(BuildContext context) {
+    final a = atlas;
+    final src = a?.rectFor(exePath);
+    if (a == null || src == null) return ExeIcon(exePath: exePath, size: size);
+
+    return ClipRRect(
+      borderRadius: BorderRadius.circular(6),
+      child: CustomPaint(
+        size: Size.square(size),
+        painter: _AtlasIconPainter(a.image, src),
+      ),
+    );
+  }
+}
+
+class _AtlasIconPainter extends CustomPainter {
+  _AtlasIconPainter(this.image, this.src);
+
+  final ui.Image image;
+  final Rect src;
+
+  @override
+  void paint(Canvas canvas, Size size) {
+    canvas.drawImageRect(
+      image,
+      src,
+      Offset.zero & size,
+      Paint()..filterQuality = FilterQuality.high,
+    );
+  }
+
+  @override
+  bool shouldRepaint(_AtlasIconPainter old) => old.image != image || old.src != src;
+}
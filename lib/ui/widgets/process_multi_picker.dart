@@ -1,7 +1,9 @@
 import 'dart:collection';
 import 'package:flutter/material.dart';
 import 'package:provider/provider.dart';
+import '../../services/windows_icon_service.dart';
 import '../../state/app_state.dart';
+import 'exe_icon.dart';
 
 class ProcessMultiPickerDialog extends StatefulWidget {
   final bool singlePick;
@@ -21,6 +23,10 @@ class _ProcessMultiPickerDialogState extends State<ProcessMultiPickerDialog> {
   final _q = TextEditingController();
   final Set<String> selected = <String>{};
 
+  // Listedeki tüm ikonlar tek atlas'ta (satır başına ayrı decode yok).
+  IconAtlas? _atlas;
+  String _atlasKey = '';
+
   @override
   void initState() {
     super.initState();
@@ -37,6 +43,17 @@ class _ProcessMultiPickerDialogState extends State<ProcessMultiPickerDialog> {
     }
   }
 
+  void _ensureAtlas(List<String> paths) {
+    final key = paths.join('|');
+    if (key == _atlasKey) return;
+    _atlasKey = key;
+
+    WindowsIconService.I.getIconAtlas(paths, size: 20).then((atlas) {
+      if (!mounted || atlas == null || key != _atlasKey) return;
+      setState(() => _atlas = atlas);
+    });
+  }
+
   @override
   void dispose() {
     _q.dispose();
@@ -59,6 +76,10 @@ class _ProcessMultiPickerDialogState extends State<ProcessMultiPickerDialog> {
     }
 
     final allItems = merged.toList();
+    _ensureAtlas([
+      for (final n in allItems)
+        if (s.exePathByName[n] != null) s.exePathByName[n]!,
+    ]);
     final items = allItems.where((e) {
       if (query.isEmpty) return true;
       return e.toLowerCase().contains(query);
@@ -91,6 +112,11 @@ class _ProcessMultiPickerDialogState extends State<ProcessMultiPickerDialog> {
                   return CheckboxListTile(
                     value: checked,
                     title: Text(name),
+                    secondary: AtlasExeIcon(
+                      atlas: _atlas,
+                      exePath: s.exePathByName[name],
+                      size: 20,
+                    ),
                     controlAffinity: ListTileControlAffinity.leading,
                     onChanged: (v) {
                       setState(() {
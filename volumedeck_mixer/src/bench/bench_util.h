@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace volumedeck_mixer {
+namespace bench {
+
+// Icon-like BGRA test image: opaque body with a gradient, antialiased
+// (partially transparent) rim and transparent corners.
+inline std::vector<uint8_t> SyntheticIconBgra(int size) {
+  std::vector<uint8_t> px((size_t)size * size * 4);
+  const float c = (size - 1) * 0.5f;
+  const float r = size * 0.45f;
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const float dx = x - c, dy = y - c;
+      const float d = dx * dx + dy * dy;
+      float a = (r * r - d) / (2.0f * r) + 0.5f;
+      a = a < 0 ? 0 : (a > 1 ? 1 : a);
+      uint8_t* p = &px[((size_t)y * size + x) * 4];
+      p[0] = (uint8_t)(40 + 200 * x / size);
+      p[1] = (uint8_t)(90 + 100 * y / size);
+      p[2] = (uint8_t)(200 - 150 * x / size);
+      p[3] = (uint8_t)(a * 255.0f + 0.5f);
+    }
+  }
+  return px;
+}
+
+}  // namespace bench
+}  // namespace volumedeck_mixer
@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "change_coalescer.h"
+#include "latency_histogram.h"
+
+namespace volumedeck_mixer {
+namespace bench {
+
+// The mixer change coalescer: what a notification callback pays to post,
+// alone and with other callbacks posting at once, and how long a change
+// takes to reach a waiting consumer.
+
+namespace {
+
+ChangeCoalescer& Shared() {
+  static ChangeCoalescer c(1024, std::chrono::milliseconds(0));
+  return c;
+}
+
+}  // namespace
+
+void BM_CoalescerPost(benchmark::State& state) {
+  ChangeCoalescer& c = Shared();
+  const std::string id = "session" + std::to_string(state.thread_index());
+  float v = 0.0f;
+  for (auto _ : state) {
+    c.Post({id, v, false});
+    v = v < 1.0f ? v + 0.001f : 0.0f;
+  }
+  if (state.thread_index() == 0) {
+    std::vector<CoalescedChange> out;
+    bool resync = false;
+    c.Take(&out, &resync);
+  }
+}
+BENCHMARK(BM_CoalescerPost)->Threads(1)->Threads(4)->UseRealTime();
+
+// Post to the consumer's wake, with no frame pacing: the floor the
+// once-per-frame limit adds to.
+void BM_CoalescerCallbackToConsumer(benchmark::State& state) {
+  ChangeCoalescer c(64, std::chrono::milliseconds(0));
+  std::atomic<int64_t> posted_ns{0};
+  std::atomic<uint64_t> taken{0};
+  LatencyHistogram h;
+  std::thread consumer([&] {
+    std::vector<CoalescedChange> out;
+    bool resync = false;
+    while (c.Wait(std::chrono::seconds(5), &out, &resync)) {
+      const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now().time_since_epoch())
+                              .count();
+      h.Record((uint64_t)(now - posted_ns.load(std::memory_order_acquire)));
+      taken.fetch_add(1, std::memory_order_release);
+    }
+  });
+
+  uint64_t sent = 0;
+  for (auto _ : state) {
+    posted_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count(),
+                    std::memory_order_release);
+    c.Post({"", (float)(sent & 1), false});
+    sent++;
+    while (taken.load(std::memory_order_acquire) < sent) std::this_thread::yield();
+  }
+  c.Close();
+  consumer.join();
+  state.counters["p50_us"] = (double)h.Percentile(50) / 1e3;
+  state.counters["p99_us"] = (double)h.Percentile(99) / 1e3;
+  state.counters["max_us"] = (double)h.max_ns() / 1e3;
+}
+BENCHMARK(BM_CoalescerCallbackToConsumer)->UseRealTime();
+
+}  // namespace bench
+}  // namespace volumedeck_mixer
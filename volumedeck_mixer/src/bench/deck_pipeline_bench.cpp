@@ -0,0 +1,313 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pty.h>
+#include <unistd.h>
+#endif
+
+#include "deck_engine.h"
+#include "deej_protocol.h"
+#include "fake_mixer_backend.h"
+#include "latency_histogram.h"
+#include "slider_mapper.h"
+#include "state_channel.h"
+
+namespace volumedeck_mixer {
+namespace bench {
+
+// The slider pipeline stage by stage against the in-memory backend: board
+// line parsing, noise filtering, session enumeration, target resolution,
+// the UI snapshot, and a real serial line to mixer write.
+
+namespace {
+
+class NullInput : public SliderInput {
+ public:
+  bool Open() override { return false; }
+  void Close() override {}
+  long Read(char*, size_t, int) override { return -1; }
+  long Write(const char*, size_t) override { return -1; }
+  std::string description() const override { return "null"; }
+};
+
+const char* const kApps[] = {"chrome.exe", "discord.exe", "spotify.exe", "firefox.exe", "steam.exe",
+                             "obs64.exe",  "vlc.exe",     "zoom.exe",    "slack.exe",   "msedge.exe"};
+
+// `sessions` sessions over the apps above plus one-offs, and a system one.
+void Populate(FakeMixerBackend* backend, size_t sessions) {
+  backend->AddSession("system", 0, true);
+  for (size_t i = 0; i < sessions; i++) {
+    const std::string exe = i % 3 == 2 ? "tool" + std::to_string(i) + ".exe" : kApps[i % 10];
+    backend->AddSession(exe, (uint32_t)(1000 + i));
+  }
+}
+
+// Typical deej config: master, a few apps, a group and the catch-all.
+DeejConfig Sliders(size_t count) {
+  DeejConfig cfg;
+  for (size_t s = 0; s < count; s++) {
+    std::vector<std::string> targets;
+    if (s == 0) {
+      targets = {"master"};
+    } else if (s + 1 == count) {
+      targets = {"deej.unmapped"};
+    } else if (s % 4 == 3) {
+      targets = {kApps[s % 10], kApps[(s + 1) % 10]};
+    } else {
+      targets = {kApps[s % 10]};
+    }
+    cfg.slider_mapping[(int)s] = targets;
+  }
+  return cfg;
+}
+
+// Fixed sessions and free writes: what is left is the mapper's own work.
+class NullMixer : public MixerBackend {
+ public:
+  explicit NullMixer(size_t sessions) {
+    FakeMixerBackend fake;
+    Populate(&fake, sessions);
+    fake.ListSessions(&sessions_);
+  }
+  const char* name() const override { return "null"; }
+  bool ListSessions(std::vector<AudioSession>* out) override {
+    *out = sessions_;
+    return true;
+  }
+  bool GetMaster(float*, bool*, float*) override { return true; }
+  bool SetMasterVolume(float) override { return ++writes, true; }
+  bool SetMasterMute(bool) override { return true; }
+  bool SetSessionVolume(const std::string&, float) override { return ++writes, true; }
+  bool SetSessionMute(const std::string&, bool) override { return true; }
+  bool SetDeviceVolume(const std::string&, float) override { return ++writes, true; }
+  uint64_t session_generation() const override { return 1; }
+
+  uint64_t writes = 0;
+
+ private:
+  std::vector<AudioSession> sessions_;
+};
+
+std::string BoardBytes(size_t sliders, size_t lines) {
+  std::mt19937 rng(9);
+  std::string out;
+  for (size_t l = 0; l < lines; l++) {
+    for (size_t s = 0; s < sliders; s++) {
+      if (s) out += '|';
+      out += std::to_string(rng() % 1024);
+    }
+    out += "\r\n";
+  }
+  return out;
+}
+
+}  // namespace
+
+static void BM_ParseLines(benchmark::State& state) {
+  const std::string bytes = BoardBytes((size_t)state.range(0), 1024);
+  SliderLineParser parser;
+  size_t values = 0;
+  for (auto _ : state) {
+    parser.Feed(bytes.data(), bytes.size(), [&](const uint16_t*, size_t count) { values += count; });
+  }
+  benchmark::DoNotOptimize(values);
+  state.SetBytesProcessed(state.iterations() * (int64_t)bytes.size());
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_ParseLines)->Arg(6)->Arg(16)->Arg(64);
+
+static void BM_FilterLine(benchmark::State& state) {
+  const size_t sliders = (size_t)state.range(0);
+  std::mt19937 rng(2);
+  std::vector<std::vector<uint16_t>> lines(256, std::vector<uint16_t>(sliders));
+  for (auto& l : lines) {
+    for (auto& v : l) v = (uint16_t)(rng() % 1024);
+  }
+  SliderFilter filter;
+  std::vector<size_t> changed;
+  size_t i = 0;
+  for (auto _ : state) {
+    const auto& l = lines[i++ & 255];
+    filter.Apply(l.data(), l.size(), &changed);
+    benchmark::DoNotOptimize(changed.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FilterLine)->Arg(6)->Arg(16)->Arg(64);
+
+static void BM_ListSessions(benchmark::State& state) {
+  FakeMixerBackend backend;
+  Populate(&backend, (size_t)state.range(0));
+  std::vector<AudioSession> out;
+  for (auto _ : state) {
+    backend.ListSessions(&out);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * (int64_t)out.size());
+}
+BENCHMARK(BM_ListSessions)->Arg(16)->Arg(128)->Arg(512);
+
+// Refresh after a session change: list plus the exe index rebuild.
+static void BM_MapperRefresh(benchmark::State& state) {
+  FakeMixerBackend backend;
+  Populate(&backend, (size_t)state.range(0));
+  SliderMapper mapper(&backend);
+  mapper.SetConfig(Sliders(6));
+  for (auto _ : state) mapper.RefreshSessions(true);
+  state.SetItemsProcessed(state.iterations() * (int64_t)mapper.sessions().size());
+}
+BENCHMARK(BM_MapperRefresh)->Arg(16)->Arg(128)->Arg(512);
+
+// One slider move resolved to its sessions and written (arg: sessions).
+// Named targets only; the catch-all is measured separately below.
+static void BM_ResolveNamed(benchmark::State& state) {
+  FakeMixerBackend backend;
+  Populate(&backend, (size_t)state.range(0));
+  SliderMapper mapper(&backend);
+  mapper.SetConfig(Sliders(6));
+  mapper.RefreshSessions(true);
+  size_t writes = 0, i = 0;
+  for (auto _ : state) writes += mapper.Apply(1 + (i++ % 4), 0.5f);
+  state.counters["writes_per_move"] = benchmark::Counter((double)writes / (double)state.iterations());
+}
+BENCHMARK(BM_ResolveNamed)->Arg(16)->Arg(128)->Arg(512);
+
+static void BM_ResolveUnmapped(benchmark::State& state) {
+  FakeMixerBackend backend;
+  Populate(&backend, (size_t)state.range(0));
+  SliderMapper mapper(&backend);
+  mapper.SetConfig(Sliders(6));
+  mapper.RefreshSessions(true);
+  size_t writes = 0;
+  for (auto _ : state) writes += mapper.Apply(5, 0.5f);
+  state.counters["writes_per_move"] = benchmark::Counter((double)writes / (double)state.iterations());
+}
+BENCHMARK(BM_ResolveUnmapped)->Arg(16)->Arg(128)->Arg(512);
+
+// A board frame in which every slider moved, dispatched to its targets
+// (arg: sliders; 64 is the most the app configures). Writes cost nothing,
+// so this is lookup and iteration only.
+static void BM_DispatchFrame(benchmark::State& state) {
+  const size_t sliders = (size_t)state.range(0);
+  NullMixer backend(128);
+  SliderMapper mapper(&backend);
+  mapper.SetConfig(Sliders(sliders));
+  mapper.RefreshSessions(true);
+  float v = 0.0f;
+  for (auto _ : state) {
+    v = v >= 1.0f ? 0.0f : v + 0.01f;
+    for (size_t s = 0; s < sliders; s++) mapper.Apply(s, v);
+  }
+  state.counters["ns_per_slider"] = benchmark::Counter(
+      (double)state.iterations() * (double)sliders, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+  state.counters["writes_per_frame"] = (double)backend.writes / (double)state.iterations();
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DispatchFrame)->Arg(6)->Arg(16)->Arg(64);
+
+// What the UI gets every frame: volumes, peaks, flags (roster unchanged).
+static void BM_SnapshotFrame(benchmark::State& state) {
+  FakeMixerBackend backend;
+  Populate(&backend, (size_t)state.range(0));
+  DeckEngine engine(&backend, std::make_unique<NullInput>(), Sliders(6));
+  StateChannelWriter channel(1024, 1 << 20);
+  if (!channel.Open()) {
+    state.SkipWithError("state channel");
+    return;
+  }
+  engine.SetStateChannel(&channel);
+  engine.PublishState();
+  for (auto _ : state) engine.PublishState();
+  state.SetItemsProcessed(state.iterations() * (int64_t)state.range(0));
+}
+BENCHMARK(BM_SnapshotFrame)->Arg(16)->Arg(128)->Arg(512);
+
+// Roster re-encode, as after a session starts or ends.
+static void BM_SnapshotRoster(benchmark::State& state) {
+  const size_t n = (size_t)state.range(0);
+  std::vector<StateRosterEntry> roster(n);
+  for (size_t i = 0; i < n; i++) {
+    roster[i].id = "{0.0.0.00000000}.{8f6c3a2e-5b1d-4c7a-9e2f-" + std::to_string(100000000000 + i) + "}";
+    roster[i].exe_name = kApps[i % 10];
+    roster[i].display_name = kApps[i % 10];
+  }
+  StateChannelWriter channel(1024, 1 << 20);
+  if (!channel.Open()) {
+    state.SkipWithError("state channel");
+    return;
+  }
+  for (auto _ : state) channel.PublishRoster(roster);
+  state.SetItemsProcessed(state.iterations() * (int64_t)n);
+}
+BENCHMARK(BM_SnapshotRoster)->Arg(16)->Arg(128)->Arg(512);
+
+#ifdef __linux__
+// Board line written to a pty until the mixer holds the new value: read
+// wakeup, parse, filter, resolve, write. Reports percentiles.
+static void BM_InputToApply(benchmark::State& state) {
+  int master = -1, slave = -1;
+  char name[128] = {};
+  if (openpty(&master, &slave, name, nullptr, nullptr) != 0) {
+    state.SkipWithError("openpty");
+    return;
+  }
+  close(slave);
+
+  FakeMixerBackend backend;
+  Populate(&backend, (size_t)state.range(0));
+  DeckEngine engine(&backend, std::make_unique<SerialPort>(name, 115200), Sliders(6));
+  std::atomic<uint64_t> applied{0};
+  engine.SetMoveObserver([&](size_t slider, float) {
+    if (slider == 0) applied.fetch_add(1, std::memory_order_release);
+  });
+  if (!engine.Start()) {
+    close(master);
+    state.SkipWithError("engine");
+    return;
+  }
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!engine.stats().connected && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  // Alternate the master slider between its ends so every line is a move.
+  const std::string lines[2] = {"0|512|512|512|512|512\r\n", "1023|512|512|512|512|512\r\n"};
+  LatencyHistogram h;
+  uint64_t sent = 0;
+  for (auto _ : state) {
+    const std::string& line = lines[sent & 1];
+    const auto t0 = std::chrono::steady_clock::now();
+    if (write(master, line.data(), line.size()) != (ssize_t)line.size()) {
+      state.SkipWithError("write");
+      break;
+    }
+    sent++;
+    while (applied.load(std::memory_order_acquire) < sent) {
+      if (std::chrono::steady_clock::now() - t0 > std::chrono::seconds(1)) {
+        state.SkipWithError("line was not applied");
+        break;
+      }
+      std::this_thread::yield();
+    }
+    h.Record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0)
+                 .count());
+  }
+  engine.Stop();
+  close(master);
+  state.counters["p50_us"] = (double)h.Percentile(50) / 1e3;
+  state.counters["p99_us"] = (double)h.Percentile(99) / 1e3;
+  state.counters["max_us"] = (double)h.max_ns() / 1e3;
+}
+BENCHMARK(BM_InputToApply)->Arg(16)->Arg(512)->UseRealTime();
+#endif
+
+}  // namespace bench
+}  // namespace volumedeck_mixer
@@ -0,0 +1,78 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "bench_util.h"
+#include "icon_memory_cache.h"
+#include "icon_pixels.h"
+#include "icon_resample.h"
+
+namespace volumedeck_mixer {
+namespace bench {
+
+static IconImage SyntheticIcon(int size) {
+  const auto bgra = SyntheticIconBgra(size);
+  IconImage img;
+  IconImageFromBgra(bgra.data(), size, size, &img);
+  return img;
+}
+
+// Single resize; items are output pixels.
+static void BM_Resize(benchmark::State& state, ResampleFilter filter) {
+  const int src_size = (int)state.range(0);
+  const int dst_size = (int)state.range(1);
+  const IconImage src = SyntheticIcon(src_size);
+  IconResampler r;
+  IconImage out;
+  for (auto _ : state) {
+    r.Resize(src, dst_size, dst_size, filter, &out);
+    benchmark::DoNotOptimize(out.rgba.data());
+  }
+  state.SetItemsProcessed(state.iterations() * dst_size * dst_size);
+  state.SetBytesProcessed(state.iterations() * (int64_t)src.rgba.size());
+}
+BENCHMARK_CAPTURE(BM_Resize, box, ResampleFilter::kBox)
+    ->Args({256, 16})->Args({256, 32})->Args({96, 48})->Args({48, 24});
+BENCHMARK_CAPTURE(BM_Resize, lanczos3, ResampleFilter::kLanczos3)
+    ->Args({256, 20})->Args({256, 24})->Args({256, 48})->Args({32, 48});
+
+// Everything the UI needs from one 256 px extraction.
+static void BM_BuildPyramid(benchmark::State& state) {
+  const int src_size = (int)state.range(0);
+  const IconImage src = SyntheticIcon(src_size);
+  IconResampler r;
+  IconPyramid p;
+  for (auto _ : state) {
+    BuildIconPyramid(src, r, &p);
+    benchmark::DoNotOptimize(p.levels[0].rgba.data());
+  }
+  state.counters["bytes"] = (double)p.byte_size();
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BuildPyramid)->Arg(32)->Arg(48)->Arg(256);
+
+// Warm lookup: what every ExeIcon rebuild costs once the pyramid exists.
+static void BM_MemoryCacheHit(benchmark::State& state) {
+  IconMemoryCache cache(64u << 20);
+  IconResampler r;
+  auto p = std::make_shared<IconPyramid>();
+  BuildIconPyramid(SyntheticIcon(256), r, p.get());
+
+  std::vector<IconCacheKey> keys(200);
+  for (size_t i = 0; i < keys.size(); i++) {
+    keys[i].path = "c:/program files/app" + std::to_string(i) + "/app.exe";
+    keys[i].mtime = (int64_t)i;
+    cache.Put(keys[i], p);
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    auto hit = cache.Get(keys[i++ % keys.size()]);
+    benchmark::DoNotOptimize(hit->ForSize(20).rgba.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MemoryCacheHit);
+
+}  // namespace bench
+}  // namespace volumedeck_mixer
@@ -0,0 +1,37 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "loudness_meter.h"
+
+namespace volumedeck_mixer {
+namespace bench {
+
+// One second of programme-like noise per iteration. "x_realtime" is how
+// many streams one core could meter; 1% of a core is x_realtime = 100.
+static void BM_LoudnessMeter(benchmark::State& state) {
+  const int rate = (int)state.range(0);
+  const int channels = (int)state.range(1);
+  std::mt19937 rng(1);
+  std::normal_distribution<float> noise(0.0f, 0.1f);
+  std::vector<float> second((size_t)rate * channels);
+  for (auto& v : second) v = noise(rng);
+
+  LoudnessMeter meter(rate, channels);
+  for (auto _ : state) {
+    // Device-sized reads, as the monitor does.
+    for (size_t at = 0; at < (size_t)rate; at += 480) {
+      meter.Process(&second[at * channels], std::min<size_t>(480, (size_t)rate - at));
+    }
+    benchmark::DoNotOptimize(meter.momentary());
+    benchmark::DoNotOptimize(meter.integrated());
+  }
+  state.SetItemsProcessed(state.iterations() * rate);
+  state.counters["x_realtime"] = benchmark::Counter((double)state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_LoudnessMeter)->Args({48000, 2})->Args({44100, 2})->Args({48000, 6})->Args({96000, 8});
+
+}  // namespace bench
+}  // namespace volumedeck_mixer
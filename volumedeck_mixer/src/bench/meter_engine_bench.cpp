@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "meter_dsp.h"
+#include "meter_engine.h"
+
+namespace volumedeck_mixer {
+namespace bench {
+
+// Peak envelopes as session meters report them: a few loud sessions,
+// some with bursts, most near silence.
+static std::vector<std::vector<float>> SyntheticPeaks(size_t channels, size_t frames) {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> noise(0.0f, 0.05f);
+  std::vector<std::vector<float>> frames_out(frames, std::vector<float>(channels));
+  for (size_t c = 0; c < channels; c++) {
+    const float level = (c % 4 == 0) ? 0.8f : (c % 4 == 1 ? 0.2f : 0.01f);
+    const float rate = 0.5f + (float)(c % 7);
+    for (size_t f = 0; f < frames; f++) {
+      const float env = 0.5f + 0.5f * std::sin(rate * (float)f * 0.004f);
+      const bool burst = (c % 5 == 0) && (f % 250) < 5;
+      frames_out[f][c] = burst ? 1.0f : level * env + noise(rng);
+    }
+  }
+  return frames_out;
+}
+
+static void BM_MeterKernel(benchmark::State& state, bool vector) {
+  const size_t channels = (size_t)state.range(0);
+  const auto frames = SyntheticPeaks(channels, 1024);
+  const MeterCoeffs c = ComputeMeterCoeffs(MeterBallistics{}, 0.004);
+  MeterBank bank(channels);
+  size_t f = 0;
+  for (auto _ : state) {
+    const auto& in = frames[f++ & 1023];
+    std::copy(in.begin(), in.end(), bank.input.begin());
+    if (vector) {
+      RunMeterKernel(bank, channels, c);
+    } else {
+      RunMeterKernelScalar(bank, channels, c);
+    }
+    benchmark::DoNotOptimize(bank.peak.data());
+  }
+  state.SetItemsProcessed(state.iterations() * (int64_t)channels);
+}
+BENCHMARK_CAPTURE(BM_MeterKernel, simd, true)->Arg(8)->Arg(64)->Arg(512);
+BENCHMARK_CAPTURE(BM_MeterKernel, scalar, false)->Arg(8)->Arg(64)->Arg(512);
+
+// Replays the synthetic frames as the probe.
+class ReplayProbe : public MeterProbe {
+ public:
+  explicit ReplayProbe(std::vector<std::vector<float>> frames) : frames_(std::move(frames)) {}
+  size_t Sample(float* peaks, size_t capacity) override {
+    const auto& in = frames_[next_++ % frames_.size()];
+    const size_t n = std::min(capacity, in.size());
+    std::copy(in.begin(), in.begin() + (std::ptrdiff_t)n, peaks);
+    return n;
+  }
+
+ private:
+  std::vector<std::vector<float>> frames_;
+  size_t next_ = 0;
+};
+
+// Whole engine step: sample, ballistics, publish. At 250 Hz this times 250
+// is the meter thread's CPU per second.
+static void BM_MeterEngineTick(benchmark::State& state) {
+  const size_t channels = (size_t)state.range(0);
+  ReplayProbe probe(SyntheticPeaks(channels, 1024));
+  MeterEngine engine(&probe, channels);
+  for (auto _ : state) engine.Tick(0.004);
+  state.SetItemsProcessed(state.iterations() * (int64_t)channels);
+}
+BENCHMARK(BM_MeterEngineTick)->Arg(8)->Arg(64)->Arg(512);
+
+// Consumer side: one full read of every slot, as a UI frame does.
+static void BM_MeterEngineRead(benchmark::State& state) {
+  const size_t channels = (size_t)state.range(0);
+  ReplayProbe probe(SyntheticPeaks(channels, 16));
+  MeterEngine engine(&probe, channels);
+  engine.Tick(0.004);
+  std::vector<MeterReading> out(channels);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(engine.Read(out.data(), channels));
+  }
+  state.SetItemsProcessed(state.iterations() * (int64_t)channels);
+}
+BENCHMARK(BM_MeterEngineRead)->Arg(8)->Arg(64)->Arg(512);
+
+}  // namespace bench
+}  // namespace volumedeck_mixer
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace volumedeck_mixer {
+namespace bench {
+
+// Stand-in for a Flutter MethodChannel round trip, for comparing against
+// the FFI path on machines without the engine: the subset of
+// StandardMethodCodec the mixer calls use, plus the hop to the platform
+// thread and back. Byte layout follows the real codec, so the encode and
+// decode work is representative.
+
+using CodecValue = std::variant<std::monostate, bool, int32_t, double, std::string>;
+using CodecMap = std::map<std::string, CodecValue>;
+
+class StandardCodecModel {
+ public:
+  enum : uint8_t { kNull = 0, kTrue = 1, kFalse = 2, kInt32 = 3, kFloat64 = 6, kString = 7, kMap = 13 };
+
+  static void WriteSize(std::vector<uint8_t>& out, size_t n) {
+    if (n < 254) {
+      out.push_back((uint8_t)n);
+    } else if (n <= 0xFFFF) {
+      out.push_back(254);
+      out.push_back((uint8_t)n);
+      out.push_back((uint8_t)(n >> 8));
+    } else {
+      out.push_back(255);
+      for (int i = 0; i < 4; i++) out.push_back((uint8_t)(n >> (8 * i)));
+    }
+  }
+
+  static void WriteString(std::vector<uint8_t>& out, const std::string& s) {
+    out.push_back(kString);
+    WriteSize(out, s.size());
+    out.insert(out.end(), s.begin(), s.end());
+  }
+
+  static void WriteValue(std::vector<uint8_t>& out, const CodecValue& v) {
+    if (std::holds_alternative<std::monostate>(v)) {
+      out.push_back(kNull);
+    } else if (const bool* b = std::get_if<bool>(&v)) {
+      out.push_back(*b ? kTrue : kFalse);
+    } else if (const int32_t* i = std::get_if<int32_t>(&v)) {
+      out.push_back(kInt32);
+      const uint8_t* p = reinterpret_cast<const uint8_t*>(i);
+      out.insert(out.end(), p, p + 4);
+    } else if (const double* d = std::get_if<double>(&v)) {
+      out.push_back(kFloat64);
+      while (out.size() % 8 != 0) out.push_back(0);  // doubles are 8-aligned
+      const uint8_t* p = reinterpret_cast<const uint8_t*>(d);
+      out.insert(out.end(), p, p + 8);
+    } else {
+      WriteString(out, std::get<std::string>(v));
+    }
+  }
+
+  static std::vector<uint8_t> EncodeCall(const std::string& method, const CodecMap& args) {
+    std::vector<uint8_t> out;
+    WriteString(out, method);
+    out.push_back(kMap);
+    WriteSize(out, args.size());
+    for (const auto& kv : args) {
+      WriteString(out, kv.first);
+      WriteValue(out, kv.second);
+    }
+    return out;
+  }
+
+  static std::vector<uint8_t> EncodeSuccess(const CodecValue& v) {
+    std::vector<uint8_t> out{0};
+    WriteValue(out, v);
+    return out;
+  }
+
+  // Decoder over one message.
+  explicit StandardCodecModel(const std::vector<uint8_t>& bytes) : b_(bytes) {}
+
+  bool ReadCall(std::string* method, CodecMap* args) {
+    CodecValue m;
+    if (!ReadValue(&m) || !std::holds_alternative<std::string>(m)) return false;
+    *method = std::get<std::string>(m);
+    if (at_ >= b_.size() || b_[at_++] != kMap) return false;
+    size_t n = 0;
+    if (!ReadSize(&n)) return false;
+    for (size_t i = 0; i < n; i++) {
+      CodecValue k, v;
+      if (!ReadValue(&k) || !std::holds_alternative<std::string>(k) || !ReadValue(&v)) return false;
+      (*args)[std::get<std::string>(k)] = std::move(v);
+    }
+    return true;
+  }
+
+  bool ReadEnvelope(CodecValue* v) {
+    if (at_ >= b_.size() || b_[at_++] != 0) return false;
+    return ReadValue(v);
+  }
+
+ private:
+  bool ReadSize(size_t* n) {
+    if (at_ >= b_.size()) return false;
+    const uint8_t b = b_[at_++];
+    if (b < 254) {
+      *n = b;
+      return true;
+    }
+    const size_t width = b == 254 ? 2 : 4;
+    if (b_.size() - at_ < width) return false;
+    *n = 0;
+    for (size_t i = 0; i < width; i++) *n |= (size_t)b_[at_++] << (8 * i);
+    return true;
+  }
+
+  bool ReadValue(CodecValue* v) {
+    if (at_ >= b_.size()) return false;
+    switch (b_[at_++]) {
+      case kNull: *v = std::monostate{}; return true;
+      case kTrue: *v = true; return true;
+      case kFalse: *v = false; return true;
+      case kInt32: {
+        if (b_.size() - at_ < 4) return false;
+        int32_t i;
+        memcpy(&i, &b_[at_], 4);
+        at_ += 4;
+        *v = i;
+        return true;
+      }
+      case kFloat64: {
+        while (at_ % 8 != 0) at_++;
+        if (at_ > b_.size() || b_.size() - at_ < 8) return false;
+        double d;
+        memcpy(&d, &b_[at_], 8);
+        at_ += 8;
+        *v = d;
+        return true;
+      }
+      case kString: {
+        size_t n = 0;
+        if (!ReadSize(&n) || b_.size() - at_ < n) return false;
+        *v = std::string(reinterpret_cast<const char*>(&b_[at_]), n);
+        at_ += n;
+        return true;
+      }
+      default:
+        return false;
+    }
+  }
+
+  const std::vector<uint8_t>& b_;
+  size_t at_ = 0;
+};
+
+// The platform thread: method calls are handled there, one at a time.
+class PlatformThreadModel {
+ public:
+  PlatformThreadModel() : thread_([this] { Run(); }) {}
+  ~PlatformThreadModel() {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+  }
+
+  void Post(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+  }
+
+ private:
+  void Run() {
+    std::unique_lock<std::mutex> lock(mu_);
+    while (true) {
+      cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+      if (tasks_.empty()) return;
+      auto task = std::move(tasks_.front());
+      tasks_.pop_front();
+      lock.unlock();
+      task();
+      lock.lock();
+    }
+  }
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+// invokeMethod + await: encode, hop, decode, handle, encode the reply, hop
+// back, decode it. `handler` runs on the platform thread.
+class MethodChannelModel {
+ public:
+  using Handler = std::function<CodecValue(const std::string&, const CodecMap&)>;
+  explicit MethodChannelModel(Handler handler) : handler_(std::move(handler)) {}
+
+  CodecValue Invoke(const std::string& method, const CodecMap& args) {
+    std::vector<uint8_t> message = StandardCodecModel::EncodeCall(method, args);
+    std::vector<uint8_t> reply;
+    bool done = false;
+    std::mutex mu;
+    std::condition_variable cv;
+    platform_.Post([&] {
+      std::string m;
+      CodecMap a;
+      StandardCodecModel(message).ReadCall(&m, &a);
+      std::vector<uint8_t> r = StandardCodecModel::EncodeSuccess(handler_(m, a));
+      std::lock_guard<std::mutex> lock(mu);
+      reply = std::move(r);
+      done = true;
+      cv.notify_one();
+    });
+    std::unique_lock<std::mutex> lock(mu);
+    cv.wait(lock, [&] { return done; });
+    CodecValue result;
+    StandardCodecModel(reply).ReadEnvelope(&result);
+    return result;
+  }
+
+ private:
+  Handler handler_;
+  PlatformThreadModel platform_;
+};
+
+}  // namespace bench
+}  // namespace volumedeck_mixer
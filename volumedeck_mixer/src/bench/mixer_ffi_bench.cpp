@@ -0,0 +1,113 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "fake_mixer_backend.h"
+#include "method_channel_model.h"
+#include "mixer_fast_path.h"
+#include "state_channel.h"
+#include "volumedeck_mixer_ffi.h"
+
+namespace volumedeck_mixer {
+namespace bench {
+
+// A fader drag through each path, against the fake backend so only the
+// transport is measured. Sessions as a busy desktop has them.
+class MixerFixture {
+ public:
+  explicit MixerFixture(size_t sessions) {
+    writer_.Open();
+    std::vector<StateRosterEntry> roster{{"master", "", ""}};
+    for (size_t i = 0; i < sessions; i++) {
+      const std::string exe = "app" + std::to_string(i) + ".exe";
+      ids_.push_back(backend_.AddSession(exe, (uint32_t)(1000 + i)));
+      roster.push_back({ids_.back(), exe, ""});
+    }
+    writer_.PublishRoster(roster);
+    reader_.Attach(writer_.header(), writer_.size());
+    InstallMixerFastPath(&path_);
+  }
+  ~MixerFixture() { InstallMixerFastPath(nullptr); }
+
+  // What the plugin's setSessionVolume handler does with a decoded call.
+  CodecValue Handle(const std::string& method, const CodecMap& args) {
+    if (method != "setSessionVolume") return std::monostate{};
+    const auto id = args.find("sessionId");
+    const auto value = args.find("value");
+    if (id == args.end() || value == args.end()) return false;
+    return backend_.SetSessionVolume(std::get<std::string>(id->second), (float)std::get<double>(value->second));
+  }
+
+  FakeMixerBackend backend_;
+  StateChannelWriter writer_{128};
+  StateChannelReader reader_;
+  MixerFastPath path_{&backend_, &reader_};
+  std::vector<std::string> ids_;
+};
+
+static void BM_SetVolume_MethodChannel(benchmark::State& state) {
+  MixerFixture f(16);
+  MethodChannelModel channel([&](const std::string& m, const CodecMap& a) { return f.Handle(m, a); });
+  size_t i = 0;
+  for (auto _ : state) {
+    const CodecMap args{{"sessionId", f.ids_[i % f.ids_.size()]}, {"value", (double)(i % 100) / 100.0}};
+    benchmark::DoNotOptimize(channel.Invoke("setSessionVolume", args));
+    i++;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SetVolume_MethodChannel)->UseRealTime();
+
+static void BM_SetVolume_Ffi(benchmark::State& state) {
+  MixerFixture f(16);
+  const uint32_t gen = (uint32_t)f.writer_.generation();
+  uint32_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(VolumedeckMixerSetVolume(gen, 1 + i % 16, (float)(i % 100) / 100.0f));
+    i++;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SetVolume_Ffi)->UseRealTime();
+
+// Every slider of a board moved in one frame.
+static void BM_Batch_MethodChannel(benchmark::State& state) {
+  const size_t n = (size_t)state.range(0);
+  MixerFixture f(n);
+  MethodChannelModel channel([&](const std::string& m, const CodecMap& a) { return f.Handle(m, a); });
+  for (auto _ : state) {
+    for (size_t i = 0; i < n; i++) {
+      benchmark::DoNotOptimize(channel.Invoke("setSessionVolume", {{"sessionId", f.ids_[i]}, {"value", 0.5}}));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * (int64_t)n);
+}
+BENCHMARK(BM_Batch_MethodChannel)->Arg(16)->Arg(64)->UseRealTime();
+
+static void BM_Batch_Ffi(benchmark::State& state) {
+  const uint32_t n = (uint32_t)state.range(0);
+  MixerFixture f(n);
+  std::vector<VolumedeckMixerOp> ops(n);
+  const uint32_t gen = (uint32_t)f.writer_.generation();
+  for (uint32_t i = 0; i < n; i++) ops[i] = {gen, 1 + i, VOLUMEDECK_OP_VOLUME, 0.5f};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(VolumedeckMixerApplyBatch(ops.data(), n));
+  }
+  state.SetItemsProcessed(state.iterations() * (int64_t)n);
+}
+BENCHMARK(BM_Batch_Ffi)->Arg(16)->Arg(64)->UseRealTime();
+
+static void BM_ReadMeters_Ffi(benchmark::State& state) {
+  MixerFixture f(64);
+  std::vector<StateSlot> slots(65);
+  f.writer_.PublishFrame(slots.data(), slots.size());
+  std::vector<float> out(65 * VOLUMEDECK_METER_FIELDS);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(VolumedeckMixerReadMeters(out.data(), 65));
+  }
+}
+BENCHMARK(BM_ReadMeters_Ffi);
+
+}  // namespace bench
+}  // namespace volumedeck_mixer
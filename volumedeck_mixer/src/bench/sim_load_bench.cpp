@@ -0,0 +1,127 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "deck_engine.h"
+#include "latency_histogram.h"
+#include "sim_mixer_backend.h"
+#include "state_channel.h"
+
+namespace volumedeck_mixer {
+namespace bench {
+
+// Load tests against the simulation backend: how the slider pipeline and
+// the state channel hold up with hundreds of churning sessions and a slow
+// mixer. Besides time per iteration each reports p50/p99/p99.9 latency.
+
+namespace {
+
+class NullInput : public SliderInput {
+ public:
+  bool Open() override { return false; }
+  void Close() override {}
+  long Read(char*, size_t, int) override { return -1; }
+  long Write(const char*, size_t) override { return -1; }
+  std::string description() const override { return "null"; }
+};
+
+SimMixerConfig LoadConfig(benchmark::State& state) {
+  SimMixerConfig c;
+  c.sessions = (size_t)state.range(0);
+  c.call_latency = {(double)state.range(1), (double)state.range(1) * 10.0};
+  c.churn_per_second = 20.0;
+  c.failure_rate = 0.001;
+  c.realtime = false;  // churn by simulated frame time, independent of how slow the run is
+  return c;
+}
+
+void ReportPercentiles(benchmark::State& state, const LatencyHistogram& h) {
+  state.counters["p50_us"] = (double)h.Percentile(50) / 1e3;
+  state.counters["p99_us"] = (double)h.Percentile(99) / 1e3;
+  state.counters["p999_us"] = (double)h.Percentile(99.9) / 1e3;
+}
+
+// A noisy six-slider board: every line moves every slider.
+std::vector<std::string> BoardLines(size_t count) {
+  std::mt19937 rng(5);
+  std::vector<std::string> lines;
+  for (size_t i = 0; i < count; i++) {
+    std::string line;
+    for (int s = 0; s < 6; s++) line += (s ? "|" : "") + std::to_string(rng() % 1024);
+    lines.push_back(line + "\n");
+  }
+  return lines;
+}
+
+}  // namespace
+
+static void BM_Sim_ListSessions(benchmark::State& state) {
+  SimMixerConfig c;
+  c.sessions = (size_t)state.range(0);
+  c.realtime = false;
+  SimMixerBackend sim(c);
+  std::vector<AudioSession> out;
+  for (auto _ : state) {
+    sim.ListSessions(&out);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * (int64_t)out.size());
+}
+BENCHMARK(BM_Sim_ListSessions)->Arg(50)->Arg(500)->Arg(2000);
+
+// One board line through filter, mapping and mixer writes, against churn
+// and per-call latency (args: sessions, median call latency in us).
+static void BM_Sim_EngineLine(benchmark::State& state) {
+  SimMixerBackend sim(LoadConfig(state));
+  DeejConfig cfg;
+  cfg.slider_mapping = {{0, {"master"}},      {1, {"chrome.exe", "msedge.exe"}},
+                        {2, {"discord.exe"}}, {3, {"spotify.exe"}},
+                        {4, {"steamwebhelper.exe", "cs2.exe"}}, {5, {"deej.unmapped"}}};
+  DeckEngine engine(&sim, std::make_unique<NullInput>(), cfg);
+  const std::vector<std::string> lines = BoardLines(1024);
+  LatencyHistogram h;
+  size_t i = 0;
+  for (auto _ : state) {
+    sim.Advance(0.01);  // 100 lines per simulated second
+    const std::string& line = lines[i++ & 1023];
+    const auto t0 = std::chrono::steady_clock::now();
+    engine.ProcessBytes(line.data(), line.size());
+    h.Record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0)
+                 .count());
+  }
+  const DeckEngineStats st = engine.stats();
+  state.SetItemsProcessed((int64_t)st.lines);
+  state.counters["writes_per_line"] = st.lines ? (double)st.writes / (double)st.lines : 0.0;
+  ReportPercentiles(state, h);
+}
+BENCHMARK(BM_Sim_EngineLine)->Args({50, 0})->Args({500, 0})->Args({500, 20})->Args({2000, 0})->UseRealTime();
+
+// UI state publish (list, roster diff, seqlock frame) with churn.
+static void BM_Sim_PublishState(benchmark::State& state) {
+  SimMixerBackend sim(LoadConfig(state));
+  DeckEngine engine(&sim, std::make_unique<NullInput>(), DeejConfig());
+  StateChannelWriter channel(4096, 1 << 20);
+  if (!channel.Open()) {
+    state.SkipWithError("state channel");
+    return;
+  }
+  engine.SetStateChannel(&channel);
+  LatencyHistogram h;
+  for (auto _ : state) {
+    sim.Advance(1.0 / 30.0);
+    const auto t0 = std::chrono::steady_clock::now();
+    engine.PublishState();
+    h.Record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0)
+                 .count());
+  }
+  state.counters["roster_generation"] = (double)channel.generation();
+  ReportPercentiles(state, h);
+}
+BENCHMARK(BM_Sim_PublishState)->Args({50, 0})->Args({500, 0})->Args({2000, 0})->UseRealTime();
+
+}  // namespace bench
+}  // namespace volumedeck_mixer
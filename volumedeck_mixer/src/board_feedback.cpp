@@ -0,0 +1,138 @@
+#include "board_feedback.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        // Bytes the budget may save up: a tenth of a second's worth, but
+        // always room for a line of a few channels.
+        constexpr double kBurstSeconds = 0.1;
+        constexpr double kMinBurst = 32.0;
+
+        char Prefix(ChannelKind kind) {
+            switch (kind) {
+                case ChannelKind::kEncoder: return 'r';
+                case ChannelKind::kButton: return 'm';
+                default: return 'f';
+            }
+        }
+
+    }  // namespace
+
+    void BoardFeedback::SetBaud(int baud) {
+        bytes_per_second_ = (float)std::max(baud, 300) / 10.0f * options_.link_share;
+    }
+
+    std::vector<BoardFeedback::Channel>& BoardFeedback::ChannelsOf(ChannelKind kind) {
+        switch (kind) {
+            case ChannelKind::kEncoder: return rings_;
+            case ChannelKind::kButton: return leds_;
+            default: return faders_;
+        }
+    }
+
+    bool BoardFeedback::Dirty(ChannelKind kind, const Channel& c) const {
+        if (c.wanted < 0) return false;
+        if (c.sent < 0) return true;
+        if (kind == ChannelKind::kButton) return c.wanted != c.sent;
+        return std::abs(c.wanted - c.sent) >= options_.deadband;
+    }
+
+    void BoardFeedback::Set(ChannelKind kind, size_t index, uint16_t value, Clock::time_point now) {
+        std::vector<Channel>& channels = ChannelsOf(kind);
+        if (index >= channels.size()) channels.resize(index + 1);
+        Channel& c = channels[index];
+        const bool was_dirty = Dirty(kind, c);
+        c.wanted = value;
+        if (!was_dirty && Dirty(kind, c)) c.dirty_since = now;
+    }
+
+    void BoardFeedback::NoteMove(size_t slider, uint16_t raw, Clock::time_point now) {
+        if (slider >= faders_.size()) faders_.resize(slider + 1);
+        Channel& c = faders_[slider];
+        c.sent = raw;
+        c.held_until = now + options_.hold_after_move;
+        c.echo_until = {};
+    }
+
+    bool BoardFeedback::IsEcho(size_t slider, uint16_t raw, Clock::time_point now, uint16_t* commanded) {
+        if (slider >= faders_.size()) return false;
+        Channel& c = faders_[slider];
+        if (now >= c.echo_until) return false;
+        if (raw + options_.echo_tolerance < c.echo_low || raw > c.echo_high + options_.echo_tolerance) {
+            c.echo_until = {};  // off the motor's path: a hand took over
+            return false;
+        }
+        *commanded = (uint16_t)c.sent;
+        stats_.echoes++;
+        return true;
+    }
+
+    void BoardFeedback::Flush(Clock::time_point now, std::string* out, std::vector<std::pair<size_t, uint16_t>>* faders) {
+        out->clear();
+        const double burst = std::max((double)bytes_per_second_ * kBurstSeconds, kMinBurst);
+        if (refilled_ == Clock::time_point{}) {
+            budget_ = burst;
+        } else {
+            budget_ = std::min(budget_ + std::chrono::duration<double>(now - refilled_).count() * bytes_per_second_, burst);
+        }
+        refilled_ = now;
+
+        const auto min_gap = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(1.0 / std::max(options_.channel_rate, 0.01f)));
+        due_.clear();
+        for (ChannelKind kind : {ChannelKind::kSlider, ChannelKind::kEncoder, ChannelKind::kButton}) {
+            const std::vector<Channel>& channels = ChannelsOf(kind);
+            for (size_t i = 0; i < channels.size(); i++) {
+                const Channel& c = channels[i];
+                if (!Dirty(kind, c) || now < c.held_until || now - c.last_sent < min_gap) continue;
+                due_.push_back({kind, i, c.dirty_since});
+            }
+        }
+        if (due_.empty()) return;
+        std::stable_sort(due_.begin(), due_.end(), [](const Due& a, const Due& b) { return a.since < b.since; });
+
+        char token[16];
+        for (const Due& d : due_) {
+            Channel& c = ChannelsOf(d.kind)[d.index];
+            const int n = snprintf(token, sizeof(token), "%s%c%zu=%d", out->empty() ? "" : "|", Prefix(d.kind),
+                                   d.index, c.wanted);
+            // +1 for the newline that ends the line.
+            if ((double)(out->size() + (size_t)n + 1) > budget_) {
+                stats_.deferred++;
+                break;
+            }
+            out->append(token, (size_t)n);
+            if (d.kind == ChannelKind::kSlider) {
+                // The motor travels from where the fader was to the new spot;
+                // if it hadn't got to the last one yet, it is still on that path.
+                const int from = c.sent < 0 ? c.wanted : c.sent;
+                const bool moving = now < c.echo_until;
+                c.echo_low = (uint16_t)std::min({from, c.wanted, moving ? (int)c.echo_low : from});
+                c.echo_high = (uint16_t)std::max({from, c.wanted, moving ? (int)c.echo_high : from});
+                c.echo_until = now + options_.echo_window;
+                faders->emplace_back(d.index, (uint16_t)c.wanted);
+            }
+            c.sent = c.wanted;
+            c.last_sent = now;
+            stats_.updates++;
+        }
+        if (out->empty()) return;
+        out->push_back('\n');
+        budget_ -= (double)out->size();
+        stats_.bytes += out->size();
+    }
+
+    void BoardFeedback::Resend() {
+        for (auto* channels : {&faders_, &rings_, &leds_}) {
+            for (Channel& c : *channels) c.sent = -1;
+        }
+    }
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "deej_protocol.h"
+
+namespace volumedeck_mixer {
+
+    struct FeedbackOptions {
+        // Share of the link's bytes/s (8N1: baud / 10) feedback may take, so
+        // it never starves a board that also has to send its readings.
+        float link_share = 0.5f;
+        // Per channel: a fader being dragged in the Windows mixer is sent at
+        // most this often, its latest position each time.
+        float channel_rate = 10.0f;
+        // Fader and ring changes smaller than this (0..1023) aren't sent.
+        uint16_t deadband = 8;
+        // After a hand moves a fader the board has the say over it this long.
+        std::chrono::milliseconds hold_after_move{300};
+        // After a fader is sent somewhere, readings along its way there are
+        // the motor, not a hand, for up to this long.
+        std::chrono::milliseconds echo_window{500};
+        uint16_t echo_tolerance = 16;
+    };
+
+    struct FeedbackStats {
+        uint64_t bytes = 0;     // written to the board
+        uint64_t updates = 0;   // channel values in them
+        uint64_t deferred = 0;  // flushes cut short by the byte budget
+        uint64_t echoes = 0;    // fader readings taken for the motor
+    };
+
+    // What a motor-fader / LED board should show, sent as deltas (see the
+    // feedback lines in deej_protocol.h). The engine sets every channel's
+    // wanted value each tick; Flush() sends the ones that changed enough,
+    // oldest change first, within a byte budget for the whole link and a
+    // rate limit per channel. Echo is suppressed both ways: a fader a hand
+    // just moved isn't sent back, and the readings of a fader the motor is
+    // moving aren't taken as moves.
+    class BoardFeedback {
+    public:
+        explicit BoardFeedback(const FeedbackOptions& options = FeedbackOptions()) : options_(options) {}
+
+        void SetBaud(int baud);
+
+        // What the board should show now: 0..1023 for faders and rings, 0/1
+        // for mute LEDs.
+        void Set(ChannelKind kind, size_t index, uint16_t value, std::chrono::steady_clock::time_point now);
+        // A hand moved the fader to `raw`: the board already shows it.
+        void NoteMove(size_t slider, uint16_t raw, std::chrono::steady_clock::time_point now);
+        // True if this reading is the motor on its way to a sent position,
+        // which goes in `commanded`: the engine takes that instead.
+        bool IsEcho(size_t slider, uint16_t raw, std::chrono::steady_clock::time_point now, uint16_t* commanded);
+
+        // Encodes what is due and fits into one line (empty if nothing).
+        // Faders sent are appended to `faders` as (slider, position).
+        void Flush(std::chrono::steady_clock::time_point now, std::string* out,
+                   std::vector<std::pair<size_t, uint16_t>>* faders);
+        // The last line didn't reach the board: send everything again.
+        void Resend();
+
+        const FeedbackStats& stats() const { return stats_; }
+
+    private:
+        struct Channel {
+            int wanted = -1;  // -1: nothing to show
+            int sent = -1;    // what the board shows, as far as we know
+            std::chrono::steady_clock::time_point dirty_since{};
+            std::chrono::steady_clock::time_point last_sent{};
+            std::chrono::steady_clock::time_point held_until{};
+            // Faders: the motor's path after a send.
+            std::chrono::steady_clock::time_point echo_until{};
+            uint16_t echo_low = 0;
+            uint16_t echo_high = 0;
+        };
+        struct Due {
+            ChannelKind kind;
+            size_t index;
+            std::chrono::steady_clock::time_point since;
+        };
+
+        std::vector<Channel>& ChannelsOf(ChannelKind kind);
+        bool Dirty(ChannelKind kind, const Channel& c) const;
+
+        FeedbackOptions options_;
+        float bytes_per_second_ = 480.0f;  // 9600 baud at half the link
+        double budget_ = 0.0;              // bytes we may send now
+        std::chrono::steady_clock::time_point refilled_{};
+        std::vector<Channel> faders_;
+        std::vector<Channel> rings_;
+        std::vector<Channel> leds_;
+        std::vector<Due> due_;
+        FeedbackStats stats_;
+    };
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,184 @@
+#include "capture_source.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#include "file_util.h"
+
+namespace volumedeck_mixer {
+
+    // ---------- synthetic ----------
+
+    SyntheticCaptureSource::SyntheticCaptureSource(CaptureFormat format, Generator generate,
+                                                   uint64_t total_frames, bool realtime)
+        : format_(format), generate_(std::move(generate)), total_frames_(total_frames), realtime_(realtime) {}
+
+    bool SyntheticCaptureSource::Open(CaptureFormat* format) {
+        if (format_.sample_rate <= 0 || format_.channels <= 0 || !generate_) return false;
+        *format = format_;
+        position_ = 0;
+        started_ = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    CaptureStatus SyntheticCaptureSource::Read(float* interleaved, size_t max_frames, size_t* frames) {
+        *frames = 0;
+        uint64_t available = max_frames;
+        if (total_frames_ != 0) {
+            if (position_ >= total_frames_) return CaptureStatus::kEnd;
+            available = std::min<uint64_t>(available, total_frames_ - position_);
+        }
+        if (realtime_) {
+            // Hand out what a device would have captured by now, in 10 ms steps.
+            const auto elapsed = std::chrono::steady_clock::now() - started_;
+            const uint64_t due = (uint64_t)(std::chrono::duration<double>(elapsed).count() * format_.sample_rate);
+            if (due <= position_) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                return CaptureStatus::kOk;
+            }
+            available = std::min<uint64_t>(available, due - position_);
+        }
+        generate_(interleaved, (size_t)available, position_);
+        position_ += available;
+        *frames = (size_t)available;
+        return CaptureStatus::kOk;
+    }
+
+    SyntheticCaptureSource::Generator SyntheticCaptureSource::Sine(CaptureFormat format, double hz, double dbfs) {
+        const double amplitude = std::pow(10.0, dbfs / 20.0);
+        const double step = 2.0 * 3.14159265358979323846 * hz / format.sample_rate;
+        const int channels = format.channels;
+        return [=](float* out, size_t frames, uint64_t first) {
+            for (size_t i = 0; i < frames; i++) {
+                // Phase from the absolute frame index: no drift over hours.
+                const float v = (float)(amplitude * std::sin(step * (double)(first + i)));
+                for (int c = 0; c < channels; c++) out[i * channels + c] = v;
+            }
+        };
+    }
+
+    // ---------- WAV ----------
+
+    namespace {
+
+        uint16_t Le16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+        uint32_t Le32(const uint8_t* p) {
+            return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        }
+
+        constexpr uint16_t kWavePcm = 1;
+        constexpr uint16_t kWaveFloat = 3;
+        constexpr uint16_t kWaveExtensible = 0xFFFE;
+
+    }  // namespace
+
+    bool WavFileCaptureSource::Open(CaptureFormat* format) {
+        Close();
+        if (!file_.Open(path_)) return false;
+        const uint8_t* p = file_.data();
+        const size_t size = file_.size();
+        if (size < 12 || memcmp(p, "RIFF", 4) != 0 || memcmp(p + 8, "WAVE", 4) != 0) {
+            Close();
+            return false;
+        }
+
+        uint16_t tag = 0, channels = 0, bits = 0;
+        uint32_t rate = 0;
+        bool have_fmt = false;
+        size_t at = 12;
+        while (at + 8 <= size) {
+            const uint32_t len = Le32(p + at + 4);
+            const size_t body = at + 8;
+            if (len > size - body) break;
+            if (memcmp(p + at, "fmt ", 4) == 0 && len >= 16) {
+                tag = Le16(p + body);
+                channels = Le16(p + body + 2);
+                rate = Le32(p + body + 4);
+                bits = Le16(p + body + 14);
+                // WAVEFORMATEXTENSIBLE: the real tag is the first two bytes
+                // of the subformat GUID.
+                if (tag == kWaveExtensible && len >= 40) tag = Le16(p + body + 24);
+                have_fmt = true;
+            } else if (memcmp(p + at, "data", 4) == 0 && have_fmt) {
+                const bool is_float = tag == kWaveFloat && bits == 32;
+                const bool is_pcm = tag == kWavePcm && (bits == 16 || bits == 24 || bits == 32);
+                if ((!is_float && !is_pcm) || channels == 0 || rate == 0) break;
+                channels_ = channels;
+                bytes_per_sample_ = bits / 8;
+                float_ = is_float;
+                data_ = p + body;
+                total_frames_ = len / ((uint64_t)channels_ * bytes_per_sample_);
+                position_ = 0;
+                format->sample_rate = (int)rate;
+                format->channels = channels_;
+                return true;
+            }
+            at = body + len + (len & 1);  // chunks are word aligned
+        }
+        Close();
+        return false;
+    }
+
+    void WavFileCaptureSource::Close() {
+        file_.Close();
+        data_ = nullptr;
+        total_frames_ = position_ = 0;
+    }
+
+    CaptureStatus WavFileCaptureSource::Read(float* out, size_t max_frames, size_t* frames) {
+        *frames = 0;
+        if (!data_) return CaptureStatus::kError;
+        if (position_ >= total_frames_) return CaptureStatus::kEnd;
+        const size_t n = (size_t)std::min<uint64_t>(max_frames, total_frames_ - position_);
+        const size_t samples = n * channels_;
+        const uint8_t* src = data_ + position_ * channels_ * bytes_per_sample_;
+        for (size_t i = 0; i < samples; i++, src += bytes_per_sample_) {
+            if (float_) {
+                float v;
+                memcpy(&v, src, 4);
+                out[i] = v;
+            } else if (bytes_per_sample_ == 2) {
+                out[i] = (float)(int16_t)Le16(src) / 32768.0f;
+            } else if (bytes_per_sample_ == 3) {
+                const int32_t v = (int32_t)((uint32_t)src[0] << 8 | (uint32_t)src[1] << 16 | (uint32_t)src[2] << 24);
+                out[i] = (float)(v / 256) / 8388608.0f;
+            } else {
+                out[i] = (float)((double)(int32_t)Le32(src) / 2147483648.0);
+            }
+        }
+        position_ += n;
+        *frames = n;
+        return CaptureStatus::kOk;
+    }
+
+    bool WriteWavFile(const std::string& path, const CaptureFormat& format, const float* interleaved,
+                      size_t frames) {
+        const uint32_t data_bytes = (uint32_t)(frames * format.channels * sizeof(float));
+        std::vector<uint8_t> out(44 + (size_t)data_bytes);
+        auto put16 = [&](size_t at, uint32_t v) {
+            out[at] = (uint8_t)v;
+            out[at + 1] = (uint8_t)(v >> 8);
+        };
+        auto put32 = [&](size_t at, uint32_t v) {
+            put16(at, v & 0xFFFF);
+            put16(at + 2, v >> 16);
+        };
+        memcpy(&out[0], "RIFF", 4);
+        put32(4, 36 + data_bytes);
+        memcpy(&out[8], "WAVEfmt ", 8);
+        put32(16, 16);
+        put16(20, kWaveFloat);
+        put16(22, (uint32_t)format.channels);
+        put32(24, (uint32_t)format.sample_rate);
+        put32(28, (uint32_t)(format.sample_rate * format.channels * 4));
+        put16(32, (uint32_t)(format.channels * 4));
+        put16(34, 32);
+        memcpy(&out[36], "data", 4);
+        put32(40, data_bytes);
+        if (data_bytes) memcpy(&out[44], interleaved, data_bytes);  // little endian hosts only
+        return WriteFileAtomic(path, out.data(), out.size());
+    }
+
+}  // namespace volumedeck_mixer
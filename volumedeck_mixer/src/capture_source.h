@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+
+namespace volumedeck_mixer {
+
+    struct CaptureFormat {
+        int sample_rate = 48000;
+        int channels = 2;
+    };
+
+    enum class CaptureStatus {
+        kOk,     // `frames` may be 0 if nothing arrived in time
+        kEnd,    // finite source exhausted
+        kError,  // device lost; Close() and Open() again to recover
+    };
+
+    // Where loudness measurement gets its audio: WASAPI loopback on Windows,
+    // files and generated signals in tests and benchmarks. Samples are
+    // interleaved float32 in [-1, 1].
+    //
+    // Open/Read/Close are called from one thread (the monitor's), so a
+    // source may keep thread-affine state such as COM objects.
+    class CaptureSource {
+    public:
+        virtual ~CaptureSource() = default;
+
+        virtual bool Open(CaptureFormat* format) = 0;
+        virtual void Close() {}
+
+        // Copies up to `max_frames` frames. Live sources wait a few ms for
+        // data rather than returning 0 in a tight loop.
+        virtual CaptureStatus Read(float* interleaved, size_t max_frames, size_t* frames) = 0;
+    };
+
+    // Signal generator source. `generate(out, frames, first_frame)` fills
+    // interleaved samples. With `realtime` the source paces itself to the
+    // wall clock like a device would; otherwise it returns data as fast as
+    // it is read. `total_frames == 0` means endless.
+    class SyntheticCaptureSource : public CaptureSource {
+    public:
+        using Generator = std::function<void(float* interleaved, size_t frames, uint64_t first_frame)>;
+
+        SyntheticCaptureSource(CaptureFormat format, Generator generate, uint64_t total_frames = 0,
+                               bool realtime = false);
+
+        bool Open(CaptureFormat* format) override;
+        CaptureStatus Read(float* interleaved, size_t max_frames, size_t* frames) override;
+
+        // Sine on every channel at `dbfs` peak level.
+        static Generator Sine(CaptureFormat format, double hz, double dbfs);
+
+    private:
+        const CaptureFormat format_;
+        const Generator generate_;
+        const uint64_t total_frames_;
+        const bool realtime_;
+        uint64_t position_ = 0;
+        std::chrono::steady_clock::time_point started_{};
+    };
+
+    // RIFF/WAVE file: PCM 16/24/32-bit or IEEE float, any channel count.
+    class WavFileCaptureSource : public CaptureSource {
+    public:
+        explicit WavFileCaptureSource(std::string path) : path_(std::move(path)) {}
+
+        bool Open(CaptureFormat* format) override;
+        void Close() override;
+        CaptureStatus Read(float* interleaved, size_t max_frames, size_t* frames) override;
+
+    private:
+        const std::string path_;
+        MappedFile file_;
+        const uint8_t* data_ = nullptr;
+        uint64_t total_frames_ = 0;
+        uint64_t position_ = 0;
+        int channels_ = 0;
+        int bytes_per_sample_ = 0;
+        bool float_ = false;
+    };
+
+    // Writes interleaved float samples as a 32-bit float WAV file.
+    bool WriteWavFile(const std::string& path, const CaptureFormat& format, const float* interleaved,
+                      size_t frames);
+
+}  // namespace volumedeck_mixer
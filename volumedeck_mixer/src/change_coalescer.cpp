@@ -0,0 +1,151 @@
+#include "change_coalescer.h"
+
+#include <cstring>
+#include <thread>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "hash.h"
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        size_t RoundUp(size_t n) {
+            size_t p = 64;
+            while (p < n) p <<= 1;
+            return p;
+        }
+
+        size_t LowestBit(uint64_t bits) {
+#ifdef _MSC_VER
+            unsigned long i;
+            _BitScanForward64(&i, bits);
+            return i;
+#else
+            return (size_t)__builtin_ctzll(bits);
+#endif
+        }
+
+        uint64_t Pack(float volume, bool mute) {
+            uint32_t bits;
+            std::memcpy(&bits, &volume, sizeof(bits));
+            return (uint64_t)bits << 32 | (mute ? 1u : 0u);
+        }
+
+        void Unpack(uint64_t state, CoalescedChange* c) {
+            const uint32_t bits = (uint32_t)(state >> 32);
+            std::memcpy(&c->volume, &bits, sizeof(bits));
+            c->mute = (state & 1) != 0;
+        }
+
+    }  // namespace
+
+    ChangeCoalescer::ChangeCoalescer(size_t capacity, Clock::duration frame)
+        : capacity_(RoundUp(capacity)),
+          frame_(frame),
+          slots_(new Slot[capacity_]),
+          dirty_(new std::atomic<uint64_t>[capacity_ / 64]) {
+        for (size_t i = 0; i < capacity_ / 64; i++) dirty_[i].store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t ChangeCoalescer::Key(const std::string& id) {
+        const uint64_t h = Fnv1a64(id);
+        return h ? h : 1;
+    }
+
+    ChangeCoalescer::Slot* ChangeCoalescer::Find(uint64_t key) {
+        const size_t mask = capacity_ - 1;
+        for (size_t i = 0, at = (size_t)key & mask; i < capacity_; i++, at = (at + 1) & mask) {
+            Slot& s = slots_[at];
+            uint64_t k = s.key.load(std::memory_order_acquire);
+            if (k == 0 && s.key.compare_exchange_strong(k, key, std::memory_order_acq_rel)) return &s;
+            if (k == key) return &s;
+        }
+        return nullptr;
+    }
+
+    void ChangeCoalescer::Signal() {
+        // Once per take: everyone after the first finds it already set.
+        if (signaled_.exchange(true, std::memory_order_acq_rel)) return;
+        std::lock_guard<std::mutex> lock(mu_);
+        cv_.notify_one();
+    }
+
+    void ChangeCoalescer::Post(const MixerChange& change) {
+        posts_.fetch_add(1, std::memory_order_relaxed);
+        Slot* s = Find(Key(change.id));
+        if (!s) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            resync_.store(true, std::memory_order_release);
+            Signal();
+            return;
+        }
+        s->state.store(Pack(change.volume, change.mute), std::memory_order_relaxed);
+        // Release: whoever clears the bit sees this state or a later one.
+        const size_t at = (size_t)(s - slots_.get());
+        dirty_[at / 64].fetch_or(uint64_t(1) << (at % 64), std::memory_order_release);
+        Signal();
+    }
+
+    bool ChangeCoalescer::Take(std::vector<CoalescedChange>* out, bool* resync) {
+        out->clear();
+        // Cleared first: a post racing the sweep below signals again, at
+        // worst for a take that finds its bit already gone.
+        signaled_.store(false, std::memory_order_seq_cst);
+        *resync = resync_.exchange(false, std::memory_order_acq_rel);
+        for (size_t w = 0; w < capacity_ / 64; w++) {
+            if (dirty_[w].load(std::memory_order_relaxed) == 0) continue;
+            uint64_t bits = dirty_[w].exchange(0, std::memory_order_acquire);
+            while (bits) {
+                const size_t at = w * 64 + LowestBit(bits);
+                bits &= bits - 1;
+                CoalescedChange c;
+                c.key = slots_[at].key.load(std::memory_order_relaxed);
+                Unpack(slots_[at].state.load(std::memory_order_relaxed), &c);
+                out->push_back(c);
+            }
+        }
+        if (out->empty() && !*resync) return false;
+        takes_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool ChangeCoalescer::Wait(std::chrono::milliseconds timeout, std::vector<CoalescedChange>* out, bool* resync) {
+        const auto deadline = Clock::now() + timeout;
+        for (;;) {
+            bool woken;
+            {
+                std::unique_lock<std::mutex> lock(mu_);
+                woken = cv_.wait_until(lock, deadline, [this] { return closed_ || signaled_.load(); }) && !closed_;
+            }
+            if (!woken) {
+                out->clear();
+                *resync = false;
+                return false;
+            }
+            // Let the rest of the storm land before taking; if that is past
+            // the deadline, it waits for the next call.
+            const auto due = last_wake_ + frame_;
+            if (due > deadline) {
+                std::this_thread::sleep_until(deadline);
+                out->clear();
+                *resync = false;
+                return false;
+            }
+            std::this_thread::sleep_until(due);
+            last_wake_ = Clock::now();
+            if (Take(out, resync)) return true;
+            if (Clock::now() >= deadline) return false;
+        }
+    }
+
+    void ChangeCoalescer::Close() {
+        std::lock_guard<std::mutex> lock(mu_);
+        closed_ = true;
+        cv_.notify_all();
+    }
+
+}  // namespace volumedeck_mixer
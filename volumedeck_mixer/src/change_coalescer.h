@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "mixer_backend.h"
+
+namespace volumedeck_mixer {
+
+    // One target's merged state, as a consumer takes it.
+    struct CoalescedChange {
+        uint64_t key;  // ChangeCoalescer::Key(id)
+        float volume;
+        bool mute;
+    };
+
+    // Folds storms of mixer change notifications into per-slot dirty bits.
+    // A fader sweep in another app fires hundreds of callbacks a second, on
+    // whatever thread the OS picks; the consumer (state publish, board
+    // feedback) only wants the latest state of each target that changed,
+    // once per frame.
+    //
+    // Post() is lock-free: it finds the id's slot in an open-addressed
+    // table of hashed ids, stores the state in one atomic word and sets the
+    // slot's dirty bit. Only the first post after a take touches the wake
+    // mutex. Slots are never freed; ids beyond `capacity` are dropped and
+    // the next take asks for a full re-read instead.
+    class ChangeCoalescer {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit ChangeCoalescer(size_t capacity = 1024,
+                                 Clock::duration frame = std::chrono::microseconds(33333));
+
+        ChangeCoalescer(const ChangeCoalescer&) = delete;
+        ChangeCoalescer& operator=(const ChangeCoalescer&) = delete;
+
+        // What CoalescedChange::key holds for `id` (empty: master).
+        static uint64_t Key(const std::string& id);
+
+        // Any thread.
+        void Post(const MixerChange& change);
+
+        // Consumer side; one consumer at a time. Replaces `out` with the
+        // targets changed since the last take. `resync` is set if some
+        // change was dropped, when everything should be re-read. False if
+        // there was nothing.
+        bool Take(std::vector<CoalescedChange>* out, bool* resync);
+
+        // Take(), blocking until there is something, at most `timeout`.
+        // Never returns sooner than a frame after its last wake, so posts
+        // arriving meanwhile are merged into one.
+        bool Wait(std::chrono::milliseconds timeout, std::vector<CoalescedChange>* out, bool* resync);
+
+        // Wakes Wait() for good.
+        void Close();
+
+        uint64_t posts() const { return posts_.load(std::memory_order_relaxed); }
+        uint64_t takes() const { return takes_.load(std::memory_order_relaxed); }
+        uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+        struct Slot {
+            std::atomic<uint64_t> key{0};    // 0: free
+            std::atomic<uint64_t> state{0};  // float bits << 32 | mute
+        };
+
+        Slot* Find(uint64_t key);
+        void Signal();
+
+        const size_t capacity_;  // power of two
+        const Clock::duration frame_;
+        std::unique_ptr<Slot[]> slots_;
+        std::unique_ptr<std::atomic<uint64_t>[]> dirty_;  // a bit per slot
+        std::atomic<bool> resync_{false};
+        std::atomic<bool> signaled_{false};
+
+        std::mutex mu_;
+        std::condition_variable cv_;
+        bool closed_ = false;
+        Clock::time_point last_wake_{};  // consumer only
+
+        std::atomic<uint64_t> posts_{0};
+        std::atomic<uint64_t> takes_{0};
+        std::atomic<uint64_t> dropped_{0};
+    };
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,278 @@
+#include "config_watcher.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include "file_util.h"
+#elif defined(__linux__)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <cerrno>
+#else
+#include "file_util.h"
+#endif
+
+#include <algorithm>
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        // Keep reading a file that is rewritten non-stop, at a bounded rate.
+        constexpr int kMaxSettleFactor = 10;
+
+        // "dir/config.yaml" -> {"dir", "config.yaml"}; a bare name is in ".".
+        void SplitPath(const std::string& path, std::string* dir, std::string* name) {
+#ifdef _WIN32
+            const size_t slash = path.find_last_of("/\\");
+#else
+            const size_t slash = path.rfind('/');
+#endif
+            if (slash == std::string::npos) {
+                *dir = ".";
+                *name = path;
+            } else {
+                *dir = slash == 0 ? path.substr(0, 1) : path.substr(0, slash);
+                *name = path.substr(slash + 1);
+            }
+        }
+
+#ifdef _WIN32
+        bool Arm(HANDLE dir, OVERLAPPED* ov, void* buffer, DWORD size) {
+            ResetEvent(ov->hEvent);
+            return ReadDirectoryChangesW(dir, buffer, size, FALSE,
+                                         FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE |
+                                                 FILE_NOTIFY_CHANGE_SIZE,
+                                         nullptr, ov, nullptr) != FALSE;
+        }
+#endif
+
+    }  // namespace
+
+    ConfigWatcher::ConfigWatcher(std::string path, Callback callback, std::chrono::milliseconds settle)
+        : path_(std::move(path)), callback_(std::move(callback)), settle_(settle) {}
+
+    ConfigWatcher::~ConfigWatcher() { Stop(); }
+
+    DeejConfig ConfigWatcher::config() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return config_;
+    }
+
+    ConfigWatcherStats ConfigWatcher::stats() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return stats_;
+    }
+
+    bool ConfigWatcher::Start(std::string* error) {
+        if (thread_.joinable()) return true;
+        {
+            DeejConfig initial;
+            if (!LoadDeejConfig(path_, &initial)) initial = DeejConfig();
+            std::lock_guard<std::mutex> lock(mu_);
+            config_ = std::move(initial);
+        }
+
+        std::string dir, name;
+        SplitPath(path_, &dir, &name);
+        auto fail = [&](const std::string& what) {
+            if (error) *error = what + " " + dir;
+            Stop();
+            return false;
+        };
+
+#ifdef _WIN32
+        name_ = Utf8ToWide(name);
+        HANDLE h = CreateFileW(Utf8ToWide(dir).c_str(), FILE_LIST_DIRECTORY,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                               FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+        if (h == INVALID_HANDLE_VALUE) return fail("cannot open");
+        dir_ = h;
+        event_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        stop_event_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!event_ || !stop_event_) return fail("cannot create events for");
+        auto* ov = new OVERLAPPED{};
+        ov->hEvent = event_;
+        overlapped_ = ov;
+        // Armed before returning so a save right after Start() is seen.
+        if (!Arm(dir_, ov, buffer_, sizeof(buffer_))) return fail("cannot watch");
+#elif defined(__linux__)
+        name_ = name;
+        inotify_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_ < 0) return fail("inotify unavailable for");
+        // Written in place (CLOSE_WRITE) or renamed over (MOVED_TO).
+        if (inotify_add_watch(inotify_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) return fail("cannot watch");
+        if (pipe2(wake_, O_CLOEXEC | O_NONBLOCK) != 0) return fail("cannot create a pipe for");
+#else
+        stop_.store(false);
+        if (!StatFile(path_, &size_, &mtime_)) size_ = 0, mtime_ = 0;
+#endif
+
+        thread_ = std::thread([this] { ThreadLoop(); });
+        return true;
+    }
+
+    void ConfigWatcher::Stop() {
+#ifdef _WIN32
+        if (thread_.joinable()) {
+            SetEvent(stop_event_);
+            thread_.join();
+        }
+        if (overlapped_) {
+            auto* ov = static_cast<OVERLAPPED*>(overlapped_);
+            DWORD bytes = 0;
+            // The kernel owns the buffer until the read is really gone.
+            if (CancelIoEx(dir_, ov) || GetLastError() != ERROR_NOT_FOUND) {
+                GetOverlappedResult(dir_, ov, &bytes, TRUE);
+            }
+            delete ov;
+            overlapped_ = nullptr;
+        }
+        if (dir_) CloseHandle(dir_);
+        if (event_) CloseHandle(event_);
+        if (stop_event_) CloseHandle(stop_event_);
+        dir_ = event_ = stop_event_ = nullptr;
+#elif defined(__linux__)
+        if (thread_.joinable()) {
+            const ssize_t n = write(wake_[1], "x", 1);
+            (void)n;
+            thread_.join();
+        }
+        for (int* fd : {&inotify_, &wake_[0], &wake_[1]}) {
+            if (*fd >= 0) close(*fd);
+            *fd = -1;
+        }
+#else
+        if (thread_.joinable()) {
+            stop_.store(true);
+            thread_.join();
+        }
+#endif
+    }
+
+#ifdef _WIN32
+
+    int ConfigWatcher::WaitForChange(int timeout_ms) {
+        HANDLE handles[2] = {stop_event_, event_};
+        const DWORD w = WaitForMultipleObjects(2, handles, FALSE, timeout_ms < 0 ? INFINITE : (DWORD)timeout_ms);
+        if (w == WAIT_TIMEOUT) return 0;
+        if (w != WAIT_OBJECT_0 + 1) return -1;
+
+        auto* ov = static_cast<OVERLAPPED*>(overlapped_);
+        DWORD bytes = 0;
+        if (!GetOverlappedResult(dir_, ov, &bytes, FALSE)) return -1;
+        // Zero bytes: the buffer overflowed and the details were dropped.
+        bool touched = bytes == 0;
+        for (DWORD offset = 0; bytes > 0;) {
+            const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer_ + offset);
+            const std::wstring file(info->FileName, info->FileNameLength / sizeof(WCHAR));
+            if (_wcsicmp(file.c_str(), name_.c_str()) == 0) touched = true;
+            if (info->NextEntryOffset == 0) break;
+            offset += info->NextEntryOffset;
+        }
+        if (!Arm(dir_, ov, buffer_, sizeof(buffer_))) return -1;
+        return touched ? 1 : 0;
+    }
+
+#elif defined(__linux__)
+
+    int ConfigWatcher::WaitForChange(int timeout_ms) {
+        pollfd fds[2] = {{inotify_, POLLIN, 0}, {wake_[0], POLLIN, 0}};
+        const int r = poll(fds, 2, timeout_ms);
+        if (r < 0) return errno == EINTR ? 0 : -1;
+        if (fds[1].revents) return -1;
+        if (r == 0) return 0;
+
+        alignas(inotify_event) char buffer[4096];
+        bool touched = false;
+        for (;;) {
+            const ssize_t n = read(inotify_, buffer, sizeof(buffer));
+            if (n <= 0) break;
+            for (ssize_t at = 0; at < n;) {
+                const auto* ev = reinterpret_cast<const inotify_event*>(buffer + at);
+                if (ev->mask & IN_IGNORED) return -1;  // the directory went away
+                if (ev->mask & IN_Q_OVERFLOW) touched = true;
+                if (ev->len && name_ == ev->name) touched = true;
+                at += (ssize_t)(sizeof(inotify_event) + ev->len);
+            }
+        }
+        return touched ? 1 : 0;
+    }
+
+#else
+
+    int ConfigWatcher::WaitForChange(int timeout_ms) {
+        constexpr int kPollMs = 100;
+        for (int waited = 0; timeout_ms < 0 || waited < timeout_ms;) {
+            if (stop_.load()) return -1;
+            uint64_t size = 0;
+            int64_t mtime = 0;
+            if (!StatFile(path_, &size, &mtime)) size = 0, mtime = 0;
+            if (size != size_ || mtime != mtime_) {
+                size_ = size;
+                mtime_ = mtime;
+                return 1;
+            }
+            const int step = timeout_ms < 0 ? kPollMs : std::min(kPollMs, timeout_ms - waited);
+            std::this_thread::sleep_for(std::chrono::milliseconds(step));
+            waited += step;
+        }
+        return stop_.load() ? -1 : 0;
+    }
+
+#endif
+
+    void ConfigWatcher::ThreadLoop() {
+        using Clock = std::chrono::steady_clock;
+        for (;;) {
+            int r = WaitForChange(-1);
+            if (r < 0) return;
+            if (r == 0) continue;
+            uint64_t events = 1;
+
+            // Wait for `settle_` without news, or give up after a while.
+            const auto give_up = Clock::now() + settle_ * kMaxSettleFactor;
+            auto quiet_at = Clock::now() + settle_;
+            for (;;) {
+                const auto now = Clock::now();
+                const auto until = std::min(quiet_at, give_up);
+                if (now >= until) break;
+                const auto left = std::chrono::ceil<std::chrono::milliseconds>(until - now);
+                r = WaitForChange((int)left.count());
+                if (r < 0) return;
+                if (r > 0) {
+                    events++;
+                    quiet_at = Clock::now() + settle_;
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                stats_.events += events;
+            }
+            Reload();
+        }
+    }
+
+    void ConfigWatcher::Reload() {
+        DeejConfig next;
+        const bool ok = LoadDeejConfig(path_, &next);
+        DeejConfigDiff diff;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stats_.reloads++;
+            if (!ok) {
+                stats_.parse_errors++;
+                return;
+            }
+            diff = DiffDeejConfig(config_, next);
+            if (diff.empty()) return;
+            config_ = next;
+            stats_.reports++;
+        }
+        callback_(next, diff);
+    }
+
+}  // namespace volumedeck_mixer
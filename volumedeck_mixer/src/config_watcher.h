@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "deej_config.h"
+
+namespace volumedeck_mixer {
+
+    struct ConfigWatcherStats {
+        uint64_t events = 0;        // notifications about the file
+        uint64_t reloads = 0;       // times it was read after settling
+        uint64_t reports = 0;       // reloads that changed something
+        uint64_t parse_errors = 0;  // unreadable or invalid: previous config kept
+    };
+
+    // Watches a deej config.yaml and reports which keys changed, so the
+    // engine applies only those (see DeckEngine::UpdateConfig). inotify on
+    // Linux, ReadDirectoryChangesW on Windows, size/mtime polling elsewhere.
+    //
+    // The parent directory is watched rather than the file: editors and
+    // SaveDeejConfig replace it by rename, which a file watch would lose.
+    // Notifications are coalesced until the file has been quiet for
+    // `settle`, so a burst of saves is one reload. Saves that parse to the
+    // same config and files that don't parse (a half-written non-atomic
+    // save) are not reported; the next save is read again.
+    class ConfigWatcher {
+    public:
+        // Called on the watcher thread with the new config and what differs
+        // from the previous report (or the config loaded by Start()).
+        using Callback = std::function<void(const DeejConfig& config, const DeejConfigDiff& diff)>;
+
+        ConfigWatcher(std::string path, Callback callback,
+                      std::chrono::milliseconds settle = std::chrono::milliseconds(50));
+        ~ConfigWatcher();
+
+        ConfigWatcher(const ConfigWatcher&) = delete;
+        ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+        // Loads the current file (defaults if it is missing or broken) and
+        // starts watching. Fails if the directory can't be watched.
+        bool Start(std::string* error = nullptr);
+        void Stop();
+
+        DeejConfig config() const;
+        ConfigWatcherStats stats() const;
+
+    private:
+        // 1 when the file was touched, 0 on timeout, -1 when stopping or
+        // the watch broke. `timeout_ms` < 0 waits indefinitely.
+        int WaitForChange(int timeout_ms);
+        void ThreadLoop();
+        void Reload();
+
+        const std::string path_;
+        const Callback callback_;
+        const std::chrono::milliseconds settle_;
+
+        mutable std::mutex mu_;
+        DeejConfig config_;
+        ConfigWatcherStats stats_;
+
+        std::thread thread_;
+#ifdef _WIN32
+        std::wstring name_;
+        void* dir_ = nullptr;
+        void* event_ = nullptr;
+        void* stop_event_ = nullptr;
+        void* overlapped_ = nullptr;  // OVERLAPPED
+        alignas(8) unsigned char buffer_[4096];
+#elif defined(__linux__)
+        std::string name_;
+        int inotify_ = -1;
+        int wake_[2] = {-1, -1};  // self-pipe for Stop()
+#else
+        std::atomic<bool> stop_{false};
+        uint64_t size_ = 0;
+        int64_t mtime_ = 0;
+#endif
+    };
+
+}  // namespace volumedeck_mixer
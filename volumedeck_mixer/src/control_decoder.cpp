@@ -0,0 +1,137 @@
+#include "control_decoder.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        // A pause this long starts the next turn unaccelerated.
+        constexpr auto kTurnPause = std::chrono::milliseconds(300);
+
+    }  // namespace
+
+    bool ButtonDecoder::Feed(bool pressed, ControlClock::time_point now, ControlEventType* type) {
+        // Whatever came due before this reading goes first. It leaves
+        // kIdle or kConsumed, where an edge completes nothing, so there is
+        // never more than one press to report.
+        if (Poll(now, type)) {
+            Edge(pressed, now, type);
+            return true;
+        }
+        return Edge(pressed, now, type);
+    }
+
+    bool ButtonDecoder::Edge(bool pressed, ControlClock::time_point now, ControlEventType* type) {
+        if (pressed == level_ || now - edge_ < timing_.debounce) return false;
+        level_ = pressed;
+        edge_ = now;
+
+        switch (state_) {
+            case State::kIdle:
+                if (pressed) {
+                    state_ = State::kDown;
+                    since_ = now;
+                }
+                return false;
+            case State::kDown:
+                if (pressed) return false;
+                if (timing_.double_gap.count() == 0) {
+                    state_ = State::kIdle;
+                    *type = ControlEventType::kShortPress;
+                    return true;
+                }
+                state_ = State::kWaitSecond;
+                since_ = now;
+                return false;
+            case State::kWaitSecond:
+                if (!pressed) return false;
+                state_ = State::kConsumed;
+                *type = ControlEventType::kDoublePress;
+                return true;
+            case State::kConsumed:
+                if (!pressed) state_ = State::kIdle;
+                return false;
+        }
+        return false;
+    }
+
+    bool ButtonDecoder::Poll(ControlClock::time_point now, ControlEventType* type) {
+        if (now < deadline()) return false;
+        if (state_ == State::kDown) {
+            state_ = State::kConsumed;
+            *type = ControlEventType::kLongPress;
+        } else {
+            state_ = State::kIdle;
+            *type = ControlEventType::kShortPress;
+        }
+        return true;
+    }
+
+    ControlClock::time_point ButtonDecoder::deadline() const {
+        switch (state_) {
+            case State::kDown: return since_ + timing_.long_press;
+            case State::kWaitSecond: return since_ + timing_.double_gap;
+            default: return ControlClock::time_point::max();
+        }
+    }
+
+    float EncoderDecoder::Feed(int detents, ControlClock::time_point now) {
+        if (detents == 0) return 0.0f;
+        const int direction = detents > 0 ? 1 : -1;
+        const auto gap = now - last_;
+        if (direction != direction_ || gap >= kTurnPause || last_ == ControlClock::time_point{}) {
+            rate_ = 0.0f;
+        } else {
+            const float seconds = std::max(std::chrono::duration<float>(gap).count(), 0.001f);
+            const float rate = (float)std::abs(detents) / seconds;
+            rate_ = rate_ == 0.0f ? rate : (rate_ + rate) * 0.5f;
+        }
+        direction_ = direction;
+        last_ = now;
+
+        const float span = std::max(accel_.fast_rate - accel_.slow_rate, 1e-3f);
+        const float t = std::clamp((rate_ - accel_.slow_rate) / span, 0.0f, 1.0f);
+        multiplier_ = 1.0f + (accel_.max_multiplier - 1.0f) * t;
+        return (float)detents * accel_.step * multiplier_;
+    }
+
+    void ControlDecoder::Configure(const ButtonTiming& timing, const EncoderAccel& accel) {
+        timing_ = timing;
+        accel_ = accel;
+        buttons_.clear();
+        encoders_.clear();
+    }
+
+    void ControlDecoder::Feed(const uint8_t* buttons, size_t button_count, const int16_t* encoders,
+                              size_t encoder_count, ControlClock::time_point now,
+                              std::vector<ControlEvent>* events) {
+        if (buttons_.size() < button_count) buttons_.resize(button_count, ButtonDecoder(timing_));
+        if (encoders_.size() < encoder_count) encoders_.resize(encoder_count, EncoderDecoder(accel_));
+
+        ControlEventType type;
+        for (size_t i = 0; i < button_count; i++) {
+            if (buttons_[i].Feed(buttons[i] != 0, now, &type)) events->push_back({type, (uint16_t)i, 0, 0.0f});
+        }
+        for (size_t i = 0; i < encoder_count; i++) {
+            if (encoders[i] == 0) continue;
+            const float delta = encoders_[i].Feed(encoders[i], now);
+            events->push_back({ControlEventType::kTurn, (uint16_t)i, encoders[i], delta});
+        }
+    }
+
+    void ControlDecoder::Poll(ControlClock::time_point now, std::vector<ControlEvent>* events) {
+        ControlEventType type;
+        for (size_t i = 0; i < buttons_.size(); i++) {
+            if (buttons_[i].Poll(now, &type)) events->push_back({type, (uint16_t)i, 0, 0.0f});
+        }
+    }
+
+    ControlClock::time_point ControlDecoder::deadline() const {
+        ControlClock::time_point t = ControlClock::time_point::max();
+        for (const ButtonDecoder& b : buttons_) t = std::min(t, b.deadline());
+        return t;
+    }
+
+}  // namespace volumedeck_mixer
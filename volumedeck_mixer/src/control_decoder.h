@@ -0,0 +1,116 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace volumedeck_mixer {
+
+    using ControlClock = std::chrono::steady_clock;
+
+    struct ButtonTiming {
+        // Edges closer than this to the last accepted one are contact
+        // bounce. The first edge is taken at once, so bounce costs no latency.
+        std::chrono::milliseconds debounce{20};
+        // Held this long: a long press, reported while still held.
+        std::chrono::milliseconds long_press{500};
+        // A second press this soon after a release makes a double press, so
+        // a short press is only reported once the gap has passed. 0 reports
+        // short presses on release and never a double.
+        std::chrono::milliseconds double_gap{250};
+    };
+
+    // Turned slowly an encoder moves `step` per detent; faster, each detent
+    // counts for more, up to max_multiplier steps, so one flick covers the
+    // whole range and a slow turn stays precise.
+    struct EncoderAccel {
+        float step = 0.02f;
+        float slow_rate = 5.0f;   // detents/s up to which a detent is one step
+        float fast_rate = 30.0f;  // detents/s from which it is max_multiplier
+        float max_multiplier = 5.0f;
+    };
+
+    enum class ControlEventType : uint8_t { kShortPress, kLongPress, kDoublePress, kTurn };
+
+    struct ControlEvent {
+        ControlEventType type = ControlEventType::kShortPress;
+        uint16_t channel = 0;  // button or encoder index
+        int detents = 0;       // kTurn: as the board reported them
+        float delta = 0.0f;    // kTurn: volume change, accelerated
+    };
+
+    // One button's debounce and press state machine. Raw readings go in,
+    // at most one press comes out per call.
+    class ButtonDecoder {
+    public:
+        explicit ButtonDecoder(const ButtonTiming& timing = ButtonTiming()) : timing_(timing) {}
+
+        // One raw reading. True if it completed a press (`type` says which).
+        bool Feed(bool pressed, ControlClock::time_point now, ControlEventType* type);
+        // Presses that came due without an edge: a long press while held, a
+        // short press once the double press gap has passed.
+        bool Poll(ControlClock::time_point now, ControlEventType* type);
+        // When Poll() next has something to report; max() if nothing.
+        ControlClock::time_point deadline() const;
+
+        bool pressed() const { return level_; }  // debounced
+
+    private:
+        enum class State : uint8_t {
+            kIdle,
+            kDown,        // first press held
+            kWaitSecond,  // released, a second press would be a double
+            kConsumed,    // reported while held (long, double); wait for release
+        };
+
+        // Applies a raw level past the debounce; true if it completed a press.
+        bool Edge(bool pressed, ControlClock::time_point now, ControlEventType* type);
+
+        ButtonTiming timing_;
+        State state_ = State::kIdle;
+        bool level_ = false;
+        ControlClock::time_point edge_{};   // last accepted edge
+        ControlClock::time_point since_{};  // entered state_
+    };
+
+    class EncoderDecoder {
+    public:
+        explicit EncoderDecoder(const EncoderAccel& accel = EncoderAccel()) : accel_(accel) {}
+
+        // Detents turned since the last reading -> volume change.
+        float Feed(int detents, ControlClock::time_point now);
+
+        float multiplier() const { return multiplier_; }
+
+    private:
+        EncoderAccel accel_;
+        float rate_ = 0.0f;  // detents/s, smoothed
+        float multiplier_ = 1.0f;
+        int direction_ = 0;
+        ControlClock::time_point last_{};
+    };
+
+    // The decoders for every button and encoder of a board, grown as its
+    // lines report more channels.
+    class ControlDecoder {
+    public:
+        void Configure(const ButtonTiming& timing, const EncoderAccel& accel);
+
+        // All buttons and encoders of one line in one pass; appends what
+        // they produced to `events`.
+        void Feed(const uint8_t* buttons, size_t button_count, const int16_t* encoders, size_t encoder_count,
+                  ControlClock::time_point now, std::vector<ControlEvent>* events);
+        // Presses that came due between lines.
+        void Poll(ControlClock::time_point now, std::vector<ControlEvent>* events);
+        // Earliest Poll() with something to report; max() if none.
+        ControlClock::time_point deadline() const;
+
+    private:
+        ButtonTiming timing_;
+        EncoderAccel accel_;
+        std::vector<ButtonDecoder> buttons_;
+        std::vector<EncoderDecoder> encoders_;
+    };
+
+}  // namespace volumedeck_mixer
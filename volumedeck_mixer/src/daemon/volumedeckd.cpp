@@ -0,0 +1,273 @@
+// volumedeckd: headless deej pipeline (serial -> noise filter -> slider
+// mapping -> mixer) without the Flutter UI, so the sliders keep working
+// while the app is closed. Live state goes out over the shared-memory
+// state channel (state_channel.h), where the app picks it up when open.
+//
+//   volumedeckd --config config.yaml [--port COM3|/dev/ttyACM0|-] [--baud 9600]
+//               [--backend wasapi|pulse|fake|sim[:SPEC]] [--fake-sessions a.exe,b.exe]
+//               [--profile NAME=CONFIG]... [--stats SECONDS] [--no-state] [--feedback]
+//               [--verbose]
+//
+// With --profile the config file is profile "default" and the others are
+// compiled up front; SIGUSR1, or a long press on any button, switches to
+// the next one without a restart. --feedback drives motor faders, encoder
+// rings and mute LEDs on boards that take the feedback lines.
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "config_watcher.h"
+#include "deck_engine.h"
+#include "deej_config.h"
+#include "fake_mixer_backend.h"
+#include "mixer_backend.h"
+#include "profile_store.h"
+#include "serial_port.h"
+#include "state_channel.h"
+
+namespace {
+
+    std::atomic<bool> g_stop{false};
+    std::atomic<bool> g_next_profile{false};
+
+#ifdef _WIN32
+    BOOL WINAPI OnConsoleCtrl(DWORD) {
+        g_stop.store(true);
+        return TRUE;
+    }
+#else
+    void OnSignal(int) { g_stop.store(true); }
+    void OnNextProfile(int) { g_next_profile.store(true); }
+#endif
+
+    // Resident set size in KiB, 0 if unknown.
+    size_t ResidentKiB() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS pmc{};
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0;
+        return pmc.WorkingSetSize / 1024;
+#else
+        FILE* f = fopen("/proc/self/statm", "r");
+        if (!f) return 0;
+        unsigned long pages = 0, resident = 0;
+        const int n = fscanf(f, "%lu %lu", &pages, &resident);
+        fclose(f);
+        if (n != 2) return 0;
+        return resident * (size_t)sysconf(_SC_PAGESIZE) / 1024;
+#endif
+    }
+
+    void Usage() {
+        fprintf(stderr,
+                "usage: volumedeckd [--config PATH] [--port PORT] [--baud N]\n"
+                "                   [--backend wasapi|pulse|fake|sim[:SPEC]] [--fake-sessions a.exe,b.exe]\n"
+                "                   [--profile NAME=CONFIG]... [--stats SECONDS] [--no-state] [--feedback]\n"
+                "                   [--realtime [--rr-priority N] [--nice N] [--no-rtkit]] [--verbose]\n"
+                "PORT '-' reads slider lines from stdin. SIGUSR1 cycles through the profiles.\n"
+                "--realtime raises the engine thread: MMCSS on Windows; SCHED_RR, rtkit, then nice\n"
+                "on Linux (0 skips a step), settling for what it is allowed.\n");
+    }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    using namespace volumedeck_mixer;
+
+    std::string config_path = "config.yaml";
+    std::string port, backend_name, fake_sessions;
+    int baud = 0;
+    int stats_interval = 0;
+    bool verbose = false;
+    bool publish_state = true;
+    bool feedback = false;
+    ThreadPriorityOptions priority;
+    std::vector<std::pair<std::string, std::string>> profile_paths;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (!strcmp(a, "--config") && has_value) config_path = argv[++i];
+        else if (!strcmp(a, "--port") && has_value) port = argv[++i];
+        else if (!strcmp(a, "--baud") && has_value) baud = atoi(argv[++i]);
+        else if (!strcmp(a, "--backend") && has_value) backend_name = argv[++i];
+        else if (!strcmp(a, "--fake-sessions") && has_value) fake_sessions = argv[++i];
+        else if (!strcmp(a, "--profile") && has_value && strchr(argv[i + 1], '=')) {
+            const std::string spec = argv[++i];
+            profile_paths.emplace_back(spec.substr(0, spec.find('=')), spec.substr(spec.find('=') + 1));
+        }
+        else if (!strcmp(a, "--stats") && has_value) stats_interval = atoi(argv[++i]);
+        else if (!strcmp(a, "--no-state")) publish_state = false;
+        else if (!strcmp(a, "--feedback")) feedback = true;
+        else if (!strcmp(a, "--realtime")) priority.enabled = true;
+        else if (!strcmp(a, "--rr-priority") && has_value) priority.rr_priority = atoi(argv[++i]);
+        else if (!strcmp(a, "--nice") && has_value) priority.nice = atoi(argv[++i]);
+        else if (!strcmp(a, "--no-rtkit")) priority.rtkit = false;
+        else if (!strcmp(a, "--verbose")) verbose = true;
+        else {
+            Usage();
+            return 2;
+        }
+    }
+
+    // deej itself runs with defaults when the file is missing; do the same
+    // but say so.
+    DeejConfig config;
+    std::string error;
+    if (!LoadDeejConfig(config_path, &config, &error)) {
+        fprintf(stderr, "volumedeckd: %s: %s, using defaults\n", config_path.c_str(), error.c_str());
+    }
+    if (!port.empty()) config.com_port = port;
+    if (baud > 0) config.baud_rate = baud;
+
+    std::unique_ptr<MixerBackend> backend = CreateMixerBackend(backend_name);
+    if (!backend) {
+        fprintf(stderr, "volumedeckd: unknown backend '%s'\n", backend_name.c_str());
+        return 2;
+    }
+    if (auto* fake = dynamic_cast<FakeMixerBackend*>(backend.get())) {
+        uint32_t pid = 1000;
+        size_t at = 0;
+        while (at < fake_sessions.size()) {
+            size_t comma = fake_sessions.find(',', at);
+            if (comma == std::string::npos) comma = fake_sessions.size();
+            if (comma > at) fake->AddSession(fake_sessions.substr(at, comma - at), pid++);
+            at = comma + 1;
+        }
+    }
+
+    DeckEngine engine(backend.get(), std::make_unique<SerialPort>(config.com_port, config.baud_rate), config);
+    if (feedback) engine.EnableFeedback();
+    engine.SetPriority(priority);
+    if (verbose) {
+        engine.SetMoveObserver([](size_t slider, float value) {
+            fprintf(stderr, "slider %zu -> %.2f\n", slider, value);
+        });
+    }
+
+    // Broken profiles are skipped rather than run with defaults.
+    ProfileStore profiles;
+    if (!profile_paths.empty()) {
+        profiles.Put("default", config);
+        for (const auto& [name, path] : profile_paths) {
+            DeejConfig p;
+            if (!LoadDeejConfig(path, &p, &error)) {
+                fprintf(stderr, "volumedeckd: profile %s: %s: %s\n", name.c_str(), path.c_str(), error.c_str());
+                continue;
+            }
+            if (!port.empty()) p.com_port = port;
+            if (baud > 0) p.baud_rate = baud;
+            profiles.Put(name, p);
+        }
+        engine.SetProfileStore(&profiles);
+    }
+
+    // Short presses (mute) and turns are handled in the engine; a long press
+    // has no target to act on, so it cycles the profiles here.
+    engine.SetControlObserver([&](const ControlEvent& e) {
+        static const char* const kNames[] = {"short press", "long press", "double press", "turn"};
+        if (verbose) {
+            fprintf(stderr, "%s %u %s", e.type == ControlEventType::kTurn ? "encoder" : "button", e.channel,
+                    kNames[(int)e.type]);
+            if (e.type == ControlEventType::kTurn) fprintf(stderr, " %+d (%+.3f)", e.detents, e.delta);
+            fprintf(stderr, "\n");
+        }
+        if (e.type == ControlEventType::kLongPress && !profile_paths.empty()) g_next_profile.store(true);
+    });
+
+    StateChannelWriter state;
+    if (publish_state) {
+        if (state.Open(kStateChannelName)) {
+            engine.SetStateChannel(&state);
+        } else {
+            fprintf(stderr, "volumedeckd: state channel '%s' unavailable (another writer?)\n", kStateChannelName);
+        }
+    }
+
+#ifdef _WIN32
+    SetConsoleCtrlHandler(OnConsoleCtrl, TRUE);
+#else
+    signal(SIGINT, OnSignal);
+    signal(SIGTERM, OnSignal);
+    signal(SIGUSR1, OnNextProfile);
+#endif
+
+    if (!engine.Start()) {
+        fprintf(stderr, "volumedeckd: %s backend failed to start\n", backend->name());
+        return 1;
+    }
+    fprintf(stderr, "volumedeckd: %s @ %d baud, %s backend, rss %zu KiB\n", config.com_port.c_str(),
+            config.baud_rate, backend->name(), ResidentKiB());
+    if (priority.enabled) {
+        // The engine thread raises itself as it starts; give it a moment.
+        std::string got;
+        for (int i = 0; i < 50 && (got = engine.stats().priority_description).empty(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        fprintf(stderr, "volumedeckd: engine thread %s\n", got.empty() ? "not started" : got.c_str());
+    }
+
+    // Edits to the config (from the app or by hand) apply live; --port and
+    // --baud keep overriding the file.
+    ConfigWatcher watcher(config_path, [&](const DeejConfig& next, const DeejConfigDiff& diff) {
+        DeejConfig cfg = next;
+        if (!port.empty()) cfg.com_port = port;
+        if (baud > 0) cfg.baud_rate = baud;
+        if (profile_paths.empty()) {
+            engine.UpdateConfig(cfg);
+        } else {
+            profiles.Put("default", cfg);
+        }
+        std::string keys;
+        for (uint32_t bit = 1; bit <= kConfigEncoderMapping; bit <<= 1) {
+            if (diff.keys & bit) keys += std::string(keys.empty() ? "" : ", ") + DeejConfigKeyName((DeejConfigKey)bit);
+        }
+        fprintf(stderr, "volumedeckd: %s changed: %s\n", config_path.c_str(), keys.c_str());
+    });
+    if (!watcher.Start(&error)) {
+        fprintf(stderr, "volumedeckd: not watching the config: %s\n", error.c_str());
+    }
+
+    auto next_stats = std::chrono::steady_clock::now() + std::chrono::seconds(stats_interval);
+    while (!g_stop.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (g_next_profile.exchange(false) && !profile_paths.empty()) {
+            fprintf(stderr, "volumedeckd: profile %s\n", profiles.SelectNext().c_str());
+        }
+        if (stats_interval <= 0 || std::chrono::steady_clock::now() < next_stats) continue;
+        next_stats += std::chrono::seconds(stats_interval);
+        const DeckEngineStats s = engine.stats();
+        fprintf(stderr,
+                "volumedeckd: %s lines=%llu malformed=%llu moves=%llu presses=%llu turns=%llu writes=%llu "
+                "feedback=%lluB/%llu echoes=%llu reconnects=%llu apply=%.1fus max=%.1fus "
+                "jitter=%.1f/%.1f/%.1fus rss=%zuKiB\n",
+                s.connected ? "connected" : "waiting", (unsigned long long)s.lines,
+                (unsigned long long)s.malformed, (unsigned long long)s.moves, (unsigned long long)s.presses,
+                (unsigned long long)s.turns, (unsigned long long)s.writes, (unsigned long long)s.feedback_bytes,
+                (unsigned long long)s.feedback_updates, (unsigned long long)s.echoes, (unsigned long long)s.reconnects,
+                s.last_apply_ns / 1000.0, s.max_apply_ns / 1000.0, s.wake_jitter_p50_ns / 1000.0,
+                s.wake_jitter_p99_ns / 1000.0, s.wake_jitter_max_ns / 1000.0, ResidentKiB());
+    }
+
+    watcher.Stop();
+    engine.Stop();
+    const DeckEngineStats s = engine.stats();
+    fprintf(stderr, "volumedeckd: exiting after %llu lines, %llu moves, rss %zu KiB\n",
+            (unsigned long long)s.lines, (unsigned long long)s.moves, ResidentKiB());
+    return 0;
+}
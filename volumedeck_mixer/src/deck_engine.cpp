@@ -0,0 +1,500 @@
+#include "deck_engine.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <future>
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        // deej polls the board every 2 s while it is missing.
+        constexpr auto kReconnectDelay = std::chrono::seconds(2);
+        constexpr int kReadTimeoutMs = 100;
+        // A lost mixer backend is restarted at once, then backed off up to
+        // this while its server stays away.
+        constexpr auto kBackendRetryFirst = std::chrono::milliseconds(250);
+        constexpr auto kBackendRetryMax = std::chrono::seconds(8);
+        constexpr auto kPublishInterval = std::chrono::microseconds(33333);
+        // An encoder left alone this long re-reads its target's volume
+        // before the next turn: a slider or the app may have moved it.
+        constexpr auto kEncoderResync = std::chrono::seconds(1);
+        // How often the mixer is read for feedback; the byte budget and the
+        // per-channel rate decide what is actually sent.
+        constexpr auto kFeedbackInterval = std::chrono::milliseconds(50);
+
+        uint16_t ToRaw(float v) { return (uint16_t)std::lround(std::clamp(v, 0.0f, 1.0f) * 1023.0f); }
+
+        bool IsUnmapped(const std::string& target) {
+            static const char kName[] = "deej.unmapped";
+            return target.size() == sizeof(kName) - 1 &&
+                   std::equal(target.begin(), target.end(), kName,
+                              [](char a, char b) { return std::tolower((unsigned char)a) == b; });
+        }
+
+    }  // namespace
+
+    DeckEngine::DeckEngine(MixerBackend* backend, std::unique_ptr<SliderInput> input, const DeejConfig& config)
+        : backend_(backend), input_(std::move(input)), mapper_(backend), config_(config) {
+        filter_.Configure(config.invert_sliders, ParseNoiseReduction(config.noise_reduction));
+        mapper_.SetConfig(config);
+        backend_->SetChangeObserver([this](const MixerChange& change) { changes_.Post(change); });
+    }
+
+    DeckEngine::~DeckEngine() {
+        Stop();
+        backend_->SetChangeObserver(nullptr);
+    }
+
+    bool DeckEngine::Start() {
+        if (thread_.joinable()) return true;
+        stop_.store(false);
+        // The backend is started on the engine thread (COM apartments), so
+        // hand the result back.
+        std::promise<bool> started;
+        auto ok = started.get_future();
+        thread_ = std::thread([this, &started] {
+            const ScopedThreadPriority priority(priority_);
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                stats_.priority = priority.level();
+                stats_.priority_description = priority.description();
+            }
+            if (!backend_->Start()) {
+                started.set_value(false);
+                return;
+            }
+            started.set_value(true);
+            ThreadLoop();
+            backend_->Stop();
+        });
+        if (ok.get()) return true;
+        thread_.join();
+        return false;
+    }
+
+    void DeckEngine::Stop() {
+        if (!thread_.joinable()) return;
+        stop_.store(true);
+        thread_.join();
+    }
+
+    void DeckEngine::UpdateConfig(const DeejConfig& config) {
+        std::lock_guard<std::mutex> lock(mu_);
+        pending_config_ = std::make_unique<DeejConfig>(config);
+    }
+
+    void DeckEngine::ApplyPendingConfig() {
+        std::unique_ptr<DeejConfig> cfg;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            cfg = std::move(pending_config_);
+        }
+        if (cfg) ApplyConfig(*cfg, nullptr);
+    }
+
+    void DeckEngine::ApplyProfileSwitch() {
+        if (!profiles_) return;
+        const uint64_t version = profiles_->version();
+        if (version == profile_version_) return;
+        const std::shared_ptr<const DeckProfileSet> set = profiles_->Load();
+        profile_version_ = set->version;
+        // Keep every profile's routes resolved so switching back is as
+        // cheap as switching here.
+        std::vector<std::shared_ptr<const SliderPlan>> plans;
+        for (const auto& p : set->profiles) plans.push_back(p->plan);
+        mapper_.Prepare(plans);
+        if (!set->active_profile()) return;
+        const std::shared_ptr<const DeckProfile>& active = set->profiles[set->active];
+        if (active == profile_) return;
+        profile_ = active;
+        ApplyConfig(active->config, active->plan);
+        std::lock_guard<std::mutex> lock(mu_);
+        stats_.profile_switches++;
+    }
+
+    void DeckEngine::ApplyConfig(const DeejConfig& cfg, const std::shared_ptr<const SliderPlan>& plan) {
+        const DeejConfigDiff diff = DiffDeejConfig(config_, cfg);
+        config_ = cfg;
+        if (diff.empty()) return;
+
+        if (diff.keys & (kConfigInvertSliders | kConfigNoiseReduction)) {
+            // An inversion also resets the filter: the next line re-applies
+            // every slider.
+            filter_.Configure(config_.invert_sliders, ParseNoiseReduction(config_.noise_reduction));
+        }
+        if (diff.keys & (kConfigSliderMapping | kConfigButtonMapping | kConfigEncoderMapping)) {
+            if (plan) {
+                mapper_.SetPlan(plan);
+            } else {
+                mapper_.SetConfig(config_);
+            }
+        }
+        if (diff.has(kConfigEncoderMapping)) encoder_levels_.clear();
+        if (diff.has(kConfigSliderMapping)) {
+            // Re-apply the retargeted sliders at their current positions,
+            // and the catch-all, whose set of unmapped sessions moved too.
+            std::vector<bool> reapply(filter_.count(), false);
+            for (int slider : diff.sliders) {
+                if ((size_t)slider < reapply.size()) reapply[slider] = true;
+            }
+            for (const auto& [slider, targets] : config_.slider_mapping) {
+                if ((size_t)slider >= reapply.size()) continue;
+                if (std::any_of(targets.begin(), targets.end(), IsUnmapped)) reapply[slider] = true;
+            }
+            for (size_t i = 0; i < reapply.size(); i++) {
+                if (reapply[i] && filter_.value(i) >= 0.0f) mapper_.Apply(i, filter_.value(i));
+            }
+        }
+        if (diff.has(kConfigBaudRate) && feedback_) feedback_->SetBaud(config_.baud_rate);
+        if (diff.keys & (kConfigComPort | kConfigBaudRate)) {
+            reopen_ = input_->Retarget(config_.com_port, config_.baud_rate);
+        }
+
+        std::lock_guard<std::mutex> lock(mu_);
+        stats_.config_updates++;
+        stats_.last_config_keys = diff.keys;
+    }
+
+    DeckEngineStats DeckEngine::stats() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        DeckEngineStats s = stats_;
+        s.mixer_changes = changes_.posts();
+        s.mixer_wakes = changes_.takes();
+        s.wake_jitter_p50_ns = wake_jitter_.Percentile(50);
+        s.wake_jitter_p99_ns = wake_jitter_.Percentile(99);
+        s.wake_jitter_max_ns = wake_jitter_.max_ns();
+        return s;
+    }
+
+    std::vector<float> DeckEngine::slider_values() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return values_;
+    }
+
+    void DeckEngine::ProcessBytes(const char* data, size_t size) {
+        ApplyPendingConfig();
+        ApplyProfileSwitch();
+        parser_.Feed(data, size, [this](const uint16_t* values, size_t count) {
+            // Profiles switch between lines, never inside one.
+            ApplyProfileSwitch();
+            const auto t0 = std::chrono::steady_clock::now();
+            // A line of only buttons and encoders ("b1") leaves the sliders
+            // where they are; the filter would take it as zero of them.
+            changed_.clear();
+            uint64_t writes = 0;
+            if (count > 0) {
+                if (feedback_) {
+                    // A motor on its way to a sent position reads as the
+                    // position it was sent to, which the filter already holds.
+                    raw_.assign(values, values + count);
+                    uint16_t commanded = 0;
+                    for (size_t i = 0; i < count; i++) {
+                        if (feedback_->IsEcho(i, raw_[i], t0, &commanded)) raw_[i] = commanded;
+                    }
+                    values = raw_.data();
+                }
+                filter_.Apply(values, count, &changed_);
+                for (size_t slider : changed_) {
+                    const float v = filter_.value(slider);
+                    writes += mapper_.Apply(slider, v);
+                    if (observer_) observer_(slider, v);
+                    if (feedback_) feedback_->NoteMove(slider, values[slider], t0);
+                }
+            }
+            const uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - t0).count();
+            // Buttons and encoders of the same line, timed by its arrival.
+            controls_.Feed(parser_.buttons(), parser_.button_count(), parser_.encoders(), parser_.encoder_count(),
+                           t0, &control_events_);
+            DispatchControls();
+
+            std::lock_guard<std::mutex> lock(mu_);
+            stats_.moves += changed_.size();
+            stats_.writes += writes;
+            if (!changed_.empty()) {
+                stats_.last_apply_ns = ns;
+                if (ns > stats_.max_apply_ns) stats_.max_apply_ns = ns;
+                values_.resize(filter_.count());
+                for (size_t i = 0; i < filter_.count(); i++) values_[i] = filter_.value(i);
+            }
+        });
+        // Long presses and lapsed double press gaps, between lines.
+        controls_.Poll(ControlClock::now(), &control_events_);
+        DispatchControls();
+        std::lock_guard<std::mutex> lock(mu_);
+        stats_.lines = parser_.lines();
+        stats_.malformed = parser_.malformed();
+    }
+
+    void DeckEngine::DispatchControls() {
+        if (control_events_.empty()) return;
+        uint64_t writes = 0, presses = 0, turns = 0;
+        for (const ControlEvent& e : control_events_) {
+            if (e.type == ControlEventType::kTurn) {
+                turns++;
+                if (encoder_levels_.size() <= e.channel) {
+                    encoder_levels_.resize(e.channel + 1u, -1.0f);
+                    encoder_turned_.resize(e.channel + 1u);
+                }
+                float& level = encoder_levels_[e.channel];
+                const auto now = ControlClock::now();
+                if (level < 0.0f || now - encoder_turned_[e.channel] >= kEncoderResync) {
+                    float current = 0.0f;
+                    bool mute = false;
+                    mapper_.ReadLevels();
+                    // Targets we can't read (mic, devices) start mid-range.
+                    if (mapper_.Level(ChannelKind::kEncoder, e.channel, &current, &mute)) {
+                        level = current;
+                    } else if (level < 0.0f) {
+                        level = 0.5f;
+                    }
+                }
+                level = std::clamp(level + e.delta, 0.0f, 1.0f);
+                encoder_turned_[e.channel] = now;
+                writes += mapper_.ApplyEncoder(e.channel, level);
+            } else {
+                presses++;
+                if (e.type == ControlEventType::kShortPress) writes += mapper_.ToggleMute(e.channel);
+            }
+            if (control_observer_) control_observer_(e);
+        }
+        control_events_.clear();
+        std::lock_guard<std::mutex> lock(mu_);
+        stats_.writes += writes;
+        stats_.presses += presses;
+        stats_.turns += turns;
+    }
+
+    void DeckEngine::EnableFeedback(const FeedbackOptions& options) {
+        feedback_ = std::make_unique<BoardFeedback>(options);
+        feedback_->SetBaud(config_.baud_rate);
+    }
+
+    void DeckEngine::SendFeedback() {
+        if (!feedback_) return;
+        const auto now = std::chrono::steady_clock::now();
+        mapper_.ReadLevels();
+        float volume = 0.0f;
+        bool mute = false;
+        for (size_t i = 0; i < filter_.count(); i++) {
+            if (!mapper_.Level(ChannelKind::kSlider, i, &volume, &mute)) continue;
+            feedback_->Set(ChannelKind::kSlider, i, ToRaw(config_.invert_sliders ? 1.0f - volume : volume), now);
+        }
+        for (size_t i = 0; i < parser_.encoder_count(); i++) {
+            if (mapper_.Level(ChannelKind::kEncoder, i, &volume, &mute)) {
+                feedback_->Set(ChannelKind::kEncoder, i, ToRaw(volume), now);
+            }
+        }
+        for (size_t i = 0; i < parser_.button_count(); i++) {
+            if (mapper_.Level(ChannelKind::kButton, i, &volume, &mute)) {
+                feedback_->Set(ChannelKind::kButton, i, mute ? 1 : 0, now);
+            }
+        }
+
+        feedback_->Flush(now, &feedback_line_, &feedback_faders_);
+        for (const auto& [slider, raw] : feedback_faders_) {
+            filter_.Set(slider, SliderFilter::Normalize(raw, config_.invert_sliders));
+        }
+        if (!feedback_line_.empty() &&
+            input_->Write(feedback_line_.data(), feedback_line_.size()) != (long)feedback_line_.size()) {
+            // A partial line is garbage to the board: start over from scratch.
+            feedback_->Resend();
+        }
+
+        std::lock_guard<std::mutex> lock(mu_);
+        const FeedbackStats& fs = feedback_->stats();
+        stats_.feedback_bytes = fs.bytes;
+        stats_.feedback_updates = fs.updates;
+        stats_.echoes = fs.echoes;
+        if (!feedback_faders_.empty()) {
+            values_.resize(filter_.count());
+            for (size_t i = 0; i < filter_.count(); i++) values_[i] = filter_.value(i);
+        }
+        feedback_faders_.clear();
+    }
+
+    int DeckEngine::FeedbackIfDue(int timeout_ms) {
+        if (!feedback_) return timeout_ms;
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= next_feedback_) {
+            SendFeedback();
+            next_feedback_ = std::max(next_feedback_ + kFeedbackInterval, now);
+        }
+        const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next_feedback_ - now).count();
+        return (int)std::clamp<long long>(wait, 1, timeout_ms);
+    }
+
+    void DeckEngine::PublishState() {
+        if (!state_) return;
+        // Enumerating every frame is what a getSnapshot poll from the UI
+        // costs today; the roster is only rewritten when the ids change.
+        if (!backend_->ListSessions(&state_sessions_)) state_sessions_.clear();
+
+        bool roster_changed = state_ids_.size() != state_sessions_.size() + 1;
+        for (size_t i = 0; !roster_changed && i < state_sessions_.size(); i++) {
+            roster_changed = state_ids_[i + 1] != state_sessions_[i].id;
+        }
+        if (roster_changed || state_->generation() == 0) {
+            state_ids_.assign(1, "master");
+            state_keys_.assign(1, ChangeCoalescer::Key(""));
+            state_roster_.assign(1, StateRosterEntry{"master", "", ""});
+            for (const AudioSession& s : state_sessions_) {
+                state_ids_.push_back(s.id);
+                state_keys_.push_back(ChangeCoalescer::Key(s.id));
+                state_roster_.push_back({s.id, s.exe_name, s.display_name});
+            }
+            state_->PublishRoster(state_roster_);
+        }
+
+        state_slots_.resize(state_sessions_.size() + 1);
+        StateSlot& master = state_slots_[0];
+        bool mute = false;
+        master = StateSlot{};
+        backend_->GetMaster(&master.volume, &mute, &master.peak);
+        master.flags = kStateEndpoint | (mute ? kStateMuted : 0u);
+        for (size_t i = 0; i < state_sessions_.size(); i++) {
+            const AudioSession& s = state_sessions_[i];
+            StateSlot& slot = state_slots_[i + 1];
+            slot.volume = s.volume;
+            slot.peak = s.peak;
+            slot.pid = s.pid;
+            slot.flags = (s.mute ? kStateMuted : 0u) | (s.system ? kStateSystem : 0u);
+        }
+        state_->PublishFrame(state_slots_.data(), state_slots_.size());
+    }
+
+    void DeckEngine::RepublishChanges(bool resync) {
+        if (resync || state_keys_.size() != state_slots_.size()) {
+            PublishState();
+            return;
+        }
+        for (const CoalescedChange& c : changed_targets_) {
+            const auto it = std::find(state_keys_.begin(), state_keys_.end(), c.key);
+            // A session the roster doesn't have yet.
+            if (it == state_keys_.end()) {
+                PublishState();
+                return;
+            }
+            StateSlot& slot = state_slots_[(size_t)(it - state_keys_.begin())];
+            slot.volume = c.volume;
+            slot.flags = c.mute ? slot.flags | kStateMuted : slot.flags & ~kStateMuted;
+        }
+        // Peaks stay as last read until the next regular publish.
+        state_->PublishFrame(state_slots_.data(), state_slots_.size());
+    }
+
+    void DeckEngine::TakeChanges() {
+        // Our own writes never get here, so they cost none.
+        bool resync = false;
+        if (!changes_.Take(&changed_targets_, &resync)) return;
+        if (state_) RepublishChanges(resync);
+        // The pass reads the levels itself; it only needs to come sooner.
+        if (feedback_) next_feedback_ = std::chrono::steady_clock::now();
+    }
+
+    void DeckEngine::TakeChangesIfDue() {
+        // However many notifications come, at most one take a frame; taken
+        // even with nothing consuming them, so the dirty bits don't pile up.
+        const auto now = std::chrono::steady_clock::now();
+        if (now < next_take_) return;
+        TakeChanges();
+        next_take_ = now + kPublishInterval;
+    }
+
+    int DeckEngine::PublishIfDue() {
+        if (!state_) return kReadTimeoutMs;
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= next_publish_) {
+            PublishState();
+            // Skip frames we were too late for instead of bursting.
+            next_publish_ = std::max(next_publish_ + kPublishInterval, now);
+        }
+        const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next_publish_ - now).count();
+        return (int)std::clamp<long long>(wait, 1, kReadTimeoutMs);
+    }
+
+    void DeckEngine::RestartBackendIfLost() {
+        if (!backend_down_ && !backend_->lost()) return;
+        const auto now = std::chrono::steady_clock::now();
+        if (!backend_down_) {
+            backend_down_ = true;
+            backend_backoff_ = kBackendRetryFirst;
+            next_backend_start_ = now;
+        }
+        if (now < next_backend_start_) return;
+        backend_->Stop();
+        if (!backend_->Start()) {
+            next_backend_start_ = now + backend_backoff_;
+            backend_backoff_ = std::min<std::chrono::milliseconds>(backend_backoff_ * 2, kBackendRetryMax);
+            return;
+        }
+        backend_down_ = false;
+        std::lock_guard<std::mutex> lock(mu_);
+        stats_.backend_restarts++;
+    }
+
+    void DeckEngine::ThreadLoop() {
+        char buffer[512];
+        bool connected = false;
+        auto next_attempt = std::chrono::steady_clock::now();
+        TickTimer timer;
+        // How late a wait came back, past its deadline.
+        const auto note_wake = [this](std::chrono::steady_clock::time_point deadline) {
+            const auto late = std::chrono::steady_clock::now() - deadline;
+            if (late < late.zero()) return;
+            wake_jitter_.Record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(late).count());
+        };
+        while (!stop_.load()) {
+            if (reopen_) {
+                reopen_ = false;
+                connected = false;  // Retarget() closed it
+                next_attempt = std::chrono::steady_clock::now();
+            }
+            RestartBackendIfLost();
+            TakeChangesIfDue();
+            int timeout_ms = PublishIfDue();
+            // Wake for a long press even when the board goes quiet.
+            const auto due = controls_.deadline();
+            if (due != ControlClock::time_point::max()) {
+                const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(due - ControlClock::now());
+                timeout_ms = (int)std::clamp<long long>(wait.count() + 1, 1, timeout_ms);
+            }
+            if (!connected) {
+                if (std::chrono::steady_clock::now() < next_attempt) {
+                    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+                    timer.SleepUntil(deadline);
+                    note_wake(deadline);
+                    ApplyPendingConfig();
+                    ApplyProfileSwitch();
+                    continue;
+                }
+                connected = input_->Open();
+                std::lock_guard<std::mutex> lock(mu_);
+                stats_.connected = connected;
+                if (!connected) {
+                    next_attempt = std::chrono::steady_clock::now() + kReconnectDelay;
+                    continue;
+                }
+            }
+
+            timeout_ms = FeedbackIfDue(timeout_ms);
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+            const long n = input_->Read(buffer, sizeof(buffer), timeout_ms);
+            if (n == 0) note_wake(deadline);
+            if (n < 0) {
+                input_->Close();
+                connected = false;
+                next_attempt = std::chrono::steady_clock::now() + kReconnectDelay;
+                std::lock_guard<std::mutex> lock(mu_);
+                stats_.connected = false;
+                stats_.reconnects++;
+                continue;
+            }
+            ProcessBytes(buffer, (size_t)n);
+        }
+        if (connected) input_->Close();
+    }
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "board_feedback.h"
+#include "change_coalescer.h"
+#include "control_decoder.h"
+#include "deej_config.h"
+#include "deej_protocol.h"
+#include "latency_histogram.h"
+#include "mixer_backend.h"
+#include "profile_store.h"
+#include "serial_port.h"
+#include "slider_mapper.h"
+#include "state_channel.h"
+#include "thread_priority.h"
+
+namespace volumedeck_mixer {
+
+    struct DeckEngineStats {
+        uint64_t lines = 0;        // valid board lines
+        uint64_t malformed = 0;
+        uint64_t moves = 0;        // slider changes past the noise filter
+        uint64_t writes = 0;       // mixer calls made
+        uint64_t reconnects = 0;
+        uint64_t backend_restarts = 0;  // mixer reconnects after it was lost()
+        uint64_t last_apply_ns = 0;  // line complete -> mixer written
+        uint64_t max_apply_ns = 0;
+        uint64_t config_updates = 0;    // updates that changed something
+        uint32_t last_config_keys = 0;  // DeejConfigKey bits of the latest
+        uint64_t profile_switches = 0;
+        uint64_t presses = 0;      // decoded button presses, any kind
+        uint64_t turns = 0;        // encoder readings that moved
+        uint64_t feedback_bytes = 0;    // fader/LED lines sent to the board
+        uint64_t feedback_updates = 0;  // channel values in them
+        uint64_t echoes = 0;            // motor fader readings not taken as moves
+        uint64_t mixer_changes = 0;     // made outside this process, as notified
+        uint64_t mixer_wakes = 0;       // passes those were merged into
+        // Engine thread wakes past their deadline, when a read timed out.
+        uint64_t wake_jitter_p50_ns = 0;
+        uint64_t wake_jitter_p99_ns = 0;
+        uint64_t wake_jitter_max_ns = 0;
+        ThreadPriorityLevel priority = ThreadPriorityLevel::kNormal;
+        std::string priority_description;  // ScopedThreadPriority's
+        bool connected = false;
+    };
+
+    // The serial -> filter -> mapping -> mixer pipeline deej runs, on one
+    // thread that owns the backend. Used by the volumedeckd daemon and
+    // embeddable in the app.
+    class DeckEngine {
+    public:
+        // Called on the engine thread after each applied move.
+        using MoveObserver = std::function<void(size_t slider, float value)>;
+        // Called on the engine thread for each decoded press and turn, after
+        // the built-in action (mute toggle, volume change) ran.
+        using ControlObserver = std::function<void(const ControlEvent& event)>;
+
+        DeckEngine(MixerBackend* backend, std::unique_ptr<SliderInput> input, const DeejConfig& config);
+        ~DeckEngine();
+
+        DeckEngine(const DeckEngine&) = delete;
+        DeckEngine& operator=(const DeckEngine&) = delete;
+
+        void SetMoveObserver(MoveObserver observer) { observer_ = std::move(observer); }
+        void SetControlObserver(ControlObserver observer) { control_observer_ = std::move(observer); }
+        // Button and encoder decoding. Set before Start().
+        void SetControlTiming(const ButtonTiming& timing, const EncoderAccel& accel) {
+            controls_.Configure(timing, accel);
+        }
+
+        // Sends fader positions, encoder rings and button mute LEDs back to
+        // the board when the mixer changes behind it (see board_feedback.h).
+        // Off by default: a plain deej board would ignore the lines, but
+        // they still cost link bandwidth. Set before Start().
+        void EnableFeedback(const FeedbackOptions& options = FeedbackOptions());
+        // One feedback pass on the calling thread.
+        void SendFeedback();
+
+        // Master and session state for the UI, published from the engine
+        // thread at the UI frame rate. Set before Start().
+        void SetStateChannel(StateChannelWriter* channel) { state_ = channel; }
+        // One publish on the calling thread.
+        void PublishState();
+
+        // Takes the mixer changes made behind the engine since the last
+        // take, on the calling thread: state slots they touch are
+        // republished in place and a feedback pass is brought forward. The
+        // engine thread does this at most once a frame, consumers or not.
+        void TakeChanges();
+
+        // Scheduling for the engine thread, which reads the board and
+        // writes the mixer. Set before Start().
+        void SetPriority(const ThreadPriorityOptions& options) { priority_ = options; }
+
+        // Start() fails if the backend can't start; an absent board is not
+        // an error, the engine keeps retrying it.
+        bool Start();
+        void Stop();
+
+        // Runs the store's active profile and follows switches at the next
+        // line boundary, so a line is dispatched entirely by one profile and
+        // none are lost. Set before Start(); a later UpdateConfig() holds
+        // until the next switch.
+        void SetProfileStore(const ProfileStore* store) { profiles_ = store; }
+
+        // Picked up by the engine thread before the next line. Any thread.
+        // Only what differs from the running config is applied: filter
+        // settings, retargeted sliders (re-applied at their current
+        // position), or a reconnect for com_port/baud_rate.
+        void UpdateConfig(const DeejConfig& config);
+
+        DeckEngineStats stats() const;
+        std::vector<float> slider_values() const;
+
+        // Runs bytes through the pipeline on the calling thread. For tests
+        // and replay tools; don't mix with a running engine thread.
+        void ProcessBytes(const char* data, size_t size);
+
+    private:
+        void ThreadLoop();
+        void ApplyPendingConfig();
+        void ApplyProfileSwitch();
+        // Applies what differs from config_; `plan` is its precompiled
+        // mapping, if there is one.
+        void ApplyConfig(const DeejConfig& config, const std::shared_ptr<const SliderPlan>& plan);
+        int PublishIfDue();  // ms until the next publish
+        int FeedbackIfDue(int timeout_ms);  // `timeout_ms` bounded by the next pass
+        void TakeChangesIfDue();
+        // Stop()s and Start()s a lost() backend, backing off while that fails.
+        void RestartBackendIfLost();
+        // Patches the last frame with changed_targets_; a full publish if
+        // one isn't in the roster or `resync`.
+        void RepublishChanges(bool resync);
+        // Runs the built-in actions for control_events_ and reports them.
+        void DispatchControls();
+
+        MixerBackend* const backend_;
+        bool backend_down_ = false;  // lost and not yet restarted
+        std::chrono::steady_clock::time_point next_backend_start_{};
+        std::chrono::milliseconds backend_backoff_{};
+        const std::unique_ptr<SliderInput> input_;
+        MoveObserver observer_;
+
+        SliderLineParser parser_;
+        SliderFilter filter_;
+        SliderMapper mapper_;
+        DeejConfig config_;
+        bool reopen_ = false;  // input retargeted; reconnect now
+        const ProfileStore* profiles_ = nullptr;
+        uint64_t profile_version_ = 0;
+        std::shared_ptr<const DeckProfile> profile_;  // last applied
+        std::vector<size_t> changed_;
+
+        ControlDecoder controls_;
+        ControlObserver control_observer_;
+        std::vector<ControlEvent> control_events_;
+        std::vector<float> encoder_levels_;  // where each encoder's targets are; -1 unknown
+        std::vector<ControlClock::time_point> encoder_turned_;
+
+        // Backend change notifications, ours filtered out; posted on the
+        // OS's threads, taken once a frame by TakeChanges().
+        ChangeCoalescer changes_;
+        std::vector<CoalescedChange> changed_targets_;
+        std::chrono::steady_clock::time_point next_take_{};
+
+        std::unique_ptr<BoardFeedback> feedback_;
+        std::chrono::steady_clock::time_point next_feedback_{};
+        std::string feedback_line_;
+        std::vector<std::pair<size_t, uint16_t>> feedback_faders_;
+        std::vector<uint16_t> raw_;  // a line's readings, echoes replaced
+
+        StateChannelWriter* state_ = nullptr;
+        std::chrono::steady_clock::time_point next_publish_{};
+        std::vector<AudioSession> state_sessions_;
+        std::vector<std::string> state_ids_;
+        std::vector<uint64_t> state_keys_;  // ChangeCoalescer::Key per slot
+        std::vector<StateSlot> state_slots_;
+        std::vector<StateRosterEntry> state_roster_;
+
+        ThreadPriorityOptions priority_;
+        LatencyHistogram wake_jitter_;
+
+        mutable std::mutex mu_;
+        std::unique_ptr<DeejConfig> pending_config_;
+        DeckEngineStats stats_;
+        std::vector<float> values_;
+
+        std::atomic<bool> stop_{false};
+        std::thread thread_;
+    };
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,275 @@
+#include "deej_config.h"
+
+#include <cstdlib>
+
+#include "file_util.h"
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        std::string Trim(const std::string& s) {
+            size_t b = 0, e = s.size();
+            while (b < e && (s[b] == ' ' || s[b] == '\t' || s[b] == '\r')) b++;
+            while (e > b && (s[e - 1] == ' ' || s[e - 1] == '\t' || s[e - 1] == '\r')) e--;
+            return s.substr(b, e - b);
+        }
+
+        // Drops a trailing comment that is not inside quotes.
+        std::string StripComment(const std::string& s) {
+            char quote = 0;
+            for (size_t i = 0; i < s.size(); i++) {
+                const char c = s[i];
+                if (quote) {
+                    if (c == quote) quote = 0;
+                } else if (c == '"' || c == '\'') {
+                    quote = c;
+                } else if (c == '#' && (i == 0 || s[i - 1] == ' ' || s[i - 1] == '\t')) {
+                    return s.substr(0, i);
+                }
+            }
+            return s;
+        }
+
+        std::string Unquote(const std::string& s) {
+            if (s.size() >= 2 && (s[0] == '"' || s[0] == '\'') && s.back() == s[0]) {
+                return s.substr(1, s.size() - 2);
+            }
+            return s;
+        }
+
+        std::vector<std::string> FlowList(const std::string& s) {
+            std::vector<std::string> out;
+            std::string item;
+            char quote = 0;
+            for (size_t i = 1; i + 1 < s.size(); i++) {
+                const char c = s[i];
+                if (quote) {
+                    if (c == quote) quote = 0;
+                    item.push_back(c);
+                } else if (c == ',') {
+                    out.push_back(Unquote(Trim(item)));
+                    item.clear();
+                } else {
+                    if (c == '"' || c == '\'') quote = c;
+                    item.push_back(c);
+                }
+            }
+            item = Unquote(Trim(item));
+            if (!item.empty() || !out.empty()) out.push_back(item);
+            return out;
+        }
+
+        bool ParseBool(const std::string& v) { return v == "true" || v == "True" || v == "yes" || v == "on"; }
+
+        size_t Indent(const std::string& line) {
+            size_t n = 0;
+            while (n < line.size() && line[n] == ' ') n++;
+            return n;
+        }
+
+        // deej's own header, kept so the file still reads like one of its.
+        const char kHeaderComment[] =
+                "# process names are case-insensitive\n"
+                "# you can use 'master' to indicate the master channel, or a list of process names to create a group\n"
+                "# you can use 'mic' to control your mic input level (uses the default recording device)\n"
+                "# you can use 'deej.unmapped' to control all apps that aren't bound to any slider (this ignores "
+                "master, system, mic and device-targeting sessions) (experimental)\n"
+                "# windows only - you can use 'deej.current' to control the currently active app (whether "
+                "full-screen or not) (experimental)\n"
+                "# windows only - you can use a device's full name, i.e. \"Speakers (Realtek High Definition "
+                "Audio)\", to bind it. this works for both output and input devices\n"
+                "# windows only - you can use 'system' to control the \"system sounds\" volume\n"
+                "# important: slider indexes start at 0, regardless of which analog pins you're using!\n";
+
+        // Plain unless the parser above would read it differently: comments,
+        // "key: value", flow lists, list items, quotes, edge whitespace.
+        std::string Scalar(const std::string& v) {
+            bool quote = v.empty() || v != Trim(v) || v.find(" #") != std::string::npos ||
+                         v.find(": ") != std::string::npos || v.back() == ':';
+            const char first = v.empty() ? 0 : v[0];
+            quote = quote || first == '#' || first == '[' || first == '-' || first == '"' || first == '\'';
+            if (!quote) return v;
+            // No escapes in this subset: pick the quote the value lacks.
+            const char q = v.find('"') == std::string::npos ? '"' : '\'';
+            return q + v + q;
+        }
+
+        void EmitMapping(const std::map<int, std::vector<std::string>>& mapping, std::string* out) {
+            for (const auto& [index, targets] : mapping) {
+                const std::string key = "  " + std::to_string(index) + ":";
+                if (targets.size() == 1 && !targets[0].empty()) {
+                    *out += key + " " + Scalar(targets[0]) + "\n";
+                    continue;
+                }
+                *out += key + "\n";
+                for (const auto& t : targets) {
+                    if (!t.empty()) *out += "    - " + Scalar(t) + "\n";
+                }
+            }
+        }
+
+    }  // namespace
+
+    bool ParseDeejConfig(const std::string& text, DeejConfig* out, std::string* error) {
+        DeejConfig cfg;
+        cfg.slider_mapping.clear();
+
+        std::string section;      // top-level key owning the indented block
+        std::map<int, std::vector<std::string>>* mapping = nullptr;  // section, if it is one
+        int slider = -1;          // mapping entry collecting "- item"s
+        size_t line_no = 0;
+        size_t pos = 0;
+        while (pos <= text.size()) {
+            size_t end = text.find('\n', pos);
+            if (end == std::string::npos) end = text.size();
+            const std::string raw = StripComment(text.substr(pos, end - pos));
+            pos = end + 1;
+            line_no++;
+            const std::string line = Trim(raw);
+            if (line.empty() || line == "---") continue;
+
+            auto fail = [&](const char* what) {
+                if (error) *error = "line " + std::to_string(line_no) + ": " + what;
+                return false;
+            };
+
+            const size_t indent = Indent(raw);
+            if (line[0] == '-') {
+                if (!mapping || slider < 0) return fail("list item outside a slider");
+                const std::string item = Unquote(Trim(line.substr(1)));
+                if (!item.empty()) (*mapping)[slider].push_back(item);
+                continue;
+            }
+
+            const size_t colon = line.find(':');
+            if (colon == std::string::npos) return fail("expected 'key: value'");
+            const std::string key = Unquote(Trim(line.substr(0, colon)));
+            const std::string value = Trim(line.substr(colon + 1));
+
+            if (indent == 0) {
+                section = key;
+                slider = -1;
+                mapping = key == "slider_mapping"   ? &cfg.slider_mapping
+                          : key == "button_mapping"  ? &cfg.button_mapping
+                          : key == "encoder_mapping" ? &cfg.encoder_mapping
+                                                     : nullptr;
+                if (mapping) {
+                    if (!value.empty()) return fail((key + " must be a block map").c_str());
+                } else if (key == "invert_sliders") {
+                    cfg.invert_sliders = ParseBool(value);
+                } else if (key == "com_port") {
+                    cfg.com_port = Unquote(value);
+                } else if (key == "baud_rate") {
+                    char* endp = nullptr;
+                    const long baud = std::strtol(Unquote(value).c_str(), &endp, 10);
+                    if (baud <= 0 || (endp && *endp)) return fail("baud_rate must be a positive number");
+                    cfg.baud_rate = (int)baud;
+                } else if (key == "noise_reduction") {
+                    cfg.noise_reduction = Unquote(value);
+                }
+                continue;
+            }
+
+            if (!mapping) continue;  // nested unknown keys
+            char* endp = nullptr;
+            const long index = std::strtol(key.c_str(), &endp, 10);
+            if (key.empty() || (endp && *endp) || index < 0 || index > 255) return fail("slider index expected");
+            slider = (int)index;
+            auto& targets = (*mapping)[slider];
+            targets.clear();
+            if (value.empty()) continue;
+            if (value[0] == '[') {
+                if (value.back() != ']') return fail("unterminated flow list");
+                for (auto& t : FlowList(value)) {
+                    if (!t.empty()) targets.push_back(t);
+                }
+            } else {
+                targets.push_back(Unquote(value));
+            }
+        }
+
+        if (cfg.slider_mapping.empty()) cfg.slider_mapping[0] = {"master"};  // as the app does
+        *out = std::move(cfg);
+        return true;
+    }
+
+    bool LoadDeejConfig(const std::string& path, DeejConfig* out, std::string* error) {
+        std::vector<uint8_t> bytes;
+        if (!ReadWholeFile(path, bytes)) {
+            if (error) *error = "cannot read " + path;
+            return false;
+        }
+        return ParseDeejConfig(std::string(bytes.begin(), bytes.end()), out, error);
+    }
+
+    std::string EmitDeejConfig(const DeejConfig& config) {
+        std::string out = kHeaderComment;
+        out += "\nslider_mapping:\n";
+        EmitMapping(config.slider_mapping, &out);
+        out += "\ninvert_sliders: ";
+        out += config.invert_sliders ? "true" : "false";
+        out += "\n\ncom_port: " + Scalar(config.com_port) + "\n";
+        out += "baud_rate: " + std::to_string(config.baud_rate) + "\n";
+        out += "\nnoise_reduction: " + Scalar(config.noise_reduction) + "\n\n";
+        if (!config.button_mapping.empty()) {
+            out += "button_mapping:\n";
+            EmitMapping(config.button_mapping, &out);
+            out += "\n";
+        }
+        if (!config.encoder_mapping.empty()) {
+            out += "encoder_mapping:\n";
+            EmitMapping(config.encoder_mapping, &out);
+            out += "\n";
+        }
+        return out;
+    }
+
+    bool SaveDeejConfig(const std::string& path, const DeejConfig& config, std::string* error) {
+        const std::string text = EmitDeejConfig(config);
+        if (!WriteFileAtomic(path, text.data(), text.size())) {
+            if (error) *error = "cannot write " + path;
+            return false;
+        }
+        return true;
+    }
+
+    DeejConfigDiff DiffDeejConfig(const DeejConfig& from, const DeejConfig& to) {
+        DeejConfigDiff diff;
+        auto a = from.slider_mapping.begin();
+        auto b = to.slider_mapping.begin();
+        while (a != from.slider_mapping.end() || b != to.slider_mapping.end()) {
+            if (b == to.slider_mapping.end() || (a != from.slider_mapping.end() && a->first < b->first)) {
+                diff.sliders.push_back((a++)->first);
+            } else if (a == from.slider_mapping.end() || b->first < a->first) {
+                diff.sliders.push_back((b++)->first);
+            } else {
+                if (a->second != b->second) diff.sliders.push_back(a->first);
+                ++a;
+                ++b;
+            }
+        }
+        if (!diff.sliders.empty()) diff.keys |= kConfigSliderMapping;
+        if (from.invert_sliders != to.invert_sliders) diff.keys |= kConfigInvertSliders;
+        if (from.com_port != to.com_port) diff.keys |= kConfigComPort;
+        if (from.baud_rate != to.baud_rate) diff.keys |= kConfigBaudRate;
+        if (from.noise_reduction != to.noise_reduction) diff.keys |= kConfigNoiseReduction;
+        if (from.button_mapping != to.button_mapping) diff.keys |= kConfigButtonMapping;
+        if (from.encoder_mapping != to.encoder_mapping) diff.keys |= kConfigEncoderMapping;
+        return diff;
+    }
+
+    const char* DeejConfigKeyName(DeejConfigKey key) {
+        switch (key) {
+            case kConfigSliderMapping: return "slider_mapping";
+            case kConfigInvertSliders: return "invert_sliders";
+            case kConfigComPort: return "com_port";
+            case kConfigBaudRate: return "baud_rate";
+            case kConfigNoiseReduction: return "noise_reduction";
+            case kConfigButtonMapping: return "button_mapping";
+            case kConfigEncoderMapping: return "encoder_mapping";
+        }
+        return "";
+    }
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace volumedeck_mixer {
+
+    // The deej config.yaml schema, as the app saves it through the plugin's
+    // saveDeejConfig (lib/services/deej_config_io.dart):
+    //
+    //   slider_mapping:
+    //     0: master
+    //     1:
+    //       - chrome.exe
+    //       - spotify.exe
+    //   invert_sliders: false
+    //   com_port: COM4
+    //   baud_rate: 9600
+    //   noise_reduction: default
+    //
+    // plus, for boards with buttons and encoders (see deej_protocol.h), two
+    // maps of the same shape that deej itself ignores:
+    //
+    //   button_mapping:     # a short press toggles mute
+    //     0: master
+    //   encoder_mapping:    # turning changes volume
+    //     0: spotify.exe
+    struct DeejConfig {
+        std::map<int, std::vector<std::string>> slider_mapping{{0, {"master"}}};
+        bool invert_sliders = false;
+        std::string com_port = "COM1";
+        int baud_rate = 9600;
+        std::string noise_reduction = "default";
+        std::map<int, std::vector<std::string>> button_mapping;
+        std::map<int, std::vector<std::string>> encoder_mapping;
+    };
+
+    // Parses the YAML subset deej configs use: block maps, block and flow
+    // (`[a, b]`) sequences, plain and quoted scalars, comments. Unknown keys
+    // are ignored. On failure `error` says which line was wrong.
+    bool ParseDeejConfig(const std::string& text, DeejConfig* out, std::string* error = nullptr);
+    bool LoadDeejConfig(const std::string& path, DeejConfig* out, std::string* error = nullptr);
+
+    // The file the app writes: its header comment, then the keys above in
+    // that order, the button and encoder maps last and only when set.
+    // Values YAML would misread are quoted.
+    std::string EmitDeejConfig(const DeejConfig& config);
+    // Emits and replaces `path` atomically (see WriteFileAtomic), so a
+    // running deej or watcher never reads half a file.
+    bool SaveDeejConfig(const std::string& path, const DeejConfig& config, std::string* error = nullptr);
+
+    enum DeejConfigKey : uint32_t {
+        kConfigSliderMapping = 1u << 0,
+        kConfigInvertSliders = 1u << 1,
+        kConfigComPort = 1u << 2,
+        kConfigBaudRate = 1u << 3,
+        kConfigNoiseReduction = 1u << 4,
+        kConfigButtonMapping = 1u << 5,
+        kConfigEncoderMapping = 1u << 6,
+    };
+
+    struct DeejConfigDiff {
+        uint32_t keys = 0;         // DeejConfigKey bits
+        std::vector<int> sliders;  // slider_mapping entries added, removed or retargeted
+
+        bool empty() const { return keys == 0; }
+        bool has(DeejConfigKey key) const { return (keys & key) != 0; }
+    };
+
+    DeejConfigDiff DiffDeejConfig(const DeejConfig& from, const DeejConfig& to);
+    // "slider_mapping", ...; "" for anything but a single key.
+    const char* DeejConfigKeyName(DeejConfigKey key);
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,130 @@
+#include "deej_protocol.h"
+
+#include <cmath>
+
+namespace volumedeck_mixer {
+
+    void SliderLineParser::ResetLine() {
+        token_ = Token::kSlider;
+        token_length_ = 0;
+        negative_ = false;
+        current_ = 0;
+        digits_ = 0;
+        length_ = 0;
+        bad_ = false;
+        cr_ = false;
+    }
+
+    bool SliderLineParser::EndToken() {
+        if (digits_ == 0) return false;
+        switch (token_) {
+            case Token::kSlider:
+                if (count_ >= kMaxSliders) return false;
+                values_[count_++] = (uint16_t)current_;
+                break;
+            case Token::kButton:
+                if (current_ > 1 || button_count_ >= kMaxControls) return false;
+                buttons_[button_count_++] = (uint8_t)current_;
+                break;
+            case Token::kEncoder:
+                if (encoder_count_ >= kMaxControls) return false;
+                encoders_[encoder_count_++] = (int16_t)(negative_ ? -(int)current_ : (int)current_);
+                break;
+        }
+        token_ = Token::kSlider;
+        token_length_ = 0;
+        negative_ = false;
+        current_ = 0;
+        digits_ = 0;
+        return true;
+    }
+
+    bool SliderLineParser::Push(char c) {
+        if (c == '\n') {
+            const bool ok = !bad_ && EndToken();
+            if (ok) {
+                lines_++;
+            } else {
+                if (length_ > 0 || cr_) malformed_++;
+                count_ = 0;
+                button_count_ = 0;
+                encoder_count_ = 0;
+            }
+            ResetLine();
+            return ok;
+        }
+        if (length_ == 0 && !bad_) {
+            count_ = 0;
+            button_count_ = 0;
+            encoder_count_ = 0;
+        }
+        if (++length_ > kMaxLine) bad_ = true;
+        if (bad_) return false;
+
+        if (cr_) {
+            bad_ = true;  // "\r" anywhere but right before "\n"
+        } else if (c >= '0' && c <= '9') {
+            token_length_++;
+            current_ = current_ * 10 + (uint32_t)(c - '0');
+            if (++digits_ > 4 || current_ > 1023) bad_ = true;
+        } else if (c == '|') {
+            if (!EndToken()) bad_ = true;
+        } else if (c == '\r') {
+            cr_ = true;
+        } else if (token_length_ == 0 && (c == 'b' || c == 'e')) {
+            token_length_++;
+            token_ = c == 'b' ? Token::kButton : Token::kEncoder;
+        } else if (token_ == Token::kEncoder && token_length_ == 1 && (c == '-' || c == '+')) {
+            token_length_++;
+            negative_ = c == '-';
+        } else {
+            bad_ = true;
+        }
+        return false;
+    }
+
+    NoiseReduction ParseNoiseReduction(const std::string& s) {
+        if (s == "low") return NoiseReduction::kLow;
+        if (s == "high") return NoiseReduction::kHigh;
+        return NoiseReduction::kDefault;
+    }
+
+    float NoiseThreshold(NoiseReduction level) {
+        switch (level) {
+            case NoiseReduction::kLow: return 0.015f;
+            case NoiseReduction::kHigh: return 0.035f;
+            default: return 0.025f;
+        }
+    }
+
+    SliderFilter::SliderFilter(bool invert, NoiseReduction level) { Configure(invert, level); }
+
+    void SliderFilter::Configure(bool invert, NoiseReduction level) {
+        // Inverting flips every position; start over so the next reading
+        // is reported in full.
+        if (invert != invert_) values_.clear();
+        invert_ = invert;
+        threshold_ = NoiseThreshold(level);
+    }
+
+    float SliderFilter::Normalize(uint16_t raw, bool invert) {
+        const float v = std::round((float)raw / 1023.0f * 100.0f) / 100.0f;
+        return invert ? 1.0f - v : v;
+    }
+
+    void SliderFilter::Apply(const uint16_t* raw, size_t count, std::vector<size_t>* changed) {
+        changed->clear();
+        if (count != values_.size()) values_.assign(count, -1.0f);
+        for (size_t i = 0; i < count; i++) {
+            const float v = Normalize(raw[i], invert_);
+            const float old = values_[i];
+            const bool at_edge = (std::fabs(v - 1.0f) < 1e-6f && old != 1.0f) ||
+                                 (std::fabs(v) < 1e-6f && old != 0.0f);
+            if (std::fabs(v - old) >= threshold_ || at_edge) {
+                values_[i] = v;
+                changed->push_back(i);
+            }
+        }
+    }
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace volumedeck_mixer {
+
+    // deej board protocol: one line per reading, slider values 0..1023
+    // separated by '|', terminated by "\r\n" (a bare "\n" is accepted too):
+    //
+    //   512|1023|0|300\r\n
+    //
+    // Boards with buttons and rotary encoders add them to the same line:
+    // "b0"/"b1" is a button's raw level (1 = pressed, bouncing included),
+    // "e<n>" the detents an encoder turned since the last line, negative
+    // counter-clockwise. Each kind is numbered on its own, in line order,
+    // so slider indexes stay what deej's config expects:
+    //
+    //   512|b0|1023|e-2|b1\r\n   sliders 512, 1023; buttons 0, 1; encoder -2
+    //
+    // Lines that don't match exactly (partial reads at connect, values above
+    // 1023, stray bytes) are dropped, as deej does.
+    //
+    // Boards with motor faders or LEDs get lines back in the same style
+    // (see board_feedback.h), only for what changed: "f<i>=<0..1023>"
+    // moves fader i, "r<i>=<0..1023>" lights encoder i's ring, "m<i>=0|1"
+    // is button i's mute LED:
+    //
+    //   f0=512|m1=1\n
+    class SliderLineParser {
+    public:
+        static constexpr size_t kMaxSliders = 64;
+        static constexpr size_t kMaxControls = 32;  // buttons, and encoders
+        static constexpr size_t kMaxLine = 5 * kMaxSliders + 3 * kMaxControls + 6 * kMaxControls + 2;
+
+        // Calls `on_line(const uint16_t* values, size_t count)` with the
+        // sliders of every complete, valid line in `data`. Its buttons and
+        // encoders can be read from inside the callback.
+        template <typename F>
+        void Feed(const char* data, size_t size, F&& on_line) {
+            for (size_t i = 0; i < size; i++) {
+                if (Push(data[i])) on_line(values_, count_);
+            }
+        }
+
+        // The line being reported; valid inside on_line.
+        const uint8_t* buttons() const { return buttons_; }
+        size_t button_count() const { return button_count_; }
+        const int16_t* encoders() const { return encoders_; }
+        size_t encoder_count() const { return encoder_count_; }
+
+        uint64_t lines() const { return lines_; }
+        uint64_t malformed() const { return malformed_; }
+
+    private:
+        enum class Token : uint8_t { kSlider, kButton, kEncoder };
+
+        // True when `c` completed a valid line (values_/count_ hold it).
+        bool Push(char c);
+        // Stores the token just ended; false if it is not a valid one.
+        bool EndToken();
+        void ResetLine();
+
+        uint16_t values_[kMaxSliders] = {};
+        size_t count_ = 0;
+        uint8_t buttons_[kMaxControls] = {};
+        size_t button_count_ = 0;
+        int16_t encoders_[kMaxControls] = {};
+        size_t encoder_count_ = 0;
+        Token token_ = Token::kSlider;
+        int token_length_ = 0;
+        bool negative_ = false;
+        uint32_t current_ = 0;
+        int digits_ = 0;
+        size_t length_ = 0;
+        bool bad_ = false;
+        bool cr_ = false;
+        uint64_t lines_ = 0;
+        uint64_t malformed_ = 0;
+    };
+
+    enum class ChannelKind : uint8_t { kSlider, kEncoder, kButton };
+
+    enum class NoiseReduction { kLow, kDefault, kHigh };
+
+    // "low" / "high"; anything else is the default, like deej.
+    NoiseReduction ParseNoiseReduction(const std::string& s);
+    float NoiseThreshold(NoiseReduction level);
+
+    // Raw readings -> normalized slider positions, with deej's rules:
+    // value / 1023 rounded to two decimals, optional inversion, and a move
+    // only when it exceeds the noise threshold or lands exactly on 0 or 1.
+    class SliderFilter {
+    public:
+        explicit SliderFilter(bool invert = false, NoiseReduction level = NoiseReduction::kDefault);
+
+        void Configure(bool invert, NoiseReduction level);
+
+        // Fills `changed` with the sliders that moved. A change in slider
+        // count (board re-flashed, reconnect) reports every slider.
+        void Apply(const uint16_t* raw, size_t count, std::vector<size_t>* changed);
+        // Takes `value` as the slider's position without reporting a move:
+        // a motor fader was sent there.
+        void Set(size_t slider, float value) {
+            if (slider < values_.size()) values_[slider] = value;
+        }
+
+        float value(size_t slider) const { return slider < values_.size() ? values_[slider] : -1.0f; }
+        size_t count() const { return values_.size(); }
+
+        static float Normalize(uint16_t raw, bool invert);
+
+    private:
+        bool invert_ = false;
+        float threshold_ = 0.025f;
+        std::vector<float> values_;
+    };
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,91 @@
+#include "echo_filter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        // Volumes come back quantized (PulseAudio: 1/65536) or rounded
+        // through dB; well under a slider step.
+        constexpr float kVolumeTolerance = 0.002f;
+
+    }  // namespace
+
+    void EchoFilter::Expire(Target* t, Clock::time_point now) const {
+        auto& w = t->writes;
+        w.erase(w.begin(), std::find_if(w.begin(), w.end(), [&](const Write& x) { return now - x.at < window_; }));
+    }
+
+    void EchoFilter::ForgetQuiet(Clock::time_point now) {
+        if (now < next_forget_) return;
+        next_forget_ = now + kForgetAfter;
+        for (auto it = targets_.begin(); it != targets_.end();) {
+            Expire(&it->second, now);
+            if (it->second.writes.empty() && now - it->second.seen >= kForgetAfter) {
+                it = targets_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    bool EchoFilter::Matches(const Write& w, const MixerChange& change) {
+        if (w.volume >= 0.0f && std::fabs(w.volume - change.volume) > kVolumeTolerance) return false;
+        return w.mute < 0 || (w.mute != 0) == change.mute;
+    }
+
+    void EchoFilter::NoteVolume(const std::string& id, float volume, Clock::time_point now) {
+        std::lock_guard<std::mutex> lock(mu_);
+        ForgetQuiet(now);
+        Target& t = targets_[id];
+        Expire(&t, now);
+        t.seen = now;
+        t.volume = std::clamp(volume, 0.0f, 1.0f);
+        t.writes.push_back({t.volume, t.mute, now});
+    }
+
+    void EchoFilter::NoteMute(const std::string& id, bool mute, Clock::time_point now) {
+        std::lock_guard<std::mutex> lock(mu_);
+        ForgetQuiet(now);
+        Target& t = targets_[id];
+        Expire(&t, now);
+        t.seen = now;
+        t.mute = mute ? 1 : 0;
+        t.writes.push_back({t.volume, t.mute, now});
+    }
+
+    bool EchoFilter::External(const MixerChange& change, const MixerContext* context, Clock::time_point now) {
+        std::lock_guard<std::mutex> lock(mu_);
+        ForgetQuiet(now);
+        Target& t = targets_[change.id];
+        Expire(&t, now);
+        t.seen = now;
+        t.volume = change.volume;
+        t.mute = change.mute ? 1 : 0;
+
+        auto hit = std::find_if(t.writes.begin(), t.writes.end(), [&](const Write& w) { return Matches(w, change); });
+        const bool in_flight = hit != t.writes.end();
+        const bool ours = context && *context == ProcessMixerContext();
+        // Ours but merged past recognition: it answers the oldest write.
+        if (ours && !in_flight && !t.writes.empty()) hit = t.writes.begin();
+        if (hit != t.writes.end()) t.writes.erase(t.writes.begin(), hit + 1);
+        if (!ours && !in_flight) return true;
+        echoes_++;
+        return false;
+    }
+
+    size_t EchoFilter::in_flight() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        size_t n = 0;
+        for (const auto& kv : targets_) n += kv.second.writes.size();
+        return n;
+    }
+
+    size_t EchoFilter::targets() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return targets_.size();
+    }
+
+}  // namespace volumedeck_mixer
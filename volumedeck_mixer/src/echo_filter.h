@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mixer_backend.h"
+
+namespace volumedeck_mixer {
+
+    // Tells the notifications of this process's own writes from real
+    // external changes, for a backend to run before its change observer.
+    // A notification tagged with ProcessMixerContext() is ours. Any other
+    // (another process, or no context: backends without one, changes the OS
+    // derives from ours) is matched against our writes still in flight: one
+    // reporting the state a recent write of ours left the target in is that
+    // write's echo, late or not, and retires it along with the writes before
+    // it. Thread-safe: writes come from the engine thread, notifications
+    // from the OS's.
+    //
+    // A target's last known volume and mute fill in the half a write
+    // doesn't set. Once it has nothing in flight and has been quiet for
+    // kForgetAfter it is dropped, so ids of sessions long gone don't pile
+    // up; its next write then matches either volume or mute.
+    class EchoFilter {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // A write not echoed within `window` is taken as lost (the server
+        // dropped it, or merged it with the next).
+        explicit EchoFilter(std::chrono::milliseconds window = std::chrono::milliseconds(500)) : window_(window) {}
+
+        // Before each write, so the echo never comes first. `id` as in
+        // MixerChange.
+        void NoteVolume(const std::string& id, float volume, Clock::time_point now = Clock::now());
+        void NoteMute(const std::string& id, bool mute, Clock::time_point now = Clock::now());
+
+        // True if `change` is someone else's and should be passed on.
+        // `context` is what the notification carried, null if nothing.
+        bool External(const MixerChange& change, const MixerContext* context, Clock::time_point now = Clock::now());
+
+        static constexpr std::chrono::seconds kForgetAfter{30};
+
+        size_t in_flight() const;
+        size_t targets() const;
+        uint64_t echoes() const { return echoes_.load(); }
+
+    private:
+        struct Write {
+            float volume;  // <0: not known
+            int mute;      // -1: not known
+            Clock::time_point at;
+        };
+        struct Target {
+            float volume = -1.0f;  // last known, from writes and notifications
+            int mute = -1;
+            std::vector<Write> writes;  // oldest first
+            Clock::time_point seen;     // last write or notification
+        };
+
+        void Expire(Target* t, Clock::time_point now) const;
+        // Drops quiet targets, at most once per kForgetAfter. Call with mu_
+        // held, before taking a Target reference.
+        void ForgetQuiet(Clock::time_point now);
+        static bool Matches(const Write& w, const MixerChange& change);
+
+        const std::chrono::milliseconds window_;
+        mutable std::mutex mu_;
+        std::unordered_map<std::string, Target> targets_;
+        Clock::time_point next_forget_{};
+        std::atomic<uint64_t> echoes_{0};
+    };
+
+}  // namespace volumedeck_mixer
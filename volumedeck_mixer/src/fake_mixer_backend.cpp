@@ -0,0 +1,224 @@
+#include "fake_mixer_backend.h"
+
+#include <algorithm>
+
+namespace volumedeck_mixer {
+
+    bool FakeMixerBackend::Start() {
+        starts_++;
+        if (start_fails_.load()) return false;
+        lost_.store(false);
+        return true;
+    }
+
+    bool FakeMixerBackend::ListSessions(std::vector<AudioSession>* out) {
+        std::lock_guard<std::mutex> lock(mu_);
+        out->clear();
+        for (const auto& kv : sessions_) out->push_back(kv.second);
+        return true;
+    }
+
+    bool FakeMixerBackend::GetMaster(float* volume, bool* mute, float* peak) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (volume) *volume = master_volume_;
+        if (mute) *mute = master_mute_;
+        if (peak) *peak = 0.0f;
+        return true;
+    }
+
+    bool FakeMixerBackend::SetMasterVolume(float volume) {
+        MixerChange change;
+        MixerContext context;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            master_volume_ = std::clamp(volume, 0.0f, 1.0f);
+            writes_++;
+            change = {"", master_volume_, master_mute_};
+            context = NoteOurs(change, true);
+        }
+        Notify(change, context);
+        return true;
+    }
+
+    bool FakeMixerBackend::SetMasterMute(bool mute) {
+        MixerChange change;
+        MixerContext context;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            master_mute_ = mute;
+            writes_++;
+            change = {"", master_volume_, master_mute_};
+            context = NoteOurs(change, false);
+        }
+        Notify(change, context);
+        return true;
+    }
+
+    bool FakeMixerBackend::SetSessionVolume(const std::string& id, float volume) {
+        MixerChange change;
+        MixerContext context;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            auto it = sessions_.find(id);
+            if (it == sessions_.end()) return false;
+            it->second.volume = std::clamp(volume, 0.0f, 1.0f);
+            writes_++;
+            change = {id, it->second.volume, it->second.mute};
+            context = NoteOurs(change, true);
+        }
+        Notify(change, context);
+        return true;
+    }
+
+    bool FakeMixerBackend::SetSessionMute(const std::string& id, bool mute) {
+        MixerChange change;
+        MixerContext context;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            auto it = sessions_.find(id);
+            if (it == sessions_.end()) return false;
+            it->second.mute = mute;
+            writes_++;
+            change = {id, it->second.volume, it->second.mute};
+            context = NoteOurs(change, false);
+        }
+        Notify(change, context);
+        return true;
+    }
+
+    bool FakeMixerBackend::SetChangeObserver(MixerChangeObserver observer) {
+        observer_ = std::move(observer);
+        return true;
+    }
+
+    MixerContext FakeMixerBackend::NoteOurs(const MixerChange& change, bool volume) {
+        // Nobody listening (the benchmarks): nothing to filter.
+        if (observer_ && volume) echo_.NoteVolume(change.id, change.volume);
+        if (observer_ && !volume) echo_.NoteMute(change.id, change.mute);
+        return tag_writes_.load() ? ProcessMixerContext() : MixerContext();
+    }
+
+    void FakeMixerBackend::ChangeExternally(const MixerChange& change) {
+        MixerChange applied = change;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (change.id.empty()) {
+                master_volume_ = applied.volume = std::clamp(change.volume, 0.0f, 1.0f);
+                master_mute_ = change.mute;
+            } else {
+                auto it = sessions_.find(change.id);
+                if (it == sessions_.end()) return;
+                it->second.volume = applied.volume = std::clamp(change.volume, 0.0f, 1.0f);
+                it->second.mute = change.mute;
+            }
+        }
+        // The Windows mixer, a game: anything but us.
+        MixerContext other;
+        other.bytes[0] = 0x5a;
+        Notify(applied, other);
+    }
+
+    void FakeMixerBackend::Notify(const MixerChange& change, const MixerContext& context) {
+        if (!observer_) return;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (hold_) {
+                held_.push_back({change, context});
+                return;
+            }
+        }
+        if (echo_.External(change, context.empty() ? nullptr : &context)) observer_(change);
+    }
+
+    void FakeMixerBackend::HoldChanges(bool hold) {
+        std::lock_guard<std::mutex> lock(mu_);
+        hold_ = hold;
+    }
+
+    size_t FakeMixerBackend::DeliverChanges() {
+        std::vector<Pending> held;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            held.swap(held_);
+        }
+        for (const Pending& p : held) {
+            if (echo_.External(p.change, p.context.empty() ? nullptr : &p.context)) observer_(p.change);
+        }
+        return held.size();
+    }
+
+    bool FakeMixerBackend::SetInputVolume(float volume) {
+        std::lock_guard<std::mutex> lock(mu_);
+        input_volume_ = std::clamp(volume, 0.0f, 1.0f);
+        writes_++;
+        return true;
+    }
+
+    bool FakeMixerBackend::SetDeviceVolume(const std::string& name, float volume) {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = devices_.find(name);
+        if (it == devices_.end()) return false;
+        it->second = std::clamp(volume, 0.0f, 1.0f);
+        writes_++;
+        return true;
+    }
+
+    void FakeMixerBackend::AddDevice(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mu_);
+        devices_.emplace(name, 1.0f);
+    }
+
+    std::string FakeMixerBackend::AddSession(const std::string& exe_name, uint32_t pid, bool system) {
+        std::lock_guard<std::mutex> lock(mu_);
+        AudioSession s;
+        s.id = "fake-session-" + std::to_string(next_id_++);
+        s.pid = pid;
+        s.exe_name = ExeBasenameLower(exe_name);
+        s.exe_path = exe_name;
+        s.display_name = exe_name;
+        s.system = system;
+        sessions_[s.id] = s;
+        generation_++;
+        return s.id;
+    }
+
+    void FakeMixerBackend::RemoveSession(const std::string& id) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (sessions_.erase(id)) generation_++;
+    }
+
+    void FakeMixerBackend::SetPeak(const std::string& id, float peak) {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = sessions_.find(id);
+        if (it != sessions_.end()) it->second.peak = peak;
+    }
+
+    float FakeMixerBackend::session_volume(const std::string& id) {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = sessions_.find(id);
+        return it == sessions_.end() ? -1.0f : it->second.volume;
+    }
+
+    bool FakeMixerBackend::session_mute(const std::string& id) {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = sessions_.find(id);
+        return it != sessions_.end() && it->second.mute;
+    }
+
+    float FakeMixerBackend::master_volume() {
+        std::lock_guard<std::mutex> lock(mu_);
+        return master_volume_;
+    }
+
+    float FakeMixerBackend::input_volume() {
+        std::lock_guard<std::mutex> lock(mu_);
+        return input_volume_;
+    }
+
+    float FakeMixerBackend::device_volume(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = devices_.find(name);
+        return it == devices_.end() ? -1.0f : it->second;
+    }
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "echo_filter.h"
+#include "mixer_backend.h"
+
+namespace volumedeck_mixer {
+
+    // In-memory mixer for tests, benchmarks and the daemon on machines
+    // without an audio server. Thread-safe, so tests can add and remove
+    // sessions while an engine drives it.
+    class FakeMixerBackend : public MixerBackend {
+    public:
+        const char* name() const override { return "fake"; }
+
+        // Fails while SetStartFails(true); clears lost() when it succeeds.
+        bool Start() override;
+        bool lost() const override { return lost_.load(); }
+
+        bool ListSessions(std::vector<AudioSession>* out) override;
+        bool GetMaster(float* volume, bool* mute, float* peak) override;
+        bool SetMasterVolume(float volume) override;
+        bool SetMasterMute(bool mute) override;
+        bool SetSessionVolume(const std::string& id, float volume) override;
+        bool SetSessionMute(const std::string& id, bool mute) override;
+        bool SetInputVolume(float volume) override;
+        bool SetDeviceVolume(const std::string& name, float volume) override;
+        uint32_t ForegroundPid() override { return foreground_.load(); }
+        uint64_t session_generation() const override { return generation_.load(); }
+        // Reports master and session volume/mute changes, synchronously on
+        // the writing thread unless held. Writes through the calls above
+        // are this process's and filtered like WASAPI's.
+        bool SetChangeObserver(MixerChangeObserver observer) override;
+
+        // Another app changing a master (empty id) or session volume/mute.
+        void ChangeExternally(const MixerChange& change);
+        // False: our writes' notifications come without a context, as from
+        // a backend that has none, and only the in-flight check sees them.
+        void SetTagWrites(bool tag) { tag_writes_.store(tag); }
+        // Queues notifications until DeliverChanges(), to have them arrive
+        // late, after later writes. Returns how many were delivered.
+        void HoldChanges(bool hold);
+        size_t DeliverChanges();
+        // The server going away: lost() until the next Start().
+        void LoseConnection() { lost_.store(true); }
+        void SetStartFails(bool fails) { start_fails_.store(fails); }
+        uint64_t start_count() const { return starts_.load(); }
+
+        // Test control. Returns the new session's id.
+        std::string AddSession(const std::string& exe_name, uint32_t pid, bool system = false);
+        void RemoveSession(const std::string& id);
+        void AddDevice(const std::string& name);
+        void SetForegroundPid(uint32_t pid) { foreground_.store(pid); }
+        void SetPeak(const std::string& id, float peak);
+
+        // Inspection. Missing sessions read as -1.
+        float session_volume(const std::string& id);
+        bool session_mute(const std::string& id);
+        float master_volume();
+        float input_volume();
+        float device_volume(const std::string& name);
+        uint64_t write_count() const { return writes_.load(); }
+        uint64_t echoes() const { return echo_.echoes(); }
+
+    private:
+        struct Pending {
+            MixerChange change;
+            MixerContext context;
+        };
+
+        // Call with mu_ held: notes a write of ours, returns its context.
+        MixerContext NoteOurs(const MixerChange& change, bool volume);
+        void Notify(const MixerChange& change, const MixerContext& context);
+
+        std::mutex mu_;
+        std::map<std::string, AudioSession> sessions_;
+        std::map<std::string, float> devices_;
+        float master_volume_ = 1.0f;
+        bool master_mute_ = false;
+        float input_volume_ = 1.0f;
+        uint64_t next_id_ = 1;
+        std::atomic<uint64_t> generation_{1};
+        std::atomic<uint64_t> writes_{0};
+        std::atomic<uint32_t> foreground_{0};
+        std::atomic<bool> lost_{false};
+        std::atomic<bool> start_fails_{false};
+        std::atomic<uint64_t> starts_{0};
+
+        MixerChangeObserver observer_;
+        EchoFilter echo_;
+        std::atomic<bool> tag_writes_{true};
+        bool hold_ = false;
+        std::vector<Pending> held_;
+    };
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,160 @@
+#include "file_util.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+
+namespace volumedeck_mixer {
+
+#ifdef _WIN32
+    std::wstring Utf8ToWide(const std::string& s) {
+        if (s.empty()) return L"";
+        int len = MultiByteToWideChar(CP_UTF8, 0, s.c_str(), (int)s.size(), nullptr, 0);
+        std::wstring out(len, L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, s.c_str(), (int)s.size(), &out[0], len);
+        return out;
+    }
+
+    bool WriteFileAtomic(const std::string& path, const void* data, size_t size) {
+        const std::wstring dst = Utf8ToWide(path);
+        const std::wstring tmp = dst + L".tmp";
+
+        HANDLE h = CreateFileW(tmp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                               FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (h == INVALID_HANDLE_VALUE) return false;
+
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        size_t left = size;
+        bool ok = true;
+        while (left > 0) {
+            DWORD chunk = left > 0x40000000 ? 0x40000000 : (DWORD)left;
+            DWORD written = 0;
+            if (!WriteFile(h, p, chunk, &written, nullptr) || written == 0) {
+                ok = false;
+                break;
+            }
+            p += written;
+            left -= written;
+        }
+        if (ok) ok = FlushFileBuffers(h) != FALSE;
+        CloseHandle(h);
+
+        if (!ok) {
+            DeleteFileW(tmp.c_str());
+            return false;
+        }
+        if (!MoveFileExW(tmp.c_str(), dst.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+            DeleteFileW(tmp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool ReadWholeFile(const std::string& path, std::vector<uint8_t>& out) {
+        HANDLE h = CreateFileW(Utf8ToWide(path).c_str(), GENERIC_READ,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (h == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(h, &size)) {
+            CloseHandle(h);
+            return false;
+        }
+        out.resize((size_t)size.QuadPart);
+        size_t done = 0;
+        while (done < out.size()) {
+            DWORD chunk = (out.size() - done) > 0x40000000 ? 0x40000000 : (DWORD)(out.size() - done);
+            DWORD read = 0;
+            if (!ReadFile(h, out.data() + done, chunk, &read, nullptr) || read == 0) break;
+            done += read;
+        }
+        CloseHandle(h);
+        out.resize(done);
+        return true;
+    }
+
+    bool StatFile(const std::string& path, uint64_t* size, int64_t* mtime) {
+        WIN32_FILE_ATTRIBUTE_DATA fad{};
+        if (!GetFileAttributesExW(Utf8ToWide(path).c_str(), GetFileExInfoStandard, &fad)) return false;
+        if (size) *size = ((uint64_t)fad.nFileSizeHigh << 32) | fad.nFileSizeLow;
+        if (mtime) {
+            *mtime = (int64_t)(((uint64_t)fad.ftLastWriteTime.dwHighDateTime << 32) |
+                               fad.ftLastWriteTime.dwLowDateTime);
+        }
+        return true;
+    }
+
+    bool RemoveFile(const std::string& path) {
+        return DeleteFileW(Utf8ToWide(path).c_str()) != FALSE;
+    }
+#else
+    bool WriteFileAtomic(const std::string& path, const void* data, size_t size) {
+        const std::string tmp = path + ".tmp";
+
+        int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        size_t left = size;
+        bool ok = true;
+        while (left > 0) {
+            ssize_t n = ::write(fd, p, left);
+            if (n <= 0) {
+                ok = false;
+                break;
+            }
+            p += n;
+            left -= (size_t)n;
+        }
+        if (ok) ok = ::fsync(fd) == 0;
+        ::close(fd);
+
+        if (!ok || ::rename(tmp.c_str(), path.c_str()) != 0) {
+            ::unlink(tmp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool ReadWholeFile(const std::string& path, std::vector<uint8_t>& out) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        out.resize((size_t)st.st_size);
+        size_t done = 0;
+        while (done < out.size()) {
+            ssize_t n = ::read(fd, out.data() + done, out.size() - done);
+            if (n <= 0) break;
+            done += (size_t)n;
+        }
+        ::close(fd);
+        out.resize(done);
+        return true;
+    }
+
+    bool StatFile(const std::string& path, uint64_t* size, int64_t* mtime) {
+        struct stat st {};
+        if (::stat(path.c_str(), &st) != 0) return false;
+        if (size) *size = (uint64_t)st.st_size;
+        if (mtime) *mtime = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+        return true;
+    }
+
+    bool RemoveFile(const std::string& path) {
+        return ::unlink(path.c_str()) == 0;
+    }
+#endif
+
+}  // namespace volumedeck_mixer
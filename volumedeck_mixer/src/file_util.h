@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace volumedeck_mixer {
+
+    // All paths are UTF-8, on Windows too (they come straight from Dart).
+
+    // Writes `size` bytes to `path + ".tmp"`, flushes it to disk and renames it
+    // over `path`, so readers see either the old file or the new one, never a
+    // half-written mix.
+    bool WriteFileAtomic(const std::string& path, const void* data, size_t size);
+
+    bool ReadWholeFile(const std::string& path, std::vector<uint8_t>& out);
+
+    // Size and modification time, as used for cache invalidation. The mtime
+    // unit is platform specific but stable for a given file system.
+    bool StatFile(const std::string& path, uint64_t* size, int64_t* mtime);
+
+    bool RemoveFile(const std::string& path);
+
+#ifdef _WIN32
+    std::wstring Utf8ToWide(const std::string& s);
+#endif
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace volumedeck_mixer {
+
+    // FNV-1a, 64 bit. Not cryptographic; used for cache keys and content
+    // addressing where a collision only costs a re-extraction.
+    constexpr uint64_t kFnvOffset = 0xcbf29ce484222325ULL;
+    constexpr uint64_t kFnvPrime = 0x100000001b3ULL;
+
+    inline uint64_t Fnv1a64(const void* data, size_t size, uint64_t seed = kFnvOffset) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        uint64_t h = seed;
+        for (size_t i = 0; i < size; i++) {
+            h ^= p[i];
+            h *= kFnvPrime;
+        }
+        return h;
+    }
+
+    inline uint64_t Fnv1a64(const std::string& s, uint64_t seed = kFnvOffset) {
+        return Fnv1a64(s.data(), s.size(), seed);
+    }
+
+}  // namespace volumedeck_mixer
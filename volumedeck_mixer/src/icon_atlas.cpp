@@ -0,0 +1,159 @@
+#include "icon_atlas.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace volumedeck_mixer {
+
+    // ---------- packer ----------
+
+    SkylinePacker::SkylinePacker(int width, int height) : width_(width), height_(height) {
+        skyline_.push_back({0, 0, width});
+    }
+
+    void SkylinePacker::Grow(int height) {
+        // Placement never depended on the old bottom, so nothing moves.
+        height_ = std::max(height_, height);
+    }
+
+    int SkylinePacker::used_height() const {
+        int h = 0;
+        for (const auto& s : skyline_) h = std::max(h, s.y);
+        return h;
+    }
+
+    bool SkylinePacker::Fits(size_t i, int w, int h, int* y) const {
+        const int x = skyline_[i].x;
+        if (x + w > width_) return false;
+        int top = 0;
+        int left = w;
+        for (size_t j = i; left > 0; j++) {
+            if (j >= skyline_.size()) return false;
+            top = std::max(top, skyline_[j].y);
+            if (top + h > height_) return false;
+            left -= skyline_[j].width;
+        }
+        *y = top;
+        return true;
+    }
+
+    bool SkylinePacker::Insert(int w, int h, AtlasRect* out) {
+        if (w <= 0 || h <= 0 || w > width_) return false;
+
+        // Bottom-left: lowest top edge, then the narrowest segment (keeps
+        // wide gaps for wide icons).
+        int best_bottom = INT_MAX, best_width = INT_MAX, best_y = 0;
+        size_t best = SIZE_MAX;
+        for (size_t i = 0; i < skyline_.size(); i++) {
+            int y;
+            if (!Fits(i, w, h, &y)) continue;
+            if (y + h < best_bottom || (y + h == best_bottom && skyline_[i].width < best_width)) {
+                best = i;
+                best_bottom = y + h;
+                best_width = skyline_[i].width;
+                best_y = y;
+            }
+        }
+        if (best == SIZE_MAX) return false;
+
+        out->x = skyline_[best].x;
+        out->y = best_y;
+        out->width = w;
+        out->height = h;
+        AddLevel(best, out->x, best_y, w, h);
+        used_area_ += (uint64_t)w * h;
+        return true;
+    }
+
+    void SkylinePacker::AddLevel(size_t i, int x, int y, int w, int h) {
+        skyline_.insert(skyline_.begin() + i, Segment{x, y + h, w});
+
+        // Trim the segments now covered by the new one.
+        for (size_t j = i + 1; j < skyline_.size();) {
+            const Segment& prev = skyline_[j - 1];
+            Segment& s = skyline_[j];
+            const int end = prev.x + prev.width;
+            if (s.x >= end) break;
+            const int shrink = end - s.x;
+            s.x += shrink;
+            s.width -= shrink;
+            if (s.width > 0) break;
+            skyline_.erase(skyline_.begin() + j);
+        }
+
+        // Merge neighbours at the same height.
+        for (size_t j = 0; j + 1 < skyline_.size();) {
+            if (skyline_[j].y == skyline_[j + 1].y) {
+                skyline_[j].width += skyline_[j + 1].width;
+                skyline_.erase(skyline_.begin() + j + 1);
+            } else {
+                j++;
+            }
+        }
+    }
+
+    // ---------- atlas ----------
+
+    IconAtlas::IconAtlas(int width, int padding, int max_height)
+        : packer_(width, std::min(64, max_height)), padding_(padding), max_height_(max_height) {
+        rgba_.assign((size_t)packer_.width() * packer_.height() * 4, 0);
+        row_version_.assign((size_t)packer_.height(), 0);
+    }
+
+    bool IconAtlas::Find(const std::string& key, AtlasRect* out) const {
+        auto it = rects_.find(key);
+        if (it == rects_.end()) return false;
+        *out = it->second;
+        return true;
+    }
+
+    bool IconAtlas::Add(const std::string& key, const IconImage& img, AtlasRect* out) {
+        if (Find(key, out)) return true;
+        if (img.width <= 0 || img.height <= 0 || img.rgba.size() != img.pixel_count() * 4) return false;
+
+        // Padding on the right/bottom of every cell is enough: cells to the
+        // left/top carry their own, and the sheet edge has no neighbour.
+        AtlasRect cell;
+        while (!packer_.Insert(img.width + padding_, img.height + padding_, &cell)) {
+            if (packer_.height() >= max_height_) return false;
+            packer_.Grow(std::min(max_height_, packer_.height() * 2));
+            // Width is fixed, so growing is an append: existing rows stay put.
+            rgba_.resize((size_t)packer_.width() * packer_.height() * 4, 0);
+            row_version_.resize((size_t)packer_.height(), 0);
+        }
+
+        const size_t stride = (size_t)packer_.width() * 4;
+        const size_t row = (size_t)img.width * 4;
+        for (int y = 0; y < img.height; y++) {
+            memcpy(&rgba_[(size_t)(cell.y + y) * stride + (size_t)cell.x * 4], &img.rgba[(size_t)y * row], row);
+        }
+
+        AtlasRect r{cell.x, cell.y, img.width, img.height};
+        rects_.emplace(key, r);
+        icon_area_ += img.pixel_count();
+        version_++;
+        std::fill(row_version_.begin() + r.y, row_version_.begin() + r.y + r.height, version_);
+        *out = r;
+        return true;
+    }
+
+    bool IconAtlas::RowsChangedSince(uint32_t version, int* first, int* last) const {
+        const int n = (int)row_version_.size();
+        int a = 0;
+        while (a < n && row_version_[a] <= version) a++;
+        if (a == n) return false;
+        int b = n;
+        while (row_version_[b - 1] <= version) b--;
+        *first = a;
+        *last = b;
+        return true;
+    }
+
+    double IconAtlas::occupancy() const {
+        const int used = packer_.used_height();
+        if (used == 0) return 0.0;
+        return (double)icon_area_ / ((double)packer_.width() * used);
+    }
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "icon_pixels.h"
+
+namespace volumedeck_mixer {
+
+    struct AtlasRect {
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    // Skyline bottom-left packer (Jylänki, "A Thousand Ways to Pack the
+    // Bin"). The sheet has a fixed width and a height that may only grow,
+    // so every rectangle handed out stays valid for the packer's lifetime.
+    class SkylinePacker {
+    public:
+        SkylinePacker(int width, int height);
+
+        // Places a w x h rectangle as low as possible. False if it does not
+        // fit under the current height; Grow() and retry.
+        bool Insert(int w, int h, AtlasRect* out);
+        void Grow(int height);
+
+        int width() const { return width_; }
+        int height() const { return height_; }
+        // Highest skyline point: the part of the sheet actually in use.
+        int used_height() const;
+        uint64_t used_area() const { return used_area_; }
+
+    private:
+        struct Segment {
+            int x;
+            int y;
+            int width;
+        };
+
+        // Lowest y at which a w x h rectangle can sit starting at segment i.
+        bool Fits(size_t i, int w, int h, int* y) const;
+        void AddLevel(size_t i, int x, int y, int w, int h);
+
+        int width_;
+        int height_;
+        uint64_t used_area_ = 0;
+        std::vector<Segment> skyline_;  // left to right, covering [0, width)
+    };
+
+    // One RGBA sheet holding many icons, for the process pickers: a single
+    // GPU upload instead of one image per row. Icons are only ever appended;
+    // existing rectangles and pixels never move, so callers can keep rects
+    // from earlier calls across updates.
+    class IconAtlas {
+    public:
+        // `padding` transparent px between icons keeps filtered sampling
+        // from bleeding into neighbours.
+        explicit IconAtlas(int width = 512, int padding = 1, int max_height = 4096);
+
+        // Copies premultiplied `img` into the sheet under `key`. An existing
+        // key returns its rect unchanged. False when the sheet is full.
+        bool Add(const std::string& key, const IconImage& img, AtlasRect* out);
+        bool Find(const std::string& key, AtlasRect* out) const;
+
+        int width() const { return packer_.width(); }
+        int height() const { return packer_.height(); }
+        const std::vector<uint8_t>& rgba() const { return rgba_; }
+        size_t count() const { return rects_.size(); }
+
+        // Bumped by every Add that changed pixels.
+        uint32_t version() const { return version_; }
+
+        // Rows [first, last) written after `version`, for a caller that has
+        // the sheet as of that version. False if nothing changed. Rows past
+        // that caller's height and outside the range are transparent.
+        bool RowsChangedSince(uint32_t version, int* first, int* last) const;
+
+        // Icon pixels over the used part of the sheet (width x used height).
+        double occupancy() const;
+
+    private:
+        SkylinePacker packer_;
+        const int padding_;
+        const int max_height_;
+        std::vector<uint8_t> rgba_;
+        std::unordered_map<std::string, AtlasRect> rects_;
+        uint64_t icon_area_ = 0;
+        uint32_t version_ = 0;
+        std::vector<uint32_t> row_version_;  // version that last wrote each row
+    };
+
+}  // namespace volumedeck_mixer
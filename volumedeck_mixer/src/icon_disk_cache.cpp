@@ -0,0 +1,129 @@
+#include "icon_disk_cache.h"
+
+#include "file_util.h"
+
+namespace volumedeck_mixer {
+
+    IconDiskCache::IconDiskCache(std::string pack_path) : path_(std::move(pack_path)) {}
+
+    IconDiskCache::~IconDiskCache() {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        if (worker_.joinable()) worker_.join();
+
+        std::lock_guard<std::mutex> lock(mu_);
+        CompactLocked();
+    }
+
+    void IconDiskCache::EnsureOpenLocked() {
+        if (opened_) return;
+        opened_ = true;
+        reader_.Open(path_);  // missing/corrupt -> empty, rebuilt on next compaction
+    }
+
+    bool IconDiskCache::Lookup(const IconCacheKey& key, std::vector<uint8_t>& out,
+                               IconFormat format) {
+        std::lock_guard<std::mutex> lock(mu_);
+
+        auto it = pending_.find(IconSlotHash(key.path, key.icon_size, format));
+        if (it != pending_.end()) {
+            const Pending& p = it->second;
+            if (p.format != format || p.key.icon_size != key.icon_size || p.key.file_size != key.file_size ||
+                p.key.mtime != key.mtime) {
+                return false;
+            }
+            out = p.bytes;
+            return true;
+        }
+
+        EnsureOpenLocked();
+        IconBlob blob;
+        if (!reader_.Find(key, &blob, format)) return false;
+        out.assign(blob.data, blob.data + blob.size);
+        return true;
+    }
+
+    void IconDiskCache::Insert(const IconCacheKey& key, IconFormat format,
+                               std::vector<uint8_t> bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            Pending& p = pending_[IconSlotHash(key.path, key.icon_size, format)];
+            p.key = key;
+            p.format = format;
+            p.bytes = std::move(bytes);
+            last_insert_ = std::chrono::steady_clock::now();
+        }
+        cv_.notify_all();
+    }
+
+    bool IconDiskCache::Compact() {
+        std::lock_guard<std::mutex> lock(mu_);
+        return CompactLocked();
+    }
+
+    bool IconDiskCache::CompactLocked() {
+        if (pending_.empty()) return true;
+        EnsureOpenLocked();
+
+        IconPackWriter w;
+        for (size_t i = 0; i < reader_.entry_count(); i++) {
+            const PackEntry& e = reader_.entry(i);
+            w.AddEntry(e, reader_.blob(e).data);
+        }
+        for (const auto& kv : pending_) {
+            const Pending& p = kv.second;
+            w.Add(p.key, p.format, p.bytes.data(), p.bytes.size());
+        }
+
+        std::vector<uint8_t> bytes;
+        w.Build(bytes);
+
+        // The old blobs have been copied out; release the mapping so the
+        // rename can replace the file on Windows.
+        reader_.Close();
+        const bool ok = WriteFileAtomic(path_, bytes.data(), bytes.size());
+        reader_.Open(path_);
+        if (ok) pending_.clear();
+        return ok;
+    }
+
+    void IconDiskCache::StartBackgroundCompaction(std::chrono::milliseconds quiet_period) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (worker_.joinable()) return;
+        worker_ = std::thread([this, quiet_period] { WorkerLoop(quiet_period); });
+    }
+
+    void IconDiskCache::WorkerLoop(std::chrono::milliseconds quiet_period) {
+        std::unique_lock<std::mutex> lock(mu_);
+        while (!stop_) {
+            cv_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+            if (stop_) break;
+
+            // Wait until no insert arrived for a whole quiet period, so a
+            // picker full of icons causes one rewrite instead of hundreds.
+            while (!stop_) {
+                auto due = last_insert_ + quiet_period;
+                if (std::chrono::steady_clock::now() >= due) break;
+                cv_.wait_until(lock, due);
+            }
+            if (stop_) break;
+            // On failure (disk full, file locked) retry after another period.
+            if (!CompactLocked()) last_insert_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    size_t IconDiskCache::pending_count() {
+        std::lock_guard<std::mutex> lock(mu_);
+        return pending_.size();
+    }
+
+    size_t IconDiskCache::packed_count() {
+        std::lock_guard<std::mutex> lock(mu_);
+        EnsureOpenLocked();
+        return reader_.entry_count();
+    }
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "icon_pack.h"
+
+namespace volumedeck_mixer {
+
+    // Persistent icon cache over a single IconPack file.
+    //
+    // Lookups go to the memory-mapped pack (opened on first use) and to the
+    // entries inserted since the last compaction. Compaction writes a fresh
+    // pack containing both and swaps it in; with StartBackgroundCompaction()
+    // that happens on a worker thread once inserts have been quiet for a
+    // while, and always on destruction.
+    class IconDiskCache {
+    public:
+        explicit IconDiskCache(std::string pack_path);
+        ~IconDiskCache();
+
+        IconDiskCache(const IconDiskCache&) = delete;
+        IconDiskCache& operator=(const IconDiskCache&) = delete;
+
+        // PNG and raw pixels of one icon are separate entries.
+        bool Lookup(const IconCacheKey& key, std::vector<uint8_t>& out,
+                    IconFormat format = IconFormat::kPng);
+        void Insert(const IconCacheKey& key, IconFormat format, std::vector<uint8_t> bytes);
+
+        // Rewrites the pack if anything was inserted. Safe to call from any
+        // thread; lookups wait while the file is swapped.
+        bool Compact();
+
+        void StartBackgroundCompaction(std::chrono::milliseconds quiet_period);
+
+        size_t pending_count();
+        size_t packed_count();
+
+    private:
+        struct Pending {
+            IconCacheKey key;
+            IconFormat format;
+            std::vector<uint8_t> bytes;
+        };
+
+        void EnsureOpenLocked();
+        bool CompactLocked();
+        void WorkerLoop(std::chrono::milliseconds quiet_period);
+
+        const std::string path_;
+
+        std::mutex mu_;
+        IconPackReader reader_;
+        bool opened_ = false;
+        std::unordered_map<uint64_t, Pending> pending_;
+
+        std::thread worker_;
+        std::condition_variable cv_;
+        bool stop_ = false;
+        std::chrono::steady_clock::time_point last_insert_{};
+    };
+
+}  // namespace volumedeck_mixer
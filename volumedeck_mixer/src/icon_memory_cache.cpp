@@ -0,0 +1,82 @@
+#include "icon_memory_cache.h"
+
+#include <iterator>
+
+namespace volumedeck_mixer {
+
+    IconMemoryCache::IconMemoryCache(size_t byte_budget) : budget_(byte_budget) {}
+
+    std::shared_ptr<const IconPyramid> IconMemoryCache::Get(const IconCacheKey& key) {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = index_.find(key.path);
+        if (it == index_.end()) {
+            misses_++;
+            return nullptr;
+        }
+        if (it->second->file_size != key.file_size || it->second->mtime != key.mtime) {
+            EraseLocked(it->second);  // exe was updated
+            misses_++;
+            return nullptr;
+        }
+        lru_.splice(lru_.begin(), lru_, it->second);
+        hits_++;
+        return lru_.front().pyramid;
+    }
+
+    void IconMemoryCache::Put(const IconCacheKey& key, std::shared_ptr<const IconPyramid> pyramid) {
+        if (!pyramid) return;
+        const size_t size = pyramid->byte_size();
+
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = index_.find(key.path);
+        if (it != index_.end()) EraseLocked(it->second);
+        if (size > budget_) return;
+
+        while (bytes_ + size > budget_ && !lru_.empty()) {
+            EraseLocked(std::prev(lru_.end()));
+            evictions_++;
+        }
+        lru_.push_front(Entry{key.path, key.file_size, key.mtime, std::move(pyramid), size});
+        index_[key.path] = lru_.begin();
+        bytes_ += size;
+    }
+
+    void IconMemoryCache::Clear() {
+        std::lock_guard<std::mutex> lock(mu_);
+        lru_.clear();
+        index_.clear();
+        bytes_ = 0;
+    }
+
+    void IconMemoryCache::EraseLocked(List::iterator it) {
+        bytes_ -= it->bytes;
+        index_.erase(it->path);
+        lru_.erase(it);
+    }
+
+    size_t IconMemoryCache::bytes() {
+        std::lock_guard<std::mutex> lock(mu_);
+        return bytes_;
+    }
+
+    size_t IconMemoryCache::count() {
+        std::lock_guard<std::mutex> lock(mu_);
+        return lru_.size();
+    }
+
+    uint64_t IconMemoryCache::hits() {
+        std::lock_guard<std::mutex> lock(mu_);
+        return hits_;
+    }
+
+    uint64_t IconMemoryCache::misses() {
+        std::lock_guard<std::mutex> lock(mu_);
+        return misses_;
+    }
+
+    uint64_t IconMemoryCache::evictions() {
+        std::lock_guard<std::mutex> lock(mu_);
+        return evictions_;
+    }
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "icon_pack.h"
+#include "icon_resample.h"
+
+namespace volumedeck_mixer {
+
+    // In-process LRU of decoded icon pyramids, bounded by pixel bytes rather
+    // than entry count (a 16 px-only shell icon and a full pyramid differ by
+    // an order of magnitude).
+    //
+    // Keyed like the disk cache minus the icon size: one entry per exe, and a
+    // changed size/mtime is a miss that drops the stale pyramid.
+    class IconMemoryCache {
+    public:
+        explicit IconMemoryCache(size_t byte_budget);
+
+        IconMemoryCache(const IconMemoryCache&) = delete;
+        IconMemoryCache& operator=(const IconMemoryCache&) = delete;
+
+        // Shared so a caller can keep using a pyramid that is evicted
+        // meanwhile. Marks the entry most recently used.
+        std::shared_ptr<const IconPyramid> Get(const IconCacheKey& key);
+
+        // Replaces any entry for the same path. Pyramids larger than the
+        // whole budget are not kept.
+        void Put(const IconCacheKey& key, std::shared_ptr<const IconPyramid> pyramid);
+
+        void Clear();
+
+        size_t byte_budget() const { return budget_; }
+        size_t bytes();
+        size_t count();
+        uint64_t hits();
+        uint64_t misses();
+        uint64_t evictions();
+
+    private:
+        struct Entry {
+            std::string path;
+            uint64_t file_size;
+            int64_t mtime;
+            std::shared_ptr<const IconPyramid> pyramid;
+            size_t bytes;
+        };
+        using List = std::list<Entry>;
+
+        void EraseLocked(List::iterator it);
+
+        const size_t budget_;
+
+        std::mutex mu_;
+        List lru_;  // front = most recently used
+        std::unordered_map<std::string, List::iterator> index_;
+        size_t bytes_ = 0;
+        uint64_t hits_ = 0;
+        uint64_t misses_ = 0;
+        uint64_t evictions_ = 0;
+    };
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,195 @@
+#include "icon_pack.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "file_util.h"
+#include "hash.h"
+
+namespace volumedeck_mixer {
+
+    static const char kPackMagic[4] = {'V', 'D', 'I', 'P'};
+
+    std::string NormalizeIconPath(const std::string& path) {
+        std::string out;
+        out.reserve(path.size());
+        for (char c : path) {
+            if (c == '\\') c = '/';
+            if (c == '/' && !out.empty() && out.back() == '/' && out.size() > 1) continue;
+            if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+            out.push_back(c);
+        }
+        return out;
+    }
+
+    bool MakeIconCacheKey(const std::string& path, int icon_size, IconCacheKey* out) {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        if (!StatFile(path, &size, &mtime)) return false;
+        out->path = NormalizeIconPath(path);
+        out->file_size = size;
+        out->mtime = mtime;
+        out->icon_size = (uint16_t)std::clamp(icon_size, 0, 0xFFFF);
+        return true;
+    }
+
+    uint64_t IconSlotHash(const std::string& normalized_path, uint16_t icon_size, IconFormat format) {
+        uint64_t h = Fnv1a64(normalized_path);
+        h = Fnv1a64(&icon_size, sizeof(icon_size), h);
+        return Fnv1a64(&format, sizeof(format), h);
+    }
+
+    // ---------- reader ----------
+
+    bool IconPackReader::Open(const std::string& path) {
+        Close();
+        if (!file_.Open(path)) return false;
+
+        const uint8_t* base = file_.data();
+        const size_t size = file_.size();
+        if (size < sizeof(PackHeader)) {
+            Close();
+            return false;
+        }
+
+        PackHeader h;
+        memcpy(&h, base, sizeof(h));
+        const uint64_t index_bytes = (uint64_t)h.entry_count * sizeof(PackEntry);
+        if (memcmp(h.magic, kPackMagic, 4) != 0 || h.version != kIconPackVersion ||
+            h.file_size != size || h.index_offset < sizeof(PackHeader) ||
+            h.index_offset > size || index_bytes > size - h.index_offset) {
+            Close();
+            return false;
+        }
+
+        // Entries are 8-byte aligned by construction (the writer pads the blob
+        // area), so they can be used straight out of the mapping.
+        if (h.index_offset % alignof(uint64_t) != 0) {
+            Close();
+            return false;
+        }
+        entries_ = reinterpret_cast<const PackEntry*>(base + h.index_offset);
+        count_ = h.entry_count;
+
+        for (size_t i = 0; i < count_; i++) {
+            const PackEntry& e = entries_[i];
+            if (e.blob_offset < sizeof(PackHeader) || e.blob_offset > h.index_offset ||
+                e.blob_length > h.index_offset - e.blob_offset) {
+                Close();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void IconPackReader::Close() {
+        file_.Close();
+        entries_ = nullptr;
+        count_ = 0;
+    }
+
+    IconBlob IconPackReader::blob(const PackEntry& e) const {
+        IconBlob b;
+        b.data = file_.data() + e.blob_offset;
+        b.size = e.blob_length;
+        b.format = (IconFormat)e.format;
+        return b;
+    }
+
+    const PackEntry* IconPackReader::FindSlot(uint64_t key_hash) const {
+        if (!entries_) return nullptr;
+        const PackEntry* end = entries_ + count_;
+        const PackEntry* it = std::lower_bound(
+                entries_, end, key_hash,
+                [](const PackEntry& e, uint64_t k) { return e.key_hash < k; });
+        if (it == end || it->key_hash != key_hash) return nullptr;
+        return it;
+    }
+
+    bool IconPackReader::Find(const IconCacheKey& key, IconBlob* out, IconFormat format) const {
+        const PackEntry* e = FindSlot(IconSlotHash(key.path, key.icon_size, format));
+        if (!e) return false;
+        if (e->icon_size != key.icon_size || e->format != (uint16_t)format || e->file_size != key.file_size ||
+            e->mtime != key.mtime) {
+            return false;
+        }
+        *out = blob(*e);
+        return true;
+    }
+
+    // ---------- writer ----------
+
+    void IconPackWriter::Add(const IconCacheKey& key, IconFormat format, const uint8_t* data,
+                             size_t size) {
+        PackEntry e{};
+        e.key_hash = IconSlotHash(key.path, key.icon_size, format);
+        e.content_hash = Fnv1a64(data, size);
+        e.mtime = key.mtime;
+        e.file_size = key.file_size;
+        e.blob_length = (uint32_t)size;
+        e.icon_size = key.icon_size;
+        e.format = (uint16_t)format;
+        AddEntry(e, data);
+    }
+
+    void IconPackWriter::AddEntry(const PackEntry& e, const uint8_t* data) {
+        Pending p;
+        p.entry = e;
+        p.bytes.assign(data, data + e.blob_length);
+
+        auto it = by_slot_.find(e.key_hash);
+        if (it != by_slot_.end()) {
+            entries_[it->second] = std::move(p);
+            return;
+        }
+        by_slot_[e.key_hash] = entries_.size();
+        entries_.push_back(std::move(p));
+    }
+
+    void IconPackWriter::Build(std::vector<uint8_t>& out) const {
+        std::vector<PackEntry> index;
+        index.reserve(entries_.size());
+
+        out.assign(sizeof(PackHeader), 0);
+
+        // content hash -> offset of the first blob with those bytes
+        std::unordered_map<uint64_t, uint64_t> written;
+        for (const auto& p : entries_) {
+            PackEntry e = p.entry;
+            auto it = written.find(e.content_hash);
+            if (it != written.end() && e.blob_length > 0 &&
+                memcmp(out.data() + it->second, p.bytes.data(), e.blob_length) == 0) {
+                e.blob_offset = it->second;
+            } else {
+                e.blob_offset = out.size();
+                out.insert(out.end(), p.bytes.begin(), p.bytes.end());
+                if (it == written.end()) written[e.content_hash] = e.blob_offset;
+            }
+            index.push_back(e);
+        }
+
+        while (out.size() % alignof(uint64_t) != 0) out.push_back(0);
+
+        std::sort(index.begin(), index.end(),
+                  [](const PackEntry& a, const PackEntry& b) { return a.key_hash < b.key_hash; });
+
+        PackHeader h{};
+        memcpy(h.magic, kPackMagic, 4);
+        h.version = kIconPackVersion;
+        h.entry_count = (uint32_t)index.size();
+        h.index_offset = out.size();
+        h.file_size = out.size() + index.size() * sizeof(PackEntry);
+
+        const size_t index_at = out.size();
+        out.resize((size_t)h.file_size);
+        if (!index.empty()) memcpy(out.data() + index_at, index.data(), index.size() * sizeof(PackEntry));
+        memcpy(out.data(), &h, sizeof(h));
+    }
+
+    bool IconPackWriter::WriteTo(const std::string& path) const {
+        std::vector<uint8_t> bytes;
+        Build(bytes);
+        return WriteFileAtomic(path, bytes.data(), bytes.size());
+    }
+
+}  // namespace volumedeck_mixer
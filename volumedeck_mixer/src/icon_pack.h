@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mapped_file.h"
+
+namespace volumedeck_mixer {
+
+    // On-disk icon pack: one file holding every cached icon plus a sorted index.
+    //
+    //   PackHeader                       32 bytes
+    //   blob data                        deduplicated by content hash
+    //   PackEntry[entry_count]           sorted by key_hash
+    //
+    // Everything is little endian and read in place from a memory mapping, so
+    // the same file works on every platform we build for.
+
+    enum class IconFormat : uint16_t {
+        kPng = 0,
+        kRgba8Premul = 1,  // SerializeIconImage layout, see icon_pixels.h
+        kPyramid = 2,      // SerializeIconPyramid layout, see icon_resample.h
+    };
+
+    // What an icon depends on. A changed size or mtime means the exe was
+    // updated and the cached icon must not be used.
+    struct IconCacheKey {
+        std::string path;        // normalized, see NormalizeIconPath
+        uint64_t file_size = 0;
+        int64_t mtime = 0;
+        uint16_t icon_size = 0;  // requested edge length in px
+    };
+
+    // Lowercase, forward slashes, no duplicate separators. Windows paths are
+    // case-insensitive and Dart hands us both separator styles.
+    std::string NormalizeIconPath(const std::string& path);
+
+    // Builds a key from the file on disk. Returns false if the file is gone.
+    bool MakeIconCacheKey(const std::string& path, int icon_size, IconCacheKey* out);
+
+    // Identifies a (path, icon size, format) slot; stat fields are checked
+    // separately so that a new version of an exe replaces its old entry. A
+    // PNG and the raw pixels of the same icon live side by side.
+    uint64_t IconSlotHash(const std::string& normalized_path, uint16_t icon_size,
+                          IconFormat format = IconFormat::kPng);
+
+#pragma pack(push, 1)
+    struct PackHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t entry_count;
+        uint32_t reserved;
+        uint64_t index_offset;
+        uint64_t file_size;
+    };
+
+    struct PackEntry {
+        uint64_t key_hash;
+        uint64_t content_hash;
+        int64_t mtime;
+        uint64_t file_size;
+        uint64_t blob_offset;
+        uint32_t blob_length;
+        uint16_t icon_size;
+        uint16_t format;
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(PackHeader) == 32, "pack header layout");
+    static_assert(sizeof(PackEntry) == 48, "pack entry layout");
+
+    // 2: the format is part of the slot hash.
+    constexpr uint32_t kIconPackVersion = 2;
+
+    struct IconBlob {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        IconFormat format = IconFormat::kPng;
+    };
+
+    class IconPackReader {
+    public:
+        // Maps the pack and validates header and index bounds. A missing or
+        // corrupt file simply reads as empty.
+        bool Open(const std::string& path);
+        void Close();
+
+        bool is_open() const { return entries_ != nullptr; }
+        size_t entry_count() const { return count_; }
+        const PackEntry& entry(size_t i) const { return entries_[i]; }
+        IconBlob blob(const PackEntry& e) const;
+
+        // Valid until Close(). Misses on stale stat data.
+        bool Find(const IconCacheKey& key, IconBlob* out, IconFormat format = IconFormat::kPng) const;
+        const PackEntry* FindSlot(uint64_t key_hash) const;
+
+    private:
+        MappedFile file_;
+        const PackEntry* entries_ = nullptr;
+        size_t count_ = 0;
+    };
+
+    class IconPackWriter {
+    public:
+        // Later Add() calls for the same slot win.
+        void Add(const IconCacheKey& key, IconFormat format, const uint8_t* data, size_t size);
+        void AddEntry(const PackEntry& e, const uint8_t* data);
+
+        size_t entry_count() const { return entries_.size(); }
+
+        // Serializes into `out` (sorted index, one copy of each distinct blob).
+        void Build(std::vector<uint8_t>& out) const;
+        bool WriteTo(const std::string& path) const;
+
+    private:
+        struct Pending {
+            PackEntry entry;
+            std::vector<uint8_t> bytes;
+        };
+        std::vector<Pending> entries_;
+        std::unordered_map<uint64_t, size_t> by_slot_;
+    };
+
+}  // namespace volumedeck_mixer
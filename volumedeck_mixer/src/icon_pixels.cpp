@@ -0,0 +1,98 @@
+#include "icon_pixels.h"
+
+#include <cstring>
+
+namespace volumedeck_mixer {
+
+    // Exact rounding of x * a / 255 without a division.
+    static inline uint8_t MulDiv255(uint32_t x, uint32_t a) {
+        uint32_t t = x * a + 128;
+        return (uint8_t)((t + (t >> 8)) >> 8);
+    }
+
+    void BgraToPremultipliedRgba(const uint8_t* src, uint8_t* dst, size_t pixel_count) {
+        for (size_t i = 0; i < pixel_count; i++) {
+            const uint8_t b = src[0], g = src[1], r = src[2], a = src[3];
+            if (a == 255) {
+                dst[0] = r;
+                dst[1] = g;
+                dst[2] = b;
+            } else {
+                dst[0] = MulDiv255(r, a);
+                dst[1] = MulDiv255(g, a);
+                dst[2] = MulDiv255(b, a);
+            }
+            dst[3] = a;
+            src += 4;
+            dst += 4;
+        }
+    }
+
+    void PremultipliedToStraightRgba(const uint8_t* src, uint8_t* dst, size_t pixel_count) {
+        for (size_t i = 0; i < pixel_count; i++) {
+            const uint32_t a = src[3];
+            if (a == 255) {
+                memmove(dst, src, 4);
+            } else if (a == 0) {
+                memset(dst, 0, 4);
+            } else {
+                for (int c = 0; c < 3; c++) {
+                    const uint32_t v = (src[c] * 255u + a / 2) / a;
+                    dst[c] = (uint8_t)(v > 255 ? 255 : v);
+                }
+                dst[3] = (uint8_t)a;
+            }
+            src += 4;
+            dst += 4;
+        }
+    }
+
+    bool AllAlphaZero(const uint8_t* bgra, size_t pixel_count) {
+        for (size_t i = 0; i < pixel_count; i++) {
+            if (bgra[i * 4 + 3] != 0) return false;
+        }
+        return true;
+    }
+
+    void ForceOpaque(uint8_t* bgra, size_t pixel_count) {
+        for (size_t i = 0; i < pixel_count; i++) bgra[i * 4 + 3] = 255;
+    }
+
+    void IconImageFromBgra(const uint8_t* bgra, int width, int height, IconImage* out) {
+        out->width = width;
+        out->height = height;
+        const size_t n = out->pixel_count();
+        out->rgba.resize(n * 4);
+        if (n == 0) return;
+
+        if (AllAlphaZero(bgra, n)) {
+            memcpy(out->rgba.data(), bgra, n * 4);
+            ForceOpaque(out->rgba.data(), n);
+            BgraToPremultipliedRgba(out->rgba.data(), out->rgba.data(), n);
+            return;
+        }
+        BgraToPremultipliedRgba(bgra, out->rgba.data(), n);
+    }
+
+    void SerializeIconImage(const IconImage& img, std::vector<uint8_t>& out) {
+        out.resize(4 + img.rgba.size());
+        const uint16_t w = (uint16_t)img.width;
+        const uint16_t h = (uint16_t)img.height;
+        memcpy(out.data(), &w, 2);
+        memcpy(out.data() + 2, &h, 2);
+        if (!img.rgba.empty()) memcpy(out.data() + 4, img.rgba.data(), img.rgba.size());
+    }
+
+    bool DeserializeIconImage(const uint8_t* data, size_t size, IconImage* out) {
+        if (size < 4) return false;
+        uint16_t w = 0, h = 0;
+        memcpy(&w, data, 2);
+        memcpy(&h, data + 2, 2);
+        if ((size_t)w * h * 4 != size - 4) return false;
+        out->width = w;
+        out->height = h;
+        out->rgba.assign(data + 4, data + size);
+        return true;
+    }
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace volumedeck_mixer {
+
+    // Decoded icon, premultiplied RGBA8, tightly packed rows. This is the
+    // layout Flutter's decodeImageFromPixels(rgba8888) takes as-is, so raw
+    // transfer needs no encode on the native side and no decode in Dart.
+    struct IconImage {
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> rgba;
+
+        size_t pixel_count() const { return (size_t)width * (size_t)height; }
+    };
+
+    // Straight-alpha BGRA (GDI DIB / WIC 32bppBGRA) -> premultiplied RGBA.
+    // `src` and `dst` may alias.
+    void BgraToPremultipliedRgba(const uint8_t* src, uint8_t* dst, size_t pixel_count);
+
+    // Premultiplied RGBA -> straight-alpha RGBA, for encoders (PNG) that
+    // expect it. Colour of fully transparent pixels becomes 0. May alias.
+    void PremultipliedToStraightRgba(const uint8_t* src, uint8_t* dst, size_t pixel_count);
+
+    // GDI leaves alpha at zero for icons without an alpha channel; such an
+    // image is meant to be opaque.
+    bool AllAlphaZero(const uint8_t* bgra, size_t pixel_count);
+    void ForceOpaque(uint8_t* bgra, size_t pixel_count);
+
+    // Convenience for the extractor: fixes up GDI alpha, converts, and fills
+    // `out` (reusing its buffer).
+    void IconImageFromBgra(const uint8_t* bgra, int width, int height, IconImage* out);
+
+    // Raw icons in the on-disk pack: u16 width, u16 height, then pixels.
+    void SerializeIconImage(const IconImage& img, std::vector<uint8_t>& out);
+    bool DeserializeIconImage(const uint8_t* data, size_t size, IconImage* out);
+
+}  // namespace volumedeck_mixer
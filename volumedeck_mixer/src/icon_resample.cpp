@@ -0,0 +1,283 @@
+#include "icon_resample.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "simd.h"
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        constexpr double kPi = 3.14159265358979323846;
+
+        double Lanczos3(double x) {
+            x = std::fabs(x);
+            if (x < 1e-9) return 1.0;
+            if (x >= 3.0) return 0.0;
+            const double px = kPi * x;
+            return 3.0 * std::sin(px) * std::sin(px / 3.0) / (px * px);
+        }
+
+        // Four channels of one pixel per vector. Clamping on store keeps
+        // colour <= alpha <= 255 after Lanczos overshoot.
+#if defined(VOLUMEDECK_SSE2)
+        using F4 = __m128;
+
+        inline F4 LoadPixel(const uint8_t* p) {
+            int32_t v;
+            memcpy(&v, p, 4);
+            const __m128i zero = _mm_setzero_si128();
+            __m128i x = _mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero);
+            return _mm_cvtepi32_ps(_mm_unpacklo_epi16(x, zero));
+        }
+        inline F4 Load(const float* p) { return _mm_loadu_ps(p); }
+        inline void Store(float* p, F4 v) { _mm_storeu_ps(p, v); }
+        inline F4 Splat(float w) { return _mm_set1_ps(w); }
+        inline F4 Zero() { return _mm_setzero_ps(); }
+        inline F4 MulAdd(F4 acc, F4 a, F4 w) { return _mm_add_ps(acc, _mm_mul_ps(a, w)); }
+        inline void StorePixel(uint8_t* p, F4 v) {
+            F4 a = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+            a = _mm_min_ps(a, _mm_set1_ps(255.0f));
+            v = _mm_max_ps(_mm_min_ps(v, a), _mm_setzero_ps());
+            __m128i i = _mm_cvtps_epi32(v);  // round to nearest
+            i = _mm_packs_epi32(i, i);
+            i = _mm_packus_epi16(i, i);
+            const int32_t out = _mm_cvtsi128_si32(i);
+            memcpy(p, &out, 4);
+        }
+#elif defined(VOLUMEDECK_NEON)
+        using F4 = float32x4_t;
+
+        inline F4 LoadPixel(const uint8_t* p) {
+            uint32_t v;
+            memcpy(&v, p, 4);
+            const uint16x8_t w = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(v)));
+            return vcvtq_f32_u32(vmovl_u16(vget_low_u16(w)));
+        }
+        inline F4 Load(const float* p) { return vld1q_f32(p); }
+        inline void Store(float* p, F4 v) { vst1q_f32(p, v); }
+        inline F4 Splat(float w) { return vdupq_n_f32(w); }
+        inline F4 Zero() { return vdupq_n_f32(0.0f); }
+        inline F4 MulAdd(F4 acc, F4 a, F4 w) { return vmlaq_f32(acc, a, w); }
+        inline void StorePixel(uint8_t* p, F4 v) {
+            const F4 a = vminq_f32(vdupq_n_f32(vgetq_lane_f32(v, 3)), vdupq_n_f32(255.0f));
+            v = vmaxq_f32(vminq_f32(v, a), vdupq_n_f32(0.0f));
+            const uint32x4_t i = vcvtq_u32_f32(vaddq_f32(v, vdupq_n_f32(0.5f)));
+            const uint16x4_t h = vmovn_u32(i);
+            const uint8x8_t b = vmovn_u16(vcombine_u16(h, h));
+            vst1_lane_u32(reinterpret_cast<uint32_t*>(p), vreinterpret_u32_u8(b), 0);
+        }
+#else
+        struct F4 {
+            float v[4];
+        };
+
+        inline F4 LoadPixel(const uint8_t* p) { return {{(float)p[0], (float)p[1], (float)p[2], (float)p[3]}}; }
+        inline F4 Load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+        inline void Store(float* p, F4 v) { memcpy(p, v.v, sizeof(v.v)); }
+        inline F4 Splat(float w) { return {{w, w, w, w}}; }
+        inline F4 Zero() { return Splat(0.0f); }
+        inline F4 MulAdd(F4 acc, F4 a, F4 w) {
+            for (int c = 0; c < 4; c++) acc.v[c] += a.v[c] * w.v[c];
+            return acc;
+        }
+        inline void StorePixel(uint8_t* p, F4 v) {
+            const float a = std::min(std::max(v.v[3], 0.0f), 255.0f);
+            for (int c = 0; c < 4; c++) {
+                const float x = std::min(std::max(v.v[c], 0.0f), a);
+                p[c] = (uint8_t)(x + 0.5f);
+            }
+        }
+#endif
+
+        bool IsIntegerRatio(int src, int dst) { return dst > 0 && src >= dst && src % dst == 0; }
+
+        bool Resize(IconResampler& r, const IconImage& src, int width, IconImage* out) {
+            const int height = std::max(1, (int)std::lround((double)width * src.height / src.width));
+            if (src.width == width && src.height == height) {
+                *out = src;
+                return true;
+            }
+            if (IsIntegerRatio(src.width, width) && IsIntegerRatio(src.height, height)) {
+                return r.Resize(src, width, height, ResampleFilter::kBox, out);
+            }
+            // Large non-integer ratios: halve with the (exact) box first so
+            // Lanczos only has to cover the last < 2x step with a short kernel.
+            if (src.width >= 2 * width && src.height >= 2 * height && src.width % 2 == 0 && src.height % 2 == 0) {
+                IconImage half;
+                if (!r.Resize(src, src.width / 2, src.height / 2, ResampleFilter::kBox, &half)) return false;
+                return Resize(r, half, width, out);
+            }
+            return r.Resize(src, width, height, ResampleFilter::kLanczos3, out);
+        }
+
+    }  // namespace
+
+    void IconResampler::BuildAxis(int src, int dst, ResampleFilter filter, Axis* axis) {
+        if (axis->src == src && axis->dst == dst && axis->filter == filter && axis->taps > 0) return;
+
+        const double scale = (double)src / dst;
+        const double fscale = std::max(scale, 1.0);  // widen the kernel when shrinking
+        const double support = filter == ResampleFilter::kBox ? fscale * 0.5 : 3.0 * fscale;
+
+        axis->src = src;
+        axis->dst = dst;
+        axis->filter = filter;
+        axis->taps = std::min(src, (int)std::ceil(support * 2.0) + 2);
+        axis->start.assign(dst, 0);
+        axis->weight.assign((size_t)dst * axis->taps, 0.0f);
+
+        std::vector<double> w(axis->taps);
+        for (int i = 0; i < dst; i++) {
+            std::fill(w.begin(), w.end(), 0.0);
+            // Samples sit at pixel centres: source coordinate of output i.
+            const double centre = (i + 0.5) * scale;
+            const int lo = std::max(0, (int)std::floor(centre - support));
+            const int first = std::min(lo, src - axis->taps);
+            const int hi = std::min(src - 1, (int)std::ceil(centre + support));
+
+            double sum = 0.0;
+            for (int j = lo; j <= hi; j++) {
+                double v;
+                if (filter == ResampleFilter::kBox) {
+                    // Overlap of source pixel [j, j+1) with the output footprint.
+                    v = std::min(j + 1.0, centre + support) - std::max((double)j, centre - support);
+                    if (v <= 0) continue;
+                } else {
+                    v = Lanczos3((j + 0.5 - centre) / fscale);
+                }
+                const int k = j - first;
+                if (k < 0 || k >= axis->taps) continue;
+                w[k] += v;
+                sum += v;
+            }
+            if (sum == 0.0) {
+                // Degenerate footprint (cannot happen for sane sizes): nearest.
+                const int j = std::min(src - 1, (int)centre);
+                w.assign(axis->taps, 0.0);
+                w[j - first] = 1.0;
+                sum = 1.0;
+            }
+            axis->start[i] = first;
+            for (int k = 0; k < axis->taps; k++) axis->weight[(size_t)i * axis->taps + k] = (float)(w[k] / sum);
+        }
+    }
+
+    bool IconResampler::Resize(const IconImage& src, int width, int height, ResampleFilter filter,
+                               IconImage* out) {
+        if (src.width <= 0 || src.height <= 0 || width <= 0 || height <= 0 ||
+            src.rgba.size() != src.pixel_count() * 4) {
+            return false;
+        }
+        BuildAxis(src.width, width, filter, &x_);
+        BuildAxis(src.height, height, filter, &y_);
+
+        // Horizontal: src.height rows of `width` float pixels.
+        const size_t tmp_stride = (size_t)width * 4;
+        tmp_.resize(tmp_stride * src.height);
+        for (int y = 0; y < src.height; y++) {
+            const uint8_t* row = &src.rgba[(size_t)y * src.width * 4];
+            float* dst = &tmp_[(size_t)y * tmp_stride];
+            for (int x = 0; x < width; x++) {
+                const uint8_t* p = row + (size_t)x_.start[x] * 4;
+                const float* w = &x_.weight[(size_t)x * x_.taps];
+                F4 acc = Zero();
+                for (int k = 0; k < x_.taps; k++) acc = MulAdd(acc, LoadPixel(p + k * 4), Splat(w[k]));
+                Store(dst + x * 4, acc);
+            }
+        }
+
+        // Vertical: accumulate whole rows, so the inner loop is a straight
+        // multiply-add over contiguous floats.
+        out->width = width;
+        out->height = height;
+        out->rgba.resize((size_t)width * height * 4);
+        acc_.resize(tmp_stride);
+        for (int y = 0; y < height; y++) {
+            std::fill(acc_.begin(), acc_.end(), 0.0f);
+            const float* w = &y_.weight[(size_t)y * y_.taps];
+            for (int k = 0; k < y_.taps; k++) {
+                if (w[k] == 0.0f) continue;
+                const float* row = &tmp_[(size_t)(y_.start[y] + k) * tmp_stride];
+                const F4 wk = Splat(w[k]);
+                for (size_t i = 0; i < tmp_stride; i += 4) Store(&acc_[i], MulAdd(Load(&acc_[i]), Load(row + i), wk));
+            }
+            uint8_t* dst = &out->rgba[(size_t)y * width * 4];
+            for (int x = 0; x < width; x++) StorePixel(dst + x * 4, Load(&acc_[(size_t)x * 4]));
+        }
+        return true;
+    }
+
+    const IconImage& IconPyramid::ForSize(int size) const {
+        for (int i = 0; i < kIconPyramidLevels; i++) {
+            if (kIconPyramidSizes[i] >= size && levels[i].width > 0) {
+                // A level above the source holds no extra detail; prefer the
+                // source when it is closer to the request.
+                if (source.width >= size && source.width < levels[i].width) return source;
+                return levels[i];
+            }
+        }
+        return source;
+    }
+
+    size_t IconPyramid::byte_size() const {
+        size_t n = source.rgba.size();
+        for (const auto& l : levels) n += l.rgba.size();
+        return n;
+    }
+
+    bool BuildIconPyramid(IconImage source, IconResampler& resampler, IconPyramid* out) {
+        if (source.width <= 0 || source.height <= 0 || source.rgba.size() != source.pixel_count() * 4) {
+            return false;
+        }
+        // Reduce a large extraction once; at 2x the biggest level it still
+        // carries all the detail the levels can show, and most levels are
+        // then integer ratios of it (box instead of a 50-tap Lanczos).
+        if (source.width > kIconPyramidMaxEdge) {
+            if (!Resize(resampler, source, kIconPyramidMaxEdge, &out->source)) return false;
+        } else {
+            out->source = std::move(source);
+        }
+        for (int i = 0; i < kIconPyramidLevels; i++) {
+            if (!Resize(resampler, out->source, kIconPyramidSizes[i], &out->levels[i])) return false;
+        }
+        return true;
+    }
+
+    void SerializeIconPyramid(const IconPyramid& pyramid, std::vector<uint8_t>& out) {
+        const uint16_t count = kIconPyramidLevels + 1;
+        out.resize(2);
+        memcpy(out.data(), &count, 2);
+        std::vector<uint8_t> blob;
+        for (int i = -1; i < kIconPyramidLevels; i++) {
+            SerializeIconImage(i < 0 ? pyramid.source : pyramid.levels[i], blob);
+            const uint32_t length = (uint32_t)blob.size();
+            const size_t at = out.size();
+            out.resize(at + 4 + blob.size());
+            memcpy(out.data() + at, &length, 4);
+            memcpy(out.data() + at + 4, blob.data(), blob.size());
+        }
+    }
+
+    bool DeserializeIconPyramid(const uint8_t* data, size_t size, IconPyramid* out) {
+        uint16_t count = 0;
+        if (size < 2) return false;
+        memcpy(&count, data, 2);
+        if (count != kIconPyramidLevels + 1) return false;
+        size_t at = 2;
+        for (int i = -1; i < kIconPyramidLevels; i++) {
+            uint32_t length = 0;
+            if (size - at < 4) return false;
+            memcpy(&length, data + at, 4);
+            at += 4;
+            if (size - at < length) return false;
+            IconImage* img = i < 0 ? &out->source : &out->levels[i];
+            if (!DeserializeIconImage(data + at, length, img) || img->width <= 0) return false;
+            at += length;
+        }
+        return at == size;
+    }
+
+}  // namespace volumedeck_mixer
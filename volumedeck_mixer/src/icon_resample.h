@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "icon_pixels.h"
+
+namespace volumedeck_mixer {
+
+    enum class ResampleFilter {
+        kBox,      // area average; exact for integer ratios, no ringing
+        kLanczos3, // sharper for arbitrary ratios (256 -> 20 and friends)
+    };
+
+    // Separable resize of a premultiplied RGBA image. Working in
+    // premultiplied space keeps transparent pixels from bleeding their
+    // (meaningless) colour into the edges. Lanczos overshoot is clamped so
+    // colour never exceeds alpha.
+    //
+    // Holds its weight tables and intermediate buffer, so one resampler per
+    // thread makes repeated pyramid builds allocation-free.
+    class IconResampler {
+    public:
+        bool Resize(const IconImage& src, int width, int height, ResampleFilter filter,
+                    IconImage* out);
+
+    private:
+        struct Axis {
+            int src = 0, dst = 0;
+            ResampleFilter filter = ResampleFilter::kBox;
+            int taps = 0;               // per output sample, zero padded
+            std::vector<int> start;     // first source index per output
+            std::vector<float> weight;  // dst * taps, normalized
+        };
+
+        static void BuildAxis(int src, int dst, ResampleFilter filter, Axis* axis);
+
+        Axis x_, y_;
+        std::vector<float> tmp_;  // dst width x src height x 4
+        std::vector<float> acc_;  // one output row
+    };
+
+    // Edge lengths the UI asks for: picker rows, deck cards, settings list.
+    constexpr int kIconPyramidSizes[] = {16, 20, 24, 32, 48};
+    constexpr int kIconPyramidLevels = sizeof(kIconPyramidSizes) / sizeof(kIconPyramidSizes[0]);
+
+    // Largest edge kept besides the levels: 2x the biggest level, enough
+    // for HiDPI cards without holding a 256 px bitmap per exe.
+    constexpr int kIconPyramidMaxEdge = 96;
+
+    // One extraction, every size the UI needs. `levels[i]` is
+    // kIconPyramidSizes[i] px; `source` (at most kIconPyramidMaxEdge) serves
+    // larger requests.
+    struct IconPyramid {
+        IconImage source;
+        IconImage levels[kIconPyramidLevels];
+
+        // Best image for a `size` px request: the exact level, else the
+        // smallest stored image that is at least that big, else the source.
+        const IconImage& ForSize(int size) const;
+
+        size_t byte_size() const;
+    };
+
+    // Integer ratios use the box filter, everything else Lanczos-3. Levels
+    // larger than a small source are upscaled rather than left empty.
+    // Non-square sources keep their aspect ratio, fitted to the level width.
+    bool BuildIconPyramid(IconImage source, IconResampler& resampler, IconPyramid* out);
+
+    // A whole pyramid in the on-disk pack, so a cold start skips the
+    // extraction: u16 image count, then per image (source first) a u32
+    // length and a SerializeIconImage blob. Deserialize rejects anything
+    // that is not one image per level plus the source.
+    void SerializeIconPyramid(const IconPyramid& pyramid, std::vector<uint8_t>& out);
+    bool DeserializeIconPyramid(const uint8_t* data, size_t size, IconPyramid* out);
+
+}  // namespace volumedeck_mixer
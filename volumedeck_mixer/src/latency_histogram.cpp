@@ -0,0 +1,87 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace volumedeck_mixer {
+
+    size_t LatencyHistogram::BucketOf(uint64_t ns) {
+        if (ns < kLinear) return (size_t)ns;
+        // Highest set bit h >= 10; keep the kSubBits bits below it.
+        int h = 63;
+        while (!(ns >> h)) h--;
+        const int shift = h - kSubBits;
+        const size_t sub = (size_t)(ns >> shift) - (size_t(1) << kSubBits);
+        const size_t bucket = kLinear + (size_t)(shift - 1) * (size_t(1) << kSubBits) + sub;
+        return std::min(bucket, kBuckets - 1);
+    }
+
+    uint64_t LatencyHistogram::UpperEdge(size_t bucket) {
+        if (bucket < kLinear) return bucket;
+        const size_t rel = bucket - kLinear;
+        const int shift = (int)(rel >> kSubBits) + 1;
+        const uint64_t sub = (rel & ((size_t(1) << kSubBits) - 1)) + (size_t(1) << kSubBits);
+        return ((sub + 1) << shift) - 1;
+    }
+
+    void LatencyHistogram::Record(uint64_t ns) {
+        buckets_[BucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t cur = min_.load(std::memory_order_relaxed);
+        while (ns < cur && !min_.compare_exchange_weak(cur, ns, std::memory_order_relaxed)) {
+        }
+        cur = max_.load(std::memory_order_relaxed);
+        while (ns > cur && !max_.compare_exchange_weak(cur, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    void LatencyHistogram::Reset() {
+        for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        min_.store(UINT64_MAX, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t LatencyHistogram::min_ns() const {
+        const uint64_t m = min_.load(std::memory_order_relaxed);
+        return m == UINT64_MAX ? 0 : m;
+    }
+
+    double LatencyHistogram::mean_ns() const {
+        const uint64_t n = count();
+        return n ? (double)sum_.load(std::memory_order_relaxed) / (double)n : 0.0;
+    }
+
+    uint64_t LatencyHistogram::Percentile(double p) const {
+        const uint64_t n = count();
+        if (n == 0) return 0;
+        p = std::min(100.0, std::max(0.0, p));
+        const uint64_t rank = std::max<uint64_t>(1, (uint64_t)std::ceil(p / 100.0 * (double)n));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; i++) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) return std::min(UpperEdge(i), max_ns());
+        }
+        return max_ns();
+    }
+
+    void LatencyHistogram::Merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < kBuckets; i++) {
+            const uint64_t v = other.buckets_[i].load(std::memory_order_relaxed);
+            if (v) buckets_[i].fetch_add(v, std::memory_order_relaxed);
+        }
+        count_.fetch_add(other.count(), std::memory_order_relaxed);
+        sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        uint64_t m = other.min_.load(std::memory_order_relaxed);
+        uint64_t cur = min_.load(std::memory_order_relaxed);
+        while (m < cur && !min_.compare_exchange_weak(cur, m, std::memory_order_relaxed)) {
+        }
+        m = other.max_ns();
+        cur = max_.load(std::memory_order_relaxed);
+        while (m > cur && !max_.compare_exchange_weak(cur, m, std::memory_order_relaxed)) {
+        }
+    }
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace volumedeck_mixer {
+
+    // Fixed-size log-linear histogram of nanosecond latencies, for load
+    // tests and benchmarks. Exact below 1024 ns, then 512 buckets per power
+    // of two (< 0.2% error) up to ~4.9 hours. Record() is lock-free and may
+    // be called from any number of threads; reads are approximate while
+    // recording is in progress.
+    class LatencyHistogram {
+    public:
+        void Record(uint64_t ns);
+        void Reset();
+
+        uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+        uint64_t min_ns() const;
+        uint64_t max_ns() const { return max_.load(std::memory_order_relaxed); }
+        double mean_ns() const;
+
+        // `p` in [0, 100]. Upper edge of the bucket holding that rank, so
+        // never below the true value. 0 when empty.
+        uint64_t Percentile(double p) const;
+
+        // Adds `other`'s samples to this one.
+        void Merge(const LatencyHistogram& other);
+
+    private:
+        static constexpr int kSubBits = 9;
+        static constexpr size_t kLinear = size_t(1) << (kSubBits + 1);  // 1024
+        static constexpr size_t kBuckets = kLinear + 34 * (size_t(1) << kSubBits);
+
+        static size_t BucketOf(uint64_t ns);
+        static uint64_t UpperEdge(size_t bucket);
+
+        std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+        std::atomic<uint64_t> count_{0};
+        std::atomic<uint64_t> sum_{0};
+        std::atomic<uint64_t> min_{UINT64_MAX};
+        std::atomic<uint64_t> max_{0};
+    };
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,274 @@
+#include "loudness_meter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "simd.h"
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        constexpr double kPi = 3.14159265358979323846;
+
+        double EnergyToLufs(double e) { return e > 0 ? -0.691 + 10.0 * std::log10(e) : -HUGE_VAL; }
+
+        // BS.1770 channel weights for the WAVEFORMATEXTENSIBLE / SMPTE order
+        // L R C LFE Ls Rs; anything beyond counts like a front channel.
+        float ChannelWeight(int channel, int channels) {
+            if (channels < 6) return 1.0f;
+            switch (channel) {
+                case 3: return 0.0f;
+                case 4:
+                case 5: return 1.41f;
+                default: return 1.0f;
+            }
+        }
+
+    }  // namespace
+
+    void KWeightingFilters(double rate, Biquad* shelf, Biquad* highpass) {
+        // Analog prototypes from the BS.1770 filter description, bilinear
+        // transformed for `rate` (same derivation as libebur128).
+        double f0 = 1681.974450955533;
+        const double gain_db = 3.999843853973347;
+        double q = 0.7071752369554196;
+        double k = std::tan(kPi * f0 / rate);
+        const double vh = std::pow(10.0, gain_db / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        double a0 = 1.0 + k / q + k * k;
+        shelf->b0 = (vh + vb * k / q + k * k) / a0;
+        shelf->b1 = 2.0 * (k * k - vh) / a0;
+        shelf->b2 = (vh - vb * k / q + k * k) / a0;
+        shelf->a1 = 2.0 * (k * k - 1.0) / a0;
+        shelf->a2 = (1.0 - k / q + k * k) / a0;
+
+        f0 = 38.13547087602444;
+        q = 0.5003270373238773;
+        k = std::tan(kPi * f0 / rate);
+        a0 = 1.0 + k / q + k * k;
+        highpass->b0 = 1.0;
+        highpass->b1 = -2.0;
+        highpass->b2 = 1.0;
+        highpass->a1 = 2.0 * (k * k - 1.0) / a0;
+        highpass->a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    LoudnessMeter::LoudnessMeter(int sample_rate, int channels)
+        : sample_rate_(sample_rate),
+          channels_(channels),
+          groups_(((size_t)std::max(channels, 1) + kLanes - 1) / kLanes),
+          sub_block_frames_((size_t)std::max(sample_rate / 10, 1)),
+          weights_(groups_ * kLanes, 0.0f),
+          state_(groups_ * 4 * kLanes, 0.0f),
+          scratch_(kChunk * kLanes, 0.0f),
+          sum_sq_(groups_ * kLanes, 0.0),
+          sub_block_left_(sub_block_frames_),
+          histogram_((size_t)std::lround((kHistogramMax - kHistogramMin) / kHistogramStep) + 1) {
+        Biquad s, h;
+        KWeightingFilters(sample_rate, &s, &h);
+        const double* sc[5] = {&s.b0, &s.b1, &s.b2, &s.a1, &s.a2};
+        const double* hc[5] = {&h.b0, &h.b1, &h.b2, &h.a1, &h.a2};
+        for (int i = 0; i < 5; i++) {
+            shelf_[i] = (float)*sc[i];
+            highpass_[i] = (float)*hc[i];
+        }
+        for (int c = 0; c < channels; c++) weights_[(size_t)c] = ChannelWeight(c, channels);
+    }
+
+    void LoudnessMeter::Reset() {
+        std::fill(state_.begin(), state_.end(), 0.0f);
+        std::fill(sum_sq_.begin(), sum_sq_.end(), 0.0);
+        std::fill(std::begin(history_), std::end(history_), 0.0);
+        history_pos_ = 0;
+        sub_blocks_ = 0;
+        sub_block_left_ = sub_block_frames_;
+        frames_ = 0;
+        ResetIntegrated();
+    }
+
+    void LoudnessMeter::ResetIntegrated() {
+        std::fill(histogram_.begin(), histogram_.end(), Bin{});
+    }
+
+    void LoudnessMeter::Process(const float* in, size_t frames) {
+        const size_t stride = (size_t)channels_;
+        while (frames > 0) {
+            const size_t n = std::min({frames, sub_block_left_, kChunk});
+            for (size_t g = 0; g < groups_; g++) {
+                // Deinterleave this group's channels into whole vectors.
+                const size_t first = g * kLanes;
+                const size_t lanes = std::min(kLanes, stride - first);
+                float* s = scratch_.data();
+                for (size_t f = 0; f < n; f++, s += kLanes) {
+                    const float* src = in + f * stride + first;
+                    size_t l = 0;
+                    for (; l < lanes; l++) s[l] = src[l];
+                    for (; l < kLanes; l++) s[l] = 0.0f;
+                }
+                FilterGroup(g, n);
+            }
+            in += n * stride;
+            frames -= n;
+            frames_ += n;
+            sub_block_left_ -= n;
+            if (sub_block_left_ == 0) {
+                FinishSubBlock();
+                sub_block_left_ = sub_block_frames_;
+            }
+        }
+    }
+
+#if defined(VOLUMEDECK_SSE2)
+    void LoudnessMeter::FilterGroup(size_t group, size_t frames) {
+        float* st = &state_[group * 4 * kLanes];
+        __m128 sz1 = _mm_loadu_ps(st), sz2 = _mm_loadu_ps(st + 4);
+        __m128 hz1 = _mm_loadu_ps(st + 8), hz2 = _mm_loadu_ps(st + 12);
+        const __m128 sb0 = _mm_set1_ps(shelf_[0]), sb1 = _mm_set1_ps(shelf_[1]), sb2 = _mm_set1_ps(shelf_[2]);
+        const __m128 sa1 = _mm_set1_ps(shelf_[3]), sa2 = _mm_set1_ps(shelf_[4]);
+        const __m128 ha1 = _mm_set1_ps(highpass_[3]), ha2 = _mm_set1_ps(highpass_[4]);
+        const __m128 two = _mm_set1_ps(2.0f);
+        __m128 acc = _mm_setzero_ps();
+
+        const float* s = scratch_.data();
+        for (size_t f = 0; f < frames; f++, s += kLanes) {
+            // Transposed direct form II; the high-pass numerator is 1 -2 1.
+            const __m128 x = _mm_loadu_ps(s);
+            const __m128 y1 = _mm_add_ps(_mm_mul_ps(sb0, x), sz1);
+            sz1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(sb1, x), _mm_mul_ps(sa1, y1)), sz2);
+            sz2 = _mm_sub_ps(_mm_mul_ps(sb2, x), _mm_mul_ps(sa2, y1));
+            const __m128 y2 = _mm_add_ps(y1, hz1);
+            hz1 = _mm_sub_ps(_mm_sub_ps(hz2, _mm_mul_ps(two, y1)), _mm_mul_ps(ha1, y2));
+            hz2 = _mm_sub_ps(y1, _mm_mul_ps(ha2, y2));
+            acc = _mm_add_ps(acc, _mm_mul_ps(y2, y2));
+        }
+
+        float out[4];
+        _mm_storeu_ps(out, acc);
+        _mm_storeu_ps(st, sz1);
+        _mm_storeu_ps(st + 4, sz2);
+        _mm_storeu_ps(st + 8, hz1);
+        _mm_storeu_ps(st + 12, hz2);
+        for (size_t l = 0; l < kLanes; l++) sum_sq_[group * kLanes + l] += out[l];
+        // The recursions decay into denormals on silence, which is very slow
+        // on x86; nothing this small is audible.
+        for (size_t i = 0; i < 4 * kLanes; i++) {
+            if (std::fabs(st[i]) < 1e-15f) st[i] = 0.0f;
+        }
+    }
+#elif defined(VOLUMEDECK_NEON)
+    void LoudnessMeter::FilterGroup(size_t group, size_t frames) {
+        float* st = &state_[group * 4 * kLanes];
+        float32x4_t sz1 = vld1q_f32(st), sz2 = vld1q_f32(st + 4);
+        float32x4_t hz1 = vld1q_f32(st + 8), hz2 = vld1q_f32(st + 12);
+        const float32x4_t sb0 = vdupq_n_f32(shelf_[0]), sb1 = vdupq_n_f32(shelf_[1]), sb2 = vdupq_n_f32(shelf_[2]);
+        const float32x4_t sa1 = vdupq_n_f32(shelf_[3]), sa2 = vdupq_n_f32(shelf_[4]);
+        const float32x4_t ha1 = vdupq_n_f32(highpass_[3]), ha2 = vdupq_n_f32(highpass_[4]);
+        float32x4_t acc = vdupq_n_f32(0.0f);
+
+        const float* s = scratch_.data();
+        for (size_t f = 0; f < frames; f++, s += kLanes) {
+            const float32x4_t x = vld1q_f32(s);
+            const float32x4_t y1 = vmlaq_f32(sz1, sb0, x);
+            sz1 = vmlsq_f32(vmlaq_f32(sz2, sb1, x), sa1, y1);
+            sz2 = vmlsq_f32(vmulq_f32(sb2, x), sa2, y1);
+            const float32x4_t y2 = vaddq_f32(y1, hz1);
+            hz1 = vmlsq_f32(vmlsq_f32(hz2, vdupq_n_f32(2.0f), y1), ha1, y2);
+            hz2 = vmlsq_f32(y1, ha2, y2);
+            acc = vmlaq_f32(acc, y2, y2);
+        }
+
+        float out[4];
+        vst1q_f32(out, acc);
+        vst1q_f32(st, sz1);
+        vst1q_f32(st + 4, sz2);
+        vst1q_f32(st + 8, hz1);
+        vst1q_f32(st + 12, hz2);
+        for (size_t l = 0; l < kLanes; l++) sum_sq_[group * kLanes + l] += out[l];
+        for (size_t i = 0; i < 4 * kLanes; i++) {
+            if (std::fabs(st[i]) < 1e-15f) st[i] = 0.0f;
+        }
+    }
+#else
+    void LoudnessMeter::FilterGroup(size_t group, size_t frames) {
+        float* st = &state_[group * 4 * kLanes];
+        for (size_t l = 0; l < kLanes; l++) {
+            float sz1 = st[l], sz2 = st[4 + l], hz1 = st[8 + l], hz2 = st[12 + l];
+            float acc = 0.0f;
+            for (size_t f = 0; f < frames; f++) {
+                const float x = scratch_[f * kLanes + l];
+                const float y1 = shelf_[0] * x + sz1;
+                sz1 = shelf_[1] * x - shelf_[3] * y1 + sz2;
+                sz2 = shelf_[2] * x - shelf_[4] * y1;
+                const float y2 = y1 + hz1;
+                hz1 = -2.0f * y1 - highpass_[3] * y2 + hz2;
+                hz2 = y1 - highpass_[4] * y2;
+                acc += y2 * y2;
+            }
+            st[l] = std::fabs(sz1) < 1e-15f ? 0.0f : sz1;
+            st[4 + l] = std::fabs(sz2) < 1e-15f ? 0.0f : sz2;
+            st[8 + l] = std::fabs(hz1) < 1e-15f ? 0.0f : hz1;
+            st[12 + l] = std::fabs(hz2) < 1e-15f ? 0.0f : hz2;
+            sum_sq_[group * kLanes + l] += acc;
+        }
+    }
+#endif
+
+    void LoudnessMeter::FinishSubBlock() {
+        double e = 0.0;
+        for (size_t i = 0; i < sum_sq_.size(); i++) {
+            e += weights_[i] * sum_sq_[i];
+            sum_sq_[i] = 0.0;
+        }
+        history_[history_pos_] = e / (double)sub_block_frames_;
+        history_pos_ = (history_pos_ + 1) % kHistory;
+        sub_blocks_++;
+
+        // Every 100 ms completes a 400 ms gating block (75 % overlap).
+        if (sub_blocks_ < 4) return;
+        const double block = [&] {
+            double sum = 0.0;
+            for (size_t i = 1; i <= 4; i++) sum += history_[(history_pos_ + kHistory - i) % kHistory];
+            return sum / 4.0;
+        }();
+        const double lufs = EnergyToLufs(block);
+        if (lufs < kHistogramMin) return;  // absolute gate
+        const size_t bin = (size_t)std::min<double>(
+                (double)(histogram_.size() - 1), std::floor((lufs - kHistogramMin) / kHistogramStep));
+        histogram_[bin].count++;
+        histogram_[bin].energy += block;
+    }
+
+    double LoudnessMeter::WindowLoudness(size_t sub_blocks) const {
+        // Before the window has filled, the missing part counts as silence.
+        double sum = 0.0;
+        for (size_t i = 1; i <= sub_blocks; i++) sum += history_[(history_pos_ + kHistory - i) % kHistory];
+        return std::max(EnergyToLufs(sum / (double)sub_blocks), kLoudnessSilence);
+    }
+
+    double LoudnessMeter::integrated() const {
+        uint64_t count = 0;
+        double energy = 0.0;
+        for (const Bin& b : histogram_) {
+            count += b.count;
+            energy += b.energy;
+        }
+        if (count == 0) return kLoudnessSilence;
+
+        // Relative gate, applied per bin: a bin is in if its lower edge is
+        // at or above the threshold, with the bin straddling the threshold
+        // decided by its centre. Bins are 0.1 LU wide.
+        const double threshold = EnergyToLufs(energy / (double)count) - 10.0;
+        count = 0;
+        energy = 0.0;
+        for (size_t i = 0; i < histogram_.size(); i++) {
+            const double centre = kHistogramMin + ((double)i + 0.5) * kHistogramStep;
+            if (centre <= threshold) continue;
+            count += histogram_[i].count;
+            energy += histogram_[i].energy;
+        }
+        if (count == 0) return kLoudnessSilence;
+        return EnergyToLufs(energy / (double)count);
+    }
+
+}  // namespace volumedeck_mixer
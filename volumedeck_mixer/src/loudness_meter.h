@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace volumedeck_mixer {
+
+    // Reported for silence (and anything below the -70 LUFS absolute gate
+    // in the integrated value).
+    constexpr double kLoudnessSilence = -70.0;
+
+    struct Biquad {
+        double b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+    };
+
+    // ITU-R BS.1770-4 K-weighting for any sample rate: high-shelf
+    // pre-filter followed by the RLB high-pass. At 48 kHz these match the
+    // coefficient tables in the recommendation.
+    void KWeightingFilters(double sample_rate, Biquad* shelf, Biquad* highpass);
+
+    // Loudness per ITU-R BS.1770-4 / EBU R 128:
+    //   momentary   400 ms window
+    //   short-term  3 s window
+    //   integrated  gated (-70 LUFS absolute, -10 LU relative) over 400 ms
+    //               blocks with 75 % overlap, since the last reset
+    //
+    // The K-weighting runs with channels in vector lanes (SSE2/NEON), so a
+    // stereo stream costs one cascade per frame. Memory is fixed: the gated
+    // blocks go into a 0.1 LU histogram, not a growing list.
+    class LoudnessMeter {
+    public:
+        LoudnessMeter(int sample_rate, int channels);
+
+        void Process(const float* interleaved, size_t frames);
+
+        double momentary() const { return WindowLoudness(4); }
+        double short_term() const { return WindowLoudness(30); }
+        double integrated() const;
+
+        void ResetIntegrated();
+        void Reset();
+
+        int sample_rate() const { return sample_rate_; }
+        int channels() const { return channels_; }
+        uint64_t frames() const { return frames_; }
+
+    private:
+        static constexpr size_t kLanes = 4;
+        static constexpr size_t kChunk = 256;
+        static constexpr size_t kHistory = 30;  // 100 ms sub-blocks for short-term
+        static constexpr double kHistogramMin = -70.0;
+        static constexpr double kHistogramMax = 20.0;
+        static constexpr double kHistogramStep = 0.1;
+
+        void FilterGroup(size_t group, size_t frames);
+        void FinishSubBlock();
+        double WindowLoudness(size_t sub_blocks) const;
+
+        const int sample_rate_;
+        const int channels_;
+        const size_t groups_;
+        const size_t sub_block_frames_;
+
+        float shelf_[5];
+        float highpass_[5];
+        std::vector<float> weights_;  // per lane, 0 for padding and LFE
+        std::vector<float> state_;    // per group: shelf z1, z2, highpass z1, z2 (x4 lanes)
+        std::vector<float> scratch_;  // one chunk of one group, frame-major
+        std::vector<double> sum_sq_;  // per lane, current sub-block
+
+        size_t sub_block_left_;
+        uint64_t frames_ = 0;
+
+        double history_[kHistory] = {};  // weighted mean square per sub-block
+        size_t history_pos_ = 0;
+        uint64_t sub_blocks_ = 0;
+
+        struct Bin {
+            uint64_t count = 0;
+            double energy = 0;
+        };
+        std::vector<Bin> histogram_;
+    };
+
+}  // namespace volumedeck_mixer
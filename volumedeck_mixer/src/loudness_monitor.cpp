@@ -0,0 +1,84 @@
+#include "loudness_monitor.h"
+
+#include <vector>
+
+namespace volumedeck_mixer {
+
+    LoudnessMonitor::LoudnessMonitor(std::unique_ptr<CaptureSource> source, std::chrono::milliseconds retry)
+        : source_(std::move(source)), retry_(retry) {}
+
+    LoudnessMonitor::~LoudnessMonitor() { Stop(); }
+
+    void LoudnessMonitor::Start() {
+        if (thread_.joinable()) return;
+        stop_.store(false);
+        finished_.store(false);
+        thread_ = std::thread([this] { ThreadLoop(); });
+    }
+
+    void LoudnessMonitor::Stop() {
+        if (!thread_.joinable()) return;
+        stop_.store(true);
+        thread_.join();
+    }
+
+    LoudnessReading LoudnessMonitor::Read() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return reading_;
+    }
+
+    void LoudnessMonitor::ThreadLoop() {
+        // 10 ms at 48 kHz per read; publishing after every read keeps the
+        // momentary value as fresh as the source delivers it.
+        constexpr size_t kFrames = 480;
+        std::vector<float> buffer;
+
+        while (!stop_.load()) {
+            CaptureFormat format;
+            if (!source_->Open(&format)) {
+                for (auto waited = std::chrono::milliseconds(0); waited < retry_ && !stop_.load();
+                     waited += std::chrono::milliseconds(10)) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                continue;
+            }
+
+            LoudnessMeter meter(format.sample_rate, format.channels);
+            buffer.resize(kFrames * (size_t)format.channels);
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                reading_ = LoudnessReading();
+                reading_.capturing = true;
+            }
+
+            CaptureStatus status = CaptureStatus::kOk;
+            while (!stop_.load()) {
+                size_t frames = 0;
+                status = source_->Read(buffer.data(), kFrames, &frames);
+                if (status != CaptureStatus::kOk) break;
+                if (reset_.exchange(false, std::memory_order_relaxed)) meter.ResetIntegrated();
+                if (frames == 0) continue;
+                meter.Process(buffer.data(), frames);
+
+                LoudnessReading r;
+                r.momentary = meter.momentary();
+                r.short_term = meter.short_term();
+                r.integrated = meter.integrated();
+                r.frames = meter.frames();
+                r.capturing = true;
+                std::lock_guard<std::mutex> lock(mu_);
+                reading_ = r;
+            }
+            source_->Close();
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                reading_.capturing = false;
+            }
+            if (status == CaptureStatus::kEnd) {
+                finished_.store(true, std::memory_order_release);
+                break;
+            }
+        }
+    }
+
+}  // namespace volumedeck_mixer
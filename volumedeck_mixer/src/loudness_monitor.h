@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "capture_source.h"
+#include "loudness_meter.h"
+
+namespace volumedeck_mixer {
+
+    struct LoudnessReading {
+        double momentary = kLoudnessSilence;   // LUFS
+        double short_term = kLoudnessSilence;  // LUFS
+        double integrated = kLoudnessSilence;  // LUFS
+        uint64_t frames = 0;                   // measured since the source opened
+        bool capturing = false;
+    };
+
+    // Pulls audio from a CaptureSource on its own thread and keeps a
+    // LoudnessMeter current. If the source fails (device removed, default
+    // endpoint switched) it is reopened after `retry` and metering starts
+    // over.
+    class LoudnessMonitor {
+    public:
+        explicit LoudnessMonitor(std::unique_ptr<CaptureSource> source,
+                                 std::chrono::milliseconds retry = std::chrono::seconds(1));
+        ~LoudnessMonitor();
+
+        LoudnessMonitor(const LoudnessMonitor&) = delete;
+        LoudnessMonitor& operator=(const LoudnessMonitor&) = delete;
+
+        void Start();
+        void Stop();
+
+        // Restarts the integrated measurement. Any thread.
+        void ResetIntegrated() { reset_.store(true, std::memory_order_relaxed); }
+
+        LoudnessReading Read() const;
+
+        // True once a finite source has been read to the end.
+        bool finished() const { return finished_.load(std::memory_order_acquire); }
+
+    private:
+        void ThreadLoop();
+
+        const std::unique_ptr<CaptureSource> source_;
+        const std::chrono::milliseconds retry_;
+
+        std::atomic<bool> stop_{false};
+        std::atomic<bool> reset_{false};
+        std::atomic<bool> finished_{false};
+
+        mutable std::mutex mu_;
+        LoudnessReading reading_;
+
+        std::thread thread_;
+    };
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace volumedeck_mixer {
+
+    // Read-only memory mapping of a whole file. Pages are faulted in by the OS
+    // on first touch, so opening a large file is cheap.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile() { Close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool Open(const std::string& path);
+        void Close();
+
+        bool is_open() const { return data_ != nullptr; }
+        const uint8_t* data() const { return data_; }
+        size_t size() const { return size_; }
+
+    private:
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        void* file_ = nullptr;
+        void* mapping_ = nullptr;
+#endif
+    };
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,187 @@
+#include "meter_dsp.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "simd.h"
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        // Below -100 dBFS everything snaps to 0: the decays would otherwise
+        // run into denormals and slow the whole bank down.
+        constexpr float kFloor = 1e-5f;
+
+        float DbPerSecondToFactor(float db_per_s, double dt) {
+            return (float)std::pow(10.0, -db_per_s * dt / 20.0);
+        }
+
+        // One-pole coefficient for time constant `tau` seconds.
+        float OnePole(double tau, double dt) {
+            if (tau <= 0.0) return 1.0f;
+            return (float)(1.0 - std::exp(-dt / tau));
+        }
+
+    }  // namespace
+
+    MeterCoeffs ComputeMeterCoeffs(const MeterBallistics& b, double dt) {
+        MeterCoeffs c;
+        c.dt = (float)dt;
+        c.peak_release = DbPerSecondToFactor(b.peak_release_db_per_s, dt);
+        c.ppm_release = DbPerSecondToFactor(b.ppm_release_db_per_s, dt);
+        // A burst of length T reads -1 dB: 1 - exp(-T / tau) = 10^(-1/20).
+        const double ppm_tau = b.ppm_integration_ms / 1000.0 / -std::log(1.0 - std::pow(10.0, -1.0 / 20.0));
+        c.ppm_attack = OnePole(ppm_tau, dt);
+        // 99 % after the rise time: tau = T / ln(100).
+        c.vu = OnePole(b.vu_rise_ms / 1000.0 / std::log(100.0), dt);
+        c.rms = OnePole(b.rms_window_ms / 1000.0, dt);
+        c.hold_time = b.hold_ms / 1000.0f;
+        return c;
+    }
+
+    void MeterBank::Resize(size_t n) {
+        channels = (n + kMeterLanes - 1) / kMeterLanes * kMeterLanes;
+        for (auto* v : {&input, &peak, &ppm, &vu, &mean_square, &hold, &hold_left}) v->assign(channels, 0.0f);
+    }
+
+    void MeterBank::Reset(size_t i) {
+        if (i >= channels) return;
+        input[i] = peak[i] = ppm[i] = vu[i] = mean_square[i] = hold[i] = hold_left[i] = 0.0f;
+    }
+
+    void RunMeterKernelScalar(MeterBank& bank, size_t count, const MeterCoeffs& c) {
+        count = std::min(count, bank.channels);
+        for (size_t i = 0; i < count; i++) {
+            const float x = bank.input[i];
+
+            float p = std::max(x, bank.peak[i] * c.peak_release);
+            bank.peak[i] = p < kFloor ? 0.0f : p;
+
+            const float m = bank.ppm[i];
+            float q = x > m ? m + (x - m) * c.ppm_attack : std::max(x, m * c.ppm_release);
+            bank.ppm[i] = q < kFloor ? 0.0f : q;
+
+            float v = bank.vu[i] + (x - bank.vu[i]) * c.vu;
+            bank.vu[i] = v < kFloor ? 0.0f : v;
+
+            float ms = bank.mean_square[i] + (x * x - bank.mean_square[i]) * c.rms;
+            bank.mean_square[i] = ms < kFloor * kFloor ? 0.0f : ms;
+
+            if (x >= bank.hold[i]) {
+                bank.hold[i] = x;
+                bank.hold_left[i] = c.hold_time;
+            } else {
+                const float left = std::max(bank.hold_left[i] - c.dt, 0.0f);
+                bank.hold_left[i] = left;
+                if (left <= 0.0f) {
+                    const float h = std::max(x, bank.hold[i] * c.peak_release);
+                    bank.hold[i] = h < kFloor ? 0.0f : h;
+                }
+            }
+        }
+    }
+
+#if defined(VOLUMEDECK_SSE2)
+    namespace {
+        inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+        inline __m128 Floor(__m128 v, __m128 floor) { return _mm_and_ps(_mm_cmpge_ps(v, floor), v); }
+    }  // namespace
+
+    void RunMeterKernel(MeterBank& bank, size_t count, const MeterCoeffs& c) {
+        count = std::min(count, bank.channels);
+        const __m128 peak_release = _mm_set1_ps(c.peak_release);
+        const __m128 ppm_attack = _mm_set1_ps(c.ppm_attack);
+        const __m128 ppm_release = _mm_set1_ps(c.ppm_release);
+        const __m128 vu_k = _mm_set1_ps(c.vu);
+        const __m128 rms_k = _mm_set1_ps(c.rms);
+        const __m128 hold_time = _mm_set1_ps(c.hold_time);
+        const __m128 dt = _mm_set1_ps(c.dt);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 floor = _mm_set1_ps(kFloor);
+        const __m128 floor_sq = _mm_set1_ps(kFloor * kFloor);
+
+        // Channels are padded to kMeterLanes, so whole vectors never read
+        // past the end.
+        for (size_t i = 0; i < count; i += 4) {
+            const __m128 x = _mm_loadu_ps(&bank.input[i]);
+
+            __m128 p = _mm_max_ps(x, _mm_mul_ps(_mm_loadu_ps(&bank.peak[i]), peak_release));
+            _mm_storeu_ps(&bank.peak[i], Floor(p, floor));
+
+            const __m128 m = _mm_loadu_ps(&bank.ppm[i]);
+            const __m128 up = _mm_add_ps(m, _mm_mul_ps(_mm_sub_ps(x, m), ppm_attack));
+            const __m128 down = _mm_max_ps(x, _mm_mul_ps(m, ppm_release));
+            _mm_storeu_ps(&bank.ppm[i], Floor(Select(_mm_cmpgt_ps(x, m), up, down), floor));
+
+            const __m128 v = _mm_loadu_ps(&bank.vu[i]);
+            _mm_storeu_ps(&bank.vu[i], Floor(_mm_add_ps(v, _mm_mul_ps(_mm_sub_ps(x, v), vu_k)), floor));
+
+            const __m128 ms = _mm_loadu_ps(&bank.mean_square[i]);
+            const __m128 ms2 = _mm_add_ps(ms, _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(x, x), ms), rms_k));
+            _mm_storeu_ps(&bank.mean_square[i], Floor(ms2, floor_sq));
+
+            const __m128 h = _mm_loadu_ps(&bank.hold[i]);
+            const __m128 rising = _mm_cmpge_ps(x, h);
+            const __m128 left = _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&bank.hold_left[i]), dt), zero);
+            const __m128 expired = _mm_cmple_ps(left, zero);
+            const __m128 fallen = Floor(_mm_max_ps(x, _mm_mul_ps(h, peak_release)), floor);
+            _mm_storeu_ps(&bank.hold[i], Select(rising, x, Select(expired, fallen, h)));
+            _mm_storeu_ps(&bank.hold_left[i], Select(rising, hold_time, left));
+        }
+    }
+#elif defined(VOLUMEDECK_NEON)
+    namespace {
+        inline float32x4_t Floor(float32x4_t v, float32x4_t floor) {
+            return vreinterpretq_f32_u32(vandq_u32(vcgeq_f32(v, floor), vreinterpretq_u32_f32(v)));
+        }
+    }  // namespace
+
+    void RunMeterKernel(MeterBank& bank, size_t count, const MeterCoeffs& c) {
+        count = std::min(count, bank.channels);
+        const float32x4_t peak_release = vdupq_n_f32(c.peak_release);
+        const float32x4_t ppm_attack = vdupq_n_f32(c.ppm_attack);
+        const float32x4_t ppm_release = vdupq_n_f32(c.ppm_release);
+        const float32x4_t vu_k = vdupq_n_f32(c.vu);
+        const float32x4_t rms_k = vdupq_n_f32(c.rms);
+        const float32x4_t hold_time = vdupq_n_f32(c.hold_time);
+        const float32x4_t dt = vdupq_n_f32(c.dt);
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        const float32x4_t floor = vdupq_n_f32(kFloor);
+        const float32x4_t floor_sq = vdupq_n_f32(kFloor * kFloor);
+
+        for (size_t i = 0; i < count; i += 4) {
+            const float32x4_t x = vld1q_f32(&bank.input[i]);
+
+            const float32x4_t p = vmaxq_f32(x, vmulq_f32(vld1q_f32(&bank.peak[i]), peak_release));
+            vst1q_f32(&bank.peak[i], Floor(p, floor));
+
+            const float32x4_t m = vld1q_f32(&bank.ppm[i]);
+            const float32x4_t up = vmlaq_f32(m, vsubq_f32(x, m), ppm_attack);
+            const float32x4_t down = vmaxq_f32(x, vmulq_f32(m, ppm_release));
+            vst1q_f32(&bank.ppm[i], Floor(vbslq_f32(vcgtq_f32(x, m), up, down), floor));
+
+            const float32x4_t v = vld1q_f32(&bank.vu[i]);
+            vst1q_f32(&bank.vu[i], Floor(vmlaq_f32(v, vsubq_f32(x, v), vu_k), floor));
+
+            const float32x4_t ms = vld1q_f32(&bank.mean_square[i]);
+            vst1q_f32(&bank.mean_square[i], Floor(vmlaq_f32(ms, vsubq_f32(vmulq_f32(x, x), ms), rms_k), floor_sq));
+
+            const float32x4_t h = vld1q_f32(&bank.hold[i]);
+            const uint32x4_t rising = vcgeq_f32(x, h);
+            const float32x4_t left = vmaxq_f32(vsubq_f32(vld1q_f32(&bank.hold_left[i]), dt), zero);
+            const uint32x4_t expired = vcleq_f32(left, zero);
+            const float32x4_t fallen = Floor(vmaxq_f32(x, vmulq_f32(h, peak_release)), floor);
+            vst1q_f32(&bank.hold[i], vbslq_f32(rising, x, vbslq_f32(expired, fallen, h)));
+            vst1q_f32(&bank.hold_left[i], vbslq_f32(rising, hold_time, left));
+        }
+    }
+#else
+    void RunMeterKernel(MeterBank& bank, size_t count, const MeterCoeffs& c) {
+        RunMeterKernelScalar(bank, count, c);
+    }
+#endif
+
+}  // namespace volumedeck_mixer
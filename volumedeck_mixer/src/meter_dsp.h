@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace volumedeck_mixer {
+
+    // Meter ballistics, applied to a stream of peak samples (linear 0..1, as
+    // IAudioMeterInformation / PulseAudio peak streams report them).
+    struct MeterBallistics {
+        // Sample-peak meter: instant attack, linear-in-dB fall.
+        float peak_release_db_per_s = 20.0f;
+        // IEC 60268-10 Type I (DIN) PPM: a burst this long reads -1 dB;
+        // falls 20 dB in 1.5 s.
+        float ppm_integration_ms = 10.0f;
+        float ppm_release_db_per_s = 20.0f / 1.5f;
+        // VU (IEC 60268-17): a step reaches 99 % in 300 ms, both ways.
+        float vu_rise_ms = 300.0f;
+        // Exponential window for the RMS of the peak envelope.
+        float rms_window_ms = 300.0f;
+        // Peak hold: stays put this long, then falls at the peak rate.
+        float hold_ms = 1500.0f;
+    };
+
+    // Per-tick multipliers derived from MeterBallistics for one dt.
+    struct MeterCoeffs {
+        float peak_release = 1.0f;  // multiplier per tick
+        float ppm_attack = 1.0f;    // one-pole coefficient towards the input
+        float ppm_release = 1.0f;
+        float vu = 1.0f;
+        float rms = 1.0f;
+        float hold_time = 0.0f;     // seconds
+        float dt = 0.0f;            // seconds
+    };
+
+    MeterCoeffs ComputeMeterCoeffs(const MeterBallistics& b, double dt_seconds);
+
+    // Meter state for many channels, struct-of-arrays so one kernel pass
+    // updates every session with full vectors. Sizes are padded to
+    // kMeterLanes; padding lanes just meter silence.
+    constexpr size_t kMeterLanes = 8;
+
+    struct MeterBank {
+        explicit MeterBank(size_t channels = 0) { Resize(channels); }
+        void Resize(size_t channels);
+        void Reset(size_t channel);
+
+        size_t channels = 0;  // padded
+        std::vector<float> input;       // latest peak sample per channel
+        std::vector<float> peak;
+        std::vector<float> ppm;
+        std::vector<float> vu;
+        std::vector<float> mean_square;
+        std::vector<float> hold;
+        std::vector<float> hold_left;   // seconds until the hold starts falling
+    };
+
+    // One ballistics step over channels [0, count). SSE2/NEON where
+    // available; the scalar version is the reference (tests, benchmarks).
+    void RunMeterKernel(MeterBank& bank, size_t count, const MeterCoeffs& c);
+    void RunMeterKernelScalar(MeterBank& bank, size_t count, const MeterCoeffs& c);
+
+}  // namespace volumedeck_mixer
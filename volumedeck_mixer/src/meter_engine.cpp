@@ -0,0 +1,224 @@
+#include "meter_engine.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        // -80 dBFS: below this a meter reads as silence.
+        constexpr float kSilence = 1e-4f;
+
+    }  // namespace
+
+    MeterEngine::MeterEngine(MeterProbe* probe, size_t capacity, MeterBallistics ballistics,
+                             std::chrono::microseconds interval)
+        : probe_(probe),
+          capacity_(capacity),
+          ballistics_(ballistics),
+          interval_(interval),
+          bank_(capacity),
+          samples_(bank_.channels, 0.0f),
+          reset_(new std::atomic<bool>[capacity]),
+          published_(new std::atomic<float>[capacity * kFieldCount]) {
+        for (size_t i = 0; i < capacity_; i++) reset_[i].store(false, std::memory_order_relaxed);
+        for (size_t i = 0; i < capacity_ * kFieldCount; i++) {
+            published_[i].store(0.0f, std::memory_order_relaxed);
+        }
+    }
+
+    MeterEngine::~MeterEngine() {
+        Stop();
+        if (scheduler_) scheduler_->SetWake(nullptr);
+    }
+
+    void MeterEngine::Start() {
+        if (thread_.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stop_ = false;
+        }
+        thread_ = std::thread([this] { ThreadLoop(); });
+    }
+
+    void MeterEngine::Stop() {
+        if (!thread_.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    void MeterEngine::SetScheduler(SampleScheduler* scheduler) {
+        scheduler_ = scheduler;
+        if (!scheduler_) return;
+        scheduler_->SetWake([this] {
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                wake_ = true;
+            }
+            cv_.notify_all();
+        });
+    }
+
+    void MeterEngine::ResetSlot(size_t slot) {
+        if (slot >= capacity_) return;
+        reset_[slot].store(true, std::memory_order_relaxed);
+        reset_pending_.store(true, std::memory_order_release);
+    }
+
+    void MeterEngine::Tick(double dt) {
+        const auto started = std::chrono::steady_clock::now();
+
+        std::fill(samples_.begin(), samples_.end(), 0.0f);
+        size_t count = probe_ ? std::min(probe_->Sample(samples_.data(), capacity_), capacity_) : 0;
+
+        if (reset_pending_.exchange(false, std::memory_order_acquire)) {
+            for (size_t i = 0; i < capacity_; i++) {
+                if (!reset_[i].exchange(false, std::memory_order_relaxed)) continue;
+                bank_.Reset(i);
+                if (history_) history_->ClearSlot(i);
+            }
+        }
+        // Slots a probe dropped keep decaying towards silence instead of
+        // freezing; they stop being reported once count shrinks.
+        for (size_t i = 0; i < bank_.channels; i++) {
+            const float s = samples_[i];
+            bank_.input[i] = s > 0.0f ? std::min(s, 1.0f) : 0.0f;  // also drops NaN
+        }
+
+        // The interval barely changes; recompute the pow/exp only when it does.
+        if (std::fabs(dt - coeffs_dt_) > 1e-6) {
+            coeffs_ = ComputeMeterCoeffs(ballistics_, dt);
+            coeffs_dt_ = dt;
+        }
+        RunMeterKernel(bank_, bank_.channels, coeffs_);
+        // The displayed peak, so the fall after the audio stops still counts.
+        audible_ = false;
+        for (size_t i = 0; i < count && !audible_; i++) audible_ = bank_.peak[i] > kSilence;
+        if (history_) history_->Accumulate(bank_.input.data(), capacity_, dt);
+        Publish(count);
+
+        const auto cost = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - started).count();
+        // Exponential average over roughly the last second of ticks.
+        const uint64_t prev = tick_cost_ns_.load(std::memory_order_relaxed);
+        tick_cost_ns_.store(prev == 0 ? (uint64_t)cost : prev - prev / 256 + (uint64_t)cost / 256,
+                            std::memory_order_relaxed);
+        ticks_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void MeterEngine::Publish(size_t count) {
+        const uint64_t s = seq_.load(std::memory_order_relaxed);
+        seq_.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < capacity_; i++) {
+            published_[kPeak * capacity_ + i].store(bank_.peak[i], std::memory_order_relaxed);
+            published_[kHold * capacity_ + i].store(bank_.hold[i], std::memory_order_relaxed);
+            published_[kPpm * capacity_ + i].store(bank_.ppm[i], std::memory_order_relaxed);
+            published_[kVu * capacity_ + i].store(bank_.vu[i], std::memory_order_relaxed);
+            published_[kRms * capacity_ + i].store(std::sqrt(bank_.mean_square[i]),
+                                                   std::memory_order_relaxed);
+        }
+        count_.store(count, std::memory_order_relaxed);
+
+        seq_.store(s + 2, std::memory_order_release);
+    }
+
+    size_t MeterEngine::Read(MeterReading* out, size_t capacity) const {
+        for (;;) {
+            const uint64_t s1 = seq_.load(std::memory_order_acquire);
+            if (s1 & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            const size_t count = count_.load(std::memory_order_relaxed);
+            const size_t n = std::min(count, capacity);
+            for (size_t i = 0; i < n; i++) {
+                out[i].peak = published_[kPeak * capacity_ + i].load(std::memory_order_relaxed);
+                out[i].hold = published_[kHold * capacity_ + i].load(std::memory_order_relaxed);
+                out[i].ppm = published_[kPpm * capacity_ + i].load(std::memory_order_relaxed);
+                out[i].vu = published_[kVu * capacity_ + i].load(std::memory_order_relaxed);
+                out[i].rms = published_[kRms * capacity_ + i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == s1) return count;
+        }
+    }
+
+    bool MeterEngine::Read(size_t slot, MeterReading* out) const {
+        if (slot >= capacity_) return false;
+        for (;;) {
+            const uint64_t s1 = seq_.load(std::memory_order_acquire);
+            if (s1 & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            const bool active = slot < count_.load(std::memory_order_relaxed);
+            MeterReading r;
+            r.peak = published_[kPeak * capacity_ + slot].load(std::memory_order_relaxed);
+            r.hold = published_[kHold * capacity_ + slot].load(std::memory_order_relaxed);
+            r.ppm = published_[kPpm * capacity_ + slot].load(std::memory_order_relaxed);
+            r.vu = published_[kVu * capacity_ + slot].load(std::memory_order_relaxed);
+            r.rms = published_[kRms * capacity_ + slot].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) != s1) continue;
+            if (!active) return false;
+            *out = r;
+            return true;
+        }
+    }
+
+    void MeterEngine::ThreadLoop() {
+        if (probe_) probe_->OnThreadStart();
+
+        auto last = std::chrono::steady_clock::now();
+        auto next = scheduler_ ? scheduler_->Due(last, last) : last + interval_;
+        std::unique_lock<std::mutex> lock(mu_);
+        while (!stop_) {
+            const auto woken = [this] { return stop_ || wake_; };
+            // Paused: nothing to wait for but a subscriber.
+            if (next == std::chrono::steady_clock::time_point::max()) {
+                cv_.wait(lock, woken);
+            } else {
+                cv_.wait_until(lock, next, woken);
+            }
+            if (stop_) break;
+            wake_ = false;
+            lock.unlock();
+
+            const auto now = std::chrono::steady_clock::now();
+            if (scheduler_) {
+                // Woken early, or the rate fell while we slept: re-plan from
+                // the last tick.
+                next = scheduler_->Due(last, now);
+                if (next > now) {
+                    lock.lock();
+                    continue;
+                }
+            }
+            const uint64_t cpu = scheduler_ ? ThreadCpuTimeNs() : 0;
+            // Ballistics use the real elapsed time, so a late wake-up decays
+            // by the right amount instead of stretching the release.
+            Tick(std::chrono::duration<double>(now - last).count());
+            last = now;
+            if (scheduler_) {
+                if (audible_) scheduler_->NoteActivity(now);
+                next = scheduler_->Ticked(now, ThreadCpuTimeNs() - cpu);
+            } else {
+                next += interval_;
+                if (next < now) next = now + interval_;  // don't burst after a stall
+            }
+
+            lock.lock();
+        }
+        lock.unlock();
+
+        if (probe_) probe_->OnThreadStop();
+    }
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "meter_dsp.h"
+#include "meter_history.h"
+#include "sample_scheduler.h"
+
+namespace volumedeck_mixer {
+
+    // Source of raw peak samples, polled from the meter thread. On Windows
+    // this wraps IAudioMeterInformation for the endpoint and every session.
+    class MeterProbe {
+    public:
+        virtual ~MeterProbe() = default;
+
+        // Run on the meter thread before the first / after the last Sample()
+        // call (COM init, acquiring and releasing interfaces).
+        virtual void OnThreadStart() {}
+        virtual void OnThreadStop() {}
+
+        // Writes the current peak (linear, 0..1) of up to `capacity` slots
+        // and returns how many are in use. Slot numbers must stay stable
+        // while a source lives; call MeterEngine::ResetSlot() when a slot is
+        // handed to a new source so its ballistics start from silence.
+        virtual size_t Sample(float* peaks, size_t capacity) = 0;
+    };
+
+    struct MeterReading {
+        float peak = 0.0f;  // sample peak, instant attack
+        float hold = 0.0f;  // peak hold
+        float ppm = 0.0f;   // quasi-peak (DIN PPM)
+        float vu = 0.0f;
+        float rms = 0.0f;
+    };
+
+    // Runs meter ballistics for every slot at a fixed rate on its own thread
+    // and publishes the smoothed values, so UIs and the FFI can read them at
+    // whatever rate they render without touching the audio APIs.
+    //
+    // Reads are lock-free: the writer publishes through a sequence counter
+    // and readers retry the (rare) read that overlapped a publish.
+    class MeterEngine {
+    public:
+        MeterEngine(MeterProbe* probe, size_t capacity, MeterBallistics ballistics = {},
+                    std::chrono::microseconds interval = std::chrono::milliseconds(4));
+        ~MeterEngine();
+
+        MeterEngine(const MeterEngine&) = delete;
+        MeterEngine& operator=(const MeterEngine&) = delete;
+
+        // Optional downsampled history, fed with the raw peaks every tick.
+        // Must have at least capacity() slots; set before Start().
+        void SetHistory(MeterHistory* history) { history_ = history; }
+
+        // Lets `scheduler` pick the tick rate instead of the fixed
+        // interval: meters above silence count as activity, and the thread
+        // sleeps while it has no subscribers. Set before Start().
+        void SetScheduler(SampleScheduler* scheduler);
+
+        void Start();
+        void Stop();
+        bool running() const { return thread_.joinable(); }
+
+        // One sample + ballistics + publish step. The thread calls this with
+        // the measured interval; tests drive it directly with a fixed dt.
+        void Tick(double dt_seconds);
+
+        // Zeroes a slot's ballistics on the next tick. Any thread.
+        void ResetSlot(size_t slot);
+
+        // Latest published values. Returns the number of active slots and
+        // copies up to `capacity` of them.
+        size_t Read(MeterReading* out, size_t capacity) const;
+        bool Read(size_t slot, MeterReading* out) const;
+
+        size_t capacity() const { return capacity_; }
+        uint64_t ticks() const { return ticks_.load(std::memory_order_relaxed); }
+        // Average CPU cost of one Tick() over the last second, in ns.
+        uint64_t tick_cost_ns() const { return tick_cost_ns_.load(std::memory_order_relaxed); }
+
+    private:
+        enum Field { kPeak, kHold, kPpm, kVu, kRms, kFieldCount };
+
+        void ThreadLoop();
+        void Publish(size_t count);
+
+        MeterProbe* const probe_;
+        MeterHistory* history_ = nullptr;
+        SampleScheduler* scheduler_ = nullptr;
+        const size_t capacity_;
+        const MeterBallistics ballistics_;
+        const std::chrono::microseconds interval_;
+
+        // Owned by the ticking thread.
+        MeterBank bank_;
+        std::vector<float> samples_;
+        bool audible_ = false;  // last tick had a meter above silence
+        double coeffs_dt_ = -1.0;
+        MeterCoeffs coeffs_;
+
+        std::unique_ptr<std::atomic<bool>[]> reset_;
+        std::atomic<bool> reset_pending_{false};
+
+        // Published state: field-major, kFieldCount x capacity.
+        std::atomic<uint64_t> seq_{0};
+        std::atomic<size_t> count_{0};
+        std::unique_ptr<std::atomic<float>[]> published_;
+
+        std::atomic<uint64_t> ticks_{0};
+        std::atomic<uint64_t> tick_cost_ns_{0};
+
+        std::mutex mu_;
+        std::condition_variable cv_;
+        bool stop_ = false;
+        bool wake_ = false;  // the scheduler's rate may have gone up
+        std::thread thread_;
+    };
+
+}  // namespace volumedeck_mixer
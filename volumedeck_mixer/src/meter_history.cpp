@@ -0,0 +1,130 @@
+#include "meter_history.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <thread>
+
+namespace volumedeck_mixer {
+
+    MeterHistory::MeterHistory(size_t slots, size_t length, float rate_hz)
+        : slots_(slots),
+          length_(std::max<size_t>(length, 1)),
+          period_(1.0 / std::max(rate_hz, 0.001f)),
+          bytes_(sizeof(MeterHistoryBlock) + slots * 2 * length_ * sizeof(float)),
+          storage_(new uint64_t[(bytes_ + 7) / 8]()),
+          peak_acc_(slots, 0.0f),
+          sq_acc_(slots, 0.0) {
+        block_ = new (storage_.get()) MeterHistoryBlock();
+        block_->magic = kMeterHistoryMagic;
+        block_->version = kMeterHistoryVersion;
+        block_->slots = (uint32_t)slots_;
+        block_->length = (uint32_t)length_;
+        block_->rate_hz = rate_hz;
+        block_->seq.store(0, std::memory_order_relaxed);
+        block_->columns.store(0, std::memory_order_relaxed);
+        data_ = reinterpret_cast<float*>(reinterpret_cast<uint8_t*>(storage_.get()) + sizeof(MeterHistoryBlock));
+    }
+
+    void MeterHistory::Accumulate(const float* peaks, size_t count, double dt) {
+        count = std::min(count, slots_);
+        for (size_t i = 0; i < count; i++) {
+            const float p = peaks[i] > 0.0f ? peaks[i] : 0.0f;
+            peak_acc_[i] = std::max(peak_acc_[i], p);
+            sq_acc_[i] += (double)p * p * dt;
+        }
+        elapsed_ += dt;
+        weight_ += dt;
+        if (elapsed_ < period_) return;
+
+        // After a stall, repeat the column so the time axis stays true.
+        const uint64_t n = std::min<uint64_t>((uint64_t)(elapsed_ / period_), length_);
+        WriteColumns(n);
+        elapsed_ = std::fmod(elapsed_, period_);
+    }
+
+    void MeterHistory::WriteColumns(uint64_t n) {
+        const uint64_t first = block_->columns.load(std::memory_order_relaxed);
+        const uint64_t s = block_->seq.load(std::memory_order_relaxed);
+        block_->seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t slot = 0; slot < slots_; slot++) {
+            const float rms = weight_ > 0.0 ? (float)std::sqrt(sq_acc_[slot] / weight_) : 0.0f;
+            float* peak_ring = Ring(slot, 0);
+            float* rms_ring = Ring(slot, 1);
+            for (uint64_t c = first; c < first + n; c++) {
+                peak_ring[c % length_] = peak_acc_[slot];
+                rms_ring[c % length_] = rms;
+            }
+            peak_acc_[slot] = 0.0f;
+            sq_acc_[slot] = 0.0;
+        }
+        weight_ = 0.0;
+
+        block_->columns.store(first + n, std::memory_order_relaxed);
+        block_->seq.store(s + 2, std::memory_order_release);
+    }
+
+    void MeterHistory::ClearSlot(size_t slot) {
+        if (slot >= slots_) return;
+        const uint64_t s = block_->seq.load(std::memory_order_relaxed);
+        block_->seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::fill(Ring(slot, 0), Ring(slot, 0) + 2 * length_, 0.0f);
+        block_->seq.store(s + 2, std::memory_order_release);
+        peak_acc_[slot] = 0.0f;
+        sq_acc_[slot] = 0.0;
+    }
+
+    namespace {
+
+        // Ring oldest first: from `start` to the end, then the wrap.
+        void Unroll(const float* ring, size_t length, size_t start, size_t valid, float* out) {
+            const size_t head = std::min(valid, length - start);
+            memcpy(out, ring + start, head * sizeof(float));
+            memcpy(out + head, ring, (valid - head) * sizeof(float));
+        }
+
+    }  // namespace
+
+    size_t MeterHistory::Copy(size_t slot, float* peaks, float* rms) const {
+        if (slot >= slots_) return 0;
+        for (;;) {
+            const uint64_t s1 = block_->seq.load(std::memory_order_acquire);
+            if (s1 & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            const uint64_t columns = block_->columns.load(std::memory_order_relaxed);
+            const size_t valid = (size_t)std::min<uint64_t>(columns, length_);
+            const size_t start = (size_t)((columns - valid) % length_);
+            if (peaks) Unroll(Ring(slot, 0), length_, start, valid, peaks);
+            if (rms) Unroll(Ring(slot, 1), length_, start, valid, rms);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (block_->seq.load(std::memory_order_relaxed) == s1) return valid;
+        }
+    }
+
+    size_t MeterHistory::CopyAll(std::vector<float>* out) const {
+        out->assign(slots_ * 2 * length_, 0.0f);
+        for (;;) {
+            const uint64_t s1 = block_->seq.load(std::memory_order_acquire);
+            if (s1 & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            const uint64_t columns = block_->columns.load(std::memory_order_relaxed);
+            const size_t valid = (size_t)std::min<uint64_t>(columns, length_);
+            const size_t start = (size_t)((columns - valid) % length_);
+            // Right-aligned, so the newest column is always last.
+            for (size_t ring = 0; ring < slots_ * 2; ring++) {
+                Unroll(data_ + ring * length_, length_, start, valid, out->data() + ring * length_ + (length_ - valid));
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (block_->seq.load(std::memory_order_relaxed) == s1) return valid;
+        }
+    }
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace volumedeck_mixer {
+
+    // Shared-memory layout of the meter history, read in place over FFI.
+    //
+    //   MeterHistoryBlock                 64 bytes
+    //   float data[slots][2][length]      peak ring, then RMS ring, per slot
+    //
+    // Column `c` (counting from 0 since creation) lives at index c % length
+    // of every ring; the newest is `columns - 1`. The writer bumps `seq` to
+    // odd before touching the rings and back to even after, so a reader
+    // copies when `seq` is even and unchanged around the copy.
+    struct MeterHistoryBlock {
+        uint32_t magic;    // 'VDMH'
+        uint32_t version;
+        uint32_t slots;
+        uint32_t length;
+        float rate_hz;
+        uint32_t reserved;
+        std::atomic<uint64_t> seq;
+        std::atomic<uint64_t> columns;
+        uint8_t pad[24];
+    };
+
+    static_assert(sizeof(MeterHistoryBlock) == 64, "history block layout");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "history block is read from Dart");
+
+    constexpr uint32_t kMeterHistoryMagic = 0x484D4456;  // "VDMH" little endian
+    constexpr uint32_t kMeterHistoryVersion = 1;
+
+    // Fixed-size, downsampled peak/RMS history per meter slot, e.g. the last
+    // 10 s at 30 Hz. Fed from the meter thread at its own rate; every
+    // column holds the maximum peak and the RMS over its period. All memory
+    // is allocated up front.
+    class MeterHistory {
+    public:
+        MeterHistory(size_t slots, size_t length = 300, float rate_hz = 30.0f);
+
+        MeterHistory(const MeterHistory&) = delete;
+        MeterHistory& operator=(const MeterHistory&) = delete;
+
+        // Writer side (one thread). `peaks` are raw per-tick peak samples for
+        // slots [0, count); missing slots count as silence.
+        void Accumulate(const float* peaks, size_t count, double dt_seconds);
+        void ClearSlot(size_t slot);
+
+        // Reader side, any thread. Copies the slot's history oldest first
+        // into `peaks`/`rms` (either may be null) and returns the number of
+        // columns written, at most length().
+        size_t Copy(size_t slot, float* peaks, float* rms) const;
+
+        // Every slot as one packed array, [slot][peak ring, RMS ring], each
+        // ring oldest first and length() long (zero-padded at the front
+        // while the history is filling). Returns the valid column count.
+        size_t CopyAll(std::vector<float>* out) const;
+
+        const MeterHistoryBlock* block() const { return block_; }
+        size_t block_size() const { return bytes_; }
+        size_t slots() const { return slots_; }
+        size_t length() const { return length_; }
+
+    private:
+        float* Ring(size_t slot, size_t field) const { return data_ + (slot * 2 + field) * length_; }
+        void WriteColumns(uint64_t n);
+
+        const size_t slots_;
+        const size_t length_;
+        const double period_;
+        const size_t bytes_;
+        std::unique_ptr<uint64_t[]> storage_;  // 8-byte aligned for the atomics
+        MeterHistoryBlock* block_;
+        float* data_;
+
+        // Current column being accumulated (writer only).
+        std::vector<float> peak_acc_;
+        std::vector<double> sq_acc_;
+        double elapsed_ = 0.0;
+        double weight_ = 0.0;
+    };
+
+}  // namespace volumedeck_mixer
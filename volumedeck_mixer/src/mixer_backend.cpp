@@ -0,0 +1,66 @@
+#include "mixer_backend.h"
+
+#include <cstring>
+#include <random>
+
+#include "fake_mixer_backend.h"
+#include "pulse_mixer_backend.h"
+#include "sim_mixer_backend.h"
+#ifdef _WIN32
+#include "wasapi_mixer_backend.h"
+#endif
+
+namespace volumedeck_mixer {
+
+    std::string ExeBasenameLower(const std::string& path_or_name) {
+        const size_t slash = path_or_name.find_last_of("/\\");
+        std::string base = slash == std::string::npos ? path_or_name : path_or_name.substr(slash + 1);
+        for (char& c : base) {
+            if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+        }
+        return base;
+    }
+
+    bool MixerContext::empty() const { return *this == MixerContext(); }
+
+    bool MixerContext::operator==(const MixerContext& other) const {
+        return memcmp(bytes, other.bytes, sizeof(bytes)) == 0;
+    }
+
+    const MixerContext& ProcessMixerContext() {
+        static const MixerContext context = [] {
+            MixerContext c;
+            std::random_device rd;
+            for (size_t i = 0; i < sizeof(c.bytes); i += 4) {
+                const uint32_t r = rd();
+                memcpy(c.bytes + i, &r, 4);
+            }
+            // A version 4 UUID, and never GUID_NULL.
+            c.bytes[7] = (uint8_t)((c.bytes[7] & 0x0f) | 0x40);
+            c.bytes[8] = (uint8_t)((c.bytes[8] & 0x3f) | 0x80);
+            return c;
+        }();
+        return context;
+    }
+
+    std::unique_ptr<MixerBackend> CreateMixerBackend(const std::string& name) {
+        if (name == "fake") return std::make_unique<FakeMixerBackend>();
+        if (name == "sim") return std::make_unique<SimMixerBackend>();
+        if (name.compare(0, 4, "sim:") == 0) {
+            SimMixerConfig config;
+            if (!ParseSimMixerSpec(name.substr(4), &config)) return nullptr;
+            return std::make_unique<SimMixerBackend>(config);
+        }
+#ifdef _WIN32
+        if (name.empty() || name == "wasapi") return std::make_unique<WasapiMixerBackend>();
+#else
+#ifdef VOLUMEDECK_HAVE_PULSE
+        // Opt-in until the pulse_mixer_backend ctest has passed on a real server.
+        if (name == "pulse") return std::make_unique<PulseMixerBackend>();
+#endif
+        if (name.empty()) return std::make_unique<FakeMixerBackend>();
+#endif
+        return nullptr;
+    }
+
+}  // namespace volumedeck_mixer
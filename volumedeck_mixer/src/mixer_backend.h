@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace volumedeck_mixer {
+
+    struct AudioSession {
+        std::string id;            // stable while the session lives
+        uint32_t pid = 0;
+        std::string exe_name;      // lowercase basename, "chrome.exe"
+        std::string exe_path;
+        std::string display_name;
+        float volume = 1.0f;       // 0..1
+        bool mute = false;
+        float peak = 0.0f;         // 0..1
+        bool system = false;       // the "system sounds" session
+    };
+
+    // A volume or mute change the OS mixer reported.
+    struct MixerChange {
+        std::string id;  // session id; empty for the master endpoint
+        float volume = 1.0f;
+        bool mute = false;
+    };
+    using MixerChangeObserver = std::function<void(const MixerChange& change)>;
+
+    // Who made a write: 16 bytes laid out like a Windows GUID. WASAPI takes
+    // it as the event context of a write and hands it back in the change
+    // notification. All zero is GUID_NULL, "no context".
+    struct MixerContext {
+        uint8_t bytes[16] = {};
+
+        bool empty() const;
+        bool operator==(const MixerContext& other) const;
+        bool operator!=(const MixerContext& other) const { return !(*this == other); }
+    };
+
+    // Random, made on first use: every write this process makes is tagged
+    // with it, whichever backend (or the plugin) makes it.
+    const MixerContext& ProcessMixerContext();
+
+    // Everything the slider pipeline needs from the OS mixer. WASAPI on
+    // Windows, PulseAudio/PipeWire on Linux, in-memory fakes for tests and
+    // benchmarks. All calls come from one thread (the engine's), between
+    // Start() and Stop().
+    class MixerBackend {
+    public:
+        virtual ~MixerBackend() = default;
+
+        virtual const char* name() const = 0;
+
+        // Thread setup and connection (COM init, server connect).
+        virtual bool Start() { return true; }
+        virtual void Stop() {}
+        // True once the connection Start() made has died (the sound server
+        // restarted). The engine then calls Stop() and Start() again,
+        // backing off while Start() fails.
+        virtual bool lost() const { return false; }
+
+        virtual bool ListSessions(std::vector<AudioSession>* out) = 0;
+
+        virtual bool GetMaster(float* volume, bool* mute, float* peak) = 0;
+        virtual bool SetMasterVolume(float volume) = 0;
+        virtual bool SetMasterMute(bool mute) = 0;
+
+        virtual bool SetSessionVolume(const std::string& id, float volume) = 0;
+        virtual bool SetSessionMute(const std::string& id, bool mute) = 0;
+
+        // Optional deej targets; unsupported by default.
+        virtual bool SetInputVolume(float) { return false; }                       // "mic"
+        virtual bool SetDeviceVolume(const std::string& /*name*/, float) { return false; }
+        virtual uint32_t ForegroundPid() { return 0; }                             // "deej.current"
+
+        // Volume and mute changes made by anyone but this process, reported
+        // on whatever thread the OS reports them on. Our own writes are
+        // filtered out at the source (see EchoFilter). False if the backend
+        // has no change notifications: keep polling. Set before Start().
+        virtual bool SetChangeObserver(MixerChangeObserver) { return false; }
+
+        // Changes whenever the session list may have changed. Backends with
+        // change notifications bump it; 0 means "unknown, poll".
+        virtual uint64_t session_generation() const { return 0; }
+    };
+
+    // Lowercase basename of a path or process name, both separators.
+    std::string ExeBasenameLower(const std::string& path_or_name);
+
+    // "fake", "sim" or "sim:<spec>" (see ParseSimMixerSpec), "wasapi"
+    // (Windows), "pulse" (Linux with libpulse, by name only for now); empty
+    // picks the platform default. Null for names this build does not have or a bad spec.
+    std::unique_ptr<MixerBackend> CreateMixerBackend(const std::string& name);
+
+}  // namespace volumedeck_mixer
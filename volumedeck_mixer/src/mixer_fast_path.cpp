@@ -0,0 +1,135 @@
+#include "mixer_fast_path.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace volumedeck_mixer {
+
+    static_assert(sizeof(VolumedeckMixerOp) == 16, "ffi op layout");
+    static_assert(sizeof(MeterReading) == VOLUMEDECK_METER_FIELDS * sizeof(float), "ffi meter layout");
+
+    MixerFastPath::MixerFastPath(MixerBackend* backend, const StateChannelReader* state, const MeterEngine* meters,
+                                 SampleScheduler* sampler)
+        : backend_(backend), state_(state), meters_(meters), sampler_(sampler) {}
+
+    // Start() started the backend; its owner stops it.
+    MixerFastPath::~MixerFastPath() = default;
+
+    bool MixerFastPath::Start() {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (!started_) started_ = backend_->Start();
+        return started_;
+    }
+
+    const std::string* MixerFastPath::SessionLocked(uint32_t generation, uint32_t slot) {
+        const uint64_t gen = state_->header()->generation.load(std::memory_order_acquire);
+        if (gen != generation_ && state_->ReadRoster(&roster_, &generation_)) {
+            slots_.resize(roster_.size());
+            for (size_t i = 0; i < roster_.size(); i++) slots_[i] = std::move(roster_[i].id);
+        }
+        // The caller's slot numbers belong to another roster.
+        if (generation != (uint32_t)generation_) return nullptr;
+        if (slot >= slots_.size() || slots_[slot].empty()) return nullptr;
+        return &slots_[slot];
+    }
+
+    bool MixerFastPath::ApplyLocked(uint32_t generation, uint32_t slot, uint32_t kind, float value) {
+        if (!started_) return false;
+        if (sampler_) sampler_->NoteActivity();  // a fader in the UI
+        if (slot == 0) {
+            return kind == VOLUMEDECK_OP_VOLUME ? backend_->SetMasterVolume(std::clamp(value, 0.0f, 1.0f))
+                                                : backend_->SetMasterMute(value != 0.0f);
+        }
+        const std::string* id = SessionLocked(generation, slot);
+        if (!id) return false;
+        return kind == VOLUMEDECK_OP_VOLUME ? backend_->SetSessionVolume(*id, std::clamp(value, 0.0f, 1.0f))
+                                            : backend_->SetSessionMute(*id, value != 0.0f);
+    }
+
+    bool MixerFastPath::SetVolume(uint32_t generation, uint32_t slot, float volume) {
+        std::lock_guard<std::mutex> lock(mu_);
+        return ApplyLocked(generation, slot, VOLUMEDECK_OP_VOLUME, volume);
+    }
+
+    bool MixerFastPath::SetMute(uint32_t generation, uint32_t slot, bool mute) {
+        std::lock_guard<std::mutex> lock(mu_);
+        return ApplyLocked(generation, slot, VOLUMEDECK_OP_MUTE, mute ? 1.0f : 0.0f);
+    }
+
+    uint32_t MixerFastPath::ApplyBatch(const VolumedeckMixerOp* ops, uint32_t count) {
+        std::lock_guard<std::mutex> lock(mu_);
+        uint32_t applied = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            if (ops[i].kind > VOLUMEDECK_OP_MUTE) continue;
+            applied += ApplyLocked(ops[i].generation, ops[i].slot, ops[i].kind, ops[i].value) ? 1 : 0;
+        }
+        return applied;
+    }
+
+    uint32_t MixerFastPath::ReadMeters(float* out, uint32_t max_slots) {
+        if (meters_) return (uint32_t)meters_->Read(reinterpret_cast<MeterReading*>(out), max_slots);
+
+        std::lock_guard<std::mutex> lock(mu_);
+        if (!state_->ReadFrame(&frame_)) return 0;
+        const uint32_t n = (uint32_t)std::min<size_t>(frame_.slots.size(), max_slots);
+        for (uint32_t i = 0; i < n; i++) {
+            std::fill(out + i * VOLUMEDECK_METER_FIELDS, out + (i + 1) * VOLUMEDECK_METER_FIELDS,
+                      frame_.slots[i].peak);
+        }
+        return n;
+    }
+
+    // ---------- C ABI ----------
+
+    // Callers count themselves in before loading the pointer, so once an
+    // uninstall has swapped it out, a zero count means nobody still holds
+    // the old one. Both sides are seq_cst: each must see the other's write.
+    static std::atomic<MixerFastPath*> g_fast_path{nullptr};
+    static std::atomic<int> g_in_use{0};
+
+    namespace {
+        class FastPathCall {
+        public:
+            FastPathCall() { g_in_use.fetch_add(1); }
+            ~FastPathCall() { g_in_use.fetch_sub(1); }
+            MixerFastPath* get() const { return g_fast_path.load(); }
+        };
+    }  // namespace
+
+    bool InstallMixerFastPath(MixerFastPath* path) {
+        if (path && !path->Start()) return false;
+        g_fast_path.exchange(path);
+        if (!path) {
+            while (g_in_use.load() != 0) std::this_thread::yield();
+        }
+        return true;
+    }
+
+}  // namespace volumedeck_mixer
+
+using volumedeck_mixer::FastPathCall;
+
+extern "C" int32_t VolumedeckMixerSetVolume(uint32_t generation, uint32_t slot, float volume) {
+    FastPathCall call;
+    auto* p = call.get();
+    return p && p->SetVolume(generation, slot, volume) ? 1 : 0;
+}
+
+extern "C" int32_t VolumedeckMixerSetMute(uint32_t generation, uint32_t slot, int32_t mute) {
+    FastPathCall call;
+    auto* p = call.get();
+    return p && p->SetMute(generation, slot, mute != 0) ? 1 : 0;
+}
+
+extern "C" uint32_t VolumedeckMixerApplyBatch(const VolumedeckMixerOp* ops, uint32_t count) {
+    FastPathCall call;
+    auto* p = call.get();
+    return p && ops ? p->ApplyBatch(ops, count) : 0;
+}
+
+extern "C" uint32_t VolumedeckMixerReadMeters(float* out, uint32_t max_slots) {
+    FastPathCall call;
+    auto* p = call.get();
+    return p && out ? p->ReadMeters(out, max_slots) : 0;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "meter_engine.h"
+#include "mixer_backend.h"
+#include "sample_scheduler.h"
+#include "state_channel.h"
+#include "volumedeck_mixer_ffi.h"
+
+namespace volumedeck_mixer {
+
+    // What the FFI entry points call into. Slots are resolved through the
+    // state channel's roster, so they mean the same thing to Dart as the
+    // arrays it reads in place; the table is only rebuilt when the roster
+    // generation moves, and session writes tagged with any other
+    // generation are refused. Calls are serialized.
+    //
+    // The plugin fills its own channel from the meter thread, which pauses
+    // while the sampler has no subscribers: Dart holds a subscription for
+    // as long as it resolves slots through the channel, and falls back to
+    // the MethodChannel without one.
+    class MixerFastPath {
+    public:
+        // `meters` supplies full ballistics when its slots match the
+        // channel's (the plugin's own probe); otherwise ReadMeters falls
+        // back to the channel's raw peaks. Writes count as activity on
+        // `sampler`, as MethodChannel writes do.
+        MixerFastPath(MixerBackend* backend, const StateChannelReader* state, const MeterEngine* meters = nullptr,
+                      SampleScheduler* sampler = nullptr);
+        ~MixerFastPath();
+
+        MixerFastPath(const MixerFastPath&) = delete;
+        MixerFastPath& operator=(const MixerFastPath&) = delete;
+
+        // Starts the backend on the calling thread. InstallMixerFastPath()
+        // does this, so the first fader move doesn't pay for it.
+        bool Start();
+
+        bool SetVolume(uint32_t generation, uint32_t slot, float volume);
+        bool SetMute(uint32_t generation, uint32_t slot, bool mute);
+        uint32_t ApplyBatch(const VolumedeckMixerOp* ops, uint32_t count);
+        uint32_t ReadMeters(float* out, uint32_t max_slots);
+
+    private:
+        bool ApplyLocked(uint32_t generation, uint32_t slot, uint32_t kind, float value);
+        const std::string* SessionLocked(uint32_t generation, uint32_t slot);
+
+        MixerBackend* const backend_;
+        const StateChannelReader* const state_;
+        const MeterEngine* const meters_;
+        SampleScheduler* const sampler_;
+
+        std::mutex mu_;
+        bool started_ = false;
+        uint64_t generation_ = 0;
+        std::vector<std::string> slots_;
+        std::vector<StateRosterEntry> roster_;
+        std::vector<MeterReading> readings_;
+        StateFrame frame_;
+    };
+
+    // Starts `path` and routes the C ABI to it; false if it didn't start.
+    // Null uninstalls, returning once calls already inside the previous
+    // path have left it, so the caller may destroy it afterwards.
+    bool InstallMixerFastPath(MixerFastPath* path);
+
+}  // namespace volumedeck_mixer
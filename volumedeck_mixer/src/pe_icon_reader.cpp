@@ -0,0 +1,342 @@
+#include "pe_icon_reader.h"
+
+#include <cstring>
+
+#include "mapped_file.h"
+#include "png_decoder.h"
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        constexpr uint32_t kRtIcon = 3;
+        constexpr uint32_t kRtGroupIcon = 14;
+        constexpr int kMaxResourceDepth = 3;
+
+        uint16_t Le16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+        uint32_t Le32(const uint8_t* p) {
+            return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        }
+
+        struct Section {
+            uint32_t va;
+            uint32_t vsize;
+            uint32_t raw_offset;
+            uint32_t raw_size;
+        };
+
+        // Bounds-checked view over the image plus RVA translation.
+        class PeImage {
+        public:
+            PeImage(const uint8_t* p, size_t n) : p_(p), n_(n) {}
+
+            bool Parse() {
+                if (n_ < 0x40 || p_[0] != 'M' || p_[1] != 'Z') return false;
+                const uint32_t pe = Le32(p_ + 0x3C);
+                if (!Has(pe, 24) || memcmp(p_ + pe, "PE\0\0", 4) != 0) return false;
+
+                const uint8_t* coff = p_ + pe + 4;
+                const uint16_t nsections = Le16(coff + 2);
+                const uint16_t opt_size = Le16(coff + 16);
+                const uint32_t opt = pe + 24;
+                if (!Has(opt, opt_size) || opt_size < 2) return false;
+
+                const uint16_t magic = Le16(p_ + opt);
+                uint32_t dirs;  // offset of the data directory array
+                if (magic == 0x10B) dirs = opt + 96;        // PE32
+                else if (magic == 0x20B) dirs = opt + 112;  // PE32+
+                else return false;
+                // NumberOfRvaAndSizes sits just before the directories.
+                if (!Has(dirs - 4, 4) || dirs > opt + opt_size) return false;
+
+                const uint32_t ndirs = Le32(p_ + dirs - 4);
+                if (ndirs <= 2 || !Has(dirs + 2 * 8, 8) || dirs + 3 * 8 > opt + opt_size) return false;
+                rsrc_rva_ = Le32(p_ + dirs + 2 * 8);
+                rsrc_size_ = Le32(p_ + dirs + 2 * 8 + 4);
+
+                const uint32_t sect = opt + opt_size;
+                if (!Has(sect, (size_t)nsections * 40)) return false;
+                for (uint16_t i = 0; i < nsections; i++) {
+                    const uint8_t* s = p_ + sect + i * 40;
+                    sections_.push_back({Le32(s + 12), Le32(s + 8), Le32(s + 20), Le32(s + 16)});
+                }
+                return rsrc_rva_ != 0 && rsrc_size_ != 0;
+            }
+
+            // File offset of [rva, rva + len), or false if it is not backed
+            // by file data.
+            bool Offset(uint32_t rva, size_t len, size_t* out) const {
+                for (const auto& s : sections_) {
+                    const uint32_t span = s.vsize ? s.vsize : s.raw_size;
+                    if (rva < s.va || rva - s.va >= span) continue;
+                    const size_t delta = rva - s.va;
+                    if (delta + len > s.raw_size) return false;
+                    const size_t off = (size_t)s.raw_offset + delta;
+                    if (!Has(off, len)) return false;
+                    *out = off;
+                    return true;
+                }
+                return false;
+            }
+
+            bool Has(size_t off, size_t len) const { return off <= n_ && len <= n_ - off; }
+            const uint8_t* at(size_t off) const { return p_ + off; }
+            uint32_t rsrc_rva() const { return rsrc_rva_; }
+
+        private:
+            const uint8_t* p_;
+            size_t n_;
+            uint32_t rsrc_rva_ = 0;
+            uint32_t rsrc_size_ = 0;
+            std::vector<Section> sections_;
+        };
+
+        struct ResourceEntry {
+            bool is_dir;
+            uint32_t id;       // 0xFFFFFFFF for named entries
+            uint32_t target;   // offset from the start of the resource directory
+        };
+
+        // Entries of the IMAGE_RESOURCE_DIRECTORY at `dir` (relative to the
+        // resource section).
+        bool ReadDirectory(const PeImage& img, uint32_t dir, std::vector<ResourceEntry>& out) {
+            out.clear();
+            size_t off;
+            if (!img.Offset(img.rsrc_rva() + dir, 16, &off)) return false;
+            const uint8_t* d = img.at(off);
+            const uint32_t n = (uint32_t)Le16(d + 12) + Le16(d + 14);
+            if (n > 4096 || !img.Offset(img.rsrc_rva() + dir + 16, (size_t)n * 8, &off)) return false;
+
+            const uint8_t* e = img.at(off);
+            for (uint32_t i = 0; i < n; i++, e += 8) {
+                const uint32_t name = Le32(e);
+                const uint32_t target = Le32(e + 4);
+                ResourceEntry r;
+                r.is_dir = (target & 0x80000000u) != 0;
+                r.target = target & 0x7FFFFFFFu;
+                r.id = (name & 0x80000000u) ? 0xFFFFFFFFu : (name & 0xFFFF);
+                out.push_back(r);
+            }
+            return true;
+        }
+
+        // Follows the first entry down to an IMAGE_RESOURCE_DATA_ENTRY
+        // (any language) and returns its file range.
+        bool ResolveData(const PeImage& img, ResourceEntry e, int depth, const uint8_t** data, size_t* size) {
+            std::vector<ResourceEntry> children;
+            while (e.is_dir) {
+                if (++depth > kMaxResourceDepth) return false;
+                if (!ReadDirectory(img, e.target, children) || children.empty()) return false;
+                e = children[0];
+            }
+            size_t off;
+            if (!img.Offset(img.rsrc_rva() + e.target, 16, &off)) return false;
+            const uint32_t rva = Le32(img.at(off));
+            const uint32_t len = Le32(img.at(off + 4));
+            if (!img.Offset(rva, len, &off)) return false;
+            *data = img.at(off);
+            *size = len;
+            return true;
+        }
+
+        bool FindTypeDir(const std::vector<ResourceEntry>& root, uint32_t type, ResourceEntry* out) {
+            for (const auto& e : root) {
+                if (e.id == type && e.is_dir) {
+                    *out = e;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        int EdgeFromByte(uint8_t b) { return b == 0 ? 256 : b; }
+
+        uint32_t AndMaskBit(const uint8_t* mask, size_t mask_stride, int x, int y_bottom_up) {
+            return (mask[(size_t)y_bottom_up * mask_stride + (size_t)(x >> 3)] >> (7 - (x & 7))) & 1u;
+        }
+
+        bool DecodeBmp(const uint8_t* p, size_t n, DecodedIcon* out) {
+            if (n < 40) return false;
+            const uint32_t hdr = Le32(p);
+            if (hdr < 40 || hdr > n) return false;
+            const int32_t w = (int32_t)Le32(p + 4);
+            const int32_t h2 = (int32_t)Le32(p + 8);  // XOR + AND masks
+            const uint16_t bpp = Le16(p + 14);
+            const uint32_t compression = Le32(p + 16);
+            uint32_t colors_used = Le32(p + 32);
+            if (w <= 0 || w > 1024 || h2 <= 0 || h2 > 2048 || (h2 & 1) || compression != 0) return false;
+            const int h = h2 / 2;
+
+            size_t palette_entries = 0;
+            if (bpp <= 8) {
+                palette_entries = colors_used ? colors_used : (1u << bpp);
+                if (palette_entries > 256) return false;
+            } else if (bpp != 24 && bpp != 32) {
+                return false;
+            }
+
+            const uint8_t* palette = p + hdr;
+            const size_t xor_stride = (((size_t)w * bpp + 31) / 32) * 4;
+            const size_t and_stride = (((size_t)w + 31) / 32) * 4;
+            const size_t xor_at = hdr + palette_entries * 4;
+            const size_t and_at = xor_at + xor_stride * (size_t)h;
+            if (xor_at > n || xor_stride * (size_t)h > n - xor_at) return false;
+            // Some 32-bit icons omit the AND mask; alpha carries everything.
+            const bool has_mask = and_at <= n && and_stride * (size_t)h <= n - and_at;
+            if (!has_mask && bpp != 32) return false;
+
+            out->width = w;
+            out->height = h;
+            out->bgra.assign((size_t)w * h * 4, 0);
+
+            bool any_alpha = false;
+            for (int y = 0; y < h; y++) {
+                const uint8_t* src = p + xor_at + (size_t)(h - 1 - y) * xor_stride;  // bottom-up
+                uint8_t* dst = &out->bgra[(size_t)y * w * 4];
+                for (int x = 0; x < w; x++, dst += 4) {
+                    if (bpp == 32) {
+                        memcpy(dst, src + x * 4, 4);
+                        any_alpha |= dst[3] != 0;
+                        continue;
+                    }
+                    if (bpp == 24) {
+                        memcpy(dst, src + x * 3, 3);
+                    } else {
+                        const int per_byte = 8 / bpp;
+                        const int shift = (per_byte - 1 - (x % per_byte)) * bpp;
+                        const size_t idx = (src[x / per_byte] >> shift) & ((1u << bpp) - 1);
+                        if (idx >= palette_entries) return false;
+                        memcpy(dst, palette + idx * 4, 3);
+                    }
+                    dst[3] = 255;
+                }
+            }
+
+            // Without real alpha, the AND mask says which pixels are see-through.
+            if (has_mask && (bpp != 32 || !any_alpha)) {
+                const uint8_t* mask = p + and_at;
+                for (int y = 0; y < h; y++) {
+                    uint8_t* dst = &out->bgra[(size_t)y * w * 4];
+                    for (int x = 0; x < w; x++, dst += 4) {
+                        dst[3] = AndMaskBit(mask, and_stride, x, h - 1 - y) ? 0 : 255;
+                    }
+                }
+            }
+            return true;
+        }
+
+    }  // namespace
+
+    bool ListPeIconVariants(const uint8_t* image, size_t size, std::vector<IconVariant>& out) {
+        out.clear();
+        PeImage img(image, size);
+        if (!img.Parse()) return false;
+
+        std::vector<ResourceEntry> root;
+        if (!ReadDirectory(img, 0, root)) return false;
+
+        ResourceEntry groups, icons;
+        if (!FindTypeDir(root, kRtGroupIcon, &groups) || !FindTypeDir(root, kRtIcon, &icons)) return false;
+
+        std::vector<ResourceEntry> group_list, icon_list;
+        if (!ReadDirectory(img, groups.target, group_list) || group_list.empty()) return false;
+        if (!ReadDirectory(img, icons.target, icon_list)) return false;
+
+        const uint8_t* grp;
+        size_t grp_size;
+        if (!ResolveData(img, group_list[0], 1, &grp, &grp_size) || grp_size < 6) return false;
+        const uint16_t count = Le16(grp + 4);
+        if (Le16(grp + 2) != 1 || grp_size < 6 + (size_t)count * 14) return false;
+
+        for (uint16_t i = 0; i < count; i++) {
+            const uint8_t* e = grp + 6 + i * 14;  // GRPICONDIRENTRY
+            const uint16_t id = Le16(e + 12);
+            for (const auto& ie : icon_list) {
+                if (ie.id != id) continue;
+                IconVariant v;
+                if (!ResolveData(img, ie, 1, &v.data, &v.size)) break;
+                v.width = EdgeFromByte(e[0]);
+                v.height = EdgeFromByte(e[1]);
+                v.bit_count = Le16(e + 6);
+                out.push_back(v);
+                break;
+            }
+        }
+        return !out.empty();
+    }
+
+    bool ListIcoVariants(const uint8_t* data, size_t size, std::vector<IconVariant>& out) {
+        out.clear();
+        if (size < 6 || Le16(data) != 0 || Le16(data + 2) != 1) return false;
+        const uint16_t count = Le16(data + 4);
+        if (size < 6 + (size_t)count * 16) return false;
+
+        for (uint16_t i = 0; i < count; i++) {
+            const uint8_t* e = data + 6 + i * 16;  // ICONDIRENTRY
+            const uint32_t len = Le32(e + 8);
+            const uint32_t off = Le32(e + 12);
+            if (off > size || len > size - off) continue;
+            IconVariant v;
+            v.width = EdgeFromByte(e[0]);
+            v.height = EdgeFromByte(e[1]);
+            v.bit_count = Le16(e + 6);
+            v.data = data + off;
+            v.size = len;
+            out.push_back(v);
+        }
+        return !out.empty();
+    }
+
+    int PickIconVariant(const std::vector<IconVariant>& variants, int size) {
+        int best = -1;
+        for (int i = 0; i < (int)variants.size(); i++) {
+            const IconVariant& v = variants[i];
+            if (best < 0) {
+                best = i;
+                continue;
+            }
+            const IconVariant& b = variants[best];
+            const bool v_fits = v.width >= size, b_fits = b.width >= size;
+            if (v_fits != b_fits) {
+                if (v_fits) best = i;
+                continue;
+            }
+            // Both big enough: prefer the smaller. Both too small: the larger.
+            if (v.width != b.width) {
+                if (v_fits ? v.width < b.width : v.width > b.width) best = i;
+                continue;
+            }
+            if (v.bit_count > b.bit_count) best = i;
+        }
+        return best;
+    }
+
+    bool DecodeIconVariant(const IconVariant& v, DecodedIcon* out) {
+        if (!v.data || v.size == 0) return false;
+        if (IsPng(v.data, v.size)) {
+            return DecodePngToBgra(v.data, v.size, &out->width, &out->height, out->bgra);
+        }
+        return DecodeBmp(v.data, v.size, out);
+    }
+
+    bool ExtractIconFromFile(const std::string& path, int size, DecodedIcon* out) {
+        MappedFile file;
+        if (!file.Open(path)) return false;
+
+        std::vector<IconVariant> variants;
+        const bool ok = ListPeIconVariants(file.data(), file.size(), variants) ||
+                        ListIcoVariants(file.data(), file.size(), variants);
+        if (!ok) return false;
+
+        const int pick = PickIconVariant(variants, size);
+        if (pick < 0) return false;
+        if (DecodeIconVariant(variants[pick], out)) return true;
+
+        // A damaged variant should not hide the others.
+        for (int i = 0; i < (int)variants.size(); i++) {
+            if (i != pick && DecodeIconVariant(variants[i], out)) return true;
+        }
+        return false;
+    }
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace volumedeck_mixer {
+
+    // Reads application icons straight out of PE images (.exe/.dll) and .ico
+    // files, without the shell. Walks the resource directory for
+    // RT_GROUP_ICON/RT_ICON, picks the variant that best fits the requested
+    // size and decodes it (PNG or BMP + AND mask) to straight-alpha BGRA.
+    //
+    // Pure parsing over a byte range, no OS calls besides mapping the file,
+    // so any number of threads may extract in parallel.
+
+    struct IconVariant {
+        int width = 0;
+        int height = 0;
+        int bit_count = 0;
+        const uint8_t* data = nullptr;  // PNG or BITMAPINFOHEADER + bits
+        size_t size = 0;
+    };
+
+    struct DecodedIcon {
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> bgra;  // straight alpha, top-down
+    };
+
+    // Variants of the first icon group in a PE image (the one Explorer
+    // shows). Pointers refer into `image`.
+    bool ListPeIconVariants(const uint8_t* image, size_t size, std::vector<IconVariant>& out);
+
+    // Variants of an .ico file.
+    bool ListIcoVariants(const uint8_t* data, size_t size, std::vector<IconVariant>& out);
+
+    // Smallest variant at least `size` px (deepest colour wins ties); the
+    // largest one if none is big enough. -1 for an empty list.
+    int PickIconVariant(const std::vector<IconVariant>& variants, int size);
+
+    bool DecodeIconVariant(const IconVariant& v, DecodedIcon* out);
+
+    // Maps `path` and runs the above; handles both .exe/.dll and .ico.
+    bool ExtractIconFromFile(const std::string& path, int size, DecodedIcon* out);
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,370 @@
+#include "png_decoder.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "png_encoder.h"
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        const uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+        const uint16_t kLengthBase[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,
+                                          15, 17, 19, 23, 27, 31, 35, 43, 51,  59,
+                                          67, 83, 99, 115, 131, 163, 195, 227, 258};
+        const uint8_t kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                          2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        const uint16_t kDistBase[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                        33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                        1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        const uint8_t kDistExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                        6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+        constexpr int kMaxBits = 15;
+
+        class BitReader {
+        public:
+            BitReader(const uint8_t* p, size_t n) : p_(p), n_(n) {}
+
+            // Returns -1 past the end.
+            int Bits(int count) {
+                uint32_t v = 0;
+                for (int i = 0; i < count; i++) {
+                    if (bit_ == 0) {
+                        if (pos_ >= n_) return -1;
+                        cur_ = p_[pos_++];
+                        bit_ = 8;
+                    }
+                    v |= (uint32_t)(cur_ & 1) << i;
+                    cur_ >>= 1;
+                    bit_--;
+                }
+                return (int)v;
+            }
+
+            void AlignToByte() { bit_ = 0; }
+
+            bool Bytes(size_t count, std::vector<uint8_t>& out) {
+                if (count > n_ - pos_) return false;
+                out.insert(out.end(), p_ + pos_, p_ + pos_ + count);
+                pos_ += count;
+                return true;
+            }
+
+            size_t pos() const { return pos_; }
+
+        private:
+            const uint8_t* p_;
+            size_t n_;
+            size_t pos_ = 0;
+            uint32_t cur_ = 0;
+            int bit_ = 0;
+        };
+
+        // Canonical Huffman decoding table in the style of zlib's puff.c.
+        struct Huffman {
+            uint16_t count[kMaxBits + 1];
+            uint16_t symbol[288];
+
+            bool Build(const uint8_t* lengths, int n) {
+                memset(count, 0, sizeof(count));
+                for (int s = 0; s < n; s++) count[lengths[s]]++;
+                if (count[0] == n) return true;  // no codes: valid, never used
+
+                int left = 1;
+                for (int len = 1; len <= kMaxBits; len++) {
+                    left <<= 1;
+                    left -= count[len];
+                    if (left < 0) return false;  // over-subscribed
+                }
+
+                uint16_t offs[kMaxBits + 1];
+                offs[1] = 0;
+                for (int len = 1; len < kMaxBits; len++) offs[len + 1] = (uint16_t)(offs[len] + count[len]);
+                for (int s = 0; s < n; s++) {
+                    if (lengths[s] != 0) symbol[offs[lengths[s]]++] = (uint16_t)s;
+                }
+                return true;
+            }
+
+            int Decode(BitReader& br) const {
+                int code = 0, first = 0, index = 0;
+                for (int len = 1; len <= kMaxBits; len++) {
+                    int b = br.Bits(1);
+                    if (b < 0) return -1;
+                    code |= b;
+                    int c = count[len];
+                    if (code - c < first) return symbol[index + (code - first)];
+                    index += c;
+                    first += c;
+                    first <<= 1;
+                    code <<= 1;
+                }
+                return -1;
+            }
+        };
+
+        // Every block path stops at `limit` bytes of output.
+        bool InflateCodes(BitReader& br, const Huffman& lit, const Huffman& dist,
+                          std::vector<uint8_t>& out, size_t limit) {
+            for (;;) {
+                int sym = lit.Decode(br);
+                if (sym < 0) return false;
+                if (sym < 256) {
+                    if (out.size() >= limit) return false;
+                    out.push_back((uint8_t)sym);
+                    continue;
+                }
+                if (sym == 256) return true;
+
+                sym -= 257;
+                if (sym >= 29) return false;
+                int extra = br.Bits(kLengthExtra[sym]);
+                if (extra < 0) return false;
+                const size_t len = (size_t)kLengthBase[sym] + (size_t)extra;
+
+                int ds = dist.Decode(br);
+                if (ds < 0 || ds >= 30) return false;
+                extra = br.Bits(kDistExtra[ds]);
+                if (extra < 0) return false;
+                const size_t d = (size_t)kDistBase[ds] + (size_t)extra;
+                if (d > out.size() || len > limit - out.size()) return false;
+
+                const size_t from = out.size() - d;
+                for (size_t i = 0; i < len; i++) out.push_back(out[from + i]);
+            }
+        }
+
+        bool InflateDynamic(BitReader& br, std::vector<uint8_t>& out, size_t limit) {
+            static const uint8_t kOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+            int nlen = br.Bits(5), ndist = br.Bits(5), ncode = br.Bits(4);
+            if (nlen < 0 || ndist < 0 || ncode < 0) return false;
+            nlen += 257;
+            ndist += 1;
+            ncode += 4;
+            if (nlen > 286 || ndist > 30) return false;
+
+            uint8_t lengths[320] = {};
+            for (int i = 0; i < ncode; i++) {
+                int v = br.Bits(3);
+                if (v < 0) return false;
+                lengths[kOrder[i]] = (uint8_t)v;
+            }
+            Huffman lencode;
+            if (!lencode.Build(lengths, 19)) return false;
+
+            int index = 0;
+            while (index < nlen + ndist) {
+                int sym = lencode.Decode(br);
+                if (sym < 0) return false;
+                if (sym < 16) {
+                    lengths[index++] = (uint8_t)sym;
+                    continue;
+                }
+                uint8_t len = 0;
+                int repeat;
+                if (sym == 16) {
+                    if (index == 0) return false;
+                    len = lengths[index - 1];
+                    repeat = 3 + br.Bits(2);
+                } else if (sym == 17) {
+                    repeat = 3 + br.Bits(3);
+                } else {
+                    repeat = 11 + br.Bits(7);
+                }
+                if (repeat < 3 || index + repeat > nlen + ndist) return false;
+                while (repeat--) lengths[index++] = len;
+            }
+            if (lengths[256] == 0) return false;  // no end-of-block code
+
+            Huffman lit, dist;
+            if (!lit.Build(lengths, nlen) || !dist.Build(lengths + nlen, ndist)) return false;
+            return InflateCodes(br, lit, dist, out, limit);
+        }
+
+        bool InflateFixed(BitReader& br, std::vector<uint8_t>& out, size_t limit) {
+            static const struct Tables {
+                Huffman lit, dist;
+                Tables() {
+                    uint8_t l[288];
+                    int s = 0;
+                    for (; s < 144; s++) l[s] = 8;
+                    for (; s < 256; s++) l[s] = 9;
+                    for (; s < 280; s++) l[s] = 7;
+                    for (; s < 288; s++) l[s] = 8;
+                    lit.Build(l, 288);
+                    uint8_t d[30];
+                    for (int i = 0; i < 30; i++) d[i] = 5;
+                    dist.Build(d, 30);
+                }
+            } tables;
+            return InflateCodes(br, tables.lit, tables.dist, out, limit);
+        }
+
+        uint32_t GetBE32(const uint8_t* p) {
+            return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+        }
+
+        inline uint8_t Paeth(int a, int b, int c) {
+            int p = a + b - c;
+            int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+            if (pa <= pb && pa <= pc) return (uint8_t)a;
+            if (pb <= pc) return (uint8_t)b;
+            return (uint8_t)c;
+        }
+
+    }  // namespace
+
+    bool Inflate(const uint8_t* data, size_t size, std::vector<uint8_t>& out, size_t expected_size) {
+        out.clear();
+        if (size < 6) return false;
+        const uint8_t cmf = data[0], flg = data[1];
+        if ((cmf & 0x0F) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20)) return false;
+        out.reserve(expected_size);
+        const size_t limit = expected_size ? expected_size : SIZE_MAX;
+
+        BitReader br(data + 2, size - 2);
+        for (;;) {
+            const int last = br.Bits(1);
+            const int type = br.Bits(2);
+            if (last < 0 || type < 0) return false;
+
+            bool ok;
+            if (type == 0) {
+                br.AlignToByte();
+                int lo = br.Bits(16), nlo = br.Bits(16);
+                if (lo < 0 || nlo < 0 || (lo ^ 0xFFFF) != nlo) return false;
+                ok = (size_t)lo <= limit - out.size() && br.Bytes((size_t)lo, out);
+            } else if (type == 1) {
+                ok = InflateFixed(br, out, limit);
+            } else if (type == 2) {
+                ok = InflateDynamic(br, out, limit);
+            } else {
+                ok = false;
+            }
+            if (!ok) return false;
+            if (last) break;
+        }
+
+        const size_t adler_at = 2 + br.pos();
+        if (adler_at + 4 > size) return false;
+        return GetBE32(data + adler_at) == Adler32(out.data(), out.size());
+    }
+
+    bool IsPng(const uint8_t* data, size_t size) {
+        return size >= 8 && memcmp(data, kSignature, 8) == 0;
+    }
+
+    bool DecodePngToBgra(const uint8_t* data, size_t size, int* width, int* height,
+                         std::vector<uint8_t>& bgra) {
+        if (!IsPng(data, size)) return false;
+
+        uint32_t w = 0, h = 0;
+        int color = -1;
+        uint8_t palette[256][4];
+        int palette_size = 0;
+        std::vector<uint8_t> idat;
+
+        size_t pos = 8;
+        bool ended = false;
+        while (pos + 12 <= size) {
+            const uint32_t len = GetBE32(data + pos);
+            if (len > size - pos - 12) return false;
+            const uint8_t* type = data + pos + 4;
+            const uint8_t* body = data + pos + 8;
+            if (GetBE32(body + len) != Crc32(type, len + 4)) return false;
+
+            if (memcmp(type, "IHDR", 4) == 0) {
+                if (len != 13) return false;
+                w = GetBE32(body);
+                h = GetBE32(body + 4);
+                const uint8_t depth = body[8];
+                color = body[9];
+                if (depth != 8 || body[10] != 0 || body[11] != 0 || body[12] != 0) return false;
+                if (color != 0 && color != 2 && color != 3 && color != 4 && color != 6) return false;
+            } else if (memcmp(type, "PLTE", 4) == 0) {
+                if (len % 3 != 0 || len / 3 > 256) return false;
+                palette_size = (int)(len / 3);
+                for (int i = 0; i < palette_size; i++) {
+                    palette[i][0] = body[i * 3];
+                    palette[i][1] = body[i * 3 + 1];
+                    palette[i][2] = body[i * 3 + 2];
+                    palette[i][3] = 255;
+                }
+            } else if (memcmp(type, "tRNS", 4) == 0) {
+                if (color == 3) {
+                    for (uint32_t i = 0; i < len && i < 256; i++) palette[i][3] = body[i];
+                }
+            } else if (memcmp(type, "IDAT", 4) == 0) {
+                idat.insert(idat.end(), body, body + len);
+            } else if (memcmp(type, "IEND", 4) == 0) {
+                ended = true;
+                break;
+            }
+            pos += 12 + len;
+        }
+        if (!ended || color < 0 || w == 0 || h == 0 || w > 4096 || h > 4096) return false;
+        if (color == 3 && palette_size == 0) return false;
+
+        static const int kChannels[7] = {1, 0, 3, 1, 2, 0, 4};
+        const size_t bpp = (size_t)kChannels[color];
+        const size_t stride = (size_t)w * bpp;
+
+        std::vector<uint8_t> raw;
+        if (!Inflate(idat.data(), idat.size(), raw, (stride + 1) * h)) return false;
+        if (raw.size() != (stride + 1) * h) return false;
+
+        // Unfilter in place; each row's filter byte precedes it.
+        for (uint32_t y = 0; y < h; y++) {
+            uint8_t* row = &raw[y * (stride + 1) + 1];
+            const uint8_t* up = y > 0 ? row - (stride + 1) : nullptr;
+            const uint8_t filter = row[-1];
+            for (size_t x = 0; x < stride; x++) {
+                const int a = x >= bpp ? row[x - bpp] : 0;
+                const int b = up ? up[x] : 0;
+                const int c = (up && x >= bpp) ? up[x - bpp] : 0;
+                switch (filter) {
+                    case 0: break;
+                    case 1: row[x] = (uint8_t)(row[x] + a); break;
+                    case 2: row[x] = (uint8_t)(row[x] + b); break;
+                    case 3: row[x] = (uint8_t)(row[x] + (a + b) / 2); break;
+                    case 4: row[x] = (uint8_t)(row[x] + Paeth(a, b, c)); break;
+                    default: return false;
+                }
+            }
+        }
+
+        bgra.resize((size_t)w * h * 4);
+        for (uint32_t y = 0; y < h; y++) {
+            const uint8_t* row = &raw[y * (stride + 1) + 1];
+            uint8_t* dst = &bgra[(size_t)y * w * 4];
+            for (uint32_t x = 0; x < w; x++, dst += 4) {
+                uint8_t r, g, b, a = 255;
+                switch (color) {
+                    case 0: r = g = b = row[x]; break;
+                    case 2: r = row[x * 3]; g = row[x * 3 + 1]; b = row[x * 3 + 2]; break;
+                    case 3: {
+                        const uint8_t i = row[x];
+                        if (i >= palette_size) return false;
+                        r = palette[i][0]; g = palette[i][1]; b = palette[i][2]; a = palette[i][3];
+                        break;
+                    }
+                    case 4: r = g = b = row[x * 2]; a = row[x * 2 + 1]; break;
+                    default: r = row[x * 4]; g = row[x * 4 + 1]; b = row[x * 4 + 2]; a = row[x * 4 + 3]; break;
+                }
+                dst[0] = b;
+                dst[1] = g;
+                dst[2] = r;
+                dst[3] = a;
+            }
+        }
+
+        *width = (int)w;
+        *height = (int)h;
+        return true;
+    }
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace volumedeck_mixer {
+
+    // zlib stream (RFC 1950/1951) -> bytes. `expected_size` (0: unknown) is
+    // reserved up front and is also a cap: a stream that would inflate past
+    // it fails there, before the rest is decoded. Returns false on malformed
+    // input or a bad Adler-32.
+    bool Inflate(const uint8_t* data, size_t size, std::vector<uint8_t>& out,
+                 size_t expected_size = 0);
+
+    // Minimal PNG reader for icon payloads embedded in .exe/.ico files:
+    // 8-bit grey, grey+alpha, RGB, RGBA and palette (with tRNS), not
+    // interlaced. Output is straight-alpha BGRA, the same layout as a DIB.
+    bool DecodePngToBgra(const uint8_t* data, size_t size, int* width, int* height,
+                         std::vector<uint8_t>& bgra);
+
+    bool IsPng(const uint8_t* data, size_t size);
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,376 @@
+#include "png_encoder.h"
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+
+#include "simd.h"
+
+namespace volumedeck_mixer {
+
+    // ---------- checksums ----------
+
+    static const std::array<uint32_t, 256>& CrcTable() {
+        static const std::array<uint32_t, 256> table = [] {
+            std::array<uint32_t, 256> t{};
+            for (uint32_t n = 0; n < 256; n++) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[n] = c;
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc) {
+        const auto& t = CrcTable();
+        uint32_t c = crc ^ 0xFFFFFFFFu;
+        for (size_t i = 0; i < size; i++) c = t[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+        return c ^ 0xFFFFFFFFu;
+    }
+
+    uint32_t Adler32(const uint8_t* data, size_t size, uint32_t adler) {
+        uint32_t a = adler & 0xFFFF, b = adler >> 16;
+        while (size > 0) {
+            size_t n = size < 5552 ? size : 5552;  // largest n without overflow
+            size -= n;
+            while (n--) {
+                a += *data++;
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+        }
+        return (b << 16) | a;
+    }
+
+    // ---------- swizzle ----------
+
+    void SwizzleBgraRgba(const uint8_t* src, uint8_t* dst, size_t pixel_count) {
+        size_t i = 0;
+#if defined(VOLUMEDECK_SSE2)
+        const __m128i ag_mask = _mm_set1_epi32((int)0xFF00FF00u);
+        const __m128i rb_mask = _mm_set1_epi32(0x00FF00FF);
+        for (; i + 4 <= pixel_count; i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+            __m128i ag = _mm_and_si128(v, ag_mask);
+            __m128i rb = _mm_and_si128(v, rb_mask);
+            rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(ag, rb));
+        }
+#elif defined(VOLUMEDECK_NEON)
+        for (; i + 16 <= pixel_count; i += 16) {
+            uint8x16x4_t v = vld4q_u8(src + i * 4);
+            uint8x16_t t = v.val[0];
+            v.val[0] = v.val[2];
+            v.val[2] = t;
+            vst4q_u8(dst + i * 4, v);
+        }
+#endif
+        for (; i < pixel_count; i++) {
+            const uint8_t b = src[i * 4], g = src[i * 4 + 1], r = src[i * 4 + 2], a = src[i * 4 + 3];
+            dst[i * 4] = r;
+            dst[i * 4 + 1] = g;
+            dst[i * 4 + 2] = b;
+            dst[i * 4 + 3] = a;
+        }
+    }
+
+    // ---------- deflate (fixed Huffman) ----------
+
+    namespace {
+
+        const uint16_t kLengthBase[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,
+                                          15, 17, 19, 23, 27, 31, 35, 43, 51,  59,
+                                          67, 83, 99, 115, 131, 163, 195, 227, 258};
+        const uint8_t kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                          2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        const uint16_t kDistBase[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                        33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                        1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        const uint8_t kDistExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                        6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+        constexpr size_t kWindow = 32768;
+        constexpr int kHashBits = 15;
+        constexpr int kMinMatch = 3;
+        constexpr int kMaxMatch = 258;
+
+        uint32_t Reverse(uint32_t code, int len) {
+            uint32_t r = 0;
+            for (int i = 0; i < len; i++) {
+                r = (r << 1) | (code & 1);
+                code >>= 1;
+            }
+            return r;
+        }
+
+        // Fixed-code tables, bit-reversed for an LSB-first writer.
+        struct FixedCodes {
+            uint16_t lit_code[288];
+            uint8_t lit_len[288];
+            uint8_t dist_code[30];
+            uint8_t length_symbol[kMaxMatch + 1];  // match length -> index into kLengthBase
+
+            FixedCodes() {
+                for (int v = 0; v < 288; v++) {
+                    uint32_t code;
+                    int len;
+                    if (v < 144) { code = 0x30 + v; len = 8; }
+                    else if (v < 256) { code = 0x190 + (v - 144); len = 9; }
+                    else if (v < 280) { code = v - 256; len = 7; }
+                    else { code = 0xC0 + (v - 280); len = 8; }
+                    lit_code[v] = (uint16_t)Reverse(code, len);
+                    lit_len[v] = (uint8_t)len;
+                }
+                for (int d = 0; d < 30; d++) dist_code[d] = (uint8_t)Reverse((uint32_t)d, 5);
+                int sym = 0;
+                for (int l = kMinMatch; l <= kMaxMatch; l++) {
+                    while (sym < 28 && kLengthBase[sym + 1] <= l) sym++;
+                    length_symbol[l] = (uint8_t)sym;
+                }
+                length_symbol[0] = length_symbol[1] = length_symbol[2] = 0;
+            }
+        };
+
+        const FixedCodes& Codes() {
+            static const FixedCodes codes;
+            return codes;
+        }
+
+        int DistSymbol(uint32_t dist) {
+            int lo = 0, hi = 29;
+            while (lo < hi) {
+                int mid = (lo + hi + 1) / 2;
+                if (kDistBase[mid] <= dist) lo = mid; else hi = mid - 1;
+            }
+            return lo;
+        }
+
+        class BitWriter {
+        public:
+            explicit BitWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+            void Put(uint32_t bits, int count) {
+                acc_ |= (uint64_t)bits << n_;
+                n_ += count;
+                while (n_ >= 8) {
+                    out_.push_back((uint8_t)acc_);
+                    acc_ >>= 8;
+                    n_ -= 8;
+                }
+            }
+
+            void Flush() {
+                if (n_ > 0) out_.push_back((uint8_t)acc_);
+                acc_ = 0;
+                n_ = 0;
+            }
+
+        private:
+            std::vector<uint8_t>& out_;
+            uint64_t acc_ = 0;
+            int n_ = 0;
+        };
+
+        inline uint32_t Hash3(const uint8_t* p) {
+            uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+            return (v * 2654435761u) >> (32 - kHashBits);
+        }
+
+        inline uint8_t Paeth(int a, int b, int c) {
+            int p = a + b - c;
+            int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+            if (pa <= pb && pa <= pc) return (uint8_t)a;
+            if (pb <= pc) return (uint8_t)b;
+            return (uint8_t)c;
+        }
+
+        void PutBE32(std::vector<uint8_t>& out, uint32_t v) {
+            out.push_back((uint8_t)(v >> 24));
+            out.push_back((uint8_t)(v >> 16));
+            out.push_back((uint8_t)(v >> 8));
+            out.push_back((uint8_t)v);
+        }
+
+        size_t BeginChunk(std::vector<uint8_t>& out, const char type[4]) {
+            PutBE32(out, 0);  // patched by EndChunk
+            const size_t start = out.size();
+            out.insert(out.end(), type, type + 4);
+            return start;
+        }
+
+        void EndChunk(std::vector<uint8_t>& out, size_t start) {
+            const uint32_t len = (uint32_t)(out.size() - start - 4);
+            out[start - 4] = (uint8_t)(len >> 24);
+            out[start - 3] = (uint8_t)(len >> 16);
+            out[start - 2] = (uint8_t)(len >> 8);
+            out[start - 1] = (uint8_t)len;
+            PutBE32(out, Crc32(out.data() + start, out.size() - start));
+        }
+
+    }  // namespace
+
+    void PngEncoder::DeflateStored(const uint8_t* data, size_t size) {
+        size_t pos = 0;
+        do {
+            const size_t n = (size - pos) > 0xFFFF ? 0xFFFF : size - pos;
+            const bool last = pos + n == size;
+            out_.push_back(last ? 1 : 0);  // BFINAL, BTYPE=00, byte aligned
+            out_.push_back((uint8_t)n);
+            out_.push_back((uint8_t)(n >> 8));
+            out_.push_back((uint8_t)~n);
+            out_.push_back((uint8_t)(~n >> 8));
+            out_.insert(out_.end(), data + pos, data + pos + n);
+            pos += n;
+        } while (pos < size);
+    }
+
+    void PngEncoder::DeflateFixed(const uint8_t* data, size_t size) {
+        const FixedCodes& c = Codes();
+        head_.assign((size_t)1 << kHashBits, 0);
+
+        BitWriter bw(out_);
+        bw.Put(1, 1);  // BFINAL
+        bw.Put(1, 2);  // BTYPE=01, fixed Huffman
+
+        auto literal = [&](uint8_t v) { bw.Put(c.lit_code[v], c.lit_len[v]); };
+
+        size_t i = 0;
+        while (i < size) {
+            int best = 0;
+            size_t dist = 0;
+            if (i + kMinMatch <= size) {
+                const uint32_t h = Hash3(data + i);
+                const uint32_t cand = head_[h];
+                head_[h] = (uint32_t)(i + 1);
+                if (cand != 0 && i - (cand - 1) <= kWindow) {
+                    const size_t from = cand - 1;
+                    const size_t limit = (size - i) < (size_t)kMaxMatch ? size - i : (size_t)kMaxMatch;
+                    size_t len = 0;
+                    while (len < limit && data[from + len] == data[i + len]) len++;
+                    if (len >= (size_t)kMinMatch) {
+                        best = (int)len;
+                        dist = i - from;
+                    }
+                }
+            }
+
+            if (best == 0) {
+                literal(data[i]);
+                i++;
+                continue;
+            }
+
+            const int ls = c.length_symbol[best];
+            const int lsym = 257 + ls;
+            bw.Put(c.lit_code[lsym], c.lit_len[lsym]);
+            if (kLengthExtra[ls]) bw.Put((uint32_t)(best - kLengthBase[ls]), kLengthExtra[ls]);
+
+            const int ds = DistSymbol((uint32_t)dist);
+            bw.Put(c.dist_code[ds], 5);
+            if (kDistExtra[ds]) bw.Put((uint32_t)(dist - kDistBase[ds]), kDistExtra[ds]);
+
+            // Index the positions we skip so later rows can still refer to them.
+            const size_t end = i + (size_t)best;
+            for (i++; i < end; i++) {
+                if (i + kMinMatch <= size) head_[Hash3(data + i)] = (uint32_t)(i + 1);
+            }
+        }
+
+        bw.Put(c.lit_code[256], c.lit_len[256]);  // end of block
+        bw.Flush();
+    }
+
+    // Per row, pick the filter with the smallest sum of |signed residual|
+    // (the usual libpng heuristic), considering None, Sub, Up and Paeth.
+    void PngEncoder::FilterRows(int width, int height) {
+        const size_t stride = (size_t)width * 4;
+        filtered_.resize((stride + 1) * (size_t)height);
+
+        scratch_.resize(stride * 4);
+        uint8_t* cand[4] = {&scratch_[0], &scratch_[stride], &scratch_[stride * 2], &scratch_[stride * 3]};
+
+        for (int y = 0; y < height; y++) {
+            const uint8_t* row = &rgba_[(size_t)y * stride];
+            const uint8_t* up = y > 0 ? row - stride : nullptr;
+            uint8_t* dst = &filtered_[(size_t)y * (stride + 1)];
+
+            uint32_t cost[4] = {0, 0, 0, 0};
+            for (size_t x = 0; x < stride; x++) {
+                const int a = x >= 4 ? row[x - 4] : 0;
+                const int b = up ? up[x] : 0;
+                const int cc = (up && x >= 4) ? up[x - 4] : 0;
+                const uint8_t v[4] = {row[x], (uint8_t)(row[x] - a), (uint8_t)(row[x] - b),
+                                      (uint8_t)(row[x] - Paeth(a, b, cc))};
+                for (int f = 0; f < 4; f++) {
+                    cand[f][x] = v[f];
+                    cost[f] += (uint32_t)std::abs((int)(int8_t)v[f]);
+                }
+            }
+
+            int best = 0;
+            for (int f = 1; f < 4; f++) {
+                if (cost[f] < cost[best]) best = f;
+            }
+            static const uint8_t kFilterType[4] = {0, 1, 2, 4};
+            dst[0] = kFilterType[best];
+            memcpy(dst + 1, cand[best], stride);
+        }
+    }
+
+    bool PngEncoder::EncodeBgra(const uint8_t* bgra, int width, int height, size_t stride) {
+        return Encode(bgra, width, height, stride, true);
+    }
+
+    bool PngEncoder::EncodeRgba(const uint8_t* rgba, int width, int height, size_t stride) {
+        return Encode(rgba, width, height, stride, false);
+    }
+
+    bool PngEncoder::Encode(const uint8_t* pixels, int width, int height, size_t stride,
+                            bool swizzle) {
+        out_.clear();
+        if (!pixels || width <= 0 || height <= 0 || width > 0x4000 || height > 0x4000) return false;
+
+        const size_t row_bytes = (size_t)width * 4;
+        if (stride < row_bytes) return false;
+
+        rgba_.resize(row_bytes * (size_t)height);
+        for (int y = 0; y < height; y++) {
+            const uint8_t* src = pixels + (size_t)y * stride;
+            uint8_t* dst = &rgba_[(size_t)y * row_bytes];
+            if (swizzle) SwizzleBgraRgba(src, dst, (size_t)width);
+            else memcpy(dst, src, row_bytes);
+        }
+
+        FilterRows(width, height);
+
+        static const uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+        out_.reserve(filtered_.size() + filtered_.size() / 64 + 128);
+        out_.insert(out_.end(), kSignature, kSignature + 8);
+
+        size_t chunk = BeginChunk(out_, "IHDR");
+        PutBE32(out_, (uint32_t)width);
+        PutBE32(out_, (uint32_t)height);
+        out_.push_back(8);  // bit depth
+        out_.push_back(6);  // RGBA
+        out_.push_back(0);  // deflate
+        out_.push_back(0);  // adaptive filtering
+        out_.push_back(0);  // no interlace
+        EndChunk(out_, chunk);
+
+        chunk = BeginChunk(out_, "IDAT");
+        out_.push_back(0x78);  // deflate, 32K window
+        out_.push_back(0x01);  // fastest, check bits
+        if (mode_ == Deflate::kStored) DeflateStored(filtered_.data(), filtered_.size());
+        else DeflateFixed(filtered_.data(), filtered_.size());
+        PutBE32(out_, Adler32(filtered_.data(), filtered_.size()));
+        EndChunk(out_, chunk);
+
+        chunk = BeginChunk(out_, "IEND");
+        EndChunk(out_, chunk);
+        return true;
+    }
+
+}  // namespace volumedeck_mixer
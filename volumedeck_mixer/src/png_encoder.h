@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace volumedeck_mixer {
+
+    // Self-contained PNG writer for small icons (16..64 px, 8-bit RGBA).
+    //
+    // No COM, no zlib: the BGRA input is swizzled to RGBA (SIMD where
+    // available), each row gets a cheaply chosen filter, and the result is
+    // deflated with a single-probe LZ77 and the fixed Huffman code. All
+    // buffers belong to the encoder and are reused between calls, so keep one
+    // per thread.
+    class PngEncoder {
+    public:
+        enum class Deflate {
+            kFixedHuffman,  // greedy LZ77 + fixed codes; ~zlib -1 size, much faster
+            kStored,        // no compression at all; fastest, biggest
+        };
+
+        explicit PngEncoder(Deflate mode = Deflate::kFixedHuffman) : mode_(mode) {}
+
+        // `bgra` is straight (non-premultiplied) alpha, `stride` bytes per
+        // row. Returns false for empty or oversized images. The PNG stays
+        // valid until the next call.
+        bool EncodeBgra(const uint8_t* bgra, int width, int height, size_t stride);
+        bool EncodeRgba(const uint8_t* rgba, int width, int height, size_t stride);
+
+        const std::vector<uint8_t>& png() const { return out_; }
+
+    private:
+        bool Encode(const uint8_t* pixels, int width, int height, size_t stride, bool swizzle);
+        void FilterRows(int width, int height);
+        void DeflateFixed(const uint8_t* data, size_t size);
+        void DeflateStored(const uint8_t* data, size_t size);
+
+        Deflate mode_;
+        std::vector<uint8_t> rgba_;      // swizzled rows
+        std::vector<uint8_t> filtered_;  // filter byte + row, per row
+        std::vector<uint8_t> scratch_;   // candidate rows for the filter choice
+        std::vector<uint32_t> head_;     // LZ77 hash -> last position + 1
+        std::vector<uint8_t> out_;
+    };
+
+    // Byte-order conversion used by the encoder: BGRA <-> RGBA (the same
+    // swap both ways). `src` and `dst` may alias.
+    void SwizzleBgraRgba(const uint8_t* src, uint8_t* dst, size_t pixel_count);
+
+    uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+    uint32_t Adler32(const uint8_t* data, size_t size, uint32_t adler = 1);
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,325 @@
+#include "process_supervisor.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include "file_util.h"
+#else
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include <algorithm>
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        uint64_t ElapsedUs(Clock::time_point since) {
+            return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - since).count();
+        }
+
+#ifdef _WIN32
+        // One argument as CommandLineToArgvW will split it back out.
+        std::wstring QuoteArg(const std::wstring& arg) {
+            if (!arg.empty() && arg.find_first_of(L" \t\n\v\"") == std::wstring::npos) return arg;
+            std::wstring out = L"\"";
+            size_t slashes = 0;
+            for (wchar_t c : arg) {
+                if (c == L'\\') {
+                    slashes++;
+                    continue;
+                }
+                // Backslashes only escape when a quote follows.
+                out.append(c == L'"' ? slashes * 2 + 1 : slashes, L'\\');
+                slashes = 0;
+                out.push_back(c);
+            }
+            out.append(slashes * 2, L'\\');
+            out.push_back(L'"');
+            return out;
+        }
+#endif
+
+    }  // namespace
+
+    ProcessSupervisor::ProcessSupervisor(SupervisorOptions options) : options_(std::move(options)) {}
+
+    ProcessSupervisor::~ProcessSupervisor() { Stop(); }
+
+    SupervisorStats ProcessSupervisor::stats() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        SupervisorStats s = stats_;
+        if (s.running) s.uptime_ms = ElapsedUs(started_at_) / 1000;
+        return s;
+    }
+
+    bool ProcessSupervisor::Start(std::string* error) {
+        if (thread_.joinable()) return true;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stop_ = false;
+            restart_ = false;
+            stats_.backoff_ms = (uint64_t)options_.min_backoff.count();
+        }
+        if (!Spawn(error)) {
+            std::lock_guard<std::mutex> lock(mu_);
+            stats_.spawn_failures++;
+            return false;
+        }
+        thread_ = std::thread([this] { ThreadLoop(); });
+        return true;
+    }
+
+    void ProcessSupervisor::Stop() {
+        {
+            std::unique_lock<std::mutex> lock(mu_);
+            if (!thread_.joinable()) return;
+            stop_ = true;
+            if (stats_.running) EndChildLocked(lock);
+            cv_.notify_all();
+        }
+        thread_.join();
+    }
+
+    void ProcessSupervisor::Restart() {
+        std::unique_lock<std::mutex> lock(mu_);
+        if (!thread_.joinable() || stop_) return;
+        restart_ = true;
+        restart_at_ = Clock::now();
+        if (stats_.running) {
+            EndChildLocked(lock);
+        } else {
+            cv_.notify_all();  // cut a crash backoff short
+        }
+    }
+
+    void ProcessSupervisor::EndChildLocked(std::unique_lock<std::mutex>& lock) {
+        const uint64_t exits = exits_;
+        auto gone = [&] { return exits_ != exits; };
+        requested_ = true;
+        SignalLocked(false);
+        if (!cv_.wait_for(lock, options_.kill_timeout, gone)) {
+            SignalLocked(true);
+            cv_.wait(lock, gone);
+        }
+    }
+
+    void ProcessSupervisor::ThreadLoop() {
+        if (observer_) observer_(stats());
+        for (;;) {
+            const int code = WaitForExit();
+
+            std::unique_lock<std::mutex> lock(mu_);
+            const uint64_t uptime_ms = ElapsedUs(started_at_) / 1000;
+            stats_.running = false;
+            stats_.pid = 0;
+            stats_.uptime_ms = 0;
+            stats_.last_exit_code = code;
+            stats_.last_uptime_ms = uptime_ms;
+            const bool asked = requested_;
+            requested_ = false;
+            if (!asked) {
+                stats_.crashes++;
+                stats_.backoff_ms = uptime_ms >= (uint64_t)options_.stable_after.count()
+                                            ? (uint64_t)options_.min_backoff.count()
+                                            : std::min<uint64_t>(stats_.backoff_ms * 2,
+                                                                 (uint64_t)options_.max_backoff.count());
+            }
+            exits_++;
+            cv_.notify_all();
+            if (observer_) {
+                const SupervisorStats snapshot = stats_;
+                lock.unlock();
+                observer_(snapshot);
+                lock.lock();
+            }
+
+            // A crash waits out the backoff, unless a restart is requested.
+            bool wait = !asked;
+            for (;;) {
+                if (wait) {
+                    cv_.wait_for(lock, std::chrono::milliseconds(stats_.backoff_ms),
+                                 [&] { return stop_ || restart_; });
+                }
+                if (stop_) return;
+                restart_ = false;
+                lock.unlock();
+                std::string error;
+                const bool ok = Spawn(&error);
+                lock.lock();
+                if (ok) break;
+                stats_.spawn_failures++;
+                stats_.backoff_ms =
+                        std::min<uint64_t>(stats_.backoff_ms * 2, (uint64_t)options_.max_backoff.count());
+                wait = true;
+            }
+            if (observer_) {
+                const SupervisorStats snapshot = stats_;
+                lock.unlock();
+                observer_(snapshot);
+            }
+        }
+    }
+
+#ifdef _WIN32
+
+    bool ProcessSupervisor::Spawn(std::string* error) {
+        std::wstring cmd = QuoteArg(Utf8ToWide(options_.program));
+        for (const std::string& a : options_.args) cmd += L" " + QuoteArg(Utf8ToWide(a));
+        const std::wstring dir = Utf8ToWide(options_.working_dir);
+
+        STARTUPINFOW si{};
+        si.cb = sizeof(si);
+        PROCESS_INFORMATION pi{};
+        const auto t0 = Clock::now();
+        if (!CreateProcessW(nullptr, cmd.data(), nullptr, nullptr, FALSE, 0, nullptr,
+                            dir.empty() ? nullptr : dir.c_str(), &si, &pi)) {
+            if (error) *error = "cannot run " + options_.program + " (error " + std::to_string(GetLastError()) + ")";
+            return false;
+        }
+        CloseHandle(pi.hThread);
+
+        std::lock_guard<std::mutex> lock(mu_);
+        process_ = pi.hProcess;
+        started_at_ = Clock::now();
+        stats_.running = true;
+        stats_.pid = pi.dwProcessId;
+        stats_.starts++;
+        stats_.last_startup_us = ElapsedUs(t0);
+        if (restart_at_ != Clock::time_point{}) {
+            stats_.last_restart_us = ElapsedUs(restart_at_);
+            restart_at_ = {};
+        }
+        // Stop() came in while we were spawning.
+        if (stop_) {
+            requested_ = true;
+            SignalLocked(true);
+        }
+        return true;
+    }
+
+    int ProcessSupervisor::WaitForExit() {
+        HANDLE h = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            h = process_;
+        }
+        WaitForSingleObject(h, INFINITE);
+        DWORD code = 0;
+        GetExitCodeProcess(h, &code);
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            process_ = nullptr;
+        }
+        CloseHandle(h);
+        return (int)code;
+    }
+
+    void ProcessSupervisor::SignalLocked(bool /*force*/) {
+        // No polite way to end a windowless GUI process: terminate it.
+        if (process_) TerminateProcess(process_, 1);
+    }
+
+#else
+
+    bool ProcessSupervisor::Spawn(std::string* error) {
+        // Everything the child needs is built before fork(): only
+        // async-signal-safe calls between fork() and exec.
+        std::vector<char*> argv;
+        argv.push_back(const_cast<char*>(options_.program.c_str()));
+        for (const std::string& a : options_.args) argv.push_back(const_cast<char*>(a.c_str()));
+        argv.push_back(nullptr);
+        const char* dir = options_.working_dir.empty() ? nullptr : options_.working_dir.c_str();
+
+        // The child reports a failed exec through this pipe; a successful
+        // one closes it (CLOEXEC), which is when the child is running.
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC) != 0) {
+            if (error) *error = std::string("pipe: ") + strerror(errno);
+            return false;
+        }
+        const auto t0 = Clock::now();
+        const pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            if (!dir || chdir(dir) == 0) execvp(argv[0], argv.data());
+            const int e = errno;
+            const ssize_t n = write(fds[1], &e, sizeof(e));
+            (void)n;
+            _exit(127);
+        }
+        close(fds[1]);
+        if (pid < 0) {
+            close(fds[0]);
+            if (error) *error = std::string("fork: ") + strerror(errno);
+            return false;
+        }
+        int child_errno = 0;
+        ssize_t n;
+        do {
+            n = read(fds[0], &child_errno, sizeof(child_errno));
+        } while (n < 0 && errno == EINTR);
+        close(fds[0]);
+        if (n > 0) {
+            waitpid(pid, nullptr, 0);
+            if (error) *error = "cannot run " + options_.program + ": " + strerror(child_errno);
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mu_);
+        pid_ = pid;
+        started_at_ = Clock::now();
+        stats_.running = true;
+        stats_.pid = (uint32_t)pid;
+        stats_.starts++;
+        stats_.last_startup_us = ElapsedUs(t0);
+        if (restart_at_ != Clock::time_point{}) {
+            stats_.last_restart_us = ElapsedUs(restart_at_);
+            restart_at_ = {};
+        }
+        // Stop() came in while we were spawning.
+        if (stop_) {
+            requested_ = true;
+            SignalLocked(true);
+        }
+        return true;
+    }
+
+    int ProcessSupervisor::WaitForExit() {
+        pid_t pid = 0;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            pid = pid_;
+        }
+        // Wait without reaping, so the pid can't be reused (and signalled
+        // by mistake) until pid_ is cleared.
+        siginfo_t info{};
+        while (waitid(P_PID, (id_t)pid, &info, WEXITED | WNOWAIT) != 0 && errno == EINTR) {
+        }
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            pid_ = 0;
+        }
+        int status = 0;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        if (WIFEXITED(status)) return WEXITSTATUS(status);
+        if (WIFSIGNALED(status)) return -WTERMSIG(status);
+        return 0;
+    }
+
+    void ProcessSupervisor::SignalLocked(bool force) {
+        if (pid_ > 0) kill(pid_, force ? SIGKILL : SIGTERM);
+    }
+
+#endif
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace volumedeck_mixer {
+
+    struct SupervisorOptions {
+        std::string program;            // path, or a name looked up in PATH (POSIX)
+        std::vector<std::string> args;  // not including the program
+        std::string working_dir;        // empty: inherit
+        // Crash restarts wait min_backoff, doubling up to max_backoff; a run
+        // that lasted stable_after starts over at min_backoff.
+        std::chrono::milliseconds min_backoff{100};
+        std::chrono::milliseconds max_backoff{10000};
+        std::chrono::milliseconds stable_after{10000};
+        // Stop()/Restart() ask politely first where the platform can
+        // (SIGTERM), then kill. deej on Windows has no polite way.
+        std::chrono::milliseconds kill_timeout{2000};
+    };
+
+    struct SupervisorStats {
+        bool running = false;
+        uint32_t pid = 0;
+        uint64_t starts = 0;
+        uint64_t crashes = 0;          // exits nobody asked for
+        uint64_t spawn_failures = 0;   // program missing, not executable, ...
+        int last_exit_code = 0;        // negative: killed by that signal (POSIX)
+        uint64_t last_startup_us = 0;  // spawn call until the child is running
+        uint64_t last_restart_us = 0;  // Restart() until the new child is running
+        uint64_t uptime_ms = 0;        // current child; 0 when not running
+        uint64_t last_uptime_ms = 0;   // the child before it
+        uint64_t backoff_ms = 0;       // wait before the next crash restart
+    };
+
+    // Runs one child process (deej.exe) and keeps it running: waits on the
+    // child itself rather than polling or sleeping, restarts it with
+    // exponential backoff when it exits on its own, and restarts it on
+    // request as soon as the old one is really gone. Only its own child is
+    // ever signalled, never other instances of the same program.
+    class ProcessSupervisor {
+    public:
+        // On the supervisor thread, after every start and every exit.
+        using Observer = std::function<void(const SupervisorStats& stats)>;
+
+        explicit ProcessSupervisor(SupervisorOptions options);
+        ~ProcessSupervisor();
+
+        ProcessSupervisor(const ProcessSupervisor&) = delete;
+        ProcessSupervisor& operator=(const ProcessSupervisor&) = delete;
+
+        void SetObserver(Observer observer) { observer_ = std::move(observer); }
+
+        // Starts the child and the supervisor thread. False if the first
+        // spawn fails (`error` says why); nothing is left running then.
+        bool Start(std::string* error = nullptr);
+        // Ends the child and stops supervising.
+        void Stop();
+        // Ends the child and starts it again at once (no backoff), e.g.
+        // after its config changed. Returns when the old child is gone; the
+        // new one is started on the supervisor thread.
+        void Restart();
+
+        SupervisorStats stats() const;
+        const SupervisorOptions& options() const { return options_; }
+
+    private:
+        // Called without mu_; records the child under it.
+        bool Spawn(std::string* error);
+        // Blocks on the child until it exits; returns its exit code.
+        int WaitForExit();
+        // mu_ held. Asks the child to exit, or kills it.
+        void SignalLocked(bool force);
+        // mu_ held via `lock`. Returns once the child is gone.
+        void EndChildLocked(std::unique_lock<std::mutex>& lock);
+        void ThreadLoop();
+
+        const SupervisorOptions options_;
+        Observer observer_;
+
+        mutable std::mutex mu_;
+        std::condition_variable cv_;
+        bool stop_ = false;
+        bool restart_ = false;     // Restart() pending
+        bool requested_ = false;   // the current child was asked to exit
+        uint64_t exits_ = 0;
+        std::chrono::steady_clock::time_point restart_at_{};
+        std::chrono::steady_clock::time_point started_at_{};
+        SupervisorStats stats_;
+
+        std::thread thread_;
+#ifdef _WIN32
+        void* process_ = nullptr;  // HANDLE, owned
+#else
+        int pid_ = 0;
+#endif
+    };
+
+}  // namespace volumedeck_mixer
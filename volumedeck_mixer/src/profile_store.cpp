@@ -0,0 +1,72 @@
+#include "profile_store.h"
+
+namespace volumedeck_mixer {
+
+    ProfileStore::ProfileStore() : set_(std::make_shared<const DeckProfileSet>()) {}
+
+    std::shared_ptr<const DeckProfileSet> ProfileStore::Load() const { return std::atomic_load(&set_); }
+
+    void ProfileStore::Publish(std::shared_ptr<DeckProfileSet> next) {
+        next->version = version_.load(std::memory_order_relaxed) + 1;
+        std::atomic_store(&set_, std::shared_ptr<const DeckProfileSet>(std::move(next)));
+        // After the swap: whoever sees the new version loads the new set.
+        version_.fetch_add(1, std::memory_order_release);
+    }
+
+    void ProfileStore::Put(const std::string& name, const DeejConfig& config) {
+        // Compile before taking the lock; switching never waits on this.
+        auto profile = std::make_shared<DeckProfile>();
+        profile->name = name;
+        profile->config = config;
+        profile->plan = std::make_shared<const SliderPlan>(config);
+
+        std::lock_guard<std::mutex> lock(mu_);
+        auto next = std::make_shared<DeckProfileSet>(*set_);
+        bool replaced = false;
+        for (auto& p : next->profiles) {
+            if (p->name != name) continue;
+            p = profile;
+            replaced = true;
+        }
+        if (!replaced) next->profiles.push_back(profile);
+        Publish(std::move(next));
+    }
+
+    bool ProfileStore::Remove(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto next = std::make_shared<DeckProfileSet>(*set_);
+        for (size_t i = 0; i < next->profiles.size(); i++) {
+            if (next->profiles[i]->name != name) continue;
+            if (i == next->active) return false;
+            next->profiles.erase(next->profiles.begin() + (ptrdiff_t)i);
+            if (i < next->active) next->active--;
+            Publish(std::move(next));
+            return true;
+        }
+        return false;
+    }
+
+    bool ProfileStore::Select(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mu_);
+        for (size_t i = 0; i < set_->profiles.size(); i++) {
+            if (set_->profiles[i]->name != name) continue;
+            if (i == set_->active) return true;
+            auto next = std::make_shared<DeckProfileSet>(*set_);
+            next->active = i;
+            Publish(std::move(next));
+            return true;
+        }
+        return false;
+    }
+
+    std::string ProfileStore::SelectNext() {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (set_->profiles.empty()) return "";
+        auto next = std::make_shared<DeckProfileSet>(*set_);
+        next->active = (next->active + 1) % next->profiles.size();
+        const std::string name = next->profiles[next->active]->name;
+        Publish(std::move(next));
+        return name;
+    }
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "deej_config.h"
+#include "slider_mapper.h"
+
+namespace volumedeck_mixer {
+
+    // A named deej config ("Streaming", "Gaming", ...) with its mapping
+    // compiled when it was stored, not when it is switched to.
+    struct DeckProfile {
+        std::string name;
+        DeejConfig config;
+        std::shared_ptr<const SliderPlan> plan;
+    };
+
+    // One immutable state of the store. Readers hold on to it as long as
+    // they like; writers publish a new one.
+    struct DeckProfileSet {
+        std::vector<std::shared_ptr<const DeckProfile>> profiles;
+        size_t active = 0;
+        uint64_t version = 0;
+
+        // Null while the store is empty.
+        const DeckProfile* active_profile() const {
+            return active < profiles.size() ? profiles[active].get() : nullptr;
+        }
+    };
+
+    // Profiles for the deck engine, switched without restarting anything:
+    // every change publishes a new DeckProfileSet by pointer swap, and the
+    // engine picks it up between two board lines (see
+    // DeckEngine::SetProfileStore). Any thread may switch, e.g. a hardware
+    // button, a hotkey or the API; the engine only reads.
+    class ProfileStore {
+    public:
+        ProfileStore();
+
+        // Compiles `config` and adds it, or replaces the profile of that
+        // name. The first profile added becomes active.
+        void Put(const std::string& name, const DeejConfig& config);
+        // The active profile can't be removed.
+        bool Remove(const std::string& name);
+
+        bool Select(const std::string& name);
+        // Cycles through the profiles in the order they were added; returns
+        // the new active name, "" when empty.
+        std::string SelectNext();
+
+        std::shared_ptr<const DeckProfileSet> Load() const;
+        // Bumped by every publish; cheap enough to poll every frame.
+        uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+    private:
+        // Called with mu_ held.
+        void Publish(std::shared_ptr<DeckProfileSet> next);
+
+        std::mutex mu_;  // serializes writers; readers never take it
+        std::shared_ptr<const DeckProfileSet> set_;
+        std::atomic<uint64_t> version_{0};
+    };
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,499 @@
+#ifdef VOLUMEDECK_HAVE_PULSE
+
+#include "pulse_mixer_backend.h"
+
+#include <pulse/pulseaudio.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        constexpr char kSessionPrefix[] = "sink-input-";
+
+        float ToUnit(pa_volume_t v) { return std::min(1.0f, (float)v / (float)PA_VOLUME_NORM); }
+
+        // Raw volume, the scale pavucontrol and GNOME show as percent.
+        pa_volume_t FromUnit(float v) {
+            return (pa_volume_t)std::lround(std::min(1.0f, std::max(0.0f, v)) * (float)PA_VOLUME_NORM);
+        }
+
+        // Every request is fire-and-forget; true if it was sent.
+        bool Sent(pa_operation* op) {
+            if (!op) return false;
+            pa_operation_unref(op);
+            return true;
+        }
+
+        const char* Prop(pa_proplist* pl, const char* key) {
+            const char* v = pl ? pa_proplist_gets(pl, key) : nullptr;
+            return v && *v ? v : nullptr;
+        }
+
+        class LoopLock {
+        public:
+            explicit LoopLock(pa_threaded_mainloop* loop) : loop_(loop) { pa_threaded_mainloop_lock(loop_); }
+            ~LoopLock() { pa_threaded_mainloop_unlock(loop_); }
+
+        private:
+            pa_threaded_mainloop* loop_;
+        };
+
+    }  // namespace
+
+    struct PulseMixerBackend::Callbacks {
+        static void State(pa_context* c, void* ud) {
+            auto* self = static_cast<PulseMixerBackend*>(ud);
+            if (!PA_CONTEXT_IS_GOOD(pa_context_get_state(c))) {
+                self->lost_.store(true);
+                self->generation_++;
+            }
+            pa_threaded_mainloop_signal(self->loop_, 0);
+        }
+
+        static void Event(pa_context* c, pa_subscription_event_type_t t, uint32_t index, void* ud) {
+            auto* self = static_cast<PulseMixerBackend*>(ud);
+            const unsigned facility = t & PA_SUBSCRIPTION_EVENT_FACILITY_MASK;
+            const bool removed = (t & PA_SUBSCRIPTION_EVENT_TYPE_MASK) == PA_SUBSCRIPTION_EVENT_REMOVE;
+            switch (facility) {
+                case PA_SUBSCRIPTION_EVENT_SINK_INPUT:
+                    if (removed) {
+                        auto it = self->streams_.find(index);
+                        if (it == self->streams_.end()) break;
+                        ClosePeakStream(it->second.peak);
+                        self->streams_.erase(it);
+                        self->generation_++;
+                    } else {
+                        Sent(pa_context_get_sink_input_info(c, index, &SinkInput, self));
+                    }
+                    break;
+                case PA_SUBSCRIPTION_EVENT_SINK:
+                    if (removed) {
+                        auto it = self->sinks_.find(index);
+                        if (it == self->sinks_.end()) break;
+                        ClosePeakStream(it->second.peak_stream);
+                        self->sinks_.erase(it);
+                    } else {
+                        Sent(pa_context_get_sink_info_by_index(c, index, &Sink, self));
+                    }
+                    break;
+                case PA_SUBSCRIPTION_EVENT_SOURCE:
+                    if (removed) {
+                        self->sources_.erase(index);
+                    } else {
+                        Sent(pa_context_get_source_info_by_index(c, index, &Source, self));
+                    }
+                    break;
+                case PA_SUBSCRIPTION_EVENT_SERVER:
+                    Sent(pa_context_get_server_info(c, &Server, self));
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        static void SinkInput(pa_context*, const pa_sink_input_info* i, int eol, void* ud) {
+            if (eol || !i || !i->has_volume) return;
+            auto* self = static_cast<PulseMixerBackend*>(ud);
+            Stream& st = self->streams_[i->index];
+            const bool fresh = st.session.id.empty();
+            const bool moved = !fresh && st.sink != i->sink;
+            const float old_volume = st.session.volume;
+            const bool old_mute = st.session.mute;
+
+            AudioSession& s = st.session;
+            s.id = SessionId(i->index);
+            const char* binary = Prop(i->proplist, PA_PROP_APPLICATION_PROCESS_BINARY);
+            const char* app = Prop(i->proplist, PA_PROP_APPLICATION_NAME);
+            const char* pid = Prop(i->proplist, PA_PROP_APPLICATION_PROCESS_ID);
+            const char* role = Prop(i->proplist, PA_PROP_MEDIA_ROLE);
+            s.pid = pid ? (uint32_t)strtoul(pid, nullptr, 10) : 0;
+            s.exe_path = binary ? binary : "";
+            s.exe_name = binary ? ExeBasenameLower(binary)
+                                : app ? ExeBasenameLower(app) : "pid_" + std::to_string(s.pid);
+            s.display_name = app ? app : i->name ? i->name : s.exe_name;
+            s.system = role && strcmp(role, "event") == 0;
+            s.volume = ToUnit(pa_cvolume_max(&i->volume));
+            s.mute = i->mute != 0;
+            st.sink = i->sink;
+            st.channels = i->volume.channels;
+
+            if (moved) ClosePeakStream(st.peak);
+            if (!st.peak) self->AttachSessionPeak(i->index, &st);
+            if (fresh) self->generation_++;
+            if (!fresh && (s.volume != old_volume || s.mute != old_mute)) self->Report({s.id, s.volume, s.mute});
+        }
+
+        static void Sink(pa_context*, const pa_sink_info* i, int eol, void* ud) {
+            if (eol || !i) return;
+            auto* self = static_cast<PulseMixerBackend*>(ud);
+            Device& d = self->sinks_[i->index];
+            const bool fresh = d.name.empty();
+            const float old_volume = d.volume;
+            const bool old_mute = d.mute;
+            d.name = i->name ? i->name : "";
+            d.description = i->description ? i->description : d.name;
+            d.volume = ToUnit(pa_cvolume_max(&i->volume));
+            d.mute = i->mute != 0;
+            d.channels = i->volume.channels;
+            d.monitor = i->monitor_source;
+            self->UpdateMasterPeak();
+            if (!fresh && d.name == self->default_sink_ && (d.volume != old_volume || d.mute != old_mute)) {
+                self->Report({"", d.volume, d.mute});
+            }
+            // Sessions that arrived before their sink did.
+            for (auto& kv : self->streams_) {
+                if (kv.second.sink == i->index && !kv.second.peak) self->AttachSessionPeak(kv.first, &kv.second);
+            }
+        }
+
+        static void Source(pa_context*, const pa_source_info* i, int eol, void* ud) {
+            if (eol || !i) return;
+            auto* self = static_cast<PulseMixerBackend*>(ud);
+            Device& d = self->sources_[i->index];
+            d.name = i->name ? i->name : "";
+            d.description = i->description ? i->description : d.name;
+            d.volume = ToUnit(pa_cvolume_max(&i->volume));
+            d.mute = i->mute != 0;
+            d.channels = i->volume.channels;
+            d.monitor = i->monitor_of_sink;
+        }
+
+        static void Server(pa_context*, const pa_server_info* i, void* ud) {
+            auto* self = static_cast<PulseMixerBackend*>(ud);
+            if (!i) return;
+            self->default_sink_ = i->default_sink_name ? i->default_sink_name : "";
+            self->default_source_ = i->default_source_name ? i->default_source_name : "";
+            self->UpdateMasterPeak();
+        }
+
+        // Initial load: same handlers, plus the countdown Start() waits on.
+        static void SinkInputList(pa_context* c, const pa_sink_input_info* i, int eol, void* ud) {
+            SinkInput(c, i, eol, ud);
+            if (eol) static_cast<PulseMixerBackend*>(ud)->InitialReplyDone();
+        }
+        static void SinkList(pa_context* c, const pa_sink_info* i, int eol, void* ud) {
+            Sink(c, i, eol, ud);
+            if (eol) static_cast<PulseMixerBackend*>(ud)->InitialReplyDone();
+        }
+        static void SourceList(pa_context* c, const pa_source_info* i, int eol, void* ud) {
+            Source(c, i, eol, ud);
+            if (eol) static_cast<PulseMixerBackend*>(ud)->InitialReplyDone();
+        }
+        static void ServerOnce(pa_context* c, const pa_server_info* i, void* ud) {
+            Server(c, i, ud);
+            static_cast<PulseMixerBackend*>(ud)->InitialReplyDone();
+        }
+
+        static void Peak(pa_stream* s, size_t, void* ud) {
+            auto* self = static_cast<PulseMixerBackend*>(ud);
+            const void* data = nullptr;
+            size_t bytes = 0;
+            if (pa_stream_peek(s, &data, &bytes) < 0 || bytes == 0) return;
+            float v = -1.0f;
+            if (data && bytes >= sizeof(float)) memcpy(&v, (const char*)data + bytes - sizeof(float), sizeof(float));
+            pa_stream_drop(s);  // also required for holes (data == null)
+            if (v < 0.0f) return;
+            v = std::min(1.0f, std::fabs(v));
+
+            const uint32_t monitored = pa_stream_get_monitor_stream(s);
+            if (monitored != PA_INVALID_INDEX) {
+                auto it = self->streams_.find(monitored);
+                if (it != self->streams_.end()) it->second.session.peak = v;
+                return;
+            }
+            for (auto& kv : self->sinks_) {
+                if (kv.second.peak_stream == s) kv.second.peak = v;
+            }
+        }
+    };
+
+    std::string PulseMixerBackend::SessionId(uint32_t sink_input) {
+        return kSessionPrefix + std::to_string(sink_input);
+    }
+
+    bool PulseMixerBackend::Start() {
+        if (ctx_ && !lost_.load()) return true;
+        Stop();  // a dead context from before a server restart
+        lost_.store(false);
+        loop_ = pa_threaded_mainloop_new();
+        if (!loop_) return false;
+        ctx_ = pa_context_new(pa_threaded_mainloop_get_api(loop_), "VolumeDeck");
+        if (!ctx_ || pa_threaded_mainloop_start(loop_) < 0) {
+            Stop();
+            return false;
+        }
+
+        bool ok = false;
+        {
+            LoopLock lock(loop_);
+            pa_context_set_state_callback(ctx_, &Callbacks::State, this);
+            if (pa_context_connect(ctx_, nullptr, PA_CONTEXT_NOAUTOSPAWN, nullptr) >= 0) {
+                pa_context_state_t st;
+                while ((st = pa_context_get_state(ctx_)) != PA_CONTEXT_READY && PA_CONTEXT_IS_GOOD(st)) {
+                    pa_threaded_mainloop_wait(loop_);
+                }
+                ok = st == PA_CONTEXT_READY;
+            }
+            if (ok) {
+                // Subscribe before the initial lists so nothing in between is
+                // missed. Replies come back in request order, so sinks are
+                // known before the sessions playing on them.
+                pa_context_set_subscribe_callback(ctx_, &Callbacks::Event, this);
+                const auto mask = (pa_subscription_mask_t)(PA_SUBSCRIPTION_MASK_SINK_INPUT | PA_SUBSCRIPTION_MASK_SINK |
+                                                           PA_SUBSCRIPTION_MASK_SOURCE | PA_SUBSCRIPTION_MASK_SERVER);
+                pending_ = 4;
+                ok = Sent(pa_context_subscribe(ctx_, mask, nullptr, nullptr)) &&
+                     Sent(pa_context_get_server_info(ctx_, &Callbacks::ServerOnce, this)) &&
+                     Sent(pa_context_get_sink_info_list(ctx_, &Callbacks::SinkList, this)) &&
+                     Sent(pa_context_get_source_info_list(ctx_, &Callbacks::SourceList, this)) &&
+                     Sent(pa_context_get_sink_input_info_list(ctx_, &Callbacks::SinkInputList, this));
+                while (ok && pending_ > 0 && PA_CONTEXT_IS_GOOD(pa_context_get_state(ctx_))) {
+                    pa_threaded_mainloop_wait(loop_);
+                }
+                ok = ok && pending_ == 0;
+            }
+        }
+        if (!ok) Stop();
+        return ok;
+    }
+
+    void PulseMixerBackend::Stop() {
+        if (!loop_) return;
+        if (ctx_) {
+            LoopLock lock(loop_);
+            for (auto& kv : streams_) ClosePeakStream(kv.second.peak);
+            for (auto& kv : sinks_) ClosePeakStream(kv.second.peak_stream);
+            pa_context_set_subscribe_callback(ctx_, nullptr, nullptr);
+            pa_context_set_state_callback(ctx_, nullptr, nullptr);
+            pa_context_disconnect(ctx_);
+            pa_context_unref(ctx_);
+            ctx_ = nullptr;
+        }
+        pa_threaded_mainloop_stop(loop_);
+        pa_threaded_mainloop_free(loop_);
+        loop_ = nullptr;
+        streams_.clear();
+        sinks_.clear();
+        sources_.clear();
+        default_sink_.clear();
+        default_source_.clear();
+        pending_ = 0;
+        generation_++;
+    }
+
+    void PulseMixerBackend::InitialReplyDone() {
+        if (pending_ > 0 && --pending_ == 0) pa_threaded_mainloop_signal(loop_, 0);
+    }
+
+    // ---------- peak streams ----------
+
+    pa_stream* PulseMixerBackend::OpenPeakStream(uint32_t source, uint32_t sink_input) {
+        // One float per 40 ms: the server does the peak detection and only
+        // ships the maximum, the same way pavucontrol draws its bars.
+        pa_sample_spec ss;
+        ss.format = PA_SAMPLE_FLOAT32NE;
+        ss.rate = 25;
+        ss.channels = 1;
+        pa_stream* s = pa_stream_new(ctx_, "VolumeDeck peak", &ss, nullptr);
+        if (!s) return nullptr;
+        if (sink_input != PA_INVALID_INDEX) pa_stream_set_monitor_stream(s, sink_input);
+        pa_stream_set_read_callback(s, &Callbacks::Peak, this);
+
+        pa_buffer_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.maxlength = (uint32_t)-1;
+        attr.fragsize = sizeof(float);
+        char dev[16];
+        snprintf(dev, sizeof(dev), "%u", source);
+        const auto flags = (pa_stream_flags_t)(PA_STREAM_DONT_MOVE | PA_STREAM_PEAK_DETECT | PA_STREAM_ADJUST_LATENCY |
+                                               PA_STREAM_DONT_INHIBIT_AUTO_SUSPEND);
+        if (pa_stream_connect_record(s, dev, &attr, flags) < 0) {
+            pa_stream_set_read_callback(s, nullptr, nullptr);
+            pa_stream_unref(s);
+            return nullptr;
+        }
+        return s;
+    }
+
+    void PulseMixerBackend::ClosePeakStream(pa_stream*& s) {
+        if (!s) return;
+        pa_stream_set_read_callback(s, nullptr, nullptr);
+        pa_stream_disconnect(s);
+        pa_stream_unref(s);
+        s = nullptr;
+    }
+
+    void PulseMixerBackend::AttachSessionPeak(uint32_t index, Stream* st) {
+        if (!peak_streams_) return;
+        auto sink = sinks_.find(st->sink);
+        if (sink == sinks_.end() || sink->second.monitor == PA_INVALID_INDEX) return;
+        st->peak = OpenPeakStream(sink->second.monitor, index);
+    }
+
+    void PulseMixerBackend::UpdateMasterPeak() {
+        for (auto& kv : sinks_) {
+            Device& d = kv.second;
+            const bool want = peak_streams_ && !default_sink_.empty() && d.name == default_sink_ &&
+                              d.monitor != PA_INVALID_INDEX;
+            if (want && !d.peak_stream) d.peak_stream = OpenPeakStream(d.monitor, PA_INVALID_INDEX);
+            if (!want && d.peak_stream) {
+                ClosePeakStream(d.peak_stream);
+                d.peak = 0.0f;
+            }
+        }
+    }
+
+    // ---------- lookups ----------
+
+    PulseMixerBackend::Stream* PulseMixerBackend::FindStream(const std::string& id, uint32_t* index) {
+        const size_t n = sizeof(kSessionPrefix) - 1;
+        if (id.size() <= n || id.compare(0, n, kSessionPrefix) != 0) return nullptr;
+        char* end = nullptr;
+        *index = (uint32_t)strtoul(id.c_str() + n, &end, 10);
+        if (!end || *end) return nullptr;
+        auto it = streams_.find(*index);
+        return it != streams_.end() ? &it->second : nullptr;
+    }
+
+    PulseMixerBackend::Device* PulseMixerBackend::FindDevice(std::map<uint32_t, Device>& devices,
+                                                             const std::string& name, uint32_t* index) {
+        for (auto& kv : devices) {
+            if (kv.second.name == name || strcasecmp(kv.second.description.c_str(), name.c_str()) == 0) {
+                *index = kv.first;
+                return &kv.second;
+            }
+        }
+        return nullptr;
+    }
+
+    // ---------- MixerBackend ----------
+
+    bool PulseMixerBackend::ListSessions(std::vector<AudioSession>* out) {
+        out->clear();
+        if (!ctx_) return false;
+        LoopLock lock(loop_);
+        if (pa_context_get_state(ctx_) != PA_CONTEXT_READY) return false;
+        out->reserve(streams_.size());
+        for (const auto& kv : streams_) out->push_back(kv.second.session);
+        return true;
+    }
+
+    bool PulseMixerBackend::GetMaster(float* volume, bool* mute, float* peak) {
+        if (!ctx_) return false;
+        LoopLock lock(loop_);
+        uint32_t index = 0;
+        const Device* d = FindDevice(sinks_, default_sink_, &index);
+        if (!d) return false;
+        if (volume) *volume = d->volume;
+        if (mute) *mute = d->mute;
+        if (peak) *peak = d->peak;
+        return true;
+    }
+
+    bool PulseMixerBackend::SetSinkVolume(uint32_t index, const Device& d, float volume) {
+        pa_cvolume cv;
+        pa_cvolume_set(&cv, std::max<uint8_t>(d.channels, 1), FromUnit(volume));
+        return Sent(pa_context_set_sink_volume_by_index(ctx_, index, &cv, nullptr, nullptr));
+    }
+
+    bool PulseMixerBackend::SetChangeObserver(MixerChangeObserver observer) {
+        if (!loop_) {
+            observer_ = std::move(observer);
+            return true;
+        }
+        LoopLock lock(loop_);
+        observer_ = std::move(observer);
+        return true;
+    }
+
+    void PulseMixerBackend::Report(const MixerChange& change) {
+        if (observer_ && echo_.External(change, nullptr)) observer_(change);
+    }
+
+    bool PulseMixerBackend::SetMasterVolume(float volume) {
+        if (!ctx_) return false;
+        LoopLock lock(loop_);
+        uint32_t index = 0;
+        Device* d = FindDevice(sinks_, default_sink_, &index);
+        if (!d) return false;
+        echo_.NoteVolume("", ToUnit(FromUnit(volume)));
+        return SetSinkVolume(index, *d, volume);
+    }
+
+    bool PulseMixerBackend::SetMasterMute(bool mute) {
+        if (!ctx_) return false;
+        LoopLock lock(loop_);
+        uint32_t index = 0;
+        Device* d = FindDevice(sinks_, default_sink_, &index);
+        if (!d) return false;
+        echo_.NoteMute("", mute);
+        return Sent(pa_context_set_sink_mute_by_index(ctx_, index, mute ? 1 : 0, nullptr, nullptr));
+    }
+
+    bool PulseMixerBackend::SetSessionVolume(const std::string& id, float volume) {
+        if (!ctx_) return false;
+        LoopLock lock(loop_);
+        uint32_t index = 0;
+        Stream* st = FindStream(id, &index);
+        if (!st) return false;
+        pa_cvolume cv;
+        pa_cvolume_set(&cv, std::max<uint8_t>(st->channels, 1), FromUnit(volume));
+        echo_.NoteVolume(id, ToUnit(FromUnit(volume)));
+        return Sent(pa_context_set_sink_input_volume(ctx_, index, &cv, nullptr, nullptr));
+    }
+
+    bool PulseMixerBackend::SetSessionMute(const std::string& id, bool mute) {
+        if (!ctx_) return false;
+        LoopLock lock(loop_);
+        uint32_t index = 0;
+        Stream* st = FindStream(id, &index);
+        if (!st) return false;
+        echo_.NoteMute(id, mute);
+        return Sent(pa_context_set_sink_input_mute(ctx_, index, mute ? 1 : 0, nullptr, nullptr));
+    }
+
+    bool PulseMixerBackend::SetInputVolume(float volume) {
+        if (!ctx_) return false;
+        LoopLock lock(loop_);
+        uint32_t index = 0;
+        Device* d = FindDevice(sources_, default_source_, &index);
+        if (!d) return false;
+        pa_cvolume cv;
+        pa_cvolume_set(&cv, std::max<uint8_t>(d->channels, 1), FromUnit(volume));
+        if (!Sent(pa_context_set_source_volume_by_index(ctx_, index, &cv, nullptr, nullptr))) return false;
+        d->volume = ToUnit(FromUnit(volume));
+        return true;
+    }
+
+    bool PulseMixerBackend::SetDeviceVolume(const std::string& name, float volume) {
+        if (!ctx_) return false;
+        LoopLock lock(loop_);
+        uint32_t index = 0;
+        if (Device* d = FindDevice(sinks_, name, &index)) {
+            if (d->name == default_sink_) echo_.NoteVolume("", ToUnit(FromUnit(volume)));
+            return SetSinkVolume(index, *d, volume);
+        }
+        // Inputs too, but not the ".monitor" shadows of the sinks.
+        for (auto& kv : sources_) {
+            Device& d = kv.second;
+            if (d.monitor != PA_INVALID_INDEX) continue;
+            if (d.name != name && strcasecmp(d.description.c_str(), name.c_str()) != 0) continue;
+            pa_cvolume cv;
+            pa_cvolume_set(&cv, std::max<uint8_t>(d.channels, 1), FromUnit(volume));
+            if (!Sent(pa_context_set_source_volume_by_index(ctx_, kv.first, &cv, nullptr, nullptr))) return false;
+            d.volume = ToUnit(FromUnit(volume));
+            return true;
+        }
+        return false;
+    }
+
+}  // namespace volumedeck_mixer
+
+#endif  // VOLUMEDECK_HAVE_PULSE
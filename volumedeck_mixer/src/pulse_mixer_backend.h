@@ -0,0 +1,118 @@
+#pragma once
+
+#ifdef VOLUMEDECK_HAVE_PULSE
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "echo_filter.h"
+#include "mixer_backend.h"
+
+struct pa_threaded_mainloop;
+struct pa_context;
+struct pa_stream;
+
+namespace volumedeck_mixer {
+
+    // PulseAudio / PipeWire (pipewire-pulse) client. Sessions are sink
+    // inputs, master is the default sink, "mic" the default source.
+    //
+    // Nothing is polled: Start() loads the server state once and then keeps
+    // a cache current from subscription events, so ListSessions() and the
+    // getters never leave the process. Setters are fire-and-forget requests
+    // on the same connection. Peaks come from 25 Hz PEAK_DETECT monitor
+    // streams, one per session plus one for the default sink.
+    //
+    // PulseAudio has no event contexts: change notifications for the default
+    // sink and the sessions reach the observer when they differ from the
+    // cache, and EchoFilter's in-flight check drops those that echo our
+    // writes. Setters leave the sink and session cache alone, so the
+    // confirming event of each write differs from it and retires the write;
+    // reads show the old value until then.
+    //
+    // The cache is guarded by the mainloop lock; callbacks run with it held
+    // on the mainloop thread. If the server goes away every call fails and
+    // lost() turns true; the engine then reconnects with Stop()/Start().
+    class PulseMixerBackend : public MixerBackend {
+    public:
+        explicit PulseMixerBackend(bool peak_streams = true) : peak_streams_(peak_streams) {}
+        ~PulseMixerBackend() override { Stop(); }
+
+        PulseMixerBackend(const PulseMixerBackend&) = delete;
+        PulseMixerBackend& operator=(const PulseMixerBackend&) = delete;
+
+        const char* name() const override { return "pulse"; }
+
+        bool Start() override;
+        void Stop() override;
+
+        bool ListSessions(std::vector<AudioSession>* out) override;
+        bool GetMaster(float* volume, bool* mute, float* peak) override;
+        bool SetMasterVolume(float volume) override;
+        bool SetMasterMute(bool mute) override;
+        bool SetSessionVolume(const std::string& id, float volume) override;
+        bool SetSessionMute(const std::string& id, bool mute) override;
+        bool SetInputVolume(float volume) override;
+        bool SetDeviceVolume(const std::string& name, float volume) override;
+        bool lost() const override { return lost_.load(); }
+        uint64_t session_generation() const override { return generation_.load(); }
+        bool SetChangeObserver(MixerChangeObserver observer) override;
+
+        // "sink-input-<index>".
+        static std::string SessionId(uint32_t sink_input);
+
+    private:
+        struct Stream {
+            AudioSession session;
+            uint32_t sink = 0;
+            uint8_t channels = 0;
+            pa_stream* peak = nullptr;
+        };
+        struct Device {
+            std::string name;          // "alsa_output.pci-0000_00_1f.3.analog-stereo"
+            std::string description;   // "Built-in Audio Analog Stereo"
+            float volume = 1.0f;
+            bool mute = false;
+            uint8_t channels = 0;
+            uint32_t monitor = 0;      // sinks: monitor source; sources: sink monitored, or invalid
+            float peak = 0.0f;
+            pa_stream* peak_stream = nullptr;
+        };
+
+        // The C callbacks, defined next to the libpulse includes.
+        struct Callbacks;
+
+        void InitialReplyDone();
+        void UpdateMasterPeak();
+        void AttachSessionPeak(uint32_t index, Stream* st);
+        pa_stream* OpenPeakStream(uint32_t source, uint32_t sink_input);
+        static void ClosePeakStream(pa_stream*& s);
+
+        Stream* FindStream(const std::string& id, uint32_t* index);
+        Device* FindDevice(std::map<uint32_t, Device>& devices, const std::string& name, uint32_t* index);
+        bool SetSinkVolume(uint32_t index, const Device& d, float volume);
+        // On the mainloop thread, lock held.
+        void Report(const MixerChange& change);
+
+        const bool peak_streams_;
+        pa_threaded_mainloop* loop_ = nullptr;
+        pa_context* ctx_ = nullptr;
+        int pending_ = 0;
+
+        std::map<uint32_t, Stream> streams_;
+        std::map<uint32_t, Device> sinks_;
+        std::map<uint32_t, Device> sources_;
+        std::string default_sink_;
+        std::string default_source_;
+        std::atomic<uint64_t> generation_{1};
+        std::atomic<bool> lost_{false};  // set on the mainloop thread
+        MixerChangeObserver observer_;
+        EchoFilter echo_;
+    };
+
+}  // namespace volumedeck_mixer
+
+#endif  // VOLUMEDECK_HAVE_PULSE
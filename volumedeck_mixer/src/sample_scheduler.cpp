@@ -0,0 +1,141 @@
+#include "sample_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace volumedeck_mixer {
+
+    uint64_t ThreadCpuTimeNs() {
+#ifdef _WIN32
+        FILETIME created, exited, kernel, user;
+        if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) return 0;
+        const auto ticks = [](const FILETIME& t) { return (uint64_t)t.dwHighDateTime << 32 | t.dwLowDateTime; };
+        return (ticks(kernel) + ticks(user)) * 100;  // 100 ns units
+#else
+        timespec ts;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+        return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+    }
+
+    SampleScheduler::SampleScheduler(SampleRates rates) : rates_(rates) {}
+
+    bool SampleScheduler::Live(const Subscriber& s, Clock::time_point now) {
+        return s.lease == Clock::duration::zero() || now - s.renewed < s.lease;
+    }
+
+    void SampleScheduler::Wake() const {
+        if (wake_) wake_();
+    }
+
+    int SampleScheduler::Subscribe(RateHint hint, Clock::duration lease, Clock::time_point now) {
+        int id;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            id = next_id_++;
+            subscribers_[id] = Subscriber{hint, lease, now};
+        }
+        Wake();
+        return id;
+    }
+
+    bool SampleScheduler::SetHint(int id, RateHint hint) {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            auto it = subscribers_.find(id);
+            if (it == subscribers_.end()) return false;
+            it->second.hint = hint;
+        }
+        Wake();
+        return true;
+    }
+
+    bool SampleScheduler::Renew(int id, Clock::time_point now) {
+        bool lapsed;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            auto it = subscribers_.find(id);
+            if (it == subscribers_.end()) return false;
+            lapsed = !Live(it->second, now);
+            it->second.renewed = now;
+        }
+        // Back from a lapse: the sampler may be paused on its account.
+        if (lapsed) Wake();
+        return true;
+    }
+
+    void SampleScheduler::Unsubscribe(int id) {
+        std::lock_guard<std::mutex> lock(mu_);
+        subscribers_.erase(id);
+    }
+
+    size_t SampleScheduler::subscribers(Clock::time_point now) const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return (size_t)std::count_if(subscribers_.begin(), subscribers_.end(),
+                                     [&](const auto& kv) { return Live(kv.second, now); });
+    }
+
+    void SampleScheduler::NoteActivity(Clock::time_point now) {
+        activity_.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+        const double hz = last_hz_.load(std::memory_order_relaxed);
+        if (hz > 0.0 && hz < rates_.high_hz) Wake();
+    }
+
+    double SampleScheduler::Rate(Clock::time_point now) const {
+        double cap = 0.0;
+        double floor = 0.0;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            for (const auto& kv : subscribers_) {
+                if (!Live(kv.second, now)) continue;
+                const RateHint& h = kv.second.hint;
+                // The most demanding subscriber sets the ceiling.
+                cap = std::max(cap, h.max_hz > 0.0 ? h.max_hz : rates_.high_hz);
+                floor = std::max(floor, h.min_hz);
+            }
+        }
+        if (cap == 0.0) return 0.0;
+        cap = std::min(cap, rates_.high_hz);
+
+        double hz = rates_.low_hz;
+        const int64_t at = activity_.load(std::memory_order_relaxed);
+        if (at != INT64_MIN) {
+            const auto since = now - Clock::time_point(Clock::duration(at));
+            if (since <= rates_.hold) {
+                hz = rates_.high_hz;
+            } else {
+                const double halvings = std::chrono::duration<double>(since - rates_.hold).count() /
+                                        std::chrono::duration<double>(rates_.half_life).count();
+                hz = std::max(rates_.low_hz, rates_.high_hz * std::exp2(-halvings));
+            }
+        }
+        return std::clamp(hz, std::min(floor, cap), cap);
+    }
+
+    SampleScheduler::Clock::time_point SampleScheduler::Due(Clock::time_point last, Clock::time_point now) const {
+        const double hz = Rate(now);
+        if (hz <= 0.0) return Clock::time_point::max();
+        return last + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / hz));
+    }
+
+    SampleScheduler::Clock::time_point SampleScheduler::Ticked(Clock::time_point now, uint64_t cpu_ns) {
+        const double hz = Rate(now);
+        last_hz_.store(hz, std::memory_order_relaxed);
+        const uint64_t prev = cpu_ns_.load(std::memory_order_relaxed);
+        cpu_ns_.store(prev == 0 ? cpu_ns : prev - prev / 64 + cpu_ns / 64, std::memory_order_relaxed);
+        ticks_.fetch_add(1, std::memory_order_relaxed);
+        if (logger_) logger_(SampleTick{hz, cpu_ns});
+        if (hz <= 0.0) return Clock::time_point::max();
+        return now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / hz));
+    }
+
+}  // namespace volumedeck_mixer
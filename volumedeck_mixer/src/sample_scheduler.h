@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+
+namespace volumedeck_mixer {
+
+    // What one subscriber can use. 0 for either: no opinion.
+    struct RateHint {
+        double min_hz = 0.0;  // wants at least this, even when all is silent
+        double max_hz = 0.0;  // has no use for more (a 20 Hz poll, a hidden window)
+    };
+
+    struct SampleRates {
+        double high_hz = 250.0;  // meters moving, a fader being dragged
+        double low_hz = 4.0;     // silence
+        // Full rate for this long after the last activity, then halving
+        // every `half_life` down to low_hz.
+        std::chrono::milliseconds hold{1000};
+        std::chrono::milliseconds half_life{250};
+    };
+
+    // One tick, as handed to the logger.
+    struct SampleTick {
+        double hz = 0.0;      // rate chosen for the next tick; 0 paused
+        uint64_t cpu_ns = 0;  // thread CPU time the tick took
+    };
+
+    // Thread CPU time, for timing ticks.
+    uint64_t ThreadCpuTimeNs();
+
+    // Picks the sampling rate for a meter / snapshot loop so the machine can
+    // idle: high_hz while there is activity, decaying to low_hz through
+    // silence, clamped to what the subscribers hint they can use, and
+    // paused while there are none. Every call takes the time it is about
+    // so tests can run it on a simulated clock; Clock::now() by default.
+    // Thread-safe.
+    class SampleScheduler {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using Logger = std::function<void(const SampleTick& tick)>;
+
+        explicit SampleScheduler(SampleRates rates = {});
+
+        SampleScheduler(const SampleScheduler&) = delete;
+        SampleScheduler& operator=(const SampleScheduler&) = delete;
+
+        // Counted until Unsubscribe(), or with a nonzero `lease`, until a
+        // lease passes without Renew() (pollers that may just stop).
+        int Subscribe(RateHint hint = {}, Clock::duration lease = Clock::duration::zero(),
+                      Clock::time_point now = Clock::now());
+        bool SetHint(int id, RateHint hint);
+        bool Renew(int id, Clock::time_point now = Clock::now());
+        void Unsubscribe(int id);
+        size_t subscribers(Clock::time_point now = Clock::now()) const;
+
+        // Meters above silence, a fader moved. Any thread, lock-free unless
+        // it wakes a sampler running below high_hz.
+        void NoteActivity(Clock::time_point now = Clock::now());
+
+        // The rate to sample at `now`; 0 while nobody is subscribed.
+        double Rate(Clock::time_point now) const;
+        // When the tick after one at `last` is due; max() while paused.
+        Clock::time_point Due(Clock::time_point last, Clock::time_point now) const;
+        // After each tick: logs it and returns when the next is due.
+        Clock::time_point Ticked(Clock::time_point now, uint64_t cpu_ns);
+
+        // Set both before the sampler starts. `wake` is called when the
+        // rate may have gone up (a subscriber, a hint, activity while slow)
+        // so a sleeping sampler can re-ask Due().
+        void SetWake(std::function<void()> wake) { wake_ = std::move(wake); }
+        void SetLogger(Logger logger) { logger_ = std::move(logger); }
+
+        const SampleRates& rates() const { return rates_; }
+        uint64_t ticks() const { return ticks_.load(std::memory_order_relaxed); }
+        double last_hz() const { return last_hz_.load(std::memory_order_relaxed); }
+        // Exponential average over roughly the last 64 ticks.
+        uint64_t cpu_ns_per_tick() const { return cpu_ns_.load(std::memory_order_relaxed); }
+
+    private:
+        struct Subscriber {
+            RateHint hint;
+            Clock::duration lease;
+            Clock::time_point renewed;
+        };
+
+        static bool Live(const Subscriber& s, Clock::time_point now);
+        void Wake() const;
+
+        const SampleRates rates_;
+        mutable std::mutex mu_;
+        std::map<int, Subscriber> subscribers_;
+        int next_id_ = 1;
+
+        std::atomic<int64_t> activity_{INT64_MIN};  // Clock::rep since its epoch; MIN: never
+        std::atomic<double> last_hz_{0.0};
+        std::atomic<uint64_t> ticks_{0};
+        std::atomic<uint64_t> cpu_ns_{0};
+        std::function<void()> wake_;
+        Logger logger_;
+    };
+
+}  // namespace volumedeck_mixer
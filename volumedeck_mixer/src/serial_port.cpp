@@ -0,0 +1,211 @@
+#include "serial_port.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include "file_util.h"
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+namespace volumedeck_mixer {
+
+    bool SerialPort::Retarget(const std::string& port, int baud) {
+        Close();
+        path_ = port;
+        baud_ = baud;
+        return true;
+    }
+
+#ifdef _WIN32
+
+    bool SerialPort::Open() {
+        Close();
+        // "\\.\" prefix: required for COM10 and up, harmless below.
+        const std::wstring name = Utf8ToWide(path_.rfind("\\\\.\\", 0) == 0 ? path_ : "\\\\.\\" + path_);
+        HANDLE h = CreateFileW(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING,
+                               FILE_FLAG_OVERLAPPED, nullptr);
+        if (h == INVALID_HANDLE_VALUE) return false;
+        if (!event_) event_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+        DCB dcb{};
+        dcb.DCBlength = sizeof(dcb);
+        if (!GetCommState(h, &dcb)) {
+            CloseHandle(h);
+            return false;
+        }
+        dcb.BaudRate = (DWORD)baud_;
+        dcb.ByteSize = 8;
+        dcb.Parity = NOPARITY;
+        dcb.StopBits = ONESTOPBIT;
+        dcb.fBinary = TRUE;
+        dcb.fDtrControl = DTR_CONTROL_ENABLE;  // Arduinos reset on DTR and then stream
+        dcb.fRtsControl = RTS_CONTROL_ENABLE;
+        dcb.fOutxCtsFlow = FALSE;
+        dcb.fOutxDsrFlow = FALSE;
+        // Reads return at once with whatever is buffered; waiting is done
+        // on WaitCommEvent and the tick timer, so a timeout isn't rounded
+        // up to the system tick.
+        COMMTIMEOUTS t{};
+        t.ReadIntervalTimeout = MAXDWORD;
+        t.WriteTotalTimeoutConstant = 100;
+        if (!event_ || !SetCommState(h, &dcb) || !SetCommTimeouts(h, &t) || !SetCommMask(h, EV_RXCHAR)) {
+            CloseHandle(h);
+            return false;
+        }
+        PurgeComm(h, PURGE_RXCLEAR | PURGE_TXCLEAR);
+        handle_ = h;
+        return true;
+    }
+
+    void SerialPort::Close() {
+        if (handle_) CloseHandle((HANDLE)handle_);
+        handle_ = nullptr;
+        if (event_) CloseHandle((HANDLE)event_);
+        event_ = nullptr;
+    }
+
+    bool SerialPort::is_open() const { return handle_ != nullptr; }
+
+    namespace {
+
+        // Waits out an overlapped call; `started` is what starting it
+        // returned. -1 on error.
+        long Finish(HANDLE h, OVERLAPPED* ov, BOOL started) {
+            if (!started && GetLastError() != ERROR_IO_PENDING) return -1;
+            DWORD n = 0;
+            if (!GetOverlappedResult(h, ov, &n, TRUE)) return -1;
+            return (long)n;
+        }
+
+    }  // namespace
+
+    long SerialPort::ReadAvailable(char* buffer, size_t size) {
+        OVERLAPPED ov{};
+        ov.hEvent = (HANDLE)event_;
+        DWORD got = 0;
+        const BOOL ok = ReadFile((HANDLE)handle_, buffer, (DWORD)size, &got, &ov);
+        return Finish((HANDLE)handle_, &ov, ok);
+    }
+
+    long SerialPort::Read(char* buffer, size_t size, int timeout_ms) {
+        if (!handle_) return -1;
+        const long n = ReadAvailable(buffer, size);
+        if (n != 0) return n;
+
+        // Nothing buffered: the next byte or the timer, whichever is first.
+        OVERLAPPED ov{};
+        ov.hEvent = (HANDLE)event_;
+        DWORD mask = 0;
+        if (!WaitCommEvent((HANDLE)handle_, &mask, &ov)) {
+            if (GetLastError() != ERROR_IO_PENDING) return -1;
+            HANDLE waits[2] = {(HANDLE)event_, (HANDLE)timer_.handle()};
+            const bool timed = waits[1] && timer_.Arm(std::chrono::milliseconds(timeout_ms > 0 ? timeout_ms : 1));
+            const DWORD r = WaitForMultipleObjects(timed ? 2 : 1, waits, FALSE,
+                                                   timed ? INFINITE : (DWORD)(timeout_ms > 0 ? timeout_ms : 1));
+            if (r != WAIT_OBJECT_0) {
+                // Take the wait back before its OVERLAPPED goes away.
+                CancelIoEx((HANDLE)handle_, &ov);
+                DWORD ignored = 0;
+                GetOverlappedResult((HANDLE)handle_, &ov, &ignored, TRUE);
+                if (r != WAIT_OBJECT_0 + 1 && r != WAIT_TIMEOUT) return -1;
+                return ReadAvailable(buffer, size);  // a byte may have just come
+            }
+            DWORD ignored = 0;
+            if (!GetOverlappedResult((HANDLE)handle_, &ov, &ignored, FALSE)) return -1;
+        }
+        return ReadAvailable(buffer, size);
+    }
+
+    long SerialPort::Write(const char* data, size_t size) {
+        if (!handle_) return -1;
+        OVERLAPPED ov{};
+        ov.hEvent = (HANDLE)event_;
+        DWORD wrote = 0;
+        const BOOL ok = WriteFile((HANDLE)handle_, data, (DWORD)size, &wrote, &ov);
+        return Finish((HANDLE)handle_, &ov, ok);
+    }
+
+#else
+
+    namespace {
+
+        speed_t BaudConstant(int baud) {
+            switch (baud) {
+                case 1200: return B1200;
+                case 2400: return B2400;
+                case 4800: return B4800;
+                case 9600: return B9600;
+                case 19200: return B19200;
+                case 38400: return B38400;
+                case 57600: return B57600;
+                case 115200: return B115200;
+                case 230400: return B230400;
+                default: return B9600;
+            }
+        }
+
+    }  // namespace
+
+    bool SerialPort::Open() {
+        Close();
+        if (path_ == "-") {
+            fd_ = STDIN_FILENO;
+            owns_fd_ = false;
+            return true;
+        }
+        fd_ = ::open(path_.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (fd_ < 0) fd_ = ::open(path_.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);  // read-only FIFO/file
+        if (fd_ < 0) return false;
+        owns_fd_ = true;
+
+        if (isatty(fd_)) {
+            termios tio{};
+            if (tcgetattr(fd_, &tio) == 0) {
+                cfmakeraw(&tio);
+                tio.c_cflag |= CLOCAL | CREAD;
+                tio.c_cflag &= ~(tcflag_t)(CSTOPB | PARENB);
+                cfsetispeed(&tio, BaudConstant(baud_));
+                cfsetospeed(&tio, BaudConstant(baud_));
+                tcsetattr(fd_, TCSANOW, &tio);
+                tcflush(fd_, TCIFLUSH);
+            }
+        }
+        return true;
+    }
+
+    void SerialPort::Close() {
+        if (fd_ >= 0 && owns_fd_) ::close(fd_);
+        fd_ = -1;
+        owns_fd_ = false;
+    }
+
+    bool SerialPort::is_open() const { return fd_ >= 0; }
+
+    long SerialPort::Read(char* buffer, size_t size, int timeout_ms) {
+        if (fd_ < 0) return -1;
+        pollfd p{fd_, POLLIN, 0};
+        const int r = ::poll(&p, 1, timeout_ms);
+        if (r < 0) return errno == EINTR ? 0 : -1;
+        if (r == 0) return 0;
+        const ssize_t n = ::read(fd_, buffer, size);
+        if (n > 0) return (long)n;
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) return 0;
+        return -1;  // EOF: the other end (board, pty master, writer) is gone
+    }
+
+    long SerialPort::Write(const char* data, size_t size) {
+        if (fd_ < 0) return -1;
+        const ssize_t n = ::write(fd_, data, size);
+        if (n < 0) return errno == EAGAIN ? 0 : -1;
+        return (long)n;
+    }
+
+#endif
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#ifdef _WIN32
+#include "thread_priority.h"
+#endif
+
+namespace volumedeck_mixer {
+
+    // Byte stream the slider boards talk over. Serial ports in practice;
+    // pipes and ptys in tests.
+    class SliderInput {
+    public:
+        virtual ~SliderInput() = default;
+
+        virtual bool Open() = 0;
+        virtual void Close() = 0;
+        // Waits up to `timeout_ms` for data. Returns bytes read, 0 on
+        // timeout, -1 when the device is gone (unplugged board).
+        virtual long Read(char* buffer, size_t size, int timeout_ms) = 0;
+        virtual long Write(const char* data, size_t size) = 0;
+        // Points the input at another port for the next Open(), after a
+        // com_port/baud_rate change. False if this input has no such notion.
+        virtual bool Retarget(const std::string&, int) { return false; }
+
+        virtual std::string description() const = 0;
+    };
+
+    // 8N1 serial port at `baud`: "COM4" on Windows, "/dev/ttyUSB0" on
+    // Linux. "-" reads standard input (POSIX only), and non-tty paths such
+    // as FIFOs are opened as plain files.
+    class SerialPort : public SliderInput {
+    public:
+        SerialPort(std::string path, int baud) : path_(std::move(path)), baud_(baud) {}
+        ~SerialPort() override { Close(); }
+
+        bool Open() override;
+        void Close() override;
+        long Read(char* buffer, size_t size, int timeout_ms) override;
+        long Write(const char* data, size_t size) override;
+        bool Retarget(const std::string& port, int baud) override;
+        std::string description() const override { return path_; }
+
+        bool is_open() const;
+
+    private:
+        std::string path_;
+        int baud_;
+#ifdef _WIN32
+        long ReadAvailable(char* buffer, size_t size);
+
+        void* handle_ = nullptr;  // overlapped
+        void* event_ = nullptr;   // for each overlapped call in turn
+        TickTimer timer_;         // read timeouts, finer than the comm timeouts
+#else
+        int fd_ = -1;
+        bool owns_fd_ = false;
+#endif
+    };
+
+}  // namespace volumedeck_mixer
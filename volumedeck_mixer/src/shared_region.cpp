@@ -0,0 +1,140 @@
+#include "shared_region.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include "file_util.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+namespace volumedeck_mixer {
+
+#ifdef _WIN32
+    bool SharedRegion::Create(const std::string& name, size_t size, const StaleCheck&) {
+        Close();
+        const std::wstring wname = Utf8ToWide("Local\\" + name);
+        const uint64_t size64 = size;
+        HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                            (DWORD)(size64 >> 32), (DWORD)size64, wname.c_str());
+        if (!mapping) return false;
+        // Sections vanish with their last handle, so an existing one belongs
+        // to a live process; don't share it with a second writer.
+        if (GetLastError() == ERROR_ALREADY_EXISTS) {
+            CloseHandle(mapping);
+            return false;
+        }
+        void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+        if (!view) {
+            CloseHandle(mapping);
+            return false;
+        }
+        mapping_ = mapping;
+        data_ = static_cast<uint8_t*>(view);
+        size_ = size;
+        owner_ = true;
+        return true;
+    }
+
+    bool SharedRegion::Open(const std::string& name) {
+        Close();
+        HANDLE mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, Utf8ToWide("Local\\" + name).c_str());
+        if (!mapping) return false;
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        MEMORY_BASIC_INFORMATION info{};
+        if (!view || !VirtualQuery(view, &info, sizeof(info))) {
+            if (view) UnmapViewOfFile(view);
+            CloseHandle(mapping);
+            return false;
+        }
+        mapping_ = mapping;
+        data_ = static_cast<uint8_t*>(view);
+        size_ = info.RegionSize;  // rounded up to a page
+        return true;
+    }
+
+    void SharedRegion::Close() {
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        data_ = nullptr;
+        mapping_ = nullptr;
+        size_ = 0;
+        owner_ = false;
+    }
+#else
+    bool SharedRegion::Create(const std::string& name, size_t size, const StaleCheck& stale) {
+        Close();
+        const std::string path = "/" + name;
+        int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (fd < 0 && errno == EEXIST && stale) {
+            SharedRegion old;
+            if (!old.Open(name) || !stale(old.data(), old.size())) return false;
+            old.Close();
+            shm_unlink(path.c_str());
+            fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        }
+        if (fd < 0) return false;
+        struct stat st {};
+        if (fstat(fd, &st) != 0 || ftruncate(fd, (off_t)size) != 0) {
+            ::close(fd);
+            shm_unlink(path.c_str());
+            return false;
+        }
+        void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) {
+            shm_unlink(path.c_str());
+            return false;
+        }
+        data_ = static_cast<uint8_t*>(view);
+        size_ = size;
+        owner_ = true;
+        name_ = path;
+        device_ = (uint64_t)st.st_dev;
+        inode_ = (uint64_t)st.st_ino;
+        return true;
+    }
+
+    bool SharedRegion::Open(const std::string& name) {
+        Close();
+        int fd = shm_open(("/" + name).c_str(), O_RDONLY | O_CLOEXEC, 0);
+        if (fd < 0) return false;
+        struct stat st {};
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) return false;
+        data_ = static_cast<uint8_t*>(view);
+        size_ = (size_t)st.st_size;
+        return true;
+    }
+
+    void SharedRegion::Close() {
+        if (data_) munmap(data_, size_);
+        if (owner_) {
+            // Only our own: a writer that took over a region it found stale
+            // keeps its name.
+            int fd = shm_open(name_.c_str(), O_RDONLY | O_CLOEXEC, 0);
+            struct stat st {};
+            if (fd >= 0 && fstat(fd, &st) == 0 && (uint64_t)st.st_dev == device_ && (uint64_t)st.st_ino == inode_) {
+                shm_unlink(name_.c_str());
+            }
+            if (fd >= 0) ::close(fd);
+        }
+        data_ = nullptr;
+        size_ = 0;
+        owner_ = false;
+        name_.clear();
+        device_ = inode_ = 0;
+    }
+#endif
+
+}  // namespace volumedeck_mixer
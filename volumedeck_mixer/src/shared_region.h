@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace volumedeck_mixer {
+
+    // Named shared memory: a POSIX shm object or a Win32 pagefile-backed
+    // section in the session's Local\ namespace. One process Create()s it,
+    // any number Open() it read-only.
+    class SharedRegion {
+    public:
+        SharedRegion() = default;
+        ~SharedRegion() { Close(); }
+
+        SharedRegion(const SharedRegion&) = delete;
+        SharedRegion& operator=(const SharedRegion&) = delete;
+
+        // Zero-filled. Fails if the name is taken: another writer owns it.
+        // POSIX regions outlive a crashed owner, so there `stale` is shown
+        // the existing contents and, if it says so, the region is replaced;
+        // readers still mapping the old one keep it until they close.
+        // Windows sections vanish with their last handle and are never stale.
+        using StaleCheck = std::function<bool(const uint8_t* data, size_t size)>;
+        bool Create(const std::string& name, size_t size, const StaleCheck& stale = nullptr);
+        bool Open(const std::string& name);
+        // Unmaps; the owner also removes the name.
+        void Close();
+
+        bool is_open() const { return data_ != nullptr; }
+        uint8_t* data() const { return data_; }
+        size_t size() const { return size_; }
+
+    private:
+        uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+        bool owner_ = false;
+#ifdef _WIN32
+        void* mapping_ = nullptr;
+#else
+        std::string name_;
+        // Ours, to leave alone a region that has since replaced it.
+        uint64_t device_ = 0;
+        uint64_t inode_ = 0;
+#endif
+    };
+
+}  // namespace volumedeck_mixer
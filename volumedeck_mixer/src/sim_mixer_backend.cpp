@@ -0,0 +1,408 @@
+#include "sim_mixer_backend.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        // What a Windows session list typically holds, weighted by how often
+        // the app shows up (browsers and chat apps open several sessions).
+        struct ExeWeight {
+            const char* path;
+            double weight;
+        };
+        const ExeWeight kExes[] = {
+                {"C:\\Program Files\\Google\\Chrome\\Application\\chrome.exe", 14},
+                {"C:\\Program Files (x86)\\Microsoft\\Edge\\Application\\msedge.exe", 8},
+                {"C:\\Program Files (x86)\\Microsoft\\EdgeWebView\\Application\\msedgewebview2.exe", 3},
+                {"C:\\Program Files\\Mozilla Firefox\\firefox.exe", 6},
+                {"C:\\Users\\user\\AppData\\Roaming\\Spotify\\Spotify.exe", 5},
+                {"C:\\Users\\user\\AppData\\Local\\Discord\\app-1.0.9170\\Discord.exe", 6},
+                {"C:\\Program Files\\WindowsApps\\MSTeams_24193\\ms-teams.exe", 4},
+                {"C:\\Users\\user\\AppData\\Roaming\\Zoom\\bin\\Zoom.exe", 3},
+                {"C:\\Users\\user\\AppData\\Local\\slack\\app-4.41.97\\slack.exe", 3},
+                {"C:\\Users\\user\\AppData\\Roaming\\Telegram Desktop\\Telegram.exe", 2},
+                {"C:\\Program Files\\WindowsApps\\WhatsApp_2.24\\WhatsApp.exe", 2},
+                {"C:\\Program Files (x86)\\Steam\\steam.exe", 2},
+                {"C:\\Program Files (x86)\\Steam\\bin\\cef\\cef.win7x64\\steamwebhelper.exe", 3},
+                {"C:\\Program Files\\obs-studio\\bin\\64bit\\obs64.exe", 2},
+                {"C:\\Program Files\\VideoLAN\\VLC\\vlc.exe", 2},
+                {"C:\\Program Files\\MPC-HC\\mpc-hc64.exe", 1},
+                {"C:\\Program Files (x86)\\foobar2000\\foobar2000.exe", 1},
+                {"C:\\Program Files\\WindowsApps\\AppleInc.AppleMusicWin\\AppleMusic.exe", 1},
+                {"C:\\Users\\user\\AppData\\Local\\Programs\\Microsoft VS Code\\Code.exe", 2},
+                {"C:\\Windows\\explorer.exe", 1},
+                {"C:\\Program Files\\LGHUB\\lghub.exe", 1},
+                {"C:\\Riot Games\\VALORANT\\live\\ShooterGame\\Binaries\\Win64\\VALORANT-Win64-Shipping.exe", 2},
+                {"C:\\Riot Games\\League of Legends\\League of Legends.exe", 1},
+                {"C:\\Program Files (x86)\\Steam\\steamapps\\common\\Counter-Strike Global Offensive\\game\\bin\\win64\\cs2.exe", 2},
+                {"C:\\Program Files (x86)\\Steam\\steamapps\\common\\ELDEN RING\\Game\\eldenring.exe", 1},
+                {"C:\\Program Files\\Epic Games\\Fortnite\\FortniteGame\\Binaries\\Win64\\FortniteClient-Win64-Shipping.exe", 1},
+                {"C:\\Program Files (x86)\\Epic Games\\Launcher\\Portal\\Binaries\\Win64\\EpicGamesLauncher.exe", 1},
+                {"C:\\Program Files (x86)\\Battle.net\\Battle.net.exe", 1},
+                {"C:\\Program Files\\Java\\jre-1.8\\bin\\javaw.exe", 1},
+        };
+        constexpr double kLongTail = 0.15;  // share of one-off tools ("tool123.exe")
+
+        const char* const kDevices[] = {
+                "Speakers (Realtek(R) Audio)",
+                "Headphones (USB Audio Device)",
+                "Microphone (USB Audio Device)",
+        };
+
+        bool SameDevice(const std::string& a, const char* b) {
+            size_t i = 0;
+            for (; i < a.size() && b[i]; i++) {
+                char x = a[i], y = b[i];
+                if (x >= 'A' && x <= 'Z') x = (char)(x - 'A' + 'a');
+                if (y >= 'A' && y <= 'Z') y = (char)(y - 'A' + 'a');
+                if (x != y) return false;
+            }
+            return i == a.size() && !b[i];
+        }
+
+        bool ParseLatency(const std::string& v, SimLatency* out) {
+            char* end = nullptr;
+            out->median_us = strtod(v.c_str(), &end);
+            out->p99_us = out->median_us;
+            if (end == v.c_str()) return false;
+            if (*end == '/') {
+                const char* p99 = end + 1;
+                out->p99_us = strtod(p99, &end);
+                if (end == p99) return false;
+            }
+            return *end == '\0' && out->median_us >= 0.0;
+        }
+
+    }  // namespace
+
+    bool ParseSimMixerSpec(const std::string& spec, SimMixerConfig* out, std::string* error) {
+        size_t at = 0;
+        while (at < spec.size()) {
+            size_t comma = spec.find(',', at);
+            if (comma == std::string::npos) comma = spec.size();
+            const std::string item = spec.substr(at, comma - at);
+            at = comma + 1;
+            if (item.empty()) continue;
+
+            const size_t eq = item.find('=');
+            const std::string key = item.substr(0, eq);
+            const std::string value = eq == std::string::npos ? "" : item.substr(eq + 1);
+            char* end = nullptr;
+            bool ok = !value.empty();
+            if (key == "sessions") {
+                out->sessions = (size_t)strtoul(value.c_str(), &end, 10);
+                ok = ok && *end == '\0';
+            } else if (key == "churn") {
+                out->churn_per_second = strtod(value.c_str(), &end);
+                ok = ok && *end == '\0' && out->churn_per_second >= 0.0;
+            } else if (key == "latency") {
+                ok = ok && ParseLatency(value, &out->call_latency);
+            } else if (key == "list_latency") {
+                ok = ok && ParseLatency(value, &out->list_latency);
+            } else if (key == "fail") {
+                out->failure_rate = strtod(value.c_str(), &end);
+                ok = ok && *end == '\0' && out->failure_rate >= 0.0 && out->failure_rate <= 1.0;
+            } else if (key == "seed") {
+                out->seed = (uint32_t)strtoul(value.c_str(), &end, 10);
+                ok = ok && *end == '\0';
+            } else if (key == "realtime") {
+                out->realtime = value != "0";
+            } else {
+                ok = false;
+            }
+            if (!ok) {
+                if (error) *error = "bad sim backend option '" + item + "'";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // ---------- latency ----------
+
+    SimLatencyModel::SimLatencyModel(const SimLatency& l) : median_us_(std::max(0.0, l.median_us)) {
+        if (median_us_ > 0.0 && l.p99_us > median_us_) {
+            mu_ = std::log(median_us_);
+            sigma_ = (std::log(l.p99_us) - mu_) / 2.3263478740;  // z(0.99)
+        }
+    }
+
+    double SimLatencyModel::SampleUs(std::mt19937_64& rng) {
+        if (sigma_ <= 0.0) return median_us_;
+        std::normal_distribution<double> n(mu_, sigma_);
+        return std::exp(n(rng));
+    }
+
+    // ---------- backend ----------
+
+    SimMixerBackend::SimMixerBackend(const SimMixerConfig& config)
+        : config_(config),
+          rng_(config.seed),
+          list_model_(config.list_latency),
+          call_model_(config.call_latency),
+          pumped_(std::chrono::steady_clock::now()) {
+        std::lock_guard<std::mutex> lock(mu_);
+        AudioSession system;
+        system.id = "sim-system";
+        system.exe_name = "system";
+        system.display_name = "System Sounds";
+        system.system = true;
+        by_id_[system.id] = 0;
+        sessions_.push_back(system);
+        levels_.push_back(0.05f);
+        for (size_t i = 0; i < config_.sessions; i++) StartSessionLocked();
+        if (config_.churn_per_second > 0.0) {
+            next_churn_ = std::exponential_distribution<double>(config_.churn_per_second)(rng_);
+        }
+    }
+
+    void SimMixerBackend::StartSessionLocked() {
+        static const std::vector<double> weights = [] {
+            std::vector<double> w;
+            for (const ExeWeight& e : kExes) w.push_back(e.weight);
+            return w;
+        }();
+        AudioSession s;
+        s.id = "sim-" + std::to_string(next_id_++);
+        s.pid = next_pid_++;
+        if (std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < kLongTail) {
+            s.exe_path = "C:\\Tools\\tool" + std::to_string(rng_() % 1000) + ".exe";
+        } else {
+            std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+            s.exe_path = kExes[pick(rng_)].path;
+        }
+        s.exe_name = ExeBasenameLower(s.exe_path);
+        s.display_name = s.exe_name;
+        s.volume = 1.0f;
+
+        by_id_[s.id] = sessions_.size();
+        sessions_.push_back(std::move(s));
+        // Most sessions are near silent, a few are loud.
+        const float u = std::uniform_real_distribution<float>(0.0f, 1.0f)(rng_);
+        levels_.push_back(u * u * u);
+        generation_++;
+    }
+
+    void SimMixerBackend::EndSessionLocked(size_t index) {
+        by_id_.erase(sessions_[index].id);
+        if (index + 1 != sessions_.size()) {
+            sessions_[index] = std::move(sessions_.back());
+            levels_[index] = levels_.back();
+            by_id_[sessions_[index].id] = index;
+        }
+        sessions_.pop_back();
+        levels_.pop_back();
+        generation_++;
+    }
+
+    void SimMixerBackend::AdvanceLocked(double seconds) {
+        sim_time_ += seconds;
+        if (config_.churn_per_second <= 0.0) return;
+        std::exponential_distribution<double> gap(config_.churn_per_second);
+        while (next_churn_ <= sim_time_) {
+            if (sessions_.size() > 1) {
+                EndSessionLocked(1 + (size_t)(rng_() % (sessions_.size() - 1)));
+                stats_.sessions_ended++;
+            }
+            StartSessionLocked();
+            stats_.sessions_started++;
+            next_churn_ += gap(rng_);
+        }
+    }
+
+    void SimMixerBackend::PumpLocked() {
+        if (!config_.realtime) return;
+        const auto now = std::chrono::steady_clock::now();
+        AdvanceLocked(std::chrono::duration<double>(now - pumped_).count());
+        pumped_ = now;
+    }
+
+    void SimMixerBackend::Advance(double seconds) {
+        std::lock_guard<std::mutex> lock(mu_);
+        AdvanceLocked(seconds);
+    }
+
+    void SimMixerBackend::Churn(size_t n) {
+        std::lock_guard<std::mutex> lock(mu_);
+        for (size_t i = 0; i < n; i++) {
+            if (sessions_.size() > 1) {
+                EndSessionLocked(1 + (size_t)(rng_() % (sessions_.size() - 1)));
+                stats_.sessions_ended++;
+            }
+            StartSessionLocked();
+            stats_.sessions_started++;
+        }
+    }
+
+    SimMixerBackend::Call SimMixerBackend::EnterLocked(SimLatencyModel& model) {
+        PumpLocked();
+        Call c;
+        c.latency_ns = (uint64_t)(model.SampleUs(rng_) * 1000.0);
+        c.ok = config_.failure_rate <= 0.0 ||
+               std::uniform_real_distribution<double>(0.0, 1.0)(rng_) >= config_.failure_rate;
+        if (!c.ok) stats_.failures++;
+        stats_.injected_ns += c.latency_ns;
+        return c;
+    }
+
+    void SimMixerBackend::Spend(uint64_t ns) {
+        if (ns == 0) return;
+        const auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds(ns);
+        // Sleeping overshoots by tens of microseconds; spin the short ones.
+        if (ns > 200000) std::this_thread::sleep_for(std::chrono::nanoseconds(ns - 100000));
+        while (std::chrono::steady_clock::now() < until) {
+        }
+    }
+
+    bool SimMixerBackend::ListSessions(std::vector<AudioSession>* out) {
+        Call c;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stats_.list_calls++;
+            c = EnterLocked(list_model_);
+            if (c.ok) {
+                std::uniform_real_distribution<float> jitter(0.5f, 1.0f);
+                for (size_t i = 0; i < sessions_.size(); i++) sessions_[i].peak = levels_[i] * jitter(rng_);
+                *out = sessions_;
+            } else {
+                out->clear();
+            }
+        }
+        Spend(c.latency_ns);
+        return c.ok;
+    }
+
+    bool SimMixerBackend::GetMaster(float* volume, bool* mute, float* peak) {
+        Call c;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stats_.get_calls++;
+            c = EnterLocked(call_model_);
+            if (volume) *volume = master_volume_;
+            if (mute) *mute = master_mute_;
+            if (peak) *peak = master_mute_ ? 0.0f : std::uniform_real_distribution<float>(0.2f, 0.6f)(rng_);
+        }
+        Spend(c.latency_ns);
+        return c.ok;
+    }
+
+    bool SimMixerBackend::SetMasterVolume(float volume) {
+        Call c;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stats_.set_calls++;
+            c = EnterLocked(call_model_);
+            if (c.ok) master_volume_ = std::clamp(volume, 0.0f, 1.0f);
+        }
+        Spend(c.latency_ns);
+        return c.ok;
+    }
+
+    bool SimMixerBackend::SetMasterMute(bool mute) {
+        Call c;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stats_.set_calls++;
+            c = EnterLocked(call_model_);
+            if (c.ok) master_mute_ = mute;
+        }
+        Spend(c.latency_ns);
+        return c.ok;
+    }
+
+    bool SimMixerBackend::SetSessionVolume(const std::string& id, float volume) {
+        Call c;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stats_.set_calls++;
+            c = EnterLocked(call_model_);
+            auto it = by_id_.find(id);
+            // A session that ended since the caller listed it, as in real life.
+            if (it == by_id_.end()) {
+                c.ok = false;
+            } else if (c.ok) {
+                sessions_[it->second].volume = std::clamp(volume, 0.0f, 1.0f);
+            }
+        }
+        Spend(c.latency_ns);
+        return c.ok;
+    }
+
+    bool SimMixerBackend::SetSessionMute(const std::string& id, bool mute) {
+        Call c;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stats_.set_calls++;
+            c = EnterLocked(call_model_);
+            auto it = by_id_.find(id);
+            if (it == by_id_.end()) {
+                c.ok = false;
+            } else if (c.ok) {
+                sessions_[it->second].mute = mute;
+            }
+        }
+        Spend(c.latency_ns);
+        return c.ok;
+    }
+
+    bool SimMixerBackend::SetInputVolume(float volume) {
+        Call c;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stats_.set_calls++;
+            c = EnterLocked(call_model_);
+            if (c.ok) input_volume_ = std::clamp(volume, 0.0f, 1.0f);
+        }
+        Spend(c.latency_ns);
+        return c.ok;
+    }
+
+    bool SimMixerBackend::SetDeviceVolume(const std::string& name, float) {
+        Call c;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stats_.set_calls++;
+            c = EnterLocked(call_model_);
+            bool found = false;
+            for (const char* d : kDevices) found = found || SameDevice(name, d);
+            c.ok = c.ok && found;
+        }
+        Spend(c.latency_ns);
+        return c.ok;
+    }
+
+    uint32_t SimMixerBackend::ForegroundPid() {
+        std::lock_guard<std::mutex> lock(mu_);
+        PumpLocked();
+        return sessions_.size() > 1 ? sessions_[1].pid : 0;
+    }
+
+    uint64_t SimMixerBackend::session_generation() const {
+        // Churn happens inside the other calls, so a mapper sees the bump
+        // on its next look, after its cached ids may already have gone stale.
+        std::lock_guard<std::mutex> lock(mu_);
+        return generation_;
+    }
+
+    SimMixerStats SimMixerBackend::stats() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return stats_;
+    }
+
+    size_t SimMixerBackend::session_count() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return sessions_.size();
+    }
+
+    float SimMixerBackend::session_volume(const std::string& id) const {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = by_id_.find(id);
+        return it == by_id_.end() ? -1.0f : sessions_[it->second].volume;
+    }
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mixer_backend.h"
+
+namespace volumedeck_mixer {
+
+    // Per-call latency, log-normal: what a busy audio server or a COM call
+    // into another apartment looks like. All zero means instant.
+    struct SimLatency {
+        double median_us = 0.0;
+        double p99_us = 0.0;  // <= median: always exactly the median
+    };
+
+    struct SimMixerConfig {
+        size_t sessions = 40;           // steady-state count, plus the system session
+        double churn_per_second = 0.0;  // session exits per second, each replaced by a new app
+        SimLatency list_latency;        // ListSessions()
+        SimLatency call_latency;        // every other call
+        double failure_rate = 0.0;      // fraction of calls that fail (after their latency)
+        bool realtime = true;           // churn follows the wall clock; false: only Advance()
+        uint32_t seed = 1;
+    };
+
+    // "sessions=500,churn=5,latency=200/2000,list_latency=1000/8000,fail=0.01,
+    // seed=3,realtime=0". Latencies are median/p99 in microseconds; unset
+    // keys keep their defaults.
+    bool ParseSimMixerSpec(const std::string& spec, SimMixerConfig* out, std::string* error = nullptr);
+
+    class SimLatencyModel {
+    public:
+        explicit SimLatencyModel(const SimLatency& l);
+        double SampleUs(std::mt19937_64& rng);
+
+    private:
+        double median_us_;
+        double mu_ = 0.0;
+        double sigma_ = 0.0;
+    };
+
+    struct SimMixerStats {
+        uint64_t list_calls = 0;
+        uint64_t set_calls = 0;
+        uint64_t get_calls = 0;
+        uint64_t failures = 0;
+        uint64_t sessions_started = 0;  // after the initial population
+        uint64_t sessions_ended = 0;
+        uint64_t injected_ns = 0;       // total latency added
+    };
+
+    // Synthetic mixer for scale and load testing: hundreds of sessions with
+    // realistic exe names, start/stop churn, slow calls and failures, all
+    // reproducible from the seed. A drop-in MixerBackend ("sim" or
+    // "sim:<spec>" in CreateMixerBackend), so the engine, mapper, state
+    // channel and fast path can be driven at scale on any platform.
+    //
+    // Thread-safe. Latency is spent outside the lock, so concurrent callers
+    // overlap like they would against a real server.
+    class SimMixerBackend : public MixerBackend {
+    public:
+        explicit SimMixerBackend(const SimMixerConfig& config = SimMixerConfig());
+
+        const char* name() const override { return "sim"; }
+
+        bool ListSessions(std::vector<AudioSession>* out) override;
+        bool GetMaster(float* volume, bool* mute, float* peak) override;
+        bool SetMasterVolume(float volume) override;
+        bool SetMasterMute(bool mute) override;
+        bool SetSessionVolume(const std::string& id, float volume) override;
+        bool SetSessionMute(const std::string& id, bool mute) override;
+        bool SetInputVolume(float volume) override;
+        bool SetDeviceVolume(const std::string& name, float volume) override;
+        uint32_t ForegroundPid() override;
+        uint64_t session_generation() const override;
+
+        // Moves the simulated clock (churn only).
+        void Advance(double seconds);
+        // Ends `n` random app sessions and starts `n` new ones right away.
+        void Churn(size_t n);
+
+        SimMixerStats stats() const;
+        size_t session_count() const;
+        // Missing sessions read as -1.
+        float session_volume(const std::string& id) const;
+        const SimMixerConfig& config() const { return config_; }
+
+    private:
+        struct Call {
+            bool ok;
+            uint64_t latency_ns;
+        };
+
+        Call EnterLocked(SimLatencyModel& model);
+        static void Spend(uint64_t ns);
+        void PumpLocked();
+        void AdvanceLocked(double seconds);
+        void StartSessionLocked();
+        void EndSessionLocked(size_t index);
+
+        const SimMixerConfig config_;
+        mutable std::mutex mu_;
+        std::mt19937_64 rng_;
+        SimLatencyModel list_model_;
+        SimLatencyModel call_model_;
+
+        std::vector<AudioSession> sessions_;  // [0] is the system session
+        std::vector<float> levels_;           // typical peak per session
+        std::unordered_map<std::string, size_t> by_id_;
+        uint64_t next_id_ = 1;
+        uint32_t next_pid_ = 1000;
+        uint64_t generation_ = 1;
+
+        float master_volume_ = 1.0f;
+        bool master_mute_ = false;
+        float input_volume_ = 1.0f;
+
+        double sim_time_ = 0.0;
+        double next_churn_ = 0.0;
+        std::chrono::steady_clock::time_point pumped_;
+
+        SimMixerStats stats_;
+    };
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,15 @@
+#pragma once
+
+// Compile-time SIMD selection shared by the core's hot loops. Every
+// vector path has a scalar tail/fallback, so other targets still build.
+//
+//   VOLUMEDECK_SSE2  x86/x64 (baseline on x64, MSVC and GCC/Clang)
+//   VOLUMEDECK_NEON  ARMv7 with NEON, ARM64 (Windows on ARM, Apple, Linux)
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VOLUMEDECK_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define VOLUMEDECK_NEON 1
+#endif
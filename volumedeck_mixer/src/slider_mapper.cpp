@@ -0,0 +1,269 @@
+#include "slider_mapper.h"
+
+#include <algorithm>
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        // deej re-reads sessions this often when nothing tells it to.
+        constexpr auto kStaleAfter = std::chrono::seconds(2);
+        // ...and at most this often when a target comes up empty.
+        constexpr auto kMissRetry = std::chrono::milliseconds(500);
+
+        std::string Lower(const std::string& s) {
+            std::string out = s;
+            for (char& c : out) {
+                if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+            }
+            return out;
+        }
+
+    }  // namespace
+
+    SliderPlan::SliderPlan(const DeejConfig& config) {
+        Add(config.slider_mapping, true, &sliders_);
+        Add(config.encoder_mapping, true, &encoders_);
+        Add(config.button_mapping, false, &buttons_);
+    }
+
+    void SliderPlan::Add(const std::map<int, std::vector<std::string>>& mapping, bool volume, Targets* out) {
+        for (const auto& kv : mapping) {
+            if (kv.first < 0) continue;
+            if ((size_t)kv.first >= out->size()) out->resize((size_t)kv.first + 1);
+            auto& targets = (*out)[(size_t)kv.first];
+            for (const std::string& name : kv.second) {
+                Target t;
+                t.name = name;
+                t.lower = Lower(name);
+                if (t.lower == "master") {
+                    t.kind = Kind::kMaster;
+                } else if (t.lower == "mic") {
+                    t.kind = Kind::kMic;
+                } else if (t.lower == "system") {
+                    t.kind = Kind::kSystem;
+                } else if (t.lower == "deej.unmapped") {
+                    t.kind = Kind::kUnmapped;
+                } else if (t.lower == "deej.current") {
+                    t.kind = Kind::kCurrent;
+                } else {
+                    t.kind = Kind::kNamed;
+                    if (volume) mapped_.insert(t.lower);
+                }
+                targets.push_back(std::move(t));
+            }
+        }
+    }
+
+    SliderMapper::SliderMapper(MixerBackend* backend) : backend_(backend) {
+        DeejConfig none;
+        none.slider_mapping.clear();
+        plans_.push_back(Compiled{std::make_shared<const SliderPlan>(none), {}, {}, {}, 0});
+        Compile(plans_[0]);
+    }
+
+    void SliderMapper::SetConfig(const DeejConfig& config) { SetPlan(std::make_shared<const SliderPlan>(config)); }
+
+    void SliderMapper::SetPlan(std::shared_ptr<const SliderPlan> plan) {
+        Compiled& c = Find(plan);
+        if (c.resolved != sessions_version_) Compile(c);
+        active_ = (size_t)(&c - plans_.data());
+    }
+
+    void SliderMapper::Prepare(const std::vector<std::shared_ptr<const SliderPlan>>& plans) {
+        std::vector<Compiled> kept;
+        kept.push_back(std::move(plans_[active_]));
+        for (const auto& plan : plans) {
+            if (plan == kept[0].plan) continue;
+            auto it = std::find_if(plans_.begin(), plans_.end(), [&](const Compiled& c) { return c.plan == plan; });
+            kept.push_back(it != plans_.end() && it->plan ? std::move(*it) : Compiled{plan, {}, {}, {}, 0});
+        }
+        plans_ = std::move(kept);
+        active_ = 0;
+        for (Compiled& c : plans_) {
+            if (c.resolved != sessions_version_) Compile(c);
+        }
+    }
+
+    SliderMapper::Compiled& SliderMapper::Find(const std::shared_ptr<const SliderPlan>& plan) {
+        for (Compiled& c : plans_) {
+            if (c.plan == plan) return c;
+        }
+        // An unprepared plan replaces the active one.
+        plans_[active_] = Compiled{plan, {}, {}, {}, 0};
+        return plans_[active_];
+    }
+
+    void SliderMapper::RefreshSessions(bool force) {
+        const auto now = std::chrono::steady_clock::now();
+        const uint64_t gen = backend_->session_generation();
+        if (!force && gen != 0 && gen == generation_) return;
+        if (!force && gen == 0 && now - refreshed_ < kStaleAfter) return;
+
+        std::vector<AudioSession> list;
+        if (!backend_->ListSessions(&list)) return;
+        sessions_ = std::move(list);
+        by_exe_.clear();
+        exe_sessions_.clear();
+        exe_of_pid_.clear();
+        for (uint32_t i = 0; i < (uint32_t)sessions_.size(); i++) {
+            const AudioSession& s = sessions_[i];
+            const auto inserted = by_exe_.emplace(s.exe_name, (uint32_t)exe_sessions_.size());
+            if (inserted.second) exe_sessions_.emplace_back();
+            exe_sessions_[inserted.first->second].push_back(i);
+            if (s.pid != 0) exe_of_pid_[s.pid] = inserted.first->second;
+        }
+        generation_ = gen;
+        refreshed_ = now;
+        sessions_version_++;
+        for (Compiled& c : plans_) Compile(c);
+    }
+
+    void SliderMapper::Compile(Compiled& c) {
+        const SliderPlan& plan = *c.plan;
+        CompileRoutes(plan, plan.sliders_, &c.routes);
+        CompileRoutes(plan, plan.encoders_, &c.encoder_routes);
+        CompileRoutes(plan, plan.buttons_, &c.button_routes);
+        c.resolved = sessions_version_;
+    }
+
+    void SliderMapper::CompileRoutes(const SliderPlan& plan, const SliderPlan::Targets& targets,
+                                     std::vector<Route>* routes) {
+        routes->assign(targets.size(), Route());
+        for (size_t slider = 0; slider < targets.size(); slider++) {
+            Route& r = (*routes)[slider];
+            for (const Target& t : targets[slider]) {
+                switch (t.kind) {
+                    case Kind::kMaster:
+                        r.master = true;
+                        break;
+                    case Kind::kMic:
+                        r.mic = true;
+                        break;
+                    case Kind::kCurrent:
+                        r.current = true;
+                        break;
+                    case Kind::kSystem:
+                        for (uint32_t i = 0; i < (uint32_t)sessions_.size(); i++) {
+                            if (sessions_[i].system) r.sessions.push_back(i);
+                        }
+                        break;
+                    case Kind::kUnmapped:
+                        for (uint32_t i = 0; i < (uint32_t)sessions_.size(); i++) {
+                            if (!sessions_[i].system && !plan.mapped_.count(sessions_[i].exe_name)) r.sessions.push_back(i);
+                        }
+                        break;
+                    case Kind::kNamed: {
+                        auto it = by_exe_.find(t.lower);
+                        if (it == by_exe_.end()) {
+                            // Not a running process: maybe an endpoint's friendly name.
+                            r.missing = true;
+                            r.devices.push_back(&t.name);
+                        } else {
+                            const auto& indices = exe_sessions_[it->second];
+                            r.sessions.insert(r.sessions.end(), indices.begin(), indices.end());
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    const SliderMapper::Route* SliderMapper::Resolve(std::vector<Route> Compiled::*routes, size_t index) {
+        if (index >= (plans_[active_].*routes).size()) return nullptr;
+        RefreshSessions();
+        // A process target that found nothing may have just started.
+        if ((plans_[active_].*routes)[index].missing && std::chrono::steady_clock::now() - refreshed_ >= kMissRetry) {
+            RefreshSessions(true);
+        }
+        return &(plans_[active_].*routes)[index];
+    }
+
+    size_t SliderMapper::Apply(size_t slider, float value) {
+        const Route* r = Resolve(&Compiled::routes, slider);
+        return r ? Write(*r, value) : 0;
+    }
+
+    size_t SliderMapper::ApplyEncoder(size_t encoder, float value) {
+        const Route* r = Resolve(&Compiled::encoder_routes, encoder);
+        return r ? Write(*r, value) : 0;
+    }
+
+    std::vector<SliderMapper::Route> SliderMapper::Compiled::*SliderMapper::RoutesOf(ChannelKind kind) {
+        switch (kind) {
+            case ChannelKind::kEncoder: return &Compiled::encoder_routes;
+            case ChannelKind::kButton: return &Compiled::button_routes;
+            default: return &Compiled::routes;
+        }
+    }
+
+    bool SliderMapper::Level(ChannelKind kind, size_t index, float* volume, bool* mute) {
+        const Route* r = Resolve(RoutesOf(kind), index);
+        if (!r) return false;
+        if (r->master) {
+            float peak = 0.0f;
+            if (backend_->GetMaster(volume, mute, &peak)) return true;
+        }
+        if (r->sessions.empty()) return false;
+        *volume = sessions_[r->sessions[0]].volume;
+        *mute = sessions_[r->sessions[0]].mute;
+        return true;
+    }
+
+    void SliderMapper::ReadLevels() {
+        if (!backend_->ListSessions(&levels_)) return;
+        bool same = levels_.size() == sessions_.size();
+        for (size_t i = 0; same && i < levels_.size(); i++) same = levels_[i].id == sessions_[i].id;
+        if (!same) {
+            RefreshSessions(true);
+            return;
+        }
+        for (size_t i = 0; i < levels_.size(); i++) {
+            sessions_[i].volume = levels_[i].volume;
+            sessions_[i].mute = levels_[i].mute;
+        }
+    }
+
+    size_t SliderMapper::ToggleMute(size_t button) {
+        if (button >= plans_[active_].button_routes.size()) return 0;
+        // Mute states change outside our writes (the app, the system
+        // mixer): read them fresh. Presses are rare enough to afford it.
+        RefreshSessions(true);
+        const Route& r = plans_[active_].button_routes[button];
+
+        bool muted = false;
+        if (r.master) {
+            float volume = 0.0f, peak = 0.0f;
+            backend_->GetMaster(&volume, &muted, &peak);
+        } else if (!r.sessions.empty()) {
+            muted = sessions_[r.sessions[0]].mute;
+        } else {
+            return 0;
+        }
+        size_t writes = 0;
+        if (r.master) writes += backend_->SetMasterMute(!muted) ? 1 : 0;
+        for (uint32_t i : r.sessions) writes += backend_->SetSessionMute(sessions_[i].id, !muted) ? 1 : 0;
+        return writes;
+    }
+
+    size_t SliderMapper::Write(const Route& r, float value) {
+        size_t writes = 0;
+        if (r.master) writes += backend_->SetMasterVolume(value) ? 1 : 0;
+        if (r.mic) writes += backend_->SetInputVolume(value) ? 1 : 0;
+        writes += WriteSessions(r.sessions, value);
+        for (const std::string* name : r.devices) writes += backend_->SetDeviceVolume(*name, value) ? 1 : 0;
+        if (r.current) {
+            auto it = exe_of_pid_.find(backend_->ForegroundPid());
+            if (it != exe_of_pid_.end()) writes += WriteSessions(exe_sessions_[it->second], value);
+        }
+        return writes;
+    }
+
+    size_t SliderMapper::WriteSessions(const std::vector<uint32_t>& indices, float value) {
+        size_t writes = 0;
+        for (uint32_t i : indices) writes += backend_->SetSessionVolume(sessions_[i].id, value) ? 1 : 0;
+        return writes;
+    }
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "deej_config.h"
+#include "deej_protocol.h"
+#include "mixer_backend.h"
+
+namespace volumedeck_mixer {
+
+    // A config's slider, encoder and button mappings with their target names
+    // parsed: the part of a config that doesn't depend on which sessions
+    // exist. Immutable once built, so profiles compile theirs ahead of time
+    // and share it across threads.
+    class SliderPlan {
+    public:
+        explicit SliderPlan(const DeejConfig& config);
+
+        size_t slider_count() const { return sliders_.size(); }
+
+    private:
+        friend class SliderMapper;
+
+        enum class Kind { kMaster, kMic, kSystem, kUnmapped, kCurrent, kNamed };
+        struct Target {
+            Kind kind;
+            std::string name;   // as configured
+            std::string lower;  // process match key
+        };
+
+        using Targets = std::vector<std::vector<Target>>;  // by channel index
+
+        // Encoders set volume like sliders, so their names count as mapped;
+        // buttons only mute.
+        void Add(const std::map<int, std::vector<std::string>>& mapping, bool volume, Targets* out);
+
+        Targets sliders_;
+        Targets encoders_;
+        Targets buttons_;
+        std::unordered_set<std::string> mapped_;  // lowercase names some slider or encoder sets
+    };
+
+    // Turns slider moves into mixer writes using deej's target names:
+    //
+    //   master          default output endpoint
+    //   mic             default input endpoint
+    //   system          the system sounds session
+    //   deej.unmapped   every session no slider names (not master/system/mic)
+    //   deej.current    sessions of the foreground process
+    //   anything else   sessions of that process (case-insensitive), or an
+    //                   endpoint with that friendly name
+    //
+    // The session list is cached and refreshed when the backend reports a
+    // change, every couple of seconds for backends that can't, and when a
+    // process target finds nothing (it may have just started).
+    //
+    // Names are only looked at when the plan or the session list changes:
+    // both compile into one route per slider (and encoder, and button)
+    // holding session indices and endpoint flags, so Apply() does no string
+    // work.
+    class SliderMapper {
+    public:
+        explicit SliderMapper(MixerBackend* backend);
+
+        void SetConfig(const DeejConfig& config);
+        // Switches to `plan`. Instant for a prepared plan: its routes are
+        // already resolved against the current sessions.
+        void SetPlan(std::shared_ptr<const SliderPlan> plan);
+        // Keeps routes for these plans (and the active one) resolved from
+        // now on; others are dropped.
+        void Prepare(const std::vector<std::shared_ptr<const SliderPlan>>& plans);
+
+        // Returns the number of backend writes made.
+        size_t Apply(size_t slider, float value);
+        // Sets an encoder's targets to `value`, like a slider.
+        size_t ApplyEncoder(size_t encoder, float value);
+        // Volume and mute of the channel's first target that can be read
+        // (master or a session), from the cached session list: where an
+        // encoder starts turning from, what the board is shown. False if
+        // it has none.
+        bool Level(ChannelKind kind, size_t index, float* volume, bool* mute);
+        // Re-reads session volumes and mutes for Level(); routes are only
+        // recompiled if the session list itself changed.
+        void ReadLevels();
+        // Mutes the button's master and session targets, or unmutes them if
+        // the first one is muted.
+        size_t ToggleMute(size_t button);
+
+        void RefreshSessions(bool force = false);
+        const std::vector<AudioSession>& sessions() const { return sessions_; }
+
+    private:
+        using Kind = SliderPlan::Kind;
+        using Target = SliderPlan::Target;
+
+        // Everything one slider writes, resolved against sessions_.
+        struct Route {
+            bool master = false;
+            bool mic = false;
+            bool current = false;               // deej.current
+            bool missing = false;               // a process target matched nothing
+            std::vector<uint32_t> sessions;     // indices into sessions_
+            std::vector<const std::string*> devices;  // unmatched names, tried as endpoints
+        };
+
+        struct Compiled {
+            std::shared_ptr<const SliderPlan> plan;
+            std::vector<Route> routes;  // by slider index
+            std::vector<Route> encoder_routes;
+            std::vector<Route> button_routes;
+            uint64_t resolved = 0;      // sessions_version_ the routes match
+        };
+
+        Compiled& Find(const std::shared_ptr<const SliderPlan>& plan);
+        void Compile(Compiled& c);
+        void CompileRoutes(const SliderPlan& plan, const SliderPlan::Targets& targets, std::vector<Route>* routes);
+        // The active plan's route, with sessions refreshed as needed; null
+        // if the channel isn't mapped.
+        const Route* Resolve(std::vector<Route> Compiled::*routes, size_t index);
+        static std::vector<Route> Compiled::*RoutesOf(ChannelKind kind);
+        size_t Write(const Route& r, float value);
+        size_t WriteSessions(const std::vector<uint32_t>& indices, float value);
+
+        MixerBackend* const backend_;
+        std::vector<Compiled> plans_;  // [active_] dispatches
+        size_t active_ = 0;
+
+        std::vector<AudioSession> sessions_;
+        std::vector<AudioSession> levels_;  // ReadLevels() scratch
+        std::unordered_map<std::string, uint32_t> by_exe_;  // -> exe_sessions_ index
+        std::vector<std::vector<uint32_t>> exe_sessions_;
+        std::unordered_map<uint32_t, uint32_t> exe_of_pid_;  // -> exe_sessions_ index
+        uint64_t sessions_version_ = 1;
+        uint64_t generation_ = 0;
+        std::chrono::steady_clock::time_point refreshed_{};
+    };
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,277 @@
+#include "state_channel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <signal.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        // A reader gives up after this many collisions; a live writer is
+        // in and out of a frame in microseconds.
+        constexpr int kReadAttempts = 10000;
+
+        size_t Align(size_t n) { return (n + 7) & ~size_t(7); }
+
+        uint32_t CurrentPid() {
+#ifdef _WIN32
+            return (uint32_t)GetCurrentProcessId();
+#else
+            return (uint32_t)getpid();
+#endif
+        }
+
+        bool ProcessAlive(uint32_t pid) {
+            if (pid == 0) return false;
+#ifdef _WIN32
+            HANDLE h = OpenProcess(SYNCHRONIZE, FALSE, (DWORD)pid);
+            if (!h) return GetLastError() == ERROR_ACCESS_DENIED;
+            const bool alive = WaitForSingleObject(h, 0) == WAIT_TIMEOUT;
+            CloseHandle(h);
+            return alive;
+#else
+            return kill((pid_t)pid, 0) == 0 || errno == EPERM;
+#endif
+        }
+
+        // A region left by a writer that is gone: closed, crashed, or killed
+        // before it got as far as the header.
+        bool StaleChannel(const uint8_t* data, size_t size) {
+            if (size < sizeof(StateChannelHeader)) return true;
+            const auto* h = reinterpret_cast<const StateChannelHeader*>(data);
+            return h->live.load(std::memory_order_acquire) == 0 || !ProcessAlive(h->writer_pid);
+        }
+
+        template <typename T>
+        T* At(StateChannelHeader* h, uint32_t offset) {
+            return reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(h) + offset);
+        }
+
+        template <typename T>
+        const T* At(const StateChannelHeader* h, uint32_t offset) {
+            return reinterpret_cast<const T*>(reinterpret_cast<const uint8_t*>(h) + offset);
+        }
+
+        void PutString(std::vector<uint8_t>& out, const std::string& s) {
+            const uint16_t n = (uint16_t)std::min<size_t>(s.size(), 0xFFFF);
+            out.push_back((uint8_t)(n & 0xFF));
+            out.push_back((uint8_t)(n >> 8));
+            out.insert(out.end(), s.begin(), s.begin() + n);
+        }
+
+        bool GetString(const uint8_t*& p, const uint8_t* end, std::string* s) {
+            if (end - p < 2) return false;
+            const size_t n = (size_t)p[0] | ((size_t)p[1] << 8);
+            p += 2;
+            if ((size_t)(end - p) < n) return false;
+            s->assign(reinterpret_cast<const char*>(p), n);
+            p += n;
+            return true;
+        }
+
+    }  // namespace
+
+    StateChannelWriter::StateChannelWriter(size_t capacity, size_t roster_bytes)
+        : capacity_(std::max<size_t>(capacity, 1)),
+          roster_bytes_(Align(roster_bytes)),
+          bytes_(sizeof(StateChannelHeader) + 4 * Align(capacity_ * 4) + roster_bytes_) {}
+
+    bool StateChannelWriter::Open(const std::string& name) {
+        Close();
+        void* mem = nullptr;
+        if (name.empty()) {
+            storage_.reset(new uint64_t[bytes_ / 8]());
+            mem = storage_.get();
+        } else {
+            // Another live writer keeps its channel.
+            if (!region_.Create(name, bytes_, StaleChannel)) return false;
+            mem = region_.data();
+        }
+
+        header_ = new (mem) StateChannelHeader();
+        const uint32_t array = (uint32_t)Align(capacity_ * 4);
+        header_->capacity = (uint32_t)capacity_;
+        header_->roster_bytes = (uint32_t)roster_bytes_;
+        header_->volume_offset = sizeof(StateChannelHeader);
+        header_->peak_offset = header_->volume_offset + array;
+        header_->flags_offset = header_->peak_offset + array;
+        header_->pid_offset = header_->flags_offset + array;
+        header_->roster_offset = header_->pid_offset + array;
+        header_->writer_pid = CurrentPid();
+        header_->magic = kStateChannelMagic;
+        header_->version = kStateChannelVersion;
+        // Last: readers reject a region whose writer isn't live yet.
+        header_->live.store(1, std::memory_order_release);
+        return true;
+    }
+
+    void StateChannelWriter::Close() {
+        if (header_) header_->live.store(0, std::memory_order_release);
+        header_ = nullptr;
+        region_.Close();
+        storage_.reset();
+    }
+
+    bool StateChannelWriter::PublishRoster(const std::vector<StateRosterEntry>& roster) {
+        if (!header_) return false;
+        scratch_.clear();
+        const size_t n = std::min(roster.size(), capacity_);
+        for (size_t i = 0; i < n; i++) {
+            PutString(scratch_, roster[i].id);
+            PutString(scratch_, roster[i].exe_name);
+            PutString(scratch_, roster[i].display_name);
+        }
+        if (scratch_.size() > roster_bytes_) return false;
+
+        const uint64_t s = header_->roster_seq.load(std::memory_order_relaxed);
+        header_->roster_seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        if (!scratch_.empty()) memcpy(At<uint8_t>(header_, header_->roster_offset), scratch_.data(), scratch_.size());
+        header_->roster_used.store((uint32_t)scratch_.size(), std::memory_order_relaxed);
+        header_->generation.fetch_add(1, std::memory_order_relaxed);
+        header_->roster_seq.store(s + 2, std::memory_order_release);
+        return true;
+    }
+
+    void StateChannelWriter::PublishFrame(const StateSlot* slots, size_t count) {
+        if (!header_) return;
+        count = std::min(count, capacity_);
+        float* volume = At<float>(header_, header_->volume_offset);
+        float* peak = At<float>(header_, header_->peak_offset);
+        uint32_t* flags = At<uint32_t>(header_, header_->flags_offset);
+        uint32_t* pid = At<uint32_t>(header_, header_->pid_offset);
+
+        const uint64_t s = header_->seq.load(std::memory_order_relaxed);
+        header_->seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < count; i++) {
+            volume[i] = slots[i].volume;
+            peak[i] = slots[i].peak;
+            flags[i] = slots[i].flags;
+            pid[i] = slots[i].pid;
+        }
+        header_->count.store((uint32_t)count, std::memory_order_relaxed);
+        header_->frame_generation.store(header_->generation.load(std::memory_order_relaxed),
+                                        std::memory_order_relaxed);
+        header_->frame.fetch_add(1, std::memory_order_relaxed);
+        header_->seq.store(s + 2, std::memory_order_release);
+    }
+
+    // ---------- reader ----------
+
+    bool StateChannelReader::Open(const std::string& name) {
+        Close();
+        if (!region_.Open(name)) return false;
+        if (!Attach(region_.data(), region_.size())) {
+            region_.Close();
+            return false;
+        }
+        return true;
+    }
+
+    bool StateChannelReader::Attach(const void* block, size_t size) {
+        header_ = nullptr;
+        size_ = 0;
+        if (!block || size < sizeof(StateChannelHeader)) return false;
+        const auto* h = static_cast<const StateChannelHeader*>(block);
+        if (h->live.load(std::memory_order_acquire) == 0) return false;
+        if (h->magic != kStateChannelMagic || h->version != kStateChannelVersion) return false;
+        const uint64_t array = Align((size_t)h->capacity * 4);
+        if (h->volume_offset < sizeof(StateChannelHeader) || h->pid_offset + array > h->roster_offset ||
+            (uint64_t)h->roster_offset + h->roster_bytes > size) {
+            return false;
+        }
+        header_ = h;
+        size_ = size;
+        return true;
+    }
+
+    void StateChannelReader::Close() {
+        header_ = nullptr;
+        size_ = 0;
+        region_.Close();
+    }
+
+    bool StateChannelReader::writer_live() const {
+        return header_ && header_->live.load(std::memory_order_acquire) != 0;
+    }
+
+    bool StateChannelReader::ReadFrame(StateFrame* out) const {
+        if (!header_) return false;
+        const float* volume = At<float>(header_, header_->volume_offset);
+        const float* peak = At<float>(header_, header_->peak_offset);
+        const uint32_t* flags = At<uint32_t>(header_, header_->flags_offset);
+        const uint32_t* pid = At<uint32_t>(header_, header_->pid_offset);
+        out->slots.reserve(header_->capacity);
+
+        for (int attempt = 0; attempt < kReadAttempts; attempt++) {
+            const uint64_t s1 = header_->seq.load(std::memory_order_acquire);
+            if (s1 & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            const size_t count = std::min<size_t>(header_->count.load(std::memory_order_relaxed), header_->capacity);
+            out->slots.resize(count);
+            for (size_t i = 0; i < count; i++) {
+                StateSlot& s = out->slots[i];
+                s.volume = volume[i];
+                s.peak = peak[i];
+                s.flags = flags[i];
+                s.pid = pid[i];
+            }
+            out->frame = header_->frame.load(std::memory_order_relaxed);
+            out->generation = header_->frame_generation.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (header_->seq.load(std::memory_order_relaxed) == s1) return true;
+        }
+        return false;
+    }
+
+    bool StateChannelReader::ReadRoster(std::vector<StateRosterEntry>* out, uint64_t* generation) const {
+        if (!header_) return false;
+        const uint8_t* roster = At<uint8_t>(header_, header_->roster_offset);
+        std::vector<uint8_t> copy;
+        copy.reserve(header_->roster_bytes);
+
+        for (int attempt = 0; attempt < kReadAttempts; attempt++) {
+            const uint64_t s1 = header_->roster_seq.load(std::memory_order_acquire);
+            if (s1 & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            const size_t used = std::min<size_t>(header_->roster_used.load(std::memory_order_relaxed),
+                                                 header_->roster_bytes);
+            copy.assign(roster, roster + used);
+            const uint64_t gen = header_->generation.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (header_->roster_seq.load(std::memory_order_relaxed) != s1) continue;
+
+            out->clear();
+            const uint8_t* p = copy.data();
+            const uint8_t* end = p + copy.size();
+            while (p < end) {
+                StateRosterEntry e;
+                if (!GetString(p, end, &e.id) || !GetString(p, end, &e.exe_name) ||
+                    !GetString(p, end, &e.display_name)) {
+                    return false;
+                }
+                out->push_back(std::move(e));
+            }
+            if (generation) *generation = gen;
+            return true;
+        }
+        return false;
+    }
+
+}  // namespace volumedeck_mixer
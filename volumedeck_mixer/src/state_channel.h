@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "shared_region.h"
+
+namespace volumedeck_mixer {
+
+    // Live mixer state for the UI, read in place over FFI or from another
+    // process through a SharedRegion.
+    //
+    //   StateChannelHeader                128 bytes
+    //   float volume[capacity]            one frame, under `seq`
+    //   float peak[capacity]
+    //   uint32_t flags[capacity]
+    //   uint32_t pid[capacity]            (arrays padded to 8 bytes)
+    //   uint8_t roster[roster_bytes]      under `roster_seq`
+    //
+    // Slot 0 is the default output endpoint, sessions follow. The roster
+    // holds, per slot in use, three length-prefixed UTF-8 strings (u16
+    // little endian length, then bytes): session id, exe name, display
+    // name. Every roster change bumps `generation`; each frame records the
+    // generation its slots belong to, so a reader can tell when its cached
+    // names went stale. Both seqlocks work like MeterHistoryBlock's: odd
+    // while the writer is inside, copy only when even and unchanged.
+    struct StateChannelHeader {
+        uint32_t magic;          // 'VDSC'
+        uint32_t version;
+        uint32_t capacity;
+        uint32_t roster_bytes;
+        uint32_t volume_offset;  // from the start of the header
+        uint32_t peak_offset;
+        uint32_t flags_offset;
+        uint32_t pid_offset;
+        uint32_t roster_offset;
+        uint32_t writer_pid;
+        std::atomic<uint64_t> seq;               // 40
+        std::atomic<uint64_t> frame;             // 48, frames published
+        std::atomic<uint64_t> frame_generation;  // 56
+        std::atomic<uint32_t> count;             // 64, slots in use
+        std::atomic<uint32_t> live;              // 68, 0 once the writer closed
+        std::atomic<uint64_t> roster_seq;        // 72
+        std::atomic<uint64_t> generation;        // 80
+        std::atomic<uint32_t> roster_used;       // 88
+        uint8_t pad[36];
+    };
+
+    static_assert(sizeof(StateChannelHeader) == 128, "state channel layout");
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "state channel is shared across processes");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "state channel is shared across processes");
+
+    constexpr uint32_t kStateChannelMagic = 0x43534456;  // "VDSC" little endian
+    constexpr uint32_t kStateChannelVersion = 1;
+    // Name of the region volumedeckd publishes.
+    constexpr const char* kStateChannelName = "volumedeck_state";
+
+    enum StateSlotFlags : uint32_t {
+        kStateMuted = 1u << 0,
+        kStateSystem = 1u << 1,  // the system sounds session
+        kStateEndpoint = 1u << 2,
+    };
+
+    struct StateSlot {
+        float volume = 0.0f;
+        float peak = 0.0f;
+        uint32_t flags = 0;
+        uint32_t pid = 0;
+    };
+
+    struct StateRosterEntry {
+        std::string id;
+        std::string exe_name;
+        std::string display_name;
+    };
+
+    struct StateFrame {
+        uint64_t frame = 0;
+        uint64_t generation = 0;
+        std::vector<StateSlot> slots;
+    };
+
+    // Single writer. Both Publish calls are wait-free for readers: they
+    // never block the writer and never see a half-written frame.
+    class StateChannelWriter {
+    public:
+        explicit StateChannelWriter(size_t capacity = 128, size_t roster_bytes = 32 * 1024);
+        ~StateChannelWriter() { Close(); }
+
+        StateChannelWriter(const StateChannelWriter&) = delete;
+        StateChannelWriter& operator=(const StateChannelWriter&) = delete;
+
+        // An empty name keeps the channel in private memory (same process,
+        // e.g. the plugin handing it to Dart). A named channel another live
+        // writer holds is refused; one left by a dead writer is replaced.
+        bool Open(const std::string& name = {});
+        void Close();
+
+        // Entries past capacity are dropped; false if the strings don't fit
+        // in roster_bytes (the previous roster stays).
+        bool PublishRoster(const std::vector<StateRosterEntry>& roster);
+        void PublishFrame(const StateSlot* slots, size_t count);
+
+        const StateChannelHeader* header() const { return header_; }
+        size_t size() const { return bytes_; }
+        size_t capacity() const { return capacity_; }
+        uint64_t generation() const { return header_ ? header_->generation.load(std::memory_order_relaxed) : 0; }
+
+    private:
+        const size_t capacity_;
+        const size_t roster_bytes_;
+        const size_t bytes_;
+        SharedRegion region_;
+        std::unique_ptr<uint64_t[]> storage_;
+        StateChannelHeader* header_ = nullptr;
+        std::vector<uint8_t> scratch_;
+    };
+
+    // Copying reader for C++ users; Dart reads the arrays in place.
+    class StateChannelReader {
+    public:
+        // Opens volumedeckd's (or any named) channel.
+        bool Open(const std::string& name);
+        // Reads a block owned by someone else; it must outlive the reader.
+        bool Attach(const void* block, size_t size);
+        void Close();
+
+        bool is_open() const { return header_ != nullptr; }
+        const StateChannelHeader* header() const { return header_; }
+        size_t size() const { return size_; }
+        bool writer_live() const;
+
+        // False if no consistent copy could be taken, e.g. the writer died
+        // inside a frame.
+        bool ReadFrame(StateFrame* out) const;
+        bool ReadRoster(std::vector<StateRosterEntry>* out, uint64_t* generation) const;
+
+    private:
+        SharedRegion region_;
+        const StateChannelHeader* header_ = nullptr;
+        size_t size_ = 0;
+    };
+
+}  // namespace volumedeck_mixer
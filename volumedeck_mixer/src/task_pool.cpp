@@ -0,0 +1,65 @@
+#include "task_pool.h"
+
+#include <algorithm>
+
+namespace volumedeck_mixer {
+
+    TaskPool::TaskPool(unsigned threads, std::function<void()> on_thread_start,
+                       std::function<void()> on_thread_exit)
+        : on_thread_start_(std::move(on_thread_start)), on_thread_exit_(std::move(on_thread_exit)) {
+        threads = std::max(threads, 1u);
+        for (unsigned i = 0; i < threads; i++) {
+            threads_.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    TaskPool::~TaskPool() {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : threads_) t.join();
+    }
+
+    void TaskPool::Post(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            queue_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+    void TaskPool::WaitIdle() {
+        std::unique_lock<std::mutex> lock(mu_);
+        idle_cv_.wait(lock, [this] { return queue_.empty() && running_ == 0; });
+    }
+
+    unsigned TaskPool::DefaultThreadCount(unsigned cap) {
+        const unsigned hw = std::thread::hardware_concurrency();
+        return std::clamp(hw > 1 ? hw - 1 : 1u, 1u, std::max(cap, 1u));
+    }
+
+    void TaskPool::WorkerLoop() {
+        if (on_thread_start_) on_thread_start_();
+
+        std::unique_lock<std::mutex> lock(mu_);
+        for (;;) {
+            cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) break;  // stopping and drained
+
+            std::function<void()> task = std::move(queue_.front());
+            queue_.pop_front();
+            running_++;
+            lock.unlock();
+            task();
+            lock.lock();
+            running_--;
+            if (queue_.empty() && running_ == 0) idle_cv_.notify_all();
+        }
+        lock.unlock();
+
+        if (on_thread_exit_) on_thread_exit_();
+    }
+
+}  // namespace volumedeck_mixer
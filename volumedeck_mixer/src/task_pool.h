@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace volumedeck_mixer {
+
+    // Fixed set of worker threads draining a FIFO of tasks. Used to keep
+    // blocking work (icon extraction, file I/O) off the platform thread.
+    //
+    // The destructor runs whatever is still queued, then joins.
+    class TaskPool {
+    public:
+        // `on_thread_start`/`on_thread_exit` run on every worker, e.g. to
+        // initialize COM for the thread.
+        explicit TaskPool(unsigned threads, std::function<void()> on_thread_start = nullptr,
+                          std::function<void()> on_thread_exit = nullptr);
+        ~TaskPool();
+
+        TaskPool(const TaskPool&) = delete;
+        TaskPool& operator=(const TaskPool&) = delete;
+
+        void Post(std::function<void()> task);
+
+        // Blocks until the queue is empty and no task is running.
+        void WaitIdle();
+
+        size_t thread_count() const { return threads_.size(); }
+
+        // Workers for CPU-bound work: hardware threads minus one for the UI,
+        // at least one, at most `cap`.
+        static unsigned DefaultThreadCount(unsigned cap = 4);
+
+    private:
+        void WorkerLoop();
+
+        std::function<void()> on_thread_start_;
+        std::function<void()> on_thread_exit_;
+
+        std::mutex mu_;
+        std::condition_variable cv_;
+        std::condition_variable idle_cv_;
+        std::deque<std::function<void()>> queue_;
+        unsigned running_ = 0;
+        bool stop_ = false;
+        std::vector<std::thread> threads_;
+    };
+
+}  // namespace volumedeck_mixer
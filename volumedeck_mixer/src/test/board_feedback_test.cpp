@@ -0,0 +1,390 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <pty.h>
+#include <unistd.h>
+#endif
+
+#include "board_feedback.h"
+#include "deck_engine.h"
+#include "fake_mixer_backend.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+using std::chrono::milliseconds;
+using Clock = std::chrono::steady_clock;
+
+const Clock::time_point kT0 = Clock::time_point{} + std::chrono::hours(1);
+
+Clock::time_point At(int ms) { return kT0 + milliseconds(ms); }
+
+std::string Flush(BoardFeedback& f, int ms, std::vector<std::pair<size_t, uint16_t>>* faders = nullptr) {
+  std::string line;
+  std::vector<std::pair<size_t, uint16_t>> sent;
+  f.Flush(At(ms), &line, faders ? faders : &sent);
+  return line;
+}
+
+// "f0=1|m2=0\n" -> {"f0": 1, "m2": 0}
+std::map<std::string, int> Tokens(const std::string& line) {
+  std::map<std::string, int> out;
+  size_t at = 0;
+  while (at < line.size()) {
+    size_t end = line.find_first_of("|\n", at);
+    if (end == std::string::npos) end = line.size();
+    const size_t eq = line.find('=', at);
+    if (eq != std::string::npos && eq < end) out[line.substr(at, eq - at)] = atoi(line.c_str() + eq + 1);
+    at = end + 1;
+  }
+  return out;
+}
+
+}  // namespace
+
+TEST(BoardFeedback, SendsChangesOnly) {
+  BoardFeedback f;
+  f.Set(ChannelKind::kSlider, 0, 512, At(0));
+  f.Set(ChannelKind::kEncoder, 1, 100, At(0));
+  f.Set(ChannelKind::kButton, 0, 1, At(0));
+  EXPECT_EQ(Flush(f, 0), "f0=512|r1=100|m0=1\n");
+  EXPECT_EQ(Flush(f, 200), "");
+
+  // Inside the deadband: nothing; past it: that channel alone.
+  f.Set(ChannelKind::kSlider, 0, 516, At(300));
+  f.Set(ChannelKind::kEncoder, 1, 100, At(300));
+  EXPECT_EQ(Flush(f, 300), "");
+  f.Set(ChannelKind::kSlider, 0, 600, At(400));
+  f.Set(ChannelKind::kButton, 0, 0, At(410));
+  EXPECT_EQ(Flush(f, 420), "f0=600|m0=0\n");
+
+  // Too soon after the last send: held, and sent at its latest value.
+  f.Set(ChannelKind::kSlider, 0, 700, At(450));
+  EXPECT_EQ(Flush(f, 450), "");
+  f.Set(ChannelKind::kSlider, 0, 800, At(500));
+  EXPECT_EQ(Flush(f, 520), "f0=800\n");
+
+  // A lost line is sent again in full, oldest change first.
+  f.Resend();
+  EXPECT_EQ(Flush(f, 700), "r1=100|m0=0|f0=800\n");
+  EXPECT_EQ(f.stats().updates, 9u);
+}
+
+TEST(BoardFeedback, KeepsToTheLinkAndChannelBudgets) {
+  FeedbackOptions options;  // half the link, 10 updates/s per channel
+  BoardFeedback f(options);
+  f.SetBaud(9600);  // 960 bytes/s, 480 for feedback
+
+  // 16 faders dragged around continuously for 2 s, flushed every 10 ms.
+  constexpr int kFaders = 16;
+  constexpr int kMs = 2000;
+  size_t bytes = 0;
+  std::vector<int> updates(kFaders, 0);
+  for (int t = 0; t < kMs; t += 10) {
+    for (int i = 0; i < kFaders; i++) f.Set(ChannelKind::kSlider, i, (uint16_t)((t * 7 + i * 61) % 1024), At(t));
+    const std::string line = Flush(f, t);
+    bytes += line.size();
+    for (const auto& [token, value] : Tokens(line)) updates[atoi(token.c_str() + 1)]++;
+  }
+  EXPECT_LE(bytes, 480u * kMs / 1000 + 48);  // plus the 0.1 s burst
+  EXPECT_GE(bytes, 480u * kMs / 1000 * 9 / 10);
+  EXPECT_GT(f.stats().deferred, 0u);
+  // Oldest change first: no fader starves, none beats its rate.
+  for (int i = 0; i < kFaders; i++) {
+    EXPECT_GE(updates[i], 4) << "fader " << i;
+    EXPECT_LE(updates[i], kMs / 100 + 1) << "fader " << i;
+  }
+}
+
+TEST(BoardFeedback, HoldsMovedFadersAndSpotsMotorEchoes) {
+  BoardFeedback f;  // 300 ms hold, 500 ms echo window, 16 tolerance
+  uint16_t commanded = 0;
+
+  // A hand put the fader at 100; the mixer lagging behind isn't sent back
+  // until the hold is over.
+  f.NoteMove(0, 100, At(0));
+  f.Set(ChannelKind::kSlider, 0, 900, At(0));
+  EXPECT_EQ(Flush(f, 100), "");
+  EXPECT_FALSE(f.IsEcho(0, 100, At(100), &commanded));
+  std::vector<std::pair<size_t, uint16_t>> faders;
+  EXPECT_EQ(Flush(f, 300, &faders), "f0=900\n");
+  ASSERT_EQ(faders.size(), 1u);
+  EXPECT_EQ(faders[0], (std::pair<size_t, uint16_t>{0, 900}));
+
+  // The motor on its way from 100 to 900 reads as 900.
+  for (int raw : {100, 350, 880, 910}) {
+    EXPECT_TRUE(f.IsEcho(0, (uint16_t)raw, At(320), &commanded)) << raw;
+    EXPECT_EQ(commanded, 900);
+  }
+  // Sent on to 200 before it got there: 100..900 is still its path.
+  f.Set(ChannelKind::kSlider, 0, 200, At(400));
+  EXPECT_EQ(Flush(f, 400), "f0=200\n");
+  EXPECT_TRUE(f.IsEcho(0, 700, At(410), &commanded));
+  EXPECT_EQ(commanded, 200);
+  // Off the path: a hand grabbed it, and the window is over.
+  EXPECT_FALSE(f.IsEcho(0, 1000, At(420), &commanded));
+  EXPECT_FALSE(f.IsEcho(0, 500, At(430), &commanded));
+  // The window also lapses on its own.
+  f.Set(ChannelKind::kSlider, 0, 600, At(1000));
+  EXPECT_EQ(Flush(f, 1000), "f0=600\n");
+  EXPECT_TRUE(f.IsEcho(0, 400, At(1499), &commanded));
+  EXPECT_FALSE(f.IsEcho(0, 400, At(1500), &commanded));
+  EXPECT_EQ(f.stats().echoes, 6u);
+}
+
+#ifdef __linux__
+
+namespace {
+
+// A motor-fader board on the other end of a pty. Every 10 ms it takes in
+// the feedback lines the engine sent, drives each fader toward its last
+// `f` target at kSpeed per tick, and sends its positions (and buttons)
+// like the deej firmware. A hand on a fader overrides the motor.
+class MotorBoard {
+ public:
+  static constexpr int kSpeed = 40;
+
+  MotorBoard(std::vector<int> positions, size_t buttons = 0)
+      : positions_(std::move(positions)), targets_(positions_.size(), -1), buttons_(buttons) {
+    char name[128] = {};
+    if (openpty(&master_, &slave_, name, nullptr, nullptr) == 0) {
+      close(slave_);
+      name_ = name;
+    }
+  }
+  ~MotorBoard() {
+    Stop();
+    if (master_ >= 0) close(master_);
+  }
+
+  const std::string& name() const { return name_; }
+
+  // After the engine opened the port: its raw mode keeps the pty from
+  // echoing our lines back.
+  void Start() {
+    started_ = Clock::now();
+    thread_ = std::thread([this] { Loop(); });
+  }
+  void Stop() {
+    stop_.store(true);
+    if (thread_.joinable()) thread_.join();
+  }
+
+  void Grab(size_t fader, int position) {
+    std::lock_guard<std::mutex> lock(mu_);
+    positions_[fader] = position;
+    targets_[fader] = -1;
+  }
+  int position(size_t fader) {
+    std::lock_guard<std::mutex> lock(mu_);
+    return positions_[fader];
+  }
+  // -1 until the engine sent one.
+  int led(size_t button) {
+    std::lock_guard<std::mutex> lock(mu_);
+    return button < leds_.size() ? leds_[button] : -1;
+  }
+  size_t bytes() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return bytes_;
+  }
+  size_t fader_updates(size_t fader) {
+    std::lock_guard<std::mutex> lock(mu_);
+    return fader < updates_.size() ? updates_[fader] : 0;
+  }
+  double seconds() const { return std::chrono::duration<double>(Clock::now() - started_).count(); }
+
+ private:
+  void Loop() {
+    auto next = Clock::now();
+    char buffer[512];
+    while (!stop_.load()) {
+      std::this_thread::sleep_until(next);
+      next += milliseconds(10);
+      pollfd p{master_, POLLIN, 0};
+      while (poll(&p, 1, 0) > 0 && (p.revents & POLLIN)) {
+        const ssize_t n = read(master_, buffer, sizeof(buffer));
+        if (n <= 0) break;
+        received_.append(buffer, (size_t)n);
+      }
+      std::string line;
+      {
+        std::lock_guard<std::mutex> lock(mu_);
+        size_t nl;
+        while ((nl = received_.find('\n')) != std::string::npos) {
+          bytes_ += nl + 1;
+          for (const auto& [token, value] : Tokens(received_.substr(0, nl + 1))) {
+            const size_t i = (size_t)atoi(token.c_str() + 1);
+            if (token[0] == 'f' && i < targets_.size()) {
+              targets_[i] = value;
+              if (updates_.size() <= i) updates_.resize(i + 1);
+              updates_[i]++;
+            } else if (token[0] == 'm') {
+              if (leds_.size() <= i) leds_.resize(i + 1, -1);
+              leds_[i] = value;
+            }
+          }
+          received_.erase(0, nl + 1);
+        }
+        for (size_t i = 0; i < positions_.size(); i++) {
+          if (targets_[i] < 0) continue;
+          const int d = targets_[i] - positions_[i];
+          positions_[i] += std::abs(d) <= kSpeed ? d : (d > 0 ? kSpeed : -kSpeed);
+        }
+        for (size_t i = 0; i < positions_.size(); i++) line += (i ? "|" : "") + std::to_string(positions_[i]);
+        for (size_t i = 0; i < buttons_; i++) line += "|b0";
+      }
+      line += "\r\n";
+      if (write(master_, line.data(), line.size()) != (ssize_t)line.size()) return;
+    }
+  }
+
+  int master_ = -1;
+  int slave_ = -1;
+  std::string name_;
+  std::thread thread_;
+  std::atomic<bool> stop_{false};
+  Clock::time_point started_{};
+  std::string received_;
+
+  std::mutex mu_;
+  std::vector<int> positions_;
+  std::vector<int> targets_;
+  size_t buttons_;
+  std::vector<int> leds_;
+  std::vector<size_t> updates_;
+  size_t bytes_ = 0;
+};
+
+template <typename F>
+bool WaitFor(F&& done, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+  const auto deadline = Clock::now() + timeout;
+  while (!done()) {
+    if (Clock::now() > deadline) return false;
+    std::this_thread::sleep_for(milliseconds(2));
+  }
+  return true;
+}
+
+float MasterVolume(FakeMixerBackend& backend) {
+  float volume = 0.0f, peak = 0.0f;
+  bool mute = false;
+  backend.GetMaster(&volume, &mute, &peak);
+  return volume;
+}
+
+}  // namespace
+
+TEST(BoardFeedback, EngineFollowsTheMixerWithoutEcho) {
+  MotorBoard board({1023}, 1);
+  ASSERT_FALSE(board.name().empty());
+  FakeMixerBackend backend;
+  const std::string chat = backend.AddSession("discord.exe", 100);
+  DeejConfig cfg;
+  cfg.button_mapping = {{0, {"discord.exe"}}};
+  DeckEngine engine(&backend, std::make_unique<SerialPort>(board.name(), 9600), cfg);
+  engine.EnableFeedback();
+  ASSERT_TRUE(engine.Start());
+  ASSERT_TRUE(WaitFor([&] { return engine.stats().connected; }));
+  board.Start();
+  ASSERT_TRUE(WaitFor([&] { return engine.stats().writes == 1; }));  // the board's first line
+  EXPECT_FLOAT_EQ(MasterVolume(backend), 1.0f);
+  ASSERT_TRUE(WaitFor([&] { return board.led(0) == 0; }));
+
+  // Turned down in the system mixer: the motor follows over several board
+  // ticks, and none of its readings on the way are written back.
+  backend.SetMasterVolume(0.25f);
+  ASSERT_TRUE(WaitFor([&] { return board.position(0) == 256; }));
+  std::this_thread::sleep_for(milliseconds(700));  // past the echo window
+  EXPECT_EQ(engine.stats().writes, 1u);
+  EXPECT_FLOAT_EQ(MasterVolume(backend), 0.25f);
+  EXPECT_GT(engine.stats().echoes, 0u);
+  EXPECT_NEAR(engine.slider_values()[0], 0.25f, 0.01f);
+
+  // Muted elsewhere: the button's LED lights.
+  backend.SetSessionMute(chat, true);
+  ASSERT_TRUE(WaitFor([&] { return board.led(0) == 1; }));
+  backend.SetSessionMute(chat, false);
+  ASSERT_TRUE(WaitFor([&] { return board.led(0) == 0; }));
+  engine.Stop();
+}
+
+TEST(BoardFeedback, EngineLeavesHandMovesAlone) {
+  MotorBoard board({1023});
+  ASSERT_FALSE(board.name().empty());
+  FakeMixerBackend backend;
+  DeckEngine engine(&backend, std::make_unique<SerialPort>(board.name(), 9600), DeejConfig());
+  engine.EnableFeedback();
+  ASSERT_TRUE(engine.Start());
+  ASSERT_TRUE(WaitFor([&] { return engine.stats().connected; }));
+  board.Start();
+  ASSERT_TRUE(WaitFor([&] { return engine.stats().writes == 1; }));
+
+  // Dragged down over 200 ms: the mixer follows, nothing is sent back.
+  for (int p = 1023; p >= 303; p -= 36) {
+    board.Grab(0, p);
+    std::this_thread::sleep_for(milliseconds(10));
+  }
+  std::this_thread::sleep_for(milliseconds(600));  // past the hold
+  EXPECT_EQ(board.fader_updates(0), 0u);
+  EXPECT_EQ(board.position(0), 303);
+  EXPECT_NEAR(MasterVolume(backend), 0.30f, 0.01f);
+  EXPECT_EQ(engine.stats().echoes, 0u);
+  engine.Stop();
+}
+
+TEST(BoardFeedback, EngineStaysInBudgetOnASlowLink) {
+  // Four faders at 9600 baud; the mixer churns every 5 ms for 2 s.
+  MotorBoard board({0, 0, 0, 0});
+  ASSERT_FALSE(board.name().empty());
+  FakeMixerBackend backend;
+  const std::string ids[] = {backend.AddSession("a.exe", 100), backend.AddSession("b.exe", 101),
+                             backend.AddSession("c.exe", 102)};
+  DeejConfig cfg;
+  cfg.slider_mapping = {{0, {"master"}}, {1, {"a.exe"}}, {2, {"b.exe"}}, {3, {"c.exe"}}};
+  DeckEngine engine(&backend, std::make_unique<SerialPort>(board.name(), 9600), cfg);
+  engine.EnableFeedback();
+  ASSERT_TRUE(engine.Start());
+  ASSERT_TRUE(WaitFor([&] { return engine.stats().connected; }));
+  board.Start();
+  ASSERT_TRUE(WaitFor([&] { return engine.stats().moves == 4; }));
+  const uint64_t writes = engine.stats().writes;
+
+  const auto end = Clock::now() + std::chrono::seconds(2);
+  for (int i = 0; Clock::now() < end; i++) {
+    backend.SetMasterVolume((float)((i * 37) % 101) / 100.0f);
+    for (int s = 0; s < 3; s++) backend.SetSessionVolume(ids[s], (float)((i * 53 + s * 29) % 101) / 100.0f);
+    std::this_thread::sleep_for(milliseconds(5));
+  }
+  const double seconds = board.seconds();
+  const size_t bytes = board.bytes();
+  engine.Stop();
+
+  // Half of 960 bytes/s, plus the 0.1 s burst.
+  EXPECT_LE((double)bytes, 480.0 * seconds + 48.0);
+  for (size_t i = 0; i < 4; i++) {
+    EXPECT_GE(board.fader_updates(i), 5u) << "fader " << i;
+    EXPECT_LE((double)board.fader_updates(i), 10.0 * seconds + 1.0) << "fader " << i;
+  }
+  // The motors chased every update; none of it came back as a move.
+  EXPECT_EQ(engine.stats().writes, writes);
+  EXPECT_EQ(engine.stats().feedback_bytes, bytes);
+}
+
+#endif
+
+}  // namespace test
+}  // namespace volumedeck_mixer
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "capture_source.h"
+#include "loudness_monitor.h"
+#include "test_util.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+TEST(SyntheticCaptureSource, DeliversExactlyTotalFrames) {
+  SyntheticCaptureSource src({48000, 2}, SyntheticCaptureSource::Sine({48000, 2}, 440, -6), 1000);
+  CaptureFormat f;
+  ASSERT_TRUE(src.Open(&f));
+  EXPECT_EQ(f.sample_rate, 48000);
+  EXPECT_EQ(f.channels, 2);
+
+  std::vector<float> buf(300 * 2);
+  size_t total = 0, n = 0;
+  while (src.Read(buf.data(), 300, &n) == CaptureStatus::kOk) total += n;
+  EXPECT_EQ(total, 1000u);
+}
+
+TEST(WavFileCaptureSource, RoundTripsFloatWav) {
+  TempDir dir;
+  const CaptureFormat f{44100, 3};
+  std::vector<float> samples(1000 * 3);
+  for (size_t i = 0; i < samples.size(); i++) samples[i] = (float)i / (float)samples.size() - 0.5f;
+  ASSERT_TRUE(WriteWavFile(dir.File("a.wav"), f, samples.data(), 1000));
+
+  WavFileCaptureSource src(dir.File("a.wav"));
+  CaptureFormat got;
+  ASSERT_TRUE(src.Open(&got));
+  EXPECT_EQ(got.sample_rate, 44100);
+  EXPECT_EQ(got.channels, 3);
+  std::vector<float> out(1000 * 3);
+  size_t n = 0;
+  ASSERT_EQ(src.Read(out.data(), 1000, &n), CaptureStatus::kOk);
+  EXPECT_EQ(n, 1000u);
+  EXPECT_EQ(out, samples);
+  EXPECT_EQ(src.Read(out.data(), 1000, &n), CaptureStatus::kEnd);
+}
+
+TEST(WavFileCaptureSource, RejectsGarbage) {
+  TempDir dir;
+  const char junk[] = "RIFF\x10\0\0\0WAVEjunk";
+  std::FILE* fp = std::fopen(dir.File("bad.wav").c_str(), "wb");
+  ASSERT_TRUE(fp);
+  std::fwrite(junk, 1, sizeof(junk), fp);
+  std::fclose(fp);
+  WavFileCaptureSource src(dir.File("bad.wav"));
+  CaptureFormat f;
+  EXPECT_FALSE(src.Open(&f));
+  WavFileCaptureSource missing(dir.File("missing.wav"));
+  EXPECT_FALSE(missing.Open(&f));
+}
+
+TEST(LoudnessMonitor, MeasuresAFileSourceToTheEnd) {
+  TempDir dir;
+  const CaptureFormat f{48000, 2};
+  std::vector<float> samples(48000 * 2 * 5);
+  SyntheticCaptureSource::Sine(f, 1000, -23)(samples.data(), 48000 * 5, 0);
+  ASSERT_TRUE(WriteWavFile(dir.File("tone.wav"), f, samples.data(), 48000 * 5));
+
+  LoudnessMonitor monitor(std::make_unique<WavFileCaptureSource>(dir.File("tone.wav")));
+  monitor.Start();
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (!monitor.finished() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  monitor.Stop();
+  ASSERT_TRUE(monitor.finished());
+  const LoudnessReading r = monitor.Read();
+  EXPECT_FALSE(r.capturing);
+  EXPECT_EQ(r.frames, 48000u * 5);
+  EXPECT_NEAR(r.integrated, -23.0, 0.1);
+  EXPECT_NEAR(r.momentary, -23.0, 0.1);
+}
+
+// A source that fails to open a couple of times, then streams in real time.
+class FlakySource : public CaptureSource {
+ public:
+  bool Open(CaptureFormat* f) override {
+    if (++opens < 3) return false;
+    return inner_.Open(f);
+  }
+  CaptureStatus Read(float* out, size_t max, size_t* n) override { return inner_.Read(out, max, n); }
+  int opens = 0;
+
+ private:
+  SyntheticCaptureSource inner_{{48000, 2}, SyntheticCaptureSource::Sine({48000, 2}, 1000, -20), 0, true};
+};
+
+TEST(LoudnessMonitor, RetriesOpenAndPublishesLiveValues) {
+  auto src = std::make_unique<FlakySource>();
+  FlakySource* flaky = src.get();
+  LoudnessMonitor monitor(std::move(src), std::chrono::milliseconds(20));
+  monitor.Start();
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  LoudnessReading r;
+  while (std::chrono::steady_clock::now() < deadline) {
+    r = monitor.Read();
+    if (r.frames >= 48000 / 2) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_TRUE(r.capturing);
+  EXPECT_GE(r.frames, 48000u / 2);
+  EXPECT_NEAR(r.momentary, -20.0, 0.2);
+  monitor.ResetIntegrated();
+  monitor.Stop();
+  EXPECT_EQ(flaky->opens, 3);
+  EXPECT_FALSE(monitor.finished());
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "change_coalescer.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+using std::chrono::milliseconds;
+
+const CoalescedChange* Find(const std::vector<CoalescedChange>& changes, const std::string& id) {
+  for (const CoalescedChange& c : changes) {
+    if (c.key == ChangeCoalescer::Key(id)) return &c;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+TEST(ChangeCoalescer, MergesAStormIntoTheLatestPerTarget) {
+  ChangeCoalescer c;
+  std::vector<CoalescedChange> out;
+  bool resync = true;
+  EXPECT_FALSE(c.Take(&out, &resync));
+  EXPECT_FALSE(resync);
+
+  for (int i = 0; i <= 100; i++) c.Post({"game", i / 100.0f, false});
+  c.Post({"", 0.3f, false});
+  c.Post({"", 0.3f, true});
+  ASSERT_TRUE(c.Take(&out, &resync));
+  EXPECT_FALSE(resync);
+  ASSERT_EQ(out.size(), 2u);
+  const CoalescedChange* game = Find(out, "game");
+  ASSERT_NE(game, nullptr);
+  EXPECT_FLOAT_EQ(game->volume, 1.0f);
+  EXPECT_FALSE(game->mute);
+  const CoalescedChange* master = Find(out, "");
+  ASSERT_NE(master, nullptr);
+  EXPECT_TRUE(master->mute);
+
+  EXPECT_FALSE(c.Take(&out, &resync));
+  EXPECT_TRUE(out.empty());
+  c.Post({"game", 0.5f, true});
+  ASSERT_TRUE(c.Take(&out, &resync));
+  ASSERT_EQ(out.size(), 1u);
+  EXPECT_FLOAT_EQ(out[0].volume, 0.5f);
+  EXPECT_EQ(c.posts(), 104u);
+  EXPECT_EQ(c.takes(), 2u);
+}
+
+TEST(ChangeCoalescer, AsksForAResyncWhenFull) {
+  ChangeCoalescer c(64);
+  for (int i = 0; i < 70; i++) c.Post({"s" + std::to_string(i), 0.5f, false});
+  std::vector<CoalescedChange> out;
+  bool resync = false;
+  ASSERT_TRUE(c.Take(&out, &resync));
+  EXPECT_TRUE(resync);
+  EXPECT_EQ(out.size(), 64u);
+  EXPECT_EQ(c.dropped(), 6u);
+  // Known ids still get through.
+  c.Post({"s0", 0.1f, false});
+  ASSERT_TRUE(c.Take(&out, &resync));
+  EXPECT_FALSE(resync);
+  ASSERT_EQ(out.size(), 1u);
+}
+
+TEST(ChangeCoalescer, WaitWakesAtMostOncePerFrame) {
+  ChangeCoalescer c(64, milliseconds(40));
+  std::vector<CoalescedChange> out;
+  bool resync = false;
+  EXPECT_FALSE(c.Wait(milliseconds(5), &out, &resync));
+
+  c.Post({"", 0.1f, false});
+  ASSERT_TRUE(c.Wait(milliseconds(500), &out, &resync));
+  const auto woke = ChangeCoalescer::Clock::now();
+  // Posted right after a wake: held until the frame is up, and merged.
+  c.Post({"", 0.2f, false});
+  c.Post({"", 0.4f, false});
+  ASSERT_TRUE(c.Wait(milliseconds(500), &out, &resync));
+  EXPECT_GE(ChangeCoalescer::Clock::now() - woke, milliseconds(35));
+  ASSERT_EQ(out.size(), 1u);
+  EXPECT_FLOAT_EQ(out[0].volume, 0.4f);
+
+  std::thread closer([&] {
+    std::this_thread::sleep_for(milliseconds(20));
+    c.Close();
+  });
+  EXPECT_FALSE(c.Wait(milliseconds(5000), &out, &resync));
+  closer.join();
+}
+
+#ifdef __linux__
+// WASAPI calls back on pool threads, several at once. Hammer it from many
+// and check the consumer never goes backwards, ends on every target's last
+// state, and wakes no more than once a frame.
+TEST(ChangeCoalescer, StressManyProducers) {
+  constexpr int kThreads = 16;
+  constexpr int kTargetsPerThread = 8;
+  constexpr int kPosts = 20000;
+  const auto frame = milliseconds(2);
+  ChangeCoalescer c(256, frame);
+
+  std::map<uint64_t, float> seen;
+  std::atomic<bool> backwards{false};
+  std::atomic<int> running{kThreads};
+  uint64_t wakes = 0;
+  std::thread consumer([&] {
+    std::vector<CoalescedChange> out;
+    bool resync = false;
+    for (;;) {
+      const bool done = running.load() == 0;
+      if (c.Wait(milliseconds(50), &out, &resync)) {
+        wakes++;
+        for (const CoalescedChange& ch : out) {
+          auto it = seen.find(ch.key);
+          if (it != seen.end() && ch.volume < it->second) backwards.store(true);
+          seen[ch.key] = ch.volume;
+        }
+      } else if (done) {
+        return;
+      }
+    }
+  });
+
+  const auto start = ChangeCoalescer::Clock::now();
+  std::vector<std::thread> producers;
+  for (int t = 0; t < kThreads; t++) {
+    producers.emplace_back([&, t] {
+      for (int i = 1; i <= kPosts; i++) {
+        const std::string id = "t" + std::to_string(t) + "s" + std::to_string(i % kTargetsPerThread);
+        // Each target only ever goes up.
+        c.Post({id, (float)i / kPosts, (i & 1) != 0});
+      }
+      running.fetch_sub(1);
+    });
+  }
+  for (std::thread& p : producers) p.join();
+  const auto elapsed = ChangeCoalescer::Clock::now() - start;
+  consumer.join();
+
+  EXPECT_FALSE(backwards.load());
+  EXPECT_EQ(c.posts(), (uint64_t)kThreads * kPosts);
+  EXPECT_EQ(c.dropped(), 0u);
+  ASSERT_EQ(seen.size(), (size_t)kThreads * kTargetsPerThread);
+  for (int t = 0; t < kThreads; t++) {
+    for (int s = 0; s < kTargetsPerThread; s++) {
+      // The last post to target s was the highest i with i % 8 == s.
+      const int last = kPosts - ((kPosts - s) % kTargetsPerThread);
+      const uint64_t key = ChangeCoalescer::Key("t" + std::to_string(t) + "s" + std::to_string(s));
+      EXPECT_FLOAT_EQ(seen[key], (float)last / kPosts) << t << "/" << s;
+    }
+  }
+  // One wake a frame while the storm lasted, plus the one after it.
+  EXPECT_LE(wakes, (uint64_t)(elapsed / frame) + 3);
+  EXPECT_LT(wakes * 100, c.posts());
+}
+#endif
+
+}  // namespace test
+}  // namespace volumedeck_mixer
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config_watcher.h"
+#include "test_util.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+template <typename F>
+bool WaitFor(F&& done, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!done()) {
+    if (std::chrono::steady_clock::now() > deadline) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  return true;
+}
+
+// Collects what the watcher reports.
+struct Reports {
+  std::mutex mu;
+  std::vector<DeejConfig> configs;
+  std::vector<DeejConfigDiff> diffs;
+
+  ConfigWatcher::Callback callback() {
+    return [this](const DeejConfig& c, const DeejConfigDiff& d) {
+      std::lock_guard<std::mutex> lock(mu);
+      configs.push_back(c);
+      diffs.push_back(d);
+    };
+  }
+  size_t size() {
+    std::lock_guard<std::mutex> lock(mu);
+    return diffs.size();
+  }
+};
+
+DeejConfig Base() {
+  DeejConfig cfg;
+  cfg.slider_mapping = {{0, {"master"}}, {1, {"chrome.exe"}}, {2, {"discord.exe"}}};
+  cfg.com_port = "/dev/ttyACM0";
+  return cfg;
+}
+
+}  // namespace
+
+TEST(ConfigWatcher, ReportsOnlyTheChangedKeys) {
+  TempDir dir;
+  const std::string path = dir.File("config.yaml");
+  ASSERT_TRUE(SaveDeejConfig(path, Base()));
+  Reports reports;
+  ConfigWatcher watcher(path, reports.callback(), std::chrono::milliseconds(20));
+  std::string error;
+  ASSERT_TRUE(watcher.Start(&error)) << error;
+  EXPECT_EQ(watcher.config().com_port, "/dev/ttyACM0");
+
+  DeejConfig cfg = Base();
+  cfg.baud_rate = 115200;
+  ASSERT_TRUE(SaveDeejConfig(path, cfg));
+  ASSERT_TRUE(WaitFor([&] { return reports.size() == 1; }));
+  EXPECT_EQ(reports.diffs[0].keys, kConfigBaudRate);
+  EXPECT_TRUE(reports.diffs[0].sliders.empty());
+  EXPECT_EQ(reports.configs[0].baud_rate, 115200);
+
+  // Edited in place, the way a text editor without atomic saves does it.
+  cfg.slider_mapping[2] = {"discord.exe", "teams.exe"};
+  std::ofstream(path) << EmitDeejConfig(cfg);
+  ASSERT_TRUE(WaitFor([&] { return reports.size() == 2; }));
+  EXPECT_EQ(reports.diffs[1].keys, kConfigSliderMapping);
+  EXPECT_EQ(reports.diffs[1].sliders, (std::vector<int>{2}));
+  EXPECT_EQ(watcher.config().slider_mapping[2].size(), 2u);
+  watcher.Stop();
+}
+
+TEST(ConfigWatcher, CoalescesRapidSaves) {
+  TempDir dir;
+  const std::string path = dir.File("config.yaml");
+  ASSERT_TRUE(SaveDeejConfig(path, Base()));
+  Reports reports;
+  ConfigWatcher watcher(path, reports.callback(), std::chrono::milliseconds(100));
+  ASSERT_TRUE(watcher.Start());
+
+  // A slider being dragged in the app's settings: one save per step.
+  DeejConfig cfg = Base();
+  for (int i = 1; i <= 50; i++) {
+    cfg.baud_rate = 9600 + i;
+    ASSERT_TRUE(SaveDeejConfig(path, cfg));
+  }
+  ASSERT_TRUE(WaitFor([&] { return watcher.config().baud_rate == 9650; }));
+  std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+  const ConfigWatcherStats st = watcher.stats();
+  EXPECT_GE(st.events, 10u);
+  EXPECT_LE(st.reloads, 3u);
+  EXPECT_EQ(st.reports, reports.size());
+  ASSERT_GE(reports.size(), 1u);
+  EXPECT_EQ(reports.configs.back().baud_rate, 9650);
+  for (const auto& d : reports.diffs) EXPECT_EQ(d.keys, kConfigBaudRate);
+  watcher.Stop();
+}
+
+TEST(ConfigWatcher, SkipsNoOpAndBrokenSaves) {
+  TempDir dir;
+  const std::string path = dir.File("config.yaml");
+  ASSERT_TRUE(SaveDeejConfig(path, Base()));
+  Reports reports;
+  ConfigWatcher watcher(path, reports.callback(), std::chrono::milliseconds(20));
+  ASSERT_TRUE(watcher.Start());
+
+  ASSERT_TRUE(SaveDeejConfig(path, Base()));
+  ASSERT_TRUE(WaitFor([&] { return watcher.stats().reloads == 1; }));
+  std::ofstream(path) << "slider_mapping:\n  0: master\nbaud_rate: fast\n";
+  ASSERT_TRUE(WaitFor([&] { return watcher.stats().parse_errors == 1; }));
+  // Neighbours in the directory don't count.
+  std::ofstream(dir.File("other.yaml")) << "baud_rate: 1\n";
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(reports.size(), 0u);
+  EXPECT_EQ(watcher.config().com_port, "/dev/ttyACM0");
+
+  DeejConfig cfg = Base();
+  cfg.noise_reduction = "high";
+  ASSERT_TRUE(SaveDeejConfig(path, cfg));
+  ASSERT_TRUE(WaitFor([&] { return reports.size() == 1; }));
+  EXPECT_EQ(reports.diffs[0].keys, kConfigNoiseReduction);
+  EXPECT_EQ(watcher.stats().reloads, 3u);
+}
+
+TEST(ConfigWatcher, StartsWithoutAFileButNotWithoutADirectory) {
+  TempDir dir;
+  Reports reports;
+  ConfigWatcher watcher(dir.File("config.yaml"), reports.callback(), std::chrono::milliseconds(20));
+  ASSERT_TRUE(watcher.Start());
+  EXPECT_EQ(watcher.config().com_port, "COM1");  // defaults, as deej does
+
+  DeejConfig cfg = Base();
+  ASSERT_TRUE(SaveDeejConfig(dir.File("config.yaml"), cfg));
+  ASSERT_TRUE(WaitFor([&] { return reports.size() == 1; }));
+  EXPECT_EQ(reports.diffs[0].keys, kConfigSliderMapping | kConfigComPort);
+  EXPECT_EQ(reports.diffs[0].sliders, (std::vector<int>{1, 2}));
+
+  const auto t0 = std::chrono::steady_clock::now();
+  watcher.Stop();
+  EXPECT_LT(std::chrono::steady_clock::now() - t0, std::chrono::milliseconds(500));
+
+  ConfigWatcher orphan(dir.File("gone/config.yaml"), reports.callback());
+  std::string error;
+  EXPECT_FALSE(orphan.Start(&error));
+  EXPECT_NE(error.find("gone"), std::string::npos) << error;
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
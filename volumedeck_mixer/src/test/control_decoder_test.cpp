@@ -0,0 +1,318 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pty.h>
+#include <unistd.h>
+#endif
+
+#include "control_decoder.h"
+#include "deck_engine.h"
+#include "fake_mixer_backend.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+using std::chrono::milliseconds;
+
+const ControlClock::time_point kT0 = ControlClock::time_point{} + std::chrono::hours(1);
+
+ControlClock::time_point At(int ms) { return kT0 + milliseconds(ms); }
+
+// Raw levels as a board would sample them every `period` ms from `start`:
+// '1' pressed, '0' released. Returns the presses decoded, with their times.
+struct Press {
+  ControlEventType type;
+  int at;
+};
+
+std::vector<Press> Sample(ButtonDecoder& b, const std::string& levels, int period = 10, int start = 0) {
+  std::vector<Press> out;
+  ControlEventType type;
+  for (size_t i = 0; i < levels.size(); i++) {
+    const int t = start + (int)i * period;
+    if (b.Feed(levels[i] == '1', At(t), &type)) out.push_back({type, t});
+  }
+  return out;
+}
+
+}  // namespace
+
+TEST(ButtonDecoder, FiltersBounceWithoutDelayingThePress) {
+  ButtonTiming timing;
+  timing.double_gap = milliseconds(0);
+  ButtonDecoder b(timing);
+  ControlEventType type;
+  // Contacts bounce for 6 ms each way, sampled every 2 ms.
+  EXPECT_FALSE(b.Feed(true, At(0), &type));
+  EXPECT_TRUE(b.pressed());  // taken at once
+  EXPECT_FALSE(b.Feed(false, At(2), &type));
+  EXPECT_FALSE(b.Feed(true, At(4), &type));
+  EXPECT_FALSE(b.Feed(false, At(6), &type));
+  EXPECT_TRUE(b.pressed());
+  // Released at 100, bouncing until 106: one short press.
+  int presses = 0;
+  for (int t = 8; t < 100; t += 2) presses += b.Feed(true, At(t), &type);
+  for (int t = 100; t <= 140; t += 2) presses += b.Feed(t > 106 || t % 4 == 0 ? false : true, At(t), &type);
+  EXPECT_EQ(presses, 1);
+  EXPECT_EQ(type, ControlEventType::kShortPress);
+}
+
+TEST(ButtonDecoder, TellsShortLongAndDoublePresses) {
+  ButtonDecoder b;  // 500 ms long press, 250 ms double press gap
+
+  // Pressed 0..100: the short press waits out the gap after the release.
+  auto p = Sample(b, std::string(10, '1') + std::string(40, '0'));
+  ASSERT_EQ(p.size(), 1u);
+  EXPECT_EQ(p[0].type, ControlEventType::kShortPress);
+  EXPECT_EQ(p[0].at, 100 + 250);
+
+  // Two presses 150 ms apart: a double press, on the second press.
+  p = Sample(b, "11111" "000000000000000" "11111" "0000000000000000000000000000000000", 10, 1000);
+  ASSERT_EQ(p.size(), 1u);
+  EXPECT_EQ(p[0].type, ControlEventType::kDoublePress);
+  EXPECT_EQ(p[0].at, 1000 + 200);
+
+  // Held: the long press comes while still held, nothing on release.
+  p = Sample(b, std::string(80, '1') + std::string(40, '0'), 10, 2000);
+  ASSERT_EQ(p.size(), 1u);
+  EXPECT_EQ(p[0].type, ControlEventType::kLongPress);
+  EXPECT_EQ(p[0].at, 2000 + 500);
+}
+
+TEST(ButtonDecoder, PollReportsPressesBetweenReadings) {
+  ButtonDecoder b;
+  ControlEventType type;
+  EXPECT_EQ(b.deadline(), ControlClock::time_point::max());
+  b.Feed(true, At(0), &type);
+  EXPECT_EQ(b.deadline(), At(500));
+  EXPECT_FALSE(b.Poll(At(499), &type));
+  ASSERT_TRUE(b.Poll(At(500), &type));
+  EXPECT_EQ(type, ControlEventType::kLongPress);
+  EXPECT_EQ(b.deadline(), ControlClock::time_point::max());
+
+  b.Feed(false, At(600), &type);
+  b.Feed(true, At(700), &type);
+  b.Feed(false, At(750), &type);
+  EXPECT_EQ(b.deadline(), At(1000));
+  ASSERT_TRUE(b.Poll(At(1003), &type));
+  EXPECT_EQ(type, ControlEventType::kShortPress);
+}
+
+TEST(EncoderDecoder, AcceleratesFastTurnsOnly) {
+  EncoderAccel accel;  // 0.02 per detent, x1 at 5/s up to x5 at 30/s
+  EncoderDecoder e(accel);
+
+  // One detent every 250 ms: 4/s, a step each.
+  float total = 0.0f;
+  for (int i = 0; i < 5; i++) total += e.Feed(1, At(i * 250));
+  EXPECT_NEAR(total, 5 * 0.02f, 1e-5f);
+  EXPECT_FLOAT_EQ(e.multiplier(), 1.0f);
+
+  // A flick: 2 detents every 20 ms (100/s) after a pause.
+  total = 0.0f;
+  for (int i = 0; i < 10; i++) total += e.Feed(2, At(5000 + i * 20));
+  EXPECT_FLOAT_EQ(e.multiplier(), accel.max_multiplier);
+  EXPECT_GT(total, 20 * 0.02f * 4.0f);  // the first reading is unaccelerated
+
+  // Reversing starts over, as does the next reading's zero.
+  EXPECT_NEAR(e.Feed(-1, At(5220)), -0.02f, 1e-6f);
+  EXPECT_EQ(e.Feed(0, At(5230)), 0.0f);
+}
+
+TEST(ControlDecoder, DecodesEveryChannelOfALineInOnePass) {
+  ButtonTiming timing;
+  timing.double_gap = milliseconds(0);
+  ControlDecoder d;
+  d.Configure(timing, EncoderAccel());
+  std::vector<ControlEvent> events;
+
+  const uint8_t down[] = {1, 0, 1};
+  const int16_t turn[] = {0, -3};
+  d.Feed(down, 3, turn, 2, At(0), &events);
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].type, ControlEventType::kTurn);
+  EXPECT_EQ(events[0].channel, 1);
+  EXPECT_EQ(events[0].detents, -3);
+  EXPECT_NEAR(events[0].delta, -0.06f, 1e-6f);
+  EXPECT_EQ(d.deadline(), At(500));
+
+  events.clear();
+  const uint8_t up[] = {0, 0, 0};
+  d.Feed(up, 3, turn, 0, At(100), &events);
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].channel, 0);
+  EXPECT_EQ(events[1].channel, 2);
+  for (const auto& e : events) EXPECT_EQ(e.type, ControlEventType::kShortPress);
+  EXPECT_EQ(d.deadline(), ControlClock::time_point::max());
+}
+
+#ifdef __linux__
+namespace {
+
+// A board on the other end of a pty: sends one line every 10 ms, like the
+// deej firmware, with each button's level and each encoder's detents
+// taken from a script.
+class ScriptedBoard {
+ public:
+  ScriptedBoard() {
+    char name[128] = {};
+    if (openpty(&master_, &slave_, name, nullptr, nullptr) == 0) {
+      close(slave_);
+      name_ = name;
+    }
+  }
+  ~ScriptedBoard() {
+    if (master_ >= 0) close(master_);
+  }
+
+  const std::string& name() const { return name_; }
+
+  // `lines` one per 10 ms tick; returns when all are sent. The time each
+  // line went out is in sent().
+  void Play(const std::vector<std::string>& lines) {
+    auto next = ControlClock::now();
+    for (const std::string& l : lines) {
+      std::this_thread::sleep_until(next);
+      const std::string line = l + "\r\n";
+      sent_.push_back(ControlClock::now());
+      if (write(master_, line.data(), line.size()) != (ssize_t)line.size()) return;
+      next += milliseconds(10);
+    }
+  }
+
+  const std::vector<ControlClock::time_point>& sent() const { return sent_; }
+
+ private:
+  int master_ = -1;
+  int slave_ = -1;
+  std::string name_;
+  std::vector<ControlClock::time_point> sent_;
+};
+
+// One slider, buttons 0 and 1, one encoder.
+std::string Frame(bool b0, bool b1, int detents) {
+  return std::string("512|b") + (b0 ? "1" : "0") + "|b" + (b1 ? "1" : "0") + "|e" + std::to_string(detents);
+}
+
+template <typename F>
+bool WaitFor(F&& done, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!done()) {
+    if (std::chrono::steady_clock::now() > deadline) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(ControlDecoder, EngineDecodesAScriptedBoard) {
+  ScriptedBoard board;
+  ASSERT_FALSE(board.name().empty());
+
+  FakeMixerBackend backend;
+  const std::string spotify = backend.AddSession("spotify.exe", 100);
+  backend.SetSessionVolume(spotify, 0.5f);
+  DeejConfig cfg;
+  cfg.button_mapping = {{0, {"master"}}, {1, {"spotify.exe"}}};
+  cfg.encoder_mapping = {{0, {"spotify.exe"}}};
+  DeckEngine engine(&backend, std::make_unique<SerialPort>(board.name(), 115200), cfg);
+
+  struct Seen {
+    ControlEvent event;
+    ControlClock::time_point at;
+  };
+  std::mutex mu;
+  std::vector<Seen> seen;
+  engine.SetControlObserver([&](const ControlEvent& e) {
+    std::lock_guard<std::mutex> lock(mu);
+    seen.push_back({e, ControlClock::now()});
+  });
+  ASSERT_TRUE(engine.Start());
+  ASSERT_TRUE(WaitFor([&] { return engine.stats().connected; }));
+
+  std::vector<std::string> script;
+  auto add = [&](int ticks, bool b0, bool b1, int detents) {
+    for (int i = 0; i < ticks; i++) script.push_back(Frame(b0, b1, i == 0 ? detents : 0));
+  };
+  add(5, false, false, 0);
+  add(8, true, false, 0);    // tick 5: button 0 down 80 ms -> short
+  add(40, false, false, 0);
+  add(70, false, true, 0);   // tick 53: button 1 held 700 ms -> long
+  add(10, false, false, 0);
+  add(5, true, false, 0);    // tick 133: button 0 twice -> double
+  add(10, false, false, 0);
+  add(5, true, false, 0);
+  add(30, false, false, 0);
+  for (int i = 0; i < 5; i++) add(30, false, false, 1);  // encoder, slowly: +5 steps
+  add(5, false, false, 0);
+  board.Play(script);
+  ASSERT_TRUE(WaitFor([&] { return engine.stats().turns == 5; }));
+  std::this_thread::sleep_for(milliseconds(50));
+  engine.Stop();
+
+  std::lock_guard<std::mutex> lock(mu);
+  std::vector<ControlEventType> types;
+  for (const Seen& s : seen) {
+    if (s.event.type != ControlEventType::kTurn) types.push_back(s.event.type);
+  }
+  ASSERT_EQ(types, (std::vector<ControlEventType>{ControlEventType::kShortPress, ControlEventType::kLongPress,
+                                                 ControlEventType::kDoublePress}));
+  // The short press landed a double press gap after the release (tick 13),
+  // the long press 500 ms into the hold (tick 53): each within a couple of
+  // board ticks, not a read timeout.
+  auto ms_after = [&](const Seen& s, size_t tick) {
+    return std::chrono::duration_cast<milliseconds>(s.at - board.sent()[tick]).count();
+  };
+  EXPECT_GE(ms_after(seen[0], 13), 250);
+  EXPECT_LT(ms_after(seen[0], 13), 250 + 40);
+  EXPECT_GE(ms_after(seen[1], 53), 500);
+  EXPECT_LT(ms_after(seen[1], 53), 500 + 40);
+
+  // Short press muted master; the double press is the app's to handle.
+  float volume = 0.0f, peak = 0.0f;
+  bool mute = false;
+  backend.GetMaster(&volume, &mute, &peak);
+  EXPECT_TRUE(mute);
+  EXPECT_FALSE(backend.session_mute(spotify));
+  EXPECT_NEAR(backend.session_volume(spotify), 0.5f + 5 * 0.02f, 1e-4f);
+  EXPECT_EQ(engine.stats().presses, 3u);
+}
+
+TEST(ControlDecoder, EngineMutesOnShortPressOnly) {
+  FakeMixerBackend backend;
+  const std::string chat = backend.AddSession("discord.exe", 100);
+  DeejConfig cfg;
+  cfg.button_mapping = {{0, {"discord.exe"}}};
+  DeckEngine engine(&backend, std::make_unique<SerialPort>("/nonexistent", 9600), cfg);
+  ButtonTiming timing;
+  timing.double_gap = milliseconds(0);
+  engine.SetControlTiming(timing, EncoderAccel());
+
+  // Released past the debounce: short, with no gap to wait for.
+  auto press = [&] {
+    engine.ProcessBytes("b1\n", 3);
+    std::this_thread::sleep_for(milliseconds(25));
+    engine.ProcessBytes("b0\n", 3);
+    std::this_thread::sleep_for(milliseconds(25));
+  };
+  press();
+  EXPECT_TRUE(backend.session_mute(chat));
+  press();
+  EXPECT_FALSE(backend.session_mute(chat));
+  EXPECT_EQ(engine.stats().presses, 2u);
+  EXPECT_EQ(engine.stats().moves, 0u);  // no sliders in these lines
+}
+#endif
+
+}  // namespace test
+}  // namespace volumedeck_mixer
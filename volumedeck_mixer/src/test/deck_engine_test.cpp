@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <pty.h>
+#include <unistd.h>
+#endif
+
+#include "deck_engine.h"
+#include "fake_mixer_backend.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+// Never connects; for driving the engine through ProcessBytes().
+class NullInput : public SliderInput {
+ public:
+  bool Open() override { return false; }
+  void Close() override {}
+  long Read(char*, size_t, int) override { return -1; }
+  long Write(const char*, size_t) override { return -1; }
+  std::string description() const override { return "null"; }
+};
+
+DeejConfig TwoSliders() {
+  DeejConfig cfg;
+  cfg.slider_mapping = {{0, {"master"}}, {1, {"music.exe"}}};
+  return cfg;
+}
+
+template <typename F>
+bool WaitFor(F&& done, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!done()) {
+    if (std::chrono::steady_clock::now() > deadline) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(DeckEngine, RunsLinesThroughToTheMixer) {
+  FakeMixerBackend backend;
+  const std::string music = backend.AddSession("music.exe", 5);
+  DeckEngine engine(&backend, std::make_unique<NullInput>(), TwoSliders());
+
+  const std::string lines = "1023|0\n1020|0\n512|256\n";
+  engine.ProcessBytes(lines.data(), lines.size());
+  EXPECT_FLOAT_EQ(backend.master_volume(), 0.5f);
+  EXPECT_FLOAT_EQ(backend.session_volume(music), 0.25f);
+
+  const DeckEngineStats s = engine.stats();
+  EXPECT_EQ(s.lines, 3u);
+  EXPECT_EQ(s.moves, 4u);  // both on the first line, both on the last
+  EXPECT_EQ(s.writes, 4u);
+  EXPECT_EQ(engine.slider_values(), (std::vector<float>{0.5f, 0.25f}));
+}
+
+TEST(DeckEngine, ControlOnlyLinesLeaveTheSlidersAlone) {
+  FakeMixerBackend backend;
+  const std::string music = backend.AddSession("music.exe", 5);
+  DeckEngine engine(&backend, std::make_unique<NullInput>(), TwoSliders());
+
+  const std::string lines = "512|512\nb1\n512|512\nb0\n512|512\n";
+  engine.ProcessBytes(lines.data(), lines.size());
+  const DeckEngineStats s = engine.stats();
+  EXPECT_EQ(s.lines, 5u);
+  EXPECT_EQ(s.moves, 2u);  // the first line only
+  EXPECT_EQ(s.writes, 2u);
+  EXPECT_NEAR(backend.session_volume(music), 0.5f, 1e-3f);
+  EXPECT_EQ(engine.slider_values().size(), 2u);
+}
+
+TEST(DeckEngine, ConfigUpdateRetargetsCurrentPositions) {
+  FakeMixerBackend backend;
+  const std::string music = backend.AddSession("music.exe", 5);
+  const std::string game = backend.AddSession("game.exe", 6);
+  DeckEngine engine(&backend, std::make_unique<NullInput>(), TwoSliders());
+
+  const std::string line = "0|716\n";
+  engine.ProcessBytes(line.data(), line.size());
+  EXPECT_FLOAT_EQ(backend.session_volume(game), 1.0f);
+
+  DeejConfig cfg = TwoSliders();
+  cfg.slider_mapping[1] = {"game.exe"};
+  engine.UpdateConfig(cfg);
+  engine.ProcessBytes(nullptr, 0);
+  EXPECT_FLOAT_EQ(backend.session_volume(game), 0.7f);
+}
+
+TEST(DeckEngine, ConfigUpdateAppliesOnlyWhatChanged) {
+  FakeMixerBackend backend;
+  const std::string music = backend.AddSession("music.exe", 5);
+  const std::string game = backend.AddSession("game.exe", 6);
+  const std::string chat = backend.AddSession("chat.exe", 7);
+  DeejConfig cfg = TwoSliders();
+  cfg.slider_mapping[2] = {"deej.unmapped"};
+  DeckEngine engine(&backend, std::make_unique<NullInput>(), cfg);
+  const std::string line = "512|716|205\n";
+  engine.ProcessBytes(line.data(), line.size());
+  EXPECT_FLOAT_EQ(backend.session_volume(game), 0.2f);
+
+  // Filter-only and no-op updates write nothing.
+  uint64_t writes = backend.write_count();
+  cfg.noise_reduction = "high";
+  engine.UpdateConfig(cfg);
+  engine.ProcessBytes(nullptr, 0);
+  engine.UpdateConfig(cfg);
+  engine.ProcessBytes(nullptr, 0);
+  EXPECT_EQ(backend.write_count(), writes);
+  EXPECT_EQ(engine.stats().config_updates, 1u);
+  EXPECT_EQ(engine.stats().last_config_keys, kConfigNoiseReduction);
+
+  // Retargeting slider 1 re-applies it and the catch-all, not master.
+  backend.SetMasterVolume(0.9f);
+  writes = backend.write_count();
+  cfg.slider_mapping[1] = {"game.exe"};
+  engine.UpdateConfig(cfg);
+  engine.ProcessBytes(nullptr, 0);
+  EXPECT_FLOAT_EQ(backend.master_volume(), 0.9f);
+  EXPECT_FLOAT_EQ(backend.session_volume(game), 0.7f);
+  EXPECT_FLOAT_EQ(backend.session_volume(music), 0.2f);  // unmapped now
+  EXPECT_FLOAT_EQ(backend.session_volume(chat), 0.2f);
+  EXPECT_EQ(backend.write_count(), writes + 3);
+  EXPECT_EQ(engine.stats().last_config_keys, kConfigSliderMapping);
+}
+
+TEST(DeckEngine, TakesMixerChangesWithNothingToConsumeThem) {
+  FakeMixerBackend backend;
+  const std::string music = backend.AddSession("music.exe", 42);
+  DeckEngine engine(&backend, std::make_unique<NullInput>(), TwoSliders());
+  ASSERT_TRUE(engine.Start());
+
+  // No board, no feedback, no state channel: still taken, once a frame.
+  backend.ChangeExternally({music, 0.25f, false});
+  EXPECT_TRUE(WaitFor([&] { return engine.stats().mixer_wakes == 1; }));
+  backend.ChangeExternally({music, 0.5f, false});
+  EXPECT_TRUE(WaitFor([&] { return engine.stats().mixer_wakes == 2; }));
+  engine.Stop();
+}
+
+TEST(DeckEngine, RestartsALostBackendWithBackoff) {
+  FakeMixerBackend backend;
+  DeckEngine engine(&backend, std::make_unique<NullInput>(), TwoSliders());
+  ASSERT_TRUE(engine.Start());
+  EXPECT_EQ(backend.start_count(), 1u);
+
+  // Restarted at once, then retried while the server stays away.
+  backend.SetStartFails(true);
+  backend.LoseConnection();
+  ASSERT_TRUE(WaitFor([&] { return backend.start_count() >= 3; }));
+  EXPECT_EQ(engine.stats().backend_restarts, 0u);
+  EXPECT_TRUE(backend.lost());
+
+  backend.SetStartFails(false);
+  EXPECT_TRUE(WaitFor([&] { return engine.stats().backend_restarts == 1; }));
+  EXPECT_FALSE(backend.lost());
+  const uint64_t starts = backend.start_count();
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  EXPECT_EQ(backend.start_count(), starts);
+  engine.Stop();
+}
+
+#ifdef __linux__
+// A pty stands in for the board's USB serial port.
+TEST(DeckEngine, ReadsABoardOverAPty) {
+  int master = -1, slave = -1;
+  char name[128] = {};
+  ASSERT_EQ(openpty(&master, &slave, name, nullptr, nullptr), 0);
+  close(slave);  // the engine opens it by path
+
+  FakeMixerBackend backend;
+  const std::string music = backend.AddSession("music.exe", 5);
+  DeckEngine engine(&backend, std::make_unique<SerialPort>(name, 9600), TwoSliders());
+  ASSERT_TRUE(engine.Start());
+  ASSERT_TRUE(WaitFor([&] { return engine.stats().connected; }));
+
+  const std::string lines = "0|0\n307|1023\n";
+  ASSERT_EQ(write(master, lines.data(), lines.size()), (ssize_t)lines.size());
+  EXPECT_TRUE(WaitFor([&] { return engine.stats().lines == 2; }));
+  EXPECT_FLOAT_EQ(backend.master_volume(), 0.3f);
+  EXPECT_FLOAT_EQ(backend.session_volume(music), 1.0f);
+  EXPECT_LT(engine.stats().max_apply_ns, 10'000'000u);
+
+  // Unplugging reports the board gone instead of spinning.
+  close(master);
+  EXPECT_TRUE(WaitFor([&] { return engine.stats().reconnects == 1; }));
+  EXPECT_FALSE(engine.stats().connected);
+  engine.Stop();
+}
+
+TEST(DeckEngine, ComPortChangeReconnectsAtOnce) {
+  int first = -1, second = -1, slave = -1;
+  char name[128] = {};
+  ASSERT_EQ(openpty(&first, &slave, name, nullptr, nullptr), 0);
+  close(slave);
+  FakeMixerBackend backend;
+  DeckEngine engine(&backend, std::make_unique<SerialPort>(name, 9600), TwoSliders());
+  ASSERT_TRUE(engine.Start());
+  ASSERT_TRUE(WaitFor([&] { return engine.stats().connected; }));
+
+  ASSERT_EQ(openpty(&second, &slave, name, nullptr, nullptr), 0);
+  close(slave);
+  DeejConfig cfg = TwoSliders();
+  cfg.com_port = name;
+  engine.UpdateConfig(cfg);
+  ASSERT_TRUE(WaitFor([&] { return engine.stats().config_updates == 1; }));
+
+  // Well inside the 2 s reconnect delay, and not counted as an unplug.
+  const std::string line = "1023|0\n";
+  ASSERT_EQ(write(second, line.data(), line.size()), (ssize_t)line.size());
+  EXPECT_TRUE(WaitFor([&] { return engine.stats().lines == 1; }, std::chrono::seconds(1)));
+  EXPECT_FLOAT_EQ(backend.master_volume(), 1.0f);
+  EXPECT_EQ(engine.stats().last_config_keys, kConfigComPort);
+  EXPECT_EQ(engine.stats().reconnects, 0u);
+  engine.Stop();
+  close(first);
+  close(second);
+}
+#endif
+
+}  // namespace test
+}  // namespace volumedeck_mixer
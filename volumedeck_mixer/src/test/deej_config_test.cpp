@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+
+#include "deej_config.h"
+#include "test_util.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+TEST(DeejConfig, ParsesTheStockConfig) {
+  const std::string text =
+      "# process names are case-insensitive\n"
+      "slider_mapping:\n"
+      "  0: master\n"
+      "  1: chrome.exe\n"
+      "  2: spotify.exe\n"
+      "  3:\n"
+      "    - pathofexile_x64.exe\n"
+      "    - \"rocketleague.exe\"\n"
+      "  4: [discord.exe, 'mic']\n"
+      "\n"
+      "invert_sliders: false\n"
+      "com_port: COM4  # the Arduino\n"
+      "baud_rate: 115200\n"
+      "noise_reduction: high\n";
+  DeejConfig cfg;
+  std::string error;
+  ASSERT_TRUE(ParseDeejConfig(text, &cfg, &error)) << error;
+  ASSERT_EQ(cfg.slider_mapping.size(), 5u);
+  EXPECT_EQ(cfg.slider_mapping[0], (std::vector<std::string>{"master"}));
+  EXPECT_EQ(cfg.slider_mapping[3], (std::vector<std::string>{"pathofexile_x64.exe", "rocketleague.exe"}));
+  EXPECT_EQ(cfg.slider_mapping[4], (std::vector<std::string>{"discord.exe", "mic"}));
+  EXPECT_FALSE(cfg.invert_sliders);
+  EXPECT_EQ(cfg.com_port, "COM4");
+  EXPECT_EQ(cfg.baud_rate, 115200);
+  EXPECT_EQ(cfg.noise_reduction, "high");
+}
+
+TEST(DeejConfig, ReportsTheOffendingLine) {
+  DeejConfig cfg;
+  std::string error;
+  EXPECT_FALSE(ParseDeejConfig("com_port: COM1\nbaud_rate: fast\n", &cfg, &error));
+  EXPECT_NE(error.find("line 2"), std::string::npos) << error;
+}
+
+TEST(DeejConfig, LoadsFromDisk) {
+  TempDir dir;
+  {
+    std::ofstream f(dir.File("config.yaml"));
+    f << "slider_mapping:\n  0: master\ninvert_sliders: true\n";
+  }
+  DeejConfig cfg;
+  ASSERT_TRUE(LoadDeejConfig(dir.File("config.yaml"), &cfg));
+  EXPECT_TRUE(cfg.invert_sliders);
+  EXPECT_FALSE(LoadDeejConfig(dir.File("missing.yaml"), &cfg));
+}
+
+TEST(DeejConfig, EmitsWhatTheAppWrites) {
+  DeejConfig cfg;
+  cfg.slider_mapping = {{0, {"master"}}, {1, {"chrome.exe", "spotify.exe"}}, {2, {}}};
+  cfg.com_port = "COM4";
+  const std::string text = EmitDeejConfig(cfg);
+  EXPECT_EQ(text.rfind("# process names are case-insensitive\n", 0), 0u);
+  EXPECT_NE(text.find("\n\nslider_mapping:\n  0: master\n  1:\n    - chrome.exe\n    - spotify.exe\n  2:\n\n"
+                      "invert_sliders: false\n\ncom_port: COM4\nbaud_rate: 9600\n\nnoise_reduction: default\n\n"),
+            std::string::npos)
+      << text;
+}
+
+TEST(DeejConfig, RoundTripsAwkwardValues) {
+  DeejConfig cfg;
+  cfg.slider_mapping = {{0, {"Speakers (Realtek High Definition Audio)"}},
+                        {3, {"# not a comment", "key: value", "[x]", "say \"hi\"", " padded"}},
+                        {7, {"-dash"}}};
+  cfg.invert_sliders = true;
+  cfg.com_port = "/dev/ttyACM0";
+  cfg.baud_rate = 115200;
+  cfg.noise_reduction = "high";
+  DeejConfig back;
+  std::string error;
+  ASSERT_TRUE(ParseDeejConfig(EmitDeejConfig(cfg), &back, &error)) << error;
+  EXPECT_EQ(back.slider_mapping, cfg.slider_mapping);
+  EXPECT_TRUE(DiffDeejConfig(cfg, back).empty());
+}
+
+TEST(DeejConfig, SavesAtomically) {
+  TempDir dir;
+  DeejConfig cfg;
+  cfg.baud_rate = 57600;
+  ASSERT_TRUE(SaveDeejConfig(dir.File("config.yaml"), cfg));
+  DeejConfig back;
+  ASSERT_TRUE(LoadDeejConfig(dir.File("config.yaml"), &back));
+  EXPECT_EQ(back.baud_rate, 57600);
+  EXPECT_FALSE(std::ifstream(dir.File("config.yaml.tmp")).good());
+  std::string error;
+  EXPECT_FALSE(SaveDeejConfig(dir.File("missing/config.yaml"), cfg, &error));
+  EXPECT_NE(error.find("missing"), std::string::npos);
+}
+
+TEST(DeejConfig, DiffsKeysAndSliders) {
+  DeejConfig a;
+  a.slider_mapping = {{0, {"master"}}, {1, {"a.exe"}}, {2, {"b.exe"}}};
+  DeejConfig b = a;
+  EXPECT_TRUE(DiffDeejConfig(a, b).empty());
+
+  b.slider_mapping[1] = {"a.exe", "c.exe"};
+  b.slider_mapping.erase(2);
+  b.slider_mapping[4] = {"mic"};
+  b.noise_reduction = "low";
+  const DeejConfigDiff d = DiffDeejConfig(a, b);
+  EXPECT_EQ(d.keys, kConfigSliderMapping | kConfigNoiseReduction);
+  EXPECT_EQ(d.sliders, (std::vector<int>{1, 2, 4}));
+
+  b = a;
+  b.com_port = "COM9";
+  b.invert_sliders = true;
+  EXPECT_EQ(DiffDeejConfig(a, b).keys, kConfigComPort | kConfigInvertSliders);
+  EXPECT_STREQ(DeejConfigKeyName(kConfigBaudRate), "baud_rate");
+}
+
+TEST(DeejConfig, CarriesButtonAndEncoderMappings) {
+  DeejConfig cfg;
+  // Without them the file is exactly what deej and the app expect.
+  EXPECT_EQ(EmitDeejConfig(cfg).find("button_mapping"), std::string::npos);
+
+  cfg.button_mapping = {{0, {"master"}}, {1, {"discord.exe", "teams.exe"}}};
+  cfg.encoder_mapping = {{0, {"spotify.exe"}}};
+  const std::string text = EmitDeejConfig(cfg);
+  EXPECT_NE(text.find("button_mapping:\n  0: master\n  1:\n    - discord.exe\n    - teams.exe\n\n"
+                      "encoder_mapping:\n  0: spotify.exe\n"),
+            std::string::npos)
+      << text;
+  DeejConfig back;
+  std::string error;
+  ASSERT_TRUE(ParseDeejConfig(text, &back, &error)) << error;
+  EXPECT_EQ(back.button_mapping, cfg.button_mapping);
+  EXPECT_EQ(back.encoder_mapping, cfg.encoder_mapping);
+  EXPECT_TRUE(DiffDeejConfig(cfg, back).empty());
+
+  back.encoder_mapping[0] = {"master"};
+  const DeejConfigDiff d = DiffDeejConfig(cfg, back);
+  EXPECT_EQ(d.keys, kConfigEncoderMapping);
+  EXPECT_TRUE(d.sliders.empty());
+  EXPECT_STREQ(DeejConfigKeyName(kConfigButtonMapping), "button_mapping");
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
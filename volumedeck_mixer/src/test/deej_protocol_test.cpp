@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "deej_protocol.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+std::vector<std::vector<uint16_t>> FeedAll(SliderLineParser& p, const std::string& bytes) {
+  std::vector<std::vector<uint16_t>> lines;
+  p.Feed(bytes.data(), bytes.size(), [&](const uint16_t* v, size_t n) {
+    lines.emplace_back(v, v + n);
+  });
+  return lines;
+}
+
+}  // namespace
+
+TEST(SliderLineParser, ParsesLinesSplitAcrossReads) {
+  SliderLineParser p;
+  std::vector<std::vector<uint16_t>> lines;
+  const std::string stream = "0|512|1023\r\n100|2";
+  for (char c : stream) {
+    p.Feed(&c, 1, [&](const uint16_t* v, size_t n) { lines.emplace_back(v, v + n); });
+  }
+  ASSERT_EQ(lines.size(), 1u);
+  EXPECT_EQ(lines[0], (std::vector<uint16_t>{0, 512, 1023}));
+
+  lines = FeedAll(p, "00\n");
+  ASSERT_EQ(lines.size(), 1u);
+  EXPECT_EQ(lines[0], (std::vector<uint16_t>{100, 200}));
+  EXPECT_EQ(p.lines(), 2u);
+  EXPECT_EQ(p.malformed(), 0u);
+}
+
+TEST(SliderLineParser, DropsMalformedLinesAndResyncs) {
+  SliderLineParser p;
+  const auto lines = FeedAll(p,
+                             "1024|5\n"    // out of range
+                             "12a|5\n"     // garbage
+                             "||\n"        // empty fields
+                             "1\r2\n"      // stray CR
+                             "00001|5\n"   // too many digits
+                             "7|8\n");
+  ASSERT_EQ(lines.size(), 1u);
+  EXPECT_EQ(lines[0], (std::vector<uint16_t>{7, 8}));
+  EXPECT_EQ(p.malformed(), 5u);
+}
+
+TEST(SliderLineParser, DropsOverlongLines) {
+  SliderLineParser p;
+  std::string line;
+  for (size_t i = 0; i <= SliderLineParser::kMaxSliders; i++) line += "1|";
+  line += "1\n3\n";
+  const auto lines = FeedAll(p, line);
+  ASSERT_EQ(lines.size(), 1u);
+  EXPECT_EQ(lines[0], (std::vector<uint16_t>{3}));
+}
+
+TEST(SliderLineParser, NumbersButtonsAndEncodersApartFromSliders) {
+  SliderLineParser p;
+  std::vector<std::vector<uint16_t>> sliders;
+  std::vector<std::vector<uint8_t>> buttons;
+  std::vector<std::vector<int16_t>> encoders;
+  const std::string stream =
+      "512|b0|1023|e-2|b1\r\n"
+      "b1|e+3|e0\n"
+      "b2|5\n"     // a button is 0 or 1
+      "e|5\n"      // no detents
+      "e-|5\n"
+      "be1|5\n"
+      "5|1b\n"     // prefix after digits
+      "7\n";
+  p.Feed(stream.data(), stream.size(), [&](const uint16_t* v, size_t n) {
+    sliders.emplace_back(v, v + n);
+    buttons.emplace_back(p.buttons(), p.buttons() + p.button_count());
+    encoders.emplace_back(p.encoders(), p.encoders() + p.encoder_count());
+  });
+  ASSERT_EQ(sliders.size(), 3u);
+  EXPECT_EQ(sliders[0], (std::vector<uint16_t>{512, 1023}));
+  EXPECT_EQ(buttons[0], (std::vector<uint8_t>{0, 1}));
+  EXPECT_EQ(encoders[0], (std::vector<int16_t>{-2}));
+  EXPECT_TRUE(sliders[1].empty());
+  EXPECT_EQ(buttons[1], (std::vector<uint8_t>{1}));
+  EXPECT_EQ(encoders[1], (std::vector<int16_t>{3, 0}));
+  EXPECT_EQ(sliders[2], (std::vector<uint16_t>{7}));
+  EXPECT_TRUE(buttons[2].empty());
+  EXPECT_TRUE(encoders[2].empty());
+  EXPECT_EQ(p.malformed(), 5u);
+}
+
+TEST(SliderFilter, NormalizesLikeDeej) {
+  EXPECT_FLOAT_EQ(SliderFilter::Normalize(0, false), 0.0f);
+  EXPECT_FLOAT_EQ(SliderFilter::Normalize(1023, false), 1.0f);
+  EXPECT_FLOAT_EQ(SliderFilter::Normalize(512, false), 0.5f);
+  EXPECT_FLOAT_EQ(SliderFilter::Normalize(1023, true), 0.0f);
+}
+
+TEST(SliderFilter, ReportsOnlyMovesPastTheThreshold) {
+  SliderFilter f(false, NoiseReduction::kDefault);
+  std::vector<size_t> changed;
+  const uint16_t first[] = {500, 500};
+  f.Apply(first, 2, &changed);
+  EXPECT_EQ(changed, (std::vector<size_t>{0, 1}));
+
+  // 0.01 of jitter is below the default 0.025.
+  const uint16_t jitter[] = {510, 490};
+  f.Apply(jitter, 2, &changed);
+  EXPECT_TRUE(changed.empty());
+
+  const uint16_t moved[] = {500, 560};
+  f.Apply(moved, 2, &changed);
+  EXPECT_EQ(changed, (std::vector<size_t>{1}));
+  EXPECT_FLOAT_EQ(f.value(1), 0.55f);
+}
+
+TEST(SliderFilter, AlwaysReachesTheEnds) {
+  SliderFilter f(false, NoiseReduction::kHigh);
+  std::vector<size_t> changed;
+  const uint16_t near_top[] = {1010};
+  f.Apply(near_top, 1, &changed);
+  const uint16_t top[] = {1023};
+  f.Apply(top, 1, &changed);
+  EXPECT_EQ(changed.size(), 1u);
+  EXPECT_FLOAT_EQ(f.value(0), 1.0f);
+  f.Apply(top, 1, &changed);
+  EXPECT_TRUE(changed.empty());
+}
+
+TEST(SliderFilter, SliderCountChangeReportsEverything) {
+  SliderFilter f;
+  std::vector<size_t> changed;
+  const uint16_t two[] = {100, 200};
+  f.Apply(two, 2, &changed);
+  const uint16_t three[] = {100, 200, 300};
+  f.Apply(three, 3, &changed);
+  EXPECT_EQ(changed, (std::vector<size_t>{0, 1, 2}));
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "deck_engine.h"
+#include "echo_filter.h"
+#include "fake_mixer_backend.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+using std::chrono::milliseconds;
+
+const EchoFilter::Clock::time_point kT0 = EchoFilter::Clock::time_point{} + std::chrono::hours(1);
+
+EchoFilter::Clock::time_point At(int ms) { return kT0 + milliseconds(ms); }
+
+MixerContext Other() {
+  MixerContext c;
+  c.bytes[3] = 7;
+  return c;
+}
+
+class NullInput : public SliderInput {
+ public:
+  bool Open() override { return false; }
+  void Close() override {}
+  long Read(char*, size_t, int) override { return -1; }
+  long Write(const char*, size_t) override { return -1; }
+  std::string description() const override { return "null"; }
+};
+
+// Collects what a backend reports, from any thread.
+struct Seen {
+  std::mutex mu;
+  std::vector<MixerChange> changes;
+
+  MixerChangeObserver observer() {
+    return [this](const MixerChange& c) {
+      std::lock_guard<std::mutex> lock(mu);
+      changes.push_back(c);
+    };
+  }
+  size_t size() {
+    std::lock_guard<std::mutex> lock(mu);
+    return changes.size();
+  }
+};
+
+}  // namespace
+
+TEST(MixerContext, IsOnePerProcessAndNeverNull) {
+  const MixerContext& a = ProcessMixerContext();
+  EXPECT_FALSE(a.empty());
+  EXPECT_EQ(&a, &ProcessMixerContext());
+  EXPECT_EQ(a.bytes[7] >> 4, 4);  // version 4, as a GUID
+  EXPECT_NE(a, Other());
+  EXPECT_TRUE(MixerContext().empty());
+}
+
+TEST(EchoFilter, DropsWritesTaggedAsOurs) {
+  EchoFilter f;
+  f.NoteVolume("", 0.4f, At(0));
+  EXPECT_FALSE(f.External({"", 0.4f, false}, &ProcessMixerContext(), At(5)));
+  EXPECT_EQ(f.in_flight(), 0u);
+  // Tagged as ours is ours, even with nothing in flight (a write the
+  // plugin made, say).
+  EXPECT_FALSE(f.External({"", 0.9f, false}, &ProcessMixerContext(), At(10)));
+  // Another process setting the same value is a change.
+  EXPECT_TRUE(f.External({"", 0.4f, false}, nullptr, At(20)));
+  const MixerContext other = Other();
+  EXPECT_TRUE(f.External({"", 0.4f, false}, &other, At(40)));
+  EXPECT_EQ(f.echoes(), 2u);
+}
+
+TEST(EchoFilter, DropsUntaggedEchoesOfWritesInFlight) {
+  EchoFilter f;
+  // A slider dragged: three writes before the first notification.
+  f.NoteVolume("s1", 0.3f, At(0));
+  f.NoteVolume("s1", 0.5f, At(10));
+  f.NoteVolume("s1", 0.7f, At(20));
+  EXPECT_EQ(f.in_flight(), 3u);
+  // The echo of 0.3 was merged away; 0.5's arrives late, after the write
+  // of 0.7. Stale, but ours: dropped, and 0.3 retired with it.
+  EXPECT_FALSE(f.External({"s1", 0.5f, false}, nullptr, At(30)));
+  EXPECT_EQ(f.in_flight(), 1u);
+  EXPECT_FALSE(f.External({"s1", 0.70001f, false}, nullptr, At(35)));
+  EXPECT_EQ(f.in_flight(), 0u);
+  // Someone setting it to 0.7 again later is theirs.
+  EXPECT_TRUE(f.External({"s1", 0.7f, false}, nullptr, At(40)));
+  // Other targets are other targets.
+  f.NoteVolume("s1", 0.2f, At(50));
+  EXPECT_TRUE(f.External({"s2", 0.2f, false}, nullptr, At(55)));
+  EXPECT_EQ(f.echoes(), 2u);
+}
+
+TEST(EchoFilter, TellsAnExternalMuteFromOurVolumeWrite) {
+  EchoFilter f;
+  f.NoteMute("", false, At(0));
+  EXPECT_FALSE(f.External({"", 0.6f, false}, nullptr, At(5)));
+  // Our volume write in flight; the notification that comes says muted,
+  // which our write didn't do.
+  f.NoteVolume("", 0.6f, At(10));
+  EXPECT_TRUE(f.External({"", 0.6f, true}, nullptr, At(15)));
+  f.NoteMute("", false, At(20));
+  EXPECT_FALSE(f.External({"", 0.6f, false}, nullptr, At(25)));
+}
+
+TEST(EchoFilter, ForgetsWritesThatNeverEchoed) {
+  EchoFilter f(milliseconds(500));
+  f.NoteVolume("", 0.5f, At(0));
+  EXPECT_TRUE(f.External({"", 0.5f, false}, nullptr, At(500)));
+  EXPECT_EQ(f.in_flight(), 0u);
+}
+
+TEST(EchoFilter, ForgetsTargetsGoneQuiet) {
+  EchoFilter f;
+  // Sessions come and go; each leaves an entry behind.
+  for (int i = 0; i < 100; i++) {
+    const std::string id = "sink-input-" + std::to_string(i);
+    f.NoteVolume(id, 0.5f, At(i));
+    EXPECT_FALSE(f.External({id, 0.5f, false}, nullptr, At(i + 5)));
+  }
+  EXPECT_EQ(f.targets(), 100u);
+
+  // One still in use keeps its last known mute: the volume write is
+  // stamped with it and an external mute still tells.
+  const int later = 40000;
+  f.NoteMute("", false, At(later - 20000));
+  f.NoteVolume("", 0.6f, At(later));
+  EXPECT_EQ(f.targets(), 1u);
+  EXPECT_TRUE(f.External({"", 0.6f, true}, nullptr, At(later + 5)));
+  EXPECT_EQ(f.in_flight(), 1u);
+}
+
+TEST(EchoFilter, FakeBackendReportsOnlyExternalChanges) {
+  FakeMixerBackend backend;
+  const std::string game = backend.AddSession("game.exe", 100);
+  Seen seen;
+  ASSERT_TRUE(backend.SetChangeObserver(seen.observer()));
+
+  backend.SetMasterVolume(0.3f);
+  backend.SetSessionVolume(game, 0.8f);
+  backend.SetSessionMute(game, true);
+  EXPECT_EQ(seen.size(), 0u);
+  EXPECT_EQ(backend.echoes(), 3u);
+
+  backend.ChangeExternally({game, 0.25f, true});
+  ASSERT_EQ(seen.size(), 1u);
+  EXPECT_EQ(seen.changes[0].id, game);
+  EXPECT_FLOAT_EQ(seen.changes[0].volume, 0.25f);
+  EXPECT_FLOAT_EQ(backend.session_volume(game), 0.25f);
+
+  // No context on our notifications: the in-flight writes catch them.
+  backend.SetTagWrites(false);
+  backend.SetSessionVolume(game, 0.4f);
+  backend.SetMasterMute(true);
+  EXPECT_EQ(seen.size(), 1u);
+
+  // Late: a burst of writes whose notifications come after the last of
+  // them, with an external change in the middle.
+  backend.HoldChanges(true);
+  for (float v : {0.1f, 0.2f, 0.3f}) backend.SetSessionVolume(game, v);
+  backend.ChangeExternally({"", 0.9f, true});
+  backend.SetSessionVolume(game, 0.35f);
+  backend.HoldChanges(false);
+  EXPECT_EQ(backend.DeliverChanges(), 5u);
+  ASSERT_EQ(seen.size(), 2u);
+  EXPECT_EQ(seen.changes[1].id, "");
+  EXPECT_FLOAT_EQ(seen.changes[1].volume, 0.9f);
+}
+
+TEST(EchoFilter, EngineCountsOnlyExternalChanges) {
+  FakeMixerBackend backend;
+  const std::string chat = backend.AddSession("discord.exe", 100);
+  DeejConfig cfg;
+  cfg.slider_mapping = {{0, {"master"}}, {1, {"discord.exe"}}};
+  DeckEngine engine(&backend, std::make_unique<NullInput>(), cfg);
+
+  for (int i = 0; i < 20; i++) {
+    const std::string line = std::to_string(i * 50) + "|" + std::to_string(1000 - i * 50) + "\n";
+    engine.ProcessBytes(line.data(), line.size());
+  }
+  EXPECT_GT(engine.stats().writes, 30u);
+  EXPECT_EQ(engine.stats().mixer_changes, 0u);
+
+  backend.ChangeExternally({chat, 0.1f, false});
+  backend.ChangeExternally({"", 0.2f, true});
+  EXPECT_EQ(engine.stats().mixer_changes, 2u);
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
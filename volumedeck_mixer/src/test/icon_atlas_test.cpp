@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "icon_atlas.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+IconImage Filled(int w, int h, uint8_t seed) {
+  IconImage img;
+  img.width = w;
+  img.height = h;
+  img.rgba.resize((size_t)w * h * 4);
+  for (size_t i = 0; i < img.rgba.size(); i++) img.rgba[i] = (uint8_t)(seed + i * 13);
+  return img;
+}
+
+bool Overlap(const AtlasRect& a, const AtlasRect& b) {
+  return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+// The icon's pixels, read back out of the sheet.
+std::vector<uint8_t> Crop(const IconAtlas& atlas, const AtlasRect& r) {
+  std::vector<uint8_t> out;
+  for (int y = 0; y < r.height; y++) {
+    const uint8_t* row = &atlas.rgba()[((size_t)(r.y + y) * atlas.width() + r.x) * 4];
+    out.insert(out.end(), row, row + (size_t)r.width * 4);
+  }
+  return out;
+}
+
+}  // namespace
+
+TEST(SkylinePacker, PacksUniformCellsWithoutGaps) {
+  SkylinePacker p(100, 100);
+  std::vector<AtlasRect> rects;
+  AtlasRect r;
+  while (p.Insert(20, 20, &r)) rects.push_back(r);
+  EXPECT_EQ(rects.size(), 25u);
+  EXPECT_EQ(p.used_area(), 100u * 100u);
+  for (size_t i = 0; i < rects.size(); i++) {
+    for (size_t j = i + 1; j < rects.size(); j++) EXPECT_FALSE(Overlap(rects[i], rects[j]));
+  }
+}
+
+TEST(SkylinePacker, MixedSizesPackDensely) {
+  std::mt19937 rng(7);
+  SkylinePacker p(512, 4096);
+  std::vector<AtlasRect> rects;
+  for (int i = 0; i < 300; i++) {
+    const int s = 16 + (int)(rng() % 33);  // 16..48, the pyramid range
+    AtlasRect r;
+    ASSERT_TRUE(p.Insert(s, s, &r));
+    ASSERT_LE(r.x + r.width, 512);
+    rects.push_back(r);
+  }
+  for (size_t i = 0; i < rects.size(); i++) {
+    for (size_t j = i + 1; j < rects.size(); j++) ASSERT_FALSE(Overlap(rects[i], rects[j])) << i << " " << j;
+  }
+  const double density = (double)p.used_area() / (512.0 * p.used_height());
+  EXPECT_GT(density, 0.8) << density;
+}
+
+TEST(SkylinePacker, GrowKeepsPlacementsAndMakesRoom) {
+  SkylinePacker p(64, 32);
+  AtlasRect a, b, c;
+  ASSERT_TRUE(p.Insert(64, 32, &a));
+  EXPECT_FALSE(p.Insert(16, 16, &b));
+  p.Grow(64);
+  ASSERT_TRUE(p.Insert(16, 16, &b));
+  EXPECT_EQ(b.y, 32);
+  EXPECT_FALSE(p.Insert(65, 1, &c));  // wider than the sheet, never fits
+}
+
+TEST(IconAtlas, AppendsWithoutMovingExistingIcons) {
+  IconAtlas atlas(128, 1, 1024);
+  std::vector<std::pair<AtlasRect, std::vector<uint8_t>>> placed;
+
+  for (int round = 0; round < 5; round++) {
+    for (int i = 0; i < 12; i++) {
+      const std::string key = "app" + std::to_string(round) + "_" + std::to_string(i);
+      const IconImage img = Filled(20, 20, (uint8_t)(round * 12 + i));
+      AtlasRect r;
+      ASSERT_TRUE(atlas.Add(key, img, &r));
+      placed.emplace_back(r, img.rgba);
+    }
+    // Everything added so far is exactly where, and what, it was.
+    for (const auto& p : placed) ASSERT_EQ(Crop(atlas, p.first), p.second);
+  }
+  EXPECT_EQ(atlas.count(), 60u);
+  EXPECT_GT(atlas.height(), 64);  // had to grow
+  EXPECT_GT(atlas.occupancy(), 0.75);
+}
+
+TEST(IconAtlas, ExistingKeyIsNotAddedTwice) {
+  IconAtlas atlas;
+  AtlasRect a, b;
+  ASSERT_TRUE(atlas.Add("c:/x/app.exe", Filled(20, 20, 1), &a));
+  const uint32_t v = atlas.version();
+  ASSERT_TRUE(atlas.Add("c:/x/app.exe", Filled(20, 20, 2), &b));
+  EXPECT_EQ(a.x, b.x);
+  EXPECT_EQ(a.y, b.y);
+  EXPECT_EQ(atlas.version(), v);
+  EXPECT_EQ(Crop(atlas, a), Filled(20, 20, 1).rgba);
+
+  AtlasRect found;
+  EXPECT_TRUE(atlas.Find("c:/x/app.exe", &found));
+  EXPECT_FALSE(atlas.Find("c:/x/other.exe", &found));
+}
+
+TEST(IconAtlas, PaddingSeparatesNeighbours) {
+  IconAtlas atlas(64, 2, 256);
+  AtlasRect a, b;
+  ASSERT_TRUE(atlas.Add("a", Filled(20, 20, 1), &a));
+  ASSERT_TRUE(atlas.Add("b", Filled(20, 20, 2), &b));
+  EXPECT_EQ(b.y, a.y);
+  EXPECT_EQ(b.x, a.x + 22);
+  for (int y = 0; y < 20; y++) {
+    for (int x = 20; x < 22; x++) EXPECT_EQ(atlas.rgba()[((size_t)y * 64 + x) * 4 + 3], 0);
+  }
+}
+
+TEST(IconAtlas, ReportsDirtyRowsAndFullSheet) {
+  IconAtlas atlas(64, 1, 64);
+  int first = 0, last = 0;
+  EXPECT_FALSE(atlas.RowsChangedSince(0, &first, &last));
+
+  AtlasRect r;
+  ASSERT_TRUE(atlas.Add("a", Filled(32, 32, 1), &r));
+  const uint32_t v1 = atlas.version();
+  ASSERT_TRUE(atlas.RowsChangedSince(0, &first, &last));
+  EXPECT_EQ(first, 0);
+  EXPECT_EQ(last, 32);
+  EXPECT_FALSE(atlas.RowsChangedSince(v1, &first, &last));
+
+  ASSERT_TRUE(atlas.Add("b", Filled(30, 30, 2), &r));
+  ASSERT_TRUE(atlas.Add("c", Filled(30, 30, 3), &r));
+  // c went below a; a caller at v1 needs only the rows from there down,
+  // one that never saw anything needs them all.
+  ASSERT_TRUE(atlas.RowsChangedSince(v1, &first, &last));
+  EXPECT_EQ(first, 0);
+  EXPECT_EQ(last, r.y + 30);
+  ASSERT_TRUE(atlas.RowsChangedSince(v1 + 1, &first, &last));
+  EXPECT_EQ(first, r.y);
+  EXPECT_EQ(last, r.y + 30);
+  // 64x64 max: a fourth 30 px icon (31 with padding) cannot fit.
+  ASSERT_TRUE(atlas.Add("d", Filled(30, 30, 4), &r));
+  EXPECT_FALSE(atlas.Add("e", Filled(30, 30, 5), &r));
+  EXPECT_FALSE(atlas.Find("e", &r));
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
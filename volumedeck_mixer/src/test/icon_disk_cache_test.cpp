@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "file_util.h"
+#include "icon_disk_cache.h"
+#include "test_util.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+IconCacheKey Key(int i, uint16_t icon_size = 20) {
+  IconCacheKey k;
+  k.path = "c:/apps/app" + std::to_string(i) + ".exe";
+  k.file_size = 1000 + (uint64_t)i;
+  k.mtime = 42;
+  k.icon_size = icon_size;
+  return k;
+}
+
+std::vector<uint8_t> Png(int i) { return std::vector<uint8_t>(200 + i, (uint8_t)i); }
+
+}  // namespace
+
+TEST(IconDiskCache, SurvivesRestart) {
+  TempDir dir;
+  const std::string pack = dir.File("icons.pack");
+
+  {
+    IconDiskCache cache(pack);
+    for (int i = 0; i < 200; i++) cache.Insert(Key(i), IconFormat::kPng, Png(i));
+  }  // destructor compacts
+
+  // Second "launch": every icon the picker asks for is a hit.
+  IconDiskCache cache(pack);
+  EXPECT_EQ(cache.packed_count(), 200u);
+  std::vector<uint8_t> out;
+  for (int i = 0; i < 200; i++) {
+    ASSERT_TRUE(cache.Lookup(Key(i), out)) << i;
+    EXPECT_EQ(out, Png(i));
+  }
+  EXPECT_FALSE(cache.Lookup(Key(0, 32), out));
+}
+
+TEST(IconDiskCache, PendingEntriesAreVisibleBeforeCompaction) {
+  TempDir dir;
+  IconDiskCache cache(dir.File("icons.pack"));
+  cache.Insert(Key(1), IconFormat::kPng, Png(1));
+
+  std::vector<uint8_t> out;
+  EXPECT_TRUE(cache.Lookup(Key(1), out));
+  EXPECT_EQ(cache.pending_count(), 1u);
+  EXPECT_EQ(cache.packed_count(), 0u);
+}
+
+TEST(IconDiskCache, UpdatedExeReplacesEntry) {
+  TempDir dir;
+  const std::string pack = dir.File("icons.pack");
+
+  IconDiskCache cache(pack);
+  cache.Insert(Key(1), IconFormat::kPng, Png(1));
+  ASSERT_TRUE(cache.Compact());
+
+  IconCacheKey updated = Key(1);
+  updated.mtime = 43;
+  std::vector<uint8_t> out;
+  EXPECT_FALSE(cache.Lookup(updated, out));
+
+  cache.Insert(updated, IconFormat::kPng, Png(7));
+  ASSERT_TRUE(cache.Compact());
+  EXPECT_EQ(cache.packed_count(), 1u);
+  ASSERT_TRUE(cache.Lookup(updated, out));
+  EXPECT_EQ(out, Png(7));
+  EXPECT_FALSE(cache.Lookup(Key(1), out));
+}
+
+TEST(IconDiskCache, PngAndRawPixelsDoNotEvictEachOther) {
+  TempDir dir;
+  const std::string pack = dir.File("icons.pack");
+
+  IconDiskCache cache(pack);
+  cache.Insert(Key(1), IconFormat::kPng, Png(1));
+  cache.Insert(Key(1), IconFormat::kRgba8Premul, Png(2));
+  std::vector<uint8_t> out;
+  for (int pass = 0; pass < 2; pass++) {
+    ASSERT_TRUE(cache.Lookup(Key(1), out, IconFormat::kPng)) << pass;
+    EXPECT_EQ(out, Png(1));
+    ASSERT_TRUE(cache.Lookup(Key(1), out, IconFormat::kRgba8Premul)) << pass;
+    EXPECT_EQ(out, Png(2));
+    ASSERT_TRUE(cache.Compact());
+  }
+  EXPECT_EQ(cache.packed_count(), 2u);
+}
+
+TEST(IconDiskCache, BackgroundCompactionAfterQuietPeriod) {
+  TempDir dir;
+  IconDiskCache cache(dir.File("icons.pack"));
+  cache.StartBackgroundCompaction(std::chrono::milliseconds(20));
+
+  for (int i = 0; i < 10; i++) cache.Insert(Key(i), IconFormat::kPng, Png(i));
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (cache.pending_count() != 0 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_EQ(cache.pending_count(), 0u);
+  EXPECT_EQ(cache.packed_count(), 10u);
+}
+
+TEST(IconDiskCache, CorruptPackIsRebuilt) {
+  TempDir dir;
+  const std::string pack = dir.File("icons.pack");
+  const char junk[] = "not a pack";
+  ASSERT_TRUE(WriteFileAtomic(pack, junk, sizeof(junk)));
+
+  IconDiskCache cache(pack);
+  std::vector<uint8_t> out;
+  EXPECT_FALSE(cache.Lookup(Key(1), out));
+  cache.Insert(Key(1), IconFormat::kPng, Png(1));
+  ASSERT_TRUE(cache.Compact());
+  EXPECT_EQ(cache.packed_count(), 1u);
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
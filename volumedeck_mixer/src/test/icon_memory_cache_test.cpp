@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "icon_memory_cache.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+IconCacheKey Key(const std::string& path, int64_t mtime = 1) {
+  IconCacheKey k;
+  k.path = path;
+  k.file_size = 100;
+  k.mtime = mtime;
+  return k;
+}
+
+// Pyramid whose byte_size() is exactly `bytes` (multiple of 4).
+std::shared_ptr<const IconPyramid> Pyramid(size_t bytes) {
+  auto p = std::make_shared<IconPyramid>();
+  p->source.width = (int)(bytes / 4);
+  p->source.height = 1;
+  p->source.rgba.resize(bytes);
+  return p;
+}
+
+}  // namespace
+
+TEST(IconMemoryCache, EvictsLeastRecentlyUsedByBytes) {
+  IconMemoryCache cache(1000);
+  cache.Put(Key("a"), Pyramid(400));
+  cache.Put(Key("b"), Pyramid(400));
+  ASSERT_NE(cache.Get(Key("a")), nullptr);  // a is now most recent
+
+  cache.Put(Key("c"), Pyramid(400));  // over budget: b goes
+  EXPECT_NE(cache.Get(Key("a")), nullptr);
+  EXPECT_EQ(cache.Get(Key("b")), nullptr);
+  EXPECT_NE(cache.Get(Key("c")), nullptr);
+  EXPECT_EQ(cache.bytes(), 800u);
+  EXPECT_EQ(cache.evictions(), 1u);
+}
+
+TEST(IconMemoryCache, StaleStatIsAMiss) {
+  IconMemoryCache cache(1000);
+  cache.Put(Key("a", 1), Pyramid(100));
+  EXPECT_EQ(cache.Get(Key("a", 2)), nullptr);
+  EXPECT_EQ(cache.count(), 0u);  // dropped, not just skipped
+  EXPECT_EQ(cache.bytes(), 0u);
+}
+
+TEST(IconMemoryCache, ReplacesAndRejectsOversized) {
+  IconMemoryCache cache(1000);
+  cache.Put(Key("a"), Pyramid(100));
+  cache.Put(Key("a"), Pyramid(300));
+  EXPECT_EQ(cache.count(), 1u);
+  EXPECT_EQ(cache.bytes(), 300u);
+
+  cache.Put(Key("big"), Pyramid(2000));
+  EXPECT_EQ(cache.Get(Key("big")), nullptr);
+  EXPECT_EQ(cache.bytes(), 300u);
+}
+
+TEST(IconMemoryCache, EvictedPyramidStaysUsable) {
+  IconMemoryCache cache(500);
+  cache.Put(Key("a"), Pyramid(400));
+  auto held = cache.Get(Key("a"));
+  cache.Put(Key("b"), Pyramid(400));
+  EXPECT_EQ(cache.Get(Key("a")), nullptr);
+  ASSERT_NE(held, nullptr);
+  EXPECT_EQ(held->byte_size(), 400u);
+}
+
+TEST(IconMemoryCache, ConcurrentUseStaysWithinBudget) {
+  IconMemoryCache cache(10000);
+  std::vector<std::thread> threads;
+  std::atomic<bool> over{false};
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < 2000; i++) {
+        const std::string path = "exe" + std::to_string((i * 7 + t) % 64);
+        if (!cache.Get(Key(path))) cache.Put(Key(path), Pyramid(400 + 4 * (i % 50)));
+        if (cache.bytes() > cache.byte_budget()) over = true;
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+  EXPECT_FALSE(over.load());
+  EXPECT_GT(cache.hits() + cache.misses(), 0u);
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "file_util.h"
+#include "icon_pack.h"
+#include "test_util.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+IconCacheKey Key(const std::string& path, uint16_t icon_size, int64_t mtime = 100) {
+  IconCacheKey k;
+  k.path = NormalizeIconPath(path);
+  k.file_size = 4096;
+  k.mtime = mtime;
+  k.icon_size = icon_size;
+  return k;
+}
+
+std::vector<uint8_t> Bytes(uint8_t seed, size_t n) {
+  std::vector<uint8_t> v(n);
+  for (size_t i = 0; i < n; i++) v[i] = (uint8_t)(seed + i * 7);
+  return v;
+}
+
+}  // namespace
+
+TEST(IconPack, NormalizesWindowsPaths) {
+  EXPECT_EQ(NormalizeIconPath("C:\\Program Files\\\\Chrome\\CHROME.EXE"),
+            "c:/program files/chrome/chrome.exe");
+  EXPECT_EQ(NormalizeIconPath("\\\\server\\share\\App.exe"), "//server/share/app.exe");
+}
+
+TEST(IconPack, RoundTripsThroughFile) {
+  TempDir dir;
+  const std::string pack = dir.File("icons.pack");
+
+  IconPackWriter w;
+  auto chrome = Bytes(1, 300);
+  auto discord = Bytes(2, 123);
+  w.Add(Key("C:\\a\\chrome.exe", 20), IconFormat::kPng, chrome.data(), chrome.size());
+  w.Add(Key("C:\\a\\discord.exe", 20), IconFormat::kPng, discord.data(), discord.size());
+  ASSERT_TRUE(w.WriteTo(pack));
+
+  IconPackReader r;
+  ASSERT_TRUE(r.Open(pack));
+  EXPECT_EQ(r.entry_count(), 2u);
+
+  IconBlob b;
+  ASSERT_TRUE(r.Find(Key("c:/a/chrome.exe", 20), &b));
+  ASSERT_EQ(b.size, chrome.size());
+  EXPECT_EQ(memcmp(b.data, chrome.data(), b.size), 0);
+
+  ASSERT_TRUE(r.Find(Key("C:\\A\\Discord.exe", 20), &b));
+  EXPECT_EQ(memcmp(b.data, discord.data(), b.size), 0);
+
+  EXPECT_FALSE(r.Find(Key("c:/a/chrome.exe", 32), &b));
+  EXPECT_FALSE(r.Find(Key("c:/a/other.exe", 20), &b));
+}
+
+TEST(IconPack, StaleStatMisses) {
+  TempDir dir;
+  const std::string pack = dir.File("icons.pack");
+
+  IconPackWriter w;
+  auto icon = Bytes(3, 64);
+  w.Add(Key("c:/app.exe", 32, 100), IconFormat::kPng, icon.data(), icon.size());
+  ASSERT_TRUE(w.WriteTo(pack));
+
+  IconPackReader r;
+  ASSERT_TRUE(r.Open(pack));
+  IconBlob b;
+  EXPECT_TRUE(r.Find(Key("c:/app.exe", 32, 100), &b));
+  EXPECT_FALSE(r.Find(Key("c:/app.exe", 32, 101), &b));
+}
+
+TEST(IconPack, DeduplicatesIdenticalBlobs) {
+  // Many exes share the generic application icon; it is stored once.
+  auto generic = Bytes(9, 1000);
+  IconPackWriter w;
+  for (int i = 0; i < 50; i++) {
+    w.Add(Key("c:/tools/tool" + std::to_string(i) + ".exe", 20), IconFormat::kPng,
+          generic.data(), generic.size());
+  }
+  std::vector<uint8_t> out;
+  w.Build(out);
+  EXPECT_LT(out.size(), sizeof(PackHeader) + 2 * generic.size() + 50 * sizeof(PackEntry));
+}
+
+TEST(IconPack, LaterAddReplacesSlot) {
+  IconPackWriter w;
+  auto v1 = Bytes(1, 10);
+  auto v2 = Bytes(2, 20);
+  w.Add(Key("c:/app.exe", 20, 1), IconFormat::kPng, v1.data(), v1.size());
+  w.Add(Key("c:/app.exe", 20, 2), IconFormat::kPng, v2.data(), v2.size());
+  EXPECT_EQ(w.entry_count(), 1u);
+}
+
+TEST(IconPack, RejectsCorruptFiles) {
+  TempDir dir;
+  const std::string pack = dir.File("icons.pack");
+
+  IconPackWriter w;
+  auto icon = Bytes(5, 64);
+  w.Add(Key("c:/app.exe", 20), IconFormat::kPng, icon.data(), icon.size());
+  std::vector<uint8_t> bytes;
+  w.Build(bytes);
+
+  // Truncated: header file_size no longer matches.
+  ASSERT_TRUE(WriteFileAtomic(pack, bytes.data(), bytes.size() - 1));
+  IconPackReader r;
+  EXPECT_FALSE(r.Open(pack));
+
+  // Blob offset pointing past the index.
+  PackHeader h;
+  memcpy(&h, bytes.data(), sizeof(h));
+  PackEntry e;
+  memcpy(&e, bytes.data() + h.index_offset, sizeof(e));
+  e.blob_offset = h.file_size;
+  memcpy(bytes.data() + h.index_offset, &e, sizeof(e));
+  ASSERT_TRUE(WriteFileAtomic(pack, bytes.data(), bytes.size()));
+  EXPECT_FALSE(r.Open(pack));
+
+  EXPECT_FALSE(r.Open(dir.File("missing.pack")));
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
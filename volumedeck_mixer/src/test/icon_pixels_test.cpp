@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <vector>
+
+#include "icon_pixels.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+TEST(IconPixels, PremultipliesAndSwizzles) {
+  const uint8_t bgra[] = {
+      10, 20, 30, 255,   // opaque: only swizzled
+      255, 128, 0, 128,  // half transparent
+      200, 200, 200, 0,  // fully transparent -> black
+  };
+  uint8_t rgba[sizeof(bgra)];
+  BgraToPremultipliedRgba(bgra, rgba, 3);
+
+  EXPECT_EQ(rgba[0], 30);
+  EXPECT_EQ(rgba[1], 20);
+  EXPECT_EQ(rgba[2], 10);
+  EXPECT_EQ(rgba[3], 255);
+
+  EXPECT_EQ(rgba[4], 0);
+  EXPECT_EQ(rgba[5], 64);   // round(128 * 128 / 255)
+  EXPECT_EQ(rgba[6], 128);  // round(255 * 128 / 255)
+  EXPECT_EQ(rgba[7], 128);
+
+  EXPECT_EQ(rgba[8], 0);
+  EXPECT_EQ(rgba[9], 0);
+  EXPECT_EQ(rgba[10], 0);
+  EXPECT_EQ(rgba[11], 0);
+}
+
+TEST(IconPixels, MatchesExactRoundingForAllValues) {
+  std::vector<uint8_t> bgra(256 * 256 * 4);
+  for (int a = 0; a < 256; a++) {
+    for (int c = 0; c < 256; c++) {
+      uint8_t* p = &bgra[(a * 256 + c) * 4];
+      p[0] = p[1] = p[2] = (uint8_t)c;
+      p[3] = (uint8_t)a;
+    }
+  }
+  // In place, as the extractor does after ForceOpaque.
+  BgraToPremultipliedRgba(bgra.data(), bgra.data(), 256 * 256);
+  for (int a = 0; a < 256; a++) {
+    for (int c = 0; c < 256; c++) {
+      const int want = (c * a + 127) / 255;
+      ASSERT_EQ(bgra[(a * 256 + c) * 4], want) << "c=" << c << " a=" << a;
+    }
+  }
+}
+
+TEST(IconPixels, TreatsAllZeroAlphaAsOpaque) {
+  std::vector<uint8_t> bgra(4 * 4 * 4, 0);
+  for (size_t i = 0; i < bgra.size(); i += 4) bgra[i] = 200;  // blue
+
+  IconImage img;
+  IconImageFromBgra(bgra.data(), 4, 4, &img);
+  ASSERT_EQ(img.rgba.size(), 64u);
+  EXPECT_EQ(img.rgba[2], 200);
+  EXPECT_EQ(img.rgba[3], 255);
+}
+
+TEST(IconPixels, UnpremultiplyInvertsPremultiply) {
+  // Round trip is exact whenever alpha keeps enough precision.
+  for (uint32_t a = 1; a < 256; a++) {
+    for (uint32_t c = 0; c < 256; c += 5) {
+      const uint8_t bgra[4] = {(uint8_t)c, 0, 0, (uint8_t)a};
+      uint8_t rgba[4];
+      BgraToPremultipliedRgba(bgra, rgba, 1);
+      PremultipliedToStraightRgba(rgba, rgba, 1);
+      EXPECT_LE(std::abs((int)rgba[2] - (int)c), (int)(128 / a) + 1) << a << " " << c;
+      EXPECT_EQ(rgba[3], a);
+    }
+  }
+  const uint8_t clear[4] = {0, 0, 0, 0};
+  uint8_t out[4] = {1, 1, 1, 1};
+  PremultipliedToStraightRgba(clear, out, 1);
+  EXPECT_EQ(out[0], 0);
+}
+
+TEST(IconPixels, SerializesForThePack) {
+  IconImage img;
+  img.width = 3;
+  img.height = 2;
+  img.rgba.resize(3 * 2 * 4);
+  for (size_t i = 0; i < img.rgba.size(); i++) img.rgba[i] = (uint8_t)i;
+
+  std::vector<uint8_t> blob;
+  SerializeIconImage(img, blob);
+
+  IconImage back;
+  ASSERT_TRUE(DeserializeIconImage(blob.data(), blob.size(), &back));
+  EXPECT_EQ(back.width, 3);
+  EXPECT_EQ(back.height, 2);
+  EXPECT_EQ(back.rgba, img.rgba);
+
+  EXPECT_FALSE(DeserializeIconImage(blob.data(), blob.size() - 1, &back));
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
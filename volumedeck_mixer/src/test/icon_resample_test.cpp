@@ -0,0 +1,256 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "icon_resample.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+IconImage Solid(int w, int h, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+  IconImage img;
+  img.width = w;
+  img.height = h;
+  img.rgba.resize((size_t)w * h * 4);
+  for (size_t i = 0; i < img.rgba.size(); i += 4) {
+    img.rgba[i] = r;
+    img.rgba[i + 1] = g;
+    img.rgba[i + 2] = b;
+    img.rgba[i + 3] = a;
+  }
+  return img;
+}
+
+// Smooth premultiplied test card: f(u, v) evaluated at pixel centres.
+double Smooth(double u, double v, int c) {
+  const double alpha = 0.6 + 0.4 * std::cos(u * 2.0);
+  const double colour = c == 0 ? 0.5 + 0.5 * std::sin(u * 3.0) : c == 1 ? v : 0.3;
+  return 255.0 * (c == 3 ? alpha : colour * alpha);
+}
+
+IconImage SmoothCard(int size) {
+  IconImage img = Solid(size, size, 0, 0, 0, 0);
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      for (int c = 0; c < 4; c++) {
+        const double v = Smooth((x + 0.5) / size, (y + 0.5) / size, c);
+        img.rgba[((size_t)y * size + x) * 4 + c] = (uint8_t)std::lround(v);
+      }
+    }
+  }
+  return img;
+}
+
+double PsnrAgainstSmooth(const IconImage& img) {
+  double se = 0;
+  for (int y = 0; y < img.height; y++) {
+    for (int x = 0; x < img.width; x++) {
+      for (int c = 0; c < 4; c++) {
+        const double ref = Smooth((x + 0.5) / img.width, (y + 0.5) / img.height, c);
+        const double d = img.rgba[((size_t)y * img.width + x) * 4 + c] - ref;
+        se += d * d;
+      }
+    }
+  }
+  const double mse = se / (img.pixel_count() * 4.0);
+  return 10.0 * std::log10(255.0 * 255.0 / std::max(mse, 1e-12));
+}
+
+void ExpectValidPremultiplied(const IconImage& img) {
+  for (size_t i = 0; i < img.rgba.size(); i += 4) {
+    for (int c = 0; c < 3; c++) ASSERT_LE(img.rgba[i + c], img.rgba[i + 3]) << i;
+  }
+}
+
+}  // namespace
+
+TEST(IconResample, BoxMatchesExactAreaAverage) {
+  IconImage src = Solid(8, 8, 0, 0, 0, 0);
+  for (size_t i = 0; i < src.rgba.size(); i++) src.rgba[i] = (uint8_t)((i * 37) % 256);
+  for (size_t i = 0; i < src.rgba.size(); i += 4) {
+    src.rgba[i + 3] = 255;  // keep it valid premultiplied
+  }
+
+  IconResampler r;
+  IconImage out;
+  ASSERT_TRUE(r.Resize(src, 2, 2, ResampleFilter::kBox, &out));
+  for (int oy = 0; oy < 2; oy++) {
+    for (int ox = 0; ox < 2; ox++) {
+      for (int c = 0; c < 4; c++) {
+        int sum = 0;
+        for (int y = 0; y < 4; y++) {
+          for (int x = 0; x < 4; x++) sum += src.rgba[(((size_t)oy * 4 + y) * 8 + ox * 4 + x) * 4 + c];
+        }
+        EXPECT_NEAR(out.rgba[((size_t)oy * 2 + ox) * 4 + c], sum / 16.0, 0.51);
+      }
+    }
+  }
+}
+
+TEST(IconResample, PreservesFlatColour) {
+  IconResampler r;
+  const IconImage src = Solid(256, 256, 90, 30, 120, 200);
+  for (auto filter : {ResampleFilter::kBox, ResampleFilter::kLanczos3}) {
+    for (int size : {16, 20, 24, 32, 48, 96, 300}) {
+      IconImage out;
+      ASSERT_TRUE(r.Resize(src, size, size, filter, &out));
+      for (size_t i = 0; i < out.rgba.size(); i++) {
+        ASSERT_NEAR(out.rgba[i], src.rgba[i % 4], 1) << size << " at " << i;
+      }
+    }
+  }
+}
+
+TEST(IconResample, SmoothImageQuality) {
+  IconResampler r;
+  const IconImage src = SmoothCard(256);
+  for (int size : {16, 20, 24, 32, 48}) {
+    SCOPED_TRACE("size " + std::to_string(size));
+    IconImage lanczos, box;
+    ASSERT_TRUE(r.Resize(src, size, size, ResampleFilter::kLanczos3, &lanczos));
+    ASSERT_TRUE(r.Resize(src, size, size, ResampleFilter::kBox, &box));
+    EXPECT_GT(PsnrAgainstSmooth(lanczos), 40.0);
+    EXPECT_GT(PsnrAgainstSmooth(box), 38.0);
+  }
+}
+
+TEST(IconResample, SuppressesAliasing) {
+  // One-pixel checkerboard: point sampling 256 -> 20 would produce bold
+  // stripes; a proper filter yields nearly flat grey.
+  IconImage src = Solid(256, 256, 0, 0, 0, 255);
+  for (int y = 0; y < 256; y++) {
+    for (int x = 0; x < 256; x++) {
+      if ((x + y) & 1) memset(&src.rgba[((size_t)y * 256 + x) * 4], 255, 3);
+    }
+  }
+  IconResampler r;
+  for (auto filter : {ResampleFilter::kBox, ResampleFilter::kLanczos3}) {
+    IconImage out;
+    ASSERT_TRUE(r.Resize(src, 20, 20, filter, &out));
+    for (size_t i = 0; i < out.rgba.size(); i += 4) EXPECT_NEAR(out.rgba[i], 127.5, 8.0) << i;
+  }
+}
+
+TEST(IconResample, NoFringeAtTransparentEdges) {
+  // Opaque red half next to a fully transparent half. In straight alpha the
+  // transparent pixels' colour (black here) would darken the edge; in
+  // premultiplied space every visible pixel stays pure red.
+  IconImage src = Solid(64, 64, 0, 0, 0, 0);
+  for (int y = 0; y < 64; y++) {
+    for (int x = 0; x < 32; x++) {
+      uint8_t* p = &src.rgba[((size_t)y * 64 + x) * 4];
+      p[0] = 255;
+      p[3] = 255;
+    }
+  }
+  IconResampler r;
+  for (auto filter : {ResampleFilter::kBox, ResampleFilter::kLanczos3}) {
+    IconImage out;
+    ASSERT_TRUE(r.Resize(src, 20, 20, filter, &out));
+    ExpectValidPremultiplied(out);
+    for (size_t i = 0; i < out.rgba.size(); i += 4) {
+      const int a = out.rgba[i + 3];
+      if (a < 16) continue;  // too faint to judge at 8 bits
+      EXPECT_NEAR(out.rgba[i], a, 2) << i;
+      EXPECT_LE(out.rgba[i + 1], 1) << i;
+      EXPECT_LE(out.rgba[i + 2], 1) << i;
+    }
+  }
+}
+
+TEST(IconResample, LanczosRingingIsClamped) {
+  // Hard-edged opaque square on transparent: Lanczos overshoots at the
+  // edges, which must not produce colour > alpha.
+  IconImage src = Solid(100, 100, 0, 0, 0, 0);
+  for (int y = 30; y < 70; y++) {
+    for (int x = 30; x < 70; x++) memset(&src.rgba[((size_t)y * 100 + x) * 4], 255, 4);
+  }
+  IconResampler r;
+  IconImage out;
+  ASSERT_TRUE(r.Resize(src, 24, 24, ResampleFilter::kLanczos3, &out));
+  ExpectValidPremultiplied(out);
+  ASSERT_TRUE(r.Resize(src, 150, 150, ResampleFilter::kLanczos3, &out));
+  ExpectValidPremultiplied(out);
+}
+
+TEST(IconResample, RejectsBadInput) {
+  IconResampler r;
+  IconImage out;
+  IconImage empty;
+  EXPECT_FALSE(r.Resize(empty, 16, 16, ResampleFilter::kBox, &out));
+  IconImage short_buf = Solid(4, 4, 0, 0, 0, 0);
+  short_buf.rgba.resize(10);
+  EXPECT_FALSE(r.Resize(short_buf, 2, 2, ResampleFilter::kBox, &out));
+  EXPECT_FALSE(r.Resize(Solid(4, 4, 0, 0, 0, 0), 0, 2, ResampleFilter::kBox, &out));
+}
+
+TEST(IconPyramid, BuildsEveryLevelFromOneSource) {
+  IconResampler r;
+  IconPyramid p;
+  ASSERT_TRUE(BuildIconPyramid(SmoothCard(256), r, &p));
+  for (int i = 0; i < kIconPyramidLevels; i++) {
+    EXPECT_EQ(p.levels[i].width, kIconPyramidSizes[i]);
+    EXPECT_EQ(p.levels[i].height, kIconPyramidSizes[i]);
+    EXPECT_GT(PsnrAgainstSmooth(p.levels[i]), 38.0) << kIconPyramidSizes[i];
+  }
+  EXPECT_EQ(p.source.width, kIconPyramidMaxEdge);
+
+  EXPECT_EQ(p.ForSize(16).width, 16);
+  EXPECT_EQ(p.ForSize(18).width, 20);
+  EXPECT_EQ(p.ForSize(32).width, 32);
+  EXPECT_EQ(p.ForSize(64).width, kIconPyramidMaxEdge);
+  EXPECT_EQ(p.ForSize(512).width, kIconPyramidMaxEdge);
+
+  size_t bytes = (size_t)kIconPyramidMaxEdge * kIconPyramidMaxEdge * 4;
+  for (int s : kIconPyramidSizes) bytes += (size_t)s * s * 4;
+  EXPECT_EQ(p.byte_size(), bytes);
+}
+
+TEST(IconPyramid, SmallSourceIsUpscaledAndPreferred) {
+  // Shell fallback only yields 32 px.
+  IconResampler r;
+  IconPyramid p;
+  ASSERT_TRUE(BuildIconPyramid(SmoothCard(32), r, &p));
+  EXPECT_EQ(p.source.width, 32);
+  EXPECT_EQ(p.levels[kIconPyramidLevels - 1].width, 48);
+  EXPECT_EQ(p.ForSize(32).width, 32);
+  EXPECT_EQ(p.ForSize(40).width, 48);
+
+  IconPyramid wide;
+  IconImage src = Solid(64, 32, 10, 10, 10, 255);
+  ASSERT_TRUE(BuildIconPyramid(src, r, &wide));
+  EXPECT_EQ(wide.levels[0].width, 16);
+  EXPECT_EQ(wide.levels[0].height, 8);
+}
+
+TEST(IconPyramid, RoundTripsThroughTheIconPack) {
+  IconResampler r;
+  IconPyramid p;
+  ASSERT_TRUE(BuildIconPyramid(SmoothCard(256), r, &p));
+  std::vector<uint8_t> bytes;
+  SerializeIconPyramid(p, bytes);
+
+  IconPyramid back;
+  ASSERT_TRUE(DeserializeIconPyramid(bytes.data(), bytes.size(), &back));
+  EXPECT_EQ(back.source.width, p.source.width);
+  EXPECT_EQ(back.source.rgba, p.source.rgba);
+  for (int i = 0; i < kIconPyramidLevels; i++) {
+    EXPECT_EQ(back.levels[i].width, p.levels[i].width) << i;
+    EXPECT_EQ(back.levels[i].rgba, p.levels[i].rgba) << i;
+  }
+
+  IconPyramid bad;
+  EXPECT_FALSE(DeserializeIconPyramid(bytes.data(), bytes.size() - 1, &bad));
+  bytes.push_back(0);
+  EXPECT_FALSE(DeserializeIconPyramid(bytes.data(), bytes.size(), &bad));
+  EXPECT_FALSE(DeserializeIconPyramid(bytes.data(), 1, &bad));
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
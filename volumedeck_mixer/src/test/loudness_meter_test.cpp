@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "capture_source.h"
+#include "loudness_meter.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+// Feeds `seconds` of a 1 kHz sine at `dbfs` on every channel, continuing
+// the phase across calls like one long file.
+class ToneFeeder {
+ public:
+  ToneFeeder(LoudnessMeter& meter) : meter_(meter) {}
+
+  void Tone(double dbfs, double seconds, double hz = 1000.0) {
+    CaptureFormat f{meter_.sample_rate(), meter_.channels()};
+    auto gen = SyntheticCaptureSource::Sine(f, hz, dbfs);
+    const size_t total = (size_t)std::lround(seconds * f.sample_rate);
+    std::vector<float> buf(1024 * (size_t)f.channels);
+    for (size_t done = 0; done < total;) {
+      const size_t n = std::min<size_t>(1024, total - done);
+      gen(buf.data(), n, position_);
+      meter_.Process(buf.data(), n);
+      position_ += n;
+      done += n;
+    }
+  }
+
+ private:
+  LoudnessMeter& meter_;
+  uint64_t position_ = 0;
+};
+
+}  // namespace
+
+// Coefficients printed in ITU-R BS.1770-4, tables 1 and 2.
+TEST(KWeighting, MatchesRecommendationAt48k) {
+  Biquad s, h;
+  KWeightingFilters(48000, &s, &h);
+  EXPECT_NEAR(s.b0, 1.53512485958697, 1e-9);
+  EXPECT_NEAR(s.b1, -2.69169618940638, 1e-9);
+  EXPECT_NEAR(s.b2, 1.19839281085285, 1e-9);
+  EXPECT_NEAR(s.a1, -1.69065929318241, 1e-9);
+  EXPECT_NEAR(s.a2, 0.73248077421585, 1e-9);
+  EXPECT_NEAR(h.a1, -1.99004745483398, 1e-9);
+  EXPECT_NEAR(h.a2, 0.99007225036621, 1e-9);
+}
+
+// EBU Tech 3341 case 1: stereo 1 kHz at -23 dBFS reads -23 LUFS on every
+// scale, at the common device rates.
+TEST(LoudnessMeter, SteadySineReadsMinus23) {
+  for (int rate : {44100, 48000, 96000}) {
+    LoudnessMeter m(rate, 2);
+    ToneFeeder(m).Tone(-23.0, 20.0);
+    EXPECT_NEAR(m.momentary(), -23.0, 0.1) << rate;
+    EXPECT_NEAR(m.short_term(), -23.0, 0.1) << rate;
+    EXPECT_NEAR(m.integrated(), -23.0, 0.1) << rate;
+  }
+}
+
+// Case 2: -33 dBFS reads -33 LUFS.
+TEST(LoudnessMeter, SteadySineReadsMinus33) {
+  LoudnessMeter m(48000, 2);
+  ToneFeeder(m).Tone(-33.0, 20.0);
+  EXPECT_NEAR(m.integrated(), -33.0, 0.1);
+}
+
+// Case 3: the quiet parts fall under the relative gate.
+TEST(LoudnessMeter, RelativeGateDropsQuietPassages) {
+  LoudnessMeter m(48000, 2);
+  ToneFeeder t(m);
+  t.Tone(-36.0, 10.0);
+  t.Tone(-23.0, 60.0);
+  t.Tone(-36.0, 10.0);
+  EXPECT_NEAR(m.integrated(), -23.0, 0.1);
+}
+
+// Case 4: plus passages under the absolute gate.
+TEST(LoudnessMeter, AbsoluteGateDropsNearSilence) {
+  LoudnessMeter m(48000, 2);
+  ToneFeeder t(m);
+  t.Tone(-72.0, 10.0);
+  t.Tone(-36.0, 10.0);
+  t.Tone(-23.0, 60.0);
+  t.Tone(-36.0, 10.0);
+  t.Tone(-72.0, 10.0);
+  EXPECT_NEAR(m.integrated(), -23.0, 0.1);
+}
+
+// Case 5: both levels are above the relative gate and average in energy.
+TEST(LoudnessMeter, IntegratesAcrossLevelChanges) {
+  LoudnessMeter m(48000, 2);
+  ToneFeeder t(m);
+  t.Tone(-26.0, 20.0);
+  t.Tone(-20.0, 20.1);
+  t.Tone(-26.0, 20.0);
+  EXPECT_NEAR(m.integrated(), -23.0, 0.1);
+}
+
+// The surround weights: Ls/Rs count +1.5 dB, LFE not at all.
+TEST(LoudnessMeter, SurroundChannelWeights) {
+  const double level = -28.0;
+  std::vector<double> readings;
+  for (int active : {0, 3, 4}) {
+    LoudnessMeter m(48000, 6);
+    auto gen = SyntheticCaptureSource::Sine({48000, 1}, 1000.0, level);
+    std::vector<float> mono(4800), buf(4800 * 6, 0.0f);
+    for (uint64_t block = 0; block < 100; block++) {
+      gen(mono.data(), mono.size(), block * mono.size());
+      for (size_t i = 0; i < mono.size(); i++) buf[i * 6 + (size_t)active] = mono[i];
+      m.Process(buf.data(), mono.size());
+    }
+    readings.push_back(m.integrated());
+  }
+  // Mono 1 kHz at -28 dBFS: -28 - 3.01 (single channel) = -31.01 LUFS.
+  EXPECT_NEAR(readings[0], -31.0, 0.1);
+  EXPECT_EQ(readings[1], kLoudnessSilence);
+  EXPECT_NEAR(readings[2] - readings[0], 10.0 * std::log10(1.41), 0.05);
+}
+
+// Momentary follows a step within its 400 ms window, short-term within 3 s.
+TEST(LoudnessMeter, WindowsFollowSteps) {
+  LoudnessMeter m(48000, 2);
+  ToneFeeder t(m);
+  t.Tone(-23.0, 5.0);
+  t.Tone(-43.0, 0.4);
+  EXPECT_NEAR(m.momentary(), -43.0, 0.2);
+  EXPECT_GT(m.short_term(), -30.0);
+  t.Tone(-43.0, 2.6);
+  EXPECT_NEAR(m.short_term(), -43.0, 0.2);
+}
+
+TEST(LoudnessMeter, SilenceAndReset) {
+  LoudnessMeter m(48000, 2);
+  std::vector<float> zeros(48000 * 2, 0.0f);
+  m.Process(zeros.data(), 48000);
+  EXPECT_EQ(m.momentary(), kLoudnessSilence);
+  EXPECT_EQ(m.integrated(), kLoudnessSilence);
+
+  ToneFeeder t(m);
+  t.Tone(-23.0, 20.0);
+  EXPECT_NEAR(m.integrated(), -23.0, 0.1);
+  m.ResetIntegrated();
+  EXPECT_EQ(m.integrated(), kLoudnessSilence);
+  // Only the three blocks overlapping the step still see the -23 tone.
+  t.Tone(-30.0, 30.0);
+  EXPECT_NEAR(m.integrated(), -30.0, 0.15);
+  m.Reset();
+  EXPECT_EQ(m.frames(), 0u);
+  EXPECT_EQ(m.short_term(), kLoudnessSilence);
+}
+
+// Block boundaries must not matter: odd chunk sizes give the same result.
+TEST(LoudnessMeter, ChunkingInvariant) {
+  std::mt19937 rng(3);
+  std::normal_distribution<float> noise(0.0f, 0.05f);
+  std::vector<float> signal(48000 * 2 * 6);
+  for (auto& v : signal) v = noise(rng);
+
+  LoudnessMeter whole(48000, 2), pieces(48000, 2);
+  whole.Process(signal.data(), signal.size() / 2);
+  std::uniform_int_distribution<size_t> len(1, 3000);
+  for (size_t at = 0; at < signal.size() / 2;) {
+    const size_t n = std::min(len(rng), signal.size() / 2 - at);
+    pieces.Process(&signal[at * 2], n);
+    at += n;
+  }
+  EXPECT_NEAR(whole.integrated(), pieces.integrated(), 1e-3);
+  EXPECT_NEAR(whole.momentary(), pieces.momentary(), 1e-3);
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
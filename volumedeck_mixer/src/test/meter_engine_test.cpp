@@ -0,0 +1,270 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "meter_dsp.h"
+#include "meter_engine.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+constexpr double kDt = 0.001;  // 1 kHz ticks make the timing assertions tight
+
+float Db(float v) { return 20.0f * std::log10(v); }
+
+// Runs `seconds` of a constant input through one channel.
+void Feed(MeterBank& bank, const MeterCoeffs& c, float x, double seconds) {
+  const int ticks = (int)std::lround(seconds / kDt);
+  for (int i = 0; i < ticks; i++) {
+    bank.input[0] = x;
+    RunMeterKernel(bank, 1, c);
+  }
+}
+
+// Fixed peaks per slot, changeable from the test thread.
+class FakeProbe : public MeterProbe {
+ public:
+  explicit FakeProbe(size_t slots) : peaks_(slots) {
+    for (auto& p : peaks_) p.store(0.0f);
+  }
+  void Set(size_t slot, float v) { peaks_[slot].store(v); }
+  void SetCount(size_t n) { count_.store(n); }
+
+  size_t Sample(float* peaks, size_t capacity) override {
+    const size_t n = std::min(count_.load(), capacity);
+    for (size_t i = 0; i < n; i++) peaks[i] = peaks_[i].load();
+    return n;
+  }
+
+ private:
+  std::vector<std::atomic<float>> peaks_;
+  std::atomic<size_t> count_{0};
+};
+
+}  // namespace
+
+TEST(MeterDsp, PeakAttacksInstantlyAndFallsAtTheConfiguredRate) {
+  MeterBallistics b;
+  const MeterCoeffs c = ComputeMeterCoeffs(b, kDt);
+  MeterBank bank(1);
+  Feed(bank, c, 1.0f, kDt);
+  EXPECT_FLOAT_EQ(bank.peak[0], 1.0f);
+  Feed(bank, c, 0.0f, 1.0);
+  EXPECT_NEAR(Db(bank.peak[0]), -b.peak_release_db_per_s, 0.1f);
+}
+
+TEST(MeterDsp, PpmReadsMinusOneDbForAnIntegrationTimeBurst) {
+  MeterBallistics b;
+  const MeterCoeffs c = ComputeMeterCoeffs(b, kDt);
+  MeterBank bank(1);
+  Feed(bank, c, 1.0f, b.ppm_integration_ms / 1000.0);
+  EXPECT_NEAR(Db(bank.ppm[0]), -1.0f, 0.1f);
+
+  Feed(bank, c, 1.0f, 1.0);
+  Feed(bank, c, 0.0f, 1.5);
+  EXPECT_NEAR(Db(bank.ppm[0]), -20.0f, 0.2f);
+}
+
+TEST(MeterDsp, VuReachesNinetyNinePercentAfterRiseTime) {
+  MeterBallistics b;
+  const MeterCoeffs c = ComputeMeterCoeffs(b, kDt);
+  MeterBank bank(1);
+  Feed(bank, c, 1.0f, b.vu_rise_ms / 1000.0);
+  EXPECT_NEAR(bank.vu[0], 0.99f, 0.002f);
+}
+
+TEST(MeterDsp, RmsOfAlternatingSignal) {
+  const MeterCoeffs c = ComputeMeterCoeffs(MeterBallistics{}, kDt);
+  MeterBank bank(1);
+  for (int i = 0; i < 4000; i++) {
+    bank.input[0] = (i & 1) ? 1.0f : 0.0f;
+    RunMeterKernel(bank, 1, c);
+  }
+  EXPECT_NEAR(std::sqrt(bank.mean_square[0]), std::sqrt(0.5f), 0.01f);
+}
+
+TEST(MeterDsp, HoldStaysThenFalls) {
+  MeterBallistics b;
+  const MeterCoeffs c = ComputeMeterCoeffs(b, kDt);
+  MeterBank bank(1);
+  Feed(bank, c, 0.5f, kDt);
+  Feed(bank, c, 0.0f, b.hold_ms / 1000.0 - 0.01);
+  EXPECT_FLOAT_EQ(bank.hold[0], 0.5f);
+  Feed(bank, c, 0.0f, 1.01);
+  EXPECT_NEAR(Db(bank.hold[0]), Db(0.5f) - b.peak_release_db_per_s, 0.2f);
+
+  // A higher peak restarts the hold.
+  Feed(bank, c, 0.8f, kDt);
+  Feed(bank, c, 0.1f, 1.0);
+  EXPECT_FLOAT_EQ(bank.hold[0], 0.8f);
+}
+
+TEST(MeterDsp, DecaysToExactZero) {
+  const MeterCoeffs c = ComputeMeterCoeffs(MeterBallistics{}, kDt);
+  MeterBank bank(1);
+  Feed(bank, c, 1.0f, 0.5);
+  Feed(bank, c, 0.0f, 30.0);
+  EXPECT_EQ(bank.peak[0], 0.0f);
+  EXPECT_EQ(bank.ppm[0], 0.0f);
+  EXPECT_EQ(bank.vu[0], 0.0f);
+  EXPECT_EQ(bank.mean_square[0], 0.0f);
+  EXPECT_EQ(bank.hold[0], 0.0f);
+}
+
+TEST(MeterDsp, VectorKernelMatchesScalar) {
+  const size_t n = 37;
+  MeterBank vec(n), ref(n);
+  EXPECT_EQ(vec.channels % kMeterLanes, 0u);
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> level(0.0f, 1.0f);
+  std::bernoulli_distribution silent(0.3);
+  for (int tick = 0; tick < 3000; tick++) {
+    const MeterCoeffs c = ComputeMeterCoeffs(MeterBallistics{}, 0.002 + 0.001 * (tick % 3));
+    for (size_t i = 0; i < n; i++) {
+      const float x = silent(rng) ? 0.0f : level(rng) * level(rng);
+      vec.input[i] = ref.input[i] = x;
+    }
+    RunMeterKernel(vec, n, c);
+    RunMeterKernelScalar(ref, n, c);
+  }
+  for (size_t i = 0; i < n; i++) {
+    EXPECT_NEAR(vec.peak[i], ref.peak[i], 1e-5f) << i;
+    EXPECT_NEAR(vec.ppm[i], ref.ppm[i], 1e-5f) << i;
+    EXPECT_NEAR(vec.vu[i], ref.vu[i], 1e-5f) << i;
+    EXPECT_NEAR(vec.mean_square[i], ref.mean_square[i], 1e-5f) << i;
+    EXPECT_NEAR(vec.hold[i], ref.hold[i], 1e-5f) << i;
+  }
+}
+
+TEST(MeterEngine, TickPublishesActiveSlots) {
+  FakeProbe probe(4);
+  probe.SetCount(2);
+  probe.Set(0, 0.5f);
+  probe.Set(1, 2.0f);  // clamped
+  MeterEngine engine(&probe, 4);
+  engine.Tick(kDt);
+
+  MeterReading r[4];
+  ASSERT_EQ(engine.Read(r, 4), 2u);
+  EXPECT_FLOAT_EQ(r[0].peak, 0.5f);
+  EXPECT_FLOAT_EQ(r[1].peak, 1.0f);
+  EXPECT_FLOAT_EQ(r[1].hold, 1.0f);
+  EXPECT_GT(r[1].rms, 0.0f);
+
+  MeterReading one;
+  EXPECT_TRUE(engine.Read(0, &one));
+  EXPECT_FLOAT_EQ(one.peak, 0.5f);
+  EXPECT_FALSE(engine.Read(2, &one));
+  EXPECT_FALSE(engine.Read(9, &one));
+}
+
+TEST(MeterEngine, ResetSlotStartsFromSilence) {
+  FakeProbe probe(2);
+  probe.SetCount(1);
+  probe.Set(0, 1.0f);
+  MeterEngine engine(&probe, 2);
+  engine.Tick(kDt);
+  probe.Set(0, 0.0f);
+  engine.ResetSlot(0);
+  engine.Tick(kDt);
+  MeterReading r;
+  ASSERT_TRUE(engine.Read(0, &r));
+  EXPECT_EQ(r.peak, 0.0f);
+  EXPECT_EQ(r.hold, 0.0f);
+}
+
+TEST(MeterEngine, ThreadTicksAndReadersSeeConsistentFrames) {
+  // Every slot sees the same input history, so all slots of a published
+  // frame are identical; a read mixing two publishes would show otherwise.
+  class RampProbe : public MeterProbe {
+   public:
+    size_t Sample(float* peaks, size_t capacity) override {
+      const float v = (float)((n_++ % 10) + 1) / 10.0f;
+      for (size_t i = 0; i < capacity; i++) peaks[i] = v;
+      return capacity;
+    }
+    void OnThreadStart() override { started++; }
+    void OnThreadStop() override { stopped++; }
+    std::atomic<int> started{0}, stopped{0};
+
+   private:
+    int n_ = 0;
+  };
+
+  const size_t slots = 64;
+  RampProbe probe;
+  MeterEngine engine(&probe, slots, MeterBallistics{}, std::chrono::microseconds(100));
+  engine.Start();
+
+  std::vector<MeterReading> r(slots);
+  int torn = 0, reads = 0;
+  const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+  while (std::chrono::steady_clock::now() < end) {
+    if (engine.Read(r.data(), slots) != slots) continue;
+    reads++;
+    for (size_t s = 1; s < slots; s++) {
+      if (r[s].peak != r[0].peak || r[s].vu != r[0].vu || r[s].rms != r[0].rms) {
+        torn++;
+        break;
+      }
+    }
+  }
+  engine.Stop();
+
+  EXPECT_EQ(torn, 0);
+  EXPECT_GT(reads, 0);
+  EXPECT_GT(engine.ticks(), 50u);
+  EXPECT_EQ(probe.started.load(), 1);
+  EXPECT_EQ(probe.stopped.load(), 1);
+  EXPECT_FALSE(engine.running());
+}
+
+TEST(MeterEngine, SchedulerPausesIdlesAndSpeedsUpForAudio) {
+  using std::chrono::milliseconds;
+  FakeProbe probe(4);
+  probe.SetCount(2);
+  SampleRates rates;
+  rates.high_hz = 200.0;
+  rates.low_hz = 10.0;
+  rates.hold = milliseconds(200);
+  SampleScheduler scheduler(rates);
+  MeterEngine engine(&probe, 4);
+  engine.SetScheduler(&scheduler);
+  engine.Start();
+
+  // Nobody listening: not a single tick.
+  std::this_thread::sleep_for(milliseconds(60));
+  EXPECT_EQ(engine.ticks(), 0u);
+
+  // Silence: the low rate.
+  const int id = scheduler.Subscribe();
+  std::this_thread::sleep_for(milliseconds(300));
+  const uint64_t idle = engine.ticks();
+  EXPECT_GE(idle, 1u);
+  EXPECT_LE(idle, 6u);
+  EXPECT_DOUBLE_EQ(scheduler.last_hz(), 10.0);
+
+  // Audio: picked up within a slow tick, then the high rate.
+  probe.Set(1, 0.5f);
+  std::this_thread::sleep_for(milliseconds(400));
+  EXPECT_GT(engine.ticks() - idle, 20u);
+  EXPECT_DOUBLE_EQ(scheduler.last_hz(), 200.0);
+
+  scheduler.Unsubscribe(id);
+  std::this_thread::sleep_for(milliseconds(50));
+  const uint64_t paused = engine.ticks();
+  std::this_thread::sleep_for(milliseconds(100));
+  EXPECT_EQ(engine.ticks(), paused);
+  engine.Stop();
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
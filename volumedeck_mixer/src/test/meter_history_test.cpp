@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "meter_engine.h"
+#include "meter_history.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+constexpr double kTick = 0.004;  // 250 Hz meter thread
+
+// `seconds` of meter ticks with constant peaks.
+void FeedSeconds(MeterHistory& h, const std::vector<float>& peaks, double seconds) {
+  const int ticks = (int)std::lround(seconds / kTick);
+  for (int i = 0; i < ticks; i++) h.Accumulate(peaks.data(), peaks.size(), kTick);
+}
+
+}  // namespace
+
+TEST(MeterHistory, BlockLayoutIsSelfDescribing) {
+  MeterHistory h(5, 300, 30.0f);
+  const MeterHistoryBlock* b = h.block();
+  EXPECT_EQ(b->magic, kMeterHistoryMagic);
+  EXPECT_EQ(b->version, kMeterHistoryVersion);
+  EXPECT_EQ(b->slots, 5u);
+  EXPECT_EQ(b->length, 300u);
+  EXPECT_FLOAT_EQ(b->rate_hz, 30.0f);
+  EXPECT_EQ(b->columns.load(), 0u);
+  EXPECT_EQ(h.block_size(), 64u + 5 * 2 * 300 * sizeof(float));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 8, 0u);
+}
+
+TEST(MeterHistory, DownsamplesToMaxPeakAndRms) {
+  MeterHistory h(1, 10, 10.0f);  // 100 ms columns = 25 ticks
+  std::vector<float> p(1);
+  for (int i = 0; i < 25; i++) {
+    p[0] = (i % 2) ? 1.0f : 0.0f;
+    if (i == 7) p[0] = 1.0f;
+    h.Accumulate(p.data(), 1, kTick);
+  }
+  float peaks[10], rms[10];
+  ASSERT_EQ(h.Copy(0, peaks, rms), 1u);
+  EXPECT_FLOAT_EQ(peaks[0], 1.0f);
+  EXPECT_NEAR(rms[0], std::sqrt(12.0 / 25.0), 1e-4);
+}
+
+TEST(MeterHistory, KeepsTheLastLengthColumnsOldestFirst) {
+  MeterHistory h(2, 30, 30.0f);
+  std::vector<float> p(2);
+  // 2 s at 30 Hz: 60 columns, the ring keeps the last 30 (values 30..59).
+  for (int c = 0; c < 60; c++) {
+    p[0] = (float)c / 100.0f;
+    p[1] = 0.5f;
+    // Exactly one column per call: feed one whole period.
+    h.Accumulate(p.data(), 2, 1.0 / 30.0);
+  }
+  EXPECT_EQ(h.block()->columns.load(), 60u);
+  float peaks[30], rms[30];
+  ASSERT_EQ(h.Copy(0, peaks, rms), 30u);
+  for (int i = 0; i < 30; i++) {
+    EXPECT_FLOAT_EQ(peaks[i], (float)(30 + i) / 100.0f) << i;
+    EXPECT_FLOAT_EQ(rms[i], (float)(30 + i) / 100.0f) << i;
+  }
+  ASSERT_EQ(h.Copy(1, peaks, nullptr), 30u);
+  EXPECT_FLOAT_EQ(peaks[29], 0.5f);
+  EXPECT_EQ(h.Copy(2, peaks, rms), 0u);
+}
+
+TEST(MeterHistory, TenSecondsAtThirtyHertz) {
+  MeterHistory h(1, 300, 30.0f);
+  std::vector<float> p{0.25f};
+  FeedSeconds(h, p, 12.0);
+  EXPECT_NEAR((double)h.block()->columns.load(), 360.0, 1.0);
+  std::vector<float> peaks(300);
+  EXPECT_EQ(h.Copy(0, peaks.data(), nullptr), 300u);
+  for (float v : peaks) EXPECT_FLOAT_EQ(v, 0.25f);
+}
+
+TEST(MeterHistory, StallRepeatsColumns) {
+  MeterHistory h(1, 10, 10.0f);
+  std::vector<float> p{0.5f};
+  h.Accumulate(p.data(), 1, 0.35);  // a 350 ms hiccup spans 3 columns
+  EXPECT_EQ(h.block()->columns.load(), 3u);
+  h.Accumulate(p.data(), 1, 60.0);  // capped at one full ring
+  EXPECT_EQ(h.block()->columns.load(), 13u);
+}
+
+TEST(MeterHistory, CopyAllIsPackedAndRightAligned) {
+  MeterHistory h(3, 8, 10.0f);
+  std::vector<float> p{0.1f, 0.2f, 0.3f};
+  h.Accumulate(p.data(), 3, 0.1);
+  h.Accumulate(p.data(), 2, 0.1);  // slot 2 went silent
+
+  std::vector<float> all;
+  EXPECT_EQ(h.CopyAll(&all), 2u);
+  ASSERT_EQ(all.size(), 3u * 2 * 8);
+  for (size_t slot = 0; slot < 3; slot++) {
+    const float* peak = &all[slot * 16];
+    for (size_t i = 0; i < 6; i++) EXPECT_EQ(peak[i], 0.0f);
+    EXPECT_FLOAT_EQ(peak[6], p[slot]);
+    EXPECT_FLOAT_EQ(peak[7], slot == 2 ? 0.0f : p[slot]);
+  }
+}
+
+TEST(MeterHistory, ClearSlotOnlyTouchesThatSlot) {
+  MeterHistory h(2, 8, 10.0f);
+  std::vector<float> p{0.4f, 0.6f};
+  h.Accumulate(p.data(), 2, 0.1);
+  h.ClearSlot(0);
+  float a[8], b[8];
+  ASSERT_EQ(h.Copy(0, a, nullptr), 1u);
+  ASSERT_EQ(h.Copy(1, b, nullptr), 1u);
+  EXPECT_EQ(a[0], 0.0f);
+  EXPECT_FLOAT_EQ(b[0], 0.6f);
+}
+
+// Reads straight out of block() the way the Dart side does, while the
+// writer runs flat out; every accepted copy must be a single column value.
+TEST(MeterHistory, ZeroCopyReaderNeverSeesTornColumns) {
+  const size_t slots = 16, length = 64;
+  MeterHistory h(slots, length, 100.0f);
+  std::atomic<bool> stop{false};
+  std::thread writer([&] {
+    std::vector<float> p(slots);
+    for (uint32_t c = 1; !stop.load(); c++) {
+      std::fill(p.begin(), p.end(), (float)(c % 1000) / 1000.0f);
+      h.Accumulate(p.data(), slots, 0.01);
+    }
+  });
+
+  const MeterHistoryBlock* b = h.block();
+  const float* data = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(b) + sizeof(*b));
+  std::vector<float> copy(slots * 2 * length);
+  int accepted = 0, torn = 0;
+  // Yield on retry: on a single core a writer preempted mid-column keeps
+  // the sequence odd for the reader's whole time slice.
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+  while (accepted < 2000 && std::chrono::steady_clock::now() < deadline) {
+    const uint64_t s1 = b->seq.load(std::memory_order_acquire);
+    if (s1 & 1) {
+      std::this_thread::yield();
+      continue;
+    }
+    const uint64_t columns = b->columns.load(std::memory_order_relaxed);
+    std::memcpy(copy.data(), data, copy.size() * sizeof(float));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (b->seq.load(std::memory_order_relaxed) != s1 || columns == 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    accepted++;
+    const size_t newest = (size_t)((columns - 1) % length);
+    for (size_t slot = 1; slot < slots; slot++) {
+      if (copy[slot * 2 * length + newest] != copy[newest]) torn++;
+    }
+  }
+  stop = true;
+  writer.join();
+  EXPECT_GT(accepted, 0);
+  EXPECT_EQ(torn, 0);
+}
+
+class ConstantProbe : public MeterProbe {
+ public:
+  size_t Sample(float* peaks, size_t capacity) override {
+    for (size_t i = 0; i < capacity; i++) peaks[i] = 0.5f;
+    return capacity;
+  }
+};
+
+TEST(MeterHistory, FedByTheMeterEngine) {
+  ConstantProbe probe;
+  MeterEngine engine(&probe, 4);
+  MeterHistory history(4, 300, 30.0f);
+  engine.SetHistory(&history);
+  for (int i = 0; i < 250; i++) engine.Tick(kTick);  // 1 s
+
+  float peaks[300];
+  EXPECT_NEAR((double)history.Copy(3, peaks, nullptr), 30.0, 1.0);
+  EXPECT_FLOAT_EQ(peaks[0], 0.5f);
+
+  engine.ResetSlot(3);
+  engine.Tick(kTick);
+  EXPECT_EQ(history.Copy(3, peaks, nullptr), history.Copy(0, nullptr, nullptr));
+  EXPECT_EQ(peaks[0], 0.0f);
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
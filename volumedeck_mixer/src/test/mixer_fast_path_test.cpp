@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fake_mixer_backend.h"
+#include "meter_engine.h"
+#include "mixer_fast_path.h"
+#include "sample_scheduler.h"
+#include "state_channel.h"
+#include "volumedeck_mixer_ffi.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+// The plugin's arrangement: a channel whose roster names the slots, and a
+// fast path installed behind the C ABI.
+class FastPathTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    music_ = backend_.AddSession("music.exe", 10);
+    game_ = backend_.AddSession("game.exe", 11);
+    ASSERT_TRUE(writer_.Open());
+    ASSERT_TRUE(writer_.PublishRoster({{"master", "", ""}, {music_, "music.exe", ""}, {game_, "game.exe", ""}}));
+    ASSERT_TRUE(reader_.Attach(writer_.header(), writer_.size()));
+  }
+  void TearDown() override { InstallMixerFastPath(nullptr); }
+
+  // What Dart tags its calls with after reading the roster.
+  uint32_t gen() const { return (uint32_t)writer_.generation(); }
+
+  FakeMixerBackend backend_;
+  StateChannelWriter writer_{16};
+  StateChannelReader reader_;
+  std::string music_, game_;
+};
+
+}  // namespace
+
+TEST_F(FastPathTest, NothingHappensBeforeInstall) {
+  InstallMixerFastPath(nullptr);
+  EXPECT_EQ(VolumedeckMixerSetVolume(gen(), 1, 0.5f), 0);
+  float meters[VOLUMEDECK_METER_FIELDS];
+  EXPECT_EQ(VolumedeckMixerReadMeters(meters, 1), 0u);
+  EXPECT_FLOAT_EQ(backend_.session_volume(music_), 1.0f);
+}
+
+TEST_F(FastPathTest, SetsBySlot) {
+  MixerFastPath path(&backend_, &reader_);
+  InstallMixerFastPath(&path);
+
+  EXPECT_EQ(VolumedeckMixerSetVolume(gen(), 0, 0.3f), 1);
+  EXPECT_EQ(VolumedeckMixerSetVolume(gen(), 2, 0.6f), 1);
+  EXPECT_EQ(VolumedeckMixerSetMute(gen(), 1, 1), 1);
+  EXPECT_EQ(VolumedeckMixerSetVolume(gen(), 7, 0.1f), 0);
+  EXPECT_FLOAT_EQ(backend_.master_volume(), 0.3f);
+  EXPECT_FLOAT_EQ(backend_.session_volume(game_), 0.6f);
+  EXPECT_TRUE(backend_.session_mute(music_));
+  // Out of range values are clamped, not rejected.
+  EXPECT_EQ(VolumedeckMixerSetVolume(gen(), 1, 1.5f), 1);
+  EXPECT_FLOAT_EQ(backend_.session_volume(music_), 1.0f);
+}
+
+TEST_F(FastPathTest, AppliesBatchesInOrder) {
+  MixerFastPath path(&backend_, &reader_);
+  InstallMixerFastPath(&path);
+  const VolumedeckMixerOp ops[] = {
+      {gen(), 1, VOLUMEDECK_OP_VOLUME, 0.2f},
+      {gen(), 1, VOLUMEDECK_OP_VOLUME, 0.4f},
+      {gen(), 2, VOLUMEDECK_OP_MUTE, 1.0f},
+      {gen(), 9, VOLUMEDECK_OP_VOLUME, 0.5f},  // no such slot
+      {gen(), 2, 77, 0.5f},                    // no such op
+  };
+  EXPECT_EQ(VolumedeckMixerApplyBatch(ops, 5), 3u);
+  EXPECT_FLOAT_EQ(backend_.session_volume(music_), 0.4f);
+  EXPECT_TRUE(backend_.session_mute(game_));
+}
+
+TEST_F(FastPathTest, FollowsRosterChanges) {
+  MixerFastPath path(&backend_, &reader_);
+  InstallMixerFastPath(&path);
+  EXPECT_EQ(VolumedeckMixerSetVolume(gen(), 1, 0.5f), 1);
+  EXPECT_FLOAT_EQ(backend_.session_volume(music_), 0.5f);
+
+  // music.exe went away; its slot is empty and game.exe kept slot 2.
+  ASSERT_TRUE(writer_.PublishRoster({{"master", "", ""}, {"", "", ""}, {game_, "game.exe", ""}}));
+  EXPECT_EQ(VolumedeckMixerSetVolume(gen(), 1, 0.25f), 0);
+  EXPECT_FLOAT_EQ(backend_.session_volume(music_), 0.5f);
+  EXPECT_EQ(VolumedeckMixerSetVolume(gen(), 2, 0.25f), 1);
+}
+
+TEST_F(FastPathTest, RefusesWritesAgainstAnOlderRoster) {
+  MixerFastPath path(&backend_, &reader_);
+  InstallMixerFastPath(&path);
+  const uint32_t before = gen();
+
+  // game.exe moved into slot 1 after Dart resolved music.exe there.
+  ASSERT_TRUE(writer_.PublishRoster({{"master", "", ""}, {game_, "game.exe", ""}, {music_, "music.exe", ""}}));
+  EXPECT_EQ(VolumedeckMixerSetVolume(before, 1, 0.25f), 0);
+  EXPECT_EQ(VolumedeckMixerSetMute(before, 1, 1), 0);
+  const VolumedeckMixerOp stale[] = {{before, 1, VOLUMEDECK_OP_VOLUME, 0.25f}, {gen(), 2, VOLUMEDECK_OP_VOLUME, 0.75f}};
+  EXPECT_EQ(VolumedeckMixerApplyBatch(stale, 2), 1u);
+  EXPECT_FLOAT_EQ(backend_.session_volume(game_), 1.0f);
+  EXPECT_FALSE(backend_.session_mute(game_));
+  EXPECT_FLOAT_EQ(backend_.session_volume(music_), 0.75f);
+
+  // The default output doesn't depend on the roster.
+  EXPECT_EQ(VolumedeckMixerSetVolume(before, 0, 0.4f), 1);
+  EXPECT_FLOAT_EQ(backend_.master_volume(), 0.4f);
+}
+
+class StartCountingBackend : public FakeMixerBackend {
+ public:
+  bool Start() override {
+    starts++;
+    return start_ok;
+  }
+  int starts = 0;
+  bool start_ok = true;
+};
+
+TEST_F(FastPathTest, StartsTheBackendAtInstall) {
+  StartCountingBackend backend;
+  MixerFastPath path(&backend, &reader_);
+  ASSERT_TRUE(InstallMixerFastPath(&path));
+  EXPECT_EQ(backend.starts, 1);
+  EXPECT_EQ(VolumedeckMixerSetVolume(gen(), 0, 0.5f), 1);
+  EXPECT_EQ(backend.starts, 1);
+}
+
+TEST_F(FastPathTest, IsNotInstalledIfTheBackendFailsToStart) {
+  StartCountingBackend backend;
+  backend.start_ok = false;
+  MixerFastPath path(&backend, &reader_);
+  EXPECT_FALSE(InstallMixerFastPath(&path));
+  EXPECT_EQ(VolumedeckMixerSetVolume(gen(), 0, 0.5f), 0);
+}
+
+// Holds a session write open until released.
+class BlockingBackend : public FakeMixerBackend {
+ public:
+  bool SetSessionVolume(const std::string& id, float volume) override {
+    std::unique_lock<std::mutex> lock(mu);
+    entered = true;
+    cv.notify_all();
+    cv.wait(lock, [this] { return released; });
+    return FakeMixerBackend::SetSessionVolume(id, volume);
+  }
+  std::mutex mu;
+  std::condition_variable cv;
+  bool entered = false;
+  bool released = false;
+};
+
+TEST_F(FastPathTest, UninstallWaitsForCallsInFlight) {
+  BlockingBackend backend;
+  const std::string id = backend.AddSession("music.exe", 10);
+  ASSERT_TRUE(writer_.PublishRoster({{"master", "", ""}, {id, "music.exe", ""}}));
+  MixerFastPath path(&backend, &reader_);
+  InstallMixerFastPath(&path);
+
+  std::thread caller([&] { VolumedeckMixerSetVolume(gen(), 1, 0.5f); });
+  {
+    std::unique_lock<std::mutex> lock(backend.mu);
+    backend.cv.wait(lock, [&] { return backend.entered; });
+  }
+  std::atomic<bool> uninstalled{false};
+  std::thread uninstaller([&] {
+    InstallMixerFastPath(nullptr);
+    uninstalled = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(uninstalled);
+
+  {
+    std::lock_guard<std::mutex> lock(backend.mu);
+    backend.released = true;
+  }
+  backend.cv.notify_all();
+  caller.join();
+  uninstaller.join();
+  EXPECT_TRUE(uninstalled);
+  EXPECT_FLOAT_EQ(backend.session_volume(id), 0.5f);
+}
+
+TEST_F(FastPathTest, ReadsMetersFromTheChannel) {
+  MixerFastPath path(&backend_, &reader_);
+  InstallMixerFastPath(&path);
+  const StateSlot slots[] = {{1.0f, 0.5f, 0, 0}, {1.0f, 0.25f, 0, 10}};
+  writer_.PublishFrame(slots, 2);
+
+  float meters[4 * VOLUMEDECK_METER_FIELDS] = {};
+  ASSERT_EQ(VolumedeckMixerReadMeters(meters, 4), 2u);
+  EXPECT_FLOAT_EQ(meters[0], 0.5f);
+  EXPECT_FLOAT_EQ(meters[VOLUMEDECK_METER_FIELDS], 0.25f);
+  EXPECT_EQ(VolumedeckMixerReadMeters(meters, 1), 1u);
+}
+
+TEST_F(FastPathTest, WritesCountAsSamplerActivity) {
+  SampleScheduler sampler;
+  sampler.Subscribe();
+  MixerFastPath path(&backend_, &reader_, nullptr, &sampler);
+  InstallMixerFastPath(&path);
+
+  EXPECT_DOUBLE_EQ(sampler.Rate(SampleScheduler::Clock::now()), sampler.rates().low_hz);
+  EXPECT_EQ(VolumedeckMixerSetVolume(gen(), 1, 0.5f), 1);
+  EXPECT_DOUBLE_EQ(sampler.Rate(SampleScheduler::Clock::now()), sampler.rates().high_hz);
+}
+
+class FixedProbe : public MeterProbe {
+ public:
+  size_t Sample(float* peaks, size_t capacity) override {
+    for (size_t i = 0; i < capacity; i++) peaks[i] = 0.5f;
+    return capacity;
+  }
+};
+
+TEST_F(FastPathTest, ReadsBallisticsFromTheMeterEngine) {
+  FixedProbe probe;
+  MeterEngine engine(&probe, 3);
+  for (int i = 0; i < 100; i++) engine.Tick(0.004);
+  MixerFastPath path(&backend_, &reader_, &engine);
+  InstallMixerFastPath(&path);
+
+  float meters[3 * VOLUMEDECK_METER_FIELDS] = {};
+  ASSERT_EQ(VolumedeckMixerReadMeters(meters, 3), 3u);
+  MeterReading r;
+  ASSERT_TRUE(engine.Read(2, &r));
+  EXPECT_FLOAT_EQ(meters[2 * VOLUMEDECK_METER_FIELDS + 0], r.peak);
+  EXPECT_FLOAT_EQ(meters[2 * VOLUMEDECK_METER_FIELDS + 3], r.vu);
+  EXPECT_FLOAT_EQ(meters[2 * VOLUMEDECK_METER_FIELDS + 4], r.rms);
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
@@ -0,0 +1,229 @@
+#include "pe_fixture.h"
+
+#include <cstring>
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+constexpr uint32_t kSectionRva = 0x1000;
+constexpr uint32_t kFileAlign = 0x200;
+
+void Put16(std::vector<uint8_t>& b, size_t at, uint32_t v) {
+  b[at] = (uint8_t)v;
+  b[at + 1] = (uint8_t)(v >> 8);
+}
+
+void Put32(std::vector<uint8_t>& b, size_t at, uint32_t v) {
+  Put16(b, at, v & 0xFFFF);
+  Put16(b, at + 2, v >> 16);
+}
+
+size_t Append(std::vector<uint8_t>& b, size_t n) {
+  const size_t at = b.size();
+  b.resize(at + n, 0);
+  return at;
+}
+
+void Align(std::vector<uint8_t>& b, size_t a) {
+  while (b.size() % a) b.push_back(0);
+}
+
+// IMAGE_RESOURCE_DIRECTORY with `ids.size()` id entries; returns the
+// offset of the first entry so the caller can fill in targets.
+size_t AddDirectory(std::vector<uint8_t>& r, const std::vector<uint32_t>& ids) {
+  const size_t dir = Append(r, 16 + ids.size() * 8);
+  Put16(r, dir + 14, (uint32_t)ids.size());
+  for (size_t i = 0; i < ids.size(); i++) Put32(r, dir + 16 + i * 8, ids[i]);
+  return dir + 16;
+}
+
+void SetSubdir(std::vector<uint8_t>& r, size_t entry, size_t target) {
+  Put32(r, entry + 4, 0x80000000u | (uint32_t)target);
+}
+
+uint8_t EdgeByte(int w) { return (uint8_t)(w >= 256 ? 0 : w); }
+
+// AND mask rows are 1 bpp padded to 32 bits, bottom-up like the XOR part.
+void AppendMask(std::vector<uint8_t>& out, const std::vector<uint8_t>& mask, int w, int h) {
+  const size_t stride = (((size_t)w + 31) / 32) * 4;
+  const size_t at = Append(out, stride * h);
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      if (!mask.empty() && mask[(size_t)y * w + x]) {
+        out[at + (size_t)(h - 1 - y) * stride + x / 8] |= (uint8_t)(0x80 >> (x % 8));
+      }
+    }
+  }
+}
+
+size_t AppendInfoHeader(std::vector<uint8_t>& out, int w, int h, int bpp, uint32_t colors) {
+  const size_t at = Append(out, 40);
+  Put32(out, at, 40);
+  Put32(out, at + 4, (uint32_t)w);
+  Put32(out, at + 8, (uint32_t)(h * 2));
+  Put16(out, at + 12, 1);
+  Put16(out, at + 14, (uint32_t)bpp);
+  Put32(out, at + 32, colors);
+  return at;
+}
+
+std::vector<uint8_t> MakeBmpIconDirect(const std::vector<uint8_t>& px, int bytes_pp, int w, int h,
+                                       const std::vector<uint8_t>& mask) {
+  std::vector<uint8_t> out;
+  AppendInfoHeader(out, w, h, bytes_pp * 8, 0);
+  const size_t stride = (((size_t)w * bytes_pp * 8 + 31) / 32) * 4;
+  const size_t at = Append(out, stride * h);
+  for (int y = 0; y < h; y++) {
+    memcpy(&out[at + (size_t)(h - 1 - y) * stride], &px[(size_t)y * w * bytes_pp],
+           (size_t)w * bytes_pp);
+  }
+  AppendMask(out, mask, w, h);
+  return out;
+}
+
+}  // namespace
+
+std::vector<uint8_t> MakeBmpIcon32(const std::vector<uint8_t>& bgra, int w, int h,
+                                   const std::vector<uint8_t>& mask) {
+  return MakeBmpIconDirect(bgra, 4, w, h, mask);
+}
+
+std::vector<uint8_t> MakeBmpIcon24(const std::vector<uint8_t>& bgr, int w, int h,
+                                   const std::vector<uint8_t>& mask) {
+  return MakeBmpIconDirect(bgr, 3, w, h, mask);
+}
+
+std::vector<uint8_t> MakeBmpIconIndexed(int bpp, const std::vector<uint8_t>& palette,
+                                        const std::vector<uint8_t>& indices, int w, int h,
+                                        const std::vector<uint8_t>& mask) {
+  std::vector<uint8_t> out;
+  AppendInfoHeader(out, w, h, bpp, (uint32_t)(palette.size() / 4));
+  out.insert(out.end(), palette.begin(), palette.end());
+  const size_t stride = (((size_t)w * bpp + 31) / 32) * 4;
+  const size_t at = Append(out, stride * h);
+  const int per_byte = 8 / bpp;
+  for (int y = 0; y < h; y++) {
+    uint8_t* row = &out[at + (size_t)(h - 1 - y) * stride];
+    for (int x = 0; x < w; x++) {
+      const int shift = (per_byte - 1 - x % per_byte) * bpp;
+      row[x / per_byte] |= (uint8_t)(indices[(size_t)y * w + x] << shift);
+    }
+  }
+  AppendMask(out, mask, w, h);
+  return out;
+}
+
+std::vector<uint8_t> BuildPeFixture(const std::vector<FixtureIcon>& icons, bool pe32plus) {
+  const size_t n = icons.size();
+
+  // ---- .rsrc contents, offsets relative to the section start ----
+  std::vector<uint8_t> r;
+  const size_t root = AddDirectory(r, {3, 14});  // RT_ICON, RT_GROUP_ICON (sorted)
+
+  std::vector<uint32_t> icon_ids;
+  for (size_t i = 0; i < n; i++) icon_ids.push_back((uint32_t)(i + 1));
+  const size_t icon_type_at = r.size();
+  const size_t icon_type = AddDirectory(r, icon_ids);
+  const size_t group_type_at = r.size();
+  const size_t group_type = AddDirectory(r, {1});
+  SetSubdir(r, root, icon_type_at);
+  SetSubdir(r, root + 8, group_type_at);
+
+  // Language level (en-US) for every name, each pointing at a data entry.
+  std::vector<size_t> lang(n + 1);
+  for (size_t i = 0; i <= n; i++) {
+    const size_t dir_at = r.size();
+    lang[i] = AddDirectory(r, {0x409});
+    SetSubdir(r, i < n ? icon_type + i * 8 : group_type, dir_at);
+  }
+  std::vector<size_t> data_entry(n + 1);
+  for (size_t i = 0; i <= n; i++) {
+    data_entry[i] = Append(r, 16);
+    Put32(r, lang[i] + 4, (uint32_t)data_entry[i]);
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    Align(r, 8);
+    const size_t at = r.size();
+    r.insert(r.end(), icons[i].payload.begin(), icons[i].payload.end());
+    Put32(r, data_entry[i], kSectionRva + (uint32_t)at);
+    Put32(r, data_entry[i] + 4, (uint32_t)icons[i].payload.size());
+  }
+
+  // GRPICONDIR + GRPICONDIRENTRY[n]
+  Align(r, 8);
+  const size_t grp = Append(r, 6 + n * 14);
+  Put16(r, grp + 2, 1);
+  Put16(r, grp + 4, (uint32_t)n);
+  for (size_t i = 0; i < n; i++) {
+    const size_t e = grp + 6 + i * 14;
+    r[e] = EdgeByte(icons[i].width);
+    r[e + 1] = EdgeByte(icons[i].width);
+    Put16(r, e + 4, 1);
+    Put16(r, e + 6, (uint32_t)icons[i].bit_count);
+    Put32(r, e + 8, (uint32_t)icons[i].payload.size());
+    Put16(r, e + 12, (uint32_t)(i + 1));
+  }
+  Put32(r, data_entry[n], kSectionRva + (uint32_t)grp);
+  Put32(r, data_entry[n] + 4, (uint32_t)(6 + n * 14));
+
+  const uint32_t rsrc_size = (uint32_t)r.size();
+  Align(r, kFileAlign);
+
+  // ---- headers ----
+  std::vector<uint8_t> f(kFileAlign, 0);
+  f[0] = 'M';
+  f[1] = 'Z';
+  const uint32_t pe = 0x40;
+  Put32(f, 0x3C, pe);
+  memcpy(&f[pe], "PE\0\0", 4);
+
+  const uint32_t opt_size = pe32plus ? 240 : 224;
+  const size_t coff = pe + 4;
+  Put16(f, coff, pe32plus ? 0x8664 : 0x14C);
+  Put16(f, coff + 2, 1);  // sections
+  Put16(f, coff + 16, opt_size);
+  Put16(f, coff + 18, 0x0102);  // executable, 32-bit machine
+
+  const size_t opt = coff + 20;
+  Put16(f, opt, pe32plus ? 0x20B : 0x10B);
+  Put32(f, opt + 32, 0x1000);     // section alignment
+  Put32(f, opt + 36, kFileAlign);  // file alignment
+  const size_t dirs = opt + (pe32plus ? 112 : 96);
+  Put32(f, dirs - 4, 16);  // NumberOfRvaAndSizes
+  Put32(f, dirs + 2 * 8, kSectionRva);
+  Put32(f, dirs + 2 * 8 + 4, rsrc_size);
+
+  const size_t sect = opt + opt_size;
+  memcpy(&f[sect], ".rsrc", 5);
+  Put32(f, sect + 8, rsrc_size);
+  Put32(f, sect + 12, kSectionRva);
+  Put32(f, sect + 16, (uint32_t)r.size());
+  Put32(f, sect + 20, kFileAlign);
+
+  f.insert(f.end(), r.begin(), r.end());
+  return f;
+}
+
+std::vector<uint8_t> BuildIcoFixture(const std::vector<FixtureIcon>& icons) {
+  const size_t n = icons.size();
+  std::vector<uint8_t> f(6 + n * 16, 0);
+  Put16(f, 2, 1);
+  Put16(f, 4, (uint32_t)n);
+  for (size_t i = 0; i < n; i++) {
+    const size_t e = 6 + i * 16;
+    f[e] = EdgeByte(icons[i].width);
+    f[e + 1] = EdgeByte(icons[i].width);
+    Put16(f, e + 4, 1);
+    Put16(f, e + 6, (uint32_t)icons[i].bit_count);
+    Put32(f, e + 8, (uint32_t)icons[i].payload.size());
+    Put32(f, e + 12, (uint32_t)f.size());
+    f.insert(f.end(), icons[i].payload.begin(), icons[i].payload.end());
+  }
+  return f;
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
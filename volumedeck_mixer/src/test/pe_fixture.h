@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace volumedeck_mixer {
+namespace test {
+
+// Synthesizes the files the PE icon reader has to cope with, so the tests
+// run on any platform without shipping Windows binaries.
+
+struct FixtureIcon {
+  int width = 0;  // 256 is written as 0, like the real thing
+  int bit_count = 32;
+  std::vector<uint8_t> payload;  // PNG or BITMAPINFOHEADER + XOR + AND
+};
+
+// Minimal PE32 (or PE32+) image whose only section is .rsrc holding one
+// RT_GROUP_ICON that references one RT_ICON per entry.
+std::vector<uint8_t> BuildPeFixture(const std::vector<FixtureIcon>& icons, bool pe32plus);
+
+std::vector<uint8_t> BuildIcoFixture(const std::vector<FixtureIcon>& icons);
+
+// DIB icon payloads. `bgra` is straight alpha, top-down; `mask` has one
+// byte per pixel, non-zero meaning transparent (AND bit set).
+std::vector<uint8_t> MakeBmpIcon32(const std::vector<uint8_t>& bgra, int w, int h,
+                                   const std::vector<uint8_t>& mask);
+std::vector<uint8_t> MakeBmpIcon24(const std::vector<uint8_t>& bgr, int w, int h,
+                                   const std::vector<uint8_t>& mask);
+// 1, 4 or 8 bpp. `palette` is BGRX, `indices` one byte per pixel.
+std::vector<uint8_t> MakeBmpIconIndexed(int bpp, const std::vector<uint8_t>& palette,
+                                        const std::vector<uint8_t>& indices, int w, int h,
+                                        const std::vector<uint8_t>& mask);
+
+}  // namespace test
+}  // namespace volumedeck_mixer
@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "pe_fixture.h"
+#include "pe_icon_reader.h"
+#include "png_encoder.h"
+#include "test_util.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+// Straight-alpha BGRA with a transparent border and a soft edge.
+std::vector<uint8_t> IconBgra(int size, uint8_t tint) {
+  std::vector<uint8_t> px((size_t)size * size * 4, 0);
+  const int m = size / 8;
+  for (int y = m; y < size - m; y++) {
+    for (int x = m; x < size - m; x++) {
+      uint8_t* p = &px[((size_t)y * size + x) * 4];
+      p[0] = tint;
+      p[1] = (uint8_t)(4 * x);
+      p[2] = (uint8_t)(4 * y);
+      p[3] = (x == m || y == m) ? 100 : 255;
+    }
+  }
+  return px;
+}
+
+FixtureIcon Bmp32(int size, uint8_t tint) {
+  FixtureIcon i;
+  i.width = size;
+  i.bit_count = 32;
+  i.payload = MakeBmpIcon32(IconBgra(size, tint), size, size, {});
+  return i;
+}
+
+FixtureIcon Png(int size, uint8_t tint) {
+  auto px = IconBgra(size, tint);
+  PngEncoder enc;
+  EXPECT_TRUE(enc.EncodeBgra(px.data(), size, size, (size_t)size * 4));
+  FixtureIcon i;
+  i.width = size;
+  i.bit_count = 32;
+  i.payload = enc.png();
+  return i;
+}
+
+void WriteFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+  std::ofstream f(path, std::ios::binary);
+  f.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size());
+}
+
+}  // namespace
+
+TEST(PeIconReader, ListsGroupVariantsInBothPeFlavours) {
+  const std::vector<FixtureIcon> icons = {Bmp32(16, 1), Bmp32(32, 2), Png(256, 3)};
+  for (bool plus : {false, true}) {
+    SCOPED_TRACE(plus ? "PE32+" : "PE32");
+    auto pe = BuildPeFixture(icons, plus);
+    std::vector<IconVariant> v;
+    ASSERT_TRUE(ListPeIconVariants(pe.data(), pe.size(), v));
+    ASSERT_EQ(v.size(), 3u);
+    EXPECT_EQ(v[0].width, 16);
+    EXPECT_EQ(v[1].width, 32);
+    EXPECT_EQ(v[2].width, 256);  // stored as 0
+    EXPECT_EQ(v[2].size, icons[2].payload.size());
+  }
+}
+
+TEST(PeIconReader, PicksSmallestVariantThatFits) {
+  std::vector<IconVariant> v(4);
+  v[0].width = 16, v[0].bit_count = 32;
+  v[1].width = 32, v[1].bit_count = 8;
+  v[2].width = 32, v[2].bit_count = 32;
+  v[3].width = 48, v[3].bit_count = 32;
+  EXPECT_EQ(PickIconVariant(v, 16), 0);
+  EXPECT_EQ(PickIconVariant(v, 20), 2);  // deeper colour wins at equal size
+  EXPECT_EQ(PickIconVariant(v, 48), 3);
+  EXPECT_EQ(PickIconVariant(v, 64), 3);  // nothing fits: largest
+  EXPECT_EQ(PickIconVariant({}, 16), -1);
+}
+
+TEST(PeIconReader, Decodes32BitDibWithAlpha) {
+  const auto px = IconBgra(24, 9);
+  IconVariant v;
+  auto bmp = MakeBmpIcon32(px, 24, 24, {});
+  v.data = bmp.data();
+  v.size = bmp.size();
+  DecodedIcon out;
+  ASSERT_TRUE(DecodeIconVariant(v, &out));
+  EXPECT_EQ(out.width, 24);
+  EXPECT_EQ(out.height, 24);
+  EXPECT_EQ(out.bgra, px);
+}
+
+TEST(PeIconReader, AndMaskSuppliesAlphaForLegacyDibs) {
+  const int w = 5, h = 3;  // odd width: exercises row padding
+  std::vector<uint8_t> mask((size_t)w * h, 0);
+  mask[0] = mask[7] = mask[14] = 1;
+
+  // 32 bpp, all alpha zero (pre-XP icon saved as 32 bit).
+  std::vector<uint8_t> bgra((size_t)w * h * 4, 0);
+  for (size_t i = 0; i < (size_t)w * h; i++) bgra[i * 4] = (uint8_t)(10 * i);
+  auto bmp32 = MakeBmpIcon32(bgra, w, h, mask);
+
+  std::vector<uint8_t> bgr((size_t)w * h * 3);
+  for (size_t i = 0; i < bgr.size(); i++) bgr[i] = (uint8_t)i;
+  auto bmp24 = MakeBmpIcon24(bgr, w, h, mask);
+
+  for (auto* bmp : {&bmp32, &bmp24}) {
+    IconVariant v;
+    v.data = bmp->data();
+    v.size = bmp->size();
+    DecodedIcon out;
+    ASSERT_TRUE(DecodeIconVariant(v, &out));
+    for (size_t i = 0; i < (size_t)w * h; i++) {
+      EXPECT_EQ(out.bgra[i * 4 + 3], mask[i] ? 0 : 255) << i;
+    }
+  }
+}
+
+TEST(PeIconReader, DecodesPalettedDibs) {
+  const int w = 9, h = 4;
+  for (int bpp : {1, 4, 8}) {
+    SCOPED_TRACE("bpp " + std::to_string(bpp));
+    const int colors = 1 << bpp;
+    std::vector<uint8_t> palette((size_t)colors * 4);
+    for (int c = 0; c < colors; c++) {
+      palette[c * 4] = (uint8_t)c;
+      palette[c * 4 + 1] = (uint8_t)(255 - c);
+      palette[c * 4 + 2] = (uint8_t)(c * 3);
+    }
+    std::vector<uint8_t> idx((size_t)w * h), mask((size_t)w * h);
+    for (size_t i = 0; i < idx.size(); i++) {
+      idx[i] = (uint8_t)((i * 7) % colors);
+      mask[i] = (uint8_t)(i % 5 == 0);
+    }
+    auto bmp = MakeBmpIconIndexed(bpp, palette, idx, w, h, mask);
+    IconVariant v;
+    v.data = bmp.data();
+    v.size = bmp.size();
+    DecodedIcon out;
+    ASSERT_TRUE(DecodeIconVariant(v, &out));
+    for (size_t i = 0; i < idx.size(); i++) {
+      EXPECT_EQ(out.bgra[i * 4], palette[idx[i] * 4]) << i;
+      EXPECT_EQ(out.bgra[i * 4 + 1], palette[idx[i] * 4 + 1]) << i;
+      EXPECT_EQ(out.bgra[i * 4 + 3], mask[i] ? 0 : 255) << i;
+    }
+  }
+}
+
+TEST(PeIconReader, ExtractsBestFitFromExeAndIcoFiles) {
+  TempDir dir;
+  const std::vector<FixtureIcon> icons = {Bmp32(16, 1), Png(48, 2), Bmp32(32, 3)};
+  WriteFile(dir.File("app.exe"), BuildPeFixture(icons, true));
+  WriteFile(dir.File("app.ico"), BuildIcoFixture(icons));
+
+  for (const char* name : {"app.exe", "app.ico"}) {
+    SCOPED_TRACE(name);
+    DecodedIcon out;
+    ASSERT_TRUE(ExtractIconFromFile(dir.File(name), 24, &out));
+    EXPECT_EQ(out.width, 32);
+    EXPECT_EQ(out.bgra, IconBgra(32, 3));
+
+    ASSERT_TRUE(ExtractIconFromFile(dir.File(name), 40, &out));
+    EXPECT_EQ(out.width, 48);  // PNG variant
+    EXPECT_EQ(out.bgra, IconBgra(48, 2));
+  }
+  DecodedIcon out;
+  EXPECT_FALSE(ExtractIconFromFile(dir.File("missing.exe"), 32, &out));
+}
+
+TEST(PeIconReader, FallsBackWhenBestVariantIsDamaged) {
+  auto icons = std::vector<FixtureIcon>{Bmp32(16, 1), Png(32, 2)};
+  icons[1].payload.resize(40);  // truncated PNG
+  TempDir dir;
+  WriteFile(dir.File("app.exe"), BuildPeFixture(icons, false));
+  DecodedIcon out;
+  ASSERT_TRUE(ExtractIconFromFile(dir.File("app.exe"), 32, &out));
+  EXPECT_EQ(out.width, 16);
+}
+
+TEST(PeIconReader, SurvivesTruncatedAndCorruptImages) {
+  const auto pe = BuildPeFixture({Bmp32(16, 1), Png(32, 2)}, false);
+  std::vector<IconVariant> v;
+  DecodedIcon out;
+  for (size_t n = 0; n < pe.size(); n += 7) {
+    if (ListPeIconVariants(pe.data(), n, v)) {
+      for (const auto& var : v) DecodeIconVariant(var, &out);
+    }
+  }
+
+  std::mt19937 rng(1);
+  for (int round = 0; round < 2000; round++) {
+    auto bad = pe;
+    for (int k = 0; k < 4; k++) bad[rng() % bad.size()] = (uint8_t)rng();
+    if (ListPeIconVariants(bad.data(), bad.size(), v)) {
+      for (const auto& var : v) DecodeIconVariant(var, &out);
+    }
+  }
+
+  const uint8_t junk[64] = {'M', 'Z'};
+  EXPECT_FALSE(ListPeIconVariants(junk, sizeof(junk), v));
+  EXPECT_FALSE(ListIcoVariants(junk, sizeof(junk), v));
+}
+
+TEST(PeIconReader, RejectsAnOptionalHeaderCutAfterTheMagic) {
+  for (bool plus : {false, true}) {
+    auto pe = BuildPeFixture({Bmp32(16, 1)}, plus);
+    const uint32_t at = pe[0x3C] | (pe[0x3D] << 8) | (pe[0x3E] << 16) | ((uint32_t)pe[0x3F] << 24);
+    const size_t opt = at + 24;
+    // SizeOfOptionalHeader = 2 and nothing after the magic: the directory
+    // count would be read from past the end.
+    pe[at + 4 + 16] = 2;
+    pe[at + 4 + 17] = 0;
+    const std::vector<uint8_t> cut(pe.begin(), pe.begin() + opt + 2);
+    std::vector<IconVariant> v;
+    EXPECT_FALSE(ListPeIconVariants(cut.data(), cut.size(), v)) << plus;
+  }
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
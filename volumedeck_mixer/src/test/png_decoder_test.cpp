@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "png_decoder.h"
+#include "png_encoder.h"
+#include "png_reference.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+std::vector<uint8_t> NoiseBgra(int w, int h, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<uint8_t> px((size_t)w * h * 4);
+  for (auto& b : px) b = (uint8_t)rng();
+  return px;
+}
+
+std::vector<uint8_t> GradientBgra(int w, int h) {
+  std::vector<uint8_t> px((size_t)w * h * 4);
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      uint8_t* p = &px[((size_t)y * w + x) * 4];
+      p[0] = (uint8_t)(x * 3);
+      p[1] = (uint8_t)(y * 5);
+      p[2] = (uint8_t)(x + y);
+      p[3] = (uint8_t)(x * y);
+    }
+  }
+  return px;
+}
+
+void PutBE32(std::vector<uint8_t>& out, uint32_t v) {
+  for (int s = 24; s >= 0; s -= 8) out.push_back((uint8_t)(v >> s));
+}
+
+void PutChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& body) {
+  PutBE32(out, (uint32_t)body.size());
+  const size_t start = out.size();
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), body.begin(), body.end());
+  PutBE32(out, Crc32(out.data() + start, body.size() + 4));
+}
+
+// PNG of any 8-bit colour type from unfiltered rows; IDAT split in two.
+std::vector<uint8_t> MakePng(int w, int h, int color_type, const std::vector<uint8_t>& pixels,
+                             const std::vector<uint8_t>& plte = {},
+                             const std::vector<uint8_t>& trns = {}) {
+  static const int kChannels[7] = {1, 0, 3, 1, 2, 0, 4};
+  const size_t row = (size_t)w * kChannels[color_type];
+  std::vector<uint8_t> raw;
+  for (int y = 0; y < h; y++) {
+    raw.push_back(0);
+    raw.insert(raw.end(), pixels.begin() + y * row, pixels.begin() + (y + 1) * row);
+  }
+  uLongf zsize = compressBound((uLong)raw.size());
+  std::vector<uint8_t> z(zsize);
+  compress2(z.data(), &zsize, raw.data(), (uLong)raw.size(), 9);
+  z.resize(zsize);
+
+  std::vector<uint8_t> out = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+  std::vector<uint8_t> ihdr;
+  PutBE32(ihdr, (uint32_t)w);
+  PutBE32(ihdr, (uint32_t)h);
+  ihdr.insert(ihdr.end(), {8, (uint8_t)color_type, 0, 0, 0});
+  PutChunk(out, "IHDR", ihdr);
+  if (!plte.empty()) PutChunk(out, "PLTE", plte);
+  if (!trns.empty()) PutChunk(out, "tRNS", trns);
+  PutChunk(out, "IDAT", std::vector<uint8_t>(z.begin(), z.begin() + z.size() / 2));
+  PutChunk(out, "IDAT", std::vector<uint8_t>(z.begin() + z.size() / 2, z.end()));
+  PutChunk(out, "IEND", {});
+  return out;
+}
+
+void ExpectDecodes(const std::vector<uint8_t>& png, int w, int h, const std::vector<uint8_t>& bgra) {
+  int dw = 0, dh = 0;
+  std::vector<uint8_t> out;
+  ASSERT_TRUE(DecodePngToBgra(png.data(), png.size(), &dw, &dh, out));
+  EXPECT_EQ(dw, w);
+  EXPECT_EQ(dh, h);
+  EXPECT_EQ(out, bgra);
+}
+
+}  // namespace
+
+TEST(PngDecoder, ReadsOwnEncoderOutput) {
+  for (auto mode : {PngEncoder::Deflate::kFixedHuffman, PngEncoder::Deflate::kStored}) {
+    PngEncoder enc(mode);
+    for (int size : {1, 7, 16, 32, 48, 256}) {
+      SCOPED_TRACE("size " + std::to_string(size));
+      for (const auto& px : {NoiseBgra(size, size, (uint32_t)size), GradientBgra(size, size)}) {
+        ASSERT_TRUE(enc.EncodeBgra(px.data(), size, size, (size_t)size * 4));
+        ExpectDecodes(enc.png(), size, size, px);
+      }
+    }
+  }
+}
+
+TEST(PngDecoder, ReadsZlibAtEveryLevel) {
+  // Level 0 is stored, 1 fixed Huffman, higher levels dynamic Huffman.
+  const int w = 64, h = 40;
+  const auto bgra = GradientBgra(w, h);
+  std::vector<uint8_t> rgba(bgra.size());
+  SwizzleBgraRgba(bgra.data(), rgba.data(), (size_t)w * h);
+  for (int level : {0, 1, 6, 9}) {
+    SCOPED_TRACE("level " + std::to_string(level));
+    std::vector<uint8_t> png;
+    ASSERT_TRUE(ReferenceEncodePng(rgba.data(), w, h, level, png));
+    ExpectDecodes(png, w, h, bgra);
+  }
+}
+
+TEST(PngDecoder, ExpandsOtherColourTypes) {
+  const int w = 3, h = 2;
+  // Grey.
+  ExpectDecodes(MakePng(w, h, 0, {0, 50, 100, 150, 200, 250}), w, h,
+                {0, 0, 0, 255, 50, 50, 50, 255, 100, 100, 100, 255,
+                 150, 150, 150, 255, 200, 200, 200, 255, 250, 250, 250, 255});
+  // Grey + alpha.
+  ExpectDecodes(MakePng(1, 2, 4, {10, 20, 30, 40}), 1, 2, {10, 10, 10, 20, 30, 30, 30, 40});
+  // RGB.
+  ExpectDecodes(MakePng(2, 1, 2, {1, 2, 3, 4, 5, 6}), 2, 1, {3, 2, 1, 255, 6, 5, 4, 255});
+  // Palette with partial tRNS.
+  ExpectDecodes(MakePng(3, 1, 3, {0, 1, 2}, {10, 20, 30, 40, 50, 60, 70, 80, 90}, {0, 128}), 3, 1,
+                {30, 20, 10, 0, 60, 50, 40, 128, 90, 80, 70, 255});
+}
+
+TEST(PngDecoder, RejectsCorruptData) {
+  const auto px = GradientBgra(16, 16);
+  PngEncoder enc;
+  ASSERT_TRUE(enc.EncodeBgra(px.data(), 16, 16, 64));
+  const auto& good = enc.png();
+
+  int w = 0, h = 0;
+  std::vector<uint8_t> out;
+  for (size_t n = 0; n < good.size(); n++) {
+    EXPECT_FALSE(DecodePngToBgra(good.data(), n, &w, &h, out)) << n;
+  }
+  auto bad = good;
+  bad[40] ^= 0x10;  // inside IDAT: chunk CRC no longer matches
+  EXPECT_FALSE(DecodePngToBgra(bad.data(), bad.size(), &w, &h, out));
+  EXPECT_FALSE(IsPng(good.data(), 7));
+  EXPECT_TRUE(IsPng(good.data(), good.size()));
+
+  // Palette index beyond PLTE.
+  EXPECT_FALSE(DecodePngToBgra(MakePng(1, 1, 3, {5}, {1, 2, 3}).data(),
+                               MakePng(1, 1, 3, {5}, {1, 2, 3}).size(), &w, &h, out));
+}
+
+TEST(PngDecoder, InflateChecksAdler) {
+  std::vector<uint8_t> src(5000);
+  for (size_t i = 0; i < src.size(); i++) src[i] = (uint8_t)(i * i);
+  uLongf zsize = compressBound((uLong)src.size());
+  std::vector<uint8_t> z(zsize);
+  ASSERT_EQ(compress2(z.data(), &zsize, src.data(), (uLong)src.size(), 6), Z_OK);
+  z.resize(zsize);
+
+  std::vector<uint8_t> out;
+  ASSERT_TRUE(Inflate(z.data(), z.size(), out, src.size()));
+  EXPECT_EQ(out, src);
+  z.back() ^= 1;
+  EXPECT_FALSE(Inflate(z.data(), z.size(), out));
+}
+
+TEST(PngDecoder, StopsInflatingAtTheImageSize) {
+  // 64 MiB of zeros for a 16x16 RGBA image: a few dozen KiB compressed.
+  const std::vector<uint8_t> raw(64u << 20);
+  uLongf zsize = compressBound((uLong)raw.size());
+  std::vector<uint8_t> z(zsize);
+  ASSERT_EQ(compress2(z.data(), &zsize, raw.data(), (uLong)raw.size(), 9), Z_OK);
+  z.resize(zsize);
+
+  const size_t expected = (16 * 4 + 1) * 16;
+  std::vector<uint8_t> out;
+  EXPECT_FALSE(Inflate(z.data(), z.size(), out, expected));
+  EXPECT_LE(out.size(), expected);
+
+  std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+  std::vector<uint8_t> ihdr;
+  PutBE32(ihdr, 16);
+  PutBE32(ihdr, 16);
+  ihdr.insert(ihdr.end(), {8, 6, 0, 0, 0});
+  PutChunk(png, "IHDR", ihdr);
+  PutChunk(png, "IDAT", z);
+  PutChunk(png, "IEND", {});
+  int w = 0, h = 0;
+  EXPECT_FALSE(DecodePngToBgra(png.data(), png.size(), &w, &h, out));
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
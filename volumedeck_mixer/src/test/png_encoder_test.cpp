@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "png_encoder.h"
+#include "png_reference.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+std::vector<uint8_t> NoiseBgra(int w, int h, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<uint8_t> px((size_t)w * h * 4);
+  for (auto& b : px) b = (uint8_t)rng();
+  return px;
+}
+
+// Rounded square on a transparent background, like most app icons.
+std::vector<uint8_t> IconBgra(int size) {
+  std::vector<uint8_t> px((size_t)size * size * 4, 0);
+  const int m = size / 8;
+  for (int y = m; y < size - m; y++) {
+    for (int x = m; x < size - m; x++) {
+      uint8_t* p = &px[((size_t)y * size + x) * 4];
+      p[0] = (uint8_t)(30 + 5 * x);
+      p[1] = (uint8_t)(120 + 2 * y);
+      p[2] = 220;
+      p[3] = (x == m || y == m || x == size - m - 1 || y == size - m - 1) ? 128 : 255;
+    }
+  }
+  return px;
+}
+
+std::vector<uint8_t> ToRgba(const std::vector<uint8_t>& bgra) {
+  std::vector<uint8_t> rgba(bgra.size());
+  for (size_t i = 0; i < bgra.size(); i += 4) {
+    rgba[i] = bgra[i + 2];
+    rgba[i + 1] = bgra[i + 1];
+    rgba[i + 2] = bgra[i];
+    rgba[i + 3] = bgra[i + 3];
+  }
+  return rgba;
+}
+
+void ExpectRoundTrip(PngEncoder& enc, const std::vector<uint8_t>& bgra, int w, int h) {
+  ASSERT_TRUE(enc.EncodeBgra(bgra.data(), w, h, (size_t)w * 4));
+  int dw = 0, dh = 0;
+  std::vector<uint8_t> decoded;
+  ASSERT_TRUE(ReferenceDecodePng(enc.png().data(), enc.png().size(), &dw, &dh, decoded));
+  EXPECT_EQ(dw, w);
+  EXPECT_EQ(dh, h);
+  EXPECT_EQ(decoded, ToRgba(bgra));
+}
+
+}  // namespace
+
+TEST(PngEncoder, Checksums) {
+  const char* s = "123456789";
+  EXPECT_EQ(Crc32(reinterpret_cast<const uint8_t*>(s), 9), 0xCBF43926u);
+  const char* w = "Wikipedia";
+  EXPECT_EQ(Adler32(reinterpret_cast<const uint8_t*>(w), 9), 0x11E60398u);
+}
+
+TEST(PngEncoder, SwizzleHandlesVectorTails) {
+  for (size_t n : {1u, 3u, 4u, 5u, 15u, 16u, 17u, 33u}) {
+    auto bgra = NoiseBgra((int)n, 1, (uint32_t)n);
+    std::vector<uint8_t> out(bgra.size());
+    SwizzleBgraRgba(bgra.data(), out.data(), n);
+    EXPECT_EQ(out, ToRgba(bgra)) << n;
+
+    SwizzleBgraRgba(bgra.data(), bgra.data(), n);  // in place
+    EXPECT_EQ(bgra, out) << n;
+  }
+}
+
+TEST(PngEncoder, FixedHuffmanRoundTrips) {
+  PngEncoder enc;  // reused on purpose
+  for (int size : {1, 2, 3, 5, 16, 20, 24, 32, 48, 64}) {
+    SCOPED_TRACE("size " + std::to_string(size));
+    ExpectRoundTrip(enc, IconBgra(size), size, size);
+    ExpectRoundTrip(enc, NoiseBgra(size, size, (uint32_t)size), size, size);
+  }
+  ExpectRoundTrip(enc, NoiseBgra(7, 3, 9), 7, 3);
+  ExpectRoundTrip(enc, std::vector<uint8_t>(64 * 64 * 4, 0), 64, 64);
+  // Long runs: exercises maximum match length and far distances.
+  ExpectRoundTrip(enc, std::vector<uint8_t>(256 * 256 * 4, 0x5a), 256, 256);
+}
+
+TEST(PngEncoder, StoredRoundTrips) {
+  PngEncoder enc(PngEncoder::Deflate::kStored);
+  ExpectRoundTrip(enc, IconBgra(32), 32, 32);
+  // Larger than one stored block (64 KiB).
+  ExpectRoundTrip(enc, NoiseBgra(200, 100, 1), 200, 100);
+}
+
+TEST(PngEncoder, HonoursStride) {
+  const int w = 5, h = 4;
+  const size_t stride = 32;
+  auto tight = NoiseBgra(w, h, 3);
+  std::vector<uint8_t> padded(stride * h, 0xEE);
+  for (int y = 0; y < h; y++) memcpy(&padded[y * stride], &tight[(size_t)y * w * 4], (size_t)w * 4);
+
+  PngEncoder enc;
+  ASSERT_TRUE(enc.EncodeBgra(padded.data(), w, h, stride));
+  int dw = 0, dh = 0;
+  std::vector<uint8_t> decoded;
+  ASSERT_TRUE(ReferenceDecodePng(enc.png().data(), enc.png().size(), &dw, &dh, decoded));
+  EXPECT_EQ(decoded, ToRgba(tight));
+}
+
+TEST(PngEncoder, CompressesIcons) {
+  auto icon = IconBgra(32);
+  PngEncoder fixed, stored(PngEncoder::Deflate::kStored);
+  ASSERT_TRUE(fixed.EncodeBgra(icon.data(), 32, 32, 32 * 4));
+  ASSERT_TRUE(stored.EncodeBgra(icon.data(), 32, 32, 32 * 4));
+  EXPECT_LT(fixed.png().size(), stored.png().size() / 2);
+}
+
+TEST(PngEncoder, RejectsBadInput) {
+  PngEncoder enc;
+  uint8_t px[4] = {};
+  EXPECT_FALSE(enc.EncodeBgra(px, 0, 1, 4));
+  EXPECT_FALSE(enc.EncodeBgra(px, 1, 1, 3));
+  EXPECT_FALSE(enc.EncodeBgra(nullptr, 1, 1, 4));
+  EXPECT_TRUE(enc.png().empty());
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
@@ -0,0 +1,150 @@
+#include "png_reference.h"
+
+#include <zlib.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+const uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+void PutBE32(std::vector<uint8_t>& out, uint32_t v) {
+  out.push_back((uint8_t)(v >> 24));
+  out.push_back((uint8_t)(v >> 16));
+  out.push_back((uint8_t)(v >> 8));
+  out.push_back((uint8_t)v);
+}
+
+uint32_t GetBE32(const uint8_t* p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+void PutChunk(std::vector<uint8_t>& out, const char type[4], const uint8_t* data, size_t n) {
+  PutBE32(out, (uint32_t)n);
+  const size_t start = out.size();
+  out.insert(out.end(), type, type + 4);
+  if (n) out.insert(out.end(), data, data + n);
+  PutBE32(out, (uint32_t)crc32(0, out.data() + start, (uInt)(n + 4)));
+}
+
+uint8_t Paeth(int a, int b, int c) {
+  int p = a + b - c;
+  int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+  if (pa <= pb && pa <= pc) return (uint8_t)a;
+  if (pb <= pc) return (uint8_t)b;
+  return (uint8_t)c;
+}
+
+}  // namespace
+
+bool ReferenceEncodePng(const uint8_t* rgba, int width, int height, int zlib_level,
+                        std::vector<uint8_t>& out) {
+  const size_t stride = (size_t)width * 4;
+  std::vector<uint8_t> raw((stride + 1) * (size_t)height);
+  for (int y = 0; y < height; y++) {
+    raw[y * (stride + 1)] = 0;  // filter: none
+    memcpy(&raw[y * (stride + 1) + 1], rgba + y * stride, stride);
+  }
+
+  uLongf zsize = compressBound((uLong)raw.size());
+  std::vector<uint8_t> z(zsize);
+  if (compress2(z.data(), &zsize, raw.data(), (uLong)raw.size(), zlib_level) != Z_OK) return false;
+
+  out.assign(kSignature, kSignature + 8);
+  uint8_t ihdr[13];
+  ihdr[0] = (uint8_t)(width >> 24);
+  ihdr[1] = (uint8_t)(width >> 16);
+  ihdr[2] = (uint8_t)(width >> 8);
+  ihdr[3] = (uint8_t)width;
+  ihdr[4] = (uint8_t)(height >> 24);
+  ihdr[5] = (uint8_t)(height >> 16);
+  ihdr[6] = (uint8_t)(height >> 8);
+  ihdr[7] = (uint8_t)height;
+  ihdr[8] = 8;   // bit depth
+  ihdr[9] = 6;   // RGBA
+  ihdr[10] = 0;  // deflate
+  ihdr[11] = 0;  // adaptive filtering
+  ihdr[12] = 0;  // no interlace
+  PutChunk(out, "IHDR", ihdr, sizeof(ihdr));
+  PutChunk(out, "IDAT", z.data(), zsize);
+  PutChunk(out, "IEND", nullptr, 0);
+  return true;
+}
+
+bool ReferenceDecodePng(const uint8_t* data, size_t size, int* width, int* height,
+                        std::vector<uint8_t>& rgba) {
+  if (size < 8 || memcmp(data, kSignature, 8) != 0) return false;
+
+  size_t pos = 8;
+  int w = 0, h = 0;
+  bool seen_ihdr = false, seen_iend = false;
+  std::vector<uint8_t> idat;
+
+  while (pos + 12 <= size) {
+    const uint32_t len = GetBE32(data + pos);
+    if (len > size - pos - 12) return false;
+    const uint8_t* type = data + pos + 4;
+    const uint8_t* body = data + pos + 8;
+    const uint32_t crc = GetBE32(body + len);
+    if (crc != (uint32_t)crc32(0, type, (uInt)(len + 4))) return false;
+
+    if (memcmp(type, "IHDR", 4) == 0) {
+      if (len != 13) return false;
+      w = (int)GetBE32(body);
+      h = (int)GetBE32(body + 4);
+      if (body[8] != 8 || body[9] != 6 || body[10] != 0 || body[11] != 0 || body[12] != 0) {
+        return false;
+      }
+      seen_ihdr = true;
+    } else if (memcmp(type, "IDAT", 4) == 0) {
+      idat.insert(idat.end(), body, body + len);
+    } else if (memcmp(type, "IEND", 4) == 0) {
+      seen_iend = true;
+      break;
+    }
+    pos += 12 + len;
+  }
+  if (!seen_ihdr || !seen_iend || w <= 0 || h <= 0) return false;
+
+  const size_t stride = (size_t)w * 4;
+  std::vector<uint8_t> raw((stride + 1) * (size_t)h);
+  uLongf raw_size = (uLongf)raw.size();
+  if (uncompress(raw.data(), &raw_size, idat.data(), (uLong)idat.size()) != Z_OK ||
+      raw_size != raw.size()) {
+    return false;
+  }
+
+  rgba.assign(stride * (size_t)h, 0);
+  for (int y = 0; y < h; y++) {
+    const uint8_t filter = raw[y * (stride + 1)];
+    const uint8_t* in = &raw[y * (stride + 1) + 1];
+    uint8_t* row = &rgba[y * stride];
+    const uint8_t* up = y > 0 ? row - stride : nullptr;
+    for (size_t x = 0; x < stride; x++) {
+      const int a = x >= 4 ? row[x - 4] : 0;
+      const int b = up ? up[x] : 0;
+      const int c = (up && x >= 4) ? up[x - 4] : 0;
+      int v = in[x];
+      switch (filter) {
+        case 0: break;
+        case 1: v += a; break;
+        case 2: v += b; break;
+        case 3: v += (a + b) / 2; break;
+        case 4: v += Paeth(a, b, c); break;
+        default: return false;
+      }
+      row[x] = (uint8_t)v;
+    }
+  }
+
+  *width = w;
+  *height = h;
+  return true;
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace volumedeck_mixer {
+namespace test {
+
+// Straightforward zlib-backed PNG codec (8-bit RGBA only). It stands in for
+// a general-purpose encoder in benchmarks and is the reference decoder for
+// round-trip tests. Not used by the product.
+
+bool ReferenceEncodePng(const uint8_t* rgba, int width, int height, int zlib_level,
+                        std::vector<uint8_t>& out);
+
+// Decodes colour type 6, bit depth 8, non-interlaced. Handles all five row
+// filters and split IDAT chunks; verifies chunk CRCs.
+bool ReferenceDecodePng(const uint8_t* data, size_t size, int* width, int* height,
+                        std::vector<uint8_t>& rgba);
+
+}  // namespace test
+}  // namespace volumedeck_mixer
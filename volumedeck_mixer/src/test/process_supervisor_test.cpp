@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "process_supervisor.h"
+#include "test_util.h"
+
+#ifdef __linux__
+#include <signal.h>
+#endif
+
+namespace volumedeck_mixer {
+namespace test {
+
+#ifdef __linux__
+namespace {
+
+template <typename F>
+bool WaitFor(F&& done, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!done()) {
+    if (std::chrono::steady_clock::now() > deadline) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  return true;
+}
+
+// A stand-in for deej.exe: a shell running `script`.
+SupervisorOptions Dummy(const std::string& script) {
+  SupervisorOptions o;
+  o.program = "/bin/sh";
+  o.args = {"-c", script};
+  o.min_backoff = std::chrono::milliseconds(20);
+  o.max_backoff = std::chrono::milliseconds(80);
+  return o;
+}
+
+bool Alive(uint32_t pid) { return kill((pid_t)pid, 0) == 0; }
+
+std::vector<std::string> Lines(const std::string& path) {
+  std::ifstream in(path);
+  std::vector<std::string> out;
+  for (std::string line; std::getline(in, line);) out.push_back(line);
+  return out;
+}
+
+}  // namespace
+
+TEST(ProcessSupervisor, StartsAndStopsItsChild) {
+  ProcessSupervisor sup(Dummy("exec sleep 30"));
+  std::string error;
+  ASSERT_TRUE(sup.Start(&error)) << error;
+  SupervisorStats st = sup.stats();
+  ASSERT_TRUE(st.running);
+  const uint32_t pid = st.pid;
+  EXPECT_TRUE(Alive(pid));
+  EXPECT_GT(st.last_startup_us, 0u);
+  EXPECT_LT(st.last_startup_us, 1000000u);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_GE(sup.stats().uptime_ms, 40u);
+
+  const auto t0 = std::chrono::steady_clock::now();
+  sup.Stop();
+  EXPECT_LT(std::chrono::steady_clock::now() - t0, std::chrono::milliseconds(500));
+  st = sup.stats();
+  EXPECT_FALSE(st.running);
+  EXPECT_FALSE(Alive(pid));  // and reaped
+  EXPECT_EQ(st.last_exit_code, -SIGTERM);
+  EXPECT_EQ(st.crashes, 0u);
+  EXPECT_EQ(st.starts, 1u);
+}
+
+TEST(ProcessSupervisor, RestartsCrashesWithBackoff) {
+  ProcessSupervisor sup(Dummy("exit 3"));
+  std::vector<SupervisorStats> seen;
+  std::mutex mu;
+  sup.SetObserver([&](const SupervisorStats& s) {
+    std::lock_guard<std::mutex> lock(mu);
+    seen.push_back(s);
+  });
+  const auto t0 = std::chrono::steady_clock::now();
+  ASSERT_TRUE(sup.Start());
+  ASSERT_TRUE(WaitFor([&] { return sup.stats().starts >= 5; }));
+  const auto elapsed = std::chrono::steady_clock::now() - t0;
+  sup.Stop();
+
+  const SupervisorStats st = sup.stats();
+  EXPECT_GE(st.crashes, 4u);
+  EXPECT_EQ(st.backoff_ms, 80u);  // 40, 80, then capped
+  // Four waits of at least 40 + 80 + 80 + 80 ms.
+  EXPECT_GE(elapsed, std::chrono::milliseconds(280));
+  // Start, exit, start, exit, ...; the last exit may be Stop()'s.
+  std::lock_guard<std::mutex> lock(mu);
+  ASSERT_GE(seen.size(), 9u);
+  for (size_t i = 0; i < 9; i++) {
+    EXPECT_EQ(seen[i].running, i % 2 == 0) << i;
+    if (i % 2) {
+      EXPECT_EQ(seen[i].last_exit_code, 3) << i;
+    }
+  }
+}
+
+TEST(ProcessSupervisor, RestartWaitsForTheExitNotAFixedDelay) {
+  TempDir dir;
+  const std::string log = dir.File("starts");
+  ProcessSupervisor sup(Dummy("echo $$ >> '" + log + "'; exec sleep 30"));
+  ASSERT_TRUE(sup.Start());
+  const uint32_t first = sup.stats().pid;
+  ASSERT_TRUE(WaitFor([&] { return Lines(log).size() == 1; }));
+
+  sup.Restart();
+  ASSERT_TRUE(WaitFor([&] { return sup.stats().starts == 2; }));
+  const SupervisorStats st = sup.stats();
+  EXPECT_FALSE(Alive(first));
+  EXPECT_NE(st.pid, first);
+  EXPECT_EQ(st.crashes, 0u);
+  EXPECT_GT(st.last_restart_us, 0u);
+  EXPECT_LT(st.last_restart_us, 250000u);  // what the old kill + sleep + start cost at least
+  ASSERT_TRUE(WaitFor([&] { return Lines(log).size() == 2; }));
+  sup.Stop();
+  EXPECT_EQ(Lines(log), (std::vector<std::string>{std::to_string(first), std::to_string(st.pid)}));
+}
+
+TEST(ProcessSupervisor, LeavesOtherInstancesAlone) {
+  ProcessSupervisor mine(Dummy("exec sleep 30"));
+  ProcessSupervisor other(Dummy("exec sleep 30"));
+  ASSERT_TRUE(mine.Start());
+  ASSERT_TRUE(other.Start());
+  const uint32_t theirs = other.stats().pid;
+  mine.Restart();
+  mine.Stop();
+  EXPECT_TRUE(Alive(theirs));
+  EXPECT_EQ(other.stats().starts, 1u);
+  other.Stop();
+}
+
+TEST(ProcessSupervisor, KillsAChildThatIgnoresTheRequest) {
+  SupervisorOptions o = Dummy("trap '' TERM; while :; do sleep 0.05; done");
+  o.kill_timeout = std::chrono::milliseconds(200);
+  ProcessSupervisor sup(o);
+  ASSERT_TRUE(sup.Start());
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));  // let the trap install
+  const auto t0 = std::chrono::steady_clock::now();
+  sup.Stop();
+  const auto took = std::chrono::steady_clock::now() - t0;
+  EXPECT_GE(took, std::chrono::milliseconds(200));
+  EXPECT_LT(took, std::chrono::seconds(2));
+  EXPECT_EQ(sup.stats().last_exit_code, -SIGKILL);
+}
+
+TEST(ProcessSupervisor, ReportsAProgramThatWontRun) {
+  SupervisorOptions o;
+  o.program = "/nonexistent/deej";
+  ProcessSupervisor sup(o);
+  std::string error;
+  EXPECT_FALSE(sup.Start(&error));
+  EXPECT_NE(error.find("No such file"), std::string::npos) << error;
+  EXPECT_EQ(sup.stats().spawn_failures, 1u);
+  EXPECT_FALSE(sup.stats().running);
+
+  o.program = "/bin/sh";
+  o.working_dir = "/nonexistent";
+  ProcessSupervisor elsewhere(o);
+  EXPECT_FALSE(elsewhere.Start(&error));
+}
+#endif
+
+}  // namespace test
+}  // namespace volumedeck_mixer
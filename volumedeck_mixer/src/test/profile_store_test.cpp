@@ -0,0 +1,241 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pty.h>
+#include <unistd.h>
+#endif
+
+#include "deck_engine.h"
+#include "fake_mixer_backend.h"
+#include "profile_store.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+constexpr int kSliders = 6;
+
+class NullInput : public SliderInput {
+ public:
+  bool Open() override { return false; }
+  void Close() override {}
+  long Read(char*, size_t, int) override { return -1; }
+  long Write(const char*, size_t) override { return -1; }
+  std::string description() const override { return "null"; }
+};
+
+template <typename F>
+bool WaitFor(F&& done, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!done()) {
+    if (std::chrono::steady_clock::now() > deadline) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  return true;
+}
+
+// Sessions a0.exe..a5.exe and b0.exe..b5.exe; every session write is
+// logged with the line being fed at the time.
+class RecordingBackend : public FakeMixerBackend {
+ public:
+  struct Write {
+    int line;
+    std::string exe;
+    float volume;
+  };
+
+  RecordingBackend() {
+    for (int i = 0; i < kSliders; i++) {
+      for (const char* p : {"a", "b"}) {
+        const std::string exe = p + std::to_string(i) + ".exe";
+        const std::string id = AddSession(exe, (uint32_t)(100 + exe_.size()));
+        exe_[id] = exe;
+        id_[exe] = id;
+      }
+    }
+  }
+
+  bool SetSessionVolume(const std::string& id, float volume) override {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      log_.push_back({line.load(), exe_[id], volume});
+    }
+    return FakeMixerBackend::SetSessionVolume(id, volume);
+  }
+
+  std::string Id(const std::string& exe) { return id_[exe]; }
+
+  std::vector<Write> log() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return log_;
+  }
+
+  std::atomic<int> line{-1};
+
+ private:
+  std::map<std::string, std::string> exe_;
+  std::map<std::string, std::string> id_;
+  std::mutex mu_;
+  std::vector<Write> log_;
+};
+
+// Profile `p` maps slider i to p<i>.exe.
+DeejConfig Profile(const char* p) {
+  DeejConfig cfg;
+  cfg.slider_mapping.clear();
+  for (int i = 0; i < kSliders; i++) cfg.slider_mapping[i] = {p + std::to_string(i) + ".exe"};
+  return cfg;
+}
+
+// Every slider at the same end, alternating per line, so each line moves
+// all of them.
+std::string Line(int n) {
+  std::string line;
+  for (int i = 0; i < kSliders; i++) line += (i ? "|" : "") + std::string(n % 2 ? "1023" : "0");
+  return line + "\n";
+}
+
+}  // namespace
+
+TEST(ProfileStore, SelectsAndCycles) {
+  ProfileStore store;
+  EXPECT_EQ(store.Load()->active_profile(), nullptr);
+  EXPECT_EQ(store.SelectNext(), "");
+
+  store.Put("Streaming", Profile("a"));
+  store.Put("Gaming", Profile("b"));
+  auto set = store.Load();
+  ASSERT_EQ(set->profiles.size(), 2u);
+  EXPECT_EQ(set->active_profile()->name, "Streaming");
+  EXPECT_EQ(set->active_profile()->plan->slider_count(), (size_t)kSliders);
+  EXPECT_EQ(set->version, store.version());
+
+  const uint64_t v = store.version();
+  EXPECT_TRUE(store.Select("Streaming"));  // already active: no publish
+  EXPECT_EQ(store.version(), v);
+  EXPECT_FALSE(store.Select("Editing"));
+  EXPECT_TRUE(store.Select("Gaming"));
+  EXPECT_EQ(store.Load()->active_profile()->name, "Gaming");
+  EXPECT_EQ(store.SelectNext(), "Streaming");
+  EXPECT_EQ(store.SelectNext(), "Gaming");
+
+  EXPECT_FALSE(store.Remove("Gaming"));
+  EXPECT_TRUE(store.Remove("Streaming"));
+  EXPECT_EQ(store.Load()->active_profile()->name, "Gaming");
+  // Readers keep the state they loaded.
+  EXPECT_EQ(set->profiles.size(), 2u);
+}
+
+TEST(ProfileStore, EngineFollowsTheActiveProfile) {
+  RecordingBackend backend;
+  ProfileStore store;
+  store.Put("a", Profile("a"));
+  store.Put("b", Profile("b"));
+  DeckEngine engine(&backend, std::make_unique<NullInput>(), DeejConfig());
+  engine.SetProfileStore(&store);
+
+  engine.ProcessBytes(Line(1).data(), Line(1).size());
+  EXPECT_FLOAT_EQ(backend.master_volume(), 1.0f);  // the engine's own config never ran
+  EXPECT_FLOAT_EQ(backend.session_volume(backend.Id("a3.exe")), 1.0f);
+
+  // Switching re-applies the current positions to the new targets.
+  store.Select("b");
+  engine.ProcessBytes(nullptr, 0);
+  for (int i = 0; i < kSliders; i++) {
+    EXPECT_FLOAT_EQ(backend.session_volume(backend.Id("b" + std::to_string(i) + ".exe")), 1.0f);
+  }
+  EXPECT_EQ(engine.stats().profile_switches, 2u);  // the first one plus this
+}
+
+// A switcher thread flips profiles as fast as it can while lines stream in:
+// each line must reach every slider, all through one profile.
+TEST(ProfileStore, SwitchesMidStreamWithoutDroppedOrTornLines) {
+  RecordingBackend backend;
+  ProfileStore store;
+  store.Put("a", Profile("a"));
+  store.Put("b", Profile("b"));
+  DeckEngine engine(&backend, std::make_unique<NullInput>(), DeejConfig());
+  engine.SetProfileStore(&store);
+
+  std::atomic<bool> done{false};
+  std::thread switcher([&] {
+    while (!done.load()) {
+      store.SelectNext();
+      std::this_thread::yield();
+    }
+  });
+  constexpr int kLines = 3000;
+  for (int n = 0; n < kLines; n++) {
+    backend.line.store(n);
+    const std::string line = Line(n);
+    engine.ProcessBytes(line.data(), line.size());
+    std::this_thread::yield();  // let the switcher in on a single core
+  }
+  done.store(true);
+  switcher.join();
+
+  EXPECT_EQ(engine.stats().lines, (uint64_t)kLines);
+  EXPECT_GT(engine.stats().profile_switches, 10u);
+  std::vector<std::set<std::string>> moved(kLines);
+  std::vector<std::set<char>> profiles(kLines);
+  for (const auto& w : backend.log()) {
+    ASSERT_GE(w.line, 0);
+    // Other values are re-applies of the previous line after a switch.
+    if (w.volume != (w.line % 2 ? 1.0f : 0.0f)) continue;
+    moved[w.line].insert(w.exe);
+    profiles[w.line].insert(w.exe[0]);
+  }
+  for (int n = 0; n < kLines; n++) {
+    ASSERT_EQ(profiles[n].size(), 1u) << "line " << n << " torn";
+    ASSERT_EQ(moved[n].size(), (size_t)kSliders) << "line " << n << " dropped";
+  }
+}
+
+#ifdef __linux__
+TEST(ProfileStore, SwitchesARunningEngine) {
+  int master = -1, slave = -1;
+  char name[128] = {};
+  ASSERT_EQ(openpty(&master, &slave, name, nullptr, nullptr), 0);
+  close(slave);
+
+  RecordingBackend backend;
+  ProfileStore store;
+  store.Put("a", Profile("a"));
+  store.Put("b", Profile("b"));
+  DeckEngine engine(&backend, std::make_unique<SerialPort>(name, 115200), DeejConfig());
+  engine.SetProfileStore(&store);
+  ASSERT_TRUE(engine.Start());
+  ASSERT_TRUE(WaitFor([&] { return engine.stats().connected; }));
+
+  constexpr int kLines = 400;
+  for (int n = 0; n < kLines; n++) {
+    if (n % 50 == 25 && n < 350) store.SelectNext();  // seven times, ending on "b"
+    const std::string line = Line(n);
+    ASSERT_EQ(write(master, line.data(), line.size()), (ssize_t)line.size());
+    if (n % 10 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_TRUE(WaitFor([&] { return engine.stats().lines == (uint64_t)kLines; }));
+  engine.Stop();
+  close(master);
+
+  EXPECT_GE(engine.stats().profile_switches, 2u);
+  // The last line (odd: all at 1023) went out through profile "b" only.
+  for (int i = 0; i < kSliders; i++) {
+    EXPECT_FLOAT_EQ(backend.session_volume(backend.Id("b" + std::to_string(i) + ".exe")), 1.0f);
+  }
+}
+#endif
+
+}  // namespace test
+}  // namespace volumedeck_mixer
@@ -0,0 +1,385 @@
+// Runs against whatever server libpulse finds (PULSE_SERVER, then the user
+// session). With pulseaudio installed, ctest's pulse_mixer_backend starts a
+// private one and runs these against it; by hand, e.g.
+//
+//   pipewire & pipewire-pulse &
+//   pulseaudio -n --load=module-native-protocol-unix --exit-idle-time=-1 -D
+//
+// Each test loads its own null sink and plays synthetic tones into it, so
+// nothing is audible and the user's devices are left alone. Without a
+// server the tests skip, unless VOLUMEDECK_REQUIRE_PULSE is set.
+
+#ifdef VOLUMEDECK_HAVE_PULSE
+
+#include <gtest/gtest.h>
+
+#include <pulse/pulseaudio.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pulse_mixer_backend.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+constexpr char kSinkName[] = "volumedeck_test_sink";
+constexpr char kSinkDescription[] = "VolumeDeckTestSink";
+
+template <typename F>
+bool WaitFor(F&& done, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!done()) {
+    if (std::chrono::steady_clock::now() > deadline) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  return true;
+}
+
+// Second, independent client: sets up the null sink, plays tones and reads
+// back what the server really applied.
+class ServerFixture {
+ public:
+  ~ServerFixture() { Close(); }
+
+  bool Open() {
+    loop_ = pa_threaded_mainloop_new();
+    ctx_ = pa_context_new(pa_threaded_mainloop_get_api(loop_), "volumedeck-test");
+    pa_context_set_state_callback(ctx_, &OnSignal, loop_);
+    if (pa_threaded_mainloop_start(loop_) < 0) return false;
+
+    pa_threaded_mainloop_lock(loop_);
+    bool ok = pa_context_connect(ctx_, nullptr, PA_CONTEXT_NOAUTOSPAWN, nullptr) >= 0;
+    pa_context_state_t st = PA_CONTEXT_UNCONNECTED;
+    while (ok && (st = pa_context_get_state(ctx_)) != PA_CONTEXT_READY && PA_CONTEXT_IS_GOOD(st)) {
+      pa_threaded_mainloop_wait(loop_);
+    }
+    ok = ok && st == PA_CONTEXT_READY;
+    if (ok) {
+      const std::string args = std::string("sink_name=") + kSinkName +
+                               " sink_properties=device.description=" + kSinkDescription;
+      Wait(pa_context_load_module(ctx_, "module-null-sink", args.c_str(), &OnIndex, this));
+      ok = module_ != PA_INVALID_INDEX;
+    }
+    pa_threaded_mainloop_unlock(loop_);
+    return ok;
+  }
+
+  void Close() {
+    if (!loop_) return;
+    pa_threaded_mainloop_lock(loop_);
+    for (auto& t : tones_) StopToneLocked(t.get());
+    tones_.clear();
+    if (module_ != PA_INVALID_INDEX) Wait(pa_context_unload_module(ctx_, module_, &OnSuccess, this));
+    pa_context_disconnect(ctx_);
+    pa_context_unref(ctx_);
+    pa_threaded_mainloop_unlock(loop_);
+    pa_threaded_mainloop_stop(loop_);
+    pa_threaded_mainloop_free(loop_);
+    loop_ = nullptr;
+  }
+
+  // Starts a 440 Hz tone at `amplitude` from a client claiming to be
+  // `binary`. Returns the sink input index, or PA_INVALID_INDEX.
+  uint32_t PlayTone(const std::string& binary, float amplitude) {
+    auto tone = std::make_unique<Tone>();
+    tone->amplitude = amplitude;
+
+    pa_threaded_mainloop_lock(loop_);
+    pa_proplist* props = pa_proplist_new();
+    pa_proplist_sets(props, PA_PROP_APPLICATION_PROCESS_BINARY, binary.c_str());
+    pa_proplist_sets(props, PA_PROP_APPLICATION_NAME, binary.c_str());
+    pa_sample_spec ss;
+    ss.format = PA_SAMPLE_FLOAT32NE;
+    ss.rate = 48000;
+    ss.channels = 2;
+    tone->stream = pa_stream_new_with_proplist(ctx_, "tone", &ss, nullptr, props);
+    pa_proplist_free(props);
+    uint32_t index = PA_INVALID_INDEX;
+    if (tone->stream) {
+      pa_stream_set_state_callback(tone->stream, &OnStreamState, loop_);
+      pa_stream_set_write_callback(tone->stream, &OnWrite, tone.get());
+      if (pa_stream_connect_playback(tone->stream, kSinkName, nullptr, PA_STREAM_NOFLAGS, nullptr, nullptr) >= 0) {
+        pa_stream_state_t st;
+        while ((st = pa_stream_get_state(tone->stream)) != PA_STREAM_READY && PA_STREAM_IS_GOOD(st)) {
+          pa_threaded_mainloop_wait(loop_);
+        }
+        if (st == PA_STREAM_READY) index = pa_stream_get_index(tone->stream);
+      }
+    }
+    if (index != PA_INVALID_INDEX) {
+      tone->index = index;
+      tones_.push_back(std::move(tone));
+    } else if (tone->stream) {
+      StopToneLocked(tone.get());
+    }
+    pa_threaded_mainloop_unlock(loop_);
+    return index;
+  }
+
+  void StopTone(uint32_t index) {
+    pa_threaded_mainloop_lock(loop_);
+    for (auto it = tones_.begin(); it != tones_.end(); ++it) {
+      if ((*it)->index != index) continue;
+      StopToneLocked(it->get());
+      tones_.erase(it);
+      break;
+    }
+    pa_threaded_mainloop_unlock(loop_);
+  }
+
+  // What the server has, not what a client cached.
+  bool SinkInput(uint32_t index, float* volume, bool* mute) {
+    Reply r;
+    r.loop = loop_;
+    pa_threaded_mainloop_lock(loop_);
+    Wait(pa_context_get_sink_input_info(ctx_, index, &OnSinkInput, &r), &r.done);
+    pa_threaded_mainloop_unlock(loop_);
+    *volume = r.volume;
+    *mute = r.mute;
+    return r.found;
+  }
+
+  // As another mixer app would.
+  void SetSinkInputVolume(uint32_t index, float volume) {
+    pa_cvolume cv;
+    pa_cvolume_set(&cv, 2, (pa_volume_t)std::lround(volume * PA_VOLUME_NORM));
+    pa_threaded_mainloop_lock(loop_);
+    Wait(pa_context_set_sink_input_volume(ctx_, index, &cv, &OnSuccess, this));
+    pa_threaded_mainloop_unlock(loop_);
+  }
+
+  bool Sink(float* volume) {
+    Reply r;
+    r.loop = loop_;
+    pa_threaded_mainloop_lock(loop_);
+    Wait(pa_context_get_sink_info_by_name(ctx_, kSinkName, &OnSink, &r), &r.done);
+    pa_threaded_mainloop_unlock(loop_);
+    *volume = r.volume;
+    return r.found;
+  }
+
+ private:
+  struct Tone {
+    pa_stream* stream = nullptr;
+    uint32_t index = PA_INVALID_INDEX;
+    float amplitude = 0.5f;
+    double phase = 0.0;
+    std::vector<float> buf;
+  };
+  struct Reply {
+    pa_threaded_mainloop* loop = nullptr;
+    bool done = false;
+    bool found = false;
+    float volume = -1.0f;
+    bool mute = false;
+  };
+
+  static void OnSignal(pa_context*, void* loop) {
+    pa_threaded_mainloop_signal(static_cast<pa_threaded_mainloop*>(loop), 0);
+  }
+  static void OnStreamState(pa_stream*, void* loop) {
+    pa_threaded_mainloop_signal(static_cast<pa_threaded_mainloop*>(loop), 0);
+  }
+  static void OnIndex(pa_context*, uint32_t index, void* ud) {
+    auto* self = static_cast<ServerFixture*>(ud);
+    self->module_ = index;
+    self->done_ = true;
+    pa_threaded_mainloop_signal(self->loop_, 0);
+  }
+  static void OnSuccess(pa_context*, int, void* ud) {
+    auto* self = static_cast<ServerFixture*>(ud);
+    self->done_ = true;
+    pa_threaded_mainloop_signal(self->loop_, 0);
+  }
+  static void OnSinkInput(pa_context*, const pa_sink_input_info* i, int eol, void* ud) {
+    auto* r = static_cast<Reply*>(ud);
+    if (i && !eol) {
+      r->found = true;
+      r->volume = (float)pa_cvolume_max(&i->volume) / (float)PA_VOLUME_NORM;
+      r->mute = i->mute != 0;
+      return;
+    }
+    r->done = true;
+    pa_threaded_mainloop_signal(r->loop, 0);
+  }
+  static void OnSink(pa_context*, const pa_sink_info* i, int eol, void* ud) {
+    auto* r = static_cast<Reply*>(ud);
+    if (i && !eol) {
+      r->found = true;
+      r->volume = (float)pa_cvolume_max(&i->volume) / (float)PA_VOLUME_NORM;
+      return;
+    }
+    r->done = true;
+    pa_threaded_mainloop_signal(r->loop, 0);
+  }
+  static void OnWrite(pa_stream* s, size_t bytes, void* ud) {
+    auto* t = static_cast<Tone*>(ud);
+    const size_t frames = bytes / (2 * sizeof(float));
+    t->buf.resize(frames * 2);
+    for (size_t f = 0; f < frames; f++) {
+      const float v = t->amplitude * (float)std::sin(t->phase);
+      t->phase += 2.0 * 3.14159265358979 * 440.0 / 48000.0;
+      t->buf[f * 2] = v;
+      t->buf[f * 2 + 1] = v;
+    }
+    pa_stream_write(s, t->buf.data(), frames * 2 * sizeof(float), nullptr, 0, PA_SEEK_RELATIVE);
+  }
+
+  // Lock held. Sends `op` and waits for its callback.
+  void Wait(pa_operation* op, bool* done = nullptr) {
+    if (!op) return;
+    if (!done) {
+      done_ = false;
+      done = &done_;
+    }
+    while (!*done && PA_CONTEXT_IS_GOOD(pa_context_get_state(ctx_))) pa_threaded_mainloop_wait(loop_);
+    pa_operation_unref(op);
+  }
+
+  void StopToneLocked(Tone* t) {
+    pa_stream_set_write_callback(t->stream, nullptr, nullptr);
+    pa_stream_set_state_callback(t->stream, nullptr, nullptr);
+    pa_stream_disconnect(t->stream);
+    pa_stream_unref(t->stream);
+    t->stream = nullptr;
+  }
+
+  pa_threaded_mainloop* loop_ = nullptr;
+  pa_context* ctx_ = nullptr;
+  uint32_t module_ = PA_INVALID_INDEX;
+  bool done_ = false;
+  std::vector<std::unique_ptr<Tone>> tones_;
+};
+
+class PulseBackendTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!server_.Open()) {
+      if (std::getenv("VOLUMEDECK_REQUIRE_PULSE")) FAIL() << "no PulseAudio/PipeWire server";
+      GTEST_SKIP() << "no PulseAudio/PipeWire server";
+    }
+    ASSERT_TRUE(backend_.Start());
+  }
+  void TearDown() override {
+    backend_.Stop();
+    server_.Close();
+  }
+
+  bool Find(const std::string& exe, AudioSession* out) {
+    std::vector<AudioSession> sessions;
+    if (!backend_.ListSessions(&sessions)) return false;
+    for (const auto& s : sessions) {
+      if (s.exe_name == exe) {
+        *out = s;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  ServerFixture server_;
+  PulseMixerBackend backend_;
+};
+
+}  // namespace
+
+TEST_F(PulseBackendTest, TracksClientsFromEvents) {
+  const uint64_t g0 = backend_.session_generation();
+  const uint32_t a = server_.PlayTone("synthetic-a", 0.5f);
+  const uint32_t b = server_.PlayTone("synthetic-b", 0.5f);
+  ASSERT_NE(a, PA_INVALID_INDEX);
+  ASSERT_NE(b, PA_INVALID_INDEX);
+
+  AudioSession s;
+  ASSERT_TRUE(WaitFor([&] { return Find("synthetic-a", &s) && Find("synthetic-b", &s); }));
+  EXPECT_GT(backend_.session_generation(), g0);
+  EXPECT_EQ(s.id, PulseMixerBackend::SessionId(b));
+  EXPECT_EQ(s.display_name, "synthetic-b");
+
+  const uint64_t g1 = backend_.session_generation();
+  server_.StopTone(a);
+  EXPECT_TRUE(WaitFor([&] { return !Find("synthetic-a", &s); }));
+  EXPECT_GT(backend_.session_generation(), g1);
+  EXPECT_TRUE(Find("synthetic-b", &s));
+}
+
+TEST_F(PulseBackendTest, SetsSessionVolumeAndMute) {
+  const uint32_t index = server_.PlayTone("synthetic-a", 0.5f);
+  ASSERT_NE(index, PA_INVALID_INDEX);
+  AudioSession s;
+  ASSERT_TRUE(WaitFor([&] { return Find("synthetic-a", &s); }));
+
+  ASSERT_TRUE(backend_.SetSessionVolume(s.id, 0.25f));
+  ASSERT_TRUE(backend_.SetSessionMute(s.id, true));
+  float volume = -1.0f;
+  bool mute = false;
+  EXPECT_TRUE(WaitFor([&] {
+    return server_.SinkInput(index, &volume, &mute) && std::fabs(volume - 0.25f) < 0.001f && mute;
+  }));
+
+  // Changes made by someone else arrive as events.
+  server_.SetSinkInputVolume(index, 0.75f);
+  EXPECT_TRUE(WaitFor([&] { return Find("synthetic-a", &s) && std::fabs(s.volume - 0.75f) < 0.001f; }));
+  EXPECT_FALSE(backend_.SetSessionVolume("sink-input-4000000000", 0.5f));
+}
+
+TEST_F(PulseBackendTest, ConfirmedWritesLeaveExternalChangesAlone) {
+  const uint32_t index = server_.PlayTone("synthetic-a", 0.5f);
+  ASSERT_NE(index, PA_INVALID_INDEX);
+  AudioSession s;
+  ASSERT_TRUE(WaitFor([&] { return Find("synthetic-a", &s); }));
+  const std::string id = s.id;
+  std::mutex mu;
+  std::vector<float> seen;
+  backend_.SetChangeObserver([&](const MixerChange& c) {
+    std::lock_guard<std::mutex> lock(mu);
+    if (c.id == id) seen.push_back(c.volume);
+  });
+  const auto seen_count = [&] {
+    std::lock_guard<std::mutex> lock(mu);
+    return seen.size();
+  };
+
+  // Our write's event retires it: someone setting the same volume right
+  // after is theirs, not an echo.
+  ASSERT_TRUE(backend_.SetSessionVolume(id, 0.25f));
+  ASSERT_TRUE(WaitFor([&] { return Find("synthetic-a", &s) && std::fabs(s.volume - 0.25f) < 0.001f; }));
+  server_.SetSinkInputVolume(index, 0.75f);
+  server_.SetSinkInputVolume(index, 0.25f);
+  EXPECT_TRUE(WaitFor([&] { return seen_count() == 2; }));
+  backend_.SetChangeObserver(nullptr);
+  ASSERT_EQ(seen.size(), 2u);
+  EXPECT_NEAR(seen[0], 0.75f, 0.001f);
+  EXPECT_NEAR(seen[1], 0.25f, 0.001f);
+}
+
+TEST_F(PulseBackendTest, MetersSessionPeaks) {
+  ASSERT_NE(server_.PlayTone("loud", 0.8f), PA_INVALID_INDEX);
+  ASSERT_NE(server_.PlayTone("quiet", 0.0f), PA_INVALID_INDEX);
+
+  AudioSession loud, quiet;
+  EXPECT_TRUE(WaitFor([&] { return Find("loud", &loud) && loud.peak > 0.5f; }));
+  EXPECT_TRUE(Find("quiet", &quiet));
+  EXPECT_LT(quiet.peak, 0.01f);
+}
+
+TEST_F(PulseBackendTest, SetsDeviceVolumeByDescription) {
+  ASSERT_TRUE(backend_.SetDeviceVolume(kSinkDescription, 0.4f));
+  float volume = -1.0f;
+  EXPECT_TRUE(WaitFor([&] { return server_.Sink(&volume) && std::fabs(volume - 0.4f) < 0.001f; }));
+  EXPECT_FALSE(backend_.SetDeviceVolume("no such device", 0.4f));
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
+
+#endif  // VOLUMEDECK_HAVE_PULSE
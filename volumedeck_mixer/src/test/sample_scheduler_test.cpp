@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <vector>
+
+#include "sample_scheduler.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+using std::chrono::milliseconds;
+
+const SampleScheduler::Clock::time_point kT0 = SampleScheduler::Clock::time_point{} + std::chrono::hours(1);
+
+SampleScheduler::Clock::time_point At(int ms) { return kT0 + milliseconds(ms); }
+
+}  // namespace
+
+TEST(SampleScheduler, PausesUntilSomeoneSubscribes) {
+  SampleScheduler s;
+  EXPECT_EQ(s.Rate(At(0)), 0.0);
+  EXPECT_EQ(s.Due(At(0), At(0)), SampleScheduler::Clock::time_point::max());
+  EXPECT_EQ(s.Ticked(At(0), 0), SampleScheduler::Clock::time_point::max());
+
+  const int id = s.Subscribe({}, {}, At(0));
+  EXPECT_EQ(s.subscribers(At(0)), 1u);
+  // Nothing has happened yet: silence.
+  EXPECT_DOUBLE_EQ(s.Rate(At(0)), s.rates().low_hz);
+  EXPECT_EQ(s.Due(At(0), At(0)), At(250));
+  s.Unsubscribe(id);
+  EXPECT_EQ(s.Rate(At(0)), 0.0);
+}
+
+TEST(SampleScheduler, RunsHighWhileActiveThenDecays) {
+  SampleScheduler s;  // 250 Hz, 4 Hz, 1 s hold, 250 ms half-life
+  s.Subscribe({}, {}, At(0));
+  s.NoteActivity(At(0));
+  EXPECT_DOUBLE_EQ(s.Rate(At(0)), 250.0);
+  EXPECT_DOUBLE_EQ(s.Rate(At(1000)), 250.0);
+  EXPECT_DOUBLE_EQ(s.Rate(At(1250)), 125.0);
+  EXPECT_DOUBLE_EQ(s.Rate(At(1500)), 62.5);
+  EXPECT_DOUBLE_EQ(s.Rate(At(5000)), 4.0);
+  // A fader moves: straight back up.
+  s.NoteActivity(At(6000));
+  EXPECT_DOUBLE_EQ(s.Rate(At(6000)), 250.0);
+}
+
+TEST(SampleScheduler, KeepsToWhatSubscribersHint) {
+  SampleScheduler s;
+  s.NoteActivity(At(0));
+  const int poll = s.Subscribe({0.0, 20.0}, {}, At(0));
+  EXPECT_DOUBLE_EQ(s.Rate(At(0)), 20.0);
+  // The most demanding subscriber wins.
+  const int meters = s.Subscribe({}, {}, At(0));
+  EXPECT_DOUBLE_EQ(s.Rate(At(0)), 250.0);
+  s.Unsubscribe(meters);
+
+  // A floor holds through silence, but not past the ceiling.
+  ASSERT_TRUE(s.SetHint(poll, {10.0, 20.0}));
+  EXPECT_DOUBLE_EQ(s.Rate(At(10000)), 10.0);
+  ASSERT_TRUE(s.SetHint(poll, {60.0, 20.0}));
+  EXPECT_DOUBLE_EQ(s.Rate(At(10000)), 20.0);
+  // Nor past high_hz.
+  ASSERT_TRUE(s.SetHint(poll, {0.0, 1000.0}));
+  EXPECT_DOUBLE_EQ(s.Rate(At(0)), 250.0);
+  EXPECT_FALSE(s.SetHint(99, {}));
+}
+
+TEST(SampleScheduler, LeasesLapseAndWakeTheSamplerWhenRenewed) {
+  SampleScheduler s;
+  int wakes = 0;
+  s.SetWake([&] { wakes++; });
+  const int id = s.Subscribe({}, std::chrono::seconds(2), At(0));
+  EXPECT_EQ(wakes, 1);
+  EXPECT_GT(s.Rate(At(1999)), 0.0);
+  EXPECT_EQ(s.Rate(At(2000)), 0.0);
+  EXPECT_EQ(s.subscribers(At(2000)), 0u);
+
+  ASSERT_TRUE(s.Renew(id, At(3000)));
+  EXPECT_EQ(wakes, 2);
+  EXPECT_GT(s.Rate(At(3000)), 0.0);
+  // Renewed in time: nothing to wake for.
+  ASSERT_TRUE(s.Renew(id, At(4000)));
+  EXPECT_EQ(wakes, 2);
+  EXPECT_FALSE(s.Renew(99, At(4000)));
+}
+
+TEST(SampleScheduler, ActivityWakesOnlyASlowSampler) {
+  SampleScheduler s;
+  int wakes = 0;
+  s.Subscribe({}, {}, At(0));
+  s.SetWake([&] { wakes++; });
+  s.NoteActivity(At(0));
+  s.Ticked(At(0), 0);  // at 250 Hz
+  s.NoteActivity(At(4));
+  EXPECT_EQ(wakes, 0);
+  s.Ticked(At(3000), 0);  // decayed
+  s.NoteActivity(At(3100));
+  EXPECT_EQ(wakes, 1);
+}
+
+// Ten simulated seconds: two of a fader being dragged, then silence. The
+// sampler follows the rate it is given, and every tick is logged.
+TEST(SampleScheduler, SimulatedLoopIdlesAfterActivity) {
+  SampleScheduler s;
+  std::vector<SampleTick> log;
+  s.SetLogger([&](const SampleTick& t) { log.push_back(t); });
+  s.Subscribe({}, {}, At(0));
+
+  std::vector<int> per_second(10, 0);
+  auto now = At(0);
+  while (now < At(10000)) {
+    if (now < At(2000)) s.NoteActivity(now);
+    per_second[(now - kT0) / std::chrono::seconds(1)]++;
+    now = s.Ticked(now, 20000);
+  }
+
+  // Held for a second after the last move, then halving every 250 ms.
+  for (int i = 0; i < 3; i++) EXPECT_GE(per_second[i], 249) << i;
+  EXPECT_LT(per_second[3], 90);
+  for (int i = 5; i < 10; i++) EXPECT_LE(per_second[i], 5) << i;
+  ASSERT_EQ(log.size(), s.ticks());
+  EXPECT_DOUBLE_EQ(log.front().hz, 250.0);
+  EXPECT_DOUBLE_EQ(log.back().hz, 4.0);
+  EXPECT_EQ(log.back().cpu_ns, 20000u);
+  EXPECT_EQ(s.cpu_ns_per_tick(), 20000u);
+  EXPECT_DOUBLE_EQ(s.last_hz(), 4.0);
+}
+
+TEST(SampleScheduler, ThreadCpuTimeAdvancesWithWork) {
+  const uint64_t start = ThreadCpuTimeNs();
+  volatile uint64_t x = 0;
+  for (int i = 0; i < 20000000; i++) x = x + (uint64_t)i;
+  EXPECT_GT(ThreadCpuTimeNs(), start);
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "deck_engine.h"
+#include "latency_histogram.h"
+#include "sim_mixer_backend.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+class NullInput : public SliderInput {
+ public:
+  bool Open() override { return false; }
+  void Close() override {}
+  long Read(char*, size_t, int) override { return -1; }
+  long Write(const char*, size_t) override { return -1; }
+  std::string description() const override { return "null"; }
+};
+
+SimMixerConfig Offline(size_t sessions) {
+  SimMixerConfig c;
+  c.sessions = sessions;
+  c.realtime = false;
+  return c;
+}
+
+}  // namespace
+
+TEST(LatencyHistogram, ExactBelowAMicrosecond) {
+  LatencyHistogram h;
+  for (uint64_t v = 1; v <= 1000; v++) h.Record(v);
+  EXPECT_EQ(h.count(), 1000u);
+  EXPECT_EQ(h.min_ns(), 1u);
+  EXPECT_EQ(h.max_ns(), 1000u);
+  EXPECT_EQ(h.Percentile(50), 500u);
+  EXPECT_EQ(h.Percentile(99), 990u);
+  EXPECT_EQ(h.Percentile(100), 1000u);
+  EXPECT_DOUBLE_EQ(h.mean_ns(), 500.5);
+}
+
+TEST(LatencyHistogram, RelativeErrorStaysSmallAtScale) {
+  LatencyHistogram h;
+  for (uint64_t v = 1; v <= 100000; v++) h.Record(v * 1000);  // 1 us .. 100 ms
+  for (double p : {1.0, 50.0, 90.0, 99.0, 99.9}) {
+    const double want = p / 100.0 * 100000.0 * 1000.0;
+    const double got = (double)h.Percentile(p);
+    EXPECT_GE(got, want * 0.999) << p;
+    EXPECT_LE(got, want * 1.004) << p;
+  }
+  EXPECT_EQ(LatencyHistogram().Percentile(50), 0u);
+}
+
+TEST(LatencyHistogram, MergesAcrossThreads) {
+  LatencyHistogram total;
+  std::vector<std::unique_ptr<LatencyHistogram>> parts;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    parts.push_back(std::make_unique<LatencyHistogram>());
+    LatencyHistogram* h = parts.back().get();
+    threads.emplace_back([h, &total, t] {
+      for (uint64_t i = 0; i < 10000; i++) {
+        h->Record(2000 + (uint64_t)t);
+        total.Record(2000 + (uint64_t)t);
+      }
+    });
+  }
+  for (auto& th : threads) th.join();
+  LatencyHistogram merged;
+  for (auto& p : parts) merged.Merge(*p);
+  EXPECT_EQ(merged.count(), 40000u);
+  EXPECT_EQ(total.count(), 40000u);
+  EXPECT_EQ(merged.Percentile(50), total.Percentile(50));
+  EXPECT_EQ(merged.min_ns(), 2000u);
+}
+
+TEST(SimMixer, ParsesSpecs) {
+  SimMixerConfig c;
+  ASSERT_TRUE(ParseSimMixerSpec("sessions=500,churn=2.5,latency=200/2000,list_latency=900,fail=0.01,seed=7,realtime=0",
+                                &c));
+  EXPECT_EQ(c.sessions, 500u);
+  EXPECT_DOUBLE_EQ(c.churn_per_second, 2.5);
+  EXPECT_DOUBLE_EQ(c.call_latency.median_us, 200);
+  EXPECT_DOUBLE_EQ(c.call_latency.p99_us, 2000);
+  EXPECT_DOUBLE_EQ(c.list_latency.median_us, 900);
+  EXPECT_DOUBLE_EQ(c.list_latency.p99_us, 900);
+  EXPECT_DOUBLE_EQ(c.failure_rate, 0.01);
+  EXPECT_EQ(c.seed, 7u);
+  EXPECT_FALSE(c.realtime);
+
+  std::string error;
+  EXPECT_FALSE(ParseSimMixerSpec("sessions=lots", &c, &error));
+  EXPECT_NE(error.find("sessions=lots"), std::string::npos);
+  EXPECT_FALSE(ParseSimMixerSpec("fail=2", &c));
+  EXPECT_FALSE(ParseSimMixerSpec("speed=9", &c));
+
+  EXPECT_NE(CreateMixerBackend("sim"), nullptr);
+  EXPECT_NE(CreateMixerBackend("sim:sessions=3"), nullptr);
+  EXPECT_EQ(CreateMixerBackend("sim:sessions="), nullptr);
+}
+
+TEST(SimMixer, PopulatesRealisticSessions) {
+  SimMixerBackend sim(Offline(500));
+  std::vector<AudioSession> sessions;
+  ASSERT_TRUE(sim.ListSessions(&sessions));
+  ASSERT_EQ(sessions.size(), 501u);
+  EXPECT_TRUE(sessions[0].system);
+
+  std::set<std::string> ids;
+  std::map<std::string, int> per_exe;
+  for (const auto& s : sessions) {
+    ids.insert(s.id);
+    per_exe[s.exe_name]++;
+    if (s.system) continue;
+    EXPECT_EQ(s.exe_name.substr(s.exe_name.size() - 4), ".exe") << s.exe_name;
+    EXPECT_NE(s.pid, 0u);
+    EXPECT_GE(s.peak, 0.0f);
+    EXPECT_LE(s.peak, 1.0f);
+  }
+  EXPECT_EQ(ids.size(), sessions.size());
+  // Popular apps repeat, the long tail doesn't.
+  EXPECT_GT(per_exe["chrome.exe"], 30);
+  EXPECT_GT(per_exe["discord.exe"], 5);
+  EXPECT_GT(per_exe.size(), 60u);
+
+  // Same seed, same world.
+  SimMixerBackend again(Offline(500));
+  std::vector<AudioSession> other;
+  ASSERT_TRUE(again.ListSessions(&other));
+  for (size_t i = 0; i < sessions.size(); i++) EXPECT_EQ(sessions[i].exe_path, other[i].exe_path);
+}
+
+TEST(SimMixer, ChurnsAtTheConfiguredRate) {
+  SimMixerConfig c = Offline(200);
+  c.churn_per_second = 50.0;
+  SimMixerBackend sim(c);
+  const uint64_t g0 = sim.session_generation();
+  std::vector<AudioSession> before;
+  ASSERT_TRUE(sim.ListSessions(&before));
+
+  sim.Advance(20.0);  // ~1000 exits and as many starts
+  const SimMixerStats st = sim.stats();
+  EXPECT_GT(st.sessions_started, 850u);
+  EXPECT_LT(st.sessions_started, 1150u);
+  EXPECT_EQ(st.sessions_started, st.sessions_ended);
+  EXPECT_EQ(sim.session_count(), 201u);
+  EXPECT_GT(sim.session_generation(), g0 + 1700);
+
+  // Set on a session that has gone away fails like a dead COM object.
+  size_t gone = 0;
+  for (const auto& s : before) {
+    if (sim.session_volume(s.id) < 0.0f) gone++;
+  }
+  EXPECT_GT(gone, 150u);
+  sim.Churn(5);
+  EXPECT_EQ(sim.stats().sessions_started, st.sessions_started + 5);
+}
+
+TEST(SimMixer, InjectsFailures) {
+  SimMixerConfig c = Offline(10);
+  c.failure_rate = 0.25;
+  SimMixerBackend sim(c);
+  int failed = 0;
+  for (int i = 0; i < 4000; i++) failed += sim.SetMasterVolume(0.5f) ? 0 : 1;
+  EXPECT_GT(failed, 850);
+  EXPECT_LT(failed, 1150);
+  EXPECT_EQ(sim.stats().failures, (uint64_t)failed);
+  EXPECT_EQ(sim.stats().set_calls, 4000u);
+}
+
+TEST(SimMixer, LatencyFollowsTheDistribution) {
+  SimLatencyModel model({200.0, 2000.0});
+  std::mt19937_64 rng(3);
+  LatencyHistogram h;
+  for (int i = 0; i < 200000; i++) h.Record((uint64_t)(model.SampleUs(rng) * 1000.0));
+  EXPECT_NEAR((double)h.Percentile(50) / 1000.0, 200.0, 10.0);
+  EXPECT_NEAR((double)h.Percentile(99) / 1000.0, 2000.0, 150.0);
+
+  SimLatencyModel fixed({50.0, 0.0});
+  EXPECT_DOUBLE_EQ(fixed.SampleUs(rng), 50.0);
+}
+
+TEST(SimMixer, CallsTakeTheirLatency) {
+  SimMixerConfig c = Offline(5);
+  c.call_latency = {300.0, 0.0};
+  SimMixerBackend sim(c);
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < 20; i++) sim.SetMasterVolume(0.5f);
+  const auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0);
+  EXPECT_GE(us.count(), 20 * 300);
+  EXPECT_EQ(sim.stats().injected_ns, 20u * 300000u);
+}
+
+TEST(SimMixer, DrivesTheEngineThroughChurn) {
+  SimMixerConfig c = Offline(300);
+  c.churn_per_second = 100.0;
+  c.failure_rate = 0.01;
+  SimMixerBackend sim(c);
+  DeejConfig cfg;
+  cfg.slider_mapping = {{0, {"master"}}, {1, {"chrome.exe"}}, {2, {"discord.exe", "spotify.exe"}},
+                        {3, {"deej.unmapped"}}};
+  DeckEngine engine(&sim, std::make_unique<NullInput>(), cfg);
+
+  std::mt19937 rng(1);
+  for (int i = 0; i < 500; i++) {
+    sim.Advance(0.01);
+    std::string line;
+    for (int s = 0; s < 4; s++) line += (s ? "|" : "") + std::to_string(rng() % 1024);
+    line += "\n";
+    engine.ProcessBytes(line.data(), line.size());
+  }
+  const DeckEngineStats st = engine.stats();
+  EXPECT_EQ(st.lines, 500u);
+  EXPECT_GT(st.writes, 500u);
+  EXPECT_GT(sim.stats().sessions_started, 350u);
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include "deej_config.h"
+#include "fake_mixer_backend.h"
+#include "slider_mapper.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+DeejConfig Mapping(std::map<int, std::vector<std::string>> m) {
+  DeejConfig cfg;
+  cfg.slider_mapping = std::move(m);
+  return cfg;
+}
+
+// Counts enumerations: each one means names were resolved again.
+class ListCounter : public FakeMixerBackend {
+ public:
+  bool ListSessions(std::vector<AudioSession>* out) override {
+    lists++;
+    return FakeMixerBackend::ListSessions(out);
+  }
+  int lists = 0;
+};
+
+}  // namespace
+
+TEST(SliderMapper, AppliesSpecialAndNamedTargets) {
+  FakeMixerBackend backend;
+  const std::string chrome1 = backend.AddSession("Chrome.exe", 10);
+  const std::string chrome2 = backend.AddSession("chrome.exe", 11);
+  const std::string game = backend.AddSession("game.exe", 12);
+  const std::string sys = backend.AddSession("system", 0, true);
+
+  SliderMapper m(&backend);
+  m.SetConfig(Mapping({{0, {"master"}}, {1, {"CHROME.EXE"}}, {2, {"mic", "system"}}, {3, {"deej.unmapped"}}}));
+
+  EXPECT_EQ(m.Apply(0, 0.3f), 1u);
+  EXPECT_FLOAT_EQ(backend.master_volume(), 0.3f);
+  EXPECT_EQ(m.Apply(1, 0.4f), 2u);
+  EXPECT_FLOAT_EQ(backend.session_volume(chrome1), 0.4f);
+  EXPECT_FLOAT_EQ(backend.session_volume(chrome2), 0.4f);
+  EXPECT_EQ(m.Apply(2, 0.5f), 2u);
+  EXPECT_FLOAT_EQ(backend.input_volume(), 0.5f);
+  EXPECT_FLOAT_EQ(backend.session_volume(sys), 0.5f);
+  // Only game.exe is neither mapped nor the system session.
+  EXPECT_EQ(m.Apply(3, 0.6f), 1u);
+  EXPECT_FLOAT_EQ(backend.session_volume(game), 0.6f);
+  EXPECT_EQ(m.Apply(7, 0.6f), 0u);
+}
+
+TEST(SliderMapper, FollowsSessionsAsTheyComeAndGo) {
+  FakeMixerBackend backend;
+  SliderMapper m(&backend);
+  m.SetConfig(Mapping({{0, {"spotify.exe"}}}));
+  EXPECT_EQ(m.Apply(0, 0.2f), 0u);
+
+  const std::string id = backend.AddSession("spotify.exe", 20);
+  EXPECT_EQ(m.Apply(0, 0.7f), 1u);
+  EXPECT_FLOAT_EQ(backend.session_volume(id), 0.7f);
+
+  backend.RemoveSession(id);
+  EXPECT_EQ(m.Apply(0, 0.1f), 0u);
+}
+
+TEST(SliderMapper, CurrentFollowsTheForegroundProcess) {
+  FakeMixerBackend backend;
+  const std::string a = backend.AddSession("a.exe", 1);
+  const std::string b = backend.AddSession("b.exe", 2);
+  SliderMapper m(&backend);
+  m.SetConfig(Mapping({{0, {"deej.current"}}}));
+
+  backend.SetForegroundPid(2);
+  EXPECT_EQ(m.Apply(0, 0.25f), 1u);
+  EXPECT_FLOAT_EQ(backend.session_volume(b), 0.25f);
+  EXPECT_FLOAT_EQ(backend.session_volume(a), 1.0f);
+}
+
+TEST(SliderMapper, FallsBackToDeviceNames) {
+  FakeMixerBackend backend;
+  backend.AddDevice("Speakers (Realtek)");
+  SliderMapper m(&backend);
+  m.SetConfig(Mapping({{0, {"Speakers (Realtek)"}}, {1, {"nothing.exe"}}}));
+  EXPECT_EQ(m.Apply(0, 0.8f), 1u);
+  EXPECT_FLOAT_EQ(backend.device_volume("Speakers (Realtek)"), 0.8f);
+  EXPECT_EQ(m.Apply(1, 0.8f), 0u);
+}
+
+TEST(SliderMapper, ResolvesOnlyWhenSessionsChange) {
+  ListCounter backend;
+  const std::string a = backend.AddSession("a.exe", 1);
+  SliderMapper m(&backend);
+  m.SetConfig(Mapping({{0, {"a.exe", "deej.unmapped"}}, {1, {"master", "b.exe"}}, {2, {"deej.unmapped"}}}));
+  for (int i = 0; i < 100; i++) {
+    m.Apply(0, 0.5f);
+    m.Apply(2, 0.5f);
+  }
+  EXPECT_EQ(backend.lists, 1);
+
+  // A new session lands in its slider and leaves the catch-all.
+  const std::string b = backend.AddSession("b.exe", 2);
+  const std::string c = backend.AddSession("c.exe", 3);
+  EXPECT_EQ(m.Apply(1, 0.4f), 2u);
+  EXPECT_EQ(backend.lists, 2);
+  EXPECT_FLOAT_EQ(backend.session_volume(b), 0.4f);
+  EXPECT_EQ(m.Apply(2, 0.3f), 1u);
+  EXPECT_FLOAT_EQ(backend.session_volume(c), 0.3f);
+  EXPECT_FLOAT_EQ(backend.session_volume(b), 0.4f);
+  EXPECT_EQ(backend.lists, 2);
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
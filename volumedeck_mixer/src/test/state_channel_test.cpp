@@ -0,0 +1,344 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "deck_engine.h"
+#include "fake_mixer_backend.h"
+#include "state_channel.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+// Every slot of frame `f` is derived from `f`, so a reader can tell a
+// torn copy from a whole one.
+void FillFrame(uint32_t f, std::vector<StateSlot>* slots) {
+  slots->resize(1 + f % 37);
+  for (size_t i = 0; i < slots->size(); i++) {
+    (*slots)[i] = StateSlot{(float)f, (float)f * 0.5f, f, f + (uint32_t)i};
+  }
+}
+
+bool FrameIsWhole(const StateFrame& frame) {
+  if (frame.slots.empty()) return true;
+  const uint32_t f = frame.slots[0].flags;
+  if (frame.slots.size() != 1 + f % 37) return false;
+  for (size_t i = 0; i < frame.slots.size(); i++) {
+    const StateSlot& s = frame.slots[i];
+    if (s.volume != (float)f || s.peak != (float)f * 0.5f || s.flags != f || s.pid != f + i) return false;
+  }
+  return true;
+}
+
+std::vector<StateRosterEntry> Roster(uint64_t gen) {
+  std::vector<StateRosterEntry> r(1 + gen % 11);
+  for (size_t i = 0; i < r.size(); i++) {
+    const std::string tag = std::to_string(gen);
+    r[i] = {"session-" + tag + "-" + std::to_string(i), "app" + tag + ".exe", std::string(gen % 50, 'x')};
+  }
+  return r;
+}
+
+bool RosterIsWhole(const std::vector<StateRosterEntry>& r) {
+  if (r.empty()) return true;
+  const std::string tag = r[0].exe_name.substr(3, r[0].exe_name.size() - 7);
+  const uint64_t gen = std::stoull(tag);
+  return r.size() == 1 + gen % 11 && r.back().id == "session-" + tag + "-" + std::to_string(r.size() - 1) &&
+         r.back().display_name.size() == gen % 50;
+}
+
+struct TornCounts {
+  std::atomic<uint64_t> frames{0};
+  std::atomic<uint64_t> rosters{0};
+  std::atomic<uint64_t> torn{0};
+};
+
+void ReadUntil(const StateChannelReader& reader, const std::atomic<bool>& stop, TornCounts* counts) {
+  StateFrame frame;
+  std::vector<StateRosterEntry> roster;
+  uint64_t generation = 0;
+  while (!stop.load()) {
+    if (reader.ReadFrame(&frame)) {
+      counts->frames++;
+      if (!FrameIsWhole(frame)) counts->torn++;
+    }
+    if (reader.ReadRoster(&roster, &generation)) {
+      counts->rosters++;
+      if (!RosterIsWhole(roster)) counts->torn++;
+    }
+    std::this_thread::yield();
+  }
+}
+
+}  // namespace
+
+TEST(StateChannel, RoundTripsFrameAndRoster) {
+  StateChannelWriter writer(8);
+  ASSERT_TRUE(writer.Open());
+  ASSERT_TRUE(writer.PublishRoster({{"master", "", ""}, {"{abc}", "chrome.exe", "Google Chrome"}}));
+  const StateSlot slots[] = {{0.5f, 0.25f, kStateEndpoint, 0}, {0.75f, 0.1f, kStateMuted, 1234}};
+  writer.PublishFrame(slots, 2);
+
+  StateChannelReader reader;
+  ASSERT_TRUE(reader.Attach(writer.header(), writer.size()));
+  StateFrame frame;
+  ASSERT_TRUE(reader.ReadFrame(&frame));
+  EXPECT_EQ(frame.frame, 1u);
+  EXPECT_EQ(frame.generation, 1u);
+  ASSERT_EQ(frame.slots.size(), 2u);
+  EXPECT_FLOAT_EQ(frame.slots[1].volume, 0.75f);
+  EXPECT_EQ(frame.slots[1].flags, (uint32_t)kStateMuted);
+  EXPECT_EQ(frame.slots[1].pid, 1234u);
+
+  std::vector<StateRosterEntry> roster;
+  uint64_t gen = 0;
+  ASSERT_TRUE(reader.ReadRoster(&roster, &gen));
+  EXPECT_EQ(gen, 1u);
+  ASSERT_EQ(roster.size(), 2u);
+  EXPECT_EQ(roster[1].id, "{abc}");
+  EXPECT_EQ(roster[1].exe_name, "chrome.exe");
+  EXPECT_EQ(roster[1].display_name, "Google Chrome");
+}
+
+TEST(StateChannel, LayoutIsWhatDartReads) {
+  StateChannelWriter writer(5, 100);
+  ASSERT_TRUE(writer.Open());
+  const StateChannelHeader* h = writer.header();
+  EXPECT_EQ(h->magic, kStateChannelMagic);
+  EXPECT_EQ(h->volume_offset, 128u);
+  EXPECT_EQ(h->peak_offset, 128u + 24u);  // 5 floats, 8-byte aligned
+  EXPECT_EQ(h->roster_offset, 128u + 4 * 24u);
+  EXPECT_EQ(h->roster_bytes, 104u);
+  EXPECT_EQ(writer.size(), 128u + 4 * 24u + 104u);
+}
+
+TEST(StateChannel, RejectsForeignAndClosedBlocks) {
+  std::vector<uint64_t> junk(64, 0x1234);
+  StateChannelReader reader;
+  EXPECT_FALSE(reader.Attach(junk.data(), junk.size() * 8));
+
+  StateChannelWriter writer(4);
+  ASSERT_TRUE(writer.Open());
+  EXPECT_FALSE(reader.Attach(writer.header(), sizeof(StateChannelHeader)));  // truncated
+  ASSERT_TRUE(reader.Attach(writer.header(), writer.size()));
+  EXPECT_TRUE(reader.writer_live());
+}
+
+TEST(StateChannel, OversizedRosterKeepsThePreviousOne) {
+  StateChannelWriter writer(4, 64);
+  ASSERT_TRUE(writer.Open());
+  ASSERT_TRUE(writer.PublishRoster({{"a", "a.exe", ""}}));
+  EXPECT_FALSE(writer.PublishRoster({{std::string(100, 'x'), "", ""}}));
+  EXPECT_EQ(writer.generation(), 1u);
+
+  StateChannelReader reader;
+  ASSERT_TRUE(reader.Attach(writer.header(), writer.size()));
+  std::vector<StateRosterEntry> roster;
+  ASSERT_TRUE(reader.ReadRoster(&roster, nullptr));
+  ASSERT_EQ(roster.size(), 1u);
+  EXPECT_EQ(roster[0].id, "a");
+}
+
+TEST(StateChannel, ConcurrentReadersNeverSeeTornState) {
+  StateChannelWriter writer(64);
+  ASSERT_TRUE(writer.Open());
+  std::atomic<bool> stop{false};
+  TornCounts counts;
+
+  std::vector<std::thread> readers;
+  std::vector<std::unique_ptr<StateChannelReader>> views;
+  for (int i = 0; i < 3; i++) {
+    views.push_back(std::make_unique<StateChannelReader>());
+    ASSERT_TRUE(views.back()->Attach(writer.header(), writer.size()));
+    readers.emplace_back(ReadUntil, std::cref(*views.back()), std::cref(stop), &counts);
+  }
+
+  std::vector<StateSlot> slots;
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(400);
+  uint32_t f = 0;
+  while (std::chrono::steady_clock::now() < deadline || counts.frames < 1000 || counts.rosters < 100) {
+    FillFrame(++f, &slots);
+    writer.PublishFrame(slots.data(), slots.size());
+    if (f % 16 == 0) writer.PublishRoster(Roster(writer.generation() + 1));
+  }
+  stop = true;
+  for (auto& t : readers) t.join();
+
+  EXPECT_EQ(counts.torn.load(), 0u);
+  EXPECT_GT(counts.frames.load(), 0u);
+}
+
+#ifdef __linux__
+// The real deployment: volumedeckd writes, the app maps the region.
+TEST(StateChannel, ReaderInAnotherProcess) {
+  const std::string name = "volumedeck_test_" + std::to_string(getpid());
+  StateChannelWriter writer(64);
+  ASSERT_TRUE(writer.Open(name));
+
+  // Fork before any thread exists; the child only reads.
+  const pid_t child = fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    StateChannelReader reader;
+    if (!reader.Open(name)) _exit(2);
+    StateFrame frame;
+    std::vector<StateRosterEntry> roster;
+    uint64_t frames = 0;
+    int torn = 0;
+    while (reader.writer_live()) {
+      if (reader.ReadFrame(&frame)) {
+        frames++;
+        if (!FrameIsWhole(frame)) torn++;
+      }
+      if (reader.ReadRoster(&roster, nullptr) && !RosterIsWhole(roster)) torn++;
+    }
+    _exit(torn ? 1 : frames > 0 ? 0 : 3);
+  }
+
+  std::vector<StateSlot> slots;
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+  for (uint32_t f = 1; std::chrono::steady_clock::now() < deadline; f++) {
+    FillFrame(f, &slots);
+    writer.PublishFrame(slots.data(), slots.size());
+    if (f % 16 == 0) writer.PublishRoster(Roster(writer.generation() + 1));
+    if (f % 64 == 0) std::this_thread::yield();
+  }
+  writer.Close();
+
+  int status = 0;
+  ASSERT_EQ(waitpid(child, &status, 0), child);
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0) << "1 = torn read, 2 = open failed, 3 = no frames";
+}
+
+TEST(StateChannel, SecondWriterIsRefused) {
+  const std::string name = "volumedeck_test_" + std::to_string(getpid());
+  StateChannelWriter first(8);
+  ASSERT_TRUE(first.Open(name));
+  StateChannelReader reader;
+  ASSERT_TRUE(reader.Open(name));
+
+  StateChannelWriter second(8);
+  EXPECT_FALSE(second.Open(name));
+  // The first writer's readers are undisturbed.
+  const StateSlot slot{0.5f, 0.0f, 0u, 0u};
+  first.PublishFrame(&slot, 1);
+  StateFrame frame;
+  ASSERT_TRUE(reader.ReadFrame(&frame));
+  ASSERT_EQ(frame.slots.size(), 1u);
+  EXPECT_EQ(frame.slots[0].volume, 0.5f);
+
+  // Once it is gone the name is free again.
+  first.Close();
+  ASSERT_TRUE(second.Open(name));
+  second.Close();
+}
+
+TEST(StateChannel, RegionOfACrashedWriterIsReplaced) {
+  const std::string name = "volumedeck_test_" + std::to_string(getpid());
+  const pid_t child = fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    // Dies holding the channel, without Close().
+    StateChannelWriter writer(8);
+    _exit(writer.Open(name) ? 0 : 1);
+  }
+  int status = 0;
+  ASSERT_EQ(waitpid(child, &status, 0), child);
+  ASSERT_EQ(WEXITSTATUS(status), 0);
+
+  StateChannelWriter writer(8);
+  ASSERT_TRUE(writer.Open(name));
+  StateChannelReader reader;
+  ASSERT_TRUE(reader.Open(name));
+  EXPECT_EQ(reader.header()->writer_pid, (uint32_t)getpid());
+  writer.Close();
+}
+#endif
+
+TEST(StateChannel, DeckEnginePublishesMasterAndSessions) {
+  FakeMixerBackend backend;
+  backend.AddSession("music.exe", 42);
+  backend.SetMasterMute(true);
+  StateChannelWriter writer(16);
+  ASSERT_TRUE(writer.Open());
+
+  DeejConfig cfg;
+  cfg.slider_mapping = {{0, {"music.exe"}}};
+  DeckEngine engine(&backend, nullptr, cfg);
+  engine.SetStateChannel(&writer);
+  const std::string line = "512\n";
+  engine.ProcessBytes(line.data(), line.size());
+  engine.PublishState();
+
+  StateChannelReader reader;
+  ASSERT_TRUE(reader.Attach(writer.header(), writer.size()));
+  StateFrame frame;
+  ASSERT_TRUE(reader.ReadFrame(&frame));
+  ASSERT_EQ(frame.slots.size(), 2u);
+  EXPECT_EQ(frame.slots[0].flags, (uint32_t)(kStateEndpoint | kStateMuted));
+  EXPECT_FLOAT_EQ(frame.slots[1].volume, 0.5f);
+  EXPECT_EQ(frame.slots[1].pid, 42u);
+
+  std::vector<StateRosterEntry> roster;
+  ASSERT_TRUE(reader.ReadRoster(&roster, nullptr));
+  ASSERT_EQ(roster.size(), 2u);
+  EXPECT_EQ(roster[1].exe_name, "music.exe");
+
+  // Unchanged sessions don't rewrite the roster.
+  engine.PublishState();
+  EXPECT_EQ(writer.generation(), 1u);
+}
+
+TEST(StateChannel, DeckEngineRepublishesChangesMadeBehindIt) {
+  FakeMixerBackend backend;
+  const std::string music = backend.AddSession("music.exe", 42);
+  StateChannelWriter writer(16);
+  ASSERT_TRUE(writer.Open());
+  DeckEngine engine(&backend, nullptr, DeejConfig());
+  engine.SetStateChannel(&writer);
+  engine.PublishState();
+  StateChannelReader reader;
+  ASSERT_TRUE(reader.Attach(writer.header(), writer.size()));
+  StateFrame frame;
+  ASSERT_TRUE(reader.ReadFrame(&frame));
+  const uint64_t published = frame.frame;
+
+  backend.ChangeExternally({music, 0.25f, true});
+  backend.ChangeExternally({music, 0.5f, true});
+  engine.TakeChanges();
+  ASSERT_TRUE(reader.ReadFrame(&frame));
+  EXPECT_EQ(frame.frame, published + 1);
+  ASSERT_EQ(frame.slots.size(), 2u);
+  EXPECT_FLOAT_EQ(frame.slots[1].volume, 0.5f);
+  EXPECT_EQ(frame.slots[1].flags, (uint32_t)kStateMuted);
+  EXPECT_EQ(frame.slots[0].flags, (uint32_t)kStateEndpoint);
+  EXPECT_EQ(writer.generation(), 1u);
+
+  // Nothing new: nothing republished.
+  engine.TakeChanges();
+  ASSERT_TRUE(reader.ReadFrame(&frame));
+  EXPECT_EQ(frame.frame, published + 1);
+
+  // A session the roster doesn't have yet takes a full publish.
+  const std::string game = backend.AddSession("game.exe", 43);
+  backend.ChangeExternally({game, 0.75f, false});
+  engine.TakeChanges();
+  EXPECT_EQ(writer.generation(), 2u);
+  ASSERT_TRUE(reader.ReadFrame(&frame));
+  ASSERT_EQ(frame.slots.size(), 3u);
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <set>
+#include <thread>
+
+#include "task_pool.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+TEST(TaskPool, RunsEveryTaskAndWaitsForIdle) {
+  std::atomic<int> done{0};
+  TaskPool pool(3);
+  for (int i = 0; i < 500; i++) pool.Post([&] { done++; });
+  pool.WaitIdle();
+  EXPECT_EQ(done.load(), 500);
+}
+
+TEST(TaskPool, RunsThreadHooksOnWorkers) {
+  std::atomic<int> started{0}, exited{0};
+  std::mutex mu;
+  std::set<std::thread::id> ids;
+  {
+    TaskPool pool(2, [&] { started++; }, [&] { exited++; });
+    for (int i = 0; i < 20; i++) {
+      pool.Post([&] {
+        std::lock_guard<std::mutex> lock(mu);
+        ids.insert(std::this_thread::get_id());
+      });
+    }
+  }
+  EXPECT_EQ(started.load(), 2);
+  EXPECT_EQ(exited.load(), 2);
+  EXPECT_EQ(ids.count(std::this_thread::get_id()), 0u);
+}
+
+TEST(TaskPool, DestructorDrainsQueue) {
+  std::atomic<int> done{0};
+  {
+    TaskPool pool(1);
+    for (int i = 0; i < 50; i++) {
+      pool.Post([&] {
+        std::this_thread::yield();
+        done++;
+      });
+    }
+  }
+  EXPECT_EQ(done.load(), 50);
+}
+
+}  // namespace test
+}  // namespace volumedeck_mixer
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "deck_engine.h"
+#include "fake_mixer_backend.h"
+#include "latency_histogram.h"
+#include "thread_priority.h"
+
+namespace volumedeck_mixer {
+namespace test {
+
+namespace {
+
+using std::chrono::milliseconds;
+
+class NullInput : public SliderInput {
+ public:
+  bool Open() override { return false; }
+  void Close() override {}
+  long Read(char*, size_t, int) override { return -1; }
+  long Write(const char*, size_t) override { return -1; }
+  std::string description() const override { return "null"; }
+};
+
+// Tests shouldn't shell out to busctl; rtkit is exercised by hand.
+ThreadPriorityOptions Elevated() {
+  ThreadPriorityOptions o;
+  o.enabled = true;
+  o.rtkit = false;
+  return o;
+}
+
+}  // namespace
+
+TEST(ScopedThreadPriority, DisabledLeavesTheThreadAlone) {
+  std::thread([] {
+    ScopedThreadPriority p{ThreadPriorityOptions()};
+    EXPECT_EQ(p.level(), ThreadPriorityLevel::kNormal);
+    EXPECT_EQ(p.description(), "normal");
+#ifdef __linux__
+    EXPECT_EQ(sched_getscheduler(0), SCHED_OTHER);
+#endif
+  }).join();
+}
+
+TEST(ScopedThreadPriority, SkippedStepsFallThroughToNormal) {
+  std::thread([] {
+    ThreadPriorityOptions o = Elevated();
+    o.rr_priority = 0;
+    o.nice = 0;
+    ScopedThreadPriority p(o);
+    EXPECT_EQ(p.level(), ThreadPriorityLevel::kNormal);
+  }).join();
+}
+
+#ifdef __linux__
+TEST(ScopedThreadPriority, RaisesWhatItMayAndPutsItBack) {
+  std::thread([] {
+    const pid_t tid = (pid_t)syscall(SYS_gettid);
+    const int nice_before = getpriority(PRIO_PROCESS, (id_t)tid);
+    {
+      ScopedThreadPriority p(Elevated());
+      std::printf("[          ] engine thread priority: %s\n", p.description().c_str());
+      switch (p.level()) {
+        case ThreadPriorityLevel::kRealtime:
+          EXPECT_EQ(sched_getscheduler(0), SCHED_RR);
+          break;
+        case ThreadPriorityLevel::kRaised:
+          EXPECT_EQ(getpriority(PRIO_PROCESS, (id_t)tid), -10);
+          break;
+        case ThreadPriorityLevel::kNormal:
+          // Without privileges: says so, and why.
+          EXPECT_EQ(p.description().rfind("normal (SCHED_RR: ", 0), 0u) << p.description();
+          break;
+      }
+    }
+    EXPECT_EQ(sched_getscheduler(0), SCHED_OTHER);
+    EXPECT_EQ(getpriority(PRIO_PROCESS, (id_t)tid), nice_before);
+  }).join();
+}
+#endif
+
+TEST(TickTimer, SleepsToTheDeadline) {
+  TickTimer timer;
+  const auto start = TickTimer::Clock::now();
+  timer.SleepUntil(start + milliseconds(3));
+  const auto slept = TickTimer::Clock::now() - start;
+  EXPECT_GE(slept, milliseconds(3));
+  EXPECT_LT(slept, milliseconds(100));
+  // A deadline already gone doesn't sleep.
+  const auto again = TickTimer::Clock::now();
+  timer.SleepUntil(again - milliseconds(5));
+  EXPECT_LT(TickTimer::Clock::now() - again, milliseconds(2));
+}
+
+TEST(TickJitter, EngineReportsPriorityAndWakeJitter) {
+  FakeMixerBackend backend;
+  DeejConfig cfg;
+  DeckEngine engine(&backend, std::make_unique<NullInput>(), cfg);
+  engine.SetPriority(Elevated());
+  ASSERT_TRUE(engine.Start());
+  // No board: the engine sleeps out its reconnect delay on the tick timer.
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+  while (engine.stats().wake_jitter_max_ns == 0 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(milliseconds(10));
+  }
+  engine.Stop();
+  const DeckEngineStats s = engine.stats();
+  EXPECT_FALSE(s.priority_description.empty());
+  EXPECT_GT(s.wake_jitter_max_ns, 0u);
+  EXPECT_LE(s.wake_jitter_p50_ns, s.wake_jitter_max_ns);
+}
+
+#ifdef __linux__
+namespace {
+
+struct JitterRun {
+  ThreadPriorityLevel level = ThreadPriorityLevel::kNormal;
+  std::string description;
+  LatencyHistogram late;
+};
+
+// 1 ms ticks on absolute deadlines, each one's lateness recorded, while
+// `hogs` threads spin on every core.
+void MeasureTicks(bool elevated, int hogs, int ticks, JitterRun* run) {
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < hogs; i++) {
+    threads.emplace_back([&] {
+      volatile uint64_t x = 0;
+      while (!stop.load(std::memory_order_relaxed)) x = x + 1;
+    });
+  }
+  std::thread ticker([&] {
+    ThreadPriorityOptions o = Elevated();
+    o.enabled = elevated;
+    ScopedThreadPriority p(o);
+    run->level = p.level();
+    run->description = p.description();
+    TickTimer timer;
+    auto next = TickTimer::Clock::now();
+    for (int i = 0; i < ticks; i++) {
+      next += milliseconds(1);
+      timer.SleepUntil(next);
+      const auto late = TickTimer::Clock::now() - next;
+      run->late.Record((uint64_t)std::max<long long>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(late).count(), 0));
+    }
+  });
+  ticker.join();
+  stop.store(true);
+  for (std::thread& t : threads) t.join();
+}
+
+void Report(const char* name, const JitterRun& r) {
+  std::printf("[          ] %-14s %-40s p50 %7.1f us  p99 %8.1f us  max %8.1f us\n", name,
+              r.description.c_str(), r.late.Percentile(50) / 1e3, r.late.Percentile(99) / 1e3,
+              r.late.max_ns() / 1e3);
+}
+
+}  // namespace
+
+// The harness: tick jitter idle, then with twice as many spinning threads
+// as cores, at normal and at raised priority. Numbers are printed; only
+// a realtime ticker is held to a bound, since what a normal thread gets
+// under a hog is up to the scheduler.
+TEST(TickJitter, UnderACpuHog) {
+  const int hogs = 2 * (int)std::max(1u, std::thread::hardware_concurrency());
+  constexpr int kTicks = 300;
+
+  JitterRun idle, hogged, raised;
+  MeasureTicks(false, 0, kTicks, &idle);
+  MeasureTicks(false, hogs, kTicks, &hogged);
+  MeasureTicks(true, hogs, kTicks, &raised);
+  Report("idle", idle);
+  Report("hog", hogged);
+  Report("hog, raised", raised);
+
+  EXPECT_EQ(idle.late.count(), (uint64_t)kTicks);
+  EXPECT_EQ(hogged.late.count(), (uint64_t)kTicks);
+  EXPECT_EQ(raised.late.count(), (uint64_t)kTicks);
+  if (raised.level == ThreadPriorityLevel::kRealtime) {
+    // SCHED_RR preempts the hogs outright.
+    EXPECT_LT(raised.late.Percentile(99), 2000000u);
+  }
+}
+#endif
+
+}  // namespace test
+}  // namespace volumedeck_mixer
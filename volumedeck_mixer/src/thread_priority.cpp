@@ -0,0 +1,251 @@
+#include "thread_priority.h"
+
+#include <algorithm>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+
+#include "file_util.h"
+#elif defined(__linux__)
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+extern char** environ;
+#endif
+
+namespace volumedeck_mixer {
+
+#ifdef _WIN32
+
+    namespace {
+
+        // avrt.dll is loaded on demand so the plugin links without it.
+        struct Avrt {
+            HANDLE(WINAPI* set)(LPCWSTR task, LPDWORD index) = nullptr;
+            BOOL(WINAPI* revert)(HANDLE handle) = nullptr;
+        };
+
+        const Avrt& LoadAvrt() {
+            static const Avrt avrt = [] {
+                Avrt a;
+                if (HMODULE m = LoadLibraryW(L"avrt.dll")) {
+                    a.set = reinterpret_cast<decltype(a.set)>(GetProcAddress(m, "AvSetMmThreadCharacteristicsW"));
+                    a.revert = reinterpret_cast<decltype(a.revert)>(GetProcAddress(m, "AvRevertMmThreadCharacteristics"));
+                }
+                return a;
+            }();
+            return avrt;
+        }
+
+    }  // namespace
+
+    ScopedThreadPriority::ScopedThreadPriority(const ThreadPriorityOptions& options) {
+        if (!options.enabled) return;
+        std::string refused;
+        const Avrt& avrt = LoadAvrt();
+        if (avrt.set && avrt.revert) {
+            DWORD index = 0;
+            if (HANDLE h = avrt.set(Utf8ToWide(options.mmcss_task).c_str(), &index)) {
+                mmcss_ = h;
+                level_ = ThreadPriorityLevel::kRealtime;
+                description_ = "MMCSS " + options.mmcss_task;
+                return;
+            }
+            refused = "MMCSS: error " + std::to_string(GetLastError());
+        } else {
+            refused = "MMCSS: no avrt.dll";
+        }
+        // The audio service is off or the task unknown: the best a user
+        // process gets on its own.
+        old_priority_ = GetThreadPriority(GetCurrentThread());
+        if (SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST)) {
+            restore_priority_ = true;
+            level_ = ThreadPriorityLevel::kRaised;
+            description_ = "THREAD_PRIORITY_HIGHEST (" + refused + ")";
+            return;
+        }
+        description_ = "normal (" + refused + ")";
+    }
+
+    ScopedThreadPriority::~ScopedThreadPriority() {
+        if (mmcss_) LoadAvrt().revert((HANDLE)mmcss_);
+        if (restore_priority_) SetThreadPriority(GetCurrentThread(), old_priority_);
+    }
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+    TickTimer::TickTimer() {
+        // Windows 10 1803 and later; older ones refuse the flag.
+        HANDLE h = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        high_resolution_ = h != nullptr;
+        if (!h) h = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        handle_ = h;
+    }
+
+    TickTimer::~TickTimer() {
+        if (handle_) CloseHandle((HANDLE)handle_);
+    }
+
+    bool TickTimer::Arm(Clock::duration d) {
+        if (!handle_) return false;
+        LARGE_INTEGER due;
+        // Negative: relative, in 100 ns units.
+        due.QuadPart = -std::max<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count() / 100, 1);
+        return SetWaitableTimer((HANDLE)handle_, &due, 0, nullptr, nullptr, FALSE) != 0;
+    }
+
+    void TickTimer::SleepUntil(Clock::time_point deadline) {
+        const auto now = Clock::now();
+        if (deadline <= now) return;
+        if (Arm(deadline - now)) {
+            WaitForSingleObject((HANDLE)handle_, INFINITE);
+        } else {
+            std::this_thread::sleep_until(deadline);
+        }
+    }
+
+#elif defined(__linux__)
+
+    namespace {
+
+        pid_t Tid() { return (pid_t)syscall(SYS_gettid); }
+
+        // What rtkit allows by default. It only serves processes that cap
+        // their realtime CPU time, so a runaway thread can't lock up the
+        // desktop.
+        constexpr rlim_t kRtkitRttimeUs = 200000;
+
+        // RealtimeKit over the system bus, through busctl rather than a
+        // D-Bus library.
+        bool AskRtkit(pid_t tid, int priority) {
+            rlimit rl{};
+            if (getrlimit(RLIMIT_RTTIME, &rl) != 0) return false;
+            if (rl.rlim_max == RLIM_INFINITY || rl.rlim_max > kRtkitRttimeUs) {
+                rl.rlim_cur = rl.rlim_max = kRtkitRttimeUs;
+                if (setrlimit(RLIMIT_RTTIME, &rl) != 0) return false;
+            }
+            const std::string tid_arg = std::to_string(tid);
+            const std::string priority_arg = std::to_string(priority);
+            const char* argv[] = {"busctl", "--system", "call", "org.freedesktop.RealtimeKit1",
+                                  "/org/freedesktop/RealtimeKit1", "org.freedesktop.RealtimeKit1",
+                                  "MakeThreadRealtime", "tu", tid_arg.c_str(), priority_arg.c_str(), nullptr};
+            posix_spawn_file_actions_t actions;
+            posix_spawn_file_actions_init(&actions);
+            posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+            posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+            pid_t pid = -1;
+            const int r = posix_spawnp(&pid, "busctl", &actions, nullptr, const_cast<char* const*>(argv), environ);
+            posix_spawn_file_actions_destroy(&actions);
+            if (r != 0) return false;
+            int status = 0;
+            while (waitpid(pid, &status, 0) < 0) {
+                if (errno != EINTR) return false;
+            }
+            return WIFEXITED(status) && WEXITSTATUS(status) == 0 && sched_getscheduler(0) == SCHED_RR;
+        }
+
+    }  // namespace
+
+    ScopedThreadPriority::ScopedThreadPriority(const ThreadPriorityOptions& options) {
+        if (!options.enabled) return;
+        std::string refused;
+        if (options.rr_priority > 0) {
+            sched_param old{};
+            if (pthread_getschedparam(pthread_self(), &old_policy_, &old) == 0) old_rr_priority_ = old.sched_priority;
+            sched_param p{};
+            p.sched_priority = std::clamp(options.rr_priority, sched_get_priority_min(SCHED_RR),
+                                          sched_get_priority_max(SCHED_RR));
+            const int e = pthread_setschedparam(pthread_self(), SCHED_RR, &p);
+            if (e == 0) {
+                restore_policy_ = true;
+                level_ = ThreadPriorityLevel::kRealtime;
+                description_ = "SCHED_RR " + std::to_string(p.sched_priority);
+                return;
+            }
+            refused = std::string("SCHED_RR: ") + strerror(e);
+            if (options.rtkit) {
+                if (AskRtkit(Tid(), p.sched_priority)) {
+                    restore_policy_ = true;
+                    level_ = ThreadPriorityLevel::kRealtime;
+                    description_ = "rtkit SCHED_RR " + std::to_string(p.sched_priority);
+                    return;
+                }
+                refused += ", rtkit refused or missing";
+            }
+        }
+        if (options.nice != 0) {
+            // Per thread on Linux, despite the name.
+            errno = 0;
+            old_nice_ = getpriority(PRIO_PROCESS, (id_t)Tid());
+            if (errno == 0 && setpriority(PRIO_PROCESS, (id_t)Tid(), options.nice) == 0) {
+                restore_nice_ = true;
+                level_ = ThreadPriorityLevel::kRaised;
+                description_ = "nice " + std::to_string(options.nice);
+                if (!refused.empty()) description_ += " (" + refused + ")";
+                return;
+            }
+            if (!refused.empty()) refused += ", ";
+            refused += std::string("nice: ") + strerror(errno);
+        }
+        if (!refused.empty()) description_ = "normal (" + refused + ")";
+    }
+
+    ScopedThreadPriority::~ScopedThreadPriority() {
+        // Lowering needs no privilege, so these always work.
+        if (restore_policy_) {
+            sched_param p{};
+            p.sched_priority = old_rr_priority_;
+            pthread_setschedparam(pthread_self(), old_policy_, &p);
+        }
+        if (restore_nice_) setpriority(PRIO_PROCESS, (id_t)Tid(), old_nice_);
+    }
+
+    TickTimer::TickTimer() : high_resolution_(true) {}
+
+    TickTimer::~TickTimer() = default;
+
+    void TickTimer::SleepUntil(Clock::time_point deadline) {
+        // steady_clock is CLOCK_MONOTONIC; an absolute deadline doesn't
+        // drift when a signal cuts the sleep short.
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+        if (ns <= 0) return;
+        timespec ts{};
+        ts.tv_sec = (time_t)(ns / 1000000000);
+        ts.tv_nsec = (long)(ns % 1000000000);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+        }
+    }
+
+#else
+
+    ScopedThreadPriority::ScopedThreadPriority(const ThreadPriorityOptions& options) {
+        if (options.enabled) description_ = "normal (unsupported)";
+    }
+
+    ScopedThreadPriority::~ScopedThreadPriority() = default;
+
+    TickTimer::TickTimer() = default;
+
+    TickTimer::~TickTimer() = default;
+
+    void TickTimer::SleepUntil(Clock::time_point deadline) { std::this_thread::sleep_until(deadline); }
+
+#endif
+
+}  // namespace volumedeck_mixer
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+namespace volumedeck_mixer {
+
+    // How to raise a latency-critical thread (the one reading the board
+    // and writing the mixer) above whatever else is loading the machine.
+    struct ThreadPriorityOptions {
+        bool enabled = false;
+        // Windows: MMCSS task to register with.
+        std::string mmcss_task = "Pro Audio";
+        // Linux, tried in order: SCHED_RR at rr_priority (1-99; 0 skips
+        // it), the same through rtkit when we lack CAP_SYS_NICE, then the
+        // thread's nice value (0 skips it).
+        int rr_priority = 10;
+        bool rtkit = true;
+        int nice = -10;
+    };
+
+    enum class ThreadPriorityLevel {
+        kNormal,    // nothing was allowed
+        kRaised,    // nice, or a higher Windows thread priority
+        kRealtime,  // SCHED_RR or MMCSS
+    };
+
+    // Raises the calling thread for as long as it lives, and puts it back
+    // after. Never fails: without the privileges for one step it tries the
+    // next, and says what it got.
+    class ScopedThreadPriority {
+    public:
+        explicit ScopedThreadPriority(const ThreadPriorityOptions& options);
+        ~ScopedThreadPriority();
+
+        ScopedThreadPriority(const ScopedThreadPriority&) = delete;
+        ScopedThreadPriority& operator=(const ScopedThreadPriority&) = delete;
+
+        ThreadPriorityLevel level() const { return level_; }
+        // "SCHED_RR 10", "rtkit SCHED_RR 10", "nice -10", "MMCSS Pro Audio",
+        // or "normal (...)" with what was refused.
+        const std::string& description() const { return description_; }
+
+    private:
+        ThreadPriorityLevel level_ = ThreadPriorityLevel::kNormal;
+        std::string description_ = "normal";
+#ifdef _WIN32
+        void* mmcss_ = nullptr;  // AvSetMmThreadCharacteristics handle
+        int old_priority_ = 0;
+        bool restore_priority_ = false;
+#else
+        int old_policy_ = 0;
+        int old_rr_priority_ = 0;
+        int old_nice_ = 0;
+        bool restore_policy_ = false;
+        bool restore_nice_ = false;
+#endif
+    };
+
+    // Sleeps to an absolute deadline on the finest timer the OS offers: a
+    // high-resolution waitable timer on Windows (a plain one before 1803),
+    // clock_nanosleep on CLOCK_MONOTONIC elsewhere. Plain sleeps on Windows
+    // round up to the 15.6 ms system tick. One per thread.
+    class TickTimer {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        TickTimer();
+        ~TickTimer();
+
+        TickTimer(const TickTimer&) = delete;
+        TickTimer& operator=(const TickTimer&) = delete;
+
+        void SleepUntil(Clock::time_point deadline);
+        void SleepFor(Clock::duration d) { SleepUntil(Clock::now() + d); }
+
+        bool high_resolution() const { return high_resolution_; }
+
+#ifdef _WIN32
+        // Sets the timer to fire after `d` without waiting on it, to wait
+        // for it alongside other handles. False if there is no timer.
+        bool Arm(Clock::duration d);
+        void* handle() const { return handle_; }
+#endif
+
+    private:
+        bool high_resolution_ = false;
+#ifdef _WIN32
+        void* handle_ = nullptr;
+#endif
+    };
+
+}  // namespace volumedeck_mixer
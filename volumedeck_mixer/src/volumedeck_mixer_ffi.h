@@ -0,0 +1,60 @@
+#ifndef VOLUMEDECK_MIXER_FFI_H_
+#define VOLUMEDECK_MIXER_FFI_H_
+
+/* Synchronous C ABI for dart:ffi, next to the method channel. Calls run on
+ * the caller's thread and return when the mixer has been written; no
+ * codec, no thread hop, no Future. Slot ids are those of the state channel
+ * (state_channel.h): 0 is the default output, sessions follow in roster
+ * order. Everything returns 0 / false until the plugin has installed a
+ * fast path.
+ *
+ * `generation` is the low 32 bits of the roster generation the caller
+ * resolved its slots against. Session writes made against any other
+ * roster are refused rather than landing on whichever session holds the
+ * slot now; slot 0 means the default output whatever the roster. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define VOLUMEDECK_FFI_EXPORT __declspec(dllexport)
+#else
+#define VOLUMEDECK_FFI_EXPORT __attribute__((visibility("default")))
+#endif
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+enum {
+  VOLUMEDECK_OP_VOLUME = 0, /* value: 0..1 */
+  VOLUMEDECK_OP_MUTE = 1,   /* value: != 0 mutes */
+};
+
+/* 16 bytes, packed by construction. */
+typedef struct VolumedeckMixerOp {
+  uint32_t generation;
+  uint32_t slot;
+  uint32_t kind;
+  float value;
+} VolumedeckMixerOp;
+
+/* Floats written per slot by VolumedeckMixerReadMeters:
+ * peak, hold, ppm, vu, rms. */
+#define VOLUMEDECK_METER_FIELDS 5
+
+VOLUMEDECK_FFI_EXPORT int32_t VolumedeckMixerSetVolume(uint32_t generation, uint32_t slot, float volume);
+VOLUMEDECK_FFI_EXPORT int32_t VolumedeckMixerSetMute(uint32_t generation, uint32_t slot, int32_t mute);
+
+/* Applies ops in order; returns how many succeeded. */
+VOLUMEDECK_FFI_EXPORT uint32_t VolumedeckMixerApplyBatch(const VolumedeckMixerOp* ops, uint32_t count);
+
+/* Fills out[slot * VOLUMEDECK_METER_FIELDS + field] for up to max_slots
+ * slots; returns the number of slots written. */
+VOLUMEDECK_FFI_EXPORT uint32_t VolumedeckMixerReadMeters(float* out, uint32_t max_slots);
+
+#if defined(__cplusplus)
+}  /* extern "C" */
+#endif
+
+#endif  /* VOLUMEDECK_MIXER_FFI_H_ */
@@ -0,0 +1,142 @@
+#ifdef _WIN32
+
+#include "wasapi_loopback_source.h"
+
+#include <windows.h>
+#include <audioclient.h>
+#include <mmdeviceapi.h>
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace volumedeck_mixer {
+
+    namespace {
+
+        template <typename T>
+        void SafeRelease(T*& p) {
+            if (p) p->Release();
+            p = nullptr;
+        }
+
+        // 1 s shared buffer: the monitor reads every 10 ms, so this only
+        // matters when the thread is starved.
+        constexpr REFERENCE_TIME kBufferDuration = 10000000;
+
+    }  // namespace
+
+    bool WasapiLoopbackSource::Open(CaptureFormat* format) {
+        Close();
+        // The monitor thread is ours; MTA so no message pump is needed.
+        com_ = SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+
+        IMMDeviceEnumerator* en = nullptr;
+        if (FAILED(CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
+                                    __uuidof(IMMDeviceEnumerator), (void**)&en))) {
+            Close();
+            return false;
+        }
+        const HRESULT hr = endpoint_id_.empty()
+                                   ? en->GetDefaultAudioEndpoint(eRender, eMultimedia, &device_)
+                                   : en->GetDevice(endpoint_id_.c_str(), &device_);
+        en->Release();
+        if (FAILED(hr) ||
+            FAILED(device_->Activate(__uuidof(IAudioClient), CLSCTX_ALL, nullptr, (void**)&client_))) {
+            Close();
+            return false;
+        }
+
+        WAVEFORMATEX* mix = nullptr;
+        if (FAILED(client_->GetMixFormat(&mix))) {
+            Close();
+            return false;
+        }
+        channels_ = mix->nChannels;
+        bits_ = mix->wBitsPerSample;
+        float_ = mix->wFormatTag == WAVE_FORMAT_IEEE_FLOAT;
+        if (mix->wFormatTag == WAVE_FORMAT_EXTENSIBLE) {
+            const auto* ext = reinterpret_cast<const WAVEFORMATEXTENSIBLE*>(mix);
+            float_ = ext->SubFormat == KSDATAFORMAT_SUBTYPE_IEEE_FLOAT;
+        }
+        format->sample_rate = (int)mix->nSamplesPerSec;
+        format->channels = channels_;
+
+        const HRESULT init = client_->Initialize(AUDCLNT_SHAREMODE_SHARED, AUDCLNT_STREAMFLAGS_LOOPBACK,
+                                                 kBufferDuration, 0, mix, nullptr);
+        CoTaskMemFree(mix);
+        if (FAILED(init) || (!float_ && bits_ != 16 && bits_ != 32) ||
+            FAILED(client_->GetService(__uuidof(IAudioCaptureClient), (void**)&capture_)) ||
+            FAILED(client_->Start())) {
+            Close();
+            return false;
+        }
+        pending_.clear();
+        pending_at_ = 0;
+        return true;
+    }
+
+    void WasapiLoopbackSource::Close() {
+        if (client_) client_->Stop();
+        SafeRelease(capture_);
+        SafeRelease(client_);
+        SafeRelease(device_);
+        if (com_) CoUninitialize();
+        com_ = false;
+    }
+
+    CaptureStatus WasapiLoopbackSource::Read(float* out, size_t max_frames, size_t* frames) {
+        *frames = 0;
+        if (!capture_) return CaptureStatus::kError;
+
+        const size_t stride = (size_t)channels_;
+        if (pending_at_ < pending_.size()) {
+            const size_t n = std::min(max_frames, (pending_.size() - pending_at_) / stride);
+            memcpy(out, &pending_[pending_at_], n * stride * sizeof(float));
+            pending_at_ += n * stride;
+            *frames = n;
+            return CaptureStatus::kOk;
+        }
+
+        UINT32 packet = 0;
+        HRESULT hr = capture_->GetNextPacketSize(&packet);
+        if (SUCCEEDED(hr) && packet == 0) {
+            // Loopback has no event support before Windows 10; poll at the
+            // engine period instead.
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            hr = capture_->GetNextPacketSize(&packet);
+        }
+        if (FAILED(hr)) return CaptureStatus::kError;  // AUDCLNT_E_DEVICE_INVALIDATED etc.
+        if (packet == 0) return CaptureStatus::kOk;
+
+        BYTE* data = nullptr;
+        UINT32 got = 0;
+        DWORD flags = 0;
+        if (FAILED(capture_->GetBuffer(&data, &got, &flags, nullptr, nullptr))) return CaptureStatus::kError;
+
+        pending_.resize((size_t)got * stride);
+        pending_at_ = 0;
+        const size_t samples = pending_.size();
+        if (flags & AUDCLNT_BUFFERFLAGS_SILENT) {
+            std::fill(pending_.begin(), pending_.end(), 0.0f);
+        } else if (float_) {
+            memcpy(pending_.data(), data, samples * sizeof(float));
+        } else if (bits_ == 16) {
+            const int16_t* s = reinterpret_cast<const int16_t*>(data);
+            for (size_t i = 0; i < samples; i++) pending_[i] = (float)s[i] / 32768.0f;
+        } else {
+            const int32_t* s = reinterpret_cast<const int32_t*>(data);
+            for (size_t i = 0; i < samples; i++) pending_[i] = (float)((double)s[i] / 2147483648.0);
+        }
+        capture_->ReleaseBuffer(got);
+
+        const size_t n = std::min(max_frames, (size_t)got);
+        memcpy(out, pending_.data(), n * stride * sizeof(float));
+        pending_at_ = n * stride;
+        *frames = n;
+        return CaptureStatus::kOk;
+    }
+
+}  // namespace volumedeck_mixer
+
+#endif  // _WIN32
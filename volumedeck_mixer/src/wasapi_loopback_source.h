@@ -0,0 +1,44 @@
+#pragma once
+
+#ifdef _WIN32
+
+#include <string>
+
+#include "capture_source.h"
+
+struct IAudioClient;
+struct IAudioCaptureClient;
+struct IMMDevice;
+
+namespace volumedeck_mixer {
+
+    // Loopback capture of a render endpoint in shared mode: exactly what the
+    // user hears, after the session mix and endpoint volume. An empty id
+    // follows the default multimedia output; after a device switch Read()
+    // reports kError and the monitor reopens on the new default.
+    class WasapiLoopbackSource : public CaptureSource {
+    public:
+        explicit WasapiLoopbackSource(std::wstring endpoint_id = {}) : endpoint_id_(std::move(endpoint_id)) {}
+        ~WasapiLoopbackSource() override { Close(); }
+
+        bool Open(CaptureFormat* format) override;
+        void Close() override;
+        CaptureStatus Read(float* interleaved, size_t max_frames, size_t* frames) override;
+
+    private:
+        const std::wstring endpoint_id_;
+        bool com_ = false;
+        IMMDevice* device_ = nullptr;
+        IAudioClient* client_ = nullptr;
+        IAudioCaptureClient* capture_ = nullptr;
+        int channels_ = 0;
+        int bits_ = 0;
+        bool float_ = false;
+        // Leftover of a packet larger than the caller's buffer.
+        std::vector<float> pending_;
+        size_t pending_at_ = 0;
+    };
+
+}  // namespace volumedeck_mixer
+
+#endif  // _WIN32
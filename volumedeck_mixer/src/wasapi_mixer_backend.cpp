@@ -0,0 +1,403 @@
+#ifdef _WIN32
+
+#include "wasapi_mixer_backend.h"
+
+#include <windows.h>
+#include <audiopolicy.h>
+#include <endpointvolume.h>
+#include <mmdeviceapi.h>
+#include <wrl/client.h>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+namespace volumedeck_mixer {
+
+    using Microsoft::WRL::ComPtr;
+
+    namespace {
+
+        std::string WideToUtf8(const wchar_t* w) {
+            if (!w || !*w) return {};
+            const int len = WideCharToMultiByte(CP_UTF8, 0, w, -1, nullptr, 0, nullptr, nullptr);
+            if (len <= 1) return {};
+            std::string out((size_t)len - 1, '\0');
+            WideCharToMultiByte(CP_UTF8, 0, w, -1, out.data(), len, nullptr, nullptr);
+            return out;
+        }
+
+        std::string ExePathByPid(DWORD pid) {
+            HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+            if (!h) return {};
+            wchar_t buf[MAX_PATH];
+            DWORD size = MAX_PATH;
+            std::string path;
+            if (QueryFullProcessImageNameW(h, 0, buf, &size)) path = WideToUtf8(buf);
+            CloseHandle(h);
+            return path;
+        }
+
+        // PKEY_Device_FriendlyName, spelled out so no GUID library is needed.
+        const PROPERTYKEY kFriendlyName = {
+                {0xa45c254e, 0xdf1c, 0x4efd, {0x80, 0x20, 0x67, 0xd1, 0x46, 0xa8, 0x50, 0xe0}}, 14};
+
+        float Clamp01(float v) { return std::min(1.0f, std::max(0.0f, v)); }
+
+        bool EndpointVolume(IMMDevice* dev, ComPtr<IAudioEndpointVolume>& out) {
+            return dev && SUCCEEDED(dev->Activate(__uuidof(IAudioEndpointVolume), CLSCTX_ALL, nullptr,
+                                                  (void**)out.GetAddressOf()));
+        }
+
+        // The event context of every write we make.
+        const GUID* OurContext() {
+            static_assert(sizeof(GUID) == sizeof(MixerContext::bytes), "MixerContext is laid out as a GUID");
+            return reinterpret_cast<const GUID*>(ProcessMixerContext().bytes);
+        }
+
+        MixerContext ContextOf(const GUID* guid) {
+            MixerContext c;
+            if (guid) memcpy(c.bytes, guid, sizeof(c.bytes));
+            return c;
+        }
+
+        // IUnknown for the callbacks below: one interface each, freed on the
+        // last Release().
+        template <typename Interface>
+        class Callback : public Interface {
+        public:
+            virtual ~Callback() = default;
+
+            ULONG STDMETHODCALLTYPE AddRef() override { return (ULONG)InterlockedIncrement(&refs_); }
+            ULONG STDMETHODCALLTYPE Release() override {
+                const LONG n = InterlockedDecrement(&refs_);
+                if (n == 0) delete this;
+                return (ULONG)n;
+            }
+            HRESULT STDMETHODCALLTYPE QueryInterface(REFIID iid, void** out) override {
+                if (!out) return E_POINTER;
+                if (iid == __uuidof(IUnknown) || iid == __uuidof(Interface)) {
+                    *out = static_cast<Interface*>(this);
+                    AddRef();
+                    return S_OK;
+                }
+                *out = nullptr;
+                return E_NOINTERFACE;
+            }
+
+        private:
+            LONG refs_ = 1;
+        };
+
+    }  // namespace
+
+    class WasapiMixerBackend::EndpointCallback : public Callback<IAudioEndpointVolumeCallback> {
+    public:
+        explicit EndpointCallback(WasapiMixerBackend* owner) : owner_(owner) {}
+
+        HRESULT STDMETHODCALLTYPE OnNotify(PAUDIO_VOLUME_NOTIFICATION_DATA data) override {
+            if (!data) return S_OK;
+            const MixerContext context = ContextOf(&data->guidEventContext);
+            owner_->Report({"", data->fMasterVolume, data->bMuted == TRUE}, context.empty() ? nullptr : &context);
+            return S_OK;
+        }
+
+    private:
+        WasapiMixerBackend* const owner_;
+    };
+
+    class WasapiMixerBackend::SessionCallback : public Callback<IAudioSessionEvents> {
+    public:
+        SessionCallback(WasapiMixerBackend* owner, std::string id) : owner_(owner), id_(std::move(id)) {}
+
+        HRESULT STDMETHODCALLTYPE OnSimpleVolumeChanged(float volume, BOOL mute, LPCGUID event_context) override {
+            const MixerContext context = ContextOf(event_context);
+            owner_->Report({id_, volume, mute == TRUE}, context.empty() ? nullptr : &context);
+            return S_OK;
+        }
+        HRESULT STDMETHODCALLTYPE OnDisplayNameChanged(LPCWSTR, LPCGUID) override { return S_OK; }
+        HRESULT STDMETHODCALLTYPE OnIconPathChanged(LPCWSTR, LPCGUID) override { return S_OK; }
+        HRESULT STDMETHODCALLTYPE OnChannelVolumeChanged(DWORD, float[], DWORD, LPCGUID) override { return S_OK; }
+        HRESULT STDMETHODCALLTYPE OnGroupingParamChanged(LPCGUID, LPCGUID) override { return S_OK; }
+        HRESULT STDMETHODCALLTYPE OnStateChanged(AudioSessionState) override { return S_OK; }
+        HRESULT STDMETHODCALLTYPE OnSessionDisconnected(AudioSessionDisconnectReason) override { return S_OK; }
+
+    private:
+        WasapiMixerBackend* const owner_;
+        const std::string id_;
+    };
+
+    bool WasapiMixerBackend::Start() {
+        if (enumerator_) return true;
+        // RPC_E_CHANGED_MODE: the thread is already STA, which works too,
+        // but then it isn't ours to uninitialize.
+        com_ = SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+        if (FAILED(CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
+                                    __uuidof(IMMDeviceEnumerator), (void**)&enumerator_))) {
+            enumerator_ = nullptr;
+            Stop();
+            return false;
+        }
+        ComPtr<IMMDevice> dev;
+        ComPtr<IAudioEndpointVolume> ep;
+        if (observing() &&
+            SUCCEEDED(enumerator_->GetDefaultAudioEndpoint(eRender, eMultimedia, dev.GetAddressOf())) &&
+            EndpointVolume(dev.Get(), ep)) {
+            endpoint_events_ = new EndpointCallback(this);
+            if (SUCCEEDED(ep->RegisterControlChangeNotify(endpoint_events_))) {
+                endpoint_ = ep.Detach();
+            } else {
+                endpoint_events_->Release();
+                endpoint_events_ = nullptr;
+            }
+        }
+        return true;
+    }
+
+    void WasapiMixerBackend::Stop() {
+        if (endpoint_) {
+            endpoint_->UnregisterControlChangeNotify(endpoint_events_);
+            endpoint_->Release();
+            endpoint_events_->Release();
+        }
+        endpoint_ = nullptr;
+        endpoint_events_ = nullptr;
+        for (auto& kv : watched_) Unwatch(&kv.second);
+        watched_.clear();
+        ClearSessions();
+        if (enumerator_) enumerator_->Release();
+        enumerator_ = nullptr;
+        if (com_) CoUninitialize();
+        com_ = false;
+    }
+
+    void WasapiMixerBackend::ClearSessions() {
+        for (auto& kv : sessions_) kv.second->Release();
+        sessions_.clear();
+    }
+
+    bool WasapiMixerBackend::SetChangeObserver(MixerChangeObserver observer) {
+        std::lock_guard<std::mutex> lock(observer_mu_);
+        observer_ = std::move(observer);
+        return true;
+    }
+
+    bool WasapiMixerBackend::observing() {
+        std::lock_guard<std::mutex> lock(observer_mu_);
+        return (bool)observer_;
+    }
+
+    void WasapiMixerBackend::Watch(const std::string& id, IAudioSessionControl* control) {
+        auto* events = new SessionCallback(this, id);
+        if (FAILED(control->RegisterAudioSessionNotification(events))) {
+            events->Release();
+            return;
+        }
+        control->AddRef();
+        watched_[id] = {control, events};
+    }
+
+    void WasapiMixerBackend::Unwatch(Watched* w) {
+        w->control->UnregisterAudioSessionNotification(w->events);
+        w->control->Release();
+        w->events->Release();
+    }
+
+    void WasapiMixerBackend::Report(const MixerChange& change, const MixerContext* context) {
+        if (!echo_.External(change, context)) return;
+        std::lock_guard<std::mutex> lock(observer_mu_);
+        if (observer_) observer_(change);
+    }
+
+    bool WasapiMixerBackend::ListSessions(std::vector<AudioSession>* out) {
+        out->clear();
+        if (!enumerator_) return false;
+        ComPtr<IMMDevice> dev;
+        ComPtr<IAudioSessionManager2> mgr;
+        ComPtr<IAudioSessionEnumerator> en;
+        if (FAILED(enumerator_->GetDefaultAudioEndpoint(eRender, eMultimedia, dev.GetAddressOf())) ||
+            FAILED(dev->Activate(__uuidof(IAudioSessionManager2), CLSCTX_ALL, nullptr,
+                                 (void**)mgr.GetAddressOf())) ||
+            FAILED(mgr->GetSessionEnumerator(en.GetAddressOf()))) {
+            return false;
+        }
+
+        ClearSessions();
+        const bool observe = observing();
+        std::unordered_set<std::string> seen;
+        int count = 0;
+        en->GetCount(&count);
+        for (int i = 0; i < count; i++) {
+            ComPtr<IAudioSessionControl> ctl;
+            ComPtr<IAudioSessionControl2> ctl2;
+            if (FAILED(en->GetSession(i, ctl.GetAddressOf())) || FAILED(ctl.As(&ctl2))) continue;
+
+            AudioSession s;
+            // The session identifier, like the plugin's sessionId and the
+            // state channel roster, so ids can be passed between them.
+            LPWSTR w = nullptr;
+            if (SUCCEEDED(ctl2->GetSessionIdentifier(&w)) && w) {
+                s.id = WideToUtf8(w);
+                CoTaskMemFree(w);
+            }
+            if (s.id.empty()) continue;
+            if (observe) {
+                seen.insert(s.id);
+                if (!watched_.count(s.id)) Watch(s.id, ctl.Get());
+            }
+            w = nullptr;
+            if (SUCCEEDED(ctl->GetDisplayName(&w)) && w) {
+                s.display_name = WideToUtf8(w);
+                CoTaskMemFree(w);
+            }
+            DWORD pid = 0;
+            ctl2->GetProcessId(&pid);
+            s.pid = pid;
+            s.system = ctl2->IsSystemSoundsSession() == S_OK;
+            if (pid != 0) s.exe_path = ExePathByPid(pid);
+            s.exe_name = !s.exe_path.empty() ? ExeBasenameLower(s.exe_path)
+                                             : s.system ? "system" : "pid_" + std::to_string(pid);
+
+            ComPtr<ISimpleAudioVolume> sav;
+            if (SUCCEEDED(ctl2.As(&sav))) {
+                BOOL mute = FALSE;
+                sav->GetMasterVolume(&s.volume);
+                sav->GetMute(&mute);
+                s.mute = mute == TRUE;
+                sessions_[s.id] = sav.Detach();
+            }
+            ComPtr<IAudioMeterInformation> meter;
+            if (SUCCEEDED(ctl2.As(&meter))) meter->GetPeakValue(&s.peak);
+
+            out->push_back(std::move(s));
+        }
+        for (auto it = watched_.begin(); it != watched_.end();) {
+            if (seen.count(it->first)) {
+                ++it;
+                continue;
+            }
+            Unwatch(&it->second);
+            it = watched_.erase(it);
+        }
+        return true;
+    }
+
+    ISimpleAudioVolume* WasapiMixerBackend::FindSession(const std::string& id) {
+        auto it = sessions_.find(id);
+        if (it != sessions_.end()) return it->second;
+        // Not seen yet; enumerate once more.
+        std::vector<AudioSession> scratch;
+        ListSessions(&scratch);
+        it = sessions_.find(id);
+        return it != sessions_.end() ? it->second : nullptr;
+    }
+
+    bool WasapiMixerBackend::GetMaster(float* volume, bool* mute, float* peak) {
+        if (!enumerator_) return false;
+        ComPtr<IMMDevice> dev;
+        ComPtr<IAudioEndpointVolume> ep;
+        if (FAILED(enumerator_->GetDefaultAudioEndpoint(eRender, eMultimedia, dev.GetAddressOf())) ||
+            !EndpointVolume(dev.Get(), ep)) {
+            return false;
+        }
+        BOOL m = FALSE;
+        ep->GetMasterVolumeLevelScalar(volume);
+        ep->GetMute(&m);
+        *mute = m == TRUE;
+        *peak = 0.0f;
+        ComPtr<IAudioMeterInformation> meter;
+        if (SUCCEEDED(dev->Activate(__uuidof(IAudioMeterInformation), CLSCTX_ALL, nullptr,
+                                    (void**)meter.GetAddressOf()))) {
+            meter->GetPeakValue(peak);
+        }
+        return true;
+    }
+
+    bool WasapiMixerBackend::SetMasterVolume(float volume) {
+        if (!enumerator_) return false;
+        ComPtr<IMMDevice> dev;
+        ComPtr<IAudioEndpointVolume> ep;
+        if (FAILED(enumerator_->GetDefaultAudioEndpoint(eRender, eMultimedia, dev.GetAddressOf())) ||
+            !EndpointVolume(dev.Get(), ep)) {
+            return false;
+        }
+        // Noted first: the notification can come before the call returns.
+        echo_.NoteVolume("", Clamp01(volume));
+        return SUCCEEDED(ep->SetMasterVolumeLevelScalar(Clamp01(volume), OurContext()));
+    }
+
+    bool WasapiMixerBackend::SetMasterMute(bool mute) {
+        if (!enumerator_) return false;
+        ComPtr<IMMDevice> dev;
+        ComPtr<IAudioEndpointVolume> ep;
+        if (FAILED(enumerator_->GetDefaultAudioEndpoint(eRender, eMultimedia, dev.GetAddressOf())) ||
+            !EndpointVolume(dev.Get(), ep)) {
+            return false;
+        }
+        echo_.NoteMute("", mute);
+        return SUCCEEDED(ep->SetMute(mute ? TRUE : FALSE, OurContext()));
+    }
+
+    bool WasapiMixerBackend::SetSessionVolume(const std::string& id, float volume) {
+        ISimpleAudioVolume* sav = FindSession(id);
+        if (!sav) return false;
+        echo_.NoteVolume(id, Clamp01(volume));
+        return SUCCEEDED(sav->SetMasterVolume(Clamp01(volume), OurContext()));
+    }
+
+    bool WasapiMixerBackend::SetSessionMute(const std::string& id, bool mute) {
+        ISimpleAudioVolume* sav = FindSession(id);
+        if (!sav) return false;
+        echo_.NoteMute(id, mute);
+        return SUCCEEDED(sav->SetMute(mute ? TRUE : FALSE, OurContext()));
+    }
+
+    bool WasapiMixerBackend::SetInputVolume(float volume) {
+        if (!enumerator_) return false;
+        ComPtr<IMMDevice> dev;
+        ComPtr<IAudioEndpointVolume> ep;
+        return SUCCEEDED(enumerator_->GetDefaultAudioEndpoint(eCapture, eMultimedia, dev.GetAddressOf())) &&
+               EndpointVolume(dev.Get(), ep) &&
+               SUCCEEDED(ep->SetMasterVolumeLevelScalar(Clamp01(volume), OurContext()));
+    }
+
+    bool WasapiMixerBackend::SetDeviceVolume(const std::string& name, float volume) {
+        if (!enumerator_) return false;
+        ComPtr<IMMDeviceCollection> devices;
+        if (FAILED(enumerator_->EnumAudioEndpoints(eAll, DEVICE_STATE_ACTIVE, devices.GetAddressOf()))) {
+            return false;
+        }
+        UINT count = 0;
+        devices->GetCount(&count);
+        for (UINT i = 0; i < count; i++) {
+            ComPtr<IMMDevice> dev;
+            ComPtr<IPropertyStore> props;
+            if (FAILED(devices->Item(i, dev.GetAddressOf())) ||
+                FAILED(dev->OpenPropertyStore(STGM_READ, props.GetAddressOf()))) {
+                continue;
+            }
+            PROPVARIANT v;
+            PropVariantInit(&v);
+            bool match = false;
+            if (SUCCEEDED(props->GetValue(kFriendlyName, &v)) && v.vt == VT_LPWSTR) {
+                match = _stricmp(WideToUtf8(v.pwszVal).c_str(), name.c_str()) == 0;
+            }
+            PropVariantClear(&v);
+            if (!match) continue;
+            ComPtr<IAudioEndpointVolume> ep;
+            return EndpointVolume(dev.Get(), ep) &&
+                   SUCCEEDED(ep->SetMasterVolumeLevelScalar(Clamp01(volume), OurContext()));
+        }
+        return false;
+    }
+
+    uint32_t WasapiMixerBackend::ForegroundPid() {
+        HWND hwnd = GetForegroundWindow();
+        DWORD pid = 0;
+        if (hwnd) GetWindowThreadProcessId(hwnd, &pid);
+        return pid;
+    }
+
+}  // namespace volumedeck_mixer
+
+#endif  // _WIN32
@@ -0,0 +1,81 @@
+#pragma once
+
+#ifdef _WIN32
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "echo_filter.h"
+#include "mixer_backend.h"
+
+struct IAudioEndpointVolume;
+struct IAudioSessionControl;
+struct IMMDeviceEnumerator;
+struct ISimpleAudioVolume;
+
+namespace volumedeck_mixer {
+
+    // Core Audio sessions on the default multimedia render endpoint. The
+    // MMDevice and session objects are free-threaded, so calls may come
+    // from a thread other than Start()'s, one at a time. Writes are
+    // tagged with ProcessMixerContext(); change notifications arrive on
+    // Core Audio's threads and reach the observer without our own.
+    class WasapiMixerBackend : public MixerBackend {
+    public:
+        WasapiMixerBackend() = default;
+        ~WasapiMixerBackend() override { Stop(); }
+
+        const char* name() const override { return "wasapi"; }
+
+        bool Start() override;
+        void Stop() override;
+
+        bool ListSessions(std::vector<AudioSession>* out) override;
+        bool GetMaster(float* volume, bool* mute, float* peak) override;
+        bool SetMasterVolume(float volume) override;
+        bool SetMasterMute(bool mute) override;
+        bool SetSessionVolume(const std::string& id, float volume) override;
+        bool SetSessionMute(const std::string& id, bool mute) override;
+        bool SetInputVolume(float volume) override;
+        bool SetDeviceVolume(const std::string& name, float volume) override;
+        uint32_t ForegroundPid() override;
+        // Master of the default endpoint as of Start(), and every session
+        // ListSessions() has seen.
+        bool SetChangeObserver(MixerChangeObserver observer) override;
+
+    private:
+        // COM callbacks, defined next to the Core Audio includes.
+        class EndpointCallback;
+        class SessionCallback;
+        struct Watched {
+            IAudioSessionControl* control = nullptr;
+            SessionCallback* events = nullptr;
+        };
+
+        ISimpleAudioVolume* FindSession(const std::string& id);
+        void ClearSessions();
+        bool observing();
+        void Watch(const std::string& id, IAudioSessionControl* control);
+        void Unwatch(Watched* w);
+        // From the callbacks' threads.
+        void Report(const MixerChange& change, const MixerContext* context);
+
+        bool com_ = false;
+        IMMDeviceEnumerator* enumerator_ = nullptr;
+        // From the last ListSessions(), so a slider move is one COM call
+        // instead of a full enumeration.
+        std::unordered_map<std::string, ISimpleAudioVolume*> sessions_;
+
+        std::mutex observer_mu_;
+        MixerChangeObserver observer_;
+        EchoFilter echo_;
+        IAudioEndpointVolume* endpoint_ = nullptr;
+        EndpointCallback* endpoint_events_ = nullptr;
+        std::unordered_map<std::string, Watched> watched_;
+    };
+
+}  // namespace volumedeck_mixer
+
+#endif  // _WIN32
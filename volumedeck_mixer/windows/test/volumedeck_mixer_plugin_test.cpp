@@ -22,21 +22,33 @@ using flutter::MethodResultFunctions;
 
 }  // namespace
 
-TEST(VolumedeckMixerPlugin, GetPlatformVersion) {
+TEST(VolumedeckMixerPlugin, GetSamplerStats) {
   VolumedeckMixerPlugin plugin;
   // Save the reply value from the success callback.
-  std::string result_string;
+  EncodableMap stats;
   plugin.HandleMethodCall(
-      MethodCall("getPlatformVersion", std::make_unique<EncodableValue>()),
+      MethodCall("getSamplerStats", std::make_unique<EncodableValue>()),
       std::make_unique<MethodResultFunctions<>>(
-          [&result_string](const EncodableValue* result) {
-            result_string = std::get<std::string>(*result);
+          [&stats](const EncodableValue* result) {
+            stats = std::get<EncodableMap>(*result);
           },
           nullptr, nullptr));
 
-  // Since the exact string varies by host, just ensure that it's a string
-  // with the expected format.
-  EXPECT_TRUE(result_string.rfind("Windows ", 0) == 0);
+  // The plugin's own method-channel poll is always subscribed.
+  ASSERT_TRUE(std::holds_alternative<int32_t>(stats[EncodableValue("subscribers")]));
+  EXPECT_GE(std::get<int32_t>(stats[EncodableValue("subscribers")]), 1);
+  EXPECT_TRUE(std::holds_alternative<double>(stats[EncodableValue("hz")]));
+}
+
+TEST(VolumedeckMixerPlugin, UnknownMethodIsNotImplemented) {
+  VolumedeckMixerPlugin plugin;
+  bool not_implemented = false;
+  plugin.HandleMethodCall(
+      MethodCall("getPlatformVersion", std::make_unique<EncodableValue>()),
+      std::make_unique<MethodResultFunctions<>>(
+          nullptr, nullptr,
+          [&not_implemented]() { not_implemented = true; }));
+  EXPECT_TRUE(not_implemented);
 }
 
 }  // namespace test
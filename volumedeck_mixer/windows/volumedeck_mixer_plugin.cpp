@@ -1,64 +1,1095 @@
+#include "volumedeck_mixer_plugin.h"
+
 #include <flutter/method_channel.h>
 #include <flutter/plugin_registrar_windows.h>
 #include <flutter/standard_method_codec.h>
 
+#include <windows.h>
+#include <mmdeviceapi.h>
+#include <endpointvolume.h>
+#include <audiopolicy.h>
+#include <psapi.h>
+#include <wrl/client.h>
+
+#include <chrono>
+#include <map>
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
+#include <optional>
+
+#include "deej_config.h"
+#include "file_util.h"
+#include "wasapi_loopback_source.h"
 
 namespace volumedeck_mixer {
 
-    class VolumedeckMixerPlugin : public flutter::Plugin {
+// ---------- helpers ----------
+    static std::string WideToUtf8(const std::wstring& w) {
+        if (w.empty()) return {};
+        int len = WideCharToMultiByte(CP_UTF8, 0, w.c_str(), (int)w.size(), nullptr, 0, nullptr, nullptr);
+        std::string out(len, '\0');
+        WideCharToMultiByte(CP_UTF8, 0, w.c_str(), (int)w.size(), out.data(), len, nullptr, nullptr);
+        return out;
+    }
+
+    // Event context for our writes, the same one the native engine uses, so
+    // change notifications can tell them from the user's (mixer_backend.h).
+    static const GUID* OurEventContext() {
+        static_assert(sizeof(GUID) == sizeof(MixerContext::bytes), "MixerContext is laid out as a GUID");
+        return reinterpret_cast<const GUID*>(ProcessMixerContext().bytes);
+    }
+
+    static std::string BasenameLower(const std::string& pathOrName) {
+        std::string s = pathOrName;
+        for (auto& c : s) if (c == '\\') c = '/';
+        auto pos = s.find_last_of('/');
+        std::string base = (pos == std::string::npos) ? s : s.substr(pos + 1);
+        for (auto& c : base) c = (char)tolower((unsigned char)c);
+        return base;
+    }
+
+    static std::string GetExePathByPid(DWORD pid) {
+        std::string path;
+        HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION | PROCESS_VM_READ, FALSE, pid);
+        if (!h) return path;
+
+        wchar_t buf[MAX_PATH];
+        DWORD size = MAX_PATH;
+
+        if (QueryFullProcessImageNameW(h, 0, buf, &size)) {
+            CloseHandle(h);
+            return WideToUtf8(std::wstring(buf, size));
+        }
+
+        HMODULE mod;
+        DWORD needed = 0;
+        if (EnumProcessModules(h, &mod, sizeof(mod), &needed)) {
+            if (GetModuleFileNameExW(h, mod, buf, MAX_PATH)) {
+                path = WideToUtf8(buf);
+            }
+        }
+
+        CloseHandle(h);
+        return path;
+    }
+
+    static double Clamp01(double x) {
+        if (x < 0.0) return 0.0;
+        if (x > 1.0) return 1.0;
+        return x;
+    }
+
+    struct SessionInfo {
+        std::string sessionId;
+        DWORD pid = 0;
+        std::string exeName;      // chrome.exe
+        std::string exePath;      // full path
+        std::string displayName;
+        float volume = 1.0f;      // 0..1
+        bool mute = false;
+        float peak = 0.0f;        // 0..1
+    };
+
+    class CoreAudio {
     public:
-        static void RegisterWithRegistrar(flutter::PluginRegistrarWindows *registrar);
+        CoreAudio() { CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED); }
+        ~CoreAudio() { CoUninitialize(); }
+
+        flutter::EncodableMap GetSnapshot(bool include_sessions) {
+            flutter::EncodableMap out;
+
+            out[flutter::EncodableValue("master")] = GetMaster();
 
-        VolumedeckMixerPlugin() {}
-        virtual ~VolumedeckMixerPlugin() {}
+            if (include_sessions) {
+                flutter::EncodableList sessions;
+                auto vec = ListSessions();
+                for (auto& s : vec) {
+                    flutter::EncodableMap m;
+                    m[flutter::EncodableValue("sessionId")] = flutter::EncodableValue(s.sessionId);
+                    m[flutter::EncodableValue("pid")] = flutter::EncodableValue((int)s.pid);
+                    m[flutter::EncodableValue("exeName")] = flutter::EncodableValue(s.exeName);
+                    m[flutter::EncodableValue("exePath")] = flutter::EncodableValue(s.exePath);
+                    m[flutter::EncodableValue("displayName")] = flutter::EncodableValue(s.displayName);
+                    m[flutter::EncodableValue("volume")] = flutter::EncodableValue((double)s.volume);
+                    m[flutter::EncodableValue("mute")] = flutter::EncodableValue(s.mute);
+                    m[flutter::EncodableValue("peak")] = flutter::EncodableValue((double)s.peak);
+                    sessions.push_back(flutter::EncodableValue(m));
+                }
+                out[flutter::EncodableValue("sessions")] = flutter::EncodableValue(sessions);
+            }
+
+            return out;
+        }
+
+        std::optional<std::string> FindSessionIdByExeName(const std::string& exeName) {
+            auto want = BasenameLower(exeName);
+            auto vec = ListSessions();
+            for (auto& s : vec) {
+                if (BasenameLower(s.exeName) == want) return s.sessionId;
+            }
+            return std::nullopt;
+        }
+
+        bool SetMasterVolume(double v01) {
+            Microsoft::WRL::ComPtr<IAudioEndpointVolume> ep;
+            if (!GetEndpointVolume(ep)) return false;
+            float v = (float)Clamp01(v01);
+            return SUCCEEDED(ep->SetMasterVolumeLevelScalar(v, OurEventContext()));
+        }
+
+        bool SetMasterMute(bool mute) {
+            Microsoft::WRL::ComPtr<IAudioEndpointVolume> ep;
+            if (!GetEndpointVolume(ep)) return false;
+            return SUCCEEDED(ep->SetMute(mute ? TRUE : FALSE, OurEventContext()));
+        }
+
+        bool SetSessionVolume(const std::string& sessionId, double v01) {
+            auto s = FindSessionById(sessionId);
+            if (!s) return false;
+            return SetSimpleVolume(*s, (float)Clamp01(v01));
+        }
+
+        bool SetSessionMute(const std::string& sessionId, bool mute) {
+            auto s = FindSessionById(sessionId);
+            if (!s) return false;
+            return SetSimpleMute(*s, mute);
+        }
 
     private:
-        void HandleMethodCall(
-                const flutter::MethodCall<flutter::EncodableValue> &method_call,
-                std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+        bool GetDefaultRenderDevice(Microsoft::WRL::ComPtr<IMMDevice>& dev) {
+            Microsoft::WRL::ComPtr<IMMDeviceEnumerator> en;
+            if (FAILED(CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
+                                        __uuidof(IMMDeviceEnumerator), (void**)en.GetAddressOf())))
+                return false;
+
+            return SUCCEEDED(en->GetDefaultAudioEndpoint(eRender, eMultimedia, dev.GetAddressOf()));
+        }
+
+        bool GetEndpointVolume(Microsoft::WRL::ComPtr<IAudioEndpointVolume>& ep) {
+            Microsoft::WRL::ComPtr<IMMDevice> dev;
+            if (!GetDefaultRenderDevice(dev)) return false;
+
+            Microsoft::WRL::ComPtr<IAudioEndpointVolume> v;
+            if (FAILED(dev->Activate(__uuidof(IAudioEndpointVolume), CLSCTX_ALL, nullptr,
+                                     (void**)v.GetAddressOf())))
+                return false;
+
+            ep = v;
+            return true;
+        }
+
+        bool GetEndpointMeter(Microsoft::WRL::ComPtr<IAudioMeterInformation>& mi) {
+            Microsoft::WRL::ComPtr<IMMDevice> dev;
+            if (!GetDefaultRenderDevice(dev)) return false;
+
+            Microsoft::WRL::ComPtr<IAudioMeterInformation> m;
+            if (FAILED(dev->Activate(__uuidof(IAudioMeterInformation), CLSCTX_ALL, nullptr,
+                                     (void**)m.GetAddressOf())))
+                return false;
+
+            mi = m;
+            return true;
+        }
+
+        flutter::EncodableMap GetMaster() {
+            flutter::EncodableMap m;
+            double vol = 1.0;
+            bool mute = false;
+            double peak = 0.0;
+
+            {
+                Microsoft::WRL::ComPtr<IAudioEndpointVolume> ep;
+                if (GetEndpointVolume(ep)) {
+                    float v = 1.f;
+                    BOOL mu = FALSE;
+                    ep->GetMasterVolumeLevelScalar(&v);
+                    ep->GetMute(&mu);
+                    vol = v;
+                    mute = (mu == TRUE);
+                }
+            }
+
+            {
+                Microsoft::WRL::ComPtr<IAudioMeterInformation> mi;
+                if (GetEndpointMeter(mi)) {
+                    float p = 0.f;
+                    if (SUCCEEDED(mi->GetPeakValue(&p))) peak = p;
+                }
+            }
+
+            m[flutter::EncodableValue("volume")] = flutter::EncodableValue(vol);
+            m[flutter::EncodableValue("mute")] = flutter::EncodableValue(mute);
+            m[flutter::EncodableValue("peak")] = flutter::EncodableValue(peak);
+            return m;
+        }
+
+        std::vector<SessionInfo> ListSessions() {
+            std::vector<SessionInfo> out;
+
+            Microsoft::WRL::ComPtr<IMMDevice> dev;
+            if (!GetDefaultRenderDevice(dev)) return out;
+
+            Microsoft::WRL::ComPtr<IAudioSessionManager2> mgr;
+            if (FAILED(dev->Activate(__uuidof(IAudioSessionManager2), CLSCTX_ALL, nullptr,
+                                     (void**)mgr.GetAddressOf())))
+                return out;
+
+            Microsoft::WRL::ComPtr<IAudioSessionEnumerator> en;
+            if (FAILED(mgr->GetSessionEnumerator(en.GetAddressOf())))
+                return out;
+
+            int count = 0;
+            en->GetCount(&count);
+
+            for (int i = 0; i < count; i++) {
+                Microsoft::WRL::ComPtr<IAudioSessionControl> ctl;
+                if (FAILED(en->GetSession(i, ctl.GetAddressOf()))) continue;
+
+                Microsoft::WRL::ComPtr<IAudioSessionControl2> ctl2;
+                if (FAILED(ctl.As(&ctl2))) continue;
+
+                DWORD pid = 0;
+                ctl2->GetProcessId(&pid);
+
+                // sessionId
+                LPWSTR sid = nullptr;
+                std::string sessionId;
+                if (SUCCEEDED(ctl2->GetSessionIdentifier(&sid)) && sid) {
+                    sessionId = WideToUtf8(sid);
+                    CoTaskMemFree(sid);
+                }
+
+                // display name
+                LPWSTR dn = nullptr;
+                std::string displayName;
+                if (SUCCEEDED(ctl->GetDisplayName(&dn)) && dn) {
+                    displayName = WideToUtf8(dn);
+                    CoTaskMemFree(dn);
+                }
+
+                std::string exePath = (pid != 0) ? GetExePathByPid(pid) : "";
+                std::string exeName = exePath.empty() ? "" : BasenameLower(exePath);
+                if (exeName.empty()) exeName = (pid == 0) ? "system" : ("pid_" + std::to_string(pid));
+
+                // volume + mute
+                float volume = 1.0f;
+                bool mute = false;
+                {
+                    Microsoft::WRL::ComPtr<ISimpleAudioVolume> sav;
+                    if (SUCCEEDED(ctl2->QueryInterface(__uuidof(ISimpleAudioVolume), (void**)sav.GetAddressOf()))) {
+                        float v = 1.0f;
+                        BOOL mu = FALSE;
+                        sav->GetMasterVolume(&v);
+                        sav->GetMute(&mu);
+                        volume = v;
+                        mute = (mu == TRUE);
+                    }
+                }
+
+                // peak
+                float peak = 0.0f;
+                {
+                    Microsoft::WRL::ComPtr<IAudioMeterInformation> mi;
+                    if (SUCCEEDED(ctl2->QueryInterface(__uuidof(IAudioMeterInformation), (void**)mi.GetAddressOf()))) {
+                        float p = 0.f;
+                        if (SUCCEEDED(mi->GetPeakValue(&p))) peak = p;
+                    }
+                }
+
+                SessionInfo s;
+                s.sessionId = sessionId;
+                s.pid = pid;
+                s.exeName = exeName;
+                s.exePath = exePath;
+                s.displayName = displayName;
+                s.volume = volume;
+                s.mute = mute;
+                s.peak = peak;
+
+                out.push_back(std::move(s));
+            }
+
+            return out;
+        }
+
+        std::optional<SessionInfo> FindSessionById(const std::string& sessionId) {
+            auto vec = ListSessions();
+            for (auto& s : vec) if (s.sessionId == sessionId) return s;
+            return std::nullopt;
+        }
+
+        bool SetSimpleVolume(const SessionInfo& si, float vol) {
+            Microsoft::WRL::ComPtr<IMMDevice> dev;
+            if (!GetDefaultRenderDevice(dev)) return false;
+
+            Microsoft::WRL::ComPtr<IAudioSessionManager2> mgr;
+            if (FAILED(dev->Activate(__uuidof(IAudioSessionManager2), CLSCTX_ALL, nullptr,
+                                     (void**)mgr.GetAddressOf())))
+                return false;
+
+            Microsoft::WRL::ComPtr<IAudioSessionEnumerator> en;
+            if (FAILED(mgr->GetSessionEnumerator(en.GetAddressOf())))
+                return false;
+
+            int count = 0;
+            en->GetCount(&count);
+
+            for (int i = 0; i < count; i++) {
+                Microsoft::WRL::ComPtr<IAudioSessionControl> ctl;
+                if (FAILED(en->GetSession(i, ctl.GetAddressOf()))) continue;
+
+                Microsoft::WRL::ComPtr<IAudioSessionControl2> ctl2;
+                if (FAILED(ctl.As(&ctl2))) continue;
+
+                LPWSTR sid = nullptr;
+                std::string id;
+                if (SUCCEEDED(ctl2->GetSessionIdentifier(&sid)) && sid) {
+                    id = WideToUtf8(sid);
+                    CoTaskMemFree(sid);
+                }
+                if (id != si.sessionId) continue;
+
+                Microsoft::WRL::ComPtr<ISimpleAudioVolume> sav;
+                if (FAILED(ctl2->QueryInterface(__uuidof(ISimpleAudioVolume), (void**)sav.GetAddressOf()))) return false;
+                return SUCCEEDED(sav->SetMasterVolume(vol, OurEventContext()));
+            }
+            return false;
+        }
+
+        bool SetSimpleMute(const SessionInfo& si, bool mute) {
+            Microsoft::WRL::ComPtr<IMMDevice> dev;
+            if (!GetDefaultRenderDevice(dev)) return false;
+
+            Microsoft::WRL::ComPtr<IAudioSessionManager2> mgr;
+            if (FAILED(dev->Activate(__uuidof(IAudioSessionManager2), CLSCTX_ALL, nullptr,
+                                     (void**)mgr.GetAddressOf())))
+                return false;
+
+            Microsoft::WRL::ComPtr<IAudioSessionEnumerator> en;
+            if (FAILED(mgr->GetSessionEnumerator(en.GetAddressOf())))
+                return false;
+
+            int count = 0;
+            en->GetCount(&count);
+
+            for (int i = 0; i < count; i++) {
+                Microsoft::WRL::ComPtr<IAudioSessionControl> ctl;
+                if (FAILED(en->GetSession(i, ctl.GetAddressOf()))) continue;
+
+                Microsoft::WRL::ComPtr<IAudioSessionControl2> ctl2;
+                if (FAILED(ctl.As(&ctl2))) continue;
+
+                LPWSTR sid = nullptr;
+                std::string id;
+                if (SUCCEEDED(ctl2->GetSessionIdentifier(&sid)) && sid) {
+                    id = WideToUtf8(sid);
+                    CoTaskMemFree(sid);
+                }
+                if (id != si.sessionId) continue;
+
+                Microsoft::WRL::ComPtr<ISimpleAudioVolume> sav;
+                if (FAILED(ctl2->QueryInterface(__uuidof(ISimpleAudioVolume), (void**)sav.GetAddressOf()))) return false;
+                return SUCCEEDED(sav->SetMute(mute ? TRUE : FALSE, OurEventContext()));
+            }
+            return false;
+        }
     };
 
-    void VolumedeckMixerPlugin::RegisterWithRegistrar(
-            flutter::PluginRegistrarWindows *registrar) {
-        auto channel =
-                std::make_unique<flutter::MethodChannel<flutter::EncodableValue>>(
-                        registrar->messenger(), "volumedeck_mixer",
-                                &flutter::StandardMethodCodec::GetInstance());
+// ---------- meters ----------
+    // Feeds the MeterEngine from IAudioMeterInformation. Runs entirely on the
+    // meter thread: slot 0 is the default endpoint, sessions get a slot when
+    // first seen and keep it until they disappear. The session list is
+    // re-enumerated about once a second; in between a tick is one
+    // GetPeakValue per slot.
+    class SessionMeterProbe : public MeterProbe {
+    public:
+        static constexpr size_t kMaxSlots = 128;
+
+        void SetEngine(MeterEngine* engine) { engine_ = engine; }
+        // Also publish volumes, mutes and raw peaks at the UI frame rate.
+        void SetStateChannel(StateChannelWriter* state) { state_ = state; }
+
+        void OnThreadStart() override { CoInitializeEx(nullptr, COINIT_MULTITHREADED); }
+
+        void OnThreadStop() override {
+            meters_.clear();
+            volumes_.clear();
+            endpoint_.Reset();
+            endpoint_volume_.Reset();
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                slots_.clear();
+            }
+            CoUninitialize();
+        }
+
+        size_t Sample(float* peaks, size_t capacity) override {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= next_refresh_) {
+                Refresh();
+                next_refresh_ = now + std::chrono::seconds(1);
+            }
+            const size_t n = std::min(capacity, meters_.size());
+            for (size_t i = 0; i < n; i++) {
+                float p = 0.f;
+                if (meters_[i] && SUCCEEDED(meters_[i]->GetPeakValue(&p))) peaks[i] = p;
+            }
+            if (state_ && now >= next_publish_) {
+                PublishState(peaks, n);
+                next_publish_ = now + std::chrono::microseconds(33333);
+            }
+            return n;
+        }
+
+        // Slot of a session, -1 if it is not metered (yet). Any thread.
+        int SlotOf(const std::string& sessionId) {
+            std::lock_guard<std::mutex> lock(mu_);
+            auto it = slots_.find(sessionId);
+            return it == slots_.end() ? -1 : (int)it->second;
+        }
+
+        std::vector<std::pair<std::string, size_t>> Roster() {
+            std::lock_guard<std::mutex> lock(mu_);
+            return {slots_.begin(), slots_.end()};
+        }
+
+    private:
+        struct LiveSession {
+            Microsoft::WRL::ComPtr<IAudioMeterInformation> meter;
+            Microsoft::WRL::ComPtr<ISimpleAudioVolume> volume;
+            StateRosterEntry entry;
+            uint32_t pid = 0;
+            bool system = false;
+        };
+
+        void PublishState(const float* peaks, size_t n) {
+            frame_.resize(n);
+            for (size_t i = 0; i < n; i++) {
+                StateSlot& s = frame_[i];
+                s = StateSlot{};
+                s.peak = peaks[i];
+                BOOL mute = FALSE;
+                if (i == 0) {
+                    s.flags = kStateEndpoint;
+                    if (endpoint_volume_) {
+                        endpoint_volume_->GetMasterVolumeLevelScalar(&s.volume);
+                        endpoint_volume_->GetMute(&mute);
+                    }
+                } else if (i < volumes_.size() && volumes_[i]) {
+                    volumes_[i]->GetMasterVolume(&s.volume);
+                    volumes_[i]->GetMute(&mute);
+                    s.pid = pids_[i];
+                    s.flags = system_[i] ? kStateSystem : 0u;
+                }
+                if (mute) s.flags |= kStateMuted;
+            }
+            if (roster_dirty_) {
+                state_->PublishRoster(roster_);
+                roster_dirty_ = false;
+            }
+            state_->PublishFrame(frame_.data(), frame_.size());
+        }
+
+        void Refresh() {
+            Microsoft::WRL::ComPtr<IMMDeviceEnumerator> en;
+            Microsoft::WRL::ComPtr<IMMDevice> dev;
+            if (FAILED(CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
+                                        __uuidof(IMMDeviceEnumerator), (void**)en.GetAddressOf())) ||
+                FAILED(en->GetDefaultAudioEndpoint(eRender, eMultimedia, dev.GetAddressOf()))) {
+                return;
+            }
+
+            // Activate hands out a new object every time; compare device ids.
+            std::wstring device_id;
+            LPWSTR did = nullptr;
+            if (SUCCEEDED(dev->GetId(&did)) && did) {
+                device_id = did;
+                CoTaskMemFree(did);
+            }
+            const bool new_device = !endpoint_ || device_id != endpoint_id_;
+
+            std::unordered_map<std::string, LiveSession> live;
+            Microsoft::WRL::ComPtr<IAudioMeterInformation> endpoint = endpoint_;
+            if (new_device) {
+                endpoint.Reset();
+                dev->Activate(__uuidof(IAudioMeterInformation), CLSCTX_ALL, nullptr, (void**)endpoint.GetAddressOf());
+                endpoint_volume_.Reset();
+                if (state_) {
+                    dev->Activate(__uuidof(IAudioEndpointVolume), CLSCTX_ALL, nullptr,
+                                  (void**)endpoint_volume_.GetAddressOf());
+                }
+            }
+
+            Microsoft::WRL::ComPtr<IAudioSessionManager2> mgr;
+            Microsoft::WRL::ComPtr<IAudioSessionEnumerator> sessions;
+            if (SUCCEEDED(dev->Activate(__uuidof(IAudioSessionManager2), CLSCTX_ALL, nullptr,
+                                        (void**)mgr.GetAddressOf())) &&
+                SUCCEEDED(mgr->GetSessionEnumerator(sessions.GetAddressOf()))) {
+                int count = 0;
+                sessions->GetCount(&count);
+                for (int i = 0; i < count; i++) {
+                    Microsoft::WRL::ComPtr<IAudioSessionControl> ctl;
+                    Microsoft::WRL::ComPtr<IAudioSessionControl2> ctl2;
+                    if (FAILED(sessions->GetSession(i, ctl.GetAddressOf())) || FAILED(ctl.As(&ctl2))) continue;
+                    LPWSTR sid = nullptr;
+                    if (FAILED(ctl2->GetSessionIdentifier(&sid)) || !sid) continue;
+                    std::string id = WideToUtf8(sid);
+                    CoTaskMemFree(sid);
+                    LiveSession ls;
+                    if (FAILED(ctl2.As(&ls.meter))) continue;
+                    if (state_) {
+                        DWORD pid = 0;
+                        ctl2->GetProcessId(&pid);
+                        ctl2.As(&ls.volume);
+                        ls.pid = pid;
+                        ls.system = ctl2->IsSystemSoundsSession() == S_OK;
+                        ls.entry.id = id;
+                        const std::string path = pid ? GetExePathByPid(pid) : std::string();
+                        ls.entry.exe_name = path.empty() ? (pid ? "pid_" + std::to_string(pid) : "system")
+                                                         : BasenameLower(path);
+                        LPWSTR dn = nullptr;
+                        if (SUCCEEDED(ctl->GetDisplayName(&dn)) && dn) {
+                            ls.entry.display_name = WideToUtf8(dn);
+                            CoTaskMemFree(dn);
+                        }
+                    }
+                    live[id] = std::move(ls);
+                }
+            }
+
+            // A new default device is a different signal: restart slot 0.
+            if (new_device && engine_) engine_->ResetSlot(0);
+            endpoint_ = endpoint;
+            endpoint_id_ = device_id;
+
+            std::lock_guard<std::mutex> lock(mu_);
+            for (auto it = slots_.begin(); it != slots_.end();) {
+                if (live.count(it->first)) {
+                    ++it;
+                    continue;
+                }
+                free_.push_back(it->second);
+                meters_[it->second].Reset();
+                if (it->second < volumes_.size()) {
+                    volumes_[it->second].Reset();
+                    roster_[it->second] = StateRosterEntry{};
+                    roster_dirty_ = true;
+                }
+                it = slots_.erase(it);
+            }
+            for (auto& kv : live) {
+                auto it = slots_.find(kv.first);
+                size_t slot = 0;
+                if (it != slots_.end()) {
+                    slot = it->second;
+                } else {
+                    if (!free_.empty()) {
+                        slot = free_.back();
+                        free_.pop_back();
+                    } else if (meters_.size() < kMaxSlots) {
+                        meters_.resize(std::max<size_t>(meters_.size(), 1) + 1);
+                        slot = meters_.size() - 1;
+                    } else {
+                        continue;
+                    }
+                    slots_[kv.first] = slot;
+                    if (engine_) engine_->ResetSlot(slot);
+                    roster_dirty_ = true;
+                }
+                meters_[slot] = kv.second.meter;
+                if (state_) {
+                    if (volumes_.size() < meters_.size()) {
+                        volumes_.resize(meters_.size());
+                        roster_.resize(meters_.size());
+                        pids_.resize(meters_.size());
+                        system_.resize(meters_.size());
+                    }
+                    volumes_[slot] = kv.second.volume;
+                    roster_[slot] = kv.second.entry;
+                    pids_[slot] = kv.second.pid;
+                    system_[slot] = kv.second.system;
+                }
+            }
+            if (meters_.empty()) meters_.resize(1);
+            meters_[0] = endpoint_;
+            if (state_ && roster_.empty()) {
+                roster_.resize(1);
+                roster_dirty_ = true;
+            }
+            if (state_) roster_[0] = StateRosterEntry{"master", "", ""};
+        }
+
+        MeterEngine* engine_ = nullptr;
+        std::chrono::steady_clock::time_point next_refresh_{};
+        Microsoft::WRL::ComPtr<IAudioMeterInformation> endpoint_;
+        std::wstring endpoint_id_;
+        std::vector<Microsoft::WRL::ComPtr<IAudioMeterInformation>> meters_;  // [0] = endpoint
+        std::vector<size_t> free_;
+
+        // State channel feed, by slot like meters_. Meter thread only.
+        StateChannelWriter* state_ = nullptr;
+        std::chrono::steady_clock::time_point next_publish_{};
+        Microsoft::WRL::ComPtr<IAudioEndpointVolume> endpoint_volume_;
+        std::vector<Microsoft::WRL::ComPtr<ISimpleAudioVolume>> volumes_;
+        std::vector<StateRosterEntry> roster_;
+        std::vector<uint32_t> pids_;
+        std::vector<bool> system_;
+        std::vector<StateSlot> frame_;
+        bool roster_dirty_ = true;
+
+        std::mutex mu_;  // slots_ is also read from the platform thread
+        std::unordered_map<std::string, size_t> slots_;
+    };
+
+    static flutter::EncodableValue EncodeMeter(const MeterReading& r) {
+        flutter::EncodableMap m;
+        m[flutter::EncodableValue("peak")] = flutter::EncodableValue((double)r.peak);
+        m[flutter::EncodableValue("hold")] = flutter::EncodableValue((double)r.hold);
+        m[flutter::EncodableValue("ppm")] = flutter::EncodableValue((double)r.ppm);
+        m[flutter::EncodableValue("vu")] = flutter::EncodableValue((double)r.vu);
+        m[flutter::EncodableValue("rms")] = flutter::EncodableValue((double)r.rms);
+        return flutter::EncodableValue(m);
+    }
+
+    // Read in place by VolumedeckMixerMeterHistory() and
+    // VolumedeckMixerStateChannel() below.
+    static std::atomic<const MeterHistory*> g_history{nullptr};
+    static std::atomic<const StateChannelHeader*> g_state{nullptr};
+    static std::atomic<size_t> g_state_size{0};
+
+    static flutter::EncodableMap EncodeSupervisor(const SupervisorStats& s) {
+        flutter::EncodableMap m;
+        m[flutter::EncodableValue("running")] = flutter::EncodableValue(s.running);
+        m[flutter::EncodableValue("pid")] = flutter::EncodableValue((int64_t)s.pid);
+        m[flutter::EncodableValue("starts")] = flutter::EncodableValue((int64_t)s.starts);
+        m[flutter::EncodableValue("crashes")] = flutter::EncodableValue((int64_t)s.crashes);
+        m[flutter::EncodableValue("lastExitCode")] = flutter::EncodableValue(s.last_exit_code);
+        m[flutter::EncodableValue("startupUs")] = flutter::EncodableValue((int64_t)s.last_startup_us);
+        m[flutter::EncodableValue("restartUs")] = flutter::EncodableValue((int64_t)s.last_restart_us);
+        m[flutter::EncodableValue("uptimeMs")] = flutter::EncodableValue((int64_t)s.uptime_ms);
+        m[flutter::EncodableValue("backoffMs")] = flutter::EncodableValue((int64_t)s.backoff_ms);
+        return m;
+    }
+
+    static std::string EndpointArg(const flutter::MethodCall<flutter::EncodableValue>& call) {
+        if (!call.arguments() || !std::holds_alternative<flutter::EncodableMap>(*call.arguments())) return {};
+        const auto& args = std::get<flutter::EncodableMap>(*call.arguments());
+        auto it = args.find(flutter::EncodableValue("endpointId"));
+        if (it == args.end() || !std::holds_alternative<std::string>(it->second)) return {};
+        return std::get<std::string>(it->second);
+    }
+
+    static double DoubleArg(const flutter::EncodableMap& args, const char* key, double fallback) {
+        auto it = args.find(flutter::EncodableValue(key));
+        if (it == args.end() || !std::holds_alternative<double>(it->second)) return fallback;
+        return std::get<double>(it->second);
+    }
+
+    static RateHint HintArg(const flutter::EncodableMap& args) {
+        return RateHint{DoubleArg(args, "minHz", 0.0), DoubleArg(args, "maxHz", 0.0)};
+    }
+
+    // {index: [target, ...]}, as DeejConfig keeps its mappings.
+    static std::map<int, std::vector<std::string>> MappingArg(const flutter::EncodableMap& args, const char* key) {
+        std::map<int, std::vector<std::string>> out;
+        auto it = args.find(flutter::EncodableValue(key));
+        if (it == args.end() || !std::holds_alternative<flutter::EncodableMap>(it->second)) return out;
+        for (const auto& [k, v] : std::get<flutter::EncodableMap>(it->second)) {
+            if (!std::holds_alternative<int32_t>(k)) continue;
+            auto& targets = out[std::get<int32_t>(k)];
+            if (!std::holds_alternative<flutter::EncodableList>(v)) continue;
+            for (const auto& t : std::get<flutter::EncodableList>(v)) {
+                if (std::holds_alternative<std::string>(t)) targets.push_back(std::get<std::string>(t));
+            }
+        }
+        return out;
+    }
+
+    static DeejConfig DeejConfigArg(const flutter::EncodableMap& args) {
+        DeejConfig cfg;
+        cfg.slider_mapping = MappingArg(args, "sliderMapping");
+        cfg.button_mapping = MappingArg(args, "buttonMapping");
+        cfg.encoder_mapping = MappingArg(args, "encoderMapping");
+        auto get = [&](const char* key) -> const flutter::EncodableValue* {
+            auto it = args.find(flutter::EncodableValue(key));
+            return it == args.end() ? nullptr : &it->second;
+        };
+        const flutter::EncodableValue* v = nullptr;
+        if ((v = get("invertSliders")) && std::holds_alternative<bool>(*v)) cfg.invert_sliders = std::get<bool>(*v);
+        if ((v = get("comPort")) && std::holds_alternative<std::string>(*v)) cfg.com_port = std::get<std::string>(*v);
+        if ((v = get("baudRate")) && std::holds_alternative<int32_t>(*v)) cfg.baud_rate = std::get<int32_t>(*v);
+        if ((v = get("noiseReduction")) && std::holds_alternative<std::string>(*v)) {
+            cfg.noise_reduction = std::get<std::string>(*v);
+        }
+        return cfg;
+    }
+
+// ---------- Flutter plugin wrapper ----------
+    void VolumedeckMixerPlugin::RegisterWithRegistrar(flutter::PluginRegistrarWindows* registrar) {
+        auto channel = std::make_unique<flutter::MethodChannel<flutter::EncodableValue>>(
+                registrar->messenger(), "volumedeck_mixer",
+                        &flutter::StandardMethodCodec::GetInstance());
 
         auto plugin = std::make_unique<VolumedeckMixerPlugin>();
 
         channel->SetMethodCallHandler(
-                [plugin_pointer = plugin.get()](const auto &call, auto result) {
-                    plugin_pointer->HandleMethodCall(call, std::move(result));
+                [plugin_ptr = plugin.get()](const auto& call, auto result) {
+                    plugin_ptr->HandleMethodCall(call, std::move(result));
                 });
 
         registrar->AddPlugin(std::move(plugin));
     }
 
+    VolumedeckMixerPlugin::VolumedeckMixerPlugin()
+        : audio_(std::make_unique<CoreAudio>()),
+          probe_(std::make_unique<SessionMeterProbe>()),
+          history_(SessionMeterProbe::kMaxSlots, kHistoryLength, kHistoryRate),
+          meters_(probe_.get(), SessionMeterProbe::kMaxSlots) {
+        probe_->SetEngine(&meters_);
+        meters_.SetHistory(&history_);
+        meters_.SetScheduler(&sampler_);
+        // Method channel polls keep the meters going while they last.
+        poll_subscriber_ = sampler_.Subscribe({}, kPollLease);
+        // With volumedeckd running the UI reads its channel; otherwise
+        // the meter thread fills one of our own.
+        if (daemon_state_.Open(kStateChannelName)) {
+            g_state_size = daemon_state_.size();
+            g_state = daemon_state_.header();
+        } else if (state_.Open()) {
+            probe_->SetStateChannel(&state_);
+            g_state_size = state_.size();
+            g_state = state_.header();
+        }
+        // Synchronous dart:ffi path (volumedeck_mixer_ffi.h), by state
+        // channel slot. Our own meters only line up with our own channel.
+        // Its backend starts here rather than on Dart's first call.
+        if (g_state && ffi_state_.Attach(g_state.load(), g_state_size.load())) {
+            fast_path_ = std::make_unique<MixerFastPath>(&ffi_backend_, &ffi_state_,
+                                                         daemon_state_.is_open() ? nullptr : &meters_, &sampler_);
+            if (!InstallMixerFastPath(fast_path_.get())) fast_path_.reset();
+        }
+        meters_.Start();
+        g_history = &history_;
+    }
+
+    VolumedeckMixerPlugin::~VolumedeckMixerPlugin() {
+        // Waits out FFI calls still inside fast_path_.
+        InstallMixerFastPath(nullptr);
+        g_history = nullptr;
+        g_state = nullptr;
+        meters_.Stop();
+    }
+
+    // {length, rateHz, columns, slots: {"master": 0, sessionId: slot},
+    //  data: Float32List [slot][peak ring, RMS ring], oldest first}
+    flutter::EncodableMap VolumedeckMixerPlugin::GetMeterHistory() {
+        std::vector<float> data;
+        const size_t columns = history_.CopyAll(&data);
+
+        flutter::EncodableMap slots;
+        slots[flutter::EncodableValue("master")] = flutter::EncodableValue(0);
+        for (const auto& kv : probe_->Roster()) {
+            slots[flutter::EncodableValue(kv.first)] = flutter::EncodableValue((int)kv.second);
+        }
+        flutter::EncodableMap out;
+        out[flutter::EncodableValue("length")] = flutter::EncodableValue((int)history_.length());
+        out[flutter::EncodableValue("rateHz")] = flutter::EncodableValue((double)kHistoryRate);
+        out[flutter::EncodableValue("columns")] = flutter::EncodableValue((int)columns);
+        out[flutter::EncodableValue("slots")] = flutter::EncodableValue(slots);
+        out[flutter::EncodableValue("data")] = flutter::EncodableValue(std::move(data));
+        return out;
+    }
+
+    LoudnessMonitor* VolumedeckMixerPlugin::LoudnessFor(const std::string& endpointId) {
+        auto& m = loudness_[endpointId];
+        if (!m) {
+            m = std::make_unique<LoudnessMonitor>(
+                    std::make_unique<WasapiLoopbackSource>(Utf8ToWide(endpointId)));
+            m->Start();
+        }
+        return m.get();
+    }
+
+    // {master: {peak, hold, ppm, vu, rms}, sessions: {sessionId: {...}}}
+    flutter::EncodableMap VolumedeckMixerPlugin::GetMeters() {
+        std::vector<MeterReading> r(SessionMeterProbe::kMaxSlots);
+        const size_t n = meters_.Read(r.data(), r.size());
+
+        flutter::EncodableMap out;
+        out[flutter::EncodableValue("master")] = EncodeMeter(n > 0 ? r[0] : MeterReading{});
+        flutter::EncodableMap sessions;
+        for (const auto& kv : probe_->Roster()) {
+            if (kv.second < n) sessions[flutter::EncodableValue(kv.first)] = EncodeMeter(r[kv.second]);
+        }
+        out[flutter::EncodableValue("sessions")] = flutter::EncodableValue(sessions);
+        return out;
+    }
+
     void VolumedeckMixerPlugin::HandleMethodCall(
-            const flutter::MethodCall<flutter::EncodableValue> &method_call,
+            const flutter::MethodCall<flutter::EncodableValue>& call,
             std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
 
-        const auto &method = method_call.method_name();
+        const auto& method = call.method_name();
+
+        if (method == "getSnapshot" || method == "getMeters" || method == "getMeterHistory") {
+            sampler_.Renew(poll_subscriber_);
+        } else if (method.rfind("setMaster", 0) == 0 || method.rfind("setSession", 0) == 0) {
+            sampler_.NoteActivity();  // a fader in the UI
+        }
 
         if (method == "getSnapshot") {
+            bool include = true;
+            if (call.arguments() && std::holds_alternative<flutter::EncodableMap>(*call.arguments())) {
+                auto args = std::get<flutter::EncodableMap>(*call.arguments());
+                auto it = args.find(flutter::EncodableValue("includeSessions"));
+                if (it != args.end() && std::holds_alternative<bool>(it->second)) {
+                    include = std::get<bool>(it->second);
+                }
+            }
+            result->Success(flutter::EncodableValue(audio_->GetSnapshot(include)));
+            return;
+        }
+
+        if (method == "getMeters") {
+            result->Success(flutter::EncodableValue(GetMeters()));
+            return;
+        }
+
+        if (method == "getMeterHistory") {
+            result->Success(flutter::EncodableValue(GetMeterHistory()));
+            return;
+        }
+
+        // {minHz?, maxHz?} -> id. Keeps the meters running, at no more
+        // than maxHz, until unsubscribeSampler.
+        if (method == "subscribeSampler") {
+            flutter::EncodableMap args;
+            if (call.arguments() && std::holds_alternative<flutter::EncodableMap>(*call.arguments())) {
+                args = std::get<flutter::EncodableMap>(*call.arguments());
+            }
+            result->Success(flutter::EncodableValue(sampler_.Subscribe(HintArg(args))));
+            return;
+        }
+
+        if (method == "setSamplerHint" || method == "unsubscribeSampler") {
+            if (!call.arguments() || !std::holds_alternative<flutter::EncodableMap>(*call.arguments())) {
+                result->Error("bad_args", "args must be map");
+                return;
+            }
+            const auto& args = std::get<flutter::EncodableMap>(*call.arguments());
+            auto it = args.find(flutter::EncodableValue("id"));
+            if (it == args.end() || !std::holds_alternative<int32_t>(it->second)) {
+                result->Error("bad_args", "id required");
+                return;
+            }
+            const int id = std::get<int32_t>(it->second);
+            if (id == poll_subscriber_) {
+                result->Error("bad_args", "unknown id");
+                return;
+            }
+            if (method == "unsubscribeSampler") {
+                sampler_.Unsubscribe(id);
+                result->Success();
+            } else {
+                result->Success(flutter::EncodableValue(sampler_.SetHint(id, HintArg(args))));
+            }
+            return;
+        }
+
+        if (method == "getSamplerStats") {
             flutter::EncodableMap m;
-            m[flutter::EncodableValue("ok")] = flutter::EncodableValue(true);
-            m[flutter::EncodableValue("master")] = flutter::EncodableValue(0.75); // örnek
+            m[flutter::EncodableValue("hz")] = flutter::EncodableValue(sampler_.last_hz());
+            m[flutter::EncodableValue("ticks")] = flutter::EncodableValue((int64_t)sampler_.ticks());
+            m[flutter::EncodableValue("cpuNsPerTick")] =
+                    flutter::EncodableValue((int64_t)sampler_.cpu_ns_per_tick());
+            m[flutter::EncodableValue("subscribers")] =
+                    flutter::EncodableValue((int)sampler_.subscribers());
             result->Success(flutter::EncodableValue(m));
             return;
         }
 
+        if (method == "getLoudness") {
+            const LoudnessReading r = LoudnessFor(EndpointArg(call))->Read();
+            flutter::EncodableMap m;
+            m[flutter::EncodableValue("momentary")] = flutter::EncodableValue(r.momentary);
+            m[flutter::EncodableValue("shortTerm")] = flutter::EncodableValue(r.short_term);
+            m[flutter::EncodableValue("integrated")] = flutter::EncodableValue(r.integrated);
+            m[flutter::EncodableValue("capturing")] = flutter::EncodableValue(r.capturing);
+            result->Success(flutter::EncodableValue(m));
+            return;
+        }
+
+        if (method == "resetLoudness") {
+            LoudnessFor(EndpointArg(call))->ResetIntegrated();
+            result->Success();
+            return;
+        }
+
+        if (method == "findSessionIdByExe") {
+            if (!call.arguments() || !std::holds_alternative<flutter::EncodableMap>(*call.arguments())) {
+                result->Error("bad_args", "args must be map");
+                return;
+            }
+            auto args = std::get<flutter::EncodableMap>(*call.arguments());
+            auto it = args.find(flutter::EncodableValue("exeName"));
+            if (it == args.end() || !std::holds_alternative<std::string>(it->second)) {
+                result->Error("bad_args", "exeName required");
+                return;
+            }
+            auto sid = audio_->FindSessionIdByExeName(std::get<std::string>(it->second));
+            if (!sid) result->Success(flutter::EncodableValue()); // null
+            else result->Success(flutter::EncodableValue(*sid));
+            return;
+        }
+
+        if (method == "setMasterVolume") {
+            auto args = std::get<flutter::EncodableMap>(*call.arguments());
+            double v = 1.0;
+            auto it = args.find(flutter::EncodableValue("value"));
+            if (it != args.end() && std::holds_alternative<double>(it->second)) v = std::get<double>(it->second);
+            result->Success(flutter::EncodableValue(audio_->SetMasterVolume(v)));
+            return;
+        }
+
+        if (method == "setMasterMute") {
+            auto args = std::get<flutter::EncodableMap>(*call.arguments());
+            bool m = false;
+            auto it = args.find(flutter::EncodableValue("mute"));
+            if (it != args.end() && std::holds_alternative<bool>(it->second)) m = std::get<bool>(it->second);
+            result->Success(flutter::EncodableValue(audio_->SetMasterMute(m)));
+            return;
+        }
+
+        if (method == "setSessionVolume") {
+            auto args = std::get<flutter::EncodableMap>(*call.arguments());
+            auto itId = args.find(flutter::EncodableValue("sessionId"));
+            auto itV  = args.find(flutter::EncodableValue("value"));
+            if (itId == args.end() || !std::holds_alternative<std::string>(itId->second) ||
+                itV == args.end()  || !std::holds_alternative<double>(itV->second)) {
+                result->Error("bad_args", "sessionId + value required");
+                return;
+            }
+            result->Success(flutter::EncodableValue(
+                    audio_->SetSessionVolume(std::get<std::string>(itId->second), std::get<double>(itV->second))
+            ));
+            return;
+        }
+
+        if (method == "setSessionMute") {
+            auto args = std::get<flutter::EncodableMap>(*call.arguments());
+            auto itId = args.find(flutter::EncodableValue("sessionId"));
+            auto itM  = args.find(flutter::EncodableValue("mute"));
+            if (itId == args.end() || !std::holds_alternative<std::string>(itId->second) ||
+                itM == args.end()  || !std::holds_alternative<bool>(itM->second)) {
+                result->Error("bad_args", "sessionId + mute required");
+                return;
+            }
+            result->Success(flutter::EncodableValue(
+                    audio_->SetSessionMute(std::get<std::string>(itId->second), std::get<bool>(itM->second))
+            ));
+            return;
+        }
+
+        // {path, sliderMapping, invertSliders, comPort, baudRate,
+        // noiseReduction, buttonMapping, encoderMapping}: writes config.yaml
+        // with the emitter the engine and volumedeckd use, atomically. On the
+        // platform thread; the Dart isolate only awaits the reply.
+        if (method == "saveDeejConfig") {
+            if (!call.arguments() || !std::holds_alternative<flutter::EncodableMap>(*call.arguments())) {
+                result->Error("bad_args", "args must be map");
+                return;
+            }
+            const auto& args = std::get<flutter::EncodableMap>(*call.arguments());
+            auto itPath = args.find(flutter::EncodableValue("path"));
+            if (itPath == args.end() || !std::holds_alternative<std::string>(itPath->second)) {
+                result->Error("bad_args", "path required");
+                return;
+            }
+            std::string error;
+            if (!SaveDeejConfig(std::get<std::string>(itPath->second), DeejConfigArg(args), &error)) {
+                result->Error("write_failed", error);
+                return;
+            }
+            result->Success();
+            return;
+        }
+
+        // {exePath, workingDir?}: (re)starts deej.exe under supervision.
+        // Only our own child is ever ended, never every deej.exe.
+        if (method == "startDeej" || method == "restartDeej") {
+            if (!call.arguments() || !std::holds_alternative<flutter::EncodableMap>(*call.arguments())) {
+                result->Error("bad_args", "args must be map");
+                return;
+            }
+            const auto& args = std::get<flutter::EncodableMap>(*call.arguments());
+            auto itExe = args.find(flutter::EncodableValue("exePath"));
+            auto itDir = args.find(flutter::EncodableValue("workingDir"));
+            if (itExe == args.end() || !std::holds_alternative<std::string>(itExe->second)) {
+                result->Error("bad_args", "exePath required");
+                return;
+            }
+            SupervisorOptions o;
+            o.program = std::get<std::string>(itExe->second);
+            if (itDir != args.end() && std::holds_alternative<std::string>(itDir->second)) {
+                o.working_dir = std::get<std::string>(itDir->second);
+            }
+            if (deej_ && method == "restartDeej" && deej_->options().program == o.program &&
+                deej_->options().working_dir == o.working_dir) {
+                deej_->Restart();
+            } else {
+                deej_.reset();
+                deej_ = std::make_unique<ProcessSupervisor>(o);
+                std::string error;
+                if (!deej_->Start(&error)) {
+                    deej_.reset();
+                    result->Error("spawn_failed", error);
+                    return;
+                }
+            }
+            result->Success(flutter::EncodableValue(EncodeSupervisor(deej_->stats())));
+            return;
+        }
+
+        if (method == "stopDeej") {
+            deej_.reset();
+            result->Success();
+            return;
+        }
+
+        if (method == "getDeejStatus") {
+            result->Success(deej_ ? flutter::EncodableValue(EncodeSupervisor(deej_->stats()))
+                                  : flutter::EncodableValue());
+            return;
+        }
+
         result->NotImplemented();
     }
 
 }  // namespace volumedeck_mixer
 
-void VolumedeckMixerPluginRegisterWithRegistrar(
-        FlutterDesktopPluginRegistrarRef registrar) {
-    volumedeck_mixer::VolumedeckMixerPlugin::RegisterWithRegistrar(
-            flutter::PluginRegistrarManager::GetInstance()
-                    ->GetRegistrar<flutter::PluginRegistrarWindows>(registrar));
+// Zero-copy access to the meter history for dart:ffi. Returns the
+// MeterHistoryBlock (see meter_history.h) and its size in bytes, or null
+// before the plugin is registered. The block lives as long as the plugin.
+extern "C" __declspec(dllexport) const void* VolumedeckMixerMeterHistory(size_t* size) {
+    const volumedeck_mixer::MeterHistory* h =
+            volumedeck_mixer::g_history.load(std::memory_order_acquire);
+    if (!h) return nullptr;
+    if (size) *size = h->block_size();
+    return h->block();
+}
+
+// Zero-copy access to the live state channel (see state_channel.h): the
+// plugin's own, or volumedeckd's when it was running at startup. Null
+// before the plugin is registered.
+extern "C" __declspec(dllexport) const void* VolumedeckMixerStateChannel(size_t* size) {
+    const volumedeck_mixer::StateChannelHeader* h =
+            volumedeck_mixer::g_state.load(std::memory_order_acquire);
+    if (!h) return nullptr;
+    if (size) *size = volumedeck_mixer::g_state_size.load();
+    return h;
 }
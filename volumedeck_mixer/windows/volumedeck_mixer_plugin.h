@@ -4,10 +4,26 @@
 #include <flutter/method_channel.h>
 #include <flutter/plugin_registrar_windows.h>
 
+#include <chrono>
+#include <map>
 #include <memory>
+#include <string>
+
+#include "loudness_monitor.h"
+#include "meter_engine.h"
+#include "meter_history.h"
+#include "mixer_fast_path.h"
+#include "process_supervisor.h"
+#include "sample_scheduler.h"
+#include "state_channel.h"
+#include "wasapi_mixer_backend.h"
 
 namespace volumedeck_mixer {
 
+// Defined in volumedeck_mixer_plugin.cpp; they need the Core Audio headers.
+class CoreAudio;
+class SessionMeterProbe;
+
 class VolumedeckMixerPlugin : public flutter::Plugin {
  public:
   static void RegisterWithRegistrar(flutter::PluginRegistrarWindows *registrar);
@@ -24,6 +40,34 @@ class VolumedeckMixerPlugin : public flutter::Plugin {
   void HandleMethodCall(
       const flutter::MethodCall<flutter::EncodableValue> &method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+ private:
+  // 10 s of sparkline at 30 Hz.
+  static constexpr size_t kHistoryLength = 300;
+  static constexpr float kHistoryRate = 30.0f;
+  static constexpr std::chrono::seconds kPollLease{2};
+
+  flutter::EncodableMap GetMeters();
+  flutter::EncodableMap GetMeterHistory();
+  LoudnessMonitor* LoudnessFor(const std::string& endpointId);
+
+  std::unique_ptr<CoreAudio> audio_;
+  StateChannelWriter state_;
+  StateChannelReader daemon_state_;
+  std::unique_ptr<SessionMeterProbe> probe_;
+  MeterHistory history_;
+  SampleScheduler sampler_;  // outlives meters_
+  MeterEngine meters_;
+  int poll_subscriber_ = 0;
+  // Started with the fast path; then used only through it.
+  WasapiMixerBackend ffi_backend_;
+  StateChannelReader ffi_state_;
+  std::unique_ptr<MixerFastPath> fast_path_;
+  // deej.exe, once the app has started it; ends with the plugin.
+  std::unique_ptr<ProcessSupervisor> deej_;
+  // Loopback loudness per endpoint id ("" = default output). Started on
+  // first request: capture is not free and most users never look.
+  std::map<std::string, std::unique_ptr<LoudnessMonitor>> loudness_;
 };
 
 }  // namespace volumedeck_mixer
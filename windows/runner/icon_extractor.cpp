@@ -3,13 +3,26 @@
 #include <windows.h>
 #include <shlobj.h>
 #include <shellapi.h>
-#include <wincodec.h>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
-#pragma comment(lib, "windowscodecs.lib")
+#include "icon_atlas.h"
+#include "icon_disk_cache.h"
+#include "icon_memory_cache.h"
+#include "icon_pixels.h"
+#include "icon_resample.h"
+#include "pe_icon_reader.h"
+#include "png_encoder.h"
+#include "task_pool.h"
+
 #pragma comment(lib, "ole32.lib")
 #pragma comment(lib, "shell32.lib")
 
@@ -63,216 +76,412 @@ static bool IconToBGRA(HICON hIcon, int size, std::vector<uint8_t>& outBGRA) {
     return true;
 }
 
-static bool EncodePngWIC(const std::vector<uint8_t>& bgra, int size, std::vector<uint8_t>& pngOut) {
-    HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
-    const bool didInit = SUCCEEDED(hr);
-
-    IWICImagingFactory* factory = nullptr;
-    hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory));
-    if (FAILED(hr) || !factory) {
-        if (didInit) CoUninitialize();
-        return false;
+// %LOCALAPPDATA%\volumedeck\icon_cache.pack, shared by every launch.
+static std::string IconCachePath() {
+    PWSTR base = nullptr;
+    if (FAILED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, nullptr, &base)) || !base) {
+        if (base) CoTaskMemFree(base);
+        return {};
     }
+    std::wstring dir = std::wstring(base) + L"\\volumedeck";
+    CoTaskMemFree(base);
+    CreateDirectoryW(dir.c_str(), nullptr);
+
+    std::wstring file = dir + L"\\icon_cache.pack";
+    int len = WideCharToMultiByte(CP_UTF8, 0, file.c_str(), (int)file.size(), nullptr, 0, nullptr, nullptr);
+    std::string out(len, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, file.c_str(), (int)file.size(), out.data(), len, nullptr, nullptr);
+    return out;
+}
 
-    IWICBitmap* bitmap = nullptr;
-    hr = factory->CreateBitmapFromMemory(
-            size, size,
-            GUID_WICPixelFormat32bppBGRA,
-            size * 4,
-            (UINT)bgra.size(),
-            (BYTE*)bgra.data(),
-            &bitmap);
-    if (FAILED(hr) || !bitmap) {
-        factory->Release();
-        if (didInit) CoUninitialize();
-        return false;
-    }
+static volumedeck_mixer::IconDiskCache* g_diskCache = nullptr;
 
-    IWICStream* stream = nullptr;
-    hr = factory->CreateStream(&stream);
-    if (FAILED(hr) || !stream) {
-        bitmap->Release();
-        factory->Release();
-        if (didInit) CoUninitialize();
-        return false;
-    }
+// Extraction runs here, never on the platform thread: a cold exe on a slow
+// disk or a picker full of apps would otherwise stall the UI.
+static volumedeck_mixer::TaskPool* g_iconPool = nullptr;
 
-    hr = stream->InitializeFromMemory(nullptr, 0); // will fail
-    // We need an IStream that grows: use CreateStreamOnHGlobal
-    IStream* memStream = nullptr;
-    hr = CreateStreamOnHGlobal(nullptr, TRUE, &memStream);
-    if (FAILED(hr) || !memStream) {
-        stream->Release();
-        bitmap->Release();
-        factory->Release();
-        if (didInit) CoUninitialize();
-        return false;
+// Message-only window owned by the platform thread; workers hand replies
+// back through it because MethodResult must be completed on that thread.
+static HWND g_replyWindow = nullptr;
+static constexpr UINT kRunReplyMessage = WM_APP + 1;
+static constexpr wchar_t kReplyWindowClass[] = L"VOLUMEDECK_ICON_REPLY";
+
+static LRESULT CALLBACK ReplyWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    if (msg == kRunReplyMessage) {
+        std::unique_ptr<std::function<void()>> fn(reinterpret_cast<std::function<void()>*>(lParam));
+        (*fn)();
+        return 0;
     }
+    return DefWindowProcW(hwnd, msg, wParam, lParam);
+}
 
-    IWICBitmapEncoder* encoder = nullptr;
-    hr = factory->CreateEncoder(GUID_ContainerFormatPng, nullptr, &encoder);
-    if (FAILED(hr) || !encoder) {
-        memStream->Release();
-        stream->Release();
-        bitmap->Release();
-        factory->Release();
-        if (didInit) CoUninitialize();
-        return false;
+static void CreateReplyWindow() {
+    WNDCLASSW wc{};
+    wc.lpfnWndProc = ReplyWndProc;
+    wc.hInstance = GetModuleHandleW(nullptr);
+    wc.lpszClassName = kReplyWindowClass;
+    RegisterClassW(&wc);
+    g_replyWindow = CreateWindowExW(0, kReplyWindowClass, L"", 0, 0, 0, 0, 0, HWND_MESSAGE,
+                                    nullptr, wc.hInstance, nullptr);
+}
+
+static void PostToPlatformThread(std::function<void()> fn) {
+    auto* heap = new std::function<void()>(std::move(fn));
+    if (!g_replyWindow || !PostMessageW(g_replyWindow, kRunReplyMessage, 0, reinterpret_cast<LPARAM>(heap))) {
+        delete heap;  // shutting down; the engine is gone anyway
     }
+}
 
-    hr = encoder->Initialize(memStream, WICBitmapEncoderNoCache);
-    if (FAILED(hr)) {
-        encoder->Release();
-        memStream->Release();
-        stream->Release();
-        bitmap->Release();
-        factory->Release();
-        if (didInit) CoUninitialize();
+// Reads the icon resources straight from the file (or .ico) and picks the
+// variant closest to `size`. Works for anything with an icon group, without
+// COM or GDI.
+static bool ExtractIconFromResources(const std::string& pathUtf8, int size,
+                                     std::vector<uint8_t>& bgra, int* width, int* height) {
+    volumedeck_mixer::DecodedIcon icon;
+    if (!volumedeck_mixer::ExtractIconFromFile(pathUtf8, size, &icon)) return false;
+    *width = icon.width;
+    *height = icon.height;
+    bgra = std::move(icon.bgra);
+    return true;
+}
+
+// Shell fallback: default icons for files without resources, shortcuts,
+// UWP stubs and so on.
+static bool ExtractIconBgra(const std::wstring& path, int size, std::vector<uint8_t>& bgra, int* edge) {
+    SHFILEINFOW sfi{};
+    UINT flags = SHGFI_ICON | (size <= 16 ? SHGFI_SMALLICON : SHGFI_LARGEICON);
+    if (!SHGetFileInfoW(path.c_str(), 0, &sfi, sizeof(sfi), flags) || !sfi.hIcon) {
         return false;
     }
 
-    IWICBitmapFrameEncode* frame = nullptr;
-    IPropertyBag2* props = nullptr;
-    hr = encoder->CreateNewFrame(&frame, &props);
-    if (props) props->Release();
-    if (FAILED(hr) || !frame) {
-        encoder->Release();
-        memStream->Release();
-        stream->Release();
-        bitmap->Release();
-        factory->Release();
-        if (didInit) CoUninitialize();
-        return false;
+    *edge = (size <= 16 ? 16 : 32);
+    bool ok = IconToBGRA(sfi.hIcon, *edge, bgra);
+    DestroyIcon(sfi.hIcon);
+    return ok;
+}
+
+static bool GetIconBgra(const std::string& pathUtf8, int size, std::vector<uint8_t>& bgra,
+                        int* width, int* height) {
+    if (ExtractIconFromResources(pathUtf8, size, bgra, width, height)) return true;
+    int edge = 0;
+    if (!ExtractIconBgra(Utf8ToWide(pathUtf8), size, bgra, &edge)) return false;
+    *width = *height = edge;
+    return true;
+}
+
+// Decoded pyramids, one per exe. 8 MB holds ~150 full pyramids. Every
+// pyramid also goes into the disk cache, so the atlas and both per-icon
+// paths skip the extraction on the next launch.
+static volumedeck_mixer::IconMemoryCache* g_memCache = nullptr;
+static constexpr size_t kMemCacheBytes = 8u << 20;
+
+// Extract at this size (the 256 px PNG most exes ship) and derive every UI
+// size from it.
+static constexpr int kPyramidSourceSize = 256;
+
+// The picker asks for the same exe at several sizes at once; these make the
+// second request wait for the first extraction instead of repeating it.
+static std::array<std::mutex, 16> g_extractLocks;
+
+static std::shared_ptr<const volumedeck_mixer::IconPyramid> GetIconPyramid(const std::string& pathUtf8) {
+    volumedeck_mixer::IconCacheKey key;
+    if (!volumedeck_mixer::MakeIconCacheKey(pathUtf8, 0, &key)) return nullptr;
+    if (auto hit = g_memCache->Get(key)) return hit;
+
+    std::lock_guard<std::mutex> lock(g_extractLocks[std::hash<std::string>()(key.path) % g_extractLocks.size()]);
+    if (auto hit = g_memCache->Get(key)) return hit;
+
+    // A previous launch may have built it already.
+    auto pyramid = std::make_shared<volumedeck_mixer::IconPyramid>();
+    std::vector<uint8_t> blob;
+    if (g_diskCache && g_diskCache->Lookup(key, blob, volumedeck_mixer::IconFormat::kPyramid) &&
+        volumedeck_mixer::DeserializeIconPyramid(blob.data(), blob.size(), pyramid.get())) {
+        g_memCache->Put(key, pyramid);
+        return pyramid;
     }
 
-    hr = frame->Initialize(nullptr);
-    if (FAILED(hr)) {
-        frame->Release();
-        encoder->Release();
-        memStream->Release();
-        stream->Release();
-        bitmap->Release();
-        factory->Release();
-        if (didInit) CoUninitialize();
-        return false;
+    std::vector<uint8_t> bgra;
+    int width = 0, height = 0;
+    if (!GetIconBgra(pathUtf8, kPyramidSourceSize, bgra, &width, &height)) return nullptr;
+
+    volumedeck_mixer::IconImage source;
+    volumedeck_mixer::IconImageFromBgra(bgra.data(), width, height, &source);
+
+    thread_local volumedeck_mixer::IconResampler resampler;
+    pyramid = std::make_shared<volumedeck_mixer::IconPyramid>();
+    if (!volumedeck_mixer::BuildIconPyramid(std::move(source), resampler, pyramid.get())) return nullptr;
+    g_memCache->Put(key, pyramid);
+    if (g_diskCache) {
+        volumedeck_mixer::SerializeIconPyramid(*pyramid, blob);
+        g_diskCache->Insert(key, volumedeck_mixer::IconFormat::kPyramid, std::move(blob));
     }
+    return pyramid;
+}
 
-    hr = frame->SetSize(size, size);
-    if (FAILED(hr)) {
-        frame->Release();
-        encoder->Release();
-        memStream->Release();
-        stream->Release();
-        bitmap->Release();
-        factory->Release();
-        if (didInit) CoUninitialize();
-        return false;
+static bool GetIconForFile(const std::string& pathUtf8, int size, std::vector<uint8_t>& pngOut) {
+    auto pyramid = GetIconPyramid(pathUtf8);
+    if (!pyramid) return false;
+    const volumedeck_mixer::IconImage& img = pyramid->ForSize(size);
+
+    thread_local volumedeck_mixer::PngEncoder encoder;
+    std::vector<uint8_t> rgba(img.rgba.size());
+    volumedeck_mixer::PremultipliedToStraightRgba(img.rgba.data(), rgba.data(), img.pixel_count());
+    if (!encoder.EncodeRgba(rgba.data(), img.width, img.height, (size_t)img.width * 4)) return false;
+    pngOut.assign(encoder.png().begin(), encoder.png().end());
+    return true;
+}
+
+static bool GetIconRgbaForFile(const std::string& pathUtf8, int size, volumedeck_mixer::IconImage& out) {
+    auto pyramid = GetIconPyramid(pathUtf8);
+    if (!pyramid) return false;
+    out = pyramid->ForSize(size);
+    return true;
+}
+
+static bool ParseIconArgs(const flutter::MethodCall<flutter::EncodableValue>& call,
+                          std::string& pathUtf8, int& size) {
+    const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+    if (!args) return false;
+
+    auto itPath = args->find(flutter::EncodableValue("path"));
+    if (itPath != args->end()) {
+        if (auto p = std::get_if<std::string>(&itPath->second)) pathUtf8 = *p;
+    }
+    auto itSize = args->find(flutter::EncodableValue("size"));
+    if (itSize != args->end()) {
+        if (auto p = std::get_if<int>(&itSize->second)) size = *p;
     }
+    return true;
+}
 
-    WICPixelFormatGUID format = GUID_WICPixelFormat32bppBGRA;
-    frame->SetPixelFormat(&format);
-
-    hr = frame->WriteSource(bitmap, nullptr);
-    if (FAILED(hr)) {
-        frame->Release();
-        encoder->Release();
-        memStream->Release();
-        stream->Release();
-        bitmap->Release();
-        factory->Release();
-        if (didInit) CoUninitialize();
-        return false;
+// {width, height, pixels}: premultiplied RGBA8 for ui.decodeImageFromPixels.
+static flutter::EncodableValue RawIconValue(const volumedeck_mixer::IconImage& img) {
+    flutter::EncodableMap m;
+    m[flutter::EncodableValue("width")] = flutter::EncodableValue(img.width);
+    m[flutter::EncodableValue("height")] = flutter::EncodableValue(img.height);
+    m[flutter::EncodableValue("pixels")] = flutter::EncodableValue(img.rgba);
+    return flutter::EncodableValue(m);
+}
+
+// Keyed by path + size + mtime, so an updated exe misses.
+static flutter::EncodableValue LoadIconPng(const std::string& pathUtf8, int size) {
+    if (pathUtf8.empty()) return flutter::EncodableValue(std::vector<uint8_t>{});
+
+    volumedeck_mixer::IconCacheKey key;
+    const bool cacheable = g_diskCache && volumedeck_mixer::MakeIconCacheKey(pathUtf8, size, &key);
+
+    std::vector<uint8_t> png;
+    if (cacheable && g_diskCache->Lookup(key, png, volumedeck_mixer::IconFormat::kPng)) {
+        return flutter::EncodableValue(png);
     }
 
-    frame->Commit();
-    encoder->Commit();
+    if (!GetIconForFile(pathUtf8, size, png)) return flutter::EncodableValue(std::vector<uint8_t>{});
+
+    if (cacheable) g_diskCache->Insert(key, volumedeck_mixer::IconFormat::kPng, png);
+    return flutter::EncodableValue(png);
+}
 
-    // Read bytes from memStream
-    STATSTG stat{};
-    memStream->Stat(&stat, STATFLAG_NONAME);
-    ULONG sizeBytes = (ULONG)stat.cbSize.QuadPart;
-    pngOut.resize(sizeBytes);
+// Same lookup, but no PNG on either side: the pixels go to Dart as they are
+// drawn. null when there is no icon.
+static flutter::EncodableValue LoadIconRgba(const std::string& pathUtf8, int size) {
+    if (pathUtf8.empty()) return flutter::EncodableValue();
 
-    LARGE_INTEGER zero{};
-    memStream->Seek(zero, STREAM_SEEK_SET, nullptr);
+    volumedeck_mixer::IconCacheKey key;
+    const bool cacheable = g_diskCache && volumedeck_mixer::MakeIconCacheKey(pathUtf8, size, &key);
 
-    ULONG read = 0;
-    memStream->Read(pngOut.data(), sizeBytes, &read);
-    pngOut.resize(read);
+    volumedeck_mixer::IconImage img;
+    std::vector<uint8_t> blob;
+    if (cacheable && g_diskCache->Lookup(key, blob, volumedeck_mixer::IconFormat::kRgba8Premul) &&
+        volumedeck_mixer::DeserializeIconImage(blob.data(), blob.size(), &img)) {
+        return RawIconValue(img);
+    }
 
-    frame->Release();
-    encoder->Release();
-    memStream->Release();
-    stream->Release();
-    bitmap->Release();
-    factory->Release();
+    if (!GetIconRgbaForFile(pathUtf8, size, img)) return flutter::EncodableValue();
 
-    if (didInit) CoUninitialize();
-    return true;
+    if (cacheable) {
+        volumedeck_mixer::SerializeIconImage(img, blob);
+        g_diskCache->Insert(key, volumedeck_mixer::IconFormat::kRgba8Premul, std::move(blob));
+    }
+    return RawIconValue(img);
 }
 
-static bool GetIconForFile(const std::wstring& path, int size, std::vector<uint8_t>& pngOut) {
-    SHFILEINFOW sfi{};
-    UINT flags = SHGFI_ICON | (size <= 16 ? SHGFI_SMALLICON : SHGFI_LARGEICON);
-    if (!SHGetFileInfoW(path.c_str(), 0, &sfi, sizeof(sfi), flags) || !sfi.hIcon) {
-        return false;
+// One append-only sheet per icon size for the pickers. Guarded by
+// g_atlasMu; pixels are copied out under the lock.
+static std::mutex g_atlasMu;
+static std::map<int, std::unique_ptr<volumedeck_mixer::IconAtlas>> g_atlases;
+
+// {width, height, version, rects: {path: [x, y, w, h]}, firstRow, pixels}.
+// Paths without an icon (or that no longer fit) are left out of `rects`.
+// `pixels` holds only the rows written after `known_version`, starting at
+// `firstRow`, and is absent when the caller's sheet is current.
+static flutter::EncodableValue LoadIconAtlas(const std::vector<std::string>& paths, int size,
+                                             uint32_t known_version) {
+    std::vector<std::pair<std::string, volumedeck_mixer::IconImage>> fresh;
+    {
+        std::lock_guard<std::mutex> lock(g_atlasMu);
+        auto& atlas = g_atlases[size];
+        if (!atlas) atlas = std::make_unique<volumedeck_mixer::IconAtlas>();
+        volumedeck_mixer::AtlasRect r;
+        for (const auto& p : paths) {
+            if (p.empty() || atlas->Find(volumedeck_mixer::NormalizeIconPath(p), &r)) continue;
+            fresh.emplace_back(p, volumedeck_mixer::IconImage{});
+        }
     }
 
-    std::vector<uint8_t> bgra;
-    bool ok = IconToBGRA(sfi.hIcon, (size <= 16 ? 16 : 32), bgra);
-    DestroyIcon(sfi.hIcon);
-    if (!ok) return false;
+    // Extract outside the lock; this is the slow part.
+    thread_local volumedeck_mixer::IconResampler resampler;
+    for (auto& f : fresh) {
+        auto pyramid = GetIconPyramid(f.first);
+        if (!pyramid) continue;
+        const volumedeck_mixer::IconImage& img = pyramid->ForSize(size);
+        if (img.width == size) {
+            f.second = img;
+        } else {
+            const int h = std::max(1, img.height * size / img.width);
+            resampler.Resize(img, size, h, volumedeck_mixer::ResampleFilter::kLanczos3, &f.second);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(g_atlasMu);
+    auto& atlas = *g_atlases[size];
+    volumedeck_mixer::AtlasRect r;
+    for (const auto& f : fresh) {
+        if (f.second.width > 0) atlas.Add(volumedeck_mixer::NormalizeIconPath(f.first), f.second, &r);
+    }
 
-    return EncodePngWIC(bgra, (size <= 16 ? 16 : 32), pngOut);
+    flutter::EncodableMap rects;
+    for (const auto& p : paths) {
+        if (p.empty() || !atlas.Find(volumedeck_mixer::NormalizeIconPath(p), &r)) continue;
+        rects[flutter::EncodableValue(p)] = flutter::EncodableValue(
+                flutter::EncodableList{flutter::EncodableValue(r.x), flutter::EncodableValue(r.y),
+                                       flutter::EncodableValue(r.width), flutter::EncodableValue(r.height)});
+    }
+
+    flutter::EncodableMap m;
+    m[flutter::EncodableValue("width")] = flutter::EncodableValue(atlas.width());
+    m[flutter::EncodableValue("height")] = flutter::EncodableValue(atlas.height());
+    m[flutter::EncodableValue("version")] = flutter::EncodableValue((int64_t)atlas.version());
+    // A version from before a restart of ours is no baseline at all.
+    if (known_version > atlas.version()) known_version = 0;
+    int first = 0, last = 0;
+    if (atlas.RowsChangedSince(known_version, &first, &last)) {
+        const size_t stride = (size_t)atlas.width() * 4;
+        m[flutter::EncodableValue("firstRow")] = flutter::EncodableValue(first);
+        m[flutter::EncodableValue("pixels")] = flutter::EncodableValue(std::vector<uint8_t>(
+                atlas.rgba().begin() + first * stride, atlas.rgba().begin() + last * stride));
+    }
+    m[flutter::EncodableValue("rects")] = flutter::EncodableValue(rects);
+    return flutter::EncodableValue(m);
+}
+
+static bool ParseAtlasArgs(const flutter::MethodCall<flutter::EncodableValue>& call,
+                           std::vector<std::string>& paths, int& size, uint32_t& known_version) {
+    const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+    if (!args) return false;
+
+    auto itPaths = args->find(flutter::EncodableValue("paths"));
+    if (itPaths == args->end()) return false;
+    const auto* list = std::get_if<flutter::EncodableList>(&itPaths->second);
+    if (!list) return false;
+    for (const auto& v : *list) {
+        if (auto p = std::get_if<std::string>(&v)) paths.push_back(*p);
+    }
+    auto itSize = args->find(flutter::EncodableValue("size"));
+    if (itSize != args->end()) {
+        if (auto p = std::get_if<int>(&itSize->second)) size = *p;
+    }
+    auto itKnown = args->find(flutter::EncodableValue("knownVersion"));
+    if (itKnown != args->end()) {
+        if (auto p = std::get_if<int>(&itKnown->second)) known_version = (uint32_t)*p;
+        else if (auto q = std::get_if<int64_t>(&itKnown->second)) known_version = (uint32_t)*q;
+    }
+    return size > 0 && size <= 256;
 }
 
 void RegisterIconExtractor(flutter::BinaryMessenger* messenger) {
+    if (!g_diskCache) {
+        const std::string cachePath = IconCachePath();
+        if (!cachePath.empty()) {
+            // Lives for the whole process, like the channel below. The pack is
+            // only mapped on the first lookup and rewritten once the picker
+            // has stopped asking for new icons.
+            g_diskCache = new volumedeck_mixer::IconDiskCache(cachePath);
+            g_diskCache->StartBackgroundCompaction(std::chrono::seconds(2));
+        }
+    }
+    if (!g_memCache) g_memCache = new volumedeck_mixer::IconMemoryCache(kMemCacheBytes);
+    if (!g_iconPool) {
+        CreateReplyWindow();
+        // SHGetFileInfoW needs COM on the calling thread.
+        g_iconPool = new volumedeck_mixer::TaskPool(
+                volumedeck_mixer::TaskPool::DefaultThreadCount(),
+                [] { CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED); },
+                [] { CoUninitialize(); });
+    }
+
     auto channel = std::make_unique<flutter::MethodChannel<flutter::EncodableValue>>(
             messenger, "volumedeck/icon", &flutter::StandardMethodCodec::GetInstance());
 
     channel->SetMethodCallHandler(
             [](const flutter::MethodCall<flutter::EncodableValue>& call,
                std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-                if (call.method_name() == "getExeIconPng") {
-                    const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
-                    if (!args) {
-                        result->Error("bad_args", "Expected map args");
-                        return;
-                    }
-
-                    std::string pathUtf8;
-                    int size = 32;
-
-                    auto itPath = args->find(flutter::EncodableValue("path"));
-                    if (itPath != args->end()) {
-                        if (auto p = std::get_if<std::string>(&itPath->second)) pathUtf8 = *p;
-                    }
-                    auto itSize = args->find(flutter::EncodableValue("size"));
-                    if (itSize != args->end()) {
-                        if (auto p = std::get_if<int>(&itSize->second)) size = *p;
-                    }
-
-                    if (pathUtf8.empty()) {
-                        result->Success(flutter::EncodableValue(std::vector<uint8_t>{}));
+                const auto& method = call.method_name();
+
+                // Every picker icon at `size` in one sheet: one upload in
+                // Dart instead of an image per row.
+                if (method == "getIconAtlas") {
+                    std::vector<std::string> paths;
+                    int size = 20;
+                    uint32_t known = 0;
+                    if (!ParseAtlasArgs(call, paths, size, known)) {
+                        result->Error("bad_args", "Expected {paths, size, knownVersion}");
                         return;
                     }
+                    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared(std::move(result));
+                    g_iconPool->Post([shared, paths, size, known] {
+                        auto value = std::make_shared<flutter::EncodableValue>(LoadIconAtlas(paths, size, known));
+                        PostToPlatformThread([shared, value] { shared->Success(*value); });
+                    });
+                    return;
+                }
 
-                    const std::wstring path = Utf8ToWide(pathUtf8);
-
-                    std::vector<uint8_t> png;
-                    if (!GetIconForFile(path, size, png)) {
-                        result->Success(flutter::EncodableValue(std::vector<uint8_t>{}));
-                        return;
-                    }
+                const bool png = method == "getExeIconPng";
+                if (!png && method != "getExeIconRgba") {
+                    result->NotImplemented();
+                    return;
+                }
 
-                    result->Success(flutter::EncodableValue(png));
+                std::string pathUtf8;
+                int size = 32;
+                if (!ParseIconArgs(call, pathUtf8, size)) {
+                    result->Error("bad_args", "Expected map args");
                     return;
                 }
 
-                result->NotImplemented();
+                // std::function must be copyable, hence shared_ptr.
+                std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared(std::move(result));
+                g_iconPool->Post([shared, pathUtf8, size, png] {
+                    auto value = std::make_shared<flutter::EncodableValue>(
+                            png ? LoadIconPng(pathUtf8, size) : LoadIconRgba(pathUtf8, size));
+                    PostToPlatformThread([shared, value] { shared->Success(*value); });
+                });
             });
 
     // IMPORTANT: keep channel alive by leaking or storing globally
     // simplest: release ownership
     channel.release();
 }
+
+void ShutdownIconExtractor() {
+    // Finish in-flight extractions first so their cache inserts are flushed
+    // below; their replies are dropped with the window.
+    delete g_iconPool;
+    g_iconPool = nullptr;
+    if (g_replyWindow) DestroyWindow(g_replyWindow);
+    g_replyWindow = nullptr;
+
+    delete g_diskCache;  // writes whatever is still pending
+    g_diskCache = nullptr;
+    delete g_memCache;
+    g_memCache = nullptr;
+}
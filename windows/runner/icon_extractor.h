@@ -4,3 +4,6 @@
 #include <flutter/standard_method_codec.h>
 
 void RegisterIconExtractor(flutter::BinaryMessenger* messenger);
+
+// Flushes the on-disk icon cache. Call after the engine is gone.
+void ShutdownIconExtractor();